@@ -20,6 +20,27 @@
 #include <iostream>
 #include <osmscout/TextSearchIndex.h>
 
+class FuzzyResultVisitor : public osmscout::TextSearchVisitor
+{
+public:
+  std::string lastText;
+
+  bool Visit(const std::string& text,
+             const osmscout::ObjectFileRef& object,
+             size_t distance)
+  {
+    if(text!=lastText) {
+      std::cout << std::endl;
+      std::cout << "\"" << text << "\" (distance " << distance << ") -> ";
+      lastText=text;
+    }
+
+    std::cout << object.GetName() << " ";
+
+    return true;
+  }
+};
+
 void badInput()
 {
   std::cout << "ERROR: Bad arguments" << std::endl;
@@ -49,6 +70,7 @@ int main (int argc, char *argv[])
   std::cout << "* Searches are case-sensitive\n"
                "* Displays up to 10 unique text results\n"
                "* Displays up to 5 file offsets for each result\n"
+               "* Displays up to 10 similar texts, if nothing is found\n"
                "* Input at least 3 characters or 'q' to quit\n" << std::endl;
 
 
@@ -74,7 +96,11 @@ int main (int argc, char *argv[])
     textSearch.Search(searchInput,true,true,true,true,results);
 
     if(results.empty()) {
-      std::cout << "No results found." << std::endl;
+      FuzzyResultVisitor visitor;
+
+      std::cout << "No results found, similar texts:";
+      textSearch.Search(searchInput,true,true,true,true,2,10,visitor);
+      std::cout << std::endl;
       continue;
     }
 
@@ -0,0 +1,249 @@
+/*
+  NearestPOI - a demo program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include <osmscout/Database.h>
+
+#include <osmscout/POIService.h>
+#include <osmscout/RoutingService.h>
+
+#include <osmscout/TypeFeatures.h>
+
+#include <osmscout/util/StopClock.h>
+
+/*
+  Example for the nordrhein-westfalen.osm (to be executed in the Demos top
+  level directory):
+
+  src/NearestPOI ../TravelJinni/ 51.51241 7.46525 10 amenity_fuel
+  src/NearestPOI --car ../TravelJinni/ 51.51241 7.46525 10 amenity_fuel
+*/
+
+static const double maxDistance=50000.0;
+
+static void GetCarSpeedTable(std::map<std::string,double>& map)
+{
+  map["highway_motorway"]=110.0;
+  map["highway_motorway_trunk"]=100.0;
+  map["highway_motorway_primary"]=70.0;
+  map["highway_motorway_link"]=60.0;
+  map["highway_motorway_junction"]=60.0;
+  map["highway_trunk"]=100.0;
+  map["highway_trunk_link"]=60.0;
+  map["highway_primary"]=70.0;
+  map["highway_primary_link"]=60.0;
+  map["highway_secondary"]=60.0;
+  map["highway_secondary_link"]=50.0;
+  map["highway_tertiary_link"]=55.0;
+  map["highway_tertiary"]=55.0;
+  map["highway_unclassified"]=50.0;
+  map["highway_road"]=50.0;
+  map["highway_residential"]=40.0;
+  map["highway_roundabout"]=40.0;
+  map["highway_living_street"]=10.0;
+  map["highway_service"]=30.0;
+}
+
+int main(int argc, char* argv[])
+{
+  bool                   byRoute=false;
+  osmscout::Vehicle      vehicle=osmscout::vehicleCar;
+  std::string            map;
+  double                 lat,lon;
+  size_t                 limit;
+  std::list<std::string> typeNames;
+
+  int currentArg=1;
+
+  while (currentArg<argc &&
+         strncmp(argv[currentArg],"--",2)==0) {
+    if (strcmp(argv[currentArg],"--foot")==0) {
+      vehicle=osmscout::vehicleFoot;
+    }
+    else if (strcmp(argv[currentArg],"--bicycle")==0) {
+      vehicle=osmscout::vehicleBicycle;
+    }
+    else if (strcmp(argv[currentArg],"--car")==0) {
+      vehicle=osmscout::vehicleCar;
+    }
+    else {
+      std::cerr << "Unknown option '" << argv[currentArg] << "'" << std::endl;
+      return 1;
+    }
+
+    byRoute=true;
+    currentArg++;
+  }
+
+  if (argc-currentArg<5) {
+    std::cerr << "NearestPOI [--foot|--bicycle|--car] <map directory> <lat> <lon> <count> {type}" << std::endl;
+    return 1;
+  }
+
+  map=argv[currentArg];
+
+  if (sscanf(argv[currentArg+1],"%lf",&lat)!=1) {
+    std::cerr << "lat is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+2],"%lf",&lon)!=1) {
+    std::cerr << "lon is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (sscanf(argv[currentArg+3],"%zu",&limit)!=1) {
+    std::cerr << "count is not numeric!" << std::endl;
+    return 1;
+  }
+
+  for (int i=currentArg+4; i<argc; i++) {
+    typeNames.push_back(std::string(argv[i]));
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+  osmscout::POIServiceRef     poiService(new osmscout::POIService(database));
+
+  if (!database->Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+
+    return 1;
+  }
+
+  osmscout::TypeConfigRef          typeConfig(database->GetTypeConfig());
+  osmscout::TypeInfoSet            types(*typeConfig);
+  osmscout::NameFeatureLabelReader nameLabelReader(*typeConfig);
+
+  for (const auto &name : typeNames) {
+    osmscout::TypeInfoRef type=typeConfig->GetTypeInfo(name);
+
+    if (type->GetIgnore()) {
+      std::cerr << "Cannot resolve type name '" << name << "'" << std::endl;
+      continue;
+    }
+
+    if (!type->GetIndexAsPOI()) {
+      std::cerr << "Type '" << name << "' is not indexed as POI" << std::endl;
+      continue;
+    }
+
+    std::cout << "- Searching for '" << name << "'" << std::endl;
+
+    types.Set(type);
+  }
+
+  std::vector<osmscout::POIResult> pois;
+  osmscout::StopClock              timer;
+
+  if (byRoute) {
+    osmscout::FastestPathRoutingProfile routingProfile(typeConfig);
+    osmscout::RouterParameter           routerParameter;
+    osmscout::RoutingService            router(database,
+                                               routerParameter,
+                                               vehicle);
+    std::map<std::string,double>        carSpeedTable;
+
+    if (!router.Open()) {
+      std::cerr << "Cannot open routing database" << std::endl;
+
+      return 1;
+    }
+
+    switch (vehicle) {
+    case osmscout::vehicleFoot:
+      routingProfile.ParametrizeForFoot(*typeConfig,
+                                        5.0);
+      break;
+    case osmscout::vehicleBicycle:
+      routingProfile.ParametrizeForBicycle(*typeConfig,
+                                           20.0);
+      break;
+    case osmscout::vehicleCar:
+      GetCarSpeedTable(carSpeedTable);
+      routingProfile.ParametrizeForCar(*typeConfig,
+                                       carSpeedTable,
+                                       160.0);
+      break;
+    }
+
+    if (!poiService->GetNearestPOIsByRoute(router,
+                                           routingProfile,
+                                           osmscout::GeoCoord(lat,lon),
+                                           types,
+                                           limit,
+                                           maxDistance,
+                                           pois)) {
+      std::cerr << "Cannot load data from database" << std::endl;
+
+      return 1;
+    }
+
+    router.Close();
+  }
+  else {
+    if (!poiService->GetNearestPOIs(osmscout::GeoCoord(lat,lon),
+                                    types,
+                                    limit,
+                                    maxDistance,
+                                    pois)) {
+      std::cerr << "Cannot load data from database" << std::endl;
+
+      return 1;
+    }
+  }
+
+  timer.Stop();
+
+  for (const auto& poi : pois) {
+    std::cout << "+ " << std::fixed << std::setprecision(0) << poi.distance << "m";
+
+    if (byRoute) {
+      std::cout << " (route " << poi.routeDistance << "m)";
+    }
+
+    if (poi.node) {
+      std::cout << " Node " << poi.node->GetFileOffset();
+      std::cout << " " << poi.node->GetType()->GetName();
+      std::cout << " " << nameLabelReader.GetLabel(poi.node->GetFeatureValueBuffer());
+    }
+    else if (poi.way) {
+      std::cout << " Way " << poi.way->GetFileOffset();
+      std::cout << " " << poi.way->GetType()->GetName();
+      std::cout << " " << nameLabelReader.GetLabel(poi.way->GetFeatureValueBuffer());
+    }
+    else if (poi.area) {
+      std::cout << " Area " << poi.area->GetFileOffset();
+      std::cout << " " << poi.area->GetType()->GetName();
+      std::cout << " " << nameLabelReader.GetLabel(poi.area->rings.front().GetFeatureValueBuffer());
+    }
+
+    std::cout << std::endl;
+  }
+
+  std::cout << pois.size() << " POI(s) found in " << timer.ResultString() << "s" << std::endl;
+
+  database->Close();
+
+  return 0;
+}
@@ -1,5 +1,5 @@
 /*
-  AddressLookup - a demo program for libosmscout
+  ReverseLocationLookup - a demo program for libosmscout
   Copyright (C) 2010  Tim Teulings
 
   This program is free software; you can redistribute it and/or modify
@@ -19,59 +19,177 @@
 
 #include <cctype>
 #include <cstring>
+#include <iomanip>
+#include <random>
 
 #include <osmscout/Database.h>
 #include <osmscout/LocationService.h>
 
+#include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
 
-int main(int argc, char* argv[])
+static const double defaultMaxDistance=500.0;
+
+void DumpResult(const osmscout::LocationService::ReverseGeocodeResult& result)
 {
-  std::string                        map;
-  std::list<osmscout::ObjectFileRef> objects;
+  std::cout << std::fixed << std::setprecision(5) << result.coord.GetLat() << " " << result.coord.GetLon() << " matches";
 
-  if (argc<4 || argc%2!=0) {
-    std::cerr << "AddressLookup <map directory> <ObjectType> <FileOffset>..." << std::endl;
-    return 1;
+  std::cout << std::setprecision(1);
+
+  if (result.address) {
+    std::cout << " address '";
+
+    if (result.addressLocation) {
+      std::cout << result.addressLocation->name << " ";
+    }
+
+    std::cout << result.address->name << "' (" << result.addressDistance << "m)";
   }
 
-  map=argv[1];
+  if (result.location) {
+    std::cout << " location '" << result.location->name << "' (" << result.locationDistance << "m)";
+  }
 
-  std::string searchPattern;
+  for (const auto& region : result.adminRegions) {
+    std::cout << " region '" << region->name << "'";
+  }
 
-  int argIndex=2;
-  while (argIndex<argc) {
-    osmscout::RefType    objectType=osmscout::refNone;
-    osmscout::FileOffset offset=0;
+  std::cout << std::endl;
+}
 
-    if (strcmp("Node",argv[argIndex])==0) {
-      objectType=osmscout::refNode;
-    }
-    else if (strcmp("Area",argv[argIndex])==0) {
-      objectType=osmscout::refArea;
+/**
+ * Reverse geocodes random coordinates within the bounding box of the database
+ * in one batch and reports the throughput. For comparison the first coordinates
+ * are also looked up one by one.
+ */
+bool Benchmark(const osmscout::DatabaseRef& database,
+               const osmscout::LocationServiceRef& locationService,
+               size_t count,
+               double maxDistance)
+{
+  osmscout::GeoBox boundingBox;
+
+  if (!database->GetBoundingBox(boundingBox)) {
+    std::cerr << "Cannot get bounding box of database" << std::endl;
+    return false;
+  }
+
+  std::mt19937                           generator(0);
+  std::uniform_real_distribution<double> latDistribution(boundingBox.GetMinLat(),boundingBox.GetMaxLat());
+  std::uniform_real_distribution<double> lonDistribution(boundingBox.GetMinLon(),boundingBox.GetMaxLon());
+  std::vector<osmscout::GeoCoord>        coords;
+
+  coords.reserve(count);
+
+  for (size_t i=0; i<count; i++) {
+    double lat=latDistribution(generator);
+    double lon=lonDistribution(generator);
+
+    coords.push_back(osmscout::GeoCoord(lat,lon));
+  }
+
+  std::vector<osmscout::LocationService::ReverseGeocodeResult> results;
+
+  // Load the indexes before measuring
+  database->GetLocationIndex();
+  database->GetReverseGeocodeIndex();
+
+  osmscout::StopClock batchTimer;
+
+  if (!locationService->ReverseGeocode(coords,
+                                       maxDistance,
+                                       results)) {
+    std::cerr << "Error while reverse geocoding" << std::endl;
+    return false;
+  }
+
+  batchTimer.Stop();
+
+  size_t addressCount=0;
+  size_t locationCount=0;
+
+  for (const auto& result : results) {
+    if (result.address) {
+      addressCount++;
     }
-    else if (strcmp("Way",argv[argIndex])==0) {
-      objectType=osmscout::refWay;
+
+    if (result.location) {
+      locationCount++;
     }
-    else {
-      std::cerr << "Error: ObjectType must be one of 'Node', 'Area' or 'Way'" << std::endl;
+  }
 
-      return 1;
+  size_t singleCount=std::min(count,(size_t)1000);
+
+  osmscout::StopClock singleTimer;
+
+  for (size_t i=0; i<singleCount; i++) {
+    std::vector<osmscout::GeoCoord> singleCoord(1,coords[i]);
+
+    if (!locationService->ReverseGeocode(singleCoord,
+                                         maxDistance,
+                                         results)) {
+      std::cerr << "Error while reverse geocoding" << std::endl;
+      return false;
     }
+  }
+
+  singleTimer.Stop();
 
-    argIndex++;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "Batch:  " << count << " coordinates in " << batchTimer.ResultString() << "s, ";
+  std::cout << count*1000.0/std::max(batchTimer.GetMilliseconds(),0.001) << " coordinates/s" << std::endl;
+  std::cout << "Single: " << singleCount << " coordinates in " << singleTimer.ResultString() << "s, ";
+  std::cout << singleCount*1000.0/std::max(singleTimer.GetMilliseconds(),0.001) << " coordinates/s" << std::endl;
+  std::cout << addressCount << " coordinates with address, ";
+  std::cout << locationCount << " coordinates with location within " << maxDistance << "m" << std::endl;
 
-    if (!osmscout::StringToNumber(argv[argIndex],
-                                  offset)) {
-      std::cerr << "Error: '" << argv[argIndex] << "' cannot be parsed to a file offset" << std::endl;
+  return true;
+}
 
+int main(int argc, char* argv[])
+{
+  std::string map;
+  double      maxDistance=defaultMaxDistance;
+  size_t      benchmarkCount=0;
+
+  std::vector<osmscout::GeoCoord> coords;
+
+  if (argc<4 ||
+      (strcmp(argv[2],"--benchmark")!=0 && argc%2!=0) ||
+      (strcmp(argv[2],"--benchmark")==0 && argc>5)) {
+    std::cerr << "ReverseLocationLookup <map directory> <lat> <lon> [<lat> <lon>...]" << std::endl;
+    std::cerr << "ReverseLocationLookup <map directory> --benchmark <count> [<max distance>]" << std::endl;
+    return 1;
+  }
+
+  map=argv[1];
+
+  if (strcmp(argv[2],"--benchmark")==0) {
+    if (!osmscout::StringToNumber(argv[3],
+                                  benchmarkCount)) {
+      std::cerr << "Error: '" << argv[3] << "' is not a valid count" << std::endl;
       return 1;
     }
 
-    argIndex++;
+    if (argc==5 &&
+        sscanf(argv[4],"%lf",&maxDistance)!=1) {
+      std::cerr << "Error: '" << argv[4] << "' is not a valid distance" << std::endl;
+      return 1;
+    }
+  }
+  else {
+    for (int argIndex=2; argIndex<argc; argIndex+=2) {
+      double lat;
+      double lon;
+
+      if (sscanf(argv[argIndex],"%lf",&lat)!=1 ||
+          sscanf(argv[argIndex+1],"%lf",&lon)!=1) {
+        std::cerr << "Error: '" << argv[argIndex] << " " << argv[argIndex+1] << "' is not a valid coordinate" << std::endl;
+        return 1;
+      }
 
-    objects.push_back(osmscout::ObjectFileRef(offset,
-                                              objectType));
+      coords.push_back(osmscout::GeoCoord(lat,lon));
+    }
   }
 
   osmscout::DatabaseParameter databaseParameter;
@@ -85,36 +203,28 @@ int main(int argc, char* argv[])
 
   osmscout::LocationServiceRef locationService(new osmscout::LocationService(database));
 
-  std::list<osmscout::LocationService::ReverseLookupResult> result;
-
-  if (locationService->ReverseLookupObjects(objects,
-                                            result)) {
-    for (std::list<osmscout::LocationService::ReverseLookupResult>::const_iterator entry=result.begin();
-         entry!=result.end();
-         ++entry) {
-      std::cout << entry->object.GetTypeName() << " " << entry->object.GetFileOffset() << " matches";
-
-      if (entry->adminRegion) {
-        std::cout << " region '" << entry->adminRegion->name << "'";
-      }
-
-      if (entry->poi) {
-        std::cout << " poi '" << entry->poi->name << "'";
-      }
-
-      if (entry->location) {
-        std::cout << " location '" << entry->location->name << "'";
-      }
-
-      if (entry->address) {
-        std::cout << " address '" << entry->address->name << "'";
-      }
-
-      std::cout << std::endl;
+  if (benchmarkCount>0) {
+    if (!Benchmark(database,
+                   locationService,
+                   benchmarkCount,
+                   maxDistance)) {
+      database->Close();
+      return 1;
     }
   }
   else {
-    std::cerr << "Error while reverse lookup" << std::endl;
+    std::vector<osmscout::LocationService::ReverseGeocodeResult> results;
+
+    if (locationService->ReverseGeocode(coords,
+                                        maxDistance,
+                                        results)) {
+      for (const auto& result : results) {
+        DumpResult(result);
+      }
+    }
+    else {
+      std::cerr << "Error while reverse geocoding" << std::endl;
+    }
   }
 
   database->Close();
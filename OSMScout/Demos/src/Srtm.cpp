@@ -31,17 +31,137 @@
  > Srtm ~/Documents/SRTM -21.0773 65.4230
  No data for (-21.0773,65.423)
 
+ > Srtm ~/Documents/SRTM --benchmark 45.5 6.5 1000000
+ Measures queries per second along a random track of 1000000 points starting at
+ the given position, crossing tile borders.
+
  */
 
 #include <cstring>
+#include <iomanip>
+#include <random>
 
 #include <osmscout/SRTM.h>
 
+#include <osmscout/util/StopClock.h>
+
+static void PrintThroughput(const std::string& name,
+                            const osmscout::StopClock& timer,
+                            size_t count,
+                            size_t hits)
+{
+  double seconds=timer.GetMilliseconds()/1000.0;
+
+  std::cout << std::left << std::setw(28) << name;
+  std::cout << std::right << std::setw(10) << timer.ResultString() << "s ";
+  std::cout << std::setw(12) << std::fixed << std::setprecision(0);
+
+  if (seconds>0.0) {
+    std::cout << count/seconds;
+  }
+  else {
+    std::cout << "-";
+  }
+
+  std::cout << " queries/s, " << hits << " with data" << std::endl;
+}
+
+static int Benchmark(const std::string& srtmDir,
+                     double latitude,
+                     double longitude,
+                     size_t count)
+{
+  std::vector<osmscout::GeoCoord>  coords;
+  std::mt19937                     generator(0);
+  std::normal_distribution<double> direction(0.0,0.5);
+  double                           bearing=0.0;
+
+  // Random track with steps of about 100m
+  coords.reserve(count);
+
+  for (size_t i=0; i<count; i++) {
+    coords.push_back(osmscout::GeoCoord(latitude,longitude));
+
+    bearing+=direction(generator);
+    latitude+=0.0009*sin(bearing);
+    longitude+=0.0013*cos(bearing);
+  }
+
+  size_t hits;
+
+  {
+    osmscout::SRTM      srtm(srtmDir);
+    osmscout::StopClock timer;
+    size_t              legacyCount=std::min(count,(size_t)100000);
+
+    hits=0;
+
+    for (size_t i=0; i<legacyCount; i++) {
+      if (srtm.heightAtLocation(coords[i].GetLat(),coords[i].GetLon())!=osmscout::SRTM::nodata) {
+        hits++;
+      }
+    }
+
+    timer.Stop();
+
+    PrintThroughput("SRTM::heightAtLocation",timer,legacyCount,hits);
+  }
+
+  {
+    osmscout::SRTMService srtm(srtmDir);
+    osmscout::StopClock   timer;
+
+    hits=0;
+
+    for (const auto& coord : coords) {
+      if (srtm.GetHeight(coord)!=osmscout::SRTM::nodata) {
+        hits++;
+      }
+    }
+
+    timer.Stop();
+
+    PrintThroughput("SRTMService::GetHeight",timer,count,hits);
+  }
+
+  {
+    osmscout::SRTMService srtm(srtmDir);
+    std::vector<double>   heights;
+    osmscout::StopClock   timer;
+
+    srtm.GetHeights(coords,heights);
+
+    timer.Stop();
+
+    hits=0;
+
+    for (const auto& height : heights) {
+      if (height!=osmscout::SRTM::nodata) {
+        hits++;
+      }
+    }
+
+    PrintThroughput("SRTMService::GetHeights",timer,count,hits);
+  }
+
+  return 0;
+}
+
 int main(int argc, char* argv[])
 {
+  if (argc>=5 && strcmp(argv[2],"--benchmark")==0) {
+    size_t count=1000000;
+
+    if (argc>=6) {
+      count=(size_t)atol(argv[5]);
+    }
+
+    return Benchmark(argv[1],atof(argv[3]),atof(argv[4]),count);
+  }
 
   if (argc!=4) {
     std::cout << "Srtm <SRTM directory> <latitude> <longitude>" << std::endl;
+    std::cout << "Srtm <SRTM directory> --benchmark <latitude> <longitude> [<count>]" << std::endl;
     return 1;
   }
 
@@ -49,8 +169,8 @@ int main(int argc, char* argv[])
   double latitude = atof(argv[2]);
   double longitude = atof(argv[3]);
 
-  osmscout::SRTM srtm(srtmDir);
-  int h = srtm.heightAtLocation(latitude, longitude);
+  osmscout::SRTMService srtm(srtmDir);
+  double h = srtm.GetHeight(osmscout::GeoCoord(latitude, longitude));
   if(h!=osmscout::SRTM::nodata){
     std::cout<<"Height at ("<<latitude<<","<<longitude<<") = "<<h<<" m"<<std::endl;
   } else {
@@ -24,6 +24,7 @@
 
 #include <osmscout/util/File.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/import/Import.h>
 
@@ -62,6 +63,8 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " -s <end step>                        set final step" << std::endl;
   std::cout << " --typefile <path>                    path and name of the map.ost file (default: " << parameter.GetTypefile() << ")" << std::endl;
   std::cout << " --destinationDirectory <path>        destination for generated map files (default: " << parameter.GetDestinationDirectory() << ")" << std::endl;
+  std::cout << " --incremental true|false             skip steps whose results are up to date (default: " << BoolToString(parameter.GetIncremental()) << ")" << std::endl;
+  std::cout << " --traceFile <path>                   write a Chrome trace of the import steps" << std::endl;
 
   std::cout << " --strictAreas true|false             assure that areas are simple (default: " << BoolToString(parameter.GetStrictAreas()) << ")" << std::endl;
 
@@ -77,9 +80,12 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --rawWayDataCacheSize <number>       raw way data cache size (default: " << parameter.GetRawWayDataCacheSize() << ")" << std::endl;
   std::cout << " --rawWayIndexCacheSize <number>      raw way index cache size (default: " << parameter.GetRawWayIndexCacheSize() << ")" << std::endl;
   std::cout << " --rawWayBlockSize <number>           number of raw ways resolved in block (default: " << parameter.GetRawWayBlockSize() << ")" << std::endl;
+  std::cout << " --rawRelationBlockSize <number>      number of raw relations resolved in block (default: " << parameter.GetRawRelationBlockSize() << ")" << std::endl;
 
   std::cout << " --noSort                             do not sort objects" << std::endl;
-  std::cout << " --sortBlockSize <number>             size of one data block during sorting (default: " << parameter.GetSortBlockSize() << ")" << std::endl;
+  std::cout << " --sortMemoryBudget <number>          memory in bytes used for one sorting run (default: " << parameter.GetSortMemoryBudget() << ")" << std::endl;
+  std::cout << " --columnStore true|false             also write columnar copies of the data files (default: " << BoolToString(parameter.GetColumnStore()) << ")" << std::endl;
+  std::cout << " --dataCompressionBlockSize <number>  block size for compressing the data files, 0 for none (default: " << parameter.GetDataCompressionBlockSize() << ")" << std::endl;
 
   std::cout << " --areaDataMemoryMaped true|false     memory maped area data file access (default: " << BoolToString(parameter.GetAreaDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --areaDataCacheSize <number>         area data cache size (default: " << parameter.GetAreaDataCacheSize() << ")" << std::endl;
@@ -87,6 +93,8 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --wayDataMemoryMaped true|false      memory maped way data file access (default: " << BoolToString(parameter.GetWayDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --wayDataCacheSize <number>          way data cache size (default: " << parameter.GetWayDataCacheSize() << ")" << std::endl;
 
+  std::cout << " --areaAreaIndexRTree true|false      also generate the R-tree area area index (default: " << BoolToString(parameter.GetAreaAreaIndexRTree()) << ")" << std::endl;
+
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << BoolToString(parameter.GetRouteNodeBlockSize()) << ")" << std::endl;
 }
 
@@ -196,6 +204,9 @@ bool CountDataSize(osmscout::Progress& progress,
   files.push_back("areaway.idx");
 
   files.push_back("location.idx");
+  files.push_back("locationtoken.idx");
+  files.push_back("reversegeocode.idx");
+  files.push_back("poi.idx");
 
   files.push_back("water.idx");
 
@@ -239,12 +250,16 @@ int main(int argc, char* argv[])
 
   size_t                    startStep=parameter.GetStartStep();
   size_t                    endStep=parameter.GetEndStep();
+  bool                      incremental=parameter.GetIncremental();
+  std::string               traceFile;
 
   bool                      strictAreas=parameter.GetStrictAreas();
 
   size_t                    numericIndexPageSize=parameter.GetNumericIndexPageSize();
 
-  size_t                    sortBlockSize=parameter.GetSortBlockSize();
+  size_t                    sortMemoryBudget=parameter.GetSortMemoryBudget();
+  bool                      columnStore=parameter.GetColumnStore();
+  size_t                    dataCompressionBlockSize=parameter.GetDataCompressionBlockSize();
 
   bool                      coordDataMemoryMaped=parameter.GetCoordDataMemoryMaped();
 
@@ -256,6 +271,7 @@ int main(int argc, char* argv[])
   size_t                    rawWayDataCacheSize=parameter.GetRawWayDataCacheSize();
   size_t                    rawWayIndexCacheSize=parameter.GetRawWayIndexCacheSize();
   size_t                    rawWayBlockSize=parameter.GetRawWayBlockSize();
+  size_t                    rawRelationBlockSize=parameter.GetRawRelationBlockSize();
 
   bool                      areaDataMemoryMaped=parameter.GetAreaDataMemoryMaped();
   size_t                    areaDataCacheSize=parameter.GetAreaDataCacheSize();
@@ -263,6 +279,8 @@ int main(int argc, char* argv[])
   bool                      wayDataMemoryMaped=parameter.GetWayDataMemoryMaped();
   size_t                    wayDataCacheSize=parameter.GetWayDataCacheSize();
 
+  bool                      areaAreaIndexRTree=parameter.GetAreaAreaIndexRTree();
+
   size_t                    routeNodeBlockSize=parameter.GetRouteNodeBlockSize();
 
   // Simple way to analyse command line parameters, but enough for now...
@@ -307,6 +325,18 @@ int main(int argc, char* argv[])
                                           i,
                                           destinationDirectory);
     }
+    else if (strcmp(argv[i],"--incremental")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        incremental);
+    }
+    else if (strcmp(argv[i],"--traceFile")==0) {
+      parameterError=!ParseStringArgument(argc,
+                                          argv,
+                                          i,
+                                          traceFile);
+    }
     else if (strcmp(argv[i],"--strictAreas")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -367,16 +397,34 @@ int main(int argc, char* argv[])
                                          i,
                                          rawWayBlockSize);
     }
+    else if (strcmp(argv[i],"--rawRelationBlockSize")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         rawRelationBlockSize);
+    }
     else if (strcmp(argv[i],"-noSort")==0) {
       parameter.SetSortObjects(false);
 
       i++;
     }
-    else if (strcmp(argv[i],"--sortBlockSize")==0) {
+    else if (strcmp(argv[i],"--sortMemoryBudget")==0) {
       parameterError=!ParseSizeTArgument(argc,
                                          argv,
                                          i,
-                                         sortBlockSize);
+                                         sortMemoryBudget);
+    }
+    else if (strcmp(argv[i],"--columnStore")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        columnStore);
+    }
+    else if (strcmp(argv[i],"--dataCompressionBlockSize")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         dataCompressionBlockSize);
     }
     else if (strcmp(argv[i],"--areaDataMemoryMaped")==0) {
       parameterError=!ParseBoolArgument(argc,
@@ -402,6 +450,12 @@ int main(int argc, char* argv[])
                                          i,
                                          wayDataCacheSize);
     }
+    else if (strcmp(argv[i],"--areaAreaIndexRTree")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        areaAreaIndexRTree);
+    }
     else if (strcmp(argv[i],"--routeNodeBlockSize")==0) {
       parameterError=!ParseSizeTArgument(argc,
                                          argv,
@@ -435,12 +489,15 @@ int main(int argc, char* argv[])
   parameter.SetTypefile(typefile);
   parameter.SetDestinationDirectory(destinationDirectory);
   parameter.SetSteps(startStep,endStep);
+  parameter.SetIncremental(incremental);
 
   parameter.SetStrictAreas(strictAreas);
 
   parameter.SetNumericIndexPageSize(numericIndexPageSize);
 
-  parameter.SetSortBlockSize(sortBlockSize);
+  parameter.SetSortMemoryBudget(sortMemoryBudget);
+  parameter.SetColumnStore(columnStore);
+  parameter.SetDataCompressionBlockSize(dataCompressionBlockSize);
 
   parameter.SetCoordDataMemoryMaped(coordDataMemoryMaped);
 
@@ -452,6 +509,7 @@ int main(int argc, char* argv[])
   parameter.SetRawWayDataCacheSize(rawWayDataCacheSize);
   parameter.SetRawWayIndexCacheSize(rawWayIndexCacheSize);
   parameter.SetRawWayBlockSize(rawWayBlockSize);
+  parameter.SetRawRelationBlockSize(rawRelationBlockSize);
 
   parameter.SetAreaDataMemoryMaped(areaDataMemoryMaped);
   parameter.SetAreaDataCacheSize(areaDataCacheSize);
@@ -459,6 +517,8 @@ int main(int argc, char* argv[])
   parameter.SetWayDataMemoryMaped(wayDataMemoryMaped);
   parameter.SetWayDataCacheSize(wayDataCacheSize);
 
+  parameter.SetAreaAreaIndexRTree(areaAreaIndexRTree);
+
   parameter.SetRouteNodeBlockSize(routeNodeBlockSize);
 
   parameter.SetOptimizationWayMethod(osmscout::TransPolygon::quality);
@@ -473,6 +533,8 @@ int main(int argc, char* argv[])
                 osmscout::NumberToString(parameter.GetStartStep())+
                 " - "+
                 osmscout::NumberToString(parameter.GetEndStep()));
+  progress.Info(std::string("Incremental: ")+
+                (parameter.GetIncremental() ? "true" : "false"));
 
   progress.Info(std::string("StrictAreas: ")+
                 (parameter.GetStrictAreas() ? "true" : "false"));
@@ -498,12 +560,18 @@ int main(int argc, char* argv[])
                 osmscout::NumberToString(parameter.GetRawWayIndexCacheSize()));
   progress.Info(std::string("RawWayBlockSize: ")+
                 osmscout::NumberToString(parameter.GetRawWayBlockSize()));
+  progress.Info(std::string("RawRelationBlockSize: ")+
+                osmscout::NumberToString(parameter.GetRawRelationBlockSize()));
 
 
   progress.Info(std::string("SortObjects: ")+
                 (parameter.GetSortObjects() ? "true" : "false"));
-  progress.Info(std::string("SortBlockSize: ")+
-                osmscout::NumberToString(parameter.GetSortBlockSize()));
+  progress.Info(std::string("SortMemoryBudget: ")+
+                osmscout::NumberToString(parameter.GetSortMemoryBudget()));
+  progress.Info(std::string("ColumnStore: ")+
+                (parameter.GetColumnStore() ? "true" : "false"));
+  progress.Info(std::string("DataCompressionBlockSize: ")+
+                osmscout::NumberToString(parameter.GetDataCompressionBlockSize()));
 
   progress.Info(std::string("AreaDataMemoryMaped: ")+
                 (parameter.GetAreaDataMemoryMaped() ? "true" : "false"));
@@ -515,12 +583,29 @@ int main(int argc, char* argv[])
   progress.Info(std::string("WayDataCacheSize: ")+
                 osmscout::NumberToString(parameter.GetWayDataCacheSize()));
 
+  progress.Info(std::string("AreaAreaIndexRTree: ")+
+                (parameter.GetAreaAreaIndexRTree() ? "true" : "false"));
+
   progress.Info(std::string("RouteNodeBlockSize: ")+
                 osmscout::NumberToString(parameter.GetRouteNodeBlockSize()));
 
+  if (!traceFile.empty()) {
+    if (osmscout::Tracer::IsSupported()) {
+      osmscout::Tracer::SetEnabled(true);
+    }
+    else {
+      progress.Warning("libosmscout has been configured without tracing support, trace will be empty");
+    }
+  }
+
   bool result=osmscout::Import(parameter,
                                progress);
 
+  if (!traceFile.empty() &&
+      !osmscout::Tracer::WriteChromeTrace(traceFile)) {
+    progress.Error(std::string("Cannot write trace file '")+traceFile+"'");
+  }
+
   progress.SetStep("Summary");
 
   if (result) {
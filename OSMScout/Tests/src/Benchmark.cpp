@@ -0,0 +1,918 @@
+/*
+  Benchmark - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "config.h"
+
+#include <osmscout/Area.h>
+#include <osmscout/Database.h>
+#include <osmscout/LocationService.h>
+#include <osmscout/MapService.h>
+#include <osmscout/Node.h>
+#include <osmscout/RoutingService.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/import/Import.h>
+#include <osmscout/import/Preprocess.h>
+
+#if defined(HAVE_LIB_OSMSCOUTMAPCAIRO)
+#include <osmscout/MapPainterCairo.h>
+#endif
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
+#include <osmscout/util/Tiling.h>
+
+/**
+  Runs a number of named benchmark scenarios against a map imported from the
+  given OSM file and writes the timing statistics of each measurement as JSON.
+
+  Scenarios:
+  * import: The duration of each import step
+  * scanner: Sequentially decoding nodes.dat, ways.dat and areas.dat
+  * tiles: Loading (and drawing, if cairo is available) all tiles covering the
+    map for each zoom level
+  * routing: Routes between random positions within the map
+  * location: Location searches
+  * classify: Assigning types to the tags of all objects of the OSM file,
+    using the compiled type conditions and evaluating the conditions of all
+    types one after the other. Fails, if the results differ.
+
+  The random positions for routing are generated with a fixed seed and the
+  default search patterns match the synthetic data/benchmark.osm, so
+  results for this dataset are comparable between runs and releases.
+
+  The map is imported into the given work directory, which must exist.
+
+  Example (to be executed in the Tests top level directory):
+
+  mkdir benchmark
+  src/Benchmark --output benchmark.json data/benchmark.osm ../stylesheets/map.ost ../stylesheets/standard.oss benchmark
+*/
+
+static const double DPI=96.0;
+static const size_t tileSize=256;
+static const size_t startZoom=10;
+static const size_t endZoom=18;
+static const size_t routeCount=20;
+
+static const char* const scenarioNames[]={"import",
+                                          "scanner",
+                                          "tiles",
+                                          "routing",
+                                          "location",
+                                          "classify"};
+
+static const char* const defaultSearchPatterns[]={"Synthtown",
+                                                  "Street 10 Synthtown",
+                                                  "Avenue 9 Synthtown",
+                                                  "Street 20 5 Synthtown",
+                                                  "Fuel"};
+
+/**
+  Collects the samples of all measurements in the order of their first sample
+  */
+class Statistics
+{
+private:
+  struct Measurement
+  {
+    std::string         name;
+    std::vector<double> samples;
+  };
+
+private:
+  std::vector<Measurement>     measurements;
+  std::map<std::string,size_t> measurementIndex;
+
+private:
+  static double GetPercentile(const std::vector<double>& sortedSamples,
+                              double percentile);
+  static std::string Escape(const std::string& text);
+
+public:
+  void AddSample(const std::string& name,
+                 double milliseconds);
+
+  void WriteJson(std::ostream& stream,
+                 const std::string& dataset,
+                 size_t iterations) const;
+};
+
+void Statistics::AddSample(const std::string& name,
+                           double milliseconds)
+{
+  auto entry=measurementIndex.find(name);
+
+  if (entry==measurementIndex.end()) {
+    Measurement measurement;
+
+    measurement.name=name;
+
+    entry=measurementIndex.insert(std::make_pair(name,measurements.size())).first;
+    measurements.push_back(measurement);
+  }
+
+  measurements[entry->second].samples.push_back(milliseconds);
+}
+
+/**
+  Nearest rank percentile of the given sorted samples
+  */
+double Statistics::GetPercentile(const std::vector<double>& sortedSamples,
+                                 double percentile)
+{
+  size_t rank=(size_t)ceil(percentile/100.0*sortedSamples.size());
+
+  if (rank==0) {
+    rank=1;
+  }
+
+  return sortedSamples[rank-1];
+}
+
+std::string Statistics::Escape(const std::string& text)
+{
+  std::ostringstream result;
+
+  for (const auto& c : text) {
+    if (c=='"' || c=='\\') {
+      result << '\\' << c;
+    }
+    else if ((unsigned char)c<0x20) {
+      result << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (unsigned int)c << std::dec;
+    }
+    else {
+      result << c;
+    }
+  }
+
+  return result.str();
+}
+
+void Statistics::WriteJson(std::ostream& stream,
+                           const std::string& dataset,
+                           size_t iterations) const
+{
+  stream << "{" << std::endl;
+  stream << "  \"dataset\": \"" << Escape(dataset) << "\"," << std::endl;
+  stream << "  \"iterations\": " << iterations << "," << std::endl;
+  stream << "  \"unit\": \"ms\"," << std::endl;
+  stream << "  \"results\": [";
+
+  for (size_t m=0; m<measurements.size(); m++) {
+    std::vector<double> samples(measurements[m].samples);
+    double              total=0.0;
+
+    std::sort(samples.begin(),
+              samples.end());
+
+    for (const auto& sample : samples) {
+      total+=sample;
+    }
+
+    stream << (m==0 ? "" : ",") << std::endl;
+    stream << "    {";
+    stream << "\"name\": \"" << Escape(measurements[m].name) << "\", ";
+    stream << std::fixed << std::setprecision(3);
+    stream << "\"count\": " << samples.size() << ", ";
+    stream << "\"total\": " << total << ", ";
+    stream << "\"min\": " << samples.front() << ", ";
+    stream << "\"mean\": " << total/samples.size() << ", ";
+    stream << "\"p50\": " << GetPercentile(samples,50.0) << ", ";
+    stream << "\"p90\": " << GetPercentile(samples,90.0) << ", ";
+    stream << "\"p99\": " << GetPercentile(samples,99.0) << ", ";
+    stream << "\"max\": " << samples.back();
+    stream << "}";
+  }
+
+  stream << std::endl;
+  stream << "  ]" << std::endl;
+  stream << "}" << std::endl;
+}
+
+/**
+  Measures the duration of each import step
+  */
+class ImportProgress : public osmscout::Progress
+{
+private:
+  Statistics&                          statistics;
+  bool                                 record;
+  std::string                          currentStep;
+  std::unique_ptr<osmscout::StopClock> stepTimer;
+
+public:
+  ImportProgress(Statistics& statistics,
+                 bool record)
+  : statistics(statistics),
+    record(record)
+  {
+    // no code
+  }
+
+  void Finish()
+  {
+    if (!currentStep.empty()) {
+      stepTimer->Stop();
+
+      if (record) {
+        statistics.AddSample("import/"+currentStep,
+                             stepTimer->GetMilliseconds());
+      }
+
+      currentStep.clear();
+    }
+  }
+
+  void SetStep(const std::string& step)
+  {
+    Finish();
+
+    // Only the import modules are numbered steps, see ExecuteModules()
+    if (step.compare(0,6,"Step #")==0) {
+      currentStep=step.substr(6);
+      stepTimer.reset(new osmscout::StopClock());
+    }
+  }
+
+  void Error(const std::string& text)
+  {
+    std::cerr << "Import error: " << text << std::endl;
+  }
+};
+
+static bool RunImport(const std::string& mapfile,
+                      const std::string& typefile,
+                      const std::string& directory,
+                      Statistics& statistics,
+                      bool record)
+{
+  osmscout::ImportParameter parameter;
+  ImportProgress            progress(statistics,
+                                     record);
+  std::list<std::string>    mapfiles;
+
+  mapfiles.push_back(mapfile);
+
+  parameter.SetMapfiles(mapfiles);
+  parameter.SetTypefile(typefile);
+  parameter.SetDestinationDirectory(directory);
+
+  osmscout::StopClock timer;
+
+  bool result=osmscout::Import(parameter,
+                               progress);
+
+  timer.Stop();
+  progress.Finish();
+
+  if (result && record) {
+    statistics.AddSample("import/total",
+                         timer.GetMilliseconds());
+  }
+
+  return result;
+}
+
+template<class T>
+static bool ScanFile(const osmscout::TypeConfig& typeConfig,
+                     const std::string& directory,
+                     const std::string& filename,
+                     Statistics& statistics)
+{
+  osmscout::FileScanner scanner;
+  uint32_t              count;
+  osmscout::StopClock   timer;
+
+  if (!scanner.Open(osmscout::AppendFileToDir(directory,
+                                              filename),
+                    osmscout::FileScanner::Sequential,
+                    true)) {
+    std::cerr << "Cannot open '" << scanner.GetFilename() << "'" << std::endl;
+    return false;
+  }
+
+  if (!scanner.Read(count)) {
+    std::cerr << "Error while reading '" << scanner.GetFilename() << "'" << std::endl;
+    return false;
+  }
+
+  for (uint32_t i=1; i<=count; i++) {
+    T object;
+
+    if (!object.Read(typeConfig,
+                     scanner)) {
+      std::cerr << "Error while reading '" << scanner.GetFilename() << "'" << std::endl;
+      return false;
+    }
+  }
+
+  if (!scanner.Close()) {
+    return false;
+  }
+
+  timer.Stop();
+
+  statistics.AddSample("scanner/"+filename,
+                       timer.GetMilliseconds());
+
+  return true;
+}
+
+static bool RunScanner(const osmscout::DatabaseRef& database,
+                       const std::string& directory,
+                       Statistics& statistics)
+{
+  osmscout::TypeConfigRef typeConfig=database->GetTypeConfig();
+
+  return ScanFile<osmscout::Node>(*typeConfig,directory,"nodes.dat",statistics) &&
+         ScanFile<osmscout::Way>(*typeConfig,directory,"ways.dat",statistics) &&
+         ScanFile<osmscout::Area>(*typeConfig,directory,"areas.dat",statistics);
+}
+
+static bool RunTiles(const osmscout::DatabaseRef& database,
+                     const osmscout::StyleConfigRef& styleConfig,
+                     Statistics& statistics)
+{
+  osmscout::MapServiceRef       mapService(new osmscout::MapService(database));
+  osmscout::AreaSearchParameter searchParameter;
+  osmscout::GeoBox              boundingBox;
+
+  if (!database->GetBoundingBox(boundingBox)) {
+    std::cerr << "Cannot load bounding box of database" << std::endl;
+    return false;
+  }
+
+#if defined(HAVE_LIB_OSMSCOUTMAPCAIRO)
+  cairo_surface_t           *surface=cairo_image_surface_create(CAIRO_FORMAT_RGB24,tileSize,tileSize);
+  cairo_t                   *cairo=cairo_create(surface);
+  osmscout::MapPainterCairo painter(styleConfig);
+  osmscout::MapParameter    drawParameter;
+#endif
+
+  for (size_t zoom=startZoom; zoom<=endZoom; zoom++) {
+    osmscout::Magnification magnification;
+
+    magnification.SetLevel(zoom);
+
+    size_t      xTileStart=osmscout::LonToTileX(boundingBox.GetMinLon(),magnification);
+    size_t      xTileEnd=osmscout::LonToTileX(boundingBox.GetMaxLon(),magnification);
+    size_t      yTileStart=osmscout::LatToTileY(boundingBox.GetMaxLat(),magnification);
+    size_t      yTileEnd=osmscout::LatToTileY(boundingBox.GetMinLat(),magnification);
+    std::string name="tiles/zoom-"+osmscout::NumberToString(zoom);
+
+    for (size_t y=yTileStart; y<=yTileEnd; y++) {
+      for (size_t x=xTileStart; x<=xTileEnd; x++) {
+        osmscout::TileProjection projection;
+        osmscout::MapData        data;
+
+        projection.Set(x,
+                       y,
+                       magnification,
+                       DPI,
+                       tileSize,
+                       tileSize);
+
+        osmscout::StopClock dbTimer;
+
+        if (!mapService->GetObjects(searchParameter,
+                                    *styleConfig,
+                                    projection,
+                                    data)) {
+          std::cerr << "Cannot load data for tile " << x << "," << y << " of zoom " << zoom << std::endl;
+          return false;
+        }
+
+        dbTimer.Stop();
+
+        statistics.AddSample(name+"/GetObjects",
+                             dbTimer.GetMilliseconds());
+
+#if defined(HAVE_LIB_OSMSCOUTMAPCAIRO)
+        osmscout::StopClock drawTimer;
+
+        painter.DrawMap(projection,
+                        drawParameter,
+                        data,
+                        cairo);
+
+        drawTimer.Stop();
+
+        statistics.AddSample(name+"/DrawMap",
+                             drawTimer.GetMilliseconds());
+#endif
+      }
+    }
+  }
+
+#if defined(HAVE_LIB_OSMSCOUTMAPCAIRO)
+  cairo_destroy(cairo);
+  cairo_surface_destroy(surface);
+#endif
+
+  return true;
+}
+
+static void GetCarSpeedTable(std::map<std::string,double>& map)
+{
+  map["highway_motorway"]=110.0;
+  map["highway_motorway_trunk"]=100.0;
+  map["highway_motorway_primary"]=70.0;
+  map["highway_motorway_link"]=60.0;
+  map["highway_motorway_junction"]=60.0;
+  map["highway_trunk"]=100.0;
+  map["highway_trunk_link"]=60.0;
+  map["highway_primary"]=70.0;
+  map["highway_primary_link"]=60.0;
+  map["highway_secondary"]=60.0;
+  map["highway_secondary_link"]=50.0;
+  map["highway_tertiary_link"]=55.0;
+  map["highway_tertiary"]=55.0;
+  map["highway_unclassified"]=50.0;
+  map["highway_road"]=50.0;
+  map["highway_residential"]=40.0;
+  map["highway_roundabout"]=40.0;
+  map["highway_living_street"]=10.0;
+  map["highway_service"]=30.0;
+}
+
+static bool RunRouting(const osmscout::DatabaseRef& database,
+                       Statistics& statistics)
+{
+  osmscout::TypeConfigRef             typeConfig=database->GetTypeConfig();
+  osmscout::FastestPathRoutingProfile routingProfile(typeConfig);
+  osmscout::RouterParameter           routerParameter;
+  osmscout::RoutingService            router(database,
+                                             routerParameter,
+                                             osmscout::vehicleCar);
+  std::map<std::string,double>        speedTable;
+  osmscout::GeoBox                    boundingBox;
+
+  if (!database->GetBoundingBox(boundingBox)) {
+    std::cerr << "Cannot load bounding box of database" << std::endl;
+    return false;
+  }
+
+  if (!router.Open()) {
+    std::cerr << "Cannot open routing database" << std::endl;
+    return false;
+  }
+
+  GetCarSpeedTable(speedTable);
+
+  routingProfile.ParametrizeForCar(*typeConfig,
+                                   speedTable,
+                                   160.0);
+
+  // Same positions in each iteration and each run
+  std::mt19937                           generator(1);
+  std::uniform_real_distribution<double> latDistribution(boundingBox.GetMinLat(),
+                                                         boundingBox.GetMaxLat());
+  std::uniform_real_distribution<double> lonDistribution(boundingBox.GetMinLon(),
+                                                         boundingBox.GetMaxLon());
+
+  for (size_t r=0; r<routeCount; r++) {
+    double                  startLat=latDistribution(generator);
+    double                  startLon=lonDistribution(generator);
+    double                  targetLat=latDistribution(generator);
+    double                  targetLon=lonDistribution(generator);
+    osmscout::ObjectFileRef startObject;
+    size_t                  startNodeIndex;
+    osmscout::ObjectFileRef targetObject;
+    size_t                  targetNodeIndex;
+    osmscout::RouteData     data;
+    osmscout::StopClock     timer;
+
+    if (!router.GetClosestRoutableNode(startLat,
+                                       startLon,
+                                       osmscout::vehicleCar,
+                                       1000,
+                                       startObject,
+                                       startNodeIndex) ||
+        !router.GetClosestRoutableNode(targetLat,
+                                       targetLon,
+                                       osmscout::vehicleCar,
+                                       1000,
+                                       targetObject,
+                                       targetNodeIndex)) {
+      std::cerr << "Error while searching for routing nodes" << std::endl;
+      router.Close();
+      return false;
+    }
+
+    if (startObject.Invalid() ||
+        targetObject.Invalid()) {
+      continue;
+    }
+
+    if (!router.CalculateRoute(routingProfile,
+                               startObject,
+                               startNodeIndex,
+                               targetObject,
+                               targetNodeIndex,
+                               data)) {
+      std::cerr << "Error while calculating route" << std::endl;
+      router.Close();
+      return false;
+    }
+
+    timer.Stop();
+
+    statistics.AddSample("routing/car",
+                         timer.GetMilliseconds());
+  }
+
+  router.Close();
+
+  return true;
+}
+
+static bool RunLocation(const osmscout::DatabaseRef& database,
+                        const std::list<std::string>& searchPatterns,
+                        Statistics& statistics)
+{
+  osmscout::LocationServiceRef locationService(new osmscout::LocationService(database));
+
+  for (const auto& pattern : searchPatterns) {
+    osmscout::LocationSearch       search;
+    osmscout::LocationSearchResult searchResult;
+    osmscout::StopClock            timer;
+
+    search.limit=50;
+
+    if (!locationService->InitializeLocationSearchEntries(pattern,
+                                                          search) ||
+        !locationService->SearchForLocations(search,
+                                             searchResult)) {
+      std::cerr << "Error while searching for '" << pattern << "'" << std::endl;
+      return false;
+    }
+
+    timer.Stop();
+
+    statistics.AddSample("location/"+pattern,
+                         timer.GetMilliseconds());
+  }
+
+  return true;
+}
+
+/**
+  Collects the tags of all nodes, ways and relations of an OSM file
+  */
+class TagCollector : public osmscout::PreprocessorCallback
+{
+public:
+  std::vector<osmscout::TagMap> nodeTags;
+  std::vector<osmscout::TagMap> wayTags;
+  std::vector<osmscout::TagMap> relationTags;
+
+public:
+  void ProcessNode(const osmscout::OSMId& /*id*/,
+                   const double& /*lon*/,
+                   const double& /*lat*/,
+                   const osmscout::TagMap& tags)
+  {
+    nodeTags.push_back(tags);
+  }
+
+  void ProcessWay(const osmscout::OSMId& /*id*/,
+                  std::vector<osmscout::OSMId>& /*nodes*/,
+                  const osmscout::TagMap& tags)
+  {
+    wayTags.push_back(tags);
+  }
+
+  void ProcessRelation(const osmscout::OSMId& /*id*/,
+                       const std::vector<osmscout::RawRelation::Member>& /*members*/,
+                       const osmscout::TagMap& tags)
+  {
+    relationTags.push_back(tags);
+  }
+};
+
+static bool LoadTags(const std::string& mapfile,
+                     const osmscout::TypeConfigRef& typeConfig,
+                     Statistics& statistics,
+                     TagCollector& tags)
+{
+  osmscout::ImportParameter parameter;
+  ImportProgress            progress(statistics,
+                                     false);
+  std::list<std::string>    mapfiles;
+
+  mapfiles.push_back(mapfile);
+
+  parameter.SetMapfiles(mapfiles);
+
+  return osmscout::Preprocess::ProcessFiles(typeConfig,
+                                            parameter,
+                                            progress,
+                                            tags);
+}
+
+static void ClassifyTags(const osmscout::TypeConfig& typeConfig,
+                         const TagCollector& tags,
+                         std::vector<osmscout::TypeInfoRef>& types)
+{
+  types.clear();
+  types.reserve(tags.nodeTags.size()+2*tags.wayTags.size()+tags.relationTags.size());
+
+  for (const auto& tagMap : tags.nodeTags) {
+    types.push_back(typeConfig.GetNodeType(tagMap));
+  }
+
+  for (const auto& tagMap : tags.wayTags) {
+    osmscout::TypeInfoRef wayType;
+    osmscout::TypeInfoRef areaType;
+
+    typeConfig.GetWayAreaType(tagMap,
+                              wayType,
+                              areaType);
+
+    types.push_back(wayType);
+    types.push_back(areaType);
+  }
+
+  for (const auto& tagMap : tags.relationTags) {
+    types.push_back(typeConfig.GetRelationType(tagMap));
+  }
+}
+
+static bool RunClassify(const osmscout::TypeConfigRef& typeConfig,
+                        const TagCollector& tags,
+                        Statistics& statistics)
+{
+  std::vector<osmscout::TypeInfoRef> compiledTypes;
+  std::vector<osmscout::TypeInfoRef> evaluatedTypes;
+
+  osmscout::StopClock compileTimer;
+
+  typeConfig->CompileConditions();
+
+  compileTimer.Stop();
+
+  osmscout::StopClock compiledTimer;
+
+  ClassifyTags(*typeConfig,
+               tags,
+               compiledTypes);
+
+  compiledTimer.Stop();
+
+  typeConfig->ClearCompiledConditions();
+
+  osmscout::StopClock evaluatedTimer;
+
+  ClassifyTags(*typeConfig,
+               tags,
+               evaluatedTypes);
+
+  evaluatedTimer.Stop();
+
+  typeConfig->CompileConditions();
+
+  size_t differences=0;
+
+  for (size_t i=0; i<compiledTypes.size(); i++) {
+    if (compiledTypes[i]!=evaluatedTypes[i]) {
+      differences++;
+    }
+  }
+
+  if (differences>0) {
+    std::cerr << "Compiled type conditions assign different types to " << differences << " of " << compiledTypes.size() << " objects" << std::endl;
+    return false;
+  }
+
+  statistics.AddSample("classify/compile",
+                       compileTimer.GetMilliseconds());
+  statistics.AddSample("classify/compiled",
+                       compiledTimer.GetMilliseconds());
+  statistics.AddSample("classify/evaluated",
+                       evaluatedTimer.GetMilliseconds());
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t                 iterations=5;
+  std::string            output;
+  std::set<std::string>  scenarios;
+  std::list<std::string> searchPatterns;
+
+  int currentArg=1;
+
+  while (currentArg<argc &&
+         strncmp(argv[currentArg],"--",2)==0) {
+    if (strcmp(argv[currentArg],"--iterations")==0 &&
+        currentArg+1<argc) {
+      if (sscanf(argv[currentArg+1],"%zu",&iterations)!=1 ||
+          iterations==0) {
+        std::cerr << "iterations is not a positive number!" << std::endl;
+        return 1;
+      }
+    }
+    else if (strcmp(argv[currentArg],"--scenario")==0 &&
+             currentArg+1<argc) {
+      if (std::find_if(std::begin(scenarioNames),
+                       std::end(scenarioNames),
+                       [&](const char* name) {
+                         return strcmp(name,argv[currentArg+1])==0;
+                       })==std::end(scenarioNames)) {
+        std::cerr << "Unknown scenario '" << argv[currentArg+1] << "'" << std::endl;
+        return 1;
+      }
+
+      scenarios.insert(argv[currentArg+1]);
+    }
+    else if (strcmp(argv[currentArg],"--search")==0 &&
+             currentArg+1<argc) {
+      searchPatterns.push_back(argv[currentArg+1]);
+    }
+    else if (strcmp(argv[currentArg],"--output")==0 &&
+             currentArg+1<argc) {
+      output=argv[currentArg+1];
+    }
+    else {
+      std::cerr << "Unknown option '" << argv[currentArg] << "'" << std::endl;
+      return 1;
+    }
+
+    currentArg+=2;
+  }
+
+  if (argc-currentArg!=4) {
+    std::cerr << "Benchmark [--iterations <count>] {--scenario <name>} {--search <pattern>} [--output <json file>] ";
+    std::cerr << "<osm file> <type file> <style file> <work directory>" << std::endl;
+    std::cerr << "Scenarios:";
+    for (const auto& name : scenarioNames) {
+      std::cerr << " " << name;
+    }
+    std::cerr << std::endl;
+    return 1;
+  }
+
+  std::string mapfile=argv[currentArg];
+  std::string typefile=argv[currentArg+1];
+  std::string stylefile=argv[currentArg+2];
+  std::string directory=argv[currentArg+3];
+
+  if (scenarios.empty()) {
+    scenarios.insert(std::begin(scenarioNames),
+                     std::end(scenarioNames));
+  }
+
+  if (searchPatterns.empty()) {
+    searchPatterns.insert(searchPatterns.end(),
+                          std::begin(defaultSearchPatterns),
+                          std::end(defaultSearchPatterns));
+  }
+
+  Statistics statistics;
+  bool       measureImport=scenarios.find("import")!=scenarios.end();
+
+  // The other scenarios need the imported map, so always import at least once
+  for (size_t i=0; i<(measureImport ? iterations : 1); i++) {
+    std::cerr << "Importing '" << mapfile << "' (" << i+1 << ")..." << std::endl;
+
+    if (!RunImport(mapfile,
+                   typefile,
+                   directory,
+                   statistics,
+                   measureImport)) {
+      std::cerr << "Cannot import '" << mapfile << "'" << std::endl;
+      return 1;
+    }
+  }
+
+  osmscout::TypeConfigRef classifyTypeConfig;
+  TagCollector            classifyTags;
+
+  if (scenarios.find("classify")!=scenarios.end()) {
+    classifyTypeConfig=std::make_shared<osmscout::TypeConfig>();
+
+    if (!classifyTypeConfig->LoadFromOSTFile(typefile)) {
+      std::cerr << "Cannot load type file '" << typefile << "'" << std::endl;
+      return 1;
+    }
+
+    if (!LoadTags(mapfile,
+                  classifyTypeConfig,
+                  statistics,
+                  classifyTags)) {
+      std::cerr << "Cannot read tags from '" << mapfile << "'" << std::endl;
+      return 1;
+    }
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(directory)) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::StyleConfigRef styleConfig(new osmscout::StyleConfig(database->GetTypeConfig()));
+
+  if (!styleConfig->Load(stylefile)) {
+    std::cerr << "Cannot open style" << std::endl;
+    return 1;
+  }
+
+  for (size_t i=0; i<iterations; i++) {
+    std::cerr << "Iteration " << i+1 << " of " << iterations << "..." << std::endl;
+
+    if (scenarios.find("scanner")!=scenarios.end() &&
+        !RunScanner(database,
+                    directory,
+                    statistics)) {
+      return 1;
+    }
+
+    if (scenarios.find("tiles")!=scenarios.end() &&
+        !RunTiles(database,
+                  styleConfig,
+                  statistics)) {
+      return 1;
+    }
+
+    if (scenarios.find("routing")!=scenarios.end() &&
+        !RunRouting(database,
+                    statistics)) {
+      return 1;
+    }
+
+    if (scenarios.find("location")!=scenarios.end() &&
+        !RunLocation(database,
+                     searchPatterns,
+                     statistics)) {
+      return 1;
+    }
+
+    if (scenarios.find("classify")!=scenarios.end() &&
+        !RunClassify(classifyTypeConfig,
+                     classifyTags,
+                     statistics)) {
+      return 1;
+    }
+  }
+
+  database->Close();
+
+  if (output.empty()) {
+    statistics.WriteJson(std::cout,
+                         mapfile,
+                         iterations);
+  }
+  else {
+    std::ofstream stream(output.c_str());
+
+    statistics.WriteJson(stream,
+                         mapfile,
+                         iterations);
+
+    if (!stream) {
+      std::cerr << "Cannot write '" << output << "'" << std::endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -17,20 +17,80 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include <osmscout/Way.h>
 
+#include <osmscout/system/Math.h>
+
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Number.h>
 #include <osmscout/util/StopClock.h>
 
 /**
   Sequentially read the ways.dat file in the current directory first using
   FileReader and then using FileScanner and compare execution time.
 
+  Afterwards the coordinate values of all ways are decoded from memory,
+  first number by number using ReadNumber() and then in bulk using
+  ReadNumbers(), to compare the speed of both variants.
+
   Call this program repeately to avoid different timing because of OS file caching.
 */
 
+static const size_t decodeRounds=20;
+
+static bool DecodeSingle(osmscout::FileScanner& scanner,
+                         std::vector<char>& buffer,
+                         size_t numberCount,
+                         uint64_t& sum)
+{
+  for (size_t r=0; r<decodeRounds; r++) {
+    scanner.SetWindow(0,buffer.data(),buffer.size());
+
+    for (size_t i=0; i<numberCount; i++) {
+      uint32_t value;
+
+      if (!scanner.ReadNumber(value)) {
+        return false;
+      }
+
+      sum+=value;
+    }
+  }
+
+  return true;
+}
+
+static bool DecodeBulk(osmscout::FileScanner& scanner,
+                       std::vector<char>& buffer,
+                       size_t numberCount,
+                       uint64_t& sum)
+{
+  const size_t chunkSize=128;
+  uint32_t     values[chunkSize];
+
+  for (size_t r=0; r<decodeRounds; r++) {
+    scanner.SetWindow(0,buffer.data(),buffer.size());
+
+    for (size_t start=0; start<numberCount; start+=chunkSize) {
+      size_t count=std::min(chunkSize,numberCount-start);
+
+      if (!scanner.ReadNumbers(values,count)) {
+        return false;
+      }
+
+      for (size_t i=0; i<count; i++) {
+        sum+=values[i];
+      }
+    }
+  }
+
+  return true;
+}
+
 int main(int argc, char* argv[])
 {
   std::string           wayFilename="ways.dat";
@@ -59,11 +119,35 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  // Coordinate values of all ways, encoded like in the data file
+  std::vector<char> numbers;
+  size_t            numberCount=0;
+
   for (size_t w=1; w<=wayCount; w++) {
     osmscout::Way way;
 
     if (way.Read(typeConfig,
                  scanner)) {
+      uint32_t minLat=way.nodes[0].GetFixedLat();
+      uint32_t minLon=way.nodes[0].GetFixedLon();
+
+      for (const auto& node : way.nodes) {
+        minLat=std::min(minLat,node.GetFixedLat());
+        minLon=std::min(minLon,node.GetFixedLon());
+      }
+
+      for (const auto& node : way.nodes) {
+        char data[5];
+
+        numbers.insert(numbers.end(),
+                       data,
+                       data+osmscout::EncodeNumber(node.GetFixedLat()-minLat,data));
+        numbers.insert(numbers.end(),
+                       data,
+                       data+osmscout::EncodeNumber(node.GetFixedLon()-minLon,data));
+
+        numberCount+=2;
+      }
     }
   }
 
@@ -73,5 +157,45 @@ int main(int argc, char* argv[])
 
   std::cout << "Reading " << wayCount << " ways via FileScanner took " << scannerTimer << std::endl;
 
+  if (numberCount==0) {
+    return 0;
+  }
+
+  if (!scanner.Open(wayFilename,osmscout::FileScanner::Sequential,false)) {
+    std::cerr << "Cannot open of file '" << wayFilename << "'!" << std::endl;
+    return 1;
+  }
+
+  uint64_t            singleSum=0;
+  osmscout::StopClock singleTimer;
+
+  if (!DecodeSingle(scanner,numbers,numberCount,singleSum)) {
+    std::cerr << "Cannot decode numbers!" << std::endl;
+    return 1;
+  }
+
+  singleTimer.Stop();
+
+  uint64_t            bulkSum=0;
+  osmscout::StopClock bulkTimer;
+
+  if (!DecodeBulk(scanner,numbers,numberCount,bulkSum)) {
+    std::cerr << "Cannot decode numbers!" << std::endl;
+    return 1;
+  }
+
+  bulkTimer.Stop();
+
+  scanner.ClearWindow();
+  scanner.Close();
+
+  if (singleSum!=bulkSum) {
+    std::cerr << "Decoded numbers differ!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Decoding " << decodeRounds << "x" << numberCount << " coordinate values (" << numbers.size() << " bytes) number by number took " << singleTimer << std::endl;
+  std::cout << "Decoding " << decodeRounds << "x" << numberCount << " coordinate values (" << numbers.size() << " bytes) in bulk took " << bulkTimer << std::endl;
+
   return 0;
 }
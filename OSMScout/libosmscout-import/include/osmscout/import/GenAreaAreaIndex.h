@@ -20,54 +20,12 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
-#include <map>
-#include <set>
-
-#include <osmscout/Pixel.h>
-
-#include <osmscout/util/FileWriter.h>
-#include <osmscout/util/Geometry.h>
-
 #include <osmscout/import/Import.h>
 
 namespace osmscout {
 
   class AreaAreaIndexGenerator : public ImportModule
   {
-  private:
-    struct Entry
-    {
-      TypeId     type;
-      FileOffset offset;
-    };
-
-    struct AreaLeaf
-    {
-      FileOffset       offset;
-      std::list<Entry> areas;
-      FileOffset       children[4];
-
-      AreaLeaf()
-      {
-        offset=0;
-        children[0]=0;
-        children[1]=0;
-        children[2]=0;
-        children[3]=0;
-      }
-    };
-
-  private:
-    void SetOffsetOfChildren(const std::map<Pixel,AreaLeaf>& leafs,
-                             std::map<Pixel,AreaLeaf>& newAreaLeafs);
-
-    bool WriteIndexLevel(const TypeConfigRef& typeConfig,
-                         const ImportParameter& parameter,
-                         FileWriter& writer,
-                         size_t level,
-                         std::map<Pixel,AreaLeaf>& leafs);
-
-
   public:
     std::string GetDescription() const;
     bool Import(const TypeConfigRef& typeConfig,
@@ -0,0 +1,42 @@
+#ifndef OSMSCOUT_IMPORT_GENAREAAREARTREEINDEX_H
+#define OSMSCOUT_IMPORT_GENAREAAREARTREEINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Generates the packed Hilbert R-tree of AreaAreaRTreeIndex, if enabled by
+   * ImportParameter::SetAreaAreaIndexRTree(). Else an existing R-tree of a
+   * previous import is deleted.
+   */
+  class AreaAreaRTreeIndexGenerator : public ImportModule
+  {
+  public:
+    std::string GetDescription() const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
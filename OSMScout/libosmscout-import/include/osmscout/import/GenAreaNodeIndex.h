@@ -40,7 +40,7 @@ namespace osmscout {
       uint32_t   cellXCount;
       uint32_t   cellYCount;
 
-      FileOffset indexOffset; //! Position in file where the offset of the bitmap is written
+      FileOffset indexOffset; //! Position in file where the offset of the cell directory is written
 
       TypeData();
 
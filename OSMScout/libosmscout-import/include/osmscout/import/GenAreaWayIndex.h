@@ -25,6 +25,7 @@
 #include <list>
 #include <map>
 
+#include <osmscout/CellDirectory.h>
 #include <osmscout/Pixel.h>
 
 #include <osmscout/util/FileWriter.h>
@@ -36,7 +37,7 @@ namespace osmscout {
   {
   private:
     typedef std::map<Pixel,size_t>                 CoordCountMap;
-    typedef std::map<Pixel,std::list<FileOffset> > CoordOffsetsMap;
+    typedef CellDirectory::CellOffsetsMap          CoordOffsetsMap;
 
     struct TypeData
     {
@@ -51,7 +52,7 @@ namespace osmscout {
       uint32_t   cellXCount;
       uint32_t   cellYCount;
 
-      FileOffset indexOffset; //! Position in file where the offset of the bitmap is written to
+      FileOffset indexOffset; //! Position in file where the offset of the cell directory is written to
 
       TypeData();
 
@@ -79,11 +80,11 @@ namespace osmscout {
                                std::vector<TypeData>& wayTypeData,
                                size_t& maxLevel) const;
 
-    bool WriteBitmap(Progress& progress,
-                     FileWriter& writer,
-                     const TypeInfo& typeInfo,
-                     const TypeData& typeData,
-                     const CoordOffsetsMap& typeCellOffsets);
+    bool WriteCells(Progress& progress,
+                    FileWriter& writer,
+                    const TypeInfo& typeInfo,
+                    const TypeData& typeData,
+                    const CoordOffsetsMap& typeCellOffsets);
 
   public:
     std::string GetDescription() const;
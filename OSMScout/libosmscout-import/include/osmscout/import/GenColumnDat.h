@@ -0,0 +1,149 @@
+#ifndef OSMSCOUT_IMPORT_GENCOLUMNDAT_H
+#define OSMSCOUT_IMPORT_GENCOLUMNDAT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+
+#include <osmscout/Area.h>
+#include <osmscout/ColumnDataFile.h>
+#include <osmscout/Node.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/import/SortDat.h>
+
+namespace osmscout {
+
+  /**
+   * Sort filter writing a columnar copy of the sorted data file using
+   * ColumnDataWriter, if enabled by ImportParameter::SetColumnStore(). Else
+   * an existing columnar file of a previous import is deleted.
+   *
+   * The filter must be the last filter of the sort step, so that it only
+   * sees objects that are actually written to the data file.
+   */
+  template <class N>
+  class ColumnDataProcessorFilter : public SortDataGenerator<N>::ProcessingFilter
+  {
+  private:
+    std::string      filename;
+    RefType          objectType;
+    bool             enabled;
+    ColumnDataWriter writer;
+
+  public:
+    ColumnDataProcessorFilter(const std::string& filename,
+                              RefType objectType);
+
+    bool BeforeProcessingStart(const ImportParameter& parameter,
+                               Progress& progress,
+                               const TypeConfig& typeConfig);
+    bool Process(Progress& progress,
+                 const FileOffset& offset,
+                 N& data,
+                 bool& save);
+    bool AfterProcessingEnd(const ImportParameter& parameter,
+                            Progress& progress,
+                            const TypeConfig& typeConfig);
+  };
+
+  template <class N>
+  ColumnDataProcessorFilter<N>::ColumnDataProcessorFilter(const std::string& filename,
+                                                          RefType objectType)
+  : filename(filename),
+    objectType(objectType),
+    enabled(false)
+  {
+    // no code
+  }
+
+  template <class N>
+  bool ColumnDataProcessorFilter<N>::BeforeProcessingStart(const ImportParameter& parameter,
+                                                           Progress& progress,
+                                                           const TypeConfig& /*typeConfig*/)
+  {
+    std::string path=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     filename);
+
+    enabled=parameter.GetColumnStore();
+
+    if (!enabled) {
+      FileOffset size;
+
+      // Do not leave an outdated file of a previous import behind
+      if (GetFileSize(path,
+                      size)) {
+        progress.Info(std::string("Removing '")+filename+"'");
+
+        if (!RemoveFile(path)) {
+          progress.Error(std::string("Cannot remove '")+path+"'");
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    if (!writer.Open(path,
+                     objectType)) {
+      progress.Error(std::string("Cannot create '")+path+"'");
+      return false;
+    }
+
+    return true;
+  }
+
+  template <class N>
+  bool ColumnDataProcessorFilter<N>::Process(Progress& progress,
+                                             const FileOffset& offset,
+                                             N& data,
+                                             bool& save)
+  {
+    if (!enabled ||
+        !save) {
+      return true;
+    }
+
+    if (!writer.Add(offset,
+                    data)) {
+      progress.Error(std::string("Error while writing data entry to file '")+
+                     writer.GetFilename()+"'");
+      return false;
+    }
+
+    return true;
+  }
+
+  template <class N>
+  bool ColumnDataProcessorFilter<N>::AfterProcessingEnd(const ImportParameter& /*parameter*/,
+                                                        Progress& progress,
+                                                        const TypeConfig& /*typeConfig*/)
+  {
+    if (!enabled) {
+      return true;
+    }
+
+    progress.Info(NumberToString(writer.GetObjectCount())+" object(s) written to file '"+writer.GetFilename()+"'");
+
+    return writer.Close();
+  }
+}
+
+#endif
@@ -20,15 +20,21 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <map>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <osmscout/Node.h>
 #include <osmscout/Area.h>
 #include <osmscout/Way.h>
 
+#include <osmscout/LocationTokenIndex.h>
 #include <osmscout/ObjectRef.h>
 
+#include <osmscout/util/GeoBox.h>
+
 #include <osmscout/import/Import.h>
 
 namespace osmscout {
@@ -74,15 +80,21 @@ namespace osmscout {
 
     struct RegionLocation
     {
-      FileOffset               addressOffset; //!< Offset of place where the address list offset is stored
-      std::list<ObjectFileRef> objects;       //!< Objects that represent this location
-      std::list<RegionAddress> addresses;     //!< Addresses at this location
+      FileOffset               locationOffset; //!< Offset of the location in the index file
+      FileOffset               addressOffset;  //!< Offset of place where the address list offset is stored
+      std::list<ObjectFileRef> objects;        //!< Objects that represent this location
+      std::list<RegionAddress> addresses;      //!< Addresses at this location
     };
 
     struct Region;
 
     typedef Ref<Region> RegionRef;
 
+    /**
+     * Sorted ids of the location token index entries for each index term
+     */
+    typedef std::map<std::string,std::vector<uint32_t> > TermEntryIdsMap;
+
     /**
       An area. An area is a administrative region, a city, a country, ...
       An area can have child areas (suburbs, ...).
@@ -91,24 +103,24 @@ namespace osmscout {
       */
     struct Region : public Referencable
     {
-      FileOffset                           indexOffset; //!< Offset into the index file
-      FileOffset                           dataOffset;  //!< Offset into the index file
+      FileOffset                                 indexOffset; //!< Offset into the index file
+      FileOffset                                 dataOffset;  //!< Offset into the index file
 
-      ObjectFileRef                        reference;   //!< Reference to the object this area is based on
-      std::string                          name;        //!< The name of this area
+      ObjectFileRef                              reference;   //!< Reference to the object this area is based on
+      std::string                                name;        //!< The name of this area
 
-      std::list<RegionAlias>               aliases;     //!< Location that are represented by this region
-      std::vector<std::vector<GeoCoord> >  areas;       //!< the geometric area of this region
+      std::list<RegionAlias>                     aliases;     //!< Location that are represented by this region
+      std::vector<std::vector<CompactGeoCoord> > areas;       //!< the geometric area of this region
 
-      double                               minlon;
-      double                               minlat;
-      double                               maxlon;
-      double                               maxlat;
+      double                                     minlon;
+      double                                     minlat;
+      double                                     maxlon;
+      double                                     maxlat;
 
-      std::list<RegionPOI>                 pois;        //!< A list of POIs in this region
-      std::map<std::string,RegionLocation> locations;   //!< list of indexed objects in this region
+      std::list<RegionPOI>                       pois;        //!< A list of POIs in this region
+      std::map<std::string,RegionLocation>       locations;   //!< list of indexed objects in this region
 
-      std::list<RegionRef>                 regions;     //!< A list of sub regions
+      std::list<RegionRef>                       regions;     //!< A list of sub regions
 
       void CalculateMinMax()
       {
@@ -139,10 +151,10 @@ namespace osmscout {
 
     struct Boundary
     {
-      ObjectFileRef                       reference;
-      std::string                         name;
-      size_t                              level;
-      std::vector<std::vector<GeoCoord> > areas;
+      ObjectFileRef                              reference;
+      std::string                                name;
+      size_t                                     level;
+      std::vector<std::vector<CompactGeoCoord> > areas;
     };
 
     class RegionIndex
@@ -153,8 +165,26 @@ namespace osmscout {
       double                                cellHeight;
 
     public:
-      RegionRef GetRegionForNode(RegionRef& rootRegion,
-                                 const GeoCoord& coord) const;
+      Pixel GetCell(const GeoCoord& coord) const;
+
+      Region& GetRegionForNode(Region& rootRegion,
+                               const GeoCoord& coord) const;
+    };
+
+    /**
+     * An object of the currently processed block that must be sorted into the region tree.
+     * The regions are looked up in parallel, the objects are added to the found regions
+     * afterwards in file order.
+     */
+    struct BlockObject
+    {
+      ObjectFileRef                object;      //!< The object itself
+      std::string                  name;        //!< Name of the location, alias or POI
+      std::string                  location;    //!< Street of the address
+      std::string                  address;     //!< House number of the address
+      std::vector<CompactGeoCoord> nodes;       //!< Geometry of the object, a single coordinate for nodes
+      GeoBox                       boundingBox; //!< Bounding box of the geometry
+      std::vector<Region*>         regions;     //!< Regions the object must be added to, in insertion order
     };
 
     /**
@@ -234,9 +264,26 @@ namespace osmscout {
     void IndexRegions(const std::vector<std::list<RegionRef> >& regionTree,
                       RegionIndex& regionIndex);
 
-    void AddAliasToRegion(Region& region,
-                          const RegionAlias& location,
-                          const GeoCoord& node);
+    void GetBlockBuckets(const RegionIndex& regionIndex,
+                         const std::vector<BlockObject>& block,
+                         std::vector<std::vector<size_t> >& buckets);
+
+    Region& FindRegionForCoord(Region& region,
+                               const GeoCoord& coord);
+
+    Region& FindRegionForArea(Region& region,
+                              const std::vector<CompactGeoCoord>& nodes,
+                              const GeoBox& boundingBox);
+
+    bool FindRegionsForLocationArea(Region& region,
+                                    const std::vector<CompactGeoCoord>& nodes,
+                                    const GeoBox& boundingBox,
+                                    std::vector<Region*>& regions);
+
+    bool FindRegionsForWay(Region& region,
+                           const std::vector<CompactGeoCoord>& nodes,
+                           const GeoBox& boundingBox,
+                           std::vector<Region*>& regions);
 
     bool IndexRegionNodes(const TypeConfigRef& typeConfig,
                           const ImportParameter& parameter,
@@ -244,64 +291,30 @@ namespace osmscout {
                           RegionRef& rootRegion,
                           const RegionIndex& regionIndex);
 
-    bool AddLocationAreaToRegion(Region& region,
-                                 const Area& area,
-                                 const std::vector<GeoCoord>& nodes,
-                                 const std::string& name,
-                                 double minlon,
-                                 double minlat,
-                                 double maxlon,
-                                 double maxlat);
-
-    void AddLocationAreaToRegion(RegionRef& rootRegion,
-                                 const Area& area,
-                                 const Area::Ring& ring,
-                                 const std::string& name,
-                                 const RegionIndex& regionIndex);
-
     bool IndexLocationAreas(const TypeConfig& typeConfig,
                             const ImportParameter& parameter,
                             Progress& progress,
                             RegionRef& rootRegion,
                             const RegionIndex& regionIndex);
 
-    bool AddLocationWayToRegion(Region& region,
-                                const Way& way,
-                                const std::string& name,
-                                double minlon,
-                                double minlat,
-                                double maxlon,
-                                double maxlat);
-
     bool IndexLocationWays(const TypeConfigRef& typeConfig,
                            const ImportParameter& parameter,
                            Progress& progress,
                            RegionRef& rootRegion,
                            const RegionIndex& regionIndex);
 
-    void AddAddressAreaToRegion(Progress& progress,
-                                Region& region,
-                                const FileOffset& fileOffset,
-                                const std::string& location,
-                                const std::string& address,
-                                const std::vector<GeoCoord>& nodes,
-                                double minlon,
-                                double minlat,
-                                double maxlon,
-                                double maxlat,
-                                bool& added);
-
-    void AddPOIAreaToRegion(Progress& progress,
+    void AddAddressToRegion(Progress& progress,
                             Region& region,
-                            const FileOffset& fileOffset,
-                            const std::string& name,
-                            const std::vector<GeoCoord>& nodes,
-                            double minlon,
-                            double minlat,
-                            double maxlon,
-                            double maxlat,
+                            const ObjectFileRef& object,
+                            const std::string& location,
+                            const std::string& address,
                             bool& added);
 
+    void AddPOIToRegion(Region& region,
+                        const ObjectFileRef& object,
+                        const std::string& name,
+                        bool& added);
+
     bool IndexAddressAreas(const TypeConfig& typeConfig,
                            const ImportParameter& parameter,
                            Progress& progress,
@@ -313,42 +326,19 @@ namespace osmscout {
                                const FileOffset& fileOffset,
                                const std::string& location,
                                const std::string& address,
-                               const std::vector<GeoCoord>& nodes,
+                               const std::vector<CompactGeoCoord>& nodes,
                                double minlon,
                                double minlat,
                                double maxlon,
                                double maxlat,
                                bool& added);
 
-    bool AddPOIWayToRegion(Progress& progress,
-                           Region& region,
-                           const FileOffset& fileOffset,
-                           const std::string& name,
-                           const std::vector<GeoCoord>& nodes,
-                           double minlon,
-                           double minlat,
-                           double maxlon,
-                           double maxlat,
-                           bool& added);
-
     bool IndexAddressWays(const TypeConfig& typeConfig,
                           const ImportParameter& parameter,
                           Progress& progress,
                           RegionRef& rootRegion,
                           const RegionIndex& regionIndex);
 
-    void AddAddressNodeToRegion(Progress& progress,
-                                Region& region,
-                                const FileOffset& fileOffset,
-                                const std::string& location,
-                                const std::string& address,
-                                bool& added);
-
-    void AddPOINodeToRegion(Region& region,
-                            const FileOffset& fileOffset,
-                            const std::string& name,
-                            bool& added);
-
     bool IndexAddressNodes(const TypeConfig& typeConfig,
                            const ImportParameter& parameter,
                            Progress& progress,
@@ -378,6 +368,21 @@ namespace osmscout {
     bool WriteAddressData(FileWriter& writer,
                           Region& root);
 
+    void AddLocationTokenIndexEntry(LocationTokenIndex::EntryType type,
+                                    FileOffset regionOffset,
+                                    FileOffset offset,
+                                    const std::set<std::string>& terms,
+                                    std::vector<LocationTokenIndex::Entry>& entries,
+                                    TermEntryIdsMap& termEntryIds);
+
+    void CollectLocationTokenIndexEntries(const Region& region,
+                                          std::vector<LocationTokenIndex::Entry>& entries,
+                                          TermEntryIdsMap& termEntryIds);
+
+    bool WriteLocationTokenIndex(const ImportParameter& parameter,
+                                 Progress& progress,
+                                 const Region& root);
+
   public:
     std::string GetDescription() const;
     bool Import(const TypeConfigRef& typeConfig,
@@ -20,13 +20,9 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
-#include <vector>
+#include <osmscout/NumericIndex.h>
 
-
-#include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
-#include <osmscout/util/FileWriter.h>
-#include <osmscout/util/Number.h>
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/String.h>
 
@@ -91,76 +87,44 @@ namespace osmscout {
     return description;
   }
 
+  /**
+    Generates a static B+-tree with fixed width entries (see NumericIndex).
+
+    The data file is scanned twice: The first scan determines the range of
+    ids, which defines the number of bytes per id. The second scan passes
+    the ids and file offsets to the NumericIndexWriter.
+    */
   template <class N,class T>
   bool NumericIndexGenerator<N,T>::Import(const TypeConfigRef& typeConfig,
                                           const ImportParameter& parameter,
                                           Progress& progress)
   {
-    FileScanner             scanner;
-    FileWriter              writer;
-
-    uint32_t                dataCount;
-
-    std::vector<N>          startingIds;
-    std::vector<FileOffset> pageStarts;
-
-    std::vector<uint32_t>   indexPageCounts;
-
-    FileOffset              levelsOffset;
-    FileOffset              lastLevelPageStartOffset;
+    FileScanner        scanner;
+    NumericIndexWriter writer;
 
-    FileOffset              indexPageCountsOffset;
-    uint32_t                pageSize=(uint32_t)parameter.GetNumericIndexPageSize();
+    uint32_t           dataCount;
+    FileOffset         dataFileSize;
+    N                  minId=0;
+    N                  maxId=0;
+    uint32_t           pageSize=(uint32_t)parameter.GetNumericIndexPageSize();
 
-    //
-    // Writing index file
-    //
-
-    progress.SetAction(std::string("Generating '")+indexfile+"'");
-
-    if (!writer.Open(indexfile)) {
-      progress.Error(std::string("Cannot create '")+indexfile+"'");
-      return false;
-    }
+    progress.SetAction(std::string("Scanning ids of '")+datafile+"'");
 
     if (!scanner.Open(datafile,FileScanner::Sequential,true)) {
       progress.Error(std::string("Cannot open '")+datafile+"'");
       return false;
     }
 
+    dataFileSize=scanner.GetSize();
+
     if (!scanner.Read(dataCount)) {
       progress.Error("Error while reading number of data entries in file");
       return false;
     }
 
-    writer.WriteNumber(pageSize);       // Size of one index page in bytes
-    writer.WriteNumber(dataCount);      // Number of entries in data file
-
-    writer.GetPos(levelsOffset);
-    writer.Write((uint32_t)0);        // Number of levels
-
-    writer.GetPos(lastLevelPageStartOffset);
-    writer.WriteFileOffset((FileOffset)0);        // Write the starting position of the last page
-
-    writer.GetPos(indexPageCountsOffset);
-    writer.WriteFileOffset((FileOffset)0);        // Write the starting position of list of sizes of each index level
-
-    writer.FlushCurrentBlockWithZeros(pageSize);
-
-    N          lastId=0;
-    FileOffset lastPos=0;
-
-    progress.Info(std::string("Writing level ")+NumberToString(1)+" ("+NumberToString(dataCount)+" entries)");
-
-    uint32_t currentPageSize=0;
-
     for (uint32_t d=0; d<dataCount; d++) {
       progress.SetProgress(d,dataCount);
 
-      FileOffset readPos;
-
-      scanner.GetPos(readPos);
-
       T data;
 
       if (!ReadData(*typeConfig,
@@ -174,147 +138,72 @@ namespace osmscout {
         return false;
       }
 
-      if (currentPageSize>0) {
-        char         b1[10];
-        char         b2[10];
-        N            b1val=data.GetId()-lastId;
-        FileOffset   b2val=readPos-lastPos;
-        unsigned int b1size;
-        unsigned int b2size;
-
-
-        b1size=EncodeNumber(b1val,b1);
-        b2size=EncodeNumber(b2val,b2);
-
-        assert(b1size<=10);
-        assert(b2size<=10);
-
-        if (currentPageSize+b1size+b2size>pageSize) {
-          // Next entry does not fit, fill rest of index page with zeros
-          writer.FlushCurrentBlockWithZeros(pageSize);
-
-          currentPageSize=0;
-        }
-        else {
-          writer.Write(b1,b1size);
-          writer.Write(b2,b2size);
-
-          currentPageSize+=b1size+b2size;
-        }
+      if (d==0) {
+        minId=data.GetId();
       }
-
-      if (currentPageSize==0) {
-        FileOffset writePos;
-
-        writer.GetPos(writePos);
-
-        startingIds.push_back(data.GetId());
-        pageStarts.push_back(writePos);
-
-        writer.WriteNumber(data.GetId());
-        writer.WriteNumber(readPos);
-
-        writer.GetPos(writePos);
-        currentPageSize=writePos%pageSize;
+      else if (data.GetId()<=maxId) {
+        progress.Error(std::string("Ids in file '")+
+                       scanner.GetFilename()+
+                       "' are not sorted ascending");
+        return false;
       }
 
-      lastId=data.GetId();
-      lastPos=readPos;
+      maxId=data.GetId();
     }
 
-    writer.FlushCurrentBlockWithZeros(pageSize);
-    indexPageCounts.push_back(pageStarts.size());
-
-    while (pageStarts.size()>1) {
-      std::vector<N>          si(startingIds);
-      std::vector<FileOffset> po(pageStarts);
-
-      startingIds.clear();
-      pageStarts.clear();
-
-      progress.Info(std::string("Writing level ")+NumberToString(indexPageCounts.size()+1)+" ("+NumberToString(si.size())+" entries)");
-
-      size_t currentPageSize=0;
-
-      for (size_t i=0; i<si.size(); i++) {
-
-        if (currentPageSize>0) {
-          char         b1[10];
-          char         b2[10];
-          N            b1val=si[i]-si[i-1];
-          FileOffset   b2val=po[i]-po[i-1];
-          unsigned int b1size;
-          unsigned int b2size;
-
-          b1size=EncodeNumber(b1val,b1);
-          b2size=EncodeNumber(b2val,b2);
-
-          assert(b1size<=10);
-          assert(b2size<=10);
-
-          if (currentPageSize+b1size+b2size>pageSize) {
-            // Fill rest of first index page with zeros
-            writer.FlushCurrentBlockWithZeros(pageSize);
-
-            currentPageSize=0;
-          }
-          else {
-            writer.Write(b1,b1size);
-            writer.Write(b2,b2size);
-
-            currentPageSize+=b1size+b2size;
-          }
-        }
-
-        if (currentPageSize==0) {
-          FileOffset writePos;
-
-          writer.GetPos(writePos);
-
-          startingIds.push_back(si[i]);
-          pageStarts.push_back(writePos);
-
-          writer.WriteNumber(si[i]);
-          writer.WriteNumber(po[i]);
+    //
+    // Writing index file
+    //
 
-          writer.GetPos(writePos);
-          currentPageSize=writePos%pageSize;
-        }
-      }
+    progress.SetAction(std::string("Generating '")+indexfile+"'");
 
-      writer.FlushCurrentBlockWithZeros(pageSize);
-      indexPageCounts.push_back(pageStarts.size());
+    if (!writer.Open(indexfile,
+                     pageSize,
+                     dataCount,
+                     (uint64_t)minId,
+                     (uint64_t)maxId,
+                     dataFileSize)) {
+      progress.Error(std::string("Cannot create '")+indexfile+"'");
+      return false;
     }
 
-    // If we have data to index, we should have at least one root level index page
-    if (dataCount>0) {
-      assert(pageStarts.size()==1);
+    if (!scanner.SetPos(0) ||
+        !scanner.Read(dataCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
 
-      FileOffset indexPageCountsPos;
+    for (uint32_t d=0; d<dataCount; d++) {
+      progress.SetProgress(d,dataCount);
 
-      writer.GetPos(indexPageCountsPos);
+      FileOffset readPos;
 
-      writer.SetPos(levelsOffset);
-      writer.Write((uint32_t)indexPageCounts.size());
+      scanner.GetPos(readPos);
 
-      writer.SetPos(lastLevelPageStartOffset);
-      writer.WriteFileOffset(pageStarts[0]);
+      T data;
 
-      writer.SetPos(indexPageCountsOffset);
-      writer.WriteFileOffset(indexPageCountsPos);
+      if (!ReadData(*typeConfig,
+                    scanner,
+                    data)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(d+1)+" of "+
+                       NumberToString(dataCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
 
-      writer.SetPos(indexPageCountsPos);
+      if (!writer.Add((uint64_t)data.GetId(),
+                      readPos)) {
+        progress.Error(std::string("Cannot write index page to '")+indexfile+"'");
+        return false;
+      }
     }
 
-    progress.Info(std::string("Index for ")+NumberToString(dataCount)+" data elements will be stored in "+NumberToString(indexPageCounts.size())+ " levels");
-    for (size_t i=0; i<indexPageCounts.size(); i++) {
-      progress.Info(std::string("Page count for level ")+NumberToString(indexPageCounts.size()-i)+" is "+NumberToString(indexPageCounts[i]));
-      writer.WriteNumber(indexPageCounts[i]);
-    }
+    progress.Info(std::string("Index for ")+NumberToString(dataCount)+" data elements will be stored in "+NumberToString(writer.GetLevelCount())+ " levels");
 
     return !scanner.HasError() &&
            scanner.Close() &&
-           !writer.HasError() &&
            writer.Close();
   }
 }
@@ -0,0 +1,97 @@
+#ifndef OSMSCOUT_IMPORT_GENPOIINDEX_H
+#define OSMSCOUT_IMPORT_GENPOIINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/GeoBox.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Generates the index of the representative points of all objects with a type
+   * that is marked as POI, see POIIndex.
+   */
+  class POIIndexGenerator : public ImportModule
+  {
+  private:
+    /**
+     * A POI to be indexed
+     */
+    struct Entry
+    {
+      uint64_t      hilbertValue; //!< Position of the POI on the Hilbert curve
+      GeoCoord      coord;        //!< The representative point of the object
+      ObjectFileRef object;       //!< The object
+    };
+
+    /**
+     * A node of the tree that still has to get a parent
+     */
+    struct TreeNode
+    {
+      GeoBox     boundingBox; //!< Bounding box of all entries of the node
+      FileOffset offset;      //!< Offset of the node
+    };
+
+  private:
+    std::vector<std::vector<Entry> > typeEntries; //!< Entries for each type index
+
+  private:
+    void AddEntry(const TypeInfoRef& type,
+                  const GeoCoord& coord,
+                  const ObjectFileRef& object);
+
+    bool ScanNodes(const TypeConfig& typeConfig,
+                   const ImportParameter& parameter,
+                   Progress& progress);
+
+    bool ScanWays(const TypeConfig& typeConfig,
+                  const ImportParameter& parameter,
+                  Progress& progress);
+
+    bool ScanAreas(const TypeConfig& typeConfig,
+                   const ImportParameter& parameter,
+                   Progress& progress);
+
+    bool WriteTree(FileWriter& writer,
+                   std::vector<Entry>& entries,
+                   FileOffset& rootOffset);
+
+    bool WriteIndex(const TypeConfig& typeConfig,
+                    const ImportParameter& parameter,
+                    Progress& progress);
+
+  public:
+    std::string GetDescription() const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
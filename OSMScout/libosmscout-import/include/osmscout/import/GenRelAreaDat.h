@@ -23,6 +23,7 @@
 #include <osmscout/import/Import.h>
 
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -32,6 +33,7 @@
 #include <osmscout/CoordDataFile.h>
 
 #include <osmscout/util/Geometry.h>
+#include <osmscout/util/Progress.h>
 
 #include <osmscout/import/RawRelation.h>
 #include <osmscout/import/RawRelIndexedDataFile.h>
@@ -118,8 +120,8 @@ namespace osmscout {
 
     struct MultipolygonPart
     {
-      Area::Ring           role;
-      std::list<RawWayRef> ways;
+      Area::Ring               role;
+      std::list<const RawWay*> ways; //! Ways are owned by the way map of the current block
 
       inline bool IsArea() const
       {
@@ -133,6 +135,33 @@ namespace osmscout {
       }
     };
 
+    /**
+     * A relation of the currently processed block together with all data collected for it
+     * and the result of its assembly
+     */
+    struct BlockEntry
+    {
+      RawRelationRef                 rawRelation;
+      std::string                    name;
+      bool                           isBoundary;            //! Relation is an administrative boundary
+      bool                           membersValid;          //! All child relations could be resolved
+      size_t                         wayCount;              //! Number of member ways, including ways of child relations
+      std::map<OSMId,RawRelationRef> relationMap;           //! Child relations of boundaries
+      BufferedProgress               progress;              //! Messages reported while handling the relation
+      IdSet                          wayAreaIndexBlacklist; //! Ways blacklisted by the relation
+      Area                           relation;
+      bool                           success;               //! Relation was assembled and should be written
+
+      BlockEntry()
+      : isBoundary(false),
+        membersValid(false),
+        wayCount(0),
+        success(false)
+      {
+        // no code
+      }
+    };
+
   private:
     std::list<MultipolygonPart>::const_iterator FindTopLevel(const std::list<MultipolygonPart>& rings,
                                                              const GroupingState& state,
@@ -182,25 +211,41 @@ namespace osmscout {
                                 IdSet& resolvedRelations,
                                 std::list<MultipolygonPart>& parts);
 
-  bool ResolveMultipolygonMembers(Progress& progress,
-                                  const TypeConfig& typeConfig,
-                                  CoordDataFile& coordDataFile,
-                                  RawWayIndexedDataFile& wayDataFile,
-                                  RawRelationIndexedDataFile& relDataFile,
-                                  IdSet& resolvedRelations,
-                                  const Area& relation,
-                                  const std::string& name,
-                                  const RawRelation& rawRelation,
-                                  std::list<MultipolygonPart>& parts);
+    bool CollectMultipolygonMembers(Progress& progress,
+                                    RawRelationIndexedDataFile& relDataFile,
+                                    bool isBoundary,
+                                    const std::string& name,
+                                    const RawRelation& rawRelation,
+                                    std::map<OSMId,RawRelationRef>& relationMap,
+                                    std::set<OSMId>& wayIds);
+
+    bool LoadBlockMembers(Progress& progress,
+                          CoordDataFile& coordDataFile,
+                          RawWayIndexedDataFile& wayDataFile,
+                          const std::set<OSMId>& wayIds,
+                          IdRawWayMap& wayMap,
+                          CoordDataFile::CoordResultMap& coordMap);
+
+    bool ResolveMultipolygonMembers(Progress& progress,
+                                    const TypeConfig& typeConfig,
+                                    const CoordDataFile::CoordResultMap& coordMap,
+                                    const IdRawWayMap& wayMap,
+                                    const std::map<OSMId,RawRelationRef>& relationMap,
+                                    bool isBoundary,
+                                    const Area& relation,
+                                    const std::string& name,
+                                    const RawRelation& rawRelation,
+                                    std::list<MultipolygonPart>& parts);
 
     bool HandleMultipolygonRelation(const ImportParameter& parameter,
                                     Progress& progress,
                                     const TypeConfig& typeConfig,
                                     IdSet& wayAreaIndexBlacklist,
-                                    CoordDataFile& coordDataFile,
-                                    RawWayIndexedDataFile& wayDataFile,
-                                    RawRelationIndexedDataFile& relDataFile,
-                                    RawRelation& rawRelation,
+                                    const CoordDataFile::CoordResultMap& coordMap,
+                                    const IdRawWayMap& wayMap,
+                                    const std::map<OSMId,RawRelationRef>& relationMap,
+                                    bool isBoundary,
+                                    const RawRelation& rawRelation,
                                     const std::string& name,
                                     Area& relation);
 
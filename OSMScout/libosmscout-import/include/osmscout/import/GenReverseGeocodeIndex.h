@@ -0,0 +1,152 @@
+#ifndef OSMSCOUT_IMPORT_GENREVERSEGEOCODEINDEX_H
+#define OSMSCOUT_IMPORT_GENREVERSEGEOCODEINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Generates the spatial index of all addresses and locations of the location
+   * index used for reverse geocoding, see ReverseGeocodeIndex.
+   */
+  class ReverseGeocodeIndexGenerator : public ImportModule
+  {
+  public:
+    /**
+     * A location of the location index
+     */
+    struct LocationEntry
+    {
+      FileOffset regionOffset;   //!< Offset of the admin region
+      FileOffset locationOffset; //!< Offset of the location
+    };
+
+    /**
+     * An address of the location index
+     */
+    struct AddressEntry
+    {
+      FileOffset    regionOffset;   //!< Offset of the admin region
+      FileOffset    locationOffset; //!< Offset of the location
+      FileOffset    addressOffset;  //!< Offset of the address
+      std::string   name;           //!< The house number
+      ObjectFileRef object;         //!< The object with the address
+    };
+
+  private:
+    /**
+     * A location or an address, that is represented by an object
+     */
+    struct ObjectUse
+    {
+      bool     isAddress; //!< Index is an index into the addresses, else into the locations
+      uint32_t index;     //!< Index of the location or the address
+    };
+
+    typedef std::unordered_map<FileOffset,std::vector<ObjectUse> > ObjectUseMap;
+
+    /**
+     * A segment of a location in a cell
+     */
+    struct CellSegment
+    {
+      uint64_t cellId;
+      uint32_t location;
+      GeoCoord from;
+      GeoCoord to;
+    };
+
+    /**
+     * An address in a cell
+     */
+    struct CellPoint
+    {
+      uint64_t cellId;
+      uint32_t address;
+      GeoCoord coord;
+    };
+
+  private:
+    std::vector<LocationEntry> locations;
+    std::vector<AddressEntry>  addresses;
+    ObjectUseMap               nodeUses;
+    ObjectUseMap               wayUses;
+    ObjectUseMap               areaUses;
+    std::vector<CellSegment>   segments;
+    std::vector<CellPoint>     points;
+
+  private:
+    void AddObjectUse(const ObjectFileRef& object,
+                      bool isAddress,
+                      uint32_t index);
+
+    bool LoadLocations(const ImportParameter& parameter,
+                       Progress& progress);
+
+    void GetSegmentCells(const GeoCoord& from,
+                         const GeoCoord& to,
+                         std::vector<uint64_t>& cellIds) const;
+
+    void AddSegment(uint32_t location,
+                    const GeoCoord& from,
+                    const GeoCoord& to);
+
+    void AddPoint(uint32_t address,
+                  const GeoCoord& coord);
+
+    void AddLine(const std::vector<ObjectUse>& uses,
+                 const std::vector<CompactGeoCoord>& nodes,
+                 bool closed);
+
+    bool ScanNodes(const TypeConfig& typeConfig,
+                   const ImportParameter& parameter,
+                   Progress& progress);
+
+    bool ScanWays(const TypeConfig& typeConfig,
+                  const ImportParameter& parameter,
+                  Progress& progress);
+
+    bool ScanAreas(const TypeConfig& typeConfig,
+                   const ImportParameter& parameter,
+                   Progress& progress);
+
+    bool WriteIndex(const ImportParameter& parameter,
+                    Progress& progress);
+
+  public:
+    std::string GetDescription() const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
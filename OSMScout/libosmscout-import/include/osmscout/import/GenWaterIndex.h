@@ -31,6 +31,7 @@
 
 #include <osmscout/util/FileWriter.h>
 #include <osmscout/util/Geometry.h>
+#include <osmscout/util/Progress.h>
 #include <osmscout/util/Reference.h>
 
 namespace osmscout {
@@ -208,6 +209,10 @@ namespace osmscout {
                   const std::vector<GeoCoord>& points,
                   std::set<Pixel>& cellIntersections);
 
+    void GetCells(const Level& level,
+                  const std::vector<CompactGeoCoord>& points,
+                  std::set<Pixel>& cellIntersections);
+
     void GetCellIntersections(const Level& level,
                               const std::vector<GeoCoord>& points,
                               size_t coastline,
@@ -223,7 +228,7 @@ namespace osmscout {
     bool AssumeLand(const ImportParameter& parameter,
                     Progress& progress,
                     const TypeConfig& typeConfig,
-                    Level& level);
+                    std::vector<Level>& levels);
 
     void FillWater(Progress& progress,
                    Level& level,
@@ -270,6 +275,13 @@ namespace osmscout {
                                           std::map<Pixel,std::list<GroundTile> >& cellGroundTileMap,
                                           Data& data);
 
+    void CalculateCoastlineTiles(const ImportParameter& parameter,
+                                 Progress& progress,
+                                 const std::list<CoastRef>& coastlines,
+                                 uint32_t magnification,
+                                 Level& level,
+                                 std::map<Pixel,std::list<GroundTile> >& cellGroundTileMap);
+
   public:
     std::string GetDescription() const;
     bool Import(const TypeConfigRef& typeConfig,
@@ -50,12 +50,15 @@ namespace osmscout {
     std::string                  destinationDirectory;     //! Name of the destination directory
     size_t                       startStep;                //! Starting step for import
     size_t                       endStep;                  //! End step for import
+    bool                         incremental;              //! Skip steps whose recorded results are still up to date
 
     bool                         strictAreas;              //! Assure that areas conform to "simple" definition
 
     bool                         sortObjects;              //! Sort all objects
-    size_t                       sortBlockSize;            //! Number of entries loaded in one sort iteration
+    size_t                       sortMemoryBudget;         //! Number of bytes of objects held in memory while generating a sorted run
     size_t                       sortTileMag;              //! Zoom level for individual sorting cells
+    bool                         columnStore;              //! Also write a columnar copy of the sorted data files
+    size_t                       dataCompressionBlockSize; //! Block size for block compression of the sorted data files, 0 for no compression
 
     size_t                       numericIndexPageSize;     //! Size of an numeric index page in bytes
 
@@ -69,6 +72,7 @@ namespace osmscout {
     size_t                       rawWayDataCacheSize;      //! Size of the raw way data cache
     size_t                       rawWayIndexCacheSize;     //! Size of the raw way index cache
     size_t                       rawWayBlockSize;          //! Number of ways loaded during import until nodes get resolved
+    size_t                       rawRelationBlockSize;     //! Number of relations whose members get resolved and assembled in one block
 
     bool                         areaDataMemoryMaped;      //! Use memory mapping for area data file access
     size_t                       areaDataCacheSize;        //! Size of the area data cache
@@ -77,6 +81,7 @@ namespace osmscout {
     size_t                       wayDataCacheSize;         //! Size of the way data cache
 
     size_t                       areaAreaIndexMaxMag;      //! Maximum depth of the index generated
+    bool                         areaAreaIndexRTree;       //! Also generate the packed R-tree area area index
 
     size_t                       areaWayMinMag;            //! Minimum magnification of index for individual type
 
@@ -109,12 +114,15 @@ namespace osmscout {
 
     size_t GetStartStep() const;
     size_t GetEndStep() const;
+    bool GetIncremental() const;
 
     bool GetStrictAreas() const;
 
     bool GetSortObjects() const;
-    size_t GetSortBlockSize() const;
+    size_t GetSortMemoryBudget() const;
     size_t GetSortTileMag() const;
+    bool GetColumnStore() const;
+    size_t GetDataCompressionBlockSize() const;
 
     size_t GetNumericIndexPageSize() const;
 
@@ -128,6 +136,7 @@ namespace osmscout {
     size_t GetRawWayDataCacheSize() const;
     size_t GetRawWayIndexCacheSize() const;
     size_t GetRawWayBlockSize() const;
+    size_t GetRawRelationBlockSize() const;
 
     bool GetAreaDataMemoryMaped() const;
     size_t GetAreaDataCacheSize() const;
@@ -143,6 +152,7 @@ namespace osmscout {
     size_t GetAreaWayMinMag() const;
 
     size_t GetAreaAreaIndexMaxMag() const;
+    bool GetAreaAreaIndexRTree() const;
 
     size_t GetWaterIndexMinMag() const;
     size_t GetWaterIndexMaxMag() const;
@@ -164,12 +174,15 @@ namespace osmscout {
 
     void SetStartStep(size_t startStep);
     void SetSteps(size_t startStep, size_t endStep);
+    void SetIncremental(bool incremental);
 
     void SetStrictAreas(bool strictAreas);
 
     void SetSortObjects(bool sortObjects);
-    void SetSortBlockSize(size_t sortBlockSize);
+    void SetSortMemoryBudget(size_t sortMemoryBudget);
     void SetSortTileMag(size_t sortTileMag);
+    void SetColumnStore(bool columnStore);
+    void SetDataCompressionBlockSize(size_t dataCompressionBlockSize);
 
     void SetNumericIndexPageSize(size_t numericIndexPageSize);
 
@@ -183,6 +196,7 @@ namespace osmscout {
     void SetRawWayDataCacheSize(size_t wayDataCacheSize);
     void SetRawWayIndexCacheSize(size_t wayIndexCacheSize);
     void SetRawWayBlockSize(size_t blockSize);
+    void SetRawRelationBlockSize(size_t blockSize);
 
     void SetAreaDataMemoryMaped(bool memoryMaped);
     void SetAreaDataCacheSize(size_t areaDataCacheSize);
@@ -191,6 +205,7 @@ namespace osmscout {
     void SetWayDataCacheSize(size_t wayDataCacheSize);
 
     void SetAreaAreaIndexMaxMag(size_t areaAreaIndexMaxMag);
+    void SetAreaAreaIndexRTree(bool areaAreaIndexRTree);
 
     void SetAreaNodeMinMag(size_t areaNodeMinMag);
     void SetAreaNodeIndexMinFillRate(double areaNodeIndexMinFillRate);
@@ -0,0 +1,124 @@
+#ifndef OSMSCOUT_IMPORT_IMPORTMANIFEST_H
+#define OSMSCOUT_IMPORT_IMPORTMANIFEST_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osmscout/private/ImportImportExport.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Records the state of an import: the import parameter, the state of the input
+   * files and for each executed step the state of the destination directory after
+   * the step has finished. A state of a file consists of its size, its modification
+   * time and a hash of its content.
+   *
+   * An import step does not need to be executed again, if the current content of the
+   * destination directory matches the recorded result of the step, since all
+   * following steps only depend on the import parameter, the input files and the
+   * files in the destination directory.
+   *
+   * The manifest is written to the destination directory after each step, so an
+   * interrupted import can be resumed after the last completed step.
+   */
+  class OSMSCOUT_IMPORT_API ImportManifest
+  {
+  public:
+    static const char* const FILENAME_IMPORT_MANIFEST;
+
+    /**
+     * State of a single file
+     */
+    struct FileState
+    {
+      FileOffset size;             //!< Size of the file in bytes
+      uint64_t   modificationTime; //!< Time of the last modification in seconds since the epoch
+      uint64_t   hash;             //!< Hash of the file content
+
+      bool operator==(const FileState& other) const
+      {
+        return size==other.size &&
+               hash==other.hash;
+      }
+    };
+
+    /**
+     * State of a number of files, indexed by their file name
+     */
+    typedef std::map<std::string,FileState> FileStateMap;
+
+  private:
+    struct Step
+    {
+      std::string  description; //!< Description of the import module
+      uint64_t     finished;    //!< Time the state of the files was recorded in seconds since the epoch
+      FileStateMap files;       //!< State of the destination directory after the step
+    };
+
+  private:
+    std::string            filename;   //!< Filename of the manifest
+    std::string            directory;  //!< The destination directory
+    std::list<std::string> parameter;  //!< All import parameter influencing the result of the import
+    FileStateMap           inputs;     //!< The input files of the import
+    std::map<size_t,Step>  steps;      //!< The executed steps
+    FileStateMap           current;    //!< The current state of the destination directory
+
+  private:
+    static bool GetFileContentHash(const std::string& filename,
+                                   uint64_t& hash);
+    static bool GetFileState(const std::string& filename,
+                             const FileState* previousState,
+                             uint64_t unchangedBefore,
+                             FileState& state);
+
+    bool ListDirectory(std::list<std::string>& files) const;
+
+    bool Matches(const FileStateMap& expected) const;
+
+    bool Load(Progress& progress,
+              std::list<std::string>& parameter,
+              FileStateMap& inputs);
+    bool Save() const;
+
+  public:
+    ImportManifest();
+
+    bool Open(const ImportParameter& parameter,
+              Progress& progress);
+
+    size_t GetUpToDateStep(size_t startStep,
+                           size_t endStep,
+                           const std::vector<std::string>& descriptions) const;
+
+    bool FinishStep(Progress& progress,
+                    size_t step,
+                    const std::string& description,
+                    uint64_t startTime);
+  };
+}
+
+#endif
@@ -125,13 +125,12 @@ namespace osmscout {
                            const TagMap& tags);
     };
 
-  private:
-    bool ProcessFiles(const TypeConfigRef& typeConfig,
-                      const ImportParameter& parameter,
-                      Progress& progress,
-                      Callback& callback);
-
   public:
+    static bool ProcessFiles(const TypeConfigRef& typeConfig,
+                             const ImportParameter& parameter,
+                             Progress& progress,
+                             PreprocessorCallback& callback);
+
     std::string GetDescription() const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
@@ -42,8 +42,15 @@ namespace osmscout {
     TagMap                           tagMap;
     std::vector<OSMId>               nodes;
     std::vector<RawRelation::Member> members;
+    std::vector<uint32_t>            blockTagIds; //!< Tag ids of the strings of the current block, resolved on first use
 
   private:
+    void ResetBlockTagIds(const PBF::PrimitiveBlock& block);
+
+    TagId GetTagId(const TypeConfig& typeConfig,
+                   const PBF::PrimitiveBlock& block,
+                   uint32_t index);
+
     void ReadNodes(const TypeConfig& typeConfig,
                    const PBF::PrimitiveBlock& block,
                    const PBF::PrimitiveGroup &group);
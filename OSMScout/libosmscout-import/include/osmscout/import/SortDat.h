@@ -20,16 +20,25 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <cmath>
 #include <list>
+#include <queue>
 #include <unordered_map>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include <osmscout/import/Import.h>
 
 #include <osmscout/DataFile.h>
 #include <osmscout/ObjectRef.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/FileWriter.h>
+#include <osmscout/util/String.h>
 
 namespace osmscout {
 
@@ -45,39 +54,61 @@ namespace osmscout {
       FileScanner scanner;
     };
 
-    struct CellEntry
+    /**
+     * A data entry together with its sort key. The sort key is the index of the
+     * tile cell the top left coordinate of the object falls into, within the cell
+     * objects are ordered by their top left coordinate and finally by their id.
+     */
+    struct SortEntry
     {
-      uint8_t                              type;
-      Id                                   id;
-      typename std::list<Source>::iterator source;
-      FileOffset                           fileOffset;
-      double                               lat;
-      double                               lon;
-
-      inline CellEntry(uint8_t type,
-                       Id id,
-                       const typename std::list<Source>::iterator source,
-                       FileOffset fileOffset,
-                       double lat,
-                       double lon)
-      : type(type),
-        id(id),
-        source(source),
-        fileOffset(fileOffset),
-        lat(lat),
-        lon(lon)
-      {
-        // no code
-      }
-
-      inline bool operator<(const CellEntry& other) const
+      size_t   cell;
+      double   lat;
+      double   lon;
+      Id       id;
+      uint8_t  type;
+      Ref<N>   data;
+
+      inline bool operator<(const SortEntry& other) const
       {
-        if (lon==other.lon) {
-          return lat>other.lat;
+        if (cell!=other.cell) {
+          return cell<other.cell;
         }
-        else {
+
+        if (lon!=other.lon) {
           return lon<other.lon;
         }
+
+        if (lat!=other.lat) {
+          return lat>other.lat;
+        }
+
+        return id<other.id;
+      }
+    };
+
+    /**
+     * A sorted run written to disk during run generation
+     */
+    struct Run
+    {
+      std::string filename;
+      FileScanner scanner;
+      uint32_t    count;
+      uint32_t    current;
+    };
+
+    /**
+     * The current head of a run during the k-way merge. Ordering is inverted,
+     * so that std::priority_queue returns the smallest entry first.
+     */
+    struct MergeEntry
+    {
+      SortEntry                         entry;
+      typename std::list<Run>::iterator run;
+
+      inline bool operator<(const MergeEntry& other) const
+      {
+        return other.entry<entry;
       }
     };
 
@@ -116,6 +147,28 @@ namespace osmscout {
     std::list<ProcessingFilterRef> filters;
 
   private:
+    void CalculateSortKey(const ImportParameter& parameter,
+                          SortEntry& entry);
+
+    void SortEntries(std::vector<SortEntry>& entries) const;
+
+    bool ReadEntry(const TypeConfig& typeConfig,
+                   FileScanner& scanner,
+                   SortEntry& entry);
+
+    bool WriteRun(const TypeConfig& typeConfig,
+                  const ImportParameter& parameter,
+                  Progress& progress,
+                  std::vector<SortEntry>& entries,
+                  std::list<Run>& runs);
+
+    bool WriteEntry(const TypeConfig& typeConfig,
+                    Progress& progress,
+                    SortEntry& entry,
+                    FileWriter& dataWriter,
+                    FileWriter& mapWriter,
+                    uint32_t& dataCopiedCount);
+
     bool Renumber(const TypeConfig& typeConfig,
                   const ImportParameter& parameter,
                   Progress& progress);
@@ -173,19 +226,211 @@ namespace osmscout {
     filters.push_back(filter);
   }
 
+  template <class N>
+  void SortDataGenerator<N>::CalculateSortKey(const ImportParameter& parameter,
+                                              SortEntry& entry)
+  {
+    double zoomLevel=pow(2.0,(double)parameter.GetSortTileMag());
+
+    GetTopLeftCoordinate(*entry.data,
+                         entry.lat,
+                         entry.lon);
+
+    size_t cellY=(size_t)((entry.lat+90.0)/180.0*zoomLevel);
+    size_t cellX=(size_t)((entry.lon+180.0)/360.0*zoomLevel);
+
+    entry.cell=cellY*(size_t)zoomLevel+cellX;
+  }
+
+  /**
+   * Sorts the given entries using all available cores. The vector is split into one
+   * chunk per thread, chunks are sorted in parallel and afterwards merged pairwise
+   * (again in parallel) until only one sorted sequence remains.
+   */
+  template <class N>
+  void SortDataGenerator<N>::SortEntries(std::vector<SortEntry>& entries) const
+  {
+    size_t chunkCount=1;
+
+#if defined(_OPENMP)
+    chunkCount=(size_t)std::max(1,omp_get_max_threads());
+#endif
+
+    if (chunkCount==1 ||
+        entries.size()<chunkCount*1024) {
+      std::sort(entries.begin(),
+                entries.end());
+      return;
+    }
+
+    size_t chunkSize=(entries.size()+chunkCount-1)/chunkCount;
+
+#pragma omp parallel for
+    for (size_t chunk=0; chunk<chunkCount; chunk++) {
+      size_t start=std::min(chunk*chunkSize,entries.size());
+      size_t end=std::min(start+chunkSize,entries.size());
+
+      std::sort(entries.begin()+start,
+                entries.begin()+end);
+    }
+
+    for (size_t width=chunkSize; width<entries.size(); width*=2) {
+      size_t pairCount=(entries.size()+2*width-1)/(2*width);
+
+#pragma omp parallel for
+      for (size_t pair=0; pair<pairCount; pair++) {
+        size_t start=pair*2*width;
+        size_t middle=std::min(start+width,entries.size());
+        size_t end=std::min(start+2*width,entries.size());
+
+        std::inplace_merge(entries.begin()+start,
+                           entries.begin()+middle,
+                           entries.begin()+end);
+      }
+    }
+  }
+
+  template <class N>
+  bool SortDataGenerator<N>::ReadEntry(const TypeConfig& typeConfig,
+                                       FileScanner& scanner,
+                                       SortEntry& entry)
+  {
+    entry.data=new N();
+
+    return scanner.Read(entry.type) &&
+           scanner.Read(entry.id) &&
+           entry.data->Read(typeConfig,
+                            scanner);
+  }
+
+  /**
+   * Sorts the given entries and writes them as a new run to disk. The
+   * entries are cleared afterwards.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::WriteRun(const TypeConfig& typeConfig,
+                                      const ImportParameter& parameter,
+                                      Progress& progress,
+                                      std::vector<SortEntry>& entries,
+                                      std::list<Run>& runs)
+  {
+    FileWriter writer;
+    Run        run;
+
+    run.filename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                 dataFilename+"."+NumberToString(runs.size())+".run");
+    run.count=(uint32_t)entries.size();
+    run.current=0;
+
+    progress.Info("Sorting run #"+NumberToString(runs.size())+" with "+NumberToString(entries.size())+" entries");
+
+    SortEntries(entries);
+
+    progress.Info(std::string("Writing run to '")+run.filename+"'");
+
+    if (!writer.Open(run.filename)) {
+      progress.Error(std::string("Cannot create '")+writer.GetFilename()+"'");
+      return false;
+    }
+
+    writer.Write(run.count);
+
+    for (const auto& entry : entries) {
+      writer.Write(entry.type);
+      writer.Write(entry.id);
+
+      if (!entry.data->Write(typeConfig,
+                             writer)) {
+        progress.Error(std::string("Error while writing data entry to file '")+
+                       writer.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    entries.clear();
+
+    runs.push_back(run);
+
+    return writer.Close();
+  }
+
+  /**
+   * Passes the entry to all filters and - if not dropped by a filter - writes it
+   * to the data and the id map file.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::WriteEntry(const TypeConfig& typeConfig,
+                                        Progress& progress,
+                                        SortEntry& entry,
+                                        FileWriter& dataWriter,
+                                        FileWriter& mapWriter,
+                                        uint32_t& dataCopiedCount)
+  {
+    FileOffset fileOffset;
+    bool       save=true;
+
+    if (!dataWriter.GetPos(fileOffset)) {
+      progress.Error(std::string("Error while reading current fileOffset in file '")+
+                     dataWriter.GetFilename()+"'");
+      return false;
+    }
+
+    for (const auto& filter : filters) {
+      if (!filter->Process(progress,
+                           fileOffset,
+                           *entry.data,
+                           save)) {
+        progress.Error(std::string("Error while processing data entry to file '")+
+                       dataWriter.GetFilename()+"'");
+
+        return false;
+      }
+    }
+
+    if (!save) {
+      return true;
+    }
+
+    if (!entry.data->Write(typeConfig,
+                           dataWriter)) {
+      progress.Error(std::string("Error while writing data entry to file '")+
+                     dataWriter.GetFilename()+"'");
+      return false;
+    }
+
+    mapWriter.Write(entry.id);
+    mapWriter.Write(entry.type);
+    mapWriter.WriteFileOffset(fileOffset);
+
+    dataCopiedCount++;
+
+    return true;
+  }
+
+  /**
+   * Sorts all objects by cell and position using an external merge sort:
+   *
+   * * All sources are read sequentially once. Objects are collected in memory until
+   *   the (estimated) memory budget is exhausted. The collected objects are then sorted
+   *   in parallel and written as a sorted run to disk.
+   * * All runs are then merged by a k-way merge into the final data file, reading
+   *   each run strictly sequentially.
+   *
+   * If all objects fit into the memory budget, no run is written and the result is
+   * directly written to the data file.
+   */
   template <class N>
   bool SortDataGenerator<N>::Renumber(const TypeConfig& typeConfig,
                                       const ImportParameter& parameter,
                                       Progress& progress)
   {
-    FileWriter dataWriter;
-    FileWriter mapWriter;
-    uint32_t   overallDataCount=0;
-    uint32_t   dataCopiedCount=0;
-    double     zoomLevel=pow(2.0,(double)parameter.GetSortTileMag());
-    size_t     cellCount=zoomLevel*zoomLevel;
-    size_t     minIndex=0;
-    size_t     maxIndex=cellCount-1;
+    FileWriter             dataWriter;
+    FileWriter             mapWriter;
+    uint32_t               overallDataCount=0;
+    uint32_t               dataCopiedCount=0;
+    std::vector<SortEntry> entries;
+    size_t                 entriesMemory=0;
+    std::list<Run>         runs;
 
     progress.SetAction("Sorting data");
 
@@ -210,6 +455,83 @@ namespace osmscout {
       overallDataCount+=dataCount;
     }
 
+    progress.Info("Memory budget for sorting is "+ByteSizeToString((double)parameter.GetSortMemoryBudget()));
+
+    for (auto& source : sources) {
+      uint32_t dataCount;
+
+      progress.Info("Reading objects from file '"+source.scanner.GetFilename()+"'");
+
+      if (!source.scanner.GotoBegin()) {
+        progress.Error(std::string("Error while setting current position in file '")+
+                       source.scanner.GetFilename()+"'");
+        return false;
+      }
+
+      if (!source.scanner.Read(dataCount)) {
+        progress.Error("Error while reading number of data entries in file'"+
+                       source.scanner.GetFilename()+"'");
+        return false;
+      }
+
+      for (uint32_t current=1; current<=dataCount; current++) {
+        SortEntry  entry;
+        FileOffset startPos;
+        FileOffset endPos;
+
+        progress.SetProgress(current,dataCount);
+
+        if (!source.scanner.GetPos(startPos) ||
+            !ReadEntry(typeConfig,
+                       source.scanner,
+                       entry) ||
+            !source.scanner.GetPos(endPos)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(current)+" of "+
+                         NumberToString(dataCount)+
+                         " in file '"+
+                         source.scanner.GetFilename()+"'");
+          return false;
+        }
+
+        CalculateSortKey(parameter,
+                         entry);
+
+        entries.push_back(entry);
+
+        // The in memory representation is roughly twice the size of the
+        // compressed on disk representation
+        entriesMemory+=sizeof(SortEntry)+sizeof(N)+2*(size_t)(endPos-startPos);
+
+        if (entriesMemory>=parameter.GetSortMemoryBudget()) {
+          if (!WriteRun(typeConfig,
+                        parameter,
+                        progress,
+                        entries,
+                        runs)) {
+            return false;
+          }
+
+          entriesMemory=0;
+        }
+      }
+
+      if (!source.scanner.Close()) {
+        progress.Error(std::string("Error while  closing '")+source.scanner.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    if (!runs.empty() &&
+        !entries.empty()) {
+      if (!WriteRun(typeConfig,
+                    parameter,
+                    progress,
+                    entries,
+                    runs)) {
+        return false;
+      }
+    }
 
     if (!dataWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                         dataFilename))) {
@@ -217,6 +539,7 @@ namespace osmscout {
       return false;
     }
 
+    dataWriter.SetBlockCompression(parameter.GetDataCompressionBlockSize());
     dataWriter.Write(overallDataCount);
 
     if (!mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
@@ -227,201 +550,128 @@ namespace osmscout {
 
     mapWriter.Write(overallDataCount);
 
-    while (true) {
-      progress.Info("Reading objects in cell range "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
+    if (runs.empty()) {
+      progress.Info("All entries fit into memory, sorting in memory");
 
-      size_t                                 currentEntries=0;
-      std::map<size_t,std::list<CellEntry> > dataByCellMap;
+      SortEntries(entries);
 
-      for (typename std::list<Source>::iterator source=sources.begin();
-           source!=sources.end();
-           ++source) {
-        uint32_t dataCount;
-        progress.Info("Reading objects from file '"+source->scanner.GetFilename()+"'");
+      progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
 
-        if (!source->scanner.GotoBegin()) {
-          progress.Error(std::string("Error while setting current position in file '")+
-                         source->scanner.GetFilename()+"'");
-        }
+      for (size_t i=0; i<entries.size(); i++) {
+        progress.SetProgress(i,entries.size());
 
-        if (!source->scanner.Read(dataCount)) {
-          progress.Error("Error while reading number of data entries in file'"+
-                         source->scanner.GetFilename()+"'");
+        if (!WriteEntry(typeConfig,
+                        progress,
+                        entries[i],
+                        dataWriter,
+                        mapWriter,
+                        dataCopiedCount)) {
           return false;
         }
+      }
 
-        uint32_t current=1;
-
-        while (current<=dataCount) {
-          uint8_t type;
-          Id      id;
-          N       data;
-
-          progress.SetProgress(current,dataCount);
+      entries.clear();
+    }
+    else {
+      std::priority_queue<MergeEntry> heads;
 
-          if (!source->scanner.Read(type) ||
-              !source->scanner.Read(id) ||
-              !data.Read(typeConfig,
-                         source->scanner)) {
-            progress.Error(std::string("Error while reading data entry ")+
-                           NumberToString(current)+" of "+
-                           NumberToString(dataCount)+
-                           " in file '"+
-                           source->scanner.GetFilename()+"'");
-            return false;
-          }
+      progress.Info("Merging "+NumberToString(runs.size())+" runs into '"+dataWriter.GetFilename()+"'");
 
-          double maxLat;
-          double minLon;
+      for (typename std::list<Run>::iterator run=runs.begin();
+           run!=runs.end();
+           ++run) {
+        if (!run->scanner.Open(run->filename,
+                               FileScanner::Sequential,
+                               true)) {
+          progress.Error(std::string("Cannot open '")+run->filename+"'");
+          return false;
+        }
 
-          GetTopLeftCoordinate(data,maxLat,minLon);
+        if (!run->scanner.Read(run->count)) {
+          progress.Error(std::string("Error while reading number of data entries in file '")+
+                         run->scanner.GetFilename()+"'");
+          return false;
+        }
 
-          size_t cellY=(size_t)((maxLat+90.0)/180.0*zoomLevel);
-          size_t cellX=(size_t)((minLon+180.0)/360.0*zoomLevel);
-          size_t cellIndex=cellY*zoomLevel+cellX;
+        if (run->count>0) {
+          MergeEntry head;
 
-          if (cellIndex>=minIndex &&
-              cellIndex<=maxIndex) {
-            dataByCellMap[cellIndex].push_back(CellEntry(type,
-                                                         id,
-                                                         source,
-                                                         data.GetFileOffset(),
-                                                         maxLat,
-                                                         minLon));
-            currentEntries++;
+          if (!ReadEntry(typeConfig,
+                         run->scanner,
+                         head.entry)) {
+            progress.Error(std::string("Error while reading data entry from file '")+
+                           run->scanner.GetFilename()+"'");
+            return false;
           }
 
-          // Reduce cell interval, deleting all already stored nodes beyond the new
-          // cell range end.
-          if (currentEntries>parameter.GetSortBlockSize() &&
-              dataByCellMap.size()>1) {
-            size_t                                                    count=0;
-            size_t                                                    cutLimit=parameter.GetSortBlockSize()*9/10;
-            typename std::map<size_t,std::list<CellEntry> >::iterator cutOff=dataByCellMap.end();
-
-            for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-                iter!=dataByCellMap.end();
-                ++iter) {
-              if (count<=cutLimit &&
-                  count+iter->second.size()>cutLimit) {
-                cutOff=iter;
-                break;
-              }
-              else {
-                maxIndex=iter->first;
-                count+=iter->second.size();
-              }
-            }
-
-            assert(cutOff!=dataByCellMap.end());
-
-            currentEntries=count;
-            dataByCellMap.erase(cutOff,dataByCellMap.end());
-          }
+          CalculateSortKey(parameter,
+                           head.entry);
 
-          current++;
-        }
-      }
+          head.run=run;
+          run->current=1;
 
-      if (maxIndex<cellCount-1) {
-        progress.Info("Cell range was reduced to "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
+          heads.push(head);
+        }
       }
 
-      progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
+      size_t mergeCount=0;
 
-      size_t copyCount=0;
-      for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-          iter!=dataByCellMap.end();
-          ++iter) {
+      while (!heads.empty()) {
+        MergeEntry head=heads.top();
 
-        iter->second.sort();
+        heads.pop();
 
-        for (auto& entry : iter->second) {
-          progress.SetProgress(copyCount,currentEntries);
+        progress.SetProgress(mergeCount,overallDataCount);
 
-          N data;
+        if (!WriteEntry(typeConfig,
+                        progress,
+                        head.entry,
+                        dataWriter,
+                        mapWriter,
+                        dataCopiedCount)) {
+          return false;
+        }
 
-          if (!entry.source->scanner.SetPos(entry.fileOffset)) {
-            progress.Error(std::string("Error while setting current position in file '")+
-                           entry.source->scanner.GetFilename()+"'");
+        mergeCount++;
 
-            return false;
-          }
+        typename std::list<Run>::iterator run=head.run;
 
-          if (!data.Read(typeConfig,
-                         entry.source->scanner))  {
-            progress.Error(std::string("Error while reading data entry at offset ")+
-                           NumberToString(entry.fileOffset)+
-                           " in file '"+
-                           entry.source->scanner.GetFilename()+"'");
+        if (run->current<run->count) {
+          MergeEntry next;
 
+          if (!ReadEntry(typeConfig,
+                         run->scanner,
+                         next.entry)) {
+            progress.Error(std::string("Error while reading data entry from file '")+
+                           run->scanner.GetFilename()+"'");
             return false;
           }
 
-          FileOffset fileOffset;
-          bool       save=true;
+          CalculateSortKey(parameter,
+                           next.entry);
 
-          if (!dataWriter.GetPos(fileOffset)) {
-            progress.Error(std::string("Error while reading current fileOffset in file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
+          next.run=run;
+          run->current++;
 
-          for (const auto& filter : filters) {
-            if (!filter->Process(progress,
-                                 fileOffset,
-                                 data,
-                                 save)) {
-              progress.Error(std::string("Error while processing data entry to file '")+
-                             dataWriter.GetFilename()+"'");
-
-              return false;
-            }
-          }
-
-          if (!save) {
-            continue;
-          }
-
-          if (!data.Write(typeConfig,
-                          dataWriter)) {
-            progress.Error(std::string("Error while writing data entry to file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
-
-          mapWriter.Write(entry.id);
-          mapWriter.Write(entry.type);
-          mapWriter.WriteFileOffset(fileOffset);
-
-          copyCount++;
-          dataCopiedCount++;
+          heads.push(next);
         }
       }
 
-      if (currentEntries==0) {
-        progress.Info("No more entries found");
-        break;
-      }
+      for (auto& run : runs) {
+        if (!run.scanner.Close()) {
+          progress.Error(std::string("Error while closing '")+run.filename+"'");
+          return false;
+        }
 
-      if (maxIndex==cellCount-1) {
-        // We are finished
-        break;
+        if (!RemoveFile(run.filename)) {
+          progress.Error(std::string("Cannot delete '")+run.filename+"'");
+          return false;
+        }
       }
-
-      minIndex=maxIndex+1;
-      maxIndex=cellCount-1;
     }
 
     assert(overallDataCount>=dataCopiedCount);
 
-    for (auto& source : sources) {
-      if (!source.scanner.Close()) {
-        progress.Error(std::string("Error while  closing '")+source.scanner.GetFilename()+"'");
-        return false;
-      }
-    }
-
     progress.Info(NumberToString(dataCopiedCount)+" of " +NumberToString(overallDataCount) + " object(s) written to file '"+dataWriter.GetFilename()+"'");
 
     dataWriter.SetPos(0);
@@ -451,6 +701,7 @@ namespace osmscout {
       return false;
     }
 
+    dataWriter.SetBlockCompression(parameter.GetDataCompressionBlockSize());
     dataWriter.Write(overallDataCount);
 
     if (!mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
@@ -0,0 +1,127 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenAreaAreaRTreeIndex.h>
+
+#include <osmscout/Area.h>
+#include <osmscout/AreaAreaRTreeIndex.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  std::string AreaAreaRTreeIndexGenerator::GetDescription() const
+  {
+    return std::string("Generate '")+AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE+"'";
+  }
+
+  bool AreaAreaRTreeIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                           const ImportParameter& parameter,
+                                           Progress& progress)
+  {
+    std::string filename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE);
+
+    if (!parameter.GetAreaAreaIndexRTree()) {
+      FileOffset size;
+
+      // Do not leave an outdated index of a previous import behind
+      if (GetFileSize(filename,
+                      size)) {
+        progress.Info(std::string("Removing '")+AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE+"'");
+
+        if (!RemoveFile(filename)) {
+          progress.Error(std::string("Cannot remove '")+filename+"'");
+          return false;
+        }
+      }
+
+      progress.Info("R-tree area area index is disabled");
+
+      return true;
+    }
+
+    AreaAreaRTreeIndexWriter writer((uint32_t)parameter.GetAreaAreaIndexMaxMag());
+    FileScanner              scanner;
+    uint32_t                 areaCount=0;
+
+    progress.SetAction("Scanning areas.dat");
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "areas.dat"),
+                      FileScanner::Sequential,
+                      parameter.GetAreaDataMemoryMaped())) {
+      progress.Error("Cannot open 'areas.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(areaCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    writer.Reserve(areaCount);
+
+    for (uint32_t a=1; a<=areaCount; a++) {
+      progress.SetProgress(a,areaCount);
+
+      FileOffset offset;
+      Area       area;
+      GeoBox     boundingBox;
+
+      scanner.GetPos(offset);
+
+      if (!area.Read(*typeConfig,
+                     scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(a)+" of "+
+                       NumberToString(areaCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      area.GetBoundingBox(boundingBox);
+
+      writer.AddArea(offset,
+                     area.GetType()->GetAreaId(),
+                     boundingBox);
+    }
+
+    if (!scanner.Close()) {
+      progress.Error("Cannot close 'areas.dat'");
+      return false;
+    }
+
+    progress.SetAction(std::string("Generating '")+AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE+"'");
+
+    if (!writer.Write(filename)) {
+      progress.Error(std::string("Cannot write '")+filename+"'");
+      return false;
+    }
+
+    progress.Info(std::string("Tree of ")+NumberToString(areaCount)+" areas has "+
+                  NumberToString(writer.GetHeight())+" levels");
+
+    return true;
+  }
+}
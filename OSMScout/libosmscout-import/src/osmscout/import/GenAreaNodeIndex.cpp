@@ -21,6 +21,7 @@
 
 #include <vector>
 
+#include <osmscout/CellDirectory.h>
 #include <osmscout/Node.h>
 #include <osmscout/Pixel.h>
 
@@ -243,15 +244,13 @@ namespace osmscout {
       size_t i=type->GetIndex();
 
       if (nodeTypeData[i].HasEntries()) {
-        FileOffset bitmapOffset=0;
-        uint8_t    dataOffsetBytes=0;
+        FileOffset directoryOffset=0;
 
         writer.WriteNumber(type->GetNodeId());
 
         writer.GetPos(nodeTypeData[i].indexOffset);
 
-        writer.WriteFileOffset(bitmapOffset);
-        writer.Write(dataOffsetBytes);
+        writer.WriteFileOffset(directoryOffset);
 
         writer.WriteNumber(nodeTypeData[i].indexLevel);
         writer.WriteNumber(nodeTypeData[i].cellXStart);
@@ -281,7 +280,7 @@ namespace osmscout {
 
       progress.Info("Scanning nodes for index level "+NumberToString(l));
 
-      std::vector<std::map<Pixel,std::list<FileOffset> > > typeCellOffsets;
+      std::vector<CellDirectory::CellOffsetsMap> typeCellOffsets;
 
       typeCellOffsets.resize(typeConfig->GetTypeCount());
 
@@ -322,109 +321,57 @@ namespace osmscout {
       }
 
       //
-      // Write bitmap
+      // Write cells
       //
       for (const auto &type : indexTypes) {
-        size_t indexEntries=0;
-        size_t dataSize=0;
-        char   buffer[10];
+        const TypeData& typeData=nodeTypeData[type->GetIndex()];
+        size_t          indexEntries=0;
+        FileOffset      dataOffset;
+        FileOffset      directoryOffset;
+        FileOffset      endOffset;
 
         for (const auto &cell : typeCellOffsets[type->GetIndex()]) {
           indexEntries+=cell.second.size();
-
-          dataSize+=EncodeNumber(cell.second.size(),buffer);
-
-          FileOffset previousOffset=0;
-          for (auto offset : cell.second) {
-            FileOffset data=offset-previousOffset;
-
-            dataSize+=EncodeNumber(data,buffer);
-
-            previousOffset=offset;
-          }
         }
 
-        // "+1" because we add +1 to every offset, to generate offset > 0
-        uint8_t dataOffsetBytes=BytesNeededToAddressFileData(dataSize);
-
-        progress.Info("Writing map for "+
-                      type->GetName()+", "+
-                      NumberToString(typeCellOffsets[type->GetIndex()].size())+" cells, "+
-                      NumberToString(indexEntries)+" entries, "+
-                      ByteSizeToString(1.0*dataOffsetBytes*nodeTypeData[type->GetIndex()].cellXCount*nodeTypeData[type->GetIndex()].cellYCount));
-
-        FileOffset bitmapOffset;
-
-        if (!writer.GetPos(bitmapOffset)) {
+        if (!writer.GetPos(dataOffset)) {
           progress.Error("Cannot get type index start position in file");
           return false;
         }
 
-        assert(nodeTypeData[type->GetIndex()].indexOffset!=0);
-
-        if (!writer.SetPos(nodeTypeData[type->GetIndex()].indexOffset)) {
-          progress.Error("Cannot go to type index offset in file");
+        if (!CellDirectory::Write(writer,
+                                  typeData.indexLevel,
+                                  typeData.cellXStart,
+                                  typeData.cellYStart,
+                                  typeCellOffsets[type->GetIndex()],
+                                  directoryOffset)) {
+          progress.Error("Cannot write cell data of type "+type->GetName());
           return false;
         }
 
-        writer.WriteFileOffset(bitmapOffset);
-        writer.Write(dataOffsetBytes);
-
-        if (!writer.SetPos(bitmapOffset)) {
-          progress.Error("Cannot go to type index start position in file");
+        if (!writer.GetPos(endOffset)) {
+          progress.Error("Cannot get type index end position in file");
           return false;
         }
 
-        // Write the bitmap with offsets for each cell
-        // We prefill with zero and only overwrite cells that have data
-        // So zero means "no data for this cell"
-        for (size_t i=0; i<nodeTypeData[type->GetIndex()].cellXCount*nodeTypeData[type->GetIndex()].cellYCount; i++) {
-          FileOffset cellOffset=0;
-
-          writer.WriteFileOffset(cellOffset,
-                                 dataOffsetBytes);
-        }
+        progress.Info("Writing map for "+
+                      type->GetName()+", "+
+                      NumberToString(typeCellOffsets[type->GetIndex()].size())+" cells, "+
+                      NumberToString(indexEntries)+" entries, "+
+                      ByteSizeToString(1.0*(endOffset-dataOffset)));
 
-        FileOffset dataStartOffset;
+        assert(typeData.indexOffset!=0);
 
-        if (!writer.GetPos(dataStartOffset)) {
-          progress.Error("Cannot get start of data section after bitmap");
+        if (!writer.SetPos(typeData.indexOffset)) {
+          progress.Error("Cannot go to type index offset in file");
           return false;
         }
 
-        // Now write the list of offsets of objects for every cell with content
-        for (const auto &cell : typeCellOffsets[type->GetIndex()]) {
-          FileOffset bitmapCellOffset=bitmapOffset+
-                                      ((cell.first.y-nodeTypeData[type->GetIndex()].cellYStart)*nodeTypeData[type->GetIndex()].cellXCount+
-                                       cell.first.x-nodeTypeData[type->GetIndex()].cellXStart)*dataOffsetBytes;
-          FileOffset previousOffset=0;
-          FileOffset cellOffset;
-
-          if (!writer.GetPos(cellOffset)) {
-            progress.Error("Cannot get cell start position in file");
-            return false;
-          }
-
-          if (!writer.SetPos(bitmapCellOffset)) {
-            progress.Error("Cannot go to cell start position in file");
-            return false;
-          }
-
-          writer.WriteFileOffset(cellOffset-dataStartOffset+1,
-                                 dataOffsetBytes);
-
-          if (!writer.SetPos(cellOffset)) {
-            progress.Error("Cannot go back to cell start position in file");
-            return false;
-          }
+        writer.WriteFileOffset(directoryOffset);
 
-          writer.WriteNumber((uint32_t)cell.second.size());
-
-          for (auto offset : cell.second) {
-            writer.WriteNumber((FileOffset)(offset-previousOffset));
-
-            previousOffset=offset;
-          }
+        if (!writer.SetPos(endOffset)) {
+          progress.Error("Cannot go to type index end position in file");
+          return false;
         }
       }
     }
@@ -278,9 +278,8 @@ namespace osmscout {
   }
 
   /**
-   * For each cell we store a file offset to the bitmap data or 0, if there is no data for the cell. The bitmap entry itself
-   * contains the number of offsets followed by the offsets themselves (delta-encoded).
-   *
+   * Writes the posting lists and the cell directory (see CellDirectory) for the
+   * given type and stores the offset of the directory in the index entry of the type.
    *
    * @param progress
    * @param writer
@@ -289,123 +288,53 @@ namespace osmscout {
    * @param typeCellOffsets
    * @return
    */
-  bool AreaWayIndexGenerator::WriteBitmap(Progress& progress,
-                                          FileWriter& writer,
-                                          const TypeInfo& typeInfo,
-                                          const TypeData& typeData,
-                                          const CoordOffsetsMap& typeCellOffsets)
+  bool AreaWayIndexGenerator::WriteCells(Progress& progress,
+                                         FileWriter& writer,
+                                         const TypeInfo& typeInfo,
+                                         const TypeData& typeData,
+                                         const CoordOffsetsMap& typeCellOffsets)
   {
-    size_t indexEntries=0;
-    size_t dataSize=0;
-    char   buffer[10];
-
-    //
-    // Calculate the number of entries and the overall size of the data in the bitmap entries
-    // We need the overall size of the bitmap entry data, because we would store the file offset only with
-    // that much bytes we need to address the last data entry.
-
-    for (const auto& cell : typeCellOffsets) {
-      indexEntries+=cell.second.size();
-
-      dataSize+=EncodeNumber(cell.second.size(),
-                             buffer);
-
-      FileOffset previousOffset=0;
-
-      for (const auto& offset : cell.second) {
-        FileOffset data=offset-previousOffset;
-
-        dataSize+=EncodeNumber(data,buffer);
-
-        previousOffset=offset;
-      }
-    }
+    FileOffset dataOffset;
+    FileOffset directoryOffset;
+    FileOffset endOffset;
 
-    // "+1" because we add +1 to every offset, to generate offset > 0
-    uint8_t dataOffsetBytes=BytesNeededToAddressFileData(dataSize+1);
-
-    progress.Info("Writing map for "+
-                  typeInfo.GetName()+" , "+
-                  ByteSizeToString(1.0*dataOffsetBytes*typeData.cellXCount*typeData.cellYCount+dataSize));
-
-    FileOffset bitmapOffset;
-
-    if (!writer.GetPos(bitmapOffset)) {
+    if (!writer.GetPos(dataOffset)) {
       progress.Error("Cannot get type index start position in file");
       return false;
     }
 
-    assert(typeData.indexOffset!=0);
-
-    if (!writer.SetPos(typeData.indexOffset)) {
-      progress.Error("Cannot go to type index offset in file");
+    if (!CellDirectory::Write(writer,
+                              typeData.indexLevel,
+                              typeData.cellXStart,
+                              typeData.cellYStart,
+                              typeCellOffsets,
+                              directoryOffset)) {
+      progress.Error("Cannot write cell data of type "+typeInfo.GetName());
       return false;
     }
 
-    writer.WriteFileOffset(bitmapOffset);
-    writer.Write(dataOffsetBytes);
-
-    if (!writer.SetPos(bitmapOffset)) {
-      progress.Error("Cannot go to type index start position in file");
+    if (!writer.GetPos(endOffset)) {
+      progress.Error("Cannot get type index end position in file");
       return false;
     }
 
-    // Write the bitmap with offsets for each cell
-    // We prefill with zero and only overwrite cells that have data
-    // So zero means "no data for this cell"
-    for (size_t i=0; i<typeData.cellXCount*typeData.cellYCount; i++) {
-      writer.WriteFileOffset(0,
-                             dataOffsetBytes);
-    }
+    progress.Info("Writing map for "+
+                  typeInfo.GetName()+" , "+
+                  NumberToString(typeCellOffsets.size())+" cells, "+
+                  ByteSizeToString(1.0*(endOffset-dataOffset)));
 
-    FileOffset dataStartOffset;
+    assert(typeData.indexOffset!=0);
 
-    if (!writer.GetPos(dataStartOffset)) {
-      progress.Error("Cannot get start of data section after bitmap");
+    if (!writer.SetPos(typeData.indexOffset)) {
+      progress.Error("Cannot go to type index offset in file");
       return false;
     }
 
-    // Now write the list of offsets of objects for every cell with content
-    for (const auto& cell : typeCellOffsets) {
-      FileOffset bitmapCellOffset=bitmapOffset+
-                                  ((cell.first.y-typeData.cellYStart)*typeData.cellXCount+
-                                    cell.first.x-typeData.cellXStart)*(FileOffset)dataOffsetBytes;
-      FileOffset previousOffset=0;
-      FileOffset cellOffset;
-
-      assert(bitmapCellOffset>=bitmapOffset);
-
-      if (!writer.GetPos(cellOffset)) {
-        progress.Error("Cannot get cell start position in file");
-        return false;
-      }
-
-      if (!writer.SetPos(bitmapCellOffset)) {
-        progress.Error("Cannot go to cell start position in file");
-        return false;
-      }
-
-      assert(cellOffset>bitmapCellOffset);
-
-      // We add +1 to make sure, that we can differentiate between "0" as "no entry" and "0" as first data entry.
-      writer.WriteFileOffset(cellOffset-dataStartOffset+1,dataOffsetBytes);
-
-      if (!writer.SetPos(cellOffset)) {
-        progress.Error("Cannot go back to cell start position in file");
-        return false;
-      }
+    writer.WriteFileOffset(directoryOffset);
 
-      writer.WriteNumber((uint32_t)cell.second.size());
-
-      // FileOffsets are already in increasing order, since
-      // File is scanned from start to end
-      for (const auto& offset : cell.second) {
-        assert(offset>previousOffset);
-
-        writer.WriteNumber((FileOffset)(offset-previousOffset));
-
-        previousOffset=offset;
-      }
+    if (!writer.SetPos(endOffset)) {
+      progress.Error("Cannot go to type index end position in file");
+      return false;
     }
 
     return true;
@@ -465,16 +394,14 @@ namespace osmscout {
       size_t i=type->GetIndex();
 
       if (wayTypeData[i].HasEntries()) {
-        uint8_t    dataOffsetBytes=0;
-        FileOffset bitmapOffset=0;
+        FileOffset directoryOffset=0;
 
         writer.WriteTypeId(type->GetWayId(),
                            typeConfig->GetWayTypeIdBytes());
 
         writer.GetPos(wayTypeData[i].indexOffset);
 
-        writer.WriteFileOffset(bitmapOffset);
-        writer.Write(dataOffsetBytes);
+        writer.WriteFileOffset(directoryOffset);
         writer.WriteNumber(wayTypeData[i].indexLevel);
         writer.WriteNumber(wayTypeData[i].cellXStart);
         writer.WriteNumber(wayTypeData[i].cellXEnd);
@@ -566,11 +493,11 @@ namespace osmscout {
       for (const auto &type : indexTypes) {
         size_t index=type->GetIndex();
 
-        if (!WriteBitmap(progress,
-                         writer,
-                         *typeConfig->GetTypeInfo(index),
-                         wayTypeData[index],
-                         typeCellOffsets[index])) {
+        if (!WriteCells(progress,
+                        writer,
+                        *typeConfig->GetTypeInfo(index),
+                        wayTypeData[index],
+                        typeCellOffsets[index])) {
           return false;
         }
       }
@@ -45,20 +45,30 @@
 namespace osmscout {
 
   static const size_t REGION_INDEX_LEVEL=16;
+  static const size_t OBJECT_BLOCK_SIZE=10000;
 
-  LocationIndexGenerator::RegionRef LocationIndexGenerator::RegionIndex::GetRegionForNode(RegionRef& rootRegion,
-                                                                                          const GeoCoord& coord) const
+  Pixel LocationIndexGenerator::RegionIndex::GetCell(const GeoCoord& coord) const
   {
     size_t minX=(coord.GetLon()+180.0)/cellWidth;
     size_t minY=(coord.GetLat()+90.0)/cellHeight;
 
-    std::map<Pixel,std::list<RegionRef> >::const_iterator indexCell=index.find(Pixel(minX,minY));
+    return Pixel(minX,minY);
+  }
+
+  /**
+   * Return the deepest indexed region containing the given coordinate or the root region,
+   * if there is none. Only reads the region tree, so it can be called in parallel.
+   */
+  LocationIndexGenerator::Region& LocationIndexGenerator::RegionIndex::GetRegionForNode(Region& rootRegion,
+                                                                                        const GeoCoord& coord) const
+  {
+    std::map<Pixel,std::list<RegionRef> >::const_iterator indexCell=index.find(GetCell(coord));
 
     if (indexCell!=index.end()) {
       for (const auto& region : indexCell->second) {
         for (size_t i=0; i<region->areas.size(); i++) {
           if (IsCoordInArea(coord,region->areas[i])) {
-            return region;
+            return *region;
           }
         }
       }
@@ -601,26 +611,48 @@ namespace osmscout {
     }
   }
 
-  void LocationIndexGenerator::AddAliasToRegion(Region& region,
-                                                const RegionAlias& location,
-                                                const GeoCoord& node)
+  /**
+   * Group the objects of the block by the region index cell their minimum coordinate
+   * falls into. Objects of the same cell share the same candidate regions, so a bucket
+   * is the unit of work that gets evaluated by one thread.
+   */
+  void LocationIndexGenerator::GetBlockBuckets(const RegionIndex& regionIndex,
+                                               const std::vector<BlockObject>& block,
+                                               std::vector<std::vector<size_t> >& buckets)
+  {
+    std::map<Pixel,size_t> cellBuckets;
+
+    buckets.clear();
+
+    for (size_t o=0; o<block.size(); o++) {
+      Pixel                                  cell=regionIndex.GetCell(block[o].boundingBox.GetMinCoord());
+      std::map<Pixel,size_t>::const_iterator entry=cellBuckets.find(cell);
+
+      if (entry==cellBuckets.end()) {
+        entry=cellBuckets.insert(std::make_pair(cell,buckets.size())).first;
+        buckets.push_back(std::vector<size_t>());
+      }
+
+      buckets[entry->second].push_back(o);
+    }
+  }
+
+  /**
+   * Return the deepest (sub) region of the given region that contains the given coordinate.
+   */
+  LocationIndexGenerator::Region& LocationIndexGenerator::FindRegionForCoord(Region& region,
+                                                                             const GeoCoord& coord)
   {
     for (const auto& childRegion : region.regions) {
       for (size_t i=0; i<childRegion->areas.size(); i++) {
-        if (IsCoordInArea(node,childRegion->areas[i])) {
-          AddAliasToRegion(*childRegion,
-                           location,
-                           node);
-          return;
+        if (IsCoordInArea(coord,childRegion->areas[i])) {
+          return FindRegionForCoord(*childRegion,
+                                    coord);
         }
       }
     }
 
-    if (region.name==location.name) {
-      return;
-    }
-
-    region.aliases.push_back(location);
+    return region;
   }
 
   /**
@@ -632,10 +664,12 @@ namespace osmscout {
                                                 RegionRef& rootRegion,
                                                 const RegionIndex& regionIndex)
   {
-    FileScanner            scanner;
-    uint32_t               nodeCount;
-    size_t                 citiesFound=0;
-    NameFeatureValueReader nameReader(*typeConfig);
+    FileScanner                       scanner;
+    uint32_t                          nodeCount;
+    size_t                            citiesFound=0;
+    NameFeatureValueReader            nameReader(*typeConfig);
+    std::vector<BlockObject>          block;
+    std::vector<std::vector<size_t> > buckets;
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "nodes.dat"),
@@ -670,23 +704,57 @@ namespace osmscout {
 
         if (nameValue==NULL) {
           progress.Warning(std::string("Node ")+NumberToString(node.GetFileOffset())+" has no name, skipping");
-          continue;
         }
+        else {
+          block.push_back(BlockObject());
+
+          BlockObject& object=block.back();
+
+          object.object.Set(node.GetFileOffset(),refNode);
+          object.name=nameValue->GetName();
+          object.nodes.push_back(node.GetCoords());
+          object.boundingBox.Set(node.GetCoords(),
+                                 node.GetCoords());
+        }
+      }
+
+      if (block.size()<OBJECT_BLOCK_SIZE &&
+          n<nodeCount) {
+        continue;
+      }
 
-        RegionAlias alias;
+      GetBlockBuckets(regionIndex,
+                      block,
+                      buckets);
 
-        alias.reference=node.GetFileOffset();
-        alias.name=nameValue->GetName();
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<buckets.size(); b++) {
+        for (const auto& o : buckets[b]) {
+          BlockObject& object=block[o];
+          Region&      region=regionIndex.GetRegionForNode(*rootRegion,
+                                                           object.nodes.front());
 
-        RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                      node.GetCoords());
+          object.regions.push_back(&FindRegionForCoord(region,
+                                                       object.nodes.front()));
+        }
+      }
 
-        AddAliasToRegion(region,
-                         alias,
-                         node.GetCoords());
+      for (const auto& object : block) {
+        Region& region=*object.regions.front();
+
+        if (region.name!=object.name) {
+          RegionAlias alias;
+
+          alias.reference=object.object.GetFileOffset();
+          alias.name=object.name;
+
+          region.aliases.push_back(alias);
+        }
 
         citiesFound++;
       }
+
+      block.clear();
     }
 
     progress.Info(std::string("Found ")+NumberToString(citiesFound)+" cities of type 'node'");
@@ -694,27 +762,33 @@ namespace osmscout {
     return scanner.Close();
   }
 
-  bool LocationIndexGenerator::AddLocationAreaToRegion(Region& region,
-                                                       const Area& area,
-                                                       const std::vector<GeoCoord>& nodes,
-                                                       const std::string& name,
-                                                       double minlon,
-                                                       double minlat,
-                                                       double maxlon,
-                                                       double maxlat)
+  /**
+    Collect the regions the given location area must be added to, the deepest regions first.
+
+    The code is designed to minimize the number of "point in area" checks, it assumes that
+    if one point of an object is in a area it is very likely that all points of the object
+    are in the area.
+    */
+  bool LocationIndexGenerator::FindRegionsForLocationArea(Region& region,
+                                                          const std::vector<CompactGeoCoord>& nodes,
+                                                          const GeoBox& boundingBox,
+                                                          std::vector<Region*>& regions)
   {
     for (const auto& childRegion : region.regions) {
       // Fast check, if the object is in the bounds of the area
-      if (!(maxlon<childRegion->minlon) &&
-          !(minlon>childRegion->maxlon) &&
-          !(maxlat<childRegion->minlat) &&
-          !(minlat>childRegion->maxlat)) {
+      if (!(boundingBox.GetMaxLon()<childRegion->minlon) &&
+          !(boundingBox.GetMinLon()>childRegion->maxlon) &&
+          !(boundingBox.GetMaxLat()<childRegion->minlat) &&
+          !(boundingBox.GetMinLat()>childRegion->maxlat)) {
         for (size_t i=0; i<childRegion->areas.size(); i++) {
           // Check if one point is in the area
           bool match=IsCoordInArea(nodes[0],childRegion->areas[i]);
 
           if (match) {
-            bool completeMatch=AddLocationAreaToRegion(childRegion,area,nodes,name,minlon,minlat,maxlon,maxlat);
+            bool completeMatch=FindRegionsForLocationArea(*childRegion,
+                                                          nodes,
+                                                          boundingBox,
+                                                          regions);
 
             if (completeMatch) {
               // We are done, the object is completely enclosed by one of our sub areas
@@ -727,7 +801,7 @@ namespace osmscout {
 
     // If we (at least partly) contain it, we add it to the area but continue
 
-    region.locations[name].objects.push_back(ObjectFileRef(area.GetFileOffset(),refArea));
+    regions.push_back(&region);
 
     for (size_t i=0; i<region.areas.size(); i++) {
       if (IsAreaCompletelyInArea(nodes,region.areas[i])) {
@@ -738,70 +812,18 @@ namespace osmscout {
     return false;
   }
 
-  /**
-    Add the given location area to the hierarchical area index.
-
-    The code is designed to minimize the number of "point in area" checks, it assumes that
-    if one point of an object is in a area it is very likely that all points of the object
-    are in the area.
-    */
-  void LocationIndexGenerator::AddLocationAreaToRegion(RegionRef& rootRegion,
-                                                       const Area& area,
-                                                       const Area::Ring& ring,
-                                                       const std::string& name,
-                                                       const RegionIndex& regionIndex)
-  {
-    if (ring.ring==Area::masterRingId &&
-        ring.nodes.empty()) {
-      for (const auto& r : area.rings) {
-        if (r.ring==Area::outerRingId) {
-          GeoBox boundingBox;
-
-          r.GetBoundingBox(boundingBox);
-
-          RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                        boundingBox.GetMinCoord());
-
-          AddLocationAreaToRegion(region,
-                                  area,
-                                  r.nodes,
-                                  name,
-                                  boundingBox.GetMinLon(),
-                                  boundingBox.GetMinLat(),
-                                  boundingBox.GetMaxLon(),
-                                  boundingBox.GetMaxLat());
-        }
-      }
-    }
-    else {
-      GeoBox boundingBox;
-
-      ring.GetBoundingBox(boundingBox);
-
-      RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                    boundingBox.GetMinCoord());
-
-      AddLocationAreaToRegion(region,
-                              area,
-                              ring.nodes,
-                              name,
-                              boundingBox.GetMinLon(),
-                              boundingBox.GetMinLat(),
-                              boundingBox.GetMaxLon(),
-                              boundingBox.GetMaxLat());
-    }
-  }
-
   bool LocationIndexGenerator::IndexLocationAreas(const TypeConfig& typeConfig,
                                                   const ImportParameter& parameter,
                                                   Progress& progress,
                                                   RegionRef& rootRegion,
                                                   const RegionIndex& regionIndex)
   {
-    FileScanner            scanner;
-    uint32_t               areaCount;
-    size_t                 areasFound=0;
-    NameFeatureValueReader nameReader(typeConfig);
+    FileScanner                       scanner;
+    uint32_t                          areaCount;
+    size_t                            areasFound=0;
+    NameFeatureValueReader            nameReader(typeConfig);
+    std::vector<BlockObject>          block;
+    std::vector<std::vector<size_t> > buckets;
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "areas.dat"),
@@ -836,16 +858,69 @@ namespace osmscout {
           NameFeatureValue *nameValue=nameReader.GetValue(ring.GetFeatureValueBuffer());
 
           if (nameValue!=NULL) {
-            AddLocationAreaToRegion(rootRegion,
-                                    area,
-                                    ring,
-                                    nameValue->GetName(),
-                                    regionIndex);
+            if (ring.ring==Area::masterRingId &&
+                ring.nodes.empty()) {
+              for (const auto& r : area.rings) {
+                if (r.ring==Area::outerRingId) {
+                  block.push_back(BlockObject());
+
+                  BlockObject& object=block.back();
+
+                  object.object.Set(area.GetFileOffset(),refArea);
+                  object.name=nameValue->GetName();
+                  object.nodes=r.nodes;
+
+                  r.GetBoundingBox(object.boundingBox);
+                }
+              }
+            }
+            else {
+              block.push_back(BlockObject());
+
+              BlockObject& object=block.back();
+
+              object.object.Set(area.GetFileOffset(),refArea);
+              object.name=nameValue->GetName();
+              object.nodes=ring.nodes;
+
+              ring.GetBoundingBox(object.boundingBox);
+            }
 
             areasFound++;
           }
         }
       }
+
+      if (block.size()<OBJECT_BLOCK_SIZE &&
+          w<areaCount) {
+        continue;
+      }
+
+      GetBlockBuckets(regionIndex,
+                      block,
+                      buckets);
+
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<buckets.size(); b++) {
+        for (const auto& o : buckets[b]) {
+          BlockObject& object=block[o];
+          Region&      region=regionIndex.GetRegionForNode(*rootRegion,
+                                                           object.boundingBox.GetMinCoord());
+
+          FindRegionsForLocationArea(region,
+                                     object.nodes,
+                                     object.boundingBox,
+                                     object.regions);
+        }
+      }
+
+      for (const auto& object : block) {
+        for (const auto& region : object.regions) {
+          region->locations[object.name].objects.push_back(object.object);
+        }
+      }
+
+      block.clear();
     }
 
     progress.Info(std::string("Found ")+NumberToString(areasFound)+" locations of type 'area'");
@@ -854,32 +929,32 @@ namespace osmscout {
   }
 
   /**
-    Add the given location way to the hierarchical area index.
+    Collect the regions the given way must be added to, the deepest regions first.
 
     The code is designed to minimize the number of "point in area" checks, it assumes that
     if one point of an object is in a area it is very likely that all points of the object
     are in the area.
     */
-  bool LocationIndexGenerator::AddLocationWayToRegion(Region& region,
-                                                      const Way& way,
-                                                      const std::string& name,
-                                                      double minlon,
-                                                      double minlat,
-                                                      double maxlon,
-                                                      double maxlat)
+  bool LocationIndexGenerator::FindRegionsForWay(Region& region,
+                                                 const std::vector<CompactGeoCoord>& nodes,
+                                                 const GeoBox& boundingBox,
+                                                 std::vector<Region*>& regions)
   {
     for (const auto& childRegion : region.regions) {
       // Fast check, if the object is in the bounds of the area
-      if (!(maxlon<childRegion->minlon) &&
-          !(minlon>childRegion->maxlon) &&
-          !(maxlat<childRegion->minlat) &&
-          !(minlat>childRegion->maxlat)) {
+      if (!(boundingBox.GetMaxLon()<childRegion->minlon) &&
+          !(boundingBox.GetMinLon()>childRegion->maxlon) &&
+          !(boundingBox.GetMaxLat()<childRegion->minlat) &&
+          !(boundingBox.GetMinLat()>childRegion->maxlat)) {
         // Check if one point is in the area
         for (size_t i=0; i<childRegion->areas.size(); i++) {
-          bool match=IsAreaAtLeastPartlyInArea(way.nodes,childRegion->areas[i]);
+          bool match=IsAreaAtLeastPartlyInArea(nodes,childRegion->areas[i]);
 
           if (match) {
-            bool completeMatch=AddLocationWayToRegion(childRegion,way,name,minlon,minlat,maxlon,maxlat);
+            bool completeMatch=FindRegionsForWay(*childRegion,
+                                                 nodes,
+                                                 boundingBox,
+                                                 regions);
 
             if (completeMatch) {
               // We are done, the object is completely enclosed by one of our sub areas
@@ -892,10 +967,10 @@ namespace osmscout {
 
     // If we (at least partly) contain it, we add it to the area but continue
 
-    region.locations[name].objects.push_back(ObjectFileRef(way.GetFileOffset(),refWay));
+    regions.push_back(&region);
 
     for (size_t i=0; i<region.areas.size(); i++) {
-      if (IsAreaCompletelyInArea(way.nodes,region.areas[i])) {
+      if (IsAreaCompletelyInArea(nodes,region.areas[i])) {
         return true;
       }
     }
@@ -909,10 +984,12 @@ namespace osmscout {
                                                  RegionRef& rootRegion,
                                                  const RegionIndex& regionIndex)
   {
-    FileScanner            scanner;
-    uint32_t               wayCount;
-    size_t                 waysFound=0;
-    NameFeatureValueReader nameReader(*typeConfig);
+    FileScanner                       scanner;
+    uint32_t                          wayCount;
+    size_t                            waysFound=0;
+    NameFeatureValueReader            nameReader(*typeConfig);
+    std::vector<BlockObject>          block;
+    std::vector<std::vector<size_t> > buckets;
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "ways.dat"),
@@ -943,32 +1020,54 @@ namespace osmscout {
         return false;
       }
 
-      if (!way.GetType()->GetIndexAsLocation()) {
-        continue;
-      }
+      if (way.GetType()->GetIndexAsLocation()) {
+        NameFeatureValue *nameValue=nameReader.GetValue(way.GetFeatureValueBuffer());
 
-      NameFeatureValue *nameValue=nameReader.GetValue(way.GetFeatureValueBuffer());
+        if (nameValue!=NULL) {
+          block.push_back(BlockObject());
 
-      if (nameValue==NULL) {
+          BlockObject& object=block.back();
+
+          object.object.Set(way.GetFileOffset(),refWay);
+          object.name=nameValue->GetName();
+
+          way.GetBoundingBox(object.boundingBox);
+          object.nodes.swap(way.nodes);
+
+          waysFound++;
+        }
+      }
+
+      if (block.size()<OBJECT_BLOCK_SIZE &&
+          w<wayCount) {
         continue;
       }
 
-      GeoBox boundingBox;
+      GetBlockBuckets(regionIndex,
+                      block,
+                      buckets);
 
-      way.GetBoundingBox(boundingBox);
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<buckets.size(); b++) {
+        for (const auto& o : buckets[b]) {
+          BlockObject& object=block[o];
+          Region&      region=regionIndex.GetRegionForNode(*rootRegion,
+                                                           object.boundingBox.GetMinCoord());
 
-      RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                    boundingBox.GetMinCoord());
+          FindRegionsForWay(region,
+                            object.nodes,
+                            object.boundingBox,
+                            object.regions);
+        }
+      }
 
-      AddLocationWayToRegion(region,
-                             way,
-                             nameValue->GetName(),
-                             boundingBox.GetMinLon(),
-                             boundingBox.GetMinLat(),
-                             boundingBox.GetMaxLon(),
-                             boundingBox.GetMaxLat());
+      for (const auto& object : block) {
+        for (const auto& region : object.regions) {
+          region->locations[object.name].objects.push_back(object.object);
+        }
+      }
 
-      waysFound++;
+      block.clear();
     }
 
     progress.Info(std::string("Found ")+NumberToString(waysFound)+" locations of type 'way'");
@@ -976,45 +1075,43 @@ namespace osmscout {
     return scanner.Close();
   }
 
-  void LocationIndexGenerator::AddAddressAreaToRegion(Progress& progress,
-                                                      Region& region,
-                                                      const FileOffset& fileOffset,
-                                                      const std::string& location,
-                                                      const std::string& address,
-                                                      const std::vector<GeoCoord>& nodes,
-                                                      double minlon,
-                                                      double minlat,
-                                                      double maxlon,
-                                                      double maxlat,
-                                                      bool& added)
+  /**
+   * Return the deepest (sub) region of the given region that completely contains the given area.
+   */
+  LocationIndexGenerator::Region& LocationIndexGenerator::FindRegionForArea(Region& region,
+                                                                            const std::vector<CompactGeoCoord>& nodes,
+                                                                            const GeoBox& boundingBox)
   {
     for (const auto& childRegion : region.regions) {
       // Fast check, if the object is in the bounds of the area
-      if (!(maxlon<childRegion->minlon) &&
-          !(minlon>childRegion->maxlon) &&
-          !(maxlat<childRegion->minlat) &&
-          !(minlat>childRegion->maxlat)) {
+      if (!(boundingBox.GetMaxLon()<childRegion->minlon) &&
+          !(boundingBox.GetMinLon()>childRegion->maxlon) &&
+          !(boundingBox.GetMaxLat()<childRegion->minlat) &&
+          !(boundingBox.GetMinLat()>childRegion->maxlat)) {
         for (size_t i=0; i<childRegion->areas.size(); i++) {
           if (IsAreaCompletelyInArea(nodes,childRegion->areas[i])) {
-            AddAddressAreaToRegion(progress,
-                                   childRegion,
-                                   fileOffset,
-                                   location,
-                                   address,
-                                   nodes,
-                                   minlon,minlat,maxlon,maxlat,
-                                   added);
-            return;
+            return FindRegionForArea(*childRegion,
+                                     nodes,
+                                     boundingBox);
           }
         }
       }
     }
 
+    return region;
+  }
+
+  void LocationIndexGenerator::AddAddressToRegion(Progress& progress,
+                                                  Region& region,
+                                                  const ObjectFileRef& object,
+                                                  const std::string& location,
+                                                  const std::string& address,
+                                                  bool& added)
+  {
     std::map<std::string,RegionLocation>::iterator loc=region.locations.find(location);
 
     if (loc==region.locations.end()) {
-      progress.Debug(std::string("Street of address '")+location +"' '"+address+"' of Area "+NumberToString(fileOffset)+" cannot be resolved in region '"+region.name+"'");
-
+      progress.Debug(std::string("Street of address '")+location +"' '"+address+"' of "+object.GetTypeName()+" "+NumberToString(object.GetFileOffset())+" cannot be resolved in region '"+region.name+"'");
       return;
     }
 
@@ -1027,49 +1124,22 @@ namespace osmscout {
     RegionAddress regionAddress;
 
     regionAddress.name=address;
-    regionAddress.object.Set(fileOffset,refArea);
+    regionAddress.object=object;
 
     loc->second.addresses.push_back(regionAddress);
 
     added=true;
   }
 
-  void LocationIndexGenerator::AddPOIAreaToRegion(Progress& progress,
-                                                  Region& region,
-                                                  const FileOffset& fileOffset,
-                                                  const std::string& name,
-                                                  const std::vector<GeoCoord>& nodes,
-                                                  double minlon,
-                                                  double minlat,
-                                                  double maxlon,
-                                                  double maxlat,
-                                                  bool& added)
+  void LocationIndexGenerator::AddPOIToRegion(Region& region,
+                                              const ObjectFileRef& object,
+                                              const std::string& name,
+                                              bool& added)
   {
-    for (const auto& childRegion : region.regions) {
-      // Fast check, if the object is in the bounds of the area
-      if (!(maxlon<childRegion->minlon) &&
-          !(minlon>childRegion->maxlon) &&
-          !(maxlat<childRegion->minlat) &&
-          !(minlat>childRegion->maxlat)) {
-        for (size_t i=0; i<childRegion->areas.size(); i++) {
-          if (IsAreaCompletelyInArea(nodes,childRegion->areas[i])) {
-            AddPOIAreaToRegion(progress,
-                               childRegion,
-                               fileOffset,
-                               name,
-                               nodes,
-                               minlon,minlat,maxlon,maxlat,
-                               added);
-            return;
-          }
-        }
-      }
-    }
-
     RegionPOI poi;
 
     poi.name=name;
-    poi.object.Set(fileOffset,refArea);
+    poi.object=object;
 
     region.pois.push_back(poi);
 
@@ -1082,10 +1152,12 @@ namespace osmscout {
                                                  RegionRef& rootRegion,
                                                  const RegionIndex& regionIndex)
   {
-    FileScanner scanner;
-    uint32_t    areaCount;
-    size_t      addressFound=0;
-    size_t      poiFound=0;
+    FileScanner                       scanner;
+    uint32_t                          areaCount;
+    size_t                            addressFound=0;
+    size_t                            poiFound=0;
+    std::vector<BlockObject>          block;
+    std::vector<std::vector<size_t> > buckets;
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "areaaddress.dat"),
@@ -1100,14 +1172,14 @@ namespace osmscout {
       return false;
     }
 
-    FileOffset            fileOffset;
-    uint32_t              tmpType;
-    TypeId                typeId;
-    TypeInfoRef           type;
-    std::string           name;
-    std::string           location;
-    std::string           address;
-    std::vector<GeoCoord> nodes;
+    FileOffset                   fileOffset;
+    uint32_t                     tmpType;
+    TypeId                       typeId;
+    TypeInfoRef                  type;
+    std::string                  name;
+    std::string                  location;
+    std::string                  address;
+    std::vector<CompactGeoCoord> nodes;
 
     for (uint32_t a=1; a<=areaCount; a++) {
       progress.SetProgress(a,areaCount);
@@ -1134,62 +1206,80 @@ namespace osmscout {
       bool isPOI=!name.empty() &&
                  type->GetIndexAsPOI();
 
-      if (!isAddress && !isPOI) {
+      if (isAddress || isPOI) {
+        block.push_back(BlockObject());
+
+        BlockObject& object=block.back();
+
+        object.object.Set(fileOffset,refArea);
+
+        if (isAddress) {
+          object.location=location;
+          object.address=address;
+        }
+
+        if (isPOI) {
+          object.name=name;
+        }
+
+        GetBoundingBox(nodes,
+                       object.boundingBox);
+        object.nodes.swap(nodes);
+      }
+
+      if (block.size()<OBJECT_BLOCK_SIZE &&
+          a<areaCount) {
         continue;
       }
 
-      double minlon;
-      double maxlon;
-      double minlat;
-      double maxlat;
+      GetBlockBuckets(regionIndex,
+                      block,
+                      buckets);
 
-      GetBoundingBox(nodes,
-                     minlon,
-                     maxlon,
-                     minlat,
-                     maxlat);
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<buckets.size(); b++) {
+        for (const auto& o : buckets[b]) {
+          BlockObject& object=block[o];
+          Region&      region=regionIndex.GetRegionForNode(*rootRegion,
+                                                           object.boundingBox.GetMinCoord());
 
-      RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                    GeoCoord(minlat,minlon));
+          object.regions.push_back(&FindRegionForArea(region,
+                                                      object.nodes,
+                                                      object.boundingBox));
+        }
+      }
 
-      if (isAddress) {
-        bool added=false;
+      for (const auto& object : block) {
+        if (!object.address.empty()) {
+          bool added=false;
 
-        AddAddressAreaToRegion(progress,
-                               region,
-                               fileOffset,
-                               location,
-                               address,
-                               nodes,
-                               minlon,
-                               minlat,
-                               maxlon,
-                               maxlat,
-                               added);
+          AddAddressToRegion(progress,
+                             *object.regions.front(),
+                             object.object,
+                             object.location,
+                             object.address,
+                             added);
 
-        if (added) {
-          addressFound++;
+          if (added) {
+            addressFound++;
+          }
         }
-      }
 
-      if (isPOI) {
-        bool added=false;
+        if (!object.name.empty()) {
+          bool added=false;
 
-        AddPOIAreaToRegion(progress,
-                           region,
-                           fileOffset,
-                           name,
-                           nodes,
-                           minlon,
-                           minlat,
-                           maxlon,
-                           maxlat,
-                           added);
+          AddPOIToRegion(*object.regions.front(),
+                         object.object,
+                         object.name,
+                         added);
 
-        if (added) {
-          poiFound++;
+          if (added) {
+            poiFound++;
+          }
         }
       }
+
+      block.clear();
     }
 
     progress.Info(NumberToString(areaCount)+" areas analyzed, "+NumberToString(addressFound)+" addresses founds, "+NumberToString(poiFound)+" POIs founds");
@@ -1202,7 +1292,7 @@ namespace osmscout {
                                                      const FileOffset& fileOffset,
                                                      const std::string& location,
                                                      const std::string& address,
-                                                     const std::vector<GeoCoord>& nodes,
+                                                     const std::vector<CompactGeoCoord>& nodes,
                                                      double minlon,
                                                      double minlat,
                                                      double maxlon,
@@ -1272,80 +1362,18 @@ namespace osmscout {
     return false;
   }
 
-  bool LocationIndexGenerator::AddPOIWayToRegion(Progress& progress,
-                                                 Region& region,
-                                                 const FileOffset& fileOffset,
-                                                 const std::string& name,
-                                                 const std::vector<GeoCoord>& nodes,
-                                                 double minlon,
-                                                 double minlat,
-                                                 double maxlon,
-                                                 double maxlat,
-                                                 bool& added)
-  {
-    for (std::list<RegionRef>::iterator r=region.regions.begin();
-         r!=region.regions.end();
-         r++) {
-      RegionRef childRegion(*r);
-
-      // Fast check, if the object is in the bounds of the area
-      if (!(maxlon<childRegion->minlon) &&
-          !(minlon>childRegion->maxlon) &&
-          !(maxlat<childRegion->minlat) &&
-          !(minlat>childRegion->maxlat)) {
-        // Check if one point is in the area
-        for (size_t i=0; i<childRegion->areas.size(); i++) {
-          bool match=IsAreaAtLeastPartlyInArea(nodes,childRegion->areas[i]);
-
-          if (match) {
-            bool completeMatch=AddPOIWayToRegion(progress,
-                                                 *r,
-                                                 fileOffset,
-                                                 name,
-                                                 nodes,
-                                                 minlon,
-                                                 minlat,
-                                                 maxlon,
-                                                 maxlat,
-                                                 added);
-
-            if (completeMatch) {
-              // We are done, the object is completely enclosed by one of our sub areas
-              return true;
-            }
-          }
-        }
-      }
-    }
-
-    RegionPOI poi;
-
-    poi.name=name;
-    poi.object.Set(fileOffset,refWay);
-
-    region.pois.push_back(poi);
-
-    added=true;
-
-    for (size_t i=0; i<region.areas.size(); i++) {
-      if (IsAreaCompletelyInArea(nodes,region.areas[i])) {
-        return true;
-      }
-    }
-
-    return false;
-  }
-
   bool LocationIndexGenerator::IndexAddressWays(const TypeConfig& typeConfig,
                                                 const ImportParameter& parameter,
                                                 Progress& progress,
                                                 RegionRef& rootRegion,
                                                 const RegionIndex& regionIndex)
   {
-    FileScanner scanner;
-    uint32_t    wayCount;
+    FileScanner                       scanner;
+    uint32_t                          wayCount;
     //size_t      addressFound=0;
-    size_t      poiFound=0;
+    size_t                            poiFound=0;
+    std::vector<BlockObject>          block;
+    std::vector<std::vector<size_t> > buckets;
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "wayaddress.dat"),
@@ -1360,13 +1388,13 @@ namespace osmscout {
       return false;
     }
 
-    FileOffset            fileOffset;
-    uint32_t              tmpType;
-    TypeId                typeId;
-    TypeInfoRef           type;
-    std::string           name;
-    std::string           location;
-    std::vector<GeoCoord> nodes;
+    FileOffset                   fileOffset;
+    uint32_t                     tmpType;
+    TypeId                       typeId;
+    TypeInfoRef                  type;
+    std::string                  name;
+    std::string                  location;
+    std::vector<CompactGeoCoord> nodes;
 
     for (uint32_t w=1; w<=wayCount; w++) {
       progress.SetProgress(w,wayCount);
@@ -1390,67 +1418,63 @@ namespace osmscout {
       bool isPOI=!name.empty() &&
                  type->GetIndexAsPOI();
 
-      if (!isPOI) {
-        continue;
-      }
+      // Addresses of ways are currently not indexed, see AddAddressWayToRegion()
+      if (isPOI) {
+        if (nodes.size()==0) {
+          std::cerr << "Way " << fileOffset << " has no nodes" << std::endl;
+        }
+
+        block.push_back(BlockObject());
 
-      double minlon;
-      double maxlon;
-      double minlat;
-      double maxlat;
+        BlockObject& object=block.back();
 
-      if (nodes.size()==0) {
-        std::cerr << "Way " << fileOffset << " has no nodes" << std::endl;
+        object.object.Set(fileOffset,refWay);
+        object.name=name;
+
+        GetBoundingBox(nodes,
+                       object.boundingBox);
+        object.nodes.swap(nodes);
       }
 
-      GetBoundingBox(nodes,
-                     minlon,
-                     maxlon,
-                     minlat,
-                     maxlat);
+      if (block.size()<OBJECT_BLOCK_SIZE &&
+          w<wayCount) {
+        continue;
+      }
 
-      RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                    GeoCoord(minlat,minlon));
+      GetBlockBuckets(regionIndex,
+                      block,
+                      buckets);
 
-      /*
-      if (isAddress) {
-        bool added=false;
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<buckets.size(); b++) {
+        for (const auto& o : buckets[b]) {
+          BlockObject& object=block[o];
+          Region&      region=regionIndex.GetRegionForNode(*rootRegion,
+                                                           object.boundingBox.GetMinCoord());
 
-        AddAddressWayToRegion(progress,
-                              region,
-                              fileOffset,
-                              location,
-                              address,
-                              nodes,
-                              minlon,
-                              minlat,
-                              maxlon,
-                              maxlat,
-                              added);
-
-      if (added) {
-        addressFound++;
+          FindRegionsForWay(region,
+                            object.nodes,
+                            object.boundingBox,
+                            object.regions);
         }
-      }*/
+      }
 
-      if (isPOI) {
+      for (const auto& object : block) {
         bool added=false;
 
-        AddPOIWayToRegion(progress,
-                          region,
-                          fileOffset,
-                          name,
-                          nodes,
-                          minlon,
-                          minlat,
-                          maxlon,
-                          maxlat,
-                          added);
-
-      if (added) {
+        for (const auto& region : object.regions) {
+          AddPOIToRegion(*region,
+                         object.object,
+                         object.name,
+                         added);
+        }
+
+        if (added) {
           poiFound++;
         }
       }
+
+      block.clear();
     }
 
     progress.Info(NumberToString(wayCount)+" ways analyzed, "/*+NumberToString(addressFound)+" addresses founds, "*/+NumberToString(poiFound)+" POIs founds");
@@ -1458,61 +1482,18 @@ namespace osmscout {
     return scanner.Close();
   }
 
-  void LocationIndexGenerator::AddAddressNodeToRegion(Progress& progress,
-                                                      Region& region,
-                                                      const FileOffset& fileOffset,
-                                                      const std::string& location,
-                                                      const std::string& address,
-                                                      bool& added)
-  {
-    std::map<std::string,RegionLocation>::iterator loc=region.locations.find(location);
-
-    if (loc==region.locations.end()) {
-      progress.Debug(std::string("Street of address '")+location +"' '"+address+"' of Node "+NumberToString(fileOffset)+" cannot be resolved in region '"+region.name+"'");
-      return;
-    }
-
-    for (const auto& regionAddress : loc->second.addresses) {
-      if (regionAddress.name==address) {
-        return;
-      }
-    }
-
-    RegionAddress regionAddress;
-
-    regionAddress.name=address;
-    regionAddress.object.Set(fileOffset,refNode);
-
-    loc->second.addresses.push_back(regionAddress);
-
-    added=true;
-  }
-
-  void LocationIndexGenerator::AddPOINodeToRegion(Region& region,
-                                                  const FileOffset& fileOffset,
-                                                  const std::string& name,
-                                                  bool& added)
-  {
-    RegionPOI poi;
-
-    poi.name=name;
-    poi.object.Set(fileOffset,refNode);
-
-    region.pois.push_back(poi);
-
-    added=true;
-  }
-
   bool LocationIndexGenerator::IndexAddressNodes(const TypeConfig& typeConfig,
                                                  const ImportParameter& parameter,
                                                  Progress& progress,
                                                  RegionRef& rootRegion,
                                                  const RegionIndex& regionIndex)
   {
-    FileScanner scanner;
-    uint32_t    nodeCount;
-    size_t      addressFound=0;
-    size_t      poiFound=0;
+    FileScanner                       scanner;
+    uint32_t                          nodeCount;
+    size_t                            addressFound=0;
+    size_t                            poiFound=0;
+    std::vector<BlockObject>          block;
+    std::vector<std::vector<size_t> > buckets;
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "nodeaddress.dat"),
@@ -1561,42 +1542,77 @@ namespace osmscout {
       bool isPOI=!name.empty() &&
                  type->GetIndexAsPOI();
 
-      if (!isAddress && !isPOI) {
-        continue;
-      }
+      if (isAddress || isPOI) {
+        block.push_back(BlockObject());
+
+        BlockObject& object=block.back();
+
+        object.object.Set(fileOffset,refNode);
 
-      RegionRef region=regionIndex.GetRegionForNode(rootRegion,
-                                                    coord);
+        if (isAddress) {
+          object.location=location;
+          object.address=address;
+        }
+
+        if (isPOI) {
+          object.name=name;
+        }
 
-      if (!region.Valid()) {
+        object.nodes.push_back(coord);
+        object.boundingBox.Set(coord,
+                               coord);
+      }
+
+      if (block.size()<OBJECT_BLOCK_SIZE &&
+          n<nodeCount) {
         continue;
       }
 
-      if (isAddress) {
-        bool added=false;
+      GetBlockBuckets(regionIndex,
+                      block,
+                      buckets);
 
-        AddAddressNodeToRegion(progress,
-                               region,
-                               fileOffset,
-                               location,
-                               address,
-                               added);
-        if (added) {
-          addressFound++;
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<buckets.size(); b++) {
+        for (const auto& o : buckets[b]) {
+          BlockObject& object=block[o];
+
+          object.regions.push_back(&regionIndex.GetRegionForNode(*rootRegion,
+                                                                 object.nodes.front()));
         }
       }
 
-      if (isPOI) {
-        bool added=false;
+      for (const auto& object : block) {
+        if (!object.address.empty()) {
+          bool added=false;
 
-        AddPOINodeToRegion(region,
-                           fileOffset,
-                           name,
-                           added);
-        if (added) {
-          poiFound++;
+          AddAddressToRegion(progress,
+                             *object.regions.front(),
+                             object.object,
+                             object.location,
+                             object.address,
+                             added);
+
+          if (added) {
+            addressFound++;
+          }
+        }
+
+        if (!object.name.empty()) {
+          bool added=false;
+
+          AddPOIToRegion(*object.regions.front(),
+                         object.object,
+                         object.name,
+                         added);
+
+          if (added) {
+            poiFound++;
+          }
         }
       }
+
+      block.clear();
     }
 
     progress.Info(NumberToString(nodeCount)+" nodes analyzed, "+NumberToString(addressFound)+" addresses founds, "+NumberToString(poiFound)+" POIs founds");
@@ -1746,6 +1762,8 @@ namespace osmscout {
     for (auto& location : region.locations) {
       location.second.objects.sort(ObjectFileRefByFileOffsetComparator());
 
+      writer.GetPos(location.second.locationOffset);
+
       writer.Write(location.first);
       writer.WriteNumber((uint32_t)location.second.objects.size()); // Number of objects
 
@@ -1838,6 +1856,197 @@ namespace osmscout {
     return true;
   }
 
+  void LocationIndexGenerator::AddLocationTokenIndexEntry(LocationTokenIndex::EntryType type,
+                                                          FileOffset regionOffset,
+                                                          FileOffset offset,
+                                                          const std::set<std::string>& terms,
+                                                          std::vector<LocationTokenIndex::Entry>& entries,
+                                                          TermEntryIdsMap& termEntryIds)
+  {
+    if (terms.empty()) {
+      return;
+    }
+
+    LocationTokenIndex::Entry entry;
+    uint32_t                  id=(uint32_t)entries.size();
+
+    entry.type=type;
+    entry.regionOffset=regionOffset;
+    entry.offset=offset;
+
+    entries.push_back(entry);
+
+    // Ids are assigned in increasing order, so the id lists stay sorted
+    for (const auto& term : terms) {
+      termEntryIds[term].push_back(id);
+    }
+  }
+
+  void LocationIndexGenerator::CollectLocationTokenIndexEntries(const Region& region,
+                                                                std::vector<LocationTokenIndex::Entry>& entries,
+                                                                TermEntryIdsMap& termEntryIds)
+  {
+    std::set<std::string> terms;
+
+    LocationTokenIndex::GetIndexTerms(region.name,
+                                      terms);
+
+    for (const auto& alias : region.aliases) {
+      LocationTokenIndex::GetIndexTerms(alias.name,
+                                        terms);
+    }
+
+    AddLocationTokenIndexEntry(LocationTokenIndex::entryRegion,
+                               region.indexOffset,
+                               region.indexOffset,
+                               terms,
+                               entries,
+                               termEntryIds);
+
+    // All POIs of a region are read at once, so they share one entry
+    terms.clear();
+
+    for (const auto& poi : region.pois) {
+      LocationTokenIndex::GetIndexTerms(poi.name,
+                                        terms);
+    }
+
+    AddLocationTokenIndexEntry(LocationTokenIndex::entryPOI,
+                               region.indexOffset,
+                               region.dataOffset,
+                               terms,
+                               entries,
+                               termEntryIds);
+
+    for (const auto& location : region.locations) {
+      terms.clear();
+
+      LocationTokenIndex::GetIndexTerms(location.first,
+                                        terms);
+
+      AddLocationTokenIndexEntry(LocationTokenIndex::entryLocation,
+                                 region.indexOffset,
+                                 location.second.locationOffset,
+                                 terms,
+                                 entries,
+                                 termEntryIds);
+    }
+
+    for (const auto& childRegion : region.regions) {
+      CollectLocationTokenIndexEntries(*childRegion,
+                                       entries,
+                                       termEntryIds);
+    }
+  }
+
+  /**
+   * Write the location token index, mapping all index terms of the names
+   * of regions, POIs and locations to their entries in the location index.
+   * See LocationTokenIndex::Load() for a description of the file format.
+   */
+  bool LocationIndexGenerator::WriteLocationTokenIndex(const ImportParameter& parameter,
+                                                       Progress& progress,
+                                                       const Region& rootRegion)
+  {
+    std::vector<LocationTokenIndex::Entry> entries;
+    TermEntryIdsMap                        termEntryIds;
+
+    for (const auto& childRegion : rootRegion.regions) {
+      CollectLocationTokenIndexEntries(*childRegion,
+                                       entries,
+                                       termEntryIds);
+    }
+
+    FileWriter writer;
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     LocationTokenIndex::FILENAME_LOCATIONTOKEN_IDX))) {
+      progress.Error("Cannot open '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    FileOffset termIndexOffsetOffset;
+
+    if (!writer.GetPos(termIndexOffsetOffset) ||
+        !writer.WriteFileOffset(0)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    writer.WriteNumber((uint32_t)entries.size());
+
+    for (const auto& entry : entries) {
+      writer.Write((uint8_t)entry.type);
+      writer.WriteFileOffset(entry.regionOffset);
+      writer.WriteFileOffset(entry.offset);
+    }
+
+    std::vector<FileOffset> postingOffsets;
+
+    postingOffsets.reserve(termEntryIds.size());
+
+    for (const auto& term : termEntryIds) {
+      FileOffset postingOffset;
+      uint32_t   lastId=0;
+
+      writer.GetPos(postingOffset);
+
+      postingOffsets.push_back(postingOffset);
+
+      writer.WriteNumber((uint32_t)term.second.size());
+
+      for (const auto& id : term.second) {
+        writer.WriteNumber(id-lastId);
+
+        lastId=id;
+      }
+    }
+
+    std::list<std::pair<std::string,FileOffset> > termIndex;
+    size_t                                        termPos=0;
+
+    for (const auto& term : termEntryIds) {
+      if (termPos%LocationTokenIndex::TERM_INDEX_INTERVAL==0) {
+        FileOffset termOffset;
+
+        writer.GetPos(termOffset);
+
+        termIndex.push_back(std::make_pair(term.first,
+                                           termOffset));
+      }
+
+      writer.Write(term.first);
+      writer.WriteFileOffset(postingOffsets[termPos]);
+
+      termPos++;
+    }
+
+    FileOffset termIndexOffset;
+
+    if (!writer.GetPos(termIndexOffset)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    writer.WriteNumber((uint32_t)termEntryIds.size());
+    writer.WriteNumber((uint32_t)termIndex.size());
+
+    for (const auto& indexEntry : termIndex) {
+      writer.Write(indexEntry.first);
+      writer.WriteFileOffset(indexEntry.second);
+    }
+
+    if (!writer.SetPos(termIndexOffsetOffset) ||
+        !writer.WriteFileOffset(termIndexOffset)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    progress.Info(NumberToString(entries.size())+" entries, "+NumberToString(termEntryIds.size())+" terms");
+
+    return !writer.HasError() && writer.Close();
+  }
+
   std::string LocationIndexGenerator::GetDescription() const
   {
     return "Generate 'location.idx'";
@@ -2086,6 +2295,14 @@ namespace osmscout {
       return false;
     }
 
+    progress.SetAction(std::string("Write '")+LocationTokenIndex::FILENAME_LOCATIONTOKEN_IDX+"'");
+
+    if (!WriteLocationTokenIndex(parameter,
+                                 progress,
+                                 *rootRegion)) {
+      return false;
+    }
+
     return true;
   }
 }
@@ -262,8 +262,8 @@ namespace osmscout
             }
 
             if (otherWay!=match->second.end()) {
-              std::vector<Id>       newIds;
-              std::vector<GeoCoord> newNodes;
+              std::vector<Id>              newIds;
+              std::vector<CompactGeoCoord> newNodes;
 
               newIds.reserve(way->ids.size()+(*otherWay)->ids.size()-1);
               newNodes.reserve(way->nodes.size()+(*otherWay)->nodes.size()-1);
@@ -471,12 +471,12 @@ namespace osmscout
     projection.Set(0,0,magnification,dpi,width,height);
 
     for (auto &way :ways) {
-      TransPolygon          polygon;
-      std::vector<GeoCoord> newNodes;
-      double                xmin;
-      double                xmax;
-      double                ymin;
-      double                ymax;
+      TransPolygon                 polygon;
+      std::vector<CompactGeoCoord> newNodes;
+      double                       xmin;
+      double                       xmax;
+      double                       ymin;
+      double                       ymax;
 
       polygon.TransformWay(projection,
                            optimizeWayMethod,
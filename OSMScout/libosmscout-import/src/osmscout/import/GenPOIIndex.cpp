@@ -0,0 +1,396 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenPOIIndex.h>
+
+#include <algorithm>
+
+#include <osmscout/Area.h>
+#include <osmscout/Node.h>
+#include <osmscout/POIIndex.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  void POIIndexGenerator::AddEntry(const TypeInfoRef& type,
+                                   const GeoCoord& coord,
+                                   const ObjectFileRef& object)
+  {
+    uint32_t maxCell=(1u << POIIndex::HILBERT_ORDER)-1;
+    uint32_t x=(uint32_t)floor((coord.GetLon()+180.0)/360.0*maxCell);
+    uint32_t y=(uint32_t)floor((coord.GetLat()+90.0)/180.0*maxCell);
+    Entry    entry;
+
+    entry.hilbertValue=GetHilbertValue(x,
+                                       y,
+                                       POIIndex::HILBERT_ORDER);
+    entry.coord=coord;
+    entry.object=object;
+
+    typeEntries[type->GetIndex()].push_back(entry);
+  }
+
+  bool POIIndexGenerator::ScanNodes(const TypeConfig& typeConfig,
+                                    const ImportParameter& parameter,
+                                    Progress& progress)
+  {
+    FileScanner scanner;
+    uint32_t    nodeCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "nodes.dat"),
+                      FileScanner::Sequential,
+                      true)) {
+      progress.Error("Cannot open 'nodes.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    for (uint32_t n=1; n<=nodeCount; n++) {
+      progress.SetProgress(n,nodeCount);
+
+      Node node;
+
+      if (!node.Read(typeConfig,
+                     scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      if (!node.GetType()->GetIndexAsPOI()) {
+        continue;
+      }
+
+      AddEntry(node.GetType(),
+               node.GetCoords(),
+               ObjectFileRef(node.GetFileOffset(),
+                             refNode));
+    }
+
+    return scanner.Close();
+  }
+
+  bool POIIndexGenerator::ScanWays(const TypeConfig& typeConfig,
+                                   const ImportParameter& parameter,
+                                   Progress& progress)
+  {
+    FileScanner scanner;
+    uint32_t    wayCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "ways.dat"),
+                      FileScanner::Sequential,
+                      parameter.GetWayDataMemoryMaped())) {
+      progress.Error("Cannot open 'ways.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(wayCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    for (uint32_t w=1; w<=wayCount; w++) {
+      progress.SetProgress(w,wayCount);
+
+      Way way;
+
+      if (!way.Read(typeConfig,
+                    scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(w)+" of "+
+                       NumberToString(wayCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      GeoCoord center;
+
+      if (!way.GetType()->GetIndexAsPOI() ||
+          !way.GetCenter(center)) {
+        continue;
+      }
+
+      AddEntry(way.GetType(),
+               center,
+               ObjectFileRef(way.GetFileOffset(),
+                             refWay));
+    }
+
+    return scanner.Close();
+  }
+
+  bool POIIndexGenerator::ScanAreas(const TypeConfig& typeConfig,
+                                    const ImportParameter& parameter,
+                                    Progress& progress)
+  {
+    FileScanner scanner;
+    uint32_t    areaCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "areas.dat"),
+                      FileScanner::Sequential,
+                      parameter.GetAreaDataMemoryMaped())) {
+      progress.Error("Cannot open 'areas.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(areaCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    for (uint32_t a=1; a<=areaCount; a++) {
+      progress.SetProgress(a,areaCount);
+
+      Area area;
+
+      if (!area.Read(typeConfig,
+                     scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(a)+" of "+
+                       NumberToString(areaCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      GeoCoord center;
+
+      if (!area.GetType()->GetIndexAsPOI() ||
+          !area.GetCenter(center)) {
+        continue;
+      }
+
+      AddEntry(area.GetType(),
+               center,
+               ObjectFileRef(area.GetFileOffset(),
+                             refArea));
+    }
+
+    return scanner.Close();
+  }
+
+  /**
+   * Write the packed R-tree of the given entries level by level, starting with
+   * the leafs, and return the offset of the root node.
+   */
+  bool POIIndexGenerator::WriteTree(FileWriter& writer,
+                                    std::vector<Entry>& entries,
+                                    FileOffset& rootOffset)
+  {
+    std::vector<TreeNode> level;
+
+    // Keep the order of entries with the same Hilbert value, so the index is reproducible
+    std::stable_sort(entries.begin(),
+                     entries.end(),
+                     [](const Entry& a, const Entry& b) {
+      return a.hilbertValue<b.hilbertValue;
+    });
+
+    for (size_t start=0; start<entries.size(); start+=POIIndex::NODE_SIZE) {
+      size_t   end=std::min(start+POIIndex::NODE_SIZE,
+                            entries.size());
+      TreeNode node;
+
+      if (!writer.GetPos(node.offset)) {
+        return false;
+      }
+
+      node.boundingBox.Set(entries[start].coord,
+                           entries[start].coord);
+
+      writer.WriteNumber((uint32_t)(end-start));
+      writer.Write(true);
+
+      for (size_t i=start; i<end; i++) {
+        node.boundingBox.Include(GeoBox(entries[i].coord,
+                                        entries[i].coord));
+
+        writer.WriteCoord(entries[i].coord);
+        writer.Write(entries[i].object);
+      }
+
+      level.push_back(node);
+    }
+
+    while (level.size()>1) {
+      std::vector<TreeNode> parentLevel;
+
+      for (size_t start=0; start<level.size(); start+=POIIndex::NODE_SIZE) {
+        size_t   end=std::min(start+POIIndex::NODE_SIZE,
+                              level.size());
+        TreeNode node;
+
+        if (!writer.GetPos(node.offset)) {
+          return false;
+        }
+
+        node.boundingBox=level[start].boundingBox;
+
+        writer.WriteNumber((uint32_t)(end-start));
+        writer.Write(false);
+
+        for (size_t i=start; i<end; i++) {
+          node.boundingBox.Include(level[i].boundingBox);
+
+          writer.WriteCoord(level[i].boundingBox.GetMinCoord());
+          writer.WriteCoord(level[i].boundingBox.GetMaxCoord());
+          writer.WriteFileOffset(level[i].offset);
+        }
+
+        parentLevel.push_back(node);
+      }
+
+      level.swap(parentLevel);
+    }
+
+    rootOffset=level.front().offset;
+
+    return !writer.HasError();
+  }
+
+  bool POIIndexGenerator::WriteIndex(const TypeConfig& typeConfig,
+                                     const ImportParameter& parameter,
+                                     Progress& progress)
+  {
+    FileWriter                                 writer;
+    std::vector<std::pair<size_t,FileOffset> > roots;
+    size_t                                     entryCount=0;
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     POIIndex::FILENAME_POI_IDX))) {
+      progress.Error(std::string("Cannot open '")+writer.GetFilename()+"'");
+      return false;
+    }
+
+    FileOffset typeIndexOffset=0;
+
+    writer.WriteFileOffset(typeIndexOffset);
+
+    for (size_t typeIndex=0; typeIndex<typeEntries.size(); typeIndex++) {
+      std::vector<Entry>& entries=typeEntries[typeIndex];
+      FileOffset          rootOffset;
+
+      if (entries.empty()) {
+        continue;
+      }
+
+      progress.Info(typeConfig.GetTypeInfo(typeIndex)->GetName()+": "+
+                    NumberToString(entries.size())+" POI(s)");
+
+      if (!WriteTree(writer,
+                     entries,
+                     rootOffset)) {
+        progress.Error(std::string("Error while writing '")+writer.GetFilename()+"'");
+        return false;
+      }
+
+      roots.push_back(std::make_pair(typeIndex,
+                                     rootOffset));
+      entryCount+=entries.size();
+    }
+
+    if (!writer.GetPos(typeIndexOffset)) {
+      progress.Error(std::string("Error while writing '")+writer.GetFilename()+"'");
+      return false;
+    }
+
+    writer.WriteNumber((uint32_t)roots.size());
+
+    for (const auto& root : roots) {
+      writer.WriteNumber((uint32_t)root.first);
+      writer.WriteNumber((uint32_t)typeEntries[root.first].size());
+      writer.WriteFileOffset(root.second);
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(typeIndexOffset);
+
+    progress.Info(NumberToString(entryCount)+" POI(s) of "+
+                  NumberToString(roots.size())+" type(s) written");
+
+    return !writer.HasError() && writer.Close();
+  }
+
+  std::string POIIndexGenerator::GetDescription() const
+  {
+    return std::string("Generate '")+POIIndex::FILENAME_POI_IDX+"'";
+  }
+
+  bool POIIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                 const ImportParameter& parameter,
+                                 Progress& progress)
+  {
+    typeEntries.clear();
+    typeEntries.resize(typeConfig->GetTypeCount());
+
+    progress.SetAction("Scanning nodes");
+
+    if (!ScanNodes(*typeConfig,
+                   parameter,
+                   progress)) {
+      return false;
+    }
+
+    progress.SetAction("Scanning ways");
+
+    if (!ScanWays(*typeConfig,
+                  parameter,
+                  progress)) {
+      return false;
+    }
+
+    progress.SetAction("Scanning areas");
+
+    if (!ScanAreas(*typeConfig,
+                   parameter,
+                   progress)) {
+      return false;
+    }
+
+    progress.SetAction(std::string("Writing '")+POIIndex::FILENAME_POI_IDX+"'");
+
+    if (!WriteIndex(*typeConfig,
+                    parameter,
+                    progress)) {
+      return false;
+    }
+
+    typeEntries.clear();
+
+    return true;
+  }
+}
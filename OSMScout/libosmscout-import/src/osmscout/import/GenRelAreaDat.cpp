@@ -29,6 +29,13 @@
 
 namespace osmscout {
 
+  /**
+   * Relations with at least this number of member ways are not assembled
+   * in parallel with other relations. Instead the ring grouping of the relation
+   * itself is calculated in parallel.
+   */
+  static const size_t largeRelationWayCount=1000;
+
   /**
     Returns true, if area a is in area b
    */
@@ -346,23 +353,35 @@ namespace osmscout {
     // Ring grouping
     //
 
-    GroupingState state(parts.size());
+    GroupingState                        state(parts.size());
+    std::vector<const MultipolygonPart*> rings;
+    std::vector<GeoBox>                  boundingBoxes;
 
-    size_t ix=0;
-    for (const auto& r1 : parts) {
-      size_t jx=0;
-      for (const auto& r2 : parts) {
-        if (ix!=jx) {
-          if (IsAreaSubOfArea(r2.role.nodes,
-                              r1.role.nodes)) {
-            state.SetIncluded(ix,jx);
-          }
-        }
+    rings.reserve(parts.size());
+    boundingBoxes.reserve(parts.size());
 
-        jx++;
-      }
+    for (const auto& part : parts) {
+      GeoBox boundingBox;
+
+      part.role.GetBoundingBox(boundingBox);
+
+      rings.push_back(&part);
+      boundingBoxes.push_back(boundingBox);
+    }
 
-      ix++;
+    // Every iteration only writes the inclusion state of its own ring, so
+    // for large relations we can check containment in parallel. Rings with disjunct
+    // bounding boxes cannot include each other.
+#pragma omp parallel for if(rings.size()>=largeRelationWayCount) schedule(dynamic)
+    for (size_t ix=0; ix<rings.size(); ix++) {
+      for (size_t jx=0; jx<rings.size(); jx++) {
+        if (ix!=jx &&
+            boundingBoxes[ix].Intersects(boundingBoxes[jx]) &&
+            IsAreaSubOfArea(rings[jx]->role.nodes,
+                            rings[ix]->role.nodes)) {
+          state.SetIncluded(ix,jx);
+        }
+      }
     }
 
     //
@@ -442,7 +461,7 @@ namespace osmscout {
           return false;
         }
 
-        RawWayRef way(wayEntry->second);
+        const RawWay* way=wayEntry->second.Get();
 
         MultipolygonPart part;
 
@@ -510,7 +529,7 @@ namespace osmscout {
             return false;
           }
 
-          RawRelationRef childRelation(relationEntry->second);
+          const RawRelation& childRelation=*relationEntry->second;
 
           resolvedRelations.insert(member->id);
 
@@ -521,7 +540,7 @@ namespace osmscout {
                                       relationMap,
                                       relation,
                                       name,
-                                      *childRelation,
+                                      childRelation,
                                       resolvedRelations,
                                       parts)) {
             break;
@@ -551,7 +570,7 @@ namespace osmscout {
           return false;
         }
 
-        RawWayRef way(wayEntry->second);
+        const RawWay* way=wayEntry->second.Get();
 
         MultipolygonPart part;
 
@@ -589,26 +608,20 @@ namespace osmscout {
     return true;
   }
 
-  bool RelAreaDataGenerator::ResolveMultipolygonMembers(Progress& progress,
-                                                        const TypeConfig& typeConfig,
-                                                        CoordDataFile& coordDataFile,
-                                                        RawWayIndexedDataFile& wayDataFile,
+  /**
+    Collect the ids of all ways of the given relation (and - in case of boundaries - of all
+    child relations). Child relations are loaded and stored in relationMap.
+   */
+  bool RelAreaDataGenerator::CollectMultipolygonMembers(Progress& progress,
                                                         RawRelationIndexedDataFile& relDataFile,
-                                                        IdSet& resolvedRelations,
-                                                        const Area& relation,
+                                                        bool isBoundary,
                                                         const std::string& name,
                                                         const RawRelation& rawRelation,
-                                                        std::list<MultipolygonPart>& parts)
+                                                        std::map<OSMId,RawRelationRef>& relationMap,
+                                                        std::set<OSMId>& wayIds)
   {
-    TypeInfoRef                    boundaryType=typeConfig.GetTypeInfo("boundary_administrative");
-    std::set<OSMId>                nodeIds;
-    std::set<OSMId>                wayIds;
-    std::set<OSMId>                pendingRelationIds;
-    std::set<OSMId>                visitedRelationIds;
-
-    CoordDataFile::CoordResultMap  coordMap;
-    IdRawWayMap                    wayMap;
-    std::map<OSMId,RawRelationRef> relationMap;
+    std::set<OSMId> pendingRelationIds;
+    std::set<OSMId> visitedRelationIds;
 
     visitedRelationIds.insert(rawRelation.GetId());
 
@@ -627,8 +640,7 @@ namespace osmscout {
                (member->role=="inner" ||
                 member->role=="outer" ||
                 member->role.empty())) {
-        if (boundaryType &&
-            rawRelation.GetType()==boundaryType) {
+        if (isBoundary) {
           if (visitedRelationIds.find(member->id)!=visitedRelationIds.end()) {
             progress.Warning("Relation "+
                              NumberToString(member->id)+
@@ -637,14 +649,6 @@ namespace osmscout {
             continue;
           }
 
-          if (resolvedRelations.find(member->id)!=resolvedRelations.end()) {
-            progress.Error("Found self referencing relation "+
-                           NumberToString(member->id)+
-                           " during resolving of members of relation "+
-                           NumberToString(rawRelation.GetId())+" "+name);
-            return false;
-          }
-
           pendingRelationIds.insert(member->id);
         }
         else {
@@ -693,24 +697,13 @@ namespace osmscout {
                    (member->role=="inner" ||
                     member->role=="outer" ||
                     member->role.empty())) {
-            if (boundaryType &&
-                rawRelation.GetType()==boundaryType) {
+            if (isBoundary) {
               if (visitedRelationIds.find(member->id)!=visitedRelationIds.end()) {
                 progress.Warning("Relation "+
                                  NumberToString(member->id)+
                                  " is referenced multiple times within relation "+
                                  NumberToString(rawRelation.GetId())+" "+name);
-                continue;;
-              }
-
-              if (resolvedRelations.find(member->id)!=resolvedRelations.end()) {
-                progress.Error("Found self referencing relation "+
-                               NumberToString(member->id)+
-                               " during resolving of members of relation "+
-                               NumberToString(rawRelation.GetId())+" "+
-                               rawRelation.GetType()->GetName()+" "+
-                               name);
-                return false;
+                continue;
               }
 
               pendingRelationIds.insert(member->id);
@@ -726,21 +719,45 @@ namespace osmscout {
       }
     }
 
-    // Now load all ways and collect all coordinate ids
+    return true;
+  }
 
-    std::vector<RawWayRef> ways;
+  /**
+    Load all ways of the current block and the coordinates of their nodes. Offsets
+    are looked up in one go and sorted, so the way data file is read in file order.
+   */
+  bool RelAreaDataGenerator::LoadBlockMembers(Progress& progress,
+                                              CoordDataFile& coordDataFile,
+                                              RawWayIndexedDataFile& wayDataFile,
+                                              const std::set<OSMId>& wayIds,
+                                              IdRawWayMap& wayMap,
+                                              CoordDataFile::CoordResultMap& coordMap)
+  {
+    std::vector<FileOffset> offsets;
+    std::vector<RawWayRef>  ways;
+    std::set<OSMId>         nodeIds;
 
-    ways.reserve(wayIds.size());
+    offsets.reserve(wayIds.size());
 
-    if (!wayDataFile.Get(wayIds,
-                         ways)) {
-      progress.Error("Cannot resolve child ways of relation "+
-                     NumberToString(rawRelation.GetId())+" "+
-                     rawRelation.GetType()->GetName()+" "+
-                     name);
+    if (!wayDataFile.GetOffsets(wayIds,
+                                offsets)) {
+      progress.Error("Cannot resolve offsets of member ways");
       return false;
     }
 
+    std::sort(offsets.begin(),
+              offsets.end());
+
+    ways.reserve(offsets.size());
+
+    if (!wayDataFile.GetByOffset(offsets,
+                                 ways)) {
+      progress.Error("Cannot load member ways");
+      return false;
+    }
+
+    offsets.clear();
+
     wayMap.reserve(ways.size());
 
     for (std::vector<RawWayRef>::const_iterator w=ways.begin();
@@ -757,26 +774,31 @@ namespace osmscout {
       wayMap[way->GetId()]=way;
     }
 
-    wayIds.clear();
     ways.clear();
 
-    // Now load all node coordinates
-
     if (!coordDataFile.Get(nodeIds,
                            coordMap)) {
-      progress.Error("Cannot resolve child nodes of relation "+
-                     NumberToString(rawRelation.GetId())+" "+
-                     rawRelation.GetType()->GetName()+" "+
-                     name);
+      progress.Error("Cannot resolve nodes of member ways");
       return false;
     }
 
-    nodeIds.clear();
+    return true;
+  }
 
-    // Now build together everything
+  bool RelAreaDataGenerator::ResolveMultipolygonMembers(Progress& progress,
+                                                        const TypeConfig& typeConfig,
+                                                        const CoordDataFile::CoordResultMap& coordMap,
+                                                        const IdRawWayMap& wayMap,
+                                                        const std::map<OSMId,RawRelationRef>& relationMap,
+                                                        bool isBoundary,
+                                                        const Area& relation,
+                                                        const std::string& name,
+                                                        const RawRelation& rawRelation,
+                                                        std::list<MultipolygonPart>& parts)
+  {
+    if (isBoundary) {
+      IdSet resolvedRelations;
 
-    if (boundaryType &&
-        rawRelation.GetType()==boundaryType) {
       return ComposeBoundaryMembers(typeConfig,
                                     progress,
                                     coordMap,
@@ -799,27 +821,31 @@ namespace osmscout {
     }
   }
 
+  /**
+    Assemble the given relation. Only reads the given (shared) maps and
+    writes the relation specific parameters, so it can be called for different
+    relations in parallel.
+   */
   bool RelAreaDataGenerator::HandleMultipolygonRelation(const ImportParameter& parameter,
                                                         Progress& progress,
                                                         const TypeConfig& typeConfig,
                                                         IdSet& wayAreaIndexBlacklist,
-                                                        CoordDataFile& coordDataFile,
-                                                        RawWayIndexedDataFile& wayDataFile,
-                                                        RawRelationIndexedDataFile& relDataFile,
-                                                        RawRelation& rawRelation,
+                                                        const CoordDataFile::CoordResultMap& coordMap,
+                                                        const IdRawWayMap& wayMap,
+                                                        const std::map<OSMId,RawRelationRef>& relationMap,
+                                                        bool isBoundary,
+                                                        const RawRelation& rawRelation,
                                                         const std::string& name,
                                                         Area& relation)
   {
-    IdSet resolvedRelations;
-
     std::list<MultipolygonPart> parts;
 
     if (!ResolveMultipolygonMembers(progress,
                                     typeConfig,
-                                    coordDataFile,
-                                    wayDataFile,
-                                    relDataFile,
-                                    resolvedRelations,
+                                    coordMap,
+                                    wayMap,
+                                    relationMap,
+                                    isBoundary,
                                     relation,
                                     name,
                                     rawRelation,
@@ -1088,74 +1114,164 @@ namespace osmscout {
 
     writer.Write(writtenRelationCount);
 
-    for (uint32_t r=1; r<=rawRelationCount; r++) {
-      progress.SetProgress(r,rawRelationCount);
+    TypeInfoRef boundaryType=typeConfig->GetTypeInfo("boundary_administrative");
+    size_t      blockSize=std::max((size_t)1,parameter.GetRawRelationBlockSize());
+    uint32_t    r=1;
 
-      RawRelation rawRel;
+    while (r<=rawRelationCount) {
+      std::vector<BlockEntry>       block(std::min((size_t)(rawRelationCount-r+1),blockSize));
+      std::set<OSMId>               wayIds;
+      IdRawWayMap                   wayMap;
+      CoordDataFile::CoordResultMap coordMap;
 
-      if (!rawRel.Read(*typeConfig,
-                       scanner)) {
-        progress.Error(std::string("Error while reading data entry ")+
-                       NumberToString(r)+" of "+
-                       NumberToString(rawRelationCount)+
-                       " in file '"+
-                       scanner.GetFilename()+"'");
-        return false;
-      }
-
-      // Normally we now also skip an object because of its missing type, but
-      // in case of relations things are a little bit more difficult,
-      // type might be placed at the outer ring and not on the relation
-      // itself, we thus still need to parse the complete relation for
-      // type analysis before we can skip it.
+      // Read the relations of the block and collect the ids of all their member ways
 
-      std::string name=ResolveRelationName(featureName,
-                                           rawRel);
-      Area        rel;
+      for (auto& entry : block) {
+        progress.SetProgress(r,rawRelationCount);
 
-      if (!HandleMultipolygonRelation(parameter,
-                                      progress,
-                                      *typeConfig,
-                                      wayAreaIndexBlacklist,
-                                      coordDataFile,
-                                      wayDataFile,
-                                      relDataFile,
-                                      rawRel,
-                                      name,
-                                      rel)) {
-        continue;
-      }
+        entry.rawRelation=new RawRelation();
 
-      if (progress.OutputDebug()) {
-        progress.Debug("Storing relation "+
-                       NumberToString(rawRel.GetId())+" "+
-                       rel.GetType()->GetName()+" "+
-                       name);
-      }
+        if (!entry.rawRelation->Read(*typeConfig,
+                                     scanner)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(r)+" of "+
+                         NumberToString(rawRelationCount)+
+                         " in file '"+
+                         scanner.GetFilename()+"'");
+          return false;
+        }
 
-      areaTypeCount[rel.GetType()->GetIndex()]++;
-      for (size_t i=0; i<rel.rings.size(); i++) {
-        if (rel.rings[i].ring==Area::outerRingId) {
-          areaNodeTypeCount[rel.GetType()->GetIndex()]+=rel.rings[i].nodes.size();
+        r++;
+
+        // Normally we now also skip an object because of its missing type, but
+        // in case of relations things are a little bit more difficult,
+        // type might be placed at the outer ring and not on the relation
+        // itself, we thus still need to parse the complete relation for
+        // type analysis before we can skip it.
+
+        std::set<OSMId> relationWayIds;
+
+        entry.name=ResolveRelationName(featureName,
+                                       *entry.rawRelation);
+        entry.isBoundary=boundaryType &&
+                         entry.rawRelation->GetType()==boundaryType;
+        entry.progress.SetOutputDebug(progress.OutputDebug());
+
+        entry.membersValid=CollectMultipolygonMembers(entry.progress,
+                                                      relDataFile,
+                                                      entry.isBoundary,
+                                                      entry.name,
+                                                      *entry.rawRelation,
+                                                      entry.relationMap,
+                                                      relationWayIds);
+
+        if (entry.membersValid) {
+          entry.wayCount=relationWayIds.size();
+          wayIds.insert(relationWayIds.begin(),
+                        relationWayIds.end());
         }
       }
 
-      FileOffset fileOffset;
+      // Load all member ways and their coordinates of the block in one go
 
-      if (!writer.GetPos(fileOffset)) {
-        progress.Error(std::string("Error while reading current fileOffset in file '")+
-                       writer.GetFilename()+"'");
+      if (!LoadBlockMembers(progress,
+                            coordDataFile,
+                            wayDataFile,
+                            wayIds,
+                            wayMap,
+                            coordMap)) {
         return false;
       }
 
-      if (!writer.Write((uint8_t)osmRefRelation) ||
-          !writer.Write(rawRel.GetId()) ||
-          !rel.Write(*typeConfig,
-                     writer)) {
-        return false;
+      wayIds.clear();
+
+      // Assemble the relations. Relations of the block are independent of each other
+      // and only read the shared way and coordinate maps.
+
+#pragma omp parallel for schedule(dynamic)
+      for (size_t b=0; b<block.size(); b++) {
+        BlockEntry& entry=block[b];
+
+        if (entry.membersValid &&
+            entry.wayCount<largeRelationWayCount) {
+          entry.success=HandleMultipolygonRelation(parameter,
+                                                   entry.progress,
+                                                   *typeConfig,
+                                                   entry.wayAreaIndexBlacklist,
+                                                   coordMap,
+                                                   wayMap,
+                                                   entry.relationMap,
+                                                   entry.isBoundary,
+                                                   *entry.rawRelation,
+                                                   entry.name,
+                                                   entry.relation);
+        }
       }
 
-      writtenRelationCount++;
+      // Large relations one after another, their ring grouping is parallelized instead
+
+      for (auto& entry : block) {
+        if (entry.membersValid &&
+            entry.wayCount>=largeRelationWayCount) {
+          entry.success=HandleMultipolygonRelation(parameter,
+                                                   entry.progress,
+                                                   *typeConfig,
+                                                   entry.wayAreaIndexBlacklist,
+                                                   coordMap,
+                                                   wayMap,
+                                                   entry.relationMap,
+                                                   entry.isBoundary,
+                                                   *entry.rawRelation,
+                                                   entry.name,
+                                                   entry.relation);
+        }
+      }
+
+      // Write the results in the order of the relations in the raw relation file
+
+      for (auto& entry : block) {
+        entry.progress.Forward(progress);
+
+        if (!entry.success) {
+          continue;
+        }
+
+        wayAreaIndexBlacklist.insert(entry.wayAreaIndexBlacklist.begin(),
+                                     entry.wayAreaIndexBlacklist.end());
+
+        const Area& rel=entry.relation;
+
+        if (progress.OutputDebug()) {
+          progress.Debug("Storing relation "+
+                         NumberToString(entry.rawRelation->GetId())+" "+
+                         rel.GetType()->GetName()+" "+
+                         entry.name);
+        }
+
+        areaTypeCount[rel.GetType()->GetIndex()]++;
+        for (size_t i=0; i<rel.rings.size(); i++) {
+          if (rel.rings[i].ring==Area::outerRingId) {
+            areaNodeTypeCount[rel.GetType()->GetIndex()]+=rel.rings[i].nodes.size();
+          }
+        }
+
+        FileOffset fileOffset;
+
+        if (!writer.GetPos(fileOffset)) {
+          progress.Error(std::string("Error while reading current fileOffset in file '")+
+                         writer.GetFilename()+"'");
+          return false;
+        }
+
+        if (!writer.Write((uint8_t)osmRefRelation) ||
+            !writer.Write(entry.rawRelation->GetId()) ||
+            !rel.Write(*typeConfig,
+                       writer)) {
+          return false;
+        }
+
+        writtenRelationCount++;
+      }
     }
 
     progress.Info(NumberToString(rawRelationCount)+" relations read"+
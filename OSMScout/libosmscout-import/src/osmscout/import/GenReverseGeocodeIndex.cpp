@@ -0,0 +1,715 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenReverseGeocodeIndex.h>
+
+#include <algorithm>
+#include <limits>
+#include <list>
+
+#include <osmscout/Area.h>
+#include <osmscout/LocationIndex.h>
+#include <osmscout/Node.h>
+#include <osmscout/ReverseGeocodeIndex.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  class ReverseGeocodeRegionCollector : public AdminRegionVisitor
+  {
+  public:
+    std::list<AdminRegion> regions;
+
+  public:
+    Action Visit(const AdminRegion& region)
+    {
+      regions.push_back(region);
+
+      return visitChildren;
+    }
+  };
+
+  class ReverseGeocodeLocationCollector : public LocationVisitor
+  {
+  public:
+    std::list<Location> locations;
+
+  public:
+    bool Visit(const AdminRegion& /*adminRegion*/,
+               const POI& /*poi*/)
+    {
+      return true;
+    }
+
+    bool Visit(const AdminRegion& /*adminRegion*/,
+               const Location& location)
+    {
+      locations.push_back(location);
+
+      return true;
+    }
+  };
+
+  class ReverseGeocodeAddressCollector : public AddressVisitor
+  {
+  public:
+    std::vector<ReverseGeocodeIndexGenerator::AddressEntry>& addresses;
+
+  public:
+    ReverseGeocodeAddressCollector(std::vector<ReverseGeocodeIndexGenerator::AddressEntry>& addresses)
+    : addresses(addresses)
+    {
+      // no code
+    }
+
+    bool Visit(const AdminRegion& /*adminRegion*/,
+               const Location& /*location*/,
+               const Address& address)
+    {
+      ReverseGeocodeIndexGenerator::AddressEntry entry;
+
+      entry.regionOffset=address.regionOffset;
+      entry.locationOffset=address.locationOffset;
+      entry.addressOffset=address.addressOffset;
+      entry.name=address.name;
+      entry.object=address.object;
+
+      addresses.push_back(entry);
+
+      return true;
+    }
+  };
+
+  void ReverseGeocodeIndexGenerator::AddObjectUse(const ObjectFileRef& object,
+                                                  bool isAddress,
+                                                  uint32_t index)
+  {
+    ObjectUse use;
+
+    use.isAddress=isAddress;
+    use.index=index;
+
+    switch (object.GetType()) {
+    case refNode:
+      nodeUses[object.GetFileOffset()].push_back(use);
+      break;
+    case refWay:
+      wayUses[object.GetFileOffset()].push_back(use);
+      break;
+    case refArea:
+      areaUses[object.GetFileOffset()].push_back(use);
+      break;
+    default:
+      break;
+    }
+  }
+
+  /**
+   * Load all locations and addresses from the location index and collect
+   * the objects they consist of
+   */
+  bool ReverseGeocodeIndexGenerator::LoadLocations(const ImportParameter& parameter,
+                                                   Progress& progress)
+  {
+    LocationIndex                 locationIndex;
+    ReverseGeocodeRegionCollector regionCollector;
+
+    if (!locationIndex.Load(parameter.GetDestinationDirectory())) {
+      progress.Error(std::string("Cannot load '")+LocationIndex::FILENAME_LOCATION_IDX+"'");
+      return false;
+    }
+
+    if (!locationIndex.VisitAdminRegions(regionCollector)) {
+      progress.Error("Error while reading admin regions");
+      return false;
+    }
+
+    ReverseGeocodeAddressCollector addressCollector(addresses);
+    size_t                         currentRegion=0;
+
+    for (const auto& region : regionCollector.regions) {
+      ReverseGeocodeLocationCollector locationCollector;
+
+      progress.SetProgress(currentRegion,
+                           regionCollector.regions.size());
+
+      currentRegion++;
+
+      if (!locationIndex.VisitAdminRegionLocations(region,
+                                                   locationCollector,
+                                                   false)) {
+        progress.Error("Error while reading locations of region '"+region.name+"'");
+        return false;
+      }
+
+      for (const auto& location : locationCollector.locations) {
+        LocationEntry entry;
+
+        entry.regionOffset=location.regionOffset;
+        entry.locationOffset=location.locationOffset;
+
+        for (const auto& object : location.objects) {
+          AddObjectUse(object,
+                       false,
+                       (uint32_t)locations.size());
+        }
+
+        locations.push_back(entry);
+
+        if (location.addressesOffset==0) {
+          continue;
+        }
+
+        size_t firstAddress=addresses.size();
+
+        if (!locationIndex.VisitLocationAddresses(region,
+                                                  location,
+                                                  addressCollector)) {
+          progress.Error("Error while reading addresses of location '"+location.name+"'");
+          return false;
+        }
+
+        for (size_t a=firstAddress; a<addresses.size(); a++) {
+          AddObjectUse(addresses[a].object,
+                       true,
+                       (uint32_t)a);
+        }
+      }
+    }
+
+    progress.Info(NumberToString(locations.size())+" locations and "+
+                  NumberToString(addresses.size())+" addresses found");
+
+    return true;
+  }
+
+  /**
+   * Return the ids of all cells the segment crosses, by walking along the
+   * segment from cell border to cell border
+   */
+  void ReverseGeocodeIndexGenerator::GetSegmentCells(const GeoCoord& from,
+                                                     const GeoCoord& to,
+                                                     std::vector<uint64_t>& cellIds) const
+  {
+    double   cellCount=(double)(((uint64_t)1) << ReverseGeocodeIndex::CELL_LEVEL);
+    uint32_t x;
+    uint32_t y;
+    uint32_t xEnd;
+    uint32_t yEnd;
+
+    cellIds.clear();
+
+    ReverseGeocodeIndex::GetCell(from,x,y);
+    ReverseGeocodeIndex::GetCell(to,xEnd,yEnd);
+
+    cellIds.push_back(ReverseGeocodeIndex::GetCellId(x,y));
+
+    if (x==xEnd && y==yEnd) {
+      return;
+    }
+
+    double fromX=(from.GetLon()+180.0)/360.0*cellCount;
+    double fromY=(from.GetLat()+90.0)/180.0*cellCount;
+    double deltaX=(to.GetLon()+180.0)/360.0*cellCount-fromX;
+    double deltaY=(to.GetLat()+90.0)/180.0*cellCount-fromY;
+    int    stepX=deltaX>0 ? 1 : -1;
+    int    stepY=deltaY>0 ? 1 : -1;
+    double infinity=std::numeric_limits<double>::infinity();
+
+    // Position on the segment (0..1) of the next vertical and horizontal cell border
+    double nextX=deltaX>0 ? (x+1-fromX)/deltaX : (deltaX<0 ? (x-fromX)/deltaX : infinity);
+    double nextY=deltaY>0 ? (y+1-fromY)/deltaY : (deltaY<0 ? (y-fromY)/deltaY : infinity);
+
+    // Distance on the segment between two vertical and two horizontal cell borders
+    double stepSizeX=deltaX!=0 ? stepX/deltaX : infinity;
+    double stepSizeY=deltaY!=0 ? stepY/deltaY : infinity;
+
+    // Each step moves one cell nearer to the end cell, so this is enough even
+    // for rounding errors
+    size_t maxSteps=std::abs((int64_t)xEnd-(int64_t)x)+std::abs((int64_t)yEnd-(int64_t)y);
+
+    for (size_t step=0; step<maxSteps; step++) {
+      if ((nextX<nextY && x!=xEnd) || y==yEnd) {
+        x+=stepX;
+        nextX+=stepSizeX;
+      }
+      else {
+        y+=stepY;
+        nextY+=stepSizeY;
+      }
+
+      cellIds.push_back(ReverseGeocodeIndex::GetCellId(x,y));
+
+      if (x==xEnd && y==yEnd) {
+        break;
+      }
+    }
+  }
+
+  void ReverseGeocodeIndexGenerator::AddSegment(uint32_t location,
+                                                const GeoCoord& from,
+                                                const GeoCoord& to)
+  {
+    std::vector<uint64_t> cellIds;
+
+    GetSegmentCells(from,
+                    to,
+                    cellIds);
+
+    for (const auto& cellId : cellIds) {
+      CellSegment segment;
+
+      segment.cellId=cellId;
+      segment.location=location;
+      segment.from=from;
+      segment.to=to;
+
+      segments.push_back(segment);
+    }
+  }
+
+  void ReverseGeocodeIndexGenerator::AddPoint(uint32_t address,
+                                              const GeoCoord& coord)
+  {
+    uint32_t  x;
+    uint32_t  y;
+    CellPoint point;
+
+    ReverseGeocodeIndex::GetCell(coord,x,y);
+
+    point.cellId=ReverseGeocodeIndex::GetCellId(x,y);
+    point.address=address;
+    point.coord=coord;
+
+    points.push_back(point);
+  }
+
+  /**
+   * Add the segments of the given line to all locations using it. Addresses
+   * are added as a point in the center of the line.
+   */
+  void ReverseGeocodeIndexGenerator::AddLine(const std::vector<ObjectUse>& uses,
+                                             const std::vector<CompactGeoCoord>& nodes,
+                                             bool closed)
+  {
+    if (nodes.empty()) {
+      return;
+    }
+
+    for (const auto& use : uses) {
+      if (use.isAddress) {
+        continue;
+      }
+
+      if (nodes.size()==1) {
+        AddSegment(use.index,
+                   nodes.front(),
+                   nodes.front());
+        continue;
+      }
+
+      for (size_t i=1; i<nodes.size(); i++) {
+        AddSegment(use.index,
+                   nodes[i-1],
+                   nodes[i]);
+      }
+
+      if (closed &&
+          nodes.size()>2) {
+        AddSegment(use.index,
+                   nodes.back(),
+                   nodes.front());
+      }
+    }
+  }
+
+  bool ReverseGeocodeIndexGenerator::ScanNodes(const TypeConfig& typeConfig,
+                                               const ImportParameter& parameter,
+                                               Progress& progress)
+  {
+    FileScanner scanner;
+    uint32_t    nodeCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "nodes.dat"),
+                      FileScanner::Sequential,
+                      true)) {
+      progress.Error("Cannot open 'nodes.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(nodeCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    for (uint32_t n=1; n<=nodeCount && !nodeUses.empty(); n++) {
+      progress.SetProgress(n,nodeCount);
+
+      Node node;
+
+      if (!node.Read(typeConfig,
+                     scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(nodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      ObjectUseMap::iterator entry=nodeUses.find(node.GetFileOffset());
+
+      if (entry==nodeUses.end()) {
+        continue;
+      }
+
+      for (const auto& use : entry->second) {
+        if (use.isAddress) {
+          AddPoint(use.index,
+                   node.GetCoords());
+        }
+        else {
+          AddSegment(use.index,
+                     node.GetCoords(),
+                     node.GetCoords());
+        }
+      }
+
+      nodeUses.erase(entry);
+    }
+
+    return scanner.Close();
+  }
+
+  bool ReverseGeocodeIndexGenerator::ScanWays(const TypeConfig& typeConfig,
+                                              const ImportParameter& parameter,
+                                              Progress& progress)
+  {
+    FileScanner scanner;
+    uint32_t    wayCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "ways.dat"),
+                      FileScanner::Sequential,
+                      parameter.GetWayDataMemoryMaped())) {
+      progress.Error("Cannot open 'ways.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(wayCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    for (uint32_t w=1; w<=wayCount && !wayUses.empty(); w++) {
+      progress.SetProgress(w,wayCount);
+
+      Way way;
+
+      if (!way.Read(typeConfig,
+                    scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(w)+" of "+
+                       NumberToString(wayCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      ObjectUseMap::iterator entry=wayUses.find(way.GetFileOffset());
+
+      if (entry==wayUses.end()) {
+        continue;
+      }
+
+      AddLine(entry->second,
+              way.nodes,
+              false);
+
+      GeoCoord center;
+
+      if (way.GetCenter(center)) {
+        for (const auto& use : entry->second) {
+          if (use.isAddress) {
+            AddPoint(use.index,
+                     center);
+          }
+        }
+      }
+
+      wayUses.erase(entry);
+    }
+
+    return scanner.Close();
+  }
+
+  bool ReverseGeocodeIndexGenerator::ScanAreas(const TypeConfig& typeConfig,
+                                               const ImportParameter& parameter,
+                                               Progress& progress)
+  {
+    FileScanner scanner;
+    uint32_t    areaCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      "areas.dat"),
+                      FileScanner::Sequential,
+                      parameter.GetAreaDataMemoryMaped())) {
+      progress.Error("Cannot open 'areas.dat'");
+      return false;
+    }
+
+    if (!scanner.Read(areaCount)) {
+      progress.Error("Error while reading number of data entries in file");
+      return false;
+    }
+
+    for (uint32_t a=1; a<=areaCount && !areaUses.empty(); a++) {
+      progress.SetProgress(a,areaCount);
+
+      Area area;
+
+      if (!area.Read(typeConfig,
+                     scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(a)+" of "+
+                       NumberToString(areaCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      ObjectUseMap::iterator entry=areaUses.find(area.GetFileOffset());
+
+      if (entry==areaUses.end()) {
+        continue;
+      }
+
+      for (const auto& ring : area.rings) {
+        AddLine(entry->second,
+                ring.nodes,
+                true);
+      }
+
+      GeoCoord center;
+
+      if (area.GetCenter(center)) {
+        for (const auto& use : entry->second) {
+          if (use.isAddress) {
+            AddPoint(use.index,
+                     center);
+          }
+        }
+      }
+
+      areaUses.erase(entry);
+    }
+
+    return scanner.Close();
+  }
+
+  bool ReverseGeocodeIndexGenerator::WriteIndex(const ImportParameter& parameter,
+                                                Progress& progress)
+  {
+    FileWriter                                   writer;
+    std::vector<std::pair<uint64_t,FileOffset> > cellOffsets;
+
+    // Keep the order of insertion within a cell, so the index is reproducible
+    std::stable_sort(segments.begin(),
+                     segments.end(),
+                     [](const CellSegment& a, const CellSegment& b) {
+      return a.cellId<b.cellId;
+    });
+
+    std::stable_sort(points.begin(),
+                     points.end(),
+                     [](const CellPoint& a, const CellPoint& b) {
+      return a.cellId<b.cellId;
+    });
+
+    std::vector<CellSegment>::const_iterator segment=segments.begin();
+    std::vector<CellPoint>::const_iterator   point=points.begin();
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     ReverseGeocodeIndex::FILENAME_REVERSEGEOCODE_IDX))) {
+      progress.Error(std::string("Cannot open '")+writer.GetFilename()+"'");
+      return false;
+    }
+
+    FileOffset cellIndexOffset=0;
+
+    writer.WriteFileOffset(cellIndexOffset);
+
+    while (segment!=segments.end() ||
+           point!=points.end()) {
+      uint64_t   cellId;
+      FileOffset cellOffset;
+
+      if (segment==segments.end()) {
+        cellId=point->cellId;
+      }
+      else if (point==points.end()) {
+        cellId=segment->cellId;
+      }
+      else {
+        cellId=std::min(segment->cellId,
+                        point->cellId);
+      }
+
+      if (!writer.GetPos(cellOffset)) {
+        progress.Error(std::string("Error while writing '")+writer.GetFilename()+"'");
+        return false;
+      }
+
+      cellOffsets.push_back(std::make_pair(cellId,
+                                           cellOffset));
+
+      std::vector<CellSegment>::const_iterator segmentsEnd=segment;
+      std::vector<CellPoint>::const_iterator   pointsEnd=point;
+
+      while (segmentsEnd!=segments.end() &&
+             segmentsEnd->cellId==cellId) {
+        ++segmentsEnd;
+      }
+
+      while (pointsEnd!=points.end() &&
+             pointsEnd->cellId==cellId) {
+        ++pointsEnd;
+      }
+
+      writer.WriteNumber((uint32_t)(segmentsEnd-segment));
+
+      for (; segment!=segmentsEnd; ++segment) {
+        const LocationEntry& location=locations[segment->location];
+
+        writer.WriteCoord(segment->from);
+        writer.WriteCoord(segment->to);
+        writer.WriteNumber(location.regionOffset);
+        writer.WriteNumber(location.locationOffset);
+      }
+
+      writer.WriteNumber((uint32_t)(pointsEnd-point));
+
+      for (; point!=pointsEnd; ++point) {
+        const AddressEntry& address=addresses[point->address];
+
+        writer.WriteCoord(point->coord);
+        writer.WriteNumber(address.regionOffset);
+        writer.WriteNumber(address.locationOffset);
+        writer.WriteNumber(address.addressOffset);
+        writer.Write(address.name);
+        writer.Write(address.object);
+      }
+    }
+
+    if (!writer.GetPos(cellIndexOffset)) {
+      progress.Error(std::string("Error while writing '")+writer.GetFilename()+"'");
+      return false;
+    }
+
+    writer.WriteNumber((uint32_t)cellOffsets.size());
+
+    uint64_t lastCellId=0;
+
+    for (const auto& cell : cellOffsets) {
+      writer.WriteNumber(cell.first-lastCellId);
+      writer.WriteFileOffset(cell.second);
+
+      lastCellId=cell.first;
+    }
+
+    writer.SetPos(0);
+    writer.WriteFileOffset(cellIndexOffset);
+
+    progress.Info(NumberToString(cellOffsets.size())+" cells with "+
+                  NumberToString(segments.size())+" segments and "+
+                  NumberToString(points.size())+" addresses written");
+
+    return !writer.HasError() && writer.Close();
+  }
+
+  std::string ReverseGeocodeIndexGenerator::GetDescription() const
+  {
+    return std::string("Generate '")+ReverseGeocodeIndex::FILENAME_REVERSEGEOCODE_IDX+"'";
+  }
+
+  bool ReverseGeocodeIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                            const ImportParameter& parameter,
+                                            Progress& progress)
+  {
+    locations.clear();
+    addresses.clear();
+    nodeUses.clear();
+    wayUses.clear();
+    areaUses.clear();
+    segments.clear();
+    points.clear();
+
+    progress.SetAction("Loading locations and addresses");
+
+    if (!LoadLocations(parameter,
+                       progress)) {
+      return false;
+    }
+
+    progress.SetAction("Scanning nodes");
+
+    if (!ScanNodes(*typeConfig,
+                   parameter,
+                   progress)) {
+      return false;
+    }
+
+    progress.SetAction("Scanning ways");
+
+    if (!ScanWays(*typeConfig,
+                  parameter,
+                  progress)) {
+      return false;
+    }
+
+    progress.SetAction("Scanning areas");
+
+    if (!ScanAreas(*typeConfig,
+                   parameter,
+                   progress)) {
+      return false;
+    }
+
+    progress.SetAction(std::string("Writing '")+ReverseGeocodeIndex::FILENAME_REVERSEGEOCODE_IDX+"'");
+
+    if (!WriteIndex(parameter,
+                    progress)) {
+      return false;
+    }
+
+    locations.clear();
+    addresses.clear();
+    segments.clear();
+    points.clear();
+
+    return true;
+  }
+}
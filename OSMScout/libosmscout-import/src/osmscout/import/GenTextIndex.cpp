@@ -25,6 +25,7 @@
 
 #include <osmscout/TypeFeatures.h>
 
+#include <osmscout/util/BlockCompression.h>
 #include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/FileWriter.h>
@@ -155,8 +156,8 @@ namespace osmscout
         AppendFileToDir(parameter.GetDestinationDirectory(),
                         "nodes.dat");
 
-    if (!GetFileSize(nodesDataFile,
-                     nodesFileSize)) {
+    if (!BlockCompression::GetDataSize(nodesDataFile,
+                                       nodesFileSize)) {
       progress.Error("Cannot get file size of file 'nodes.dat'");
       return false;
     }
@@ -166,8 +167,8 @@ namespace osmscout
         AppendFileToDir(parameter.GetDestinationDirectory(),
                         "ways.dat");
 
-    if (!GetFileSize(waysDataFile,
-                     waysFileSize)) {
+    if (!BlockCompression::GetDataSize(waysDataFile,
+                                       waysFileSize)) {
       progress.Error("Cannot get file size of file 'ways.dat'");
       return false;
     }
@@ -177,8 +178,8 @@ namespace osmscout
         AppendFileToDir(parameter.GetDestinationDirectory(),
                         "areas.dat");
 
-    if (!GetFileSize(areasDataFile,
-                     areasFileSize)) {
+    if (!BlockCompression::GetDataSize(areasDataFile,
+                                       areasFileSize)) {
       progress.Error("Cannot get file size of file 'areas.dat'");
       return false;
     }
@@ -43,6 +43,17 @@
 
 namespace osmscout {
 
+  /**
+   * Number of rows of a level that are processed as one unit in parallel. Must be a multiple
+   * of 4, so that two bands never share a byte of the packed cell state bitmap.
+   */
+  static const uint32_t bandRowCount=64;
+
+  /**
+   * Number of ways read from 'ways.dat' before they get applied to all levels.
+   */
+  static const size_t assumeLandWayBlockSize=10000;
+
   GroundTile::Coord WaterIndexGenerator::Transform(const GeoCoord& point,
                                                    const Level& level,
                                                    double cellMinLat,
@@ -549,17 +560,21 @@ namespace osmscout {
   /**
    * Every cell that is unknown but contains a way (that is marked
    * as "to be ignored"), must be land.
+   *
+   * 'ways.dat' is only scanned once for all levels. Ways are read in blocks, each block
+   * is then applied to all levels in parallel.
    */
   bool WaterIndexGenerator::AssumeLand(const ImportParameter& parameter,
                                        Progress& progress,
                                        const TypeConfig& typeConfig,
-                                       Level& level)
+                                       std::vector<Level>& levels)
   {
     progress.Info("Assume land");
 
-    FileScanner scanner;
+    FileScanner         scanner;
 
-    uint32_t    wayCount=0;
+    uint32_t            wayCount=0;
+    std::vector<WayRef> ways;
 
     // We do not yet know if we handle borders as ways or areas
 
@@ -576,13 +591,15 @@ namespace osmscout {
       return false;
     }
 
+    ways.reserve(std::min((size_t)wayCount,assumeLandWayBlockSize));
+
     for (uint32_t w=1; w<=wayCount; w++) {
       progress.SetProgress(w,wayCount);
 
-      Way way;
+      WayRef way=new Way();
 
-      if (!way.Read(typeConfig,
-                    scanner)) {
+      if (!way->Read(typeConfig,
+                     scanner)) {
         progress.Error(std::string("Error while reading data entry ")+
                        NumberToString(w)+" of "+
                        NumberToString(wayCount)+
@@ -591,11 +608,24 @@ namespace osmscout {
         return false;
       }
 
-      if (!way.GetType()->GetIgnoreSeaLand()) {
-        if (way.nodes.size()>=2) {
+      if (!way->GetType()->GetIgnoreSeaLand() &&
+          way->nodes.size()>=2) {
+        ways.push_back(way);
+      }
+
+      if (ways.size()<assumeLandWayBlockSize &&
+          w<wayCount) {
+        continue;
+      }
+
+#pragma omp parallel for schedule(dynamic)
+      for (size_t l=0; l<levels.size(); l++) {
+        Level& level=levels[l];
+
+        for (const auto& landWay : ways) {
           std::set<Pixel> coords;
 
-          GetCells(level,way.nodes,coords);
+          GetCells(level,landWay->nodes,coords);
 
           for (std::set<Pixel>::const_iterator coord=coords.begin();
               coord!=coords.end();
@@ -603,7 +633,7 @@ namespace osmscout {
             if (level.IsInAbsolute(coord->x,coord->y)) {
               if (level.GetState(coord->x-level.cellXStart,coord->y-level.cellYStart)==unknown) {
 #if defined(DEBUG_TILING)
-          std::cout << "Assume land: " << coord->x-level.cellXStart << "," << coord->y-level.cellYStart << " Way " << way.GetId() << " " << typeConfig.GetTypeInfo(way.GetType()).GetName() << " is defining area as land" << std::endl;
+                std::cout << "Assume land: " << coord->x-level.cellXStart << "," << coord->y-level.cellYStart << " Way " << landWay->GetId() << " " << landWay->GetType()->GetName() << " is defining area as land" << std::endl;
 #endif
                 level.SetStateAbsolute(coord->x,coord->y,land);
               }
@@ -611,14 +641,19 @@ namespace osmscout {
           }
         }
       }
+
+      ways.clear();
     }
 
-    return true;
+    return scanner.Close();
   }
 
   /**
    * Converts all cells of state "unknown" that touch a tile with state
    * "water" to state "water", too.
+   *
+   * Every cell only evaluates the state of the previous iteration and only
+   * changes its own state, so bands of rows can be processed in parallel.
    */
   void WaterIndexGenerator::FillWater(Progress& progress,
                                       Level& level,
@@ -626,47 +661,30 @@ namespace osmscout {
   {
     progress.Info("Filling water");
 
+    uint32_t bandCount=(level.cellYCount+bandRowCount-1)/bandRowCount;
+
     for (size_t i=1; i<=tileCount; i++) {
 
       Level newLevel(level);
 
-      for (uint32_t y=0; y<level.cellYCount; y++) {
-        for (uint32_t x=0; x<level.cellXCount; x++) {
-          if (level.GetState(x,y)==water) {
-            if (y>0) {
-              if (level.GetState(x,y-1)==unknown) {
-#if defined(DEBUG_TILING)
-                std::cout << "Water below water: " << x << "," << y-1 << std::endl;
-#endif
-                newLevel.SetState(x,y-1,water);
-              }
-            }
+#pragma omp parallel for schedule(dynamic)
+      for (uint32_t band=0; band<bandCount; band++) {
+        uint32_t yEnd=std::min((band+1)*bandRowCount,level.cellYCount);
 
-            if (y<level.cellYCount-1) {
-              if (level.GetState(x,y+1)==unknown) {
-#if defined(DEBUG_TILING)
-                std::cout << "Water above water: " << x << "," << y+1 << std::endl;
-#endif
-                newLevel.SetState(x,y+1,water);
-              }
-            }
-
-            if (x>0) {
-              if (level.GetState(x-1,y)==unknown) {
-#if defined(DEBUG_TILING)
-                std::cout << "Water left of water: " << x-1 << "," << y << std::endl;
-#endif
-                newLevel.SetState(x-1,y,water);
-              }
+        for (uint32_t y=band*bandRowCount; y<yEnd; y++) {
+          for (uint32_t x=0; x<level.cellXCount; x++) {
+            if (level.GetState(x,y)!=unknown) {
+              continue;
             }
 
-            if (x<level.cellXCount-1) {
-              if (level.GetState(x+1,y)==unknown) {
+            if ((y>0 && level.GetState(x,y-1)==water) ||
+                (y<level.cellYCount-1 && level.GetState(x,y+1)==water) ||
+                (x>0 && level.GetState(x-1,y)==water) ||
+                (x<level.cellXCount-1 && level.GetState(x+1,y)==water)) {
 #if defined(DEBUG_TILING)
-                std::cout << "Water right of water: " << x+1 << "," << y << std::endl;
+              std::cout << "Water next to water: " << x << "," << y << std::endl;
 #endif
-                newLevel.SetState(x+1,y,water);
-              }
+              newLevel.SetState(x,y,water);
             }
           }
         }
@@ -679,70 +697,79 @@ namespace osmscout {
   /**
    * Scanning from left to right and bottom to top: Every tile that is unknown
    * but is placed between land and coast or land cells must be land, too.
+   *
+   * Scanning a row only touches the row itself, so bands of rows are scanned
+   * in parallel.
    */
   void WaterIndexGenerator::FillLand(Progress& progress,
                                      Level& level)
   {
     progress.Info("Filling land");
 
-    bool cont=true;
+    uint32_t bandCount=(level.cellYCount+bandRowCount-1)/bandRowCount;
+    bool     cont=true;
 
     while (cont) {
       cont=false;
 
       // Left to right
-      for (uint32_t y=0; y<level.cellYCount; y++) {
-        uint32_t x=0;
-        uint32_t start=0;
-        uint32_t end=0;
-        uint32_t state=0;
-
-        while (x<level.cellXCount) {
-          switch (state) {
-            case 0:
-              if (level.GetState(x,y)==land) {
-                state=1;
-              }
-              x++;
-              break;
-            case 1:
-              if (level.GetState(x,y)==unknown) {
-                state=2;
-                start=x;
-                end=x;
-                x++;
-              }
-              else {
-                state=0;
-              }
-              break;
-            case 2:
-              if (level.GetState(x,y)==unknown) {
-                end=x;
+#pragma omp parallel for schedule(dynamic) reduction(||:cont)
+      for (uint32_t band=0; band<bandCount; band++) {
+        uint32_t yEnd=std::min((band+1)*bandRowCount,level.cellYCount);
+
+        for (uint32_t y=band*bandRowCount; y<yEnd; y++) {
+          uint32_t x=0;
+          uint32_t start=0;
+          uint32_t end=0;
+          uint32_t state=0;
+
+          while (x<level.cellXCount) {
+            switch (state) {
+              case 0:
+                if (level.GetState(x,y)==land) {
+                  state=1;
+                }
                 x++;
-              }
-              else if (level.GetState(x,y)==coast || level.GetState(x,y)==land) {
-                if (start<level.cellXCount && end<level.cellXCount && start<=end) {
-                  for (uint32_t i=start; i<=end; i++) {
+                break;
+              case 1:
+                if (level.GetState(x,y)==unknown) {
+                  state=2;
+                  start=x;
+                  end=x;
+                  x++;
+                }
+                else {
+                  state=0;
+                }
+                break;
+              case 2:
+                if (level.GetState(x,y)==unknown) {
+                  end=x;
+                  x++;
+                }
+                else if (level.GetState(x,y)==coast || level.GetState(x,y)==land) {
+                  if (start<level.cellXCount && end<level.cellXCount && start<=end) {
+                    for (uint32_t i=start; i<=end; i++) {
 #if defined(DEBUG_TILING)
-                    std::cout << "Land between: " << i << "," << y << std::endl;
+                      std::cout << "Land between: " << i << "," << y << std::endl;
 #endif
-                    level.SetState(i,y,land);
-                    cont=true;
+                      level.SetState(i,y,land);
+                      cont=true;
+                    }
                   }
-                }
 
-                state=0;
-              }
-              else {
-                state=0;
-              }
-              break;
+                  state=0;
+                }
+                else {
+                  state=0;
+                }
+                break;
+            }
           }
         }
       }
 
-      //Bottom Up
+      // Bottom up, cells of neighbouring columns share the same bytes, so no parallelization here
       for (uint32_t x=0; x<level.cellXCount; x++) {
         uint32_t y=0;
         uint32_t start=0;
@@ -936,6 +963,15 @@ namespace osmscout {
     }
   }
 
+  void WaterIndexGenerator::GetCells(const Level& level,
+                                     const std::vector<CompactGeoCoord>& points,
+                                     std::set<Pixel>& cellIntersections)
+  {
+    for (size_t p=0; p<points.size()-1; p++) {
+      GetCells(level,points[p].GetCoord(),points[p+1].GetCoord(),cellIntersections);
+    }
+  }
+
   void WaterIndexGenerator::GetCellIntersections(const Level& level,
                                                  const std::vector<GeoCoord>& points,
                                                  size_t coastline,
@@ -1630,6 +1666,55 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Calculates the ground tiles of all cells of the given level that are crossed by
+   * coastlines and derives the state of the neighbouring cells. Only reads the coastlines
+   * and only changes level specific data, so different levels can be handled in parallel.
+   */
+  void WaterIndexGenerator::CalculateCoastlineTiles(const ImportParameter& parameter,
+                                                    Progress& progress,
+                                                    const std::list<CoastRef>& coastlines,
+                                                    uint32_t magnification,
+                                                    Level& level,
+                                                    std::map<Pixel,std::list<GroundTile> >& cellGroundTileMap)
+  {
+    if (!coastlines.empty()) {
+      Magnification      levelMagnification;
+      MercatorProjection projection;
+      Data               data;
+
+      levelMagnification.SetLevel(magnification);
+
+      projection.Set(0,0,levelMagnification,72,640,480);
+
+      MarkCoastlineCells(progress,
+                         coastlines,
+                         level);
+
+      GetCoastlineData(parameter,
+                       progress,
+                       projection,
+                       level,
+                       coastlines,
+                       data);
+
+      HandleAreaCoastlinesCompletelyInACell(progress,
+                                            level,
+                                            data,
+                                            cellGroundTileMap);
+
+      HandleCoastlinesPartiallyInACell(progress,
+                                       coastlines,
+                                       level,
+                                       cellGroundTileMap,
+                                       data);
+    }
+
+    CalculateLandCells(progress,
+                       level,
+                       cellGroundTileMap);
+  }
+
   std::string WaterIndexGenerator::GetDescription() const
   {
     return "Generate 'water.idx'";
@@ -1722,59 +1807,53 @@ namespace osmscout {
                     writer,
                     levels);
 
+    // Calculating the tiles of the individual levels is independent, so we do it in parallel
+    // and pass the collected messages afterwards in level order
+
+    std::vector<std::map<Pixel,std::list<GroundTile> > > cellGroundTileMaps(levels.size());
+    std::vector<BufferedProgress>                        levelProgress(levels.size());
+
+    progress.SetAction("Building coastline tiles");
+
+    for (size_t level=0; level<levels.size(); level++) {
+      levelProgress[level].SetOutputDebug(progress.OutputDebug());
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t level=0; level<levels.size(); level++) {
+      CalculateCoastlineTiles(parameter,
+                              levelProgress[level],
+                              coastlines,
+                              (uint32_t)(level+parameter.GetWaterIndexMinMag()),
+                              levels[level],
+                              cellGroundTileMaps[level]);
+    }
+
     for (size_t level=0; level<levels.size(); level++) {
-      FileOffset                             indexOffset;
-      Magnification                          magnification;
-      MercatorProjection                     projection;
-      Data                                   data;
-      std::map<Pixel,std::list<GroundTile> > cellGroundTileMap;
+      progress.Info("Level "+NumberToString(level+parameter.GetWaterIndexMinMag()));
+      levelProgress[level].Forward(progress);
+    }
+
+    levelProgress.clear();
 
-      magnification.SetLevel((uint32_t)(level+parameter.GetWaterIndexMinMag()));
+    if (parameter.GetAssumeLand()) {
+      AssumeLand(parameter,
+                 progress,
+                 *typeConfig,
+                 levels);
+    }
 
-      projection.Set(0,0,magnification,72,640,480);
+    for (size_t level=0; level<levels.size(); level++) {
+      FileOffset                                    indexOffset;
+      const std::map<Pixel,std::list<GroundTile> >& cellGroundTileMap=cellGroundTileMaps[level];
 
-      progress.SetAction("Building tiles for level "+NumberToString(level+parameter.GetWaterIndexMinMag()));
+      progress.SetAction("Filling tiles for level "+NumberToString(level+parameter.GetWaterIndexMinMag()));
 
       writer.GetPos(indexOffset);
       writer.SetPos(levels[level].indexEntryOffset);
       writer.WriteFileOffset(indexOffset);
       writer.SetPos(indexOffset);
 
-      if (!coastlines.empty()) {
-        MarkCoastlineCells(progress,
-                           coastlines,
-                           levels[level]);
-
-        GetCoastlineData(parameter,
-                         progress,
-                         projection,
-                         levels[level],
-                         coastlines,
-                         data);
-
-        HandleAreaCoastlinesCompletelyInACell(progress,
-                                              levels[level],
-                                              data,
-                                              cellGroundTileMap);
-
-        HandleCoastlinesPartiallyInACell(progress,
-                                         coastlines,
-                                         levels[level],
-                                         cellGroundTileMap,
-                                         data);
-      }
-
-      CalculateLandCells(progress,
-                         levels[level],
-                         cellGroundTileMap);
-
-      if (parameter.GetAssumeLand()) {
-        AssumeLand(parameter,
-                   progress,
-                   *typeConfig,
-                   levels[level]);
-      }
-
       if (!coastlines.empty()) {
         FillWater(progress,
                   levels[level],20);
@@ -1827,6 +1906,8 @@ namespace osmscout {
 
         writer.SetPos(endPos);
       }
+
+      cellGroundTileMaps[level].clear();
     }
 
     coastlines.clear();
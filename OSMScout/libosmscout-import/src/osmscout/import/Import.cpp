@@ -19,6 +19,8 @@
 
 #include <osmscout/import/Import.h>
 
+#include <time.h>
+
 #include <iostream>
 
 #include <osmscout/Types.h>
@@ -55,10 +57,13 @@
 #include <osmscout/import/GenNumericIndex.h>
 
 #include <osmscout/import/GenAreaAreaIndex.h>
+#include <osmscout/import/GenAreaAreaRTreeIndex.h>
 #include <osmscout/import/GenAreaNodeIndex.h>
 #include <osmscout/import/GenAreaWayIndex.h>
 
 #include <osmscout/import/GenLocationIndex.h>
+#include <osmscout/import/GenReverseGeocodeIndex.h>
+#include <osmscout/import/GenPOIIndex.h>
 #include <osmscout/import/GenOptimizeAreaWayIds.h>
 #include <osmscout/import/GenWaterIndex.h>
 
@@ -72,26 +77,32 @@
 #include <osmscout/import/GenTextIndex.h>
 #endif
 
+#include <osmscout/import/ImportManifest.h>
+
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout {
 
   static const size_t defaultStartStep=1;
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=28;
+  static const size_t defaultEndStep=31;
 #else
-  static const size_t defaultEndStep=27;
+  static const size_t defaultEndStep=30;
 #endif
 
   ImportParameter::ImportParameter()
    : typefile("map.ost"),
      startStep(defaultStartStep),
      endStep(defaultEndStep),
+     incremental(false),
      strictAreas(false),
      sortObjects(true),
-     sortBlockSize(40000000),
+     sortMemoryBudget(1024*1024*1024),
      sortTileMag(14),
+     columnStore(false),
+     dataCompressionBlockSize(0),
      numericIndexPageSize(4096),
      coordDataMemoryMaped(false),
      rawNodeDataMemoryMaped(false),
@@ -101,11 +112,13 @@ namespace osmscout {
      rawWayDataCacheSize(5000),
      rawWayIndexCacheSize(10000),
      rawWayBlockSize(500000),
+     rawRelationBlockSize(5000),
      areaDataMemoryMaped(false),
      areaDataCacheSize(0),
      wayDataMemoryMaped(false),
      wayDataCacheSize(0),
      areaAreaIndexMaxMag(15),
+     areaAreaIndexRTree(false),
      areaWayMinMag(11), // Should not be >= than optimizationMaxMag
      areaNodeMinMag(8),
      areaNodeIndexMinFillRate(0.1),
@@ -150,6 +163,11 @@ namespace osmscout {
     return endStep;
   }
 
+  bool ImportParameter::GetIncremental() const
+  {
+    return incremental;
+  }
+
   bool ImportParameter::GetStrictAreas() const
   {
     return strictAreas;
@@ -160,9 +178,9 @@ namespace osmscout {
     return sortObjects;
   }
 
-  size_t ImportParameter::GetSortBlockSize() const
+  size_t ImportParameter::GetSortMemoryBudget() const
   {
-    return sortBlockSize;
+    return sortMemoryBudget;
   }
 
   size_t ImportParameter::GetSortTileMag() const
@@ -170,6 +188,16 @@ namespace osmscout {
     return sortTileMag;
   }
 
+  bool ImportParameter::GetColumnStore() const
+  {
+    return columnStore;
+  }
+
+  size_t ImportParameter::GetDataCompressionBlockSize() const
+  {
+    return dataCompressionBlockSize;
+  }
+
   size_t ImportParameter::GetNumericIndexPageSize() const
   {
     return numericIndexPageSize;
@@ -210,6 +238,11 @@ namespace osmscout {
     return rawWayBlockSize;
   }
 
+  size_t ImportParameter::GetRawRelationBlockSize() const
+  {
+    return rawRelationBlockSize;
+  }
+
   size_t ImportParameter::GetRawNodeDataCacheSize() const
   {
     return rawNodeDataCacheSize;
@@ -265,6 +298,11 @@ namespace osmscout {
     return areaAreaIndexMaxMag;
   }
 
+  bool ImportParameter::GetAreaAreaIndexRTree() const
+  {
+    return areaAreaIndexRTree;
+  }
+
   size_t ImportParameter::GetWaterIndexMinMag() const
   {
     return waterIndexMinMag;
@@ -342,6 +380,11 @@ namespace osmscout {
     this->endStep=endStep;
   }
 
+  void ImportParameter::SetIncremental(bool incremental)
+  {
+    this->incremental=incremental;
+  }
+
   void ImportParameter::SetStrictAreas(bool strictAreas)
   {
     this->strictAreas=strictAreas;
@@ -352,9 +395,9 @@ namespace osmscout {
     this->sortObjects=renumberIds;
   }
 
-  void ImportParameter::SetSortBlockSize(size_t sortBlockSize)
+  void ImportParameter::SetSortMemoryBudget(size_t sortMemoryBudget)
   {
-    this->sortBlockSize=sortBlockSize;
+    this->sortMemoryBudget=sortMemoryBudget;
   }
 
   void ImportParameter::SetSortTileMag(size_t sortTileMag)
@@ -362,6 +405,16 @@ namespace osmscout {
     this->sortTileMag=sortTileMag;
   }
 
+  void ImportParameter::SetColumnStore(bool columnStore)
+  {
+    this->columnStore=columnStore;
+  }
+
+  void ImportParameter::SetDataCompressionBlockSize(size_t dataCompressionBlockSize)
+  {
+    this->dataCompressionBlockSize=dataCompressionBlockSize;
+  }
+
   void ImportParameter::SetNumericIndexPageSize(size_t numericIndexPageSize)
   {
     this->numericIndexPageSize=numericIndexPageSize;
@@ -402,6 +455,11 @@ namespace osmscout {
     this->rawWayBlockSize=blockSize;
   }
 
+  void ImportParameter::SetRawRelationBlockSize(size_t blockSize)
+  {
+    this->rawRelationBlockSize=blockSize;
+  }
+
   void ImportParameter::SetRawNodeDataCacheSize(size_t nodeDataCacheSize)
   {
     this->rawNodeDataCacheSize=nodeDataCacheSize;
@@ -433,6 +491,11 @@ namespace osmscout {
     this->areaAreaIndexMaxMag=areaAreaIndexMaxMag;
   }
 
+  void ImportParameter::SetAreaAreaIndexRTree(bool areaAreaIndexRTree)
+  {
+    this->areaAreaIndexRTree=areaAreaIndexRTree;
+  }
+
   void ImportParameter::SetAreaNodeMinMag(size_t areaNodeMinMag)
   {
     this->areaNodeMinMag=areaNodeMinMag;
@@ -520,8 +583,28 @@ namespace osmscout {
                             Progress& progress,
                             const TypeConfigRef& typeConfig)
   {
-    StopClock overAllTimer;
-    size_t    currentStep=1;
+    StopClock                overAllTimer;
+    size_t                   currentStep=1;
+    ImportManifest           manifest;
+    std::vector<std::string> descriptions;
+    size_t                   upToDateStep=0;
+
+    for (const auto& module : modules) {
+      descriptions.push_back(module->GetDescription());
+    }
+
+    if (parameter.GetIncremental()) {
+      progress.SetStep("Checking import manifest");
+
+      if (!manifest.Open(parameter,
+                         progress)) {
+        return false;
+      }
+
+      upToDateStep=manifest.GetUpToDateStep(parameter.GetStartStep(),
+                                            parameter.GetEndStep(),
+                                            descriptions);
+    }
 
     for (const auto& module : modules) {
       if (currentStep>=parameter.GetStartStep() &&
@@ -534,9 +617,22 @@ namespace osmscout {
                          " - "+
                          module->GetDescription());
 
-        success=module->Import(typeConfig,
-                               parameter,
-                               progress);
+        if (currentStep<=upToDateStep) {
+          progress.Info("Result is up to date, skipping step");
+
+          currentStep++;
+          continue;
+        }
+
+        uint64_t startTime=(uint64_t)time(NULL);
+
+        {
+          OSMSCOUT_TRACE_SPAN("import",Tracer::InternName(module->GetDescription()));
+
+          success=module->Import(typeConfig,
+                                 parameter,
+                                 progress);
+        }
 
         timer.Stop();
 
@@ -546,6 +642,19 @@ namespace osmscout {
           progress.Error(std::string("Error while executing step '")+module->GetDescription()+"'!");
           return false;
         }
+
+        if (parameter.GetIncremental()) {
+          if (!manifest.FinishStep(progress,
+                                   currentStep,
+                                   module->GetDescription(),
+                                   startTime)) {
+            return false;
+          }
+
+          upToDateStep=manifest.GetUpToDateStep(currentStep+1,
+                                                parameter.GetEndStep(),
+                                                descriptions);
+        }
       }
 
       currentStep++;
@@ -650,50 +759,59 @@ namespace osmscout {
     modules.push_back(new AreaAreaIndexGenerator());
 
     /* 19 */
-    modules.push_back(new WaterIndexGenerator());
+    modules.push_back(new AreaAreaRTreeIndexGenerator());
 
     /* 20 */
-    modules.push_back(new OptimizeAreasLowZoomGenerator());
+    modules.push_back(new WaterIndexGenerator());
 
     /* 21 */
-    modules.push_back(new OptimizeWaysLowZoomGenerator());
+    modules.push_back(new OptimizeAreasLowZoomGenerator());
 
     /* 22 */
-    modules.push_back(new LocationIndexGenerator());
+    modules.push_back(new OptimizeWaysLowZoomGenerator());
 
     /* 23 */
-    modules.push_back(new RouteDataGenerator());
+    modules.push_back(new LocationIndexGenerator());
 
     /* 24 */
+    modules.push_back(new RouteDataGenerator());
+
+    /* 25 */
     modules.push_back(new NumericIndexGenerator<Id,Intersection>(std::string("Generating '")+RoutingService::FILENAME_INTERSECTIONS_IDX+"'",
                                                                  AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                  RoutingService::FILENAME_INTERSECTIONS_DAT),
                                                                  AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                  RoutingService::FILENAME_INTERSECTIONS_IDX)));
 
-    /* 25 */
+    /* 26 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+RoutingService::FILENAME_FOOT_IDX+"'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_FOOT_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_FOOT_IDX)));
 
-    /* 26 */
+    /* 27 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+RoutingService::FILENAME_BICYCLE_IDX+"'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_BICYCLE_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_BICYCLE_IDX)));
 
-    /* 27 */
+    /* 28 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+RoutingService::FILENAME_CAR_IDX+"'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_CAR_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_CAR_IDX)));
 
+    /* 29 */
+    modules.push_back(new ReverseGeocodeIndexGenerator());
+
+    /* 30 */
+    modules.push_back(new POIIndexGenerator());
+
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-    /* 28 */
+    /* 31 */
     modules.push_back(new TextIndexGenerator());
 #endif
 
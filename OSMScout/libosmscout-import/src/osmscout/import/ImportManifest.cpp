@@ -0,0 +1,594 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/ImportManifest.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(__WIN32__) || defined(WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  const char* const ImportManifest::FILENAME_IMPORT_MANIFEST = "import.manifest";
+
+  template<typename T>
+  static void AddParameter(std::list<std::string>& parameter,
+                           const char* name,
+                           const T& value)
+  {
+    std::ostringstream stream;
+
+    stream.imbue(std::locale::classic());
+    stream.precision(std::numeric_limits<double>::digits10+2);
+
+    stream << name << " " << value;
+
+    parameter.push_back(stream.str());
+  }
+
+  /**
+   * Return all parameter that influence the result of the import. Parameter that only
+   * influence how files are accessed (memory mapping, cache sizes) are not included,
+   * so they can be changed before resuming an import.
+   */
+  static void GetParameter(const ImportParameter& parameter,
+                           std::list<std::string>& values)
+  {
+    AddParameter(values,"strictAreas",parameter.GetStrictAreas());
+    AddParameter(values,"sortObjects",parameter.GetSortObjects());
+    AddParameter(values,"sortMemoryBudget",parameter.GetSortMemoryBudget());
+    AddParameter(values,"sortTileMag",parameter.GetSortTileMag());
+    AddParameter(values,"columnStore",parameter.GetColumnStore());
+    AddParameter(values,"dataCompressionBlockSize",parameter.GetDataCompressionBlockSize());
+    AddParameter(values,"numericIndexPageSize",parameter.GetNumericIndexPageSize());
+    AddParameter(values,"rawWayBlockSize",parameter.GetRawWayBlockSize());
+    AddParameter(values,"rawRelationBlockSize",parameter.GetRawRelationBlockSize());
+    AddParameter(values,"areaAreaIndexMaxMag",parameter.GetAreaAreaIndexMaxMag());
+    AddParameter(values,"areaAreaIndexRTree",parameter.GetAreaAreaIndexRTree());
+    AddParameter(values,"areaWayMinMag",parameter.GetAreaWayMinMag());
+    AddParameter(values,"areaNodeMinMag",parameter.GetAreaNodeMinMag());
+    AddParameter(values,"areaNodeIndexMinFillRate",parameter.GetAreaNodeIndexMinFillRate());
+    AddParameter(values,"areaNodeIndexCellSizeAverage",parameter.GetAreaNodeIndexCellSizeAverage());
+    AddParameter(values,"areaNodeIndexCellSizeMax",parameter.GetAreaNodeIndexCellSizeMax());
+    AddParameter(values,"waterIndexMinMag",parameter.GetWaterIndexMinMag());
+    AddParameter(values,"waterIndexMaxMag",parameter.GetWaterIndexMaxMag());
+    AddParameter(values,"optimizationMaxWayCount",parameter.GetOptimizationMaxWayCount());
+    AddParameter(values,"optimizationMaxMag",parameter.GetOptimizationMaxMag());
+    AddParameter(values,"optimizationMinMag",parameter.GetOptimizationMinMag());
+    AddParameter(values,"optimizationCellSizeAverage",parameter.GetOptimizationCellSizeAverage());
+    AddParameter(values,"optimizationCellSizeMax",parameter.GetOptimizationCellSizeMax());
+    AddParameter(values,"optimizationWayMethod",(int)parameter.GetOptimizationWayMethod());
+    AddParameter(values,"routeNodeBlockSize",parameter.GetRouteNodeBlockSize());
+    AddParameter(values,"assumeLand",parameter.GetAssumeLand());
+  }
+
+  ImportManifest::ImportManifest()
+  {
+    // no code
+  }
+
+  /**
+   * Calculates a 64 bit FNV-1a hash of the complete file content.
+   */
+  bool ImportManifest::GetFileContentHash(const std::string& filename,
+                                          uint64_t& hash)
+  {
+    FILE *file=fopen(filename.c_str(),"rb");
+
+    if (file==NULL) {
+      return false;
+    }
+
+    std::vector<unsigned char> buffer(1024*1024);
+    size_t                     count;
+
+    hash=14695981039346656037ULL;
+
+    while ((count=fread(&buffer[0],1,buffer.size(),file))>0) {
+      for (size_t i=0; i<count; i++) {
+        hash^=buffer[i];
+        hash*=1099511628211ULL;
+      }
+    }
+
+    bool error=ferror(file)!=0;
+
+    fclose(file);
+
+    return !error;
+  }
+
+  /**
+   * Return the state of the given file. The content hash of the previous state is reused,
+   * if size and modification time did not change and the file was not modified at or after
+   * the given point in time (modification times only have a resolution of a second).
+   */
+  bool ImportManifest::GetFileState(const std::string& filename,
+                                    const FileState* previousState,
+                                    uint64_t unchangedBefore,
+                                    FileState& state)
+  {
+    struct stat fileStat;
+
+    if (stat(filename.c_str(),&fileStat)!=0) {
+      return false;
+    }
+
+    state.size=(FileOffset)fileStat.st_size;
+    state.modificationTime=(uint64_t)fileStat.st_mtime;
+
+    if (previousState!=NULL &&
+        previousState->size==state.size &&
+        previousState->modificationTime==state.modificationTime &&
+        state.modificationTime<unchangedBefore) {
+      state.hash=previousState->hash;
+
+      return true;
+    }
+
+    return GetFileContentHash(filename,
+                              state.hash);
+  }
+
+  /**
+   * Return the names of all regular files in the destination directory, excluding the manifest itself.
+   */
+  bool ImportManifest::ListDirectory(std::list<std::string>& files) const
+  {
+    std::string manifestFile(FILENAME_IMPORT_MANIFEST);
+    std::string manifestTmpFile(manifestFile+".tmp");
+
+#if defined(__WIN32__) || defined(WIN32)
+    WIN32_FIND_DATAA data;
+    HANDLE           handle=FindFirstFileA(AppendFileToDir(directory,"*").c_str(),
+                                           &data);
+
+    if (handle==INVALID_HANDLE_VALUE) {
+      return false;
+    }
+
+    do {
+      std::string name(data.cFileName);
+
+      if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)==0 &&
+          name!=manifestFile &&
+          name!=manifestTmpFile) {
+        files.push_back(name);
+      }
+    } while (FindNextFileA(handle,&data));
+
+    FindClose(handle);
+#else
+    DIR *dir=opendir(directory.c_str());
+
+    if (dir==NULL) {
+      return false;
+    }
+
+    struct dirent *entry;
+
+    while ((entry=readdir(dir))!=NULL) {
+      std::string name(entry->d_name);
+      struct stat fileStat;
+
+      if (name==manifestFile ||
+          name==manifestTmpFile) {
+        continue;
+      }
+
+      if (stat(AppendFileToDir(directory,name).c_str(),&fileStat)==0 &&
+          S_ISREG(fileStat.st_mode)) {
+        files.push_back(name);
+      }
+    }
+
+    closedir(dir);
+#endif
+
+    return true;
+  }
+
+  /**
+   * Return true, if all expected files exist in the destination directory with the expected state.
+   * Additional files are ignored.
+   */
+  bool ImportManifest::Matches(const FileStateMap& expected) const
+  {
+    for (const auto& file : expected) {
+      FileStateMap::const_iterator currentFile=current.find(file.first);
+
+      if (currentFile==current.end() ||
+          !(currentFile->second==file.second)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool ImportManifest::Load(Progress& progress,
+                            std::list<std::string>& parameter,
+                            FileStateMap& inputs)
+  {
+    std::ifstream stream(filename.c_str(),
+                         std::ios::in);
+
+    if (!stream.is_open()) {
+      progress.Info("No import manifest found");
+      return false;
+    }
+
+    std::string line;
+    size_t      lineNumber=0;
+    Step        *currentStep=NULL;
+
+    while (std::getline(stream,line)) {
+      std::istringstream lineStream(line);
+      std::string        keyword;
+      bool               error=false;
+
+      lineNumber++;
+
+      if (line.empty() ||
+          line[0]=='#') {
+        continue;
+      }
+
+      lineStream.imbue(std::locale::classic());
+      lineStream >> keyword;
+
+      if (keyword=="parameter") {
+        std::string value;
+
+        std::getline(lineStream >> std::ws,value);
+
+        error=lineStream.fail();
+
+        if (!error) {
+          parameter.push_back(value);
+        }
+      }
+      else if (keyword=="input" ||
+               keyword=="file") {
+        FileState   state;
+        std::string name;
+
+        lineStream >> state.size >> state.modificationTime >> state.hash;
+        std::getline(lineStream >> std::ws,name);
+
+        error=lineStream.fail() ||
+              (keyword=="file" && currentStep==NULL);
+
+        if (!error) {
+          if (keyword=="input") {
+            inputs[name]=state;
+          }
+          else {
+            currentStep->files[name]=state;
+          }
+        }
+      }
+      else if (keyword=="step") {
+        size_t number;
+        Step   step;
+
+        lineStream >> number >> step.finished;
+        std::getline(lineStream >> std::ws,step.description);
+
+        error=lineStream.fail();
+
+        if (!error) {
+          currentStep=&steps[number];
+          *currentStep=step;
+        }
+      }
+      else {
+        error=true;
+      }
+
+      if (error) {
+        progress.Warning("Cannot parse line "+NumberToString(lineNumber)+" of '"+filename+"', ignoring import manifest");
+        steps.clear();
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool ImportManifest::Save() const
+  {
+    std::string   tmpFilename=filename+".tmp";
+    std::ofstream stream;
+
+    stream.open(tmpFilename.c_str(),
+                std::ios::out|std::ios::trunc);
+
+    if (!stream.is_open()) {
+      return false;
+    }
+
+    stream.imbue(std::locale::classic());
+
+    stream << "# libosmscout import manifest" << std::endl;
+
+    for (const auto& value : parameter) {
+      stream << "parameter " << value << std::endl;
+    }
+
+    for (const auto& input : inputs) {
+      stream << "input " << input.second.size << " " << input.second.modificationTime << " " << input.second.hash << " " << input.first << std::endl;
+    }
+
+    for (const auto& step : steps) {
+      stream << "step " << step.first << " " << step.second.finished << " " << step.second.description << std::endl;
+
+      for (const auto& file : step.second.files) {
+        stream << "file " << file.second.size << " " << file.second.modificationTime << " " << file.second.hash << " " << file.first << std::endl;
+      }
+    }
+
+    stream.flush();
+
+    bool error=stream.fail();
+
+    stream.close();
+
+    if (error) {
+      return false;
+    }
+
+    RemoveFile(filename);
+
+    return RenameFile(tmpFilename,
+                      filename);
+  }
+
+  /**
+   * Load the manifest of a previous import from the destination directory (if there is one)
+   * and determine the state of the input files and the destination directory.
+   *
+   * The recorded steps of a previous import are dropped, if the import parameter or
+   * the input files have changed since.
+   */
+  bool ImportManifest::Open(const ImportParameter& parameter,
+                            Progress& progress)
+  {
+    std::list<std::string> oldParameter;
+    FileStateMap           oldInputs;
+    std::list<std::string> inputFiles;
+    std::list<std::string> files;
+    uint64_t               now=(uint64_t)time(NULL);
+
+    directory=parameter.GetDestinationDirectory();
+    filename=AppendFileToDir(directory,
+                             FILENAME_IMPORT_MANIFEST);
+
+    this->parameter.clear();
+    inputs.clear();
+    steps.clear();
+    current.clear();
+
+    GetParameter(parameter,
+                 this->parameter);
+
+    bool loaded=Load(progress,
+                     oldParameter,
+                     oldInputs);
+
+    inputFiles.push_back(parameter.GetTypefile());
+    inputFiles.insert(inputFiles.end(),
+                      parameter.GetMapfiles().begin(),
+                      parameter.GetMapfiles().end());
+
+    for (const auto& inputFile : inputFiles) {
+      FileStateMap::const_iterator oldInput=oldInputs.find(inputFile);
+      FileState                    state;
+
+      if (!GetFileState(inputFile,
+                        oldInput!=oldInputs.end() ? &oldInput->second : NULL,
+                        now,
+                        state)) {
+        progress.Error("Cannot read input file '"+inputFile+"'");
+        return false;
+      }
+
+      inputs[inputFile]=state;
+    }
+
+    if (loaded &&
+        (oldParameter!=this->parameter ||
+         oldInputs!=inputs)) {
+      progress.Info("Import parameter or input files have changed, ignoring import manifest");
+      steps.clear();
+    }
+
+    if (!ListDirectory(files)) {
+      progress.Error("Cannot read directory '"+directory+"'");
+      return false;
+    }
+
+    for (const auto& file : files) {
+      const FileState* previousState=NULL;
+      uint64_t         unchangedBefore=0;
+      FileState        state;
+
+      // The latest recorded state of the file
+      for (std::map<size_t,Step>::const_reverse_iterator step=steps.rbegin();
+           step!=steps.rend();
+           ++step) {
+        FileStateMap::const_iterator stepFile=step->second.files.find(file);
+
+        if (stepFile!=step->second.files.end()) {
+          previousState=&stepFile->second;
+          unchangedBefore=step->second.finished;
+          break;
+        }
+      }
+
+      if (!GetFileState(AppendFileToDir(directory,file),
+                        previousState,
+                        unchangedBefore,
+                        state)) {
+        progress.Error("Cannot read file '"+AppendFileToDir(directory,file)+"'");
+        return false;
+      }
+
+      current[file]=state;
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the highest step in the given range, whose recorded result matches the
+   * current content of the destination directory. All steps up to and including the
+   * returned step do not need to be executed. If there is no such step, startStep-1
+   * is returned.
+   */
+  size_t ImportManifest::GetUpToDateStep(size_t startStep,
+                                         size_t endStep,
+                                         const std::vector<std::string>& descriptions) const
+  {
+    startStep=std::max(startStep,(size_t)1);
+    endStep=std::min(endStep,descriptions.size());
+
+    for (size_t step=endStep; step>=startStep; step--) {
+      std::map<size_t,Step>::const_iterator entry=steps.find(step);
+
+      if (entry!=steps.end() &&
+          entry->second.description==descriptions[step-1] &&
+          Matches(entry->second.files)) {
+        return step;
+      }
+    }
+
+    return startStep-1;
+  }
+
+  /**
+   * Record the state of the destination directory after the given step has been executed
+   * and write the manifest.
+   *
+   * If the result of the step differs from the recorded result of a previous execution,
+   * the records of all following steps are dropped, since they are based on the old result.
+   */
+  bool ImportManifest::FinishStep(Progress& progress,
+                                  size_t step,
+                                  const std::string& description,
+                                  uint64_t startTime)
+  {
+    std::list<std::string> files;
+    FileStateMap           state;
+
+    if (!ListDirectory(files)) {
+      progress.Error("Cannot read directory '"+directory+"'");
+      return false;
+    }
+
+    for (const auto& file : files) {
+      FileStateMap::const_iterator previousState=current.find(file);
+
+      if (!GetFileState(AppendFileToDir(directory,file),
+                        previousState!=current.end() ? &previousState->second : NULL,
+                        startTime,
+                        state[file])) {
+        progress.Error("Cannot read file '"+AppendFileToDir(directory,file)+"'");
+        return false;
+      }
+    }
+
+    Step                                  newStep;
+    std::map<size_t,Step>::const_iterator previousStep=steps.find(step-1);
+    std::map<size_t,Step>::const_iterator oldStep=steps.find(step);
+
+    if (oldStep!=steps.end() &&
+        oldStep->second.description!=description) {
+      oldStep=steps.end();
+    }
+
+    newStep.description=description;
+    newStep.finished=(uint64_t)time(NULL);
+
+    // The result of the step are all files it has written together with the result of
+    // the previous step. Without a recorded previous step all files that existed before
+    // are taken. Files of the last execution of the step are included, too, so that
+    // missing files are detected.
+    for (const auto& file : state) {
+      bool isResult=file.second.modificationTime>=startTime;
+
+      if (!isResult) {
+        if (previousStep!=steps.end()) {
+          isResult=previousStep->second.files.find(file.first)!=previousStep->second.files.end();
+        }
+        else if (step>1) {
+          isResult=current.find(file.first)!=current.end();
+        }
+      }
+
+      if (!isResult &&
+          oldStep!=steps.end()) {
+        isResult=oldStep->second.files.find(file.first)!=oldStep->second.files.end();
+      }
+
+      if (isResult) {
+        newStep.files.insert(file);
+      }
+    }
+
+    bool unchanged=oldStep!=steps.end() &&
+                   newStep.files==oldStep->second.files;
+
+    current=state;
+
+    if (unchanged) {
+      progress.Info("Result of step is unchanged");
+    }
+    else {
+      steps.erase(steps.upper_bound(step),
+                  steps.end());
+    }
+
+    steps[step]=newStep;
+
+    if (!Save()) {
+      progress.Error("Cannot write import manifest '"+filename+"'");
+      return false;
+    }
+
+    return true;
+  }
+}
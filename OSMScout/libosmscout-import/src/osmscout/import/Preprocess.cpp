@@ -737,10 +737,14 @@ namespace osmscout {
     return "Preprocess";
   }
 
+  /**
+   * Parses all map files of the given import parameter, passing all nodes, ways
+   * and relations to the given callback.
+   */
   bool Preprocess::ProcessFiles(const TypeConfigRef& typeConfig,
                                 const ImportParameter& parameter,
                                 Progress& progress,
-                                Callback& callback)
+                                PreprocessorCallback& callback)
   {
     for (const auto& filename : parameter.GetMapfiles()) {
       if (filename.length()>=4 &&
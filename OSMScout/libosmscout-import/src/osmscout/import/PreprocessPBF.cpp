@@ -22,6 +22,7 @@
 #include <osmscout/import/PreprocessPBF.h>
 
 #include <cstdio>
+#include <limits>
 
 // We should try to get rid of this!
 #if defined(__WIN32__) || defined(WIN32)
@@ -270,6 +271,36 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Marker for a string of the string table of the current block, for which
+   * the tag id has not yet been resolved
+   */
+  static const uint32_t tagUnresolved=std::numeric_limits<uint32_t>::max();
+
+  /**
+   * Resets the cache of tag ids for the strings of the string table of the given
+   * block. Keys are repeated heavily within a block, so looking up the tag id
+   * for each string only once saves a hash lookup for each tag of each object.
+   */
+  void PreprocessPBF::ResetBlockTagIds(const PBF::PrimitiveBlock& block)
+  {
+    blockTagIds.assign((size_t)block.stringtable().s_size(),
+                       tagUnresolved);
+  }
+
+  inline TagId PreprocessPBF::GetTagId(const TypeConfig& typeConfig,
+                                       const PBF::PrimitiveBlock& block,
+                                       uint32_t index)
+  {
+    uint32_t& tagId=blockTagIds[index];
+
+    if (tagId==tagUnresolved) {
+      tagId=typeConfig.GetTagId(block.stringtable().s(index));
+    }
+
+    return (TagId)tagId;
+  }
+
   void PreprocessPBF::ReadNodes(const TypeConfig& typeConfig,
                                 const PBF::PrimitiveBlock& block,
                                 const PBF::PrimitiveGroup& group)
@@ -280,7 +311,9 @@ namespace osmscout {
       tagMap.clear();
 
       for (int t=0; t<inputNode.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputNode.keys(t)).c_str());
+        TagId id=GetTagId(typeConfig,
+                          block,
+                          inputNode.keys(t));
 
         if (id!=tagIgnore) {
           tagMap[id]=block.stringtable().s(inputNode.vals(t));
@@ -321,7 +354,9 @@ namespace osmscout {
           break;
         }
 
-        TagId id=typeConfig.GetTagId(block.stringtable().s(dense.keys_vals(t)).c_str());
+        TagId id=GetTagId(typeConfig,
+                          block,
+                          dense.keys_vals(t));
 
         if (id!=tagIgnore) {
           tagMap[id]=block.stringtable().s(dense.keys_vals(t+1));
@@ -348,7 +383,9 @@ namespace osmscout {
       tagMap.clear();
 
       for (int t=0; t<inputWay.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputWay.keys(t)).c_str());
+        TagId id=GetTagId(typeConfig,
+                          block,
+                          inputWay.keys(t));
 
         if (id!=tagIgnore) {
           tagMap[id]=block.stringtable().s(inputWay.vals(t));
@@ -379,7 +416,9 @@ namespace osmscout {
       tagMap.clear();
 
       for (int t=0; t<inputRelation.keys_size(); t++) {
-        TagId id=typeConfig.GetTagId(block.stringtable().s(inputRelation.keys(t)).c_str());
+        TagId id=GetTagId(typeConfig,
+                          block,
+                          inputRelation.keys(t));
 
         if (id!=tagIgnore) {
           tagMap[id]=block.stringtable().s(inputRelation.vals(t));
@@ -503,6 +542,8 @@ namespace osmscout {
         return false;
       }
 
+      ResetBlockTagIds(block);
+
       for (int currentGroup=0;
            currentGroup<block.primitivegroup_size();
            currentGroup++) {
@@ -23,6 +23,8 @@
 
 #include <osmscout/TypeFeatures.h>
 
+#include <osmscout/import/GenColumnDat.h>
+
 #include <iostream>
 namespace osmscout {
 
@@ -204,16 +206,13 @@ namespace osmscout {
   class AreaNodeReductionProcessorFilter : public SortDataGenerator<Area>::ProcessingFilter
   {
   private:
-    std::vector<GeoCoord> nodeBuffer;
-    std::vector<Id>       idBuffer;
-    size_t                duplicateCount;
-    size_t                redundantCount;
-    size_t                overallCount;
+    std::vector<CompactGeoCoord> nodeBuffer;
+    std::vector<Id>              idBuffer;
+    size_t                       duplicateCount;
+    size_t                       redundantCount;
+    size_t                       overallCount;
 
   private:
-    bool IsEqual(const unsigned char buffer1[],
-                 const unsigned char buffer2[]);
-
     bool RemoveDuplicateNodes(Progress& progress,
                               const FileOffset& offset,
                               Area& area,
@@ -250,49 +249,27 @@ namespace osmscout {
     return true;
   }
 
-  bool AreaNodeReductionProcessorFilter::IsEqual(const unsigned char buffer1[],
-                                                 const unsigned char buffer2[])
-  {
-    for (size_t i=0; i<coordByteSize; i++) {
-      if (buffer1[i]!=buffer2[i]) {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
   bool AreaNodeReductionProcessorFilter::RemoveDuplicateNodes(Progress& progress,
                                                               const FileOffset& offset,
                                                               Area& area,
                                                               bool& save)
   {
-    unsigned char buffers[2][coordByteSize];
-
     std::vector<Area::Ring>::iterator ring=area.rings.begin();
 
     while (ring!=area.rings.end()) {
       bool reduced=false;
 
       if (ring->nodes.size()>=2) {
-        size_t lastIndex=0;
-        size_t currentIndex=1;
-
         nodeBuffer.clear();
         idBuffer.clear();
 
-        ring->nodes[0].EncodeToBuffer(buffers[0]);
-
         nodeBuffer.push_back(ring->nodes[0]);
         if (!ring->ids.empty()) {
           idBuffer.push_back(ring->ids[0]);
         }
 
         for (size_t n=1; n<ring->nodes.size(); n++) {
-          ring->nodes[n].EncodeToBuffer(buffers[currentIndex]);
-
-          if (IsEqual(buffers[lastIndex],
-                      buffers[currentIndex])) {
+          if (ring->nodes[n]==nodeBuffer.back()) {
             if (n>=ring->ids.size() ||
                 ring->ids[n]==0) {
               reduced=true;
@@ -307,9 +284,6 @@ namespace osmscout {
               if (n<ring->ids.size()) {
                 idBuffer.push_back(ring->ids[n]);
               }
-
-              lastIndex=currentIndex;
-              currentIndex=(lastIndex+1)%2;
             }
           }
           else {
@@ -317,9 +291,6 @@ namespace osmscout {
             if (n<ring->ids.size()) {
               idBuffer.push_back(ring->ids[n]);
             }
-
-            lastIndex=currentIndex;
-            currentIndex=(lastIndex+1)%2;
           }
         }
       }
@@ -476,6 +447,8 @@ namespace osmscout {
 
     AddFilter(new AreaLocationProcessorFilter());
     AddFilter(new AreaNodeReductionProcessorFilter());
+    AddFilter(new ColumnDataProcessorFilter<Area>(ColumnDataFile::FILENAME_AREAS_COL,
+                                                  refArea));
   }
 
   std::string SortAreaDataGenerator::GetDescription() const
@@ -21,6 +21,8 @@
 
 #include <osmscout/TypeFeatures.h>
 
+#include <osmscout/import/GenColumnDat.h>
+
 namespace osmscout {
   class NodeLocationProcessorFilter : public SortDataGenerator<Node>::ProcessingFilter
   {
@@ -170,6 +172,8 @@ namespace osmscout {
     AddSource("nodes.tmp");
 
     AddFilter(new NodeLocationProcessorFilter());
+    AddFilter(new ColumnDataProcessorFilter<Node>(ColumnDataFile::FILENAME_NODES_COL,
+                                                  refNode));
   }
 
   std::string SortNodeDataGenerator::GetDescription() const
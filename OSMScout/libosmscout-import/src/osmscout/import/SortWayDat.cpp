@@ -23,6 +23,8 @@
 
 #include <osmscout/util/Geometry.h>
 
+#include <osmscout/import/GenColumnDat.h>
+
 namespace osmscout {
 
   class WayLocationProcessorFilter : public SortDataGenerator<Way>::ProcessingFilter
@@ -137,16 +139,13 @@ namespace osmscout {
   class WayNodeReductionProcessorFilter : public SortDataGenerator<Way>::ProcessingFilter
   {
   private:
-    std::vector<GeoCoord> nodeBuffer;
-    std::vector<Id>       idBuffer;
-    size_t                duplicateCount;
-    size_t                redundantCount;
-    size_t                overallCount;
+    std::vector<CompactGeoCoord> nodeBuffer;
+    std::vector<Id>              idBuffer;
+    size_t                       duplicateCount;
+    size_t                       redundantCount;
+    size_t                       overallCount;
 
   private:
-    bool IsEqual(const unsigned char buffer1[],
-                 const unsigned char buffer2[]);
-
     bool RemoveDuplicateNodes(Progress& progress,
                               const FileOffset& offset,
                               Way& way,
@@ -183,47 +182,25 @@ namespace osmscout {
     return true;
   }
 
-  bool WayNodeReductionProcessorFilter::IsEqual(const unsigned char buffer1[],
-                                                const unsigned char buffer2[])
-  {
-    for (size_t i=0; i<coordByteSize; i++) {
-      if (buffer1[i]!=buffer2[i]) {
-        return false;
-      }
-    }
-
-    return true;
-  }
-
   bool WayNodeReductionProcessorFilter::RemoveDuplicateNodes(Progress& progress,
                                                              const FileOffset& offset,
                                                              Way& way,
                                                              bool& save)
   {
-    unsigned char buffers[2][coordByteSize];
-
     bool reduced=false;
 
     if (way.nodes.size()>=2) {
-      size_t lastIndex=0;
-      size_t currentIndex=1;
-
       nodeBuffer.clear();
       idBuffer.clear();
 
       // Prefill with the first coordinate
-      way.nodes[0].EncodeToBuffer(buffers[0]);
-
       nodeBuffer.push_back(way.nodes[0]);
       if (!way.ids.empty()) {
         idBuffer.push_back(way.ids[0]);
       }
 
       for (size_t n=1; n<way.nodes.size(); n++) {
-        way.nodes[n].EncodeToBuffer(buffers[currentIndex]);
-
-        if (IsEqual(buffers[lastIndex],
-                    buffers[currentIndex])) {
+        if (way.nodes[n]==nodeBuffer.back()) {
           if (n>=way.ids.size() ||
               way.ids[n]==0) {
             duplicateCount++;
@@ -240,9 +217,6 @@ namespace osmscout {
             if (n<way.ids.size()) {
               idBuffer.push_back(way.ids[n]);
             }
-
-            lastIndex=currentIndex;
-            currentIndex=(lastIndex+1)%2;
           }
         }
         else {
@@ -250,9 +224,6 @@ namespace osmscout {
           if (n<way.ids.size()) {
             idBuffer.push_back(way.ids[n]);
           }
-
-          lastIndex=currentIndex;
-          currentIndex=(lastIndex+1)%2;
         }
       }
     }
@@ -384,6 +355,8 @@ namespace osmscout {
 
     AddFilter(new WayLocationProcessorFilter());
     AddFilter(new WayNodeReductionProcessorFilter());
+    AddFilter(new ColumnDataProcessorFilter<Way>(ColumnDataFile::FILENAME_WAYS_COL,
+                                                 refWay));
   }
 
   std::string SortWayDataGenerator::GetDescription() const
@@ -297,7 +297,7 @@ namespace osmscout {
                            const MapParameter& parameter,
                            const ObjectFileRef& ref,
                            const FeatureValueBuffer& buffer,
-                           const std::vector<GeoCoord>& nodes,
+                           const std::vector<CompactGeoCoord>& nodes,
                            const std::vector<Id>& ids);
 
     void PrepareWays(const StyleConfig& styleConfig,
@@ -374,7 +374,7 @@ namespace osmscout {
      */
     //@{
     bool IsVisible(const Projection& projection,
-                   const std::vector<GeoCoord>& nodes,
+                   const std::vector<CompactGeoCoord>& nodes,
                    double pixelOffset) const;
 
     void Transform(const Projection& projection,
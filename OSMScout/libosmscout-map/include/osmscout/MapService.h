@@ -26,6 +26,12 @@
 
 #include <osmscout/private/MapImportExport.h>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <future>
+#endif
+
 #include <osmscout/Database.h>
 #include <osmscout/TypeConfig.h>
 #include <osmscout/TypeSet.h>
@@ -82,6 +88,35 @@ namespace osmscout {
     bool IsAborted() const;
   };
 
+  /**
+   * \ingroup Service
+   * Callback for MapService::GetObjectsAsync(). Each method gets called as soon
+   * as the corresponding objects have been loaded, so that clients can start
+   * drawing before all data is available.
+   *
+   * The methods are called from the loading threads and may be called
+   * concurrently. They are not called for objects whose loading failed or
+   * has been aborted.
+   */
+  class OSMSCOUT_MAP_API MapLoadCallback
+  {
+  public:
+    virtual ~MapLoadCallback();
+
+    virtual void NodesLoaded(const std::vector<NodeRef>& nodes);
+    virtual void WaysLoaded(const std::vector<WayRef>& ways);
+    virtual void AreasLoaded(const std::vector<AreaRef>& areas);
+    virtual void GroundTilesLoaded(const std::list<GroundTile>& groundTiles);
+  };
+
+  //! \ingroup Service
+  //! Reference counted reference to a MapLoadCallback instance
+  typedef std::shared_ptr<MapLoadCallback> MapLoadCallbackRef;
+
+  //! \ingroup Service
+  //! Reference counted reference to a MapData instance
+  typedef std::shared_ptr<MapData> MapDataRef;
+
   /**
    * \ingroup Service
    * MapService offers services for retrieving data in a way that is
@@ -123,6 +158,43 @@ namespace osmscout {
                                std::string& areasTime,
                                std::vector<AreaRef>& areas) const;
 
+#if defined(OSMSCOUT_HAVE_THREAD)
+    bool LoadNodesAsync(const AreaSearchParameter& parameter,
+                        const TypeSet& nodeTypes,
+                        const GeoBox& boundingBox,
+                        std::vector<NodeRef>& nodes,
+                        const MapLoadCallbackRef& callback) const;
+
+    bool LoadWaysAsync(const AreaSearchParameter& parameter,
+                       const std::vector<TypeSet>& wayTypes,
+                       const Magnification& magnification,
+                       const GeoBox& boundingBox,
+                       std::vector<WayRef>& ways,
+                       const MapLoadCallbackRef& callback) const;
+
+    bool LoadAreasAsync(const AreaSearchParameter& parameter,
+                        const TypeSet& areaTypes,
+                        const Magnification& magnification,
+                        const GeoBox& boundingBox,
+                        std::vector<AreaRef>& areas,
+                        const MapLoadCallbackRef& callback) const;
+
+    bool LoadGroundTilesAsync(const AreaSearchParameter& parameter,
+                              const Magnification& magnification,
+                              const GeoBox& boundingBox,
+                              std::list<GroundTile>& groundTiles,
+                              const MapLoadCallbackRef& callback) const;
+
+    bool LoadObjectsAsync(const AreaSearchParameter& parameter,
+                          const Magnification& magnification,
+                          const TypeSet& nodeTypes,
+                          const std::vector<TypeSet>& wayTypes,
+                          const TypeSet& areaTypes,
+                          const GeoBox& boundingBox,
+                          const MapDataRef& data,
+                          const MapLoadCallbackRef& callback) const;
+#endif
+
   public:
     MapService(const DatabaseRef& database);
     virtual ~MapService();
@@ -144,6 +216,14 @@ namespace osmscout {
                     const GeoBox& areaBoundingBox,
                     std::vector<AreaRef>& areas) const;
 
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::future<bool> GetObjectsAsync(const AreaSearchParameter& parameter,
+                                      const StyleConfig& styleConfig,
+                                      const Projection& projection,
+                                      const MapDataRef& data,
+                                      const MapLoadCallbackRef& callback) const;
+#endif
+
     bool GetGroundTiles(const Projection& projection,
                         std::list<GroundTile>& tiles) const;
 
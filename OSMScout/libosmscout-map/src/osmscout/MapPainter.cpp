@@ -26,6 +26,7 @@
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 
 //#define DEBUG_GROUNDTILES
 
@@ -112,26 +113,38 @@ namespace osmscout {
   }
 
   bool MapPainter::IsVisible(const Projection& projection,
-                             const std::vector<GeoCoord>& nodes,
+                             const std::vector<CompactGeoCoord>& nodes,
                              double pixelOffset) const
   {
     if (nodes.empty()) {
       return false;
     }
 
-    // Bounding box
-    double lonMin=nodes[0].GetLon();
-    double lonMax=nodes[0].GetLon();
-    double latMin=nodes[0].GetLat();
-    double latMax=nodes[0].GetLat();
+    // Bounding box, calculated on the fixed point values, so that only
+    // the resulting corners have to be converted
+    uint32_t fixedLonMin=nodes[0].GetFixedLon();
+    uint32_t fixedLonMax=nodes[0].GetFixedLon();
+    uint32_t fixedLatMin=nodes[0].GetFixedLat();
+    uint32_t fixedLatMax=nodes[0].GetFixedLat();
 
     for (size_t i=1; i<nodes.size(); i++) {
-      lonMin=std::min(lonMin,nodes[i].GetLon());
-      lonMax=std::max(lonMax,nodes[i].GetLon());
-      latMin=std::min(latMin,nodes[i].GetLat());
-      latMax=std::max(latMax,nodes[i].GetLat());
+      fixedLonMin=std::min(fixedLonMin,nodes[i].GetFixedLon());
+      fixedLonMax=std::max(fixedLonMax,nodes[i].GetFixedLon());
+      fixedLatMin=std::min(fixedLatMin,nodes[i].GetFixedLat());
+      fixedLatMax=std::max(fixedLatMax,nodes[i].GetFixedLat());
     }
 
+    CompactGeoCoord minCoord;
+    CompactGeoCoord maxCoord;
+
+    minCoord.SetFixed(fixedLatMin,fixedLonMin);
+    maxCoord.SetFixed(fixedLatMax,fixedLonMax);
+
+    double lonMin=minCoord.GetLon();
+    double lonMax=maxCoord.GetLon();
+    double latMin=minCoord.GetLat();
+    double latMax=maxCoord.GetLat();
+
     double x1;
     double x2;
     double y1;
@@ -1350,7 +1363,7 @@ namespace osmscout {
                                      const MapParameter& parameter,
                                      const ObjectFileRef& ref,
                                      const FeatureValueBuffer& buffer,
-                                     const std::vector<GeoCoord>& nodes,
+                                     const std::vector<CompactGeoCoord>& nodes,
                                      const std::vector<Id>& ids)
   {
     styleConfig.GetWayLineStyles(buffer,
@@ -1525,6 +1538,8 @@ namespace osmscout {
                         const MapParameter& parameter,
                         const MapData& data)
   {
+    OSMSCOUT_TRACE_SPAN("map","MapPainter::Draw");
+
     waysSegments=0;
     waysDrawn=0;
     waysLabelDrawn=0;
@@ -1755,6 +1770,11 @@ namespace osmscout {
                  parameter,
                  data);
 
+    OSMSCOUT_TRACE_COUNTER("MapPainter.waysDrawn",waysDrawn);
+    OSMSCOUT_TRACE_COUNTER("MapPainter.areasDrawn",areasDrawn);
+    OSMSCOUT_TRACE_COUNTER("MapPainter.nodesDrawn",nodesDrawn);
+    OSMSCOUT_TRACE_COUNTER("MapPainter.labelsDrawn",labelsDrawn);
+
     if (parameter.IsDebugPerformance()) {
       log.Info()
           << "Paths: "
@@ -30,9 +30,16 @@
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/Geometry.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout {
 
+  /**
+   * Number of objects loaded from a data file at once. Loading can be
+   * aborted between chunks.
+   */
+  static const size_t loadChunkSize=256;
+
   AreaSearchParameter::AreaSearchParameter()
   : maxAreaLevel(4),
     maxNodes(2000),
@@ -119,6 +126,31 @@ namespace osmscout {
     }
   }
 
+  MapLoadCallback::~MapLoadCallback()
+  {
+    // no code
+  }
+
+  void MapLoadCallback::NodesLoaded(const std::vector<NodeRef>& /*nodes*/)
+  {
+    // no code
+  }
+
+  void MapLoadCallback::WaysLoaded(const std::vector<WayRef>& /*ways*/)
+  {
+    // no code
+  }
+
+  void MapLoadCallback::AreasLoaded(const std::vector<AreaRef>& /*areas*/)
+  {
+    // no code
+  }
+
+  void MapLoadCallback::GroundTilesLoaded(const std::list<GroundTile>& /*groundTiles*/)
+  {
+    // no code
+  }
+
   MapService::MapService(const DatabaseRef& database)
    : database(database)
   {
@@ -137,6 +169,8 @@ namespace osmscout {
                                    std::string& nodesTime,
                                    std::vector<NodeRef>& nodes) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetObjectsNodes");
+
     AreaNodeIndexRef areaNodeIndex=database->GetAreaNodeIndex();
 
     if (!areaNodeIndex) {
@@ -180,10 +214,22 @@ namespace osmscout {
 
     StopClock nodesTimer;
 
-    if (!database->GetNodesByOffset(nodeOffsets,
-                                    nodes)) {
-      std::cout << "Error reading nodes in area!" << std::endl;
-      return false;
+    nodes.reserve(nodeOffsets.size());
+
+    for (size_t start=0; start<nodeOffsets.size(); start+=loadChunkSize) {
+      std::vector<FileOffset> chunk(nodeOffsets.begin()+start,
+                                    nodeOffsets.begin()+std::min(start+loadChunkSize,
+                                                                 nodeOffsets.size()));
+
+      if (parameter.IsAborted()) {
+        return false;
+      }
+
+      if (!database->GetNodesByOffset(chunk,
+                                      nodes)) {
+        std::cout << "Error reading nodes in area!" << std::endl;
+        return false;
+      }
     }
 
     nodesTimer.Stop();
@@ -205,6 +251,8 @@ namespace osmscout {
                                    std::string& areasTime,
                                    std::vector<AreaRef>& areas) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetObjectsAreas");
+
     AreaAreaIndexRef        areaAreaIndex=database->GetAreaAreaIndex();
     OptimizeAreasLowZoomRef optimizeAreasLowZoom=database->GetOptimizeAreasLowZoom();
 
@@ -305,8 +353,16 @@ namespace osmscout {
 
     StopClock areasTimer;
 
-    if (!restOffsets.empty()) {
-      if (!database->GetAreasByOffset(restOffsets,
+    for (size_t start=0; start<restOffsets.size(); start+=loadChunkSize) {
+      std::vector<FileOffset> chunk(restOffsets.begin()+start,
+                                    restOffsets.begin()+std::min(start+loadChunkSize,
+                                                                 restOffsets.size()));
+
+      if (parameter.IsAborted()) {
+        return false;
+      }
+
+      if (!database->GetAreasByOffset(chunk,
                                       areas)) {
         std::cout << "Error reading areas in area!" << std::endl;
         return false;
@@ -328,6 +384,8 @@ namespace osmscout {
                                   std::string& waysTime,
                                   std::vector<WayRef>& ways) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetObjectsWays");
+
     AreaWayIndexRef        areaWayIndex=database->GetAreaWayIndex();
     OptimizeWaysLowZoomRef optimizeWaysLowZoom=database->GetOptimizeWaysLowZoom();
 
@@ -423,8 +481,16 @@ namespace osmscout {
 
     StopClock waysTimer;
 
-    if (!restOffsets.empty()) {
-      if (!database->GetWaysByOffset(restOffsets,
+    for (size_t start=0; start<restOffsets.size(); start+=loadChunkSize) {
+      std::vector<FileOffset> chunk(restOffsets.begin()+start,
+                                    restOffsets.begin()+std::min(start+loadChunkSize,
+                                                                 restOffsets.size()));
+
+      if (parameter.IsAborted()) {
+        return false;
+      }
+
+      if (!database->GetWaysByOffset(chunk,
                                      ways)) {
         std::cout << "Error reading ways in area!" << std::endl;
         return false;
@@ -457,6 +523,8 @@ namespace osmscout {
                               const Projection& projection,
                               MapData& data) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetObjects");
+
     osmscout::TypeSet              nodeTypes;
     std::vector<osmscout::TypeSet> wayTypes;
     osmscout::TypeSet              areaTypes;
@@ -526,6 +594,8 @@ namespace osmscout {
                               const GeoBox& areaBoundingBox,
                               std::vector<AreaRef>& areas) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetObjects");
+
     std::string nodeIndexTime;
     std::string nodesTime;
 
@@ -600,6 +670,255 @@ namespace osmscout {
     return true;
   }
 
+#if defined(OSMSCOUT_HAVE_THREAD)
+  bool MapService::LoadNodesAsync(const AreaSearchParameter& parameter,
+                                  const TypeSet& nodeTypes,
+                                  const GeoBox& boundingBox,
+                                  std::vector<NodeRef>& nodes,
+                                  const MapLoadCallbackRef& callback) const
+  {
+    std::string nodeIndexTime;
+    std::string nodesTime;
+
+    if (!GetObjectsNodes(parameter,
+                         nodeTypes,
+                         boundingBox,
+                         nodeIndexTime,
+                         nodesTime,
+                         nodes)) {
+      return false;
+    }
+
+    if (callback) {
+      callback->NodesLoaded(nodes);
+    }
+
+    return true;
+  }
+
+  bool MapService::LoadWaysAsync(const AreaSearchParameter& parameter,
+                                 const std::vector<TypeSet>& wayTypes,
+                                 const Magnification& magnification,
+                                 const GeoBox& boundingBox,
+                                 std::vector<WayRef>& ways,
+                                 const MapLoadCallbackRef& callback) const
+  {
+    std::string wayOptimizedTime;
+    std::string wayIndexTime;
+    std::string waysTime;
+
+    if (!GetObjectsWays(parameter,
+                        wayTypes,
+                        magnification,
+                        boundingBox,
+                        wayOptimizedTime,
+                        wayIndexTime,
+                        waysTime,
+                        ways)) {
+      return false;
+    }
+
+    if (callback) {
+      callback->WaysLoaded(ways);
+    }
+
+    return true;
+  }
+
+  bool MapService::LoadAreasAsync(const AreaSearchParameter& parameter,
+                                  const TypeSet& areaTypes,
+                                  const Magnification& magnification,
+                                  const GeoBox& boundingBox,
+                                  std::vector<AreaRef>& areas,
+                                  const MapLoadCallbackRef& callback) const
+  {
+    std::string areaOptimizedTime;
+    std::string areaIndexTime;
+    std::string areasTime;
+
+    if (!GetObjectsAreas(parameter,
+                         areaTypes,
+                         magnification,
+                         boundingBox,
+                         areaOptimizedTime,
+                         areaIndexTime,
+                         areasTime,
+                         areas)) {
+      return false;
+    }
+
+    if (callback) {
+      callback->AreasLoaded(areas);
+    }
+
+    return true;
+  }
+
+  bool MapService::LoadGroundTilesAsync(const AreaSearchParameter& parameter,
+                                        const Magnification& magnification,
+                                        const GeoBox& boundingBox,
+                                        std::list<GroundTile>& groundTiles,
+                                        const MapLoadCallbackRef& callback) const
+  {
+    groundTiles.clear();
+
+    if (parameter.IsAborted()) {
+      return false;
+    }
+
+    if (!GetGroundTiles(boundingBox,
+                        magnification,
+                        groundTiles)) {
+      return false;
+    }
+
+    if (parameter.IsAborted()) {
+      return false;
+    }
+
+    if (callback) {
+      callback->GroundTilesLoaded(groundTiles);
+    }
+
+    return true;
+  }
+
+  /**
+   * Loads nodes, ways, areas and ground tiles, each in its own thread, and
+   * waits until all of them are finished. The parameters are copies held by
+   * the future returned by GetObjectsAsync(), so they stay valid until all
+   * threads are finished.
+   */
+  bool MapService::LoadObjectsAsync(const AreaSearchParameter& parameter,
+                                    const Magnification& magnification,
+                                    const TypeSet& nodeTypes,
+                                    const std::vector<TypeSet>& wayTypes,
+                                    const TypeSet& areaTypes,
+                                    const GeoBox& boundingBox,
+                                    const MapDataRef& data,
+                                    const MapLoadCallbackRef& callback) const
+  {
+    OSMSCOUT_TRACE_SPAN("map","MapService::LoadObjectsAsync");
+
+    std::future<bool> areasResult=std::async(std::launch::async,
+                                             &MapService::LoadAreasAsync,
+                                             this,
+                                             std::cref(parameter),
+                                             std::cref(areaTypes),
+                                             std::cref(magnification),
+                                             std::cref(boundingBox),
+                                             std::ref(data->areas),
+                                             std::cref(callback));
+    std::future<bool> waysResult=std::async(std::launch::async,
+                                            &MapService::LoadWaysAsync,
+                                            this,
+                                            std::cref(parameter),
+                                            std::cref(wayTypes),
+                                            std::cref(magnification),
+                                            std::cref(boundingBox),
+                                            std::ref(data->ways),
+                                            std::cref(callback));
+    std::future<bool> nodesResult=std::async(std::launch::async,
+                                             &MapService::LoadNodesAsync,
+                                             this,
+                                             std::cref(parameter),
+                                             std::cref(nodeTypes),
+                                             std::cref(boundingBox),
+                                             std::ref(data->nodes),
+                                             std::cref(callback));
+
+    bool groundTilesSuccess=LoadGroundTilesAsync(parameter,
+                                                 magnification,
+                                                 boundingBox,
+                                                 data->groundTiles,
+                                                 callback);
+
+    // Wait for all threads, even in case of errors, since they reference our parameters
+    bool areasSuccess=areasResult.get();
+    bool waysSuccess=waysResult.get();
+    bool nodesSuccess=nodesResult.get();
+
+    if (!nodesSuccess ||
+        !waysSuccess ||
+        !areasSuccess ||
+        !groundTilesSuccess) {
+      data->nodes.clear();
+      data->ways.clear();
+      data->areas.clear();
+      data->groundTiles.clear();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Asynchronously loads all objects conforming to the given restrictions
+   * together with the ground tiles.
+   *
+   * Nodes, ways, areas and ground tiles are loaded concurrently, each in its
+   * own thread. As soon as one of them is loaded, the corresponding method of
+   * the callback gets called, so that clients can start drawing early.
+   * Objects already in data are reused as in GetObjects().
+   *
+   * Loading can be cancelled by the breaker of the parameter (see
+   * ThreadedBreaker). It is checked between the individual lookups and
+   * between loading chunks of objects from the data files.
+   *
+   * The MapService and the Database must stay valid and the Database must
+   * not be used otherwise until the returned future is ready.
+   *
+   * @param parameter
+   *    Further restrictions
+   * @param styleConfig
+   *    Style configuration, defining which types are loaded for the
+   *    magnification defined by the projection
+   * @param projection
+   *    Projection defining the area and the magnification
+   * @param data
+   *    the returned data
+   * @param callback
+   *    optional callback notified about partial results
+   * @return
+   *    A future, returning true, if loading of data was successful else false
+   */
+  std::future<bool> MapService::GetObjectsAsync(const AreaSearchParameter& parameter,
+                                                const StyleConfig& styleConfig,
+                                                const Projection& projection,
+                                                const MapDataRef& data,
+                                                const MapLoadCallbackRef& callback) const
+  {
+    osmscout::TypeSet              nodeTypes;
+    std::vector<osmscout::TypeSet> wayTypes;
+    osmscout::TypeSet              areaTypes;
+    GeoBox                         boundingBox;
+
+    projection.GetDimensions(boundingBox);
+
+    styleConfig.GetNodeTypesWithMaxMag(projection.GetMagnification(),
+                                       nodeTypes);
+
+    styleConfig.GetWayTypesByPrioWithMaxMag(projection.GetMagnification(),
+                                            wayTypes);
+
+    styleConfig.GetAreaTypesWithMaxMag(projection.GetMagnification(),
+                                       areaTypes);
+
+    return std::async(std::launch::async,
+                      &MapService::LoadObjectsAsync,
+                      this,
+                      parameter,
+                      projection.GetMagnification(),
+                      nodeTypes,
+                      wayTypes,
+                      areaTypes,
+                      boundingBox,
+                      data,
+                      callback);
+  }
+#endif
+
   /**
    * Return all ground tiles for the given projection data
    * (bounding box and magnification).
@@ -616,6 +935,8 @@ namespace osmscout {
   bool MapService::GetGroundTiles(const Projection& projection,
                                   std::list<GroundTile>& tiles) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetGroundTiles");
+
     GeoBox boundingBox;
 
     projection.GetDimensions(boundingBox);
@@ -643,6 +964,8 @@ namespace osmscout {
                                   const Magnification& magnification,
                                   std::list<GroundTile>& tiles) const
   {
+    OSMSCOUT_TRACE_SPAN("map","MapService::GetGroundTiles");
+
     WaterIndexRef waterIndex=database->GetWaterIndex();
 
     if (!waterIndex) {
@@ -48,7 +48,7 @@ namespace osmscout {
 
       uint8_t               ring;               //!< The ring hierarchy number (0...n)
       std::vector<Id>       ids;                //!< The array of ids for a coordinate
-      std::vector<GeoCoord> nodes;              //!< The array of coordinates
+      std::vector<CompactGeoCoord> nodes;       //!< The array of coordinates
 
     public:
       inline Ring()
@@ -147,6 +147,8 @@ namespace osmscout {
 
     void GetBoundingBox(GeoBox& boundingBox) const;
 
+    size_t GetMemory() const;
+
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool ReadOptimized(const TypeConfig& typeConfig,
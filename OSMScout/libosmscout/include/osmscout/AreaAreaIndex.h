@@ -20,13 +20,20 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <list>
+#include <map>
 #include <memory>
 #include <vector>
 
+#include <osmscout/AreaAreaRTreeIndex.h>
+#include <osmscout/CacheSnapshot.h>
+#include <osmscout/Pixel.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/GeoBox.h>
 
 namespace osmscout {
 
@@ -43,6 +50,9 @@ namespace osmscout {
 
     Internally the index is implemented as quadtree. As a result each index entry
     has 4 children (besides entries in the lowest level).
+
+    If the database contains an AreaAreaRTreeIndex and its use is enabled, all
+    queries are delegated to it instead and the quadtree is not loaded.
     */
   class OSMSCOUT_API AreaAreaIndex
   {
@@ -61,6 +71,7 @@ namespace osmscout {
       */
     struct IndexCell
     {
+      uint32_t                level;       //!< Level of the cell in the quadtree
       FileOffset              children[4]; //!< File index of each of the four children, or 0 if there is no child
       std::vector<IndexEntry> areas;
     };
@@ -76,7 +87,7 @@ namespace osmscout {
         memory+=sizeof(value);
 
         // Areas
-        memory+=value.areas.size()*sizeof(IndexEntry);
+        memory+=value.areas.capacity()*sizeof(IndexEntry);
 
         return memory;
       }
@@ -109,8 +120,12 @@ namespace osmscout {
     uint32_t                        maxLevel;       //!< Maximum level in index
     FileOffset                      topLevelOffset; //!< File offset of the top level index entry
 
+    IndexCacheValueSizer            indexCacheValueSizer; //!< Memory accounting for the index cache
     mutable IndexCache              indexCache;     //!< Cached map of all index entries by file offset
 
+    bool                            useRTree;       //!< Use the R-tree index, if available
+    AreaAreaRTreeIndexRef           rtree;          //!< The R-tree index, if loaded
+
   private:
     bool GetIndexCell(const TypeConfig& typeConfig,
                       uint32_t level,
@@ -118,11 +133,17 @@ namespace osmscout {
                       IndexCache::CacheRef& cacheRef) const;
 
   public:
-    AreaAreaIndex(size_t cacheSize);
+    AreaAreaIndex(size_t cacheSize,
+                  bool useRTree);
 
     void Close();
     bool Load(const std::string& path);
 
+    inline bool IsRTree() const
+    {
+      return (bool)rtree;
+    }
+
     bool GetOffsets(const TypeConfigRef& typeConfig,
                     double minlon,
                     double minlat,
@@ -133,10 +154,93 @@ namespace osmscout {
                     size_t maxCount,
                     std::vector<FileOffset>& offsets) const;
 
+    void GetCacheSnapshot(CacheSnapshot& snapshot) const;
+    bool PrefetchCacheSnapshot(const TypeConfigRef& typeConfig,
+                               const CacheSnapshot& snapshot) const;
+
+    void RegisterCache(CacheManager& manager) const;
+
     void DumpStatistics();
+
+    static uint32_t GetAreaLevel(const GeoBox& boundingBox,
+                                 uint32_t maxLevel);
   };
 
   typedef std::shared_ptr<AreaAreaIndex> AreaAreaIndexRef;
+
+  /**
+    \ingroup Database
+    Writes the quadtree read by AreaAreaIndex. The quadtree is written bottom
+    up, one level after the other, starting with the maximum level: Add all
+    areas of the current level (see GetLevel() and
+    AreaAreaIndex::GetAreaLevel()), then call WriteLevel(). After level 0 has
+    been written, Close() completes the file.
+    */
+  class OSMSCOUT_API AreaAreaIndexWriter
+  {
+  private:
+    struct Entry
+    {
+      TypeId     type;
+      FileOffset offset;
+    };
+
+    struct Cell
+    {
+      FileOffset       offset;
+      std::list<Entry> areas;
+      FileOffset       children[4];
+
+      Cell()
+      {
+        offset=0;
+        children[0]=0;
+        children[1]=0;
+        children[2]=0;
+        children[3]=0;
+      }
+    };
+
+  private:
+    FileWriter            writer;
+    uint8_t               areaTypeIdBytes;
+    uint32_t              maxLevel;
+    uint32_t              level;                //!< Level of the cells currently collected
+    bool                  complete;             //!< All levels have been written
+    FileOffset            topLevelOffset;       //!< File offset of the cell in level 0
+    FileOffset            topLevelOffsetOffset; //!< File offset of the top level entry offset
+    std::map<Pixel,Cell>  cells;                //!< Cells of the current level
+
+  public:
+    AreaAreaIndexWriter();
+
+    bool Open(const std::string& filename,
+              uint32_t maxLevel,
+              uint8_t areaTypeIdBytes);
+
+    void AddArea(FileOffset offset,
+                 TypeId type,
+                 const GeoBox& boundingBox);
+
+    bool WriteLevel();
+    bool Close();
+
+    /**
+      Returns the level whose areas are added next
+      */
+    inline uint32_t GetLevel() const
+    {
+      return level;
+    }
+
+    /**
+      Returns the number of cells of the current level
+      */
+    inline size_t GetCellCount() const
+    {
+      return cells.size();
+    }
+  };
 }
 
 #endif
@@ -0,0 +1,175 @@
+#ifndef OSMSCOUT_AREAAREARTREEINDEX_H
+#define OSMSCOUT_AREAAREARTREEINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+#include <osmscout/TypeSet.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/GeoBox.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup Database
+
+    AreaAreaRTreeIndex is an alternative to the quadtree of AreaAreaIndex.
+    It is a packed Hilbert R-tree over the bounding boxes of all areas,
+    built bottom up during import.
+
+    The file consists of pages of PAGE_SIZE bytes. The first page holds the
+    file header, every other page exactly one node of the tree. A node
+    consists of a node header followed by up to NODE_CAPACITY entries of
+    ENTRY_SIZE bytes. All values are stored little endian with a fixed size,
+    so nodes are accessed directly in the memory mapped file without any
+    deserialization.
+
+    The file header holds the page size, the page of the root node, the
+    height of the tree and the maximum area level (all uint32). The node
+    header holds the number of entries (uint32) and a leaf flag (uint8).
+
+    Every entry starts with its bounding box in fixed point coordinates
+    (see GetFixedLon() and GetFixedLat()) as minimum lon, minimum lat, maximum
+    lon and maximum lat (uint32).
+
+    Leaf entries then hold the file offset of the area (uint64), its area type
+    id (uint16) and its level (uint8). The level is the deepest level of the
+    quadtree of AreaAreaIndex into whose cells the bounding box of the area
+    fits, so the maxLevel parameter of GetOffsets() has the same meaning for
+    both indexes.
+
+    Inner entries then hold a mask of the area types below (uint64, bit
+    typeId%64), the page of the child node (uint32) and the minimum level of
+    all areas below (uint8). Subtrees that only contain too small areas or no
+    area of a requested type are thus skipped without being read.
+
+    Areas are sorted by their level and then by the Hilbert value of the
+    center of their bounding box, so each leaf holds areas of similar size
+    near to each other.
+    */
+  class OSMSCOUT_API AreaAreaRTreeIndex
+  {
+  public:
+    static const char* const FILENAME_AREAAREA_RTREE;
+
+    static const size_t PAGE_SIZE=4096;       //!< Size of a node in bytes, nodes are aligned to pages
+    static const size_t NODE_HEADER_SIZE=32;  //!< Size of the node header in bytes
+    static const size_t ENTRY_SIZE=32;        //!< Size of a node entry in bytes
+    static const size_t NODE_CAPACITY=(PAGE_SIZE-NODE_HEADER_SIZE)/ENTRY_SIZE; //!< Maximum number of entries per node
+
+    static const uint32_t FIXED_POINT_FACTOR=10000000; //!< Fixed point coordinates per degree
+
+  private:
+    std::string         datafilename;   //!< Full path and name of the data file
+    mutable FileScanner scanner;        //!< Scanner instance for reading this file
+
+    uint32_t            rootPage;       //!< Page of the root node, 0 for an empty index
+    uint32_t            height;         //!< Number of levels of the tree
+    uint32_t            maxLevel;       //!< Maximum area level in index
+    uint32_t            pageCount;      //!< Number of pages in the file
+
+  private:
+    bool GetNode(uint32_t page,
+                 std::vector<char>& buffer,
+                 const unsigned char*& node) const;
+
+  public:
+    AreaAreaRTreeIndex();
+
+    void Close();
+    bool Load(const std::string& path);
+
+    bool GetOffsets(const TypeConfigRef& typeConfig,
+                    double minlon,
+                    double minlat,
+                    double maxlon,
+                    double maxlat,
+                    size_t maxLevel,
+                    const TypeSet& types,
+                    size_t maxCount,
+                    std::vector<FileOffset>& offsets) const;
+
+    static uint32_t GetFixedLon(double lon,
+                                bool roundUp);
+    static uint32_t GetFixedLat(double lat,
+                                bool roundUp);
+  };
+
+  typedef std::shared_ptr<AreaAreaRTreeIndex> AreaAreaRTreeIndexRef;
+
+  /**
+    \ingroup Database
+    Writes the packed Hilbert R-tree read by AreaAreaRTreeIndex. All areas are
+    collected in memory and sorted, the tree is written on Write().
+    */
+  class OSMSCOUT_API AreaAreaRTreeIndexWriter
+  {
+  private:
+    struct Entry
+    {
+      uint32_t   minLon;
+      uint32_t   minLat;
+      uint32_t   maxLon;
+      uint32_t   maxLat;
+      uint64_t   value;    //!< File offset of the area (leaf) or type mask of the child (inner node)
+      uint32_t   page;     //!< Page of the child node (inner node)
+      TypeId     type;     //!< Area type id (leaf)
+      uint8_t    level;    //!< Level of the area (leaf) or minimum level of the child (inner node)
+      uint64_t   hilbert;  //!< Hilbert value of the center of the bounding box
+    };
+
+  private:
+    uint32_t           maxLevel;   //!< Maximum area level
+    uint32_t           height;     //!< Number of levels of the written tree
+    std::vector<Entry> entries;
+
+  private:
+    bool WriteNodes(FileWriter& writer,
+                    bool isLeaf,
+                    const std::vector<Entry>& levelEntries,
+                    uint32_t& nextPage,
+                    std::vector<Entry>& parents);
+
+  public:
+    AreaAreaRTreeIndexWriter(uint32_t maxLevel);
+
+    void Reserve(size_t areaCount);
+    void AddArea(FileOffset offset,
+                 TypeId type,
+                 const GeoBox& boundingBox);
+
+    bool Write(const std::string& filename);
+
+    /**
+      Returns the number of levels of the written tree
+      */
+    inline uint32_t GetHeight() const
+    {
+      return height;
+    }
+  };
+}
+
+#endif
@@ -26,6 +26,12 @@
 #include <osmscout/DataFile.h>
 
 namespace osmscout {
+
+  inline unsigned long GetDataMemory(const Area& area)
+  {
+    return (unsigned long)area.GetMemory();
+  }
+
   /**
     \ingroup Database
     Abstraction for getting cached access to the 'ways.dat' file.
@@ -23,6 +23,7 @@
 #include <memory>
 #include <vector>
 
+#include <osmscout/CellDirectory.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/FileScanner.h>
@@ -45,7 +46,6 @@ namespace osmscout {
       uint32_t   indexLevel;
 
       FileOffset indexOffset;
-      uint8_t    dataOffsetBytes;
 
       uint32_t   cellXStart;
       uint32_t   cellXEnd;
@@ -62,26 +62,26 @@ namespace osmscout {
       double     minLat;
       double     maxLat;
 
+      bool          directoryLoaded; //!< The cell directory has been loaded
+      CellDirectory directory;       //!< The non empty cells
+
       TypeData();
     };
 
   private:
-    std::string           filepart;       //!< name of the data file
-    std::string           datafilename;   //!< Full path and name of the data file
-    mutable FileScanner   scanner;        //!< Scanner instance for reading this file
+    std::string                   filepart;       //!< name of the data file
+    std::string                   datafilename;   //!< Full path and name of the data file
+    mutable FileScanner           scanner;        //!< Scanner instance for reading this file
 
-    std::vector<TypeData> nodeTypeData;
+    mutable std::vector<TypeData> nodeTypeData;   //!< Index data per type, cell directories are loaded on demand
 
   private:
-    bool GetOffsets(const TypeData& typeData,
+    bool GetOffsets(TypeData& typeData,
                     double minlon,
                     double minlat,
                     double maxlon,
                     double maxlat,
-                    size_t maxNodeCount,
-                    std::vector<FileOffset>& offsets,
-                    size_t currentSize,
-                    bool& sizeExceeded) const;
+                    std::vector<FileOffset>& offsets) const;
 
   public:
     AreaNodeIndex();
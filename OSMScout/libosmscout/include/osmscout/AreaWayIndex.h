@@ -21,9 +21,9 @@
 */
 
 #include <memory>
-#include <unordered_set>
 #include <vector>
 
+#include <osmscout/CellDirectory.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/FileScanner.h>
@@ -36,6 +36,10 @@ namespace osmscout {
     a given area.
 
     Ways can be limited by type and result count.
+
+    For each type the index holds a CellDirectory of the non empty cells
+    of a grid of the level of the type. The cell directory of a type is
+    loaded on its first use.
     */
   class OSMSCOUT_API AreaWayIndex
   {
@@ -44,8 +48,7 @@ namespace osmscout {
     {
       uint32_t   indexLevel;
 
-      uint8_t    dataOffsetBytes;
-      FileOffset bitmapOffset;
+      FileOffset directoryOffset;
 
       uint32_t   cellXStart;
       uint32_t   cellXEnd;
@@ -62,27 +65,26 @@ namespace osmscout {
       double     minLat;
       double     maxLat;
 
+      bool          directoryLoaded; //!< The cell directory has been loaded
+      CellDirectory directory;       //!< The non empty cells
 
       TypeData();
     };
 
   private:
-    std::string           filepart;       //!< name of the data file
-    std::string           datafilename;   //!< Full path and name of the data file
-    mutable FileScanner   scanner;        //!< Scanner instance for reading this file
+    std::string                   filepart;       //!< name of the data file
+    std::string                   datafilename;   //!< Full path and name of the data file
+    mutable FileScanner           scanner;        //!< Scanner instance for reading this file
 
-    std::vector<TypeData> wayTypeData;
+    mutable std::vector<TypeData> wayTypeData;    //!< Index data per type, cell directories are loaded on demand
 
   private:
-    bool GetOffsets(const TypeData& typeData,
+    bool GetOffsets(TypeData& typeData,
                     double minlon,
                     double minlat,
                     double maxlon,
                     double maxlat,
-                    size_t maxWayCount,
-                    std::unordered_set<FileOffset>& offsets,
-                    size_t currentSize,
-                    bool& sizeExceeded) const;
+                    std::vector<FileOffset>& offsets) const;
 
   public:
     AreaWayIndex();
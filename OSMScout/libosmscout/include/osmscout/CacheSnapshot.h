@@ -0,0 +1,100 @@
+#ifndef OSMSCOUT_CACHESNAPSHOT_H
+#define OSMSCOUT_CACHESNAPSHOT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   *
+   * Snapshot of the keys of the entries in the caches of data files and
+   * indexes. The snapshot gets written to a sidecar file, so that the caches
+   * can be filled again ("warm start") after the database has been reopened.
+   *
+   * The snapshot consists of sections, one per cache. Each section holds the
+   * name of the file the cache belongs to, the size of this file at the time
+   * the snapshot was taken (to detect outdated snapshots after an import),
+   * an optional level (for caches holding entries of different levels of a
+   * hierarchical index) and the cache keys, the most recently used key
+   * first. For data files and indexes the keys are file offsets.
+   */
+  class OSMSCOUT_API CacheSnapshot
+  {
+  public:
+    struct OSMSCOUT_API Section
+    {
+      std::string           file;     //!< Name of the file without directory
+      FileOffset            fileSize; //!< Size of the file at the time of the snapshot
+      uint32_t              level;    //!< Level of the cache, 0 if the cache has no levels
+      std::vector<uint64_t> keys;     //!< Cache keys, most recently used first
+    };
+
+  private:
+    std::list<Section> sections;
+
+  public:
+    void Clear();
+
+    void AddSection(const std::string& file,
+                    FileOffset fileSize,
+                    uint32_t level,
+                    const std::vector<uint64_t>& keys);
+
+    void CopySections(const CacheSnapshot& other,
+                      const std::string& file);
+
+    const Section* GetSection(const std::string& file,
+                              uint32_t level) const;
+
+    inline bool IsEmpty() const
+    {
+      return sections.empty();
+    }
+
+    inline const std::list<Section>& GetSections() const
+    {
+      return sections;
+    }
+
+    static bool IsValid(const Section& section,
+                        const std::string& filename);
+
+    bool Read(const std::string& filename);
+    bool Write(const std::string& filename) const;
+
+    static void GetPrefetchKeys(const Section& section,
+                                size_t maxCount,
+                                std::vector<uint64_t>& keys);
+  };
+
+  typedef std::shared_ptr<CacheSnapshot> CacheSnapshotRef;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef OSMSCOUT_CELLDIRECTORY_H
+#define OSMSCOUT_CELLDIRECTORY_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Pixel.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   *
+   * Directory of the non empty cells of the cell grid of one type in
+   * AreaNodeIndex and AreaWayIndex.
+   *
+   * For each non empty cell the index holds a posting list (see
+   * EncodePostingList()) of the file offsets of the objects in the cell. The
+   * posting lists are stored one after another ordered by the position of their
+   * cell on the Hilbert curve, so that neighbouring cells are mostly also
+   * neighbours in the file. The directory follows the posting lists and
+   * stores the number of cells, the offset of the first posting list and
+   * for each cell (in the same order) its position relative to the start of the
+   * grid and the size of its posting list.
+   */
+  class OSMSCOUT_API CellDirectory
+  {
+  public:
+    typedef std::map<Pixel,std::list<FileOffset> > CellOffsetsMap;
+
+  private:
+    struct Cell
+    {
+      uint32_t   x;
+      uint32_t   y;
+      FileOffset offset; //!< Offset of the posting list of the cell
+      uint32_t   size;   //!< Size of the posting list of the cell in bytes
+
+      inline bool operator<(const Cell& other) const
+      {
+        return y<other.y ||
+               (y==other.y && x<other.x);
+      }
+    };
+
+  private:
+    std::vector<Cell> cells; //!< The non empty cells, sorted by row and column
+
+  private:
+    void GetCells(uint32_t minxc,
+                  uint32_t maxxc,
+                  uint32_t minyc,
+                  uint32_t maxyc,
+                  std::vector<const Cell*>& result) const;
+
+  public:
+    inline size_t GetCellCount() const
+    {
+      return cells.size();
+    }
+
+    bool Read(FileScanner& scanner,
+              FileOffset directoryOffset,
+              uint32_t cellXStart,
+              uint32_t cellYStart);
+
+    bool GetOffsets(FileScanner& scanner,
+                    uint32_t minxc,
+                    uint32_t maxxc,
+                    uint32_t minyc,
+                    uint32_t maxyc,
+                    std::vector<FileOffset>& offsets) const;
+
+    static bool Write(FileWriter& writer,
+                      uint32_t level,
+                      uint32_t cellXStart,
+                      uint32_t cellYStart,
+                      const CellOffsetsMap& cellOffsets,
+                      FileOffset& directoryOffset);
+  };
+}
+
+#endif
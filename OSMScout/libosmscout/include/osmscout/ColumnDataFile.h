@@ -0,0 +1,277 @@
+#ifndef OSMSCOUT_COLUMNDATAFILE_H
+#define OSMSCOUT_COLUMNDATAFILE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/TypeSet.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/GeoBox.h>
+
+namespace osmscout {
+
+  class Area;
+  class Node;
+  class Way;
+
+  /**
+    \ingroup Database
+
+    Columnar copy of the nodes, ways or areas of one of the data files
+    (nodes.dat, ways.dat, areas.dat), written during import by the sort steps
+    if enabled.
+
+    Objects are stored in blocks of consecutive objects. Since the data files
+    are sorted by tile cell, the objects of a block are near to each other.
+    Within a block each property of the objects is stored in its own column,
+    so a reader only reads and decodes the columns it actually needs.
+
+    An object consists of one or more parts. Nodes and ways have exactly one
+    part, areas have one part per ring. Columns are either per object or per
+    part:
+
+    * columnOffset: File offset of the object in the data file, as delta to
+      the offset of the previous object (per object)
+    * columnPart: Number of rings per object followed by the ring level per
+      part (areas only, else empty)
+    * columnType: Node, way or area type id (per part)
+    * columnFeatureMask: Feature bit mask with the number of bytes given by
+      the type (per part)
+    * columnFeatureValue: Values of all set features with a value (per part)
+    * columnCoord: Number of coordinates followed by the coordinates, each
+      latitude and longitude as signed delta to the previous coordinate of the
+      block, in the fixed point resolution of GeoCoord (per part)
+    * columnId: Number of node ids followed by the node ids, 0 for no id,
+      else the signed delta to the previous id of the block, increased by one
+      if not negative (per part, empty for nodes)
+
+    The file starts with the number of objects, the number of blocks (uint32),
+    the type of objects (uint8, see RefType) and the offset of the block
+    directory (FileOffset). For each block the block directory holds the
+    number of objects and parts (uint32), the bounding box of the block
+    in fixed point coordinates (uint32 minimum lat, minimum lon, maximum lat,
+    maximum lon) and the start of each column plus the end of the block
+    (FileOffset).
+    */
+  class OSMSCOUT_API ColumnDataFile
+  {
+  public:
+    static const char* const FILENAME_NODES_COL;
+    static const char* const FILENAME_WAYS_COL;
+    static const char* const FILENAME_AREAS_COL;
+
+    enum Column
+    {
+      columnOffset       = 0,
+      columnPart         = 1,
+      columnType         = 2,
+      columnFeatureMask  = 3,
+      columnFeatureValue = 4,
+      columnCoord        = 5,
+      columnId           = 6,
+      columnCount        = 7
+    };
+
+    /**
+      Directory entry of one block
+      */
+    struct Block
+    {
+      uint32_t   objectCount;               //!< Number of objects in the block
+      uint32_t   partCount;                 //!< Number of parts of all objects in the block
+      GeoBox     boundingBox;               //!< Bounding box of all coordinates of the block
+      FileOffset columns[columnCount+1];    //!< Start of each column, followed by the end of the block
+    };
+
+  private:
+    TypeConfigRef       typeConfig;
+    std::string         datafilename;
+    mutable FileScanner scanner;
+    RefType             objectType;
+    uint32_t            objectCount;
+    std::vector<Block>  blocks;
+
+  private:
+    bool GotoColumn(size_t block,
+                    Column column) const;
+    TypeInfoRef GetTypeInfo(TypeId id) const;
+    bool ReadTypeIds(size_t block,
+                     std::vector<TypeId>& typeIds) const;
+
+  public:
+    ColumnDataFile();
+    virtual ~ColumnDataFile();
+
+    bool Open(const TypeConfigRef& typeConfig,
+              const std::string& path,
+              const std::string& filename,
+              bool memoryMaped);
+    bool Close();
+
+    inline bool IsOpen() const
+    {
+      return scanner.IsOpen();
+    }
+
+    inline std::string GetFilename() const
+    {
+      return datafilename;
+    }
+
+    inline RefType GetObjectType() const
+    {
+      return objectType;
+    }
+
+    inline uint32_t GetObjectCount() const
+    {
+      return objectCount;
+    }
+
+    inline size_t GetBlockCount() const
+    {
+      return blocks.size();
+    }
+
+    inline const Block& GetBlock(size_t block) const
+    {
+      return blocks[block];
+    }
+
+    inline FileOffset GetColumnSize(size_t block,
+                                    Column column) const
+    {
+      return blocks[block].columns[column+1]-blocks[block].columns[column];
+    }
+
+    void GetBlocks(const GeoBox& boundingBox,
+                   std::vector<size_t>& blocks) const;
+
+    bool GetOffsets(const GeoBox& boundingBox,
+                    const TypeSet& types,
+                    std::vector<FileOffset>& offsets) const;
+
+    bool ReadOffsets(size_t block,
+                     std::vector<FileOffset>& offsets) const;
+    bool ReadParts(size_t block,
+                   std::vector<uint32_t>& partCounts,
+                   std::vector<uint8_t>& rings) const;
+    bool ReadTypes(size_t block,
+                   std::vector<TypeInfoRef>& types) const;
+    bool ReadFeatureMasks(size_t block,
+                          std::vector<uint8_t>& masks) const;
+    bool ReadFeatures(size_t block,
+                      const std::vector<TypeInfoRef>& types,
+                      std::vector<FeatureValueBuffer>& features) const;
+    bool ReadCoords(size_t block,
+                    std::vector<std::vector<CompactGeoCoord> >& coords) const;
+    bool ReadIds(size_t block,
+                 std::vector<std::vector<Id> >& ids) const;
+
+    static uint32_t GetFixedLat(double lat);
+    static uint32_t GetFixedLon(double lon);
+    static double GetLat(uint32_t lat);
+    static double GetLon(uint32_t lon);
+  };
+
+  typedef std::shared_ptr<ColumnDataFile> ColumnDataFileRef;
+
+  /**
+   * Writes the columnar data file read by ColumnDataFile. Objects are
+   * collected until a block is complete, then the block is written column
+   * by column.
+   */
+  class OSMSCOUT_API ColumnDataWriter
+  {
+  public:
+    static const size_t BLOCK_OBJECT_COUNT=1024; //!< Number of objects per block
+
+  private:
+    struct Part
+    {
+      TypeId                       typeId;
+      FeatureValueBuffer           features;
+      uint8_t                      ring;
+      std::vector<CompactGeoCoord> nodes;
+      std::vector<Id>              ids;
+    };
+
+    struct BlockEntry
+    {
+      uint32_t   objectCount;
+      uint32_t   partCount;
+      uint32_t   minLat;
+      uint32_t   minLon;
+      uint32_t   maxLat;
+      uint32_t   maxLon;
+      FileOffset columns[ColumnDataFile::columnCount+1];
+    };
+
+  private:
+    FileWriter              writer;
+    RefType                 objectType;
+    uint32_t                objectCount;
+    std::vector<BlockEntry> blocks;
+    std::vector<FileOffset> offsets;
+    std::vector<uint32_t>   partCounts;
+    std::vector<Part>       parts;
+
+  private:
+    Part& AddPart(const FeatureValueBuffer& features,
+                  TypeId typeId);
+    bool AddObject(FileOffset offset,
+                   size_t partCount);
+    bool WriteBlock();
+
+  public:
+    ColumnDataWriter();
+
+    bool Open(const std::string& filename,
+              RefType objectType);
+    bool Close();
+
+    inline std::string GetFilename() const
+    {
+      return writer.GetFilename();
+    }
+
+    inline uint32_t GetObjectCount() const
+    {
+      return objectCount;
+    }
+
+    bool Add(FileOffset offset,
+             const Node& node);
+    bool Add(FileOffset offset,
+             const Way& way);
+    bool Add(FileOffset offset,
+             const Area& area);
+  };
+}
+
+#endif
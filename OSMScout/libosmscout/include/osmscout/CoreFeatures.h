@@ -53,9 +53,18 @@
 /* system header <thread> is available */
 #define OSMSCOUT_HAVE_THREAD 1
 
+/* standard library has support for mutex */
+#define OSMSCOUT_HAVE_MUTEX 1
+
+/* tracing of spans and counters is enabled */
+/* #undef OSMSCOUT_HAVE_TRACING */
+
 /* libmarisa is available */
 /* #undef OSMSCOUT_HAVE_LIB_MARISA */
 
+/* zlib is available */
+/* #undef OSMSCOUT_HAVE_LIB_ZLIB */
+
 /* long long is available */
 #define OSMSCOUT_HAVE_LONG_LONG 1
 
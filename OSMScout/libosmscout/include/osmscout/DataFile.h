@@ -20,17 +20,34 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <set>
 #include <unordered_map>
 #include <vector>
 
+#include <osmscout/CacheSnapshot.h>
 #include <osmscout/NumericIndex.h>
 
 #include <osmscout/util/Cache.h>
+#include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout {
 
+  /**
+   * \ingroup Database
+   *
+   * Returns the memory (in bytes) used by a data object for the memory
+   * accounting of the DataFile cache. Data classes allocating additional memory
+   * provide an overload next to the definition of their data file.
+   */
+  template <class N>
+  inline unsigned long GetDataMemory(const N& data)
+  {
+    return sizeof(data);
+  }
+
   /**
    * \ingroup Database
    *
@@ -51,7 +68,13 @@ namespace osmscout {
     {
       unsigned long GetSize(const ValueType& value) const
       {
-        return sizeof(value);
+        unsigned long memory=sizeof(value);
+
+        if (value) {
+          memory+=GetDataMemory(*value);
+        }
+
+        return memory;
       }
     };
 
@@ -60,6 +83,7 @@ namespace osmscout {
     std::string         datafilename;    //!< complete filename for data file
     FileScanner::Mode   modeData;        //!< Type of file access
     bool                memoryMapedData; //!< Use memory mapped files for data access
+    DataCacheValueSizer cacheValueSizer; //!< Memory accounting for the entry cache
     mutable DataCache   cache;           //!< Entry cache
     mutable FileScanner scanner;         //!< File stream to the data file
 
@@ -72,6 +96,12 @@ namespace osmscout {
                   FileScanner& scanner,
                   N& data) const;
 
+    template<typename IteratorIn>
+    bool GetByOffsetBatched(IteratorIn begin,
+                            IteratorIn end,
+                            size_t size,
+                            std::vector<ValueType>& data) const;
+
   public:
     DataFile(const std::string& datafile,
                  unsigned long dataCacheSize);
@@ -99,6 +129,12 @@ namespace osmscout {
                      ValueType& entry) const;
 
     void FlushCache();
+
+    void GetCacheSnapshot(CacheSnapshot& snapshot) const;
+    bool PrefetchCacheSnapshot(const CacheSnapshot& snapshot) const;
+
+    void RegisterCache(CacheManager& manager) const;
+
     void DumpStatistics() const;
   };
 
@@ -112,7 +148,7 @@ namespace osmscout {
     isOpen(false)
 
   {
-    // no code
+    cache.SetValueSizer(&cacheValueSizer);
   }
 
   template <class N>
@@ -175,12 +211,168 @@ namespace osmscout {
     return success;
   }
 
+  /**
+   * Loads the objects at the given offsets, if the data file is not memory mapped.
+   *
+   * Offsets of objects not already in the cache are sorted and coalesced into
+   * ranges of neighbouring objects. Each range is read by one positional read
+   * (in parallel, if OpenMP is available) and the objects are decoded from the
+   * returned buffers. An object ends at or before the start of the next object,
+   * so all objects of a range but the last one are guaranteed to be completely
+   * contained in the buffer. The buffer is extended by a small tail for the last
+   * object. The last object is decoded from the buffer, too, and only read again
+   * the normal way, if decoding runs past the end of the buffer.
+   */
+  template <class N>
+  template<typename IteratorIn>
+  bool DataFile<N>::GetByOffsetBatched(IteratorIn begin,
+                                       IteratorIn end,
+                                       size_t size,
+                                       std::vector<ValueType>& data) const
+  {
+    // Maximum gap between two objects to be read as part of the same range
+    const FileOffset maxGap=16*1024;
+    // Maximum size of a range
+    const FileOffset maxRangeSize=1024*1024;
+    // Bytes read after the start of the last object of a range
+    const FileOffset tailSize=4*1024;
+
+    struct ReadRange
+    {
+      FileOffset        start;
+      FileOffset        end;
+      size_t            first;
+      size_t            last;
+      std::vector<char> buffer;
+      bool              success;
+    };
+
+    std::unordered_map<FileOffset,ValueType> values;
+    std::vector<FileOffset>                  offsets;
+    std::vector<ReadRange>                   ranges;
+    typename DataCache::CacheRef             cacheRef;
+    FileOffset                               fileSize=scanner.GetSize();
+
+    values.reserve(size);
+    offsets.reserve(size);
+
+    for (IteratorIn offset=begin;
+         offset!=end;
+         ++offset) {
+      if (cache.GetEntry(*offset,cacheRef)) {
+        values[*offset]=cacheRef->value;
+      }
+      else {
+        offsets.push_back(*offset);
+      }
+    }
+
+    std::sort(offsets.begin(),
+              offsets.end());
+    offsets.erase(std::unique(offsets.begin(),
+                              offsets.end()),
+                  offsets.end());
+
+    for (size_t i=0; i<offsets.size(); i++) {
+      if (ranges.empty() ||
+          offsets[i]-offsets[ranges.back().last]>maxGap ||
+          offsets[i]+tailSize-ranges.back().start>maxRangeSize) {
+        ReadRange range;
+
+        range.start=offsets[i];
+        range.end=offsets[i];
+        range.first=i;
+        range.last=i;
+        range.success=false;
+
+        ranges.push_back(range);
+      }
+
+      ranges.back().last=i;
+    }
+
+    for (auto& range : ranges) {
+      range.end=std::min(offsets[range.last]+tailSize,
+                         fileSize);
+    }
+
+    OSMSCOUT_TRACE_COUNTER("DataFile.batchedReads",ranges.size());
+
+#pragma omp parallel for schedule(dynamic) if(ranges.size()>1)
+    for (int r=0; r<(int)ranges.size(); r++) {
+      ReadRange& range=ranges[r];
+
+      range.buffer.resize((size_t)(range.end-range.start));
+      range.success=scanner.ReadAt(range.start,
+                                   range.buffer.data(),
+                                   range.buffer.size());
+    }
+
+    for (auto& range : ranges) {
+      if (range.success) {
+        scanner.SetWindow(range.start,
+                          range.buffer.data(),
+                          range.buffer.size());
+      }
+
+      for (size_t i=range.first; i<=range.last; i++) {
+        ValueType value=new N();
+
+        if (!range.success ||
+            !scanner.SetPos(offsets[i]) ||
+            !ReadData(*typeConfig,
+                      scanner,
+                      *value)) {
+          // Failed reads and the last object of a range running past the end of
+          // the buffer are read from the file
+          scanner.ClearWindow();
+          OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
+
+          value=new N();
+
+          scanner.SetPos(offsets[i]);
+
+          if (!ReadData(*typeConfig,
+                        scanner,
+                        *value)) {
+            std::cerr << "Error while reading data from offset " << offsets[i] << " of file " << datafilename << "!" << std::endl;
+            scanner.Close();
+            return false;
+          }
+        }
+
+        values[offsets[i]]=value;
+
+        if (cache.IsActive()) {
+          typename DataCache::CacheEntry cacheEntry(offsets[i],value);
+
+          cache.SetEntry(cacheEntry);
+        }
+      }
+
+      scanner.ClearWindow();
+    }
+
+    data.reserve(data.size()+size);
+
+    for (IteratorIn offset=begin;
+         offset!=end;
+         ++offset) {
+      data.push_back(values[*offset]);
+    }
+
+    return true;
+  }
+
   template <class N>
   bool DataFile<N>::GetByOffset(const std::vector<FileOffset>& offsets,
                                 std::vector<ValueType>& data) const
   {
     assert(isOpen);
 
+    OSMSCOUT_TRACE_SPAN("database","DataFile::GetByOffset");
+    OSMSCOUT_TRACE_COUNTER("DataFile.objects",offsets.size());
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
         std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
@@ -188,6 +380,14 @@ namespace osmscout {
       }
     }
 
+    if (offsets.size()>1 &&
+        scanner.CanReadAt()) {
+      return GetByOffsetBatched(offsets.begin(),
+                                offsets.end(),
+                                offsets.size(),
+                                data);
+    }
+
     data.reserve(data.size()+offsets.size());
 
     if (!cache.IsActive()) {
@@ -196,6 +396,7 @@ namespace osmscout {
            ++offset) {
         N *value=new N();
 
+        OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
         scanner.SetPos(*offset);
 
         if (!ReadData(*typeConfig,
@@ -221,6 +422,7 @@ namespace osmscout {
 
           cacheRef=cache.SetEntry(cacheEntry);
 
+          OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
           scanner.SetPos(*offset);
           cacheRef->value=new N();
 
@@ -232,6 +434,8 @@ namespace osmscout {
             scanner.Close();
             return false;
           }
+
+          cache.UpdateMemory(cacheRef);
         }
 
         data.push_back(cacheRef->value);
@@ -247,6 +451,9 @@ namespace osmscout {
   {
     assert(isOpen);
 
+    OSMSCOUT_TRACE_SPAN("database","DataFile::GetByOffset");
+    OSMSCOUT_TRACE_COUNTER("DataFile.objects",offsets.size());
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
         std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
@@ -254,6 +461,14 @@ namespace osmscout {
       }
     }
 
+    if (offsets.size()>1 &&
+        scanner.CanReadAt()) {
+      return GetByOffsetBatched(offsets.begin(),
+                                offsets.end(),
+                                offsets.size(),
+                                data);
+    }
+
     data.reserve(data.size()+offsets.size());
 
     if (!cache.IsActive()) {
@@ -262,6 +477,7 @@ namespace osmscout {
            ++offset) {
         N *value=new N();
 
+        OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
         scanner.SetPos(*offset);
 
         if (!ReadData(*typeConfig,
@@ -287,6 +503,7 @@ namespace osmscout {
 
           cacheRef=cache.SetEntry(cacheEntry);
 
+          OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
           scanner.SetPos(*offset);
           cacheRef->value=new N();
 
@@ -298,6 +515,8 @@ namespace osmscout {
             scanner.Close();
             return false;
           }
+
+          cache.UpdateMemory(cacheRef);
         }
 
         data.push_back(cacheRef->value);
@@ -313,6 +532,9 @@ namespace osmscout {
   {
     assert(isOpen);
 
+    OSMSCOUT_TRACE_SPAN("database","DataFile::GetByOffset");
+    OSMSCOUT_TRACE_COUNTER("DataFile.objects",offsets.size());
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
         std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
@@ -320,6 +542,14 @@ namespace osmscout {
       }
     }
 
+    if (offsets.size()>1 &&
+        scanner.CanReadAt()) {
+      return GetByOffsetBatched(offsets.begin(),
+                                offsets.end(),
+                                offsets.size(),
+                                data);
+    }
+
     data.reserve(data.size()+offsets.size());
 
     if (!cache.IsActive()) {
@@ -328,6 +558,7 @@ namespace osmscout {
            ++offset) {
         N *value=new N();
 
+        OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
         scanner.SetPos(*offset);
 
         if (!ReadData(*typeConfig,
@@ -353,6 +584,7 @@ namespace osmscout {
 
           cacheRef=cache.SetEntry(cacheEntry);
 
+          OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
           scanner.SetPos(*offset);
           cacheRef->value=new N();
 
@@ -364,6 +596,8 @@ namespace osmscout {
             scanner.Close();
             return false;
           }
+
+          cache.UpdateMemory(cacheRef);
         }
 
         data.push_back(cacheRef->value);
@@ -398,6 +632,9 @@ namespace osmscout {
   {
     assert(isOpen);
 
+    OSMSCOUT_TRACE_SPAN("database","DataFile::GetByOffset");
+    OSMSCOUT_TRACE_COUNTER("DataFile.objects",1);
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
         std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
@@ -408,6 +645,7 @@ namespace osmscout {
     if (!cache.IsActive()) {
       N *value=new N();
 
+      OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
       scanner.SetPos(offset);
 
       if (!ReadData(*typeConfig,
@@ -429,6 +667,7 @@ namespace osmscout {
 
         cacheRef=cache.SetEntry(cacheEntry);
 
+        OSMSCOUT_TRACE_COUNTER("DataFile.reads",1);
         scanner.SetPos(offset);
         cacheRef->value=new N();
 
@@ -440,6 +679,8 @@ namespace osmscout {
           scanner.Close();
           return false;
         }
+
+        cache.UpdateMemory(cacheRef);
       }
 
       entry=cacheRef->value;
@@ -454,6 +695,78 @@ namespace osmscout {
     cache.Flush();
   }
 
+  /**
+   * Adds the offsets of all objects currently in the cache to the given
+   * snapshot.
+   */
+  template <class N>
+  void DataFile<N>::GetCacheSnapshot(CacheSnapshot& snapshot) const
+  {
+    FileOffset              fileSize;
+    std::vector<FileOffset> offsets;
+
+    if (!isOpen ||
+        !cache.IsActive() ||
+        !GetFileSize(datafilename,
+                     fileSize)) {
+      return;
+    }
+
+    cache.GetKeys(offsets);
+
+    snapshot.AddSection(datafile,
+                        fileSize,
+                        0,
+                        std::vector<uint64_t>(offsets.begin(),
+                                              offsets.end()));
+  }
+
+  /**
+   * Loads the objects referenced by the given snapshot into the cache. Objects
+   * are loaded in the order of their file offsets. If the snapshot does
+   * not contain data for this file or the file has changed since the snapshot
+   * has been taken, nothing is loaded.
+   */
+  template <class N>
+  bool DataFile<N>::PrefetchCacheSnapshot(const CacheSnapshot& snapshot) const
+  {
+    if (!isOpen ||
+        !cache.IsActive()) {
+      return true;
+    }
+
+    const CacheSnapshot::Section* section=snapshot.GetSection(datafile,
+                                                              0);
+
+    if (section==NULL ||
+        !CacheSnapshot::IsValid(*section,
+                                datafilename)) {
+      return true;
+    }
+
+    std::vector<uint64_t>   keys;
+    std::vector<ValueType>  data;
+
+    CacheSnapshot::GetPrefetchKeys(*section,
+                                   cache.GetMaxSize(),
+                                   keys);
+
+    return GetByOffset(std::vector<FileOffset>(keys.begin(),
+                                               keys.end()),
+                       data);
+  }
+
+  /**
+   * Registers the entry cache at the given manager, which from then on
+   * controls the memory limit of the cache.
+   */
+  template <class N>
+  void DataFile<N>::RegisterCache(CacheManager& manager) const
+  {
+    manager.Register(datafile,
+                     cache);
+  }
+
   template <class N>
   void DataFile<N>::DumpStatistics() const
   {
@@ -512,6 +825,9 @@ namespace osmscout {
     bool Get(const I& id,
              ValueType& entry) const;
 
+    void GetCacheSnapshot(CacheSnapshot& snapshot) const;
+    bool PrefetchCacheSnapshot(const CacheSnapshot& snapshot) const;
+
     void DumpStatistics() const;
   };
 
@@ -639,6 +955,26 @@ namespace osmscout {
     return DataFile<N>::GetByOffset(offset,entry);
   }
 
+  template <class I, class N>
+  void IndexedDataFile<I,N>::GetCacheSnapshot(CacheSnapshot& snapshot) const
+  {
+    DataFile<N>::GetCacheSnapshot(snapshot);
+
+    index.GetCacheSnapshot(snapshot);
+  }
+
+  template <class I, class N>
+  bool IndexedDataFile<I,N>::PrefetchCacheSnapshot(const CacheSnapshot& snapshot) const
+  {
+    bool success=index.PrefetchCacheSnapshot(snapshot);
+
+    if (!DataFile<N>::PrefetchCacheSnapshot(snapshot)) {
+      success=false;
+    }
+
+    return success;
+  }
+
   template <class I, class N>
   void IndexedDataFile<I,N>::DumpStatistics() const
   {
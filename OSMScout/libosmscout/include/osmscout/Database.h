@@ -25,15 +25,25 @@
 #include <set>
 #include <unordered_map>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <atomic>
+#include <thread>
+#endif
+
 // Type and style sheet configuration
 #include <osmscout/TypeConfig.h>
 #include <osmscout/TypeSet.h>
 
 // Datafiles
+#include <osmscout/CacheSnapshot.h>
 #include <osmscout/AreaDataFile.h>
 #include <osmscout/NodeDataFile.h>
 #include <osmscout/WayDataFile.h>
 
+#include <osmscout/ColumnDataFile.h>
+
 #include <osmscout/OptimizeAreasLowZoom.h>
 #include <osmscout/OptimizeWaysLowZoom.h>
 
@@ -44,6 +54,10 @@
 
 // Location index
 #include <osmscout/LocationIndex.h>
+#include <osmscout/ReverseGeocodeIndex.h>
+
+// POI index
+#include <osmscout/POIIndex.h>
 
 // Water index
 #include <osmscout/WaterIndex.h>
@@ -69,11 +83,14 @@ namespace osmscout {
 
     The following attributes are currently available:
     * cache sizes.
+    * cache memory budget.
+    * cache snapshot file.
     */
   class OSMSCOUT_API DatabaseParameter
   {
   private:
     unsigned long areaAreaIndexCacheSize;
+    bool          areaAreaIndexRTree;
     unsigned long areaNodeIndexCacheSize;
 
     unsigned long nodeCacheSize;
@@ -82,10 +99,19 @@ namespace osmscout {
 
     unsigned long areaCacheSize;
 
+    unsigned long cacheMemoryBudget;
+
+    bool          nodesDataMMap;
+    bool          waysDataMMap;
+    bool          areasDataMMap;
+
+    std::string   cacheSnapshotFile;
+
   public:
     DatabaseParameter();
 
     void SetAreaAreaIndexCacheSize(unsigned long areaAreaIndexCacheSize);
+    void SetAreaAreaIndexRTree(bool rtree);
     void SetAreaNodeIndexCacheSize(unsigned long areaNodeIndexCacheSize);
 
     void SetNodeCacheSize(unsigned long nodeCacheSize);
@@ -94,7 +120,16 @@ namespace osmscout {
 
     void SetAreaCacheSize(unsigned long relationCacheSize);
 
+    void SetCacheMemoryBudget(unsigned long cacheMemoryBudget);
+
+    void SetNodesDataMMap(bool mmap);
+    void SetWaysDataMMap(bool mmap);
+    void SetAreasDataMMap(bool mmap);
+
+    void SetCacheSnapshotFile(const std::string& cacheSnapshotFile);
+
     unsigned long GetAreaAreaIndexCacheSize() const;
+    bool GetAreaAreaIndexRTree() const;
     unsigned long GetAreaNodeIndexCacheSize() const;
 
     unsigned long GetNodeCacheSize() const;
@@ -102,6 +137,14 @@ namespace osmscout {
     unsigned long GetWayCacheSize() const;
 
     unsigned long GetAreaCacheSize() const;
+
+    unsigned long GetCacheMemoryBudget() const;
+
+    bool GetNodesDataMMap() const;
+    bool GetWaysDataMMap() const;
+    bool GetAreasDataMMap() const;
+
+    std::string GetCacheSnapshotFile() const;
   };
 
   /**
@@ -114,6 +157,19 @@ namespace osmscout {
    *
    * The Database is opened by passing the directory that contains
    * all database files.
+   *
+   * If a cache snapshot file is configured (see
+   * DatabaseParameter::SetCacheSnapshotFile()), the database warms up after
+   * Open(): the file regions referenced by the snapshot are read in the
+   * background in file offset order and the caches of the data files and
+   * indexes are filled from the snapshot when they are opened. On Close()
+   * a new snapshot is written. SaveCacheSnapshot() can be called to write
+   * snapshots periodically.
+   *
+   * If a cache memory budget is configured (see
+   * DatabaseParameter::SetCacheMemoryBudget()), the caches of nodes, ways,
+   * areas and the area area index share the budget via a CacheManager instead
+   * of being limited by their number of entries.
    */
   class OSMSCOUT_API Database
   {
@@ -127,21 +183,44 @@ namespace osmscout {
 
     GeoBox                          boundingBox;          //!< Bounding box in which data is available
 
+    CacheManagerRef                 cacheManager;         //!< Distributes the cache memory budget, if configured
+
     mutable NodeDataFileRef         nodeDataFile;         //!< Cached access to the 'nodes.dat' file
     mutable AreaDataFileRef         areaDataFile;         //!< Cached access to the 'areas.dat' file
     mutable WayDataFileRef          wayDataFile;          //!< Cached access to the 'ways.dat' file
 
+    mutable ColumnDataFileRef       nodeColumnFile;       //!< Cached access to the optional 'nodes.col' file
+    mutable ColumnDataFileRef       wayColumnFile;        //!< Cached access to the optional 'ways.col' file
+    mutable ColumnDataFileRef       areaColumnFile;       //!< Cached access to the optional 'areas.col' file
+
     mutable AreaNodeIndexRef        areaNodeIndex;        //!< Index of nodes by containing area
     mutable AreaWayIndexRef         areaWayIndex;         //!< Index of areas by containing area
     mutable AreaAreaIndexRef        areaAreaIndex;        //!< Index of ways by containing area
 
     mutable LocationIndexRef        locationIndex;        //!< Location-based index
+    mutable ReverseGeocodeIndexRef  reverseGeocodeIndex;  //!< Spatial index of addresses and locations
+
+    mutable POIIndexRef             poiIndex;             //!< Index of POIs by type and position
 
     mutable WaterIndexRef           waterIndex;           //!< Index of land/sea tiles
 
     mutable OptimizeAreasLowZoomRef optimizeAreasLowZoom; //!< Optimized data for low zoom situations
     mutable OptimizeWaysLowZoomRef  optimizeWaysLowZoom;  //!< Optimized data for low zoom situations
 
+    CacheSnapshot                   cacheSnapshot;        //!< Cache snapshot loaded during Open()
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::thread                     prefetchThread;       //!< Thread reading the regions of the cache snapshot
+    std::atomic<bool>               prefetchAborted;      //!< Signals the prefetch thread to stop
+#endif
+
+  private:
+    void PrefetchFiles();
+    void StopPrefetch();
+    ColumnDataFileRef GetColumnFile(const char* filename,
+                                    bool memoryMapped,
+                                    ColumnDataFileRef& columnFile) const;
+
   public:
     Database(const DatabaseParameter& parameter);
     virtual ~Database();
@@ -152,18 +231,29 @@ namespace osmscout {
 
     void FlushCache();
 
+    bool SaveCacheSnapshot(const std::string& filename) const;
+
     std::string GetPath() const;
     TypeConfigRef GetTypeConfig() const;
 
+    CacheManagerRef GetCacheManager() const;
+
     NodeDataFileRef GetNodeDataFile() const;
     AreaDataFileRef GetAreaDataFile() const;
     WayDataFileRef GetWayDataFile() const;
 
+    ColumnDataFileRef GetNodeColumnFile() const;
+    ColumnDataFileRef GetWayColumnFile() const;
+    ColumnDataFileRef GetAreaColumnFile() const;
+
     AreaNodeIndexRef GetAreaNodeIndex() const;
     AreaAreaIndexRef GetAreaAreaIndex() const;
     AreaWayIndexRef GetAreaWayIndex() const;
 
     LocationIndexRef GetLocationIndex() const;
+    ReverseGeocodeIndexRef GetReverseGeocodeIndex() const;
+
+    POIIndexRef GetPOIIndex() const;
 
     WaterIndexRef GetWaterIndex() const;
 
@@ -209,6 +209,152 @@ namespace osmscout {
     static bool Parse(const std::string& text,
                       GeoCoord& coord);
   };
+
+  /**
+   * \ingroup Geometry
+   *
+   * Geographic coordinate stored in the fixed point format of the data files
+   * (see latConversionFactor and lonConversionFactor) using two 32 bit integers
+   * instead of two doubles, thus halving the memory of a coordinate.
+   *
+   * Coordinates read from or written to data files are stored without any
+   * conversion. The latitude and longitude values are only converted to double
+   * on access (GetLat(), GetLon(), GetCoord()), normally while projecting the
+   * coordinate. Setting the coordinate from double values rounds them to the
+   * resolution of the data files.
+   *
+   * Used for the coordinates of ways and areas.
+   */
+  struct OSMSCOUT_API CompactGeoCoord
+  {
+    uint32_t lat;
+    uint32_t lon;
+
+    /**
+     * The default constructor creates an uninitialized instance (for performance reasons).
+     */
+    inline CompactGeoCoord()
+    {
+      // no code
+    }
+
+    /**
+     * Initialize the coordinate with the given latitude and longitude values.
+     */
+    inline CompactGeoCoord(double lat,
+                           double lon)
+    {
+      Set(lat,lon);
+    }
+
+    /**
+     * Initialize the coordinate with the value of the given coordinate.
+     */
+    inline CompactGeoCoord(const GeoCoord& coord)
+    {
+      Set(coord.GetLat(),coord.GetLon());
+    }
+
+    /**
+     * Assign a new latitude and longitude value to the coordinate
+     */
+    inline void Set(double lat,
+                    double lon)
+    {
+      this->lat=(uint32_t)round((lat+90.0)*latConversionFactor);
+      this->lon=(uint32_t)round((lon+180.0)*lonConversionFactor);
+    }
+
+    /**
+     * Assign new fixed point latitude and longitude values to the coordinate
+     */
+    inline void SetFixed(uint32_t lat,
+                         uint32_t lon)
+    {
+      this->lat=lat;
+      this->lon=lon;
+    }
+
+    /**
+     * Return the latitude value of the coordinate
+     */
+    inline double GetLat() const
+    {
+      return lat/latConversionFactor-90.0;
+    }
+
+    /**
+     * Return the longitude value of the coordinate
+     */
+    inline double GetLon() const
+    {
+      return lon/lonConversionFactor-180.0;
+    }
+
+    /**
+     * Return the fixed point latitude value of the coordinate
+     */
+    inline uint32_t GetFixedLat() const
+    {
+      return lat;
+    }
+
+    /**
+     * Return the fixed point longitude value of the coordinate
+     */
+    inline uint32_t GetFixedLon() const
+    {
+      return lon;
+    }
+
+    /**
+     * Return the coordinate as GeoCoord
+     */
+    inline GeoCoord GetCoord() const
+    {
+      return GeoCoord(GetLat(),GetLon());
+    }
+
+    inline operator GeoCoord() const
+    {
+      return GetCoord();
+    }
+
+    /**
+     * Return a string representation of the coordinate value in a human readable format.
+     */
+    inline std::string GetDisplayText() const
+    {
+      return GetCoord().GetDisplayText();
+    }
+
+    /**
+     * Return true if both coordinates are equals
+     */
+    inline bool IsEqual(const CompactGeoCoord& other) const
+    {
+      return lat==other.lat && lon==other.lon;
+    }
+
+    /**
+     * Return true if both coordinates are equals
+     */
+    inline bool operator==(const CompactGeoCoord& other) const
+    {
+      return lat==other.lat && lon==other.lon;
+    }
+
+    inline bool operator!=(const CompactGeoCoord& other) const
+    {
+      return lat!=other.lat || lon!=other.lon;
+    }
+
+    inline bool operator<(const CompactGeoCoord& other) const
+    {
+      return lat<other.lat ||
+      (lat==other.lat && lon<other.lon);
+    }
+  };
 }
 
 #endif
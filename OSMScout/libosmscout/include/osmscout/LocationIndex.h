@@ -21,13 +21,16 @@
 */
 
 #include <list>
+#include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
 #include <string>
 
 #include <osmscout/Location.h>
+#include <osmscout/LocationTokenIndex.h>
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/FileScanner.h>
@@ -43,6 +46,10 @@ namespace osmscout {
    * Currently every type that has option 'INDEX' set in the map.ost file is indexed as
    * location. Areas are currently build by scanning administrative boundaries and the
    * various sized city typed locations and areas.
+   *
+   * If the optional LocationTokenIndex is available, visiting regions and locations
+   * for a given name pattern only touches the entries the token index returns as
+   * possible matches.
    */
   class OSMSCOUT_API LocationIndex
   {
@@ -57,6 +64,7 @@ namespace osmscout {
     std::unordered_set<std::string> regionIgnoreTokens;
     std::unordered_set<std::string> locationIgnoreTokens;
     FileOffset                      indexOffset;
+    LocationTokenIndex              tokenIndex;
 
   private:
     bool Read(FileScanner& scanner,
@@ -73,6 +81,26 @@ namespace osmscout {
                                     bool recursive,
                                     bool& stopped) const;
 
+    bool LoadParentRegionOffset(FileScanner& scanner,
+                                std::unordered_map<FileOffset,FileOffset>& parentOffsets,
+                                FileOffset regionOffset,
+                                FileOffset& parentOffset) const;
+
+    bool IsRegionInSubtree(FileScanner& scanner,
+                           std::unordered_map<FileOffset,FileOffset>& parentOffsets,
+                           const std::unordered_set<FileOffset>& rootOffsets,
+                           FileOffset regionOffset,
+                           bool& inSubtree) const;
+
+    bool LoadRegionPOIEntries(FileScanner& scanner,
+                              const AdminRegion& region,
+                              LocationVisitor& visitor,
+                              bool& stopped) const;
+
+    bool LoadLocationEntry(FileScanner& scanner,
+                           FileOffset regionOffset,
+                           Location& location) const;
+
     bool LoadRegionDataEntry(FileScanner& scanner,
                              const AdminRegion& region,
                              LocationVisitor& visitor,
@@ -98,6 +126,12 @@ namespace osmscout {
      */
     bool VisitAdminRegions(AdminRegionVisitor& visitor) const;
 
+    /**
+     * Visit all admin regions, whose name or alias might match the given pattern
+     */
+    bool VisitAdminRegions(const std::string& pattern,
+                           AdminRegionVisitor& visitor) const;
+
     /**
      * Visit all locations within the given admin region
      */
@@ -105,6 +139,14 @@ namespace osmscout {
                                    LocationVisitor& visitor,
                                    bool recursive=true) const;
 
+    /**
+     * Visit all locations and POIs within the given admin region and its sub regions,
+     * whose name might match the given pattern
+     */
+    bool VisitAdminRegionLocations(const AdminRegion& region,
+                                   const std::string& pattern,
+                                   LocationVisitor& visitor) const;
+
     /**
      * Visit all addresses for a given location (in a given AdminRegion)
      */
@@ -115,6 +157,12 @@ namespace osmscout {
     bool ResolveAdminRegionHierachie(const AdminRegionRef& region,
                                      std::map<FileOffset,AdminRegionRef>& refs) const;
 
+    bool ResolveAdminRegionHierachie(const std::set<FileOffset>& regionOffsets,
+                                     std::map<FileOffset,AdminRegionRef>& refs) const;
+
+    bool ResolveLocations(const std::map<FileOffset,FileOffset>& locationRegionOffsets,
+                          std::map<FileOffset,LocationRef>& locations) const;
+
     void DumpStatistics();
   };
 
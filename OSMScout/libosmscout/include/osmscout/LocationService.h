@@ -22,6 +22,7 @@
 
 #include <list>
 #include <memory>
+#include <vector>
 
 #include <osmscout/Database.h>
 #include <osmscout/Location.h>
@@ -259,6 +260,23 @@ namespace osmscout {
       AddressRef     address;     //!< Address data if set
     };
 
+    /**
+     * \ingroup Location
+     *
+     * Result of reverse geocoding a coordinate
+     */
+    struct OSMSCOUT_API ReverseGeocodeResult
+    {
+      GeoCoord                    coord;            //!< The coordinate used for lookup
+      AdminRegionRef              adminRegion;      //!< Region of the nearest address or location, if set
+      std::vector<AdminRegionRef> adminRegions;     //!< The region and all its parent regions, starting with the region
+      LocationRef                 location;         //!< The nearest location (street,...), if set
+      double                      locationDistance; //!< Distance to the nearest location in meter
+      LocationRef                 addressLocation;  //!< The location of the nearest address, if set
+      AddressRef                  address;          //!< The nearest address, if set
+      double                      addressDistance;  //!< Distance to the nearest address in meter
+    };
+
   private:
     DatabaseRef database;
 
@@ -310,6 +328,10 @@ namespace osmscout {
                               std::list<ReverseLookupResult>& result) const;
     bool ReverseLookupObject(const ObjectFileRef& object,
                               std::list<ReverseLookupResult>& result) const;
+
+    bool ReverseGeocode(const std::vector<GeoCoord>& coords,
+                        double maxDistance,
+                        std::vector<ReverseGeocodeResult>& results) const;
   };
 
   //! \ingroup Service
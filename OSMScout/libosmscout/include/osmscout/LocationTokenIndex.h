@@ -0,0 +1,151 @@
+#ifndef OSMSCOUT_LOCATIONTOKENINDEX_H
+#define OSMSCOUT_LOCATIONTOKENINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   * Inverted index for the names stored in the location index. For each token of
+   * a region name, a region alias, a POI name or a location name all suffixes with
+   * at least MIN_TOKEN_LENGTH bytes are indexed. Since every substring of a token
+   * is the prefix of one of its suffixes, a prefix lookup in the sorted list of
+   * index terms returns all entries with at least one name containing the given
+   * token.
+   *
+   * Names and search patterns are normalized in the same way as the location
+   * search matches names, so the entries returned are a superset of the entries
+   * matching a pattern. Entries are returned in the order they are stored in the
+   * location index.
+   */
+  class OSMSCOUT_API LocationTokenIndex
+  {
+  public:
+    static const char* const FILENAME_LOCATIONTOKEN_IDX;
+
+    //! Minimum length of a token in bytes to be indexed
+    static const size_t MIN_TOKEN_LENGTH=3;
+
+    //! Number of index terms between two entries of the in memory term index
+    static const size_t TERM_INDEX_INTERVAL=64;
+
+    //! Size of an entry in the entry table in bytes
+    static const size_t ENTRY_SIZE=1+8+8;
+
+    enum EntryType
+    {
+      entryRegion   = 0, //!< An admin region, including its aliases
+      entryPOI      = 1, //!< A POI of an admin region
+      entryLocation = 2  //!< A location of an admin region
+    };
+
+    /**
+     * An entry of the location index containing a name
+     */
+    struct OSMSCOUT_API Entry
+    {
+      EntryType  type;         //!< Type of the entry
+      FileOffset regionOffset; //!< Offset of the admin region the entry belongs to
+      FileOffset offset;       //!< Offset of the entry in the location index, for POIs the data offset of the region
+
+      bool operator<(const Entry& other) const
+      {
+        if (offset!=other.offset) {
+          return offset<other.offset;
+        }
+
+        return type<other.type;
+      }
+
+      bool operator==(const Entry& other) const
+      {
+        return offset==other.offset &&
+               type==other.type;
+      }
+    };
+
+  private:
+    /**
+     * An entry of the in memory term index, referencing every TERM_INDEX_INTERVAL'th
+     * term of the on disk term list
+     */
+    struct TermIndexEntry
+    {
+      std::string term;   //!< The term
+      FileOffset  offset; //!< Offset of the term in the term list
+
+      bool operator<(const TermIndexEntry& other) const
+      {
+        return term<other.term;
+      }
+    };
+
+  private:
+    std::string                 path;
+    bool                        isAvailable;
+    uint32_t                    entryCount;
+    FileOffset                  entryTableOffset;
+    uint32_t                    termCount;
+    std::vector<TermIndexEntry> termIndex;
+
+  private:
+    bool GetTokenEntryIds(FileScanner& scanner,
+                          const std::string& token,
+                          std::vector<uint32_t>& ids) const;
+
+  public:
+    LocationTokenIndex();
+    virtual ~LocationTokenIndex();
+
+    bool Load(const std::string& path);
+
+    /**
+     * Returns true, if the index has been found and loaded
+     */
+    inline bool IsAvailable() const
+    {
+      return isAvailable;
+    }
+
+    bool GetEntries(const std::string& pattern,
+                    std::vector<Entry>& entries,
+                    bool& indexed) const;
+
+    static void NormalizeName(std::string& name);
+
+    static void GetTokens(const std::string& name,
+                          std::list<std::string>& tokens);
+
+    static void GetIndexTerms(const std::string& name,
+                              std::set<std::string>& terms);
+  };
+}
+
+#endif
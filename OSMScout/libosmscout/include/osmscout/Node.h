@@ -99,6 +99,8 @@ namespace osmscout {
     void SetCoords(const GeoCoord& coords);
     void SetFeatures(const FeatureValueBuffer& buffer);
 
+    size_t GetMemory() const;
+
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool Write(const TypeConfig& typeConfig,
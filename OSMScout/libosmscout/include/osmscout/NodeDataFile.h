@@ -26,6 +26,12 @@
 #include <osmscout/DataFile.h>
 
 namespace osmscout {
+
+  inline unsigned long GetDataMemory(const Node& node)
+  {
+    return (unsigned long)node.GetMemory();
+  }
+
   /**
     \ingroup Database
     Abstraction for getting cached access to the 'nodes.dat' file.
@@ -20,14 +20,19 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
+#include <list>
+#include <set>
 #include <vector>
 
+#include <osmscout/CacheSnapshot.h>
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/Number.h>
 #include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
 #include <osmscout/util/Reference.h>
 #include <osmscout/util/String.h>
 
@@ -37,62 +42,101 @@ namespace osmscout {
     \ingroup Database
     Numeric index handles an index over instance of class <T> where the index criteria
     is of type <N>, where <N> has a numeric nature (usually Id).
+
+    The index is a static B+-tree with fixed width entries, so that it can be
+    searched directly in the memory mapped file.
+
+    All values are stored little endian. The file header (padded to full
+    pages) holds the page size, the number of entries, the smallest id (as uint64),
+    the number of bytes per id and per file offset and the number of levels.
+    For each level (top level first) it then holds the file offset of the
+    first page of the level and the number of entries in the level.
+
+    Ids are stored relative to the smallest id. Each page holds a block of a
+    fixed number of entries. Entries of the leaf level are id and file offset
+    of an object, entries of the other levels are the first id of the
+    corresponding block in the level below. Entry i of a level thus refers to
+    block i of the level below and no child pointers are needed.
+
+    If the file is not memory mapped, pages are read into a page cache.
     */
   template <class N>
   class NumericIndex
   {
   private:
     /**
-      an individual index entry.
+      Position and layout of one level of the tree
       */
-    struct Entry
+    struct Level
     {
-      N          startId;
-      FileOffset fileOffset;
+      FileOffset start;        //!< File offset of the first page of the level
+      uint32_t   entryCount;   //!< Number of entries in the level
+      uint32_t   blockSize;    //!< Number of entries per page
+      uint8_t    entryBytes;   //!< Size of one entry in bytes
     };
 
-    struct Page : public Referencable
-    {
-      std::vector<Entry> entries;
-
-      bool IndexIsValid(size_t index)
-      {
-        return index<entries.size();
-      }
-    };
-
-    typedef Ref<Page> PageRef;
-
-    typedef Cache<N,PageRef> PageCache;
+    typedef Cache<FileOffset,std::vector<unsigned char> > PageCache;
 
     /**
       Returns the size of a individual cache entry
       */
     struct NumericIndexCacheValueSizer : public PageCache::ValueSizer
     {
-      unsigned long GetSize(const PageRef& value) const
+      unsigned long GetSize(const std::vector<unsigned char>& value) const
       {
-        return sizeof(value)+sizeof(Page)+sizeof(Entry)*value->entries.size();
+        return sizeof(value)+value.size();
       }
     };
 
   private:
     std::string                    filepart;
     std::string                    filename;
-    unsigned long                  cacheSize;
     mutable FileScanner            scanner;
     bool                           memoryMaped;
     FileScanner::Mode              mode;
     uint32_t                       pageSize;
-    uint32_t                       levels;
-    std::vector<uint32_t>          pageCounts;
-    char                           *buffer;
-    PageRef                        root;
-    mutable std::vector<PageCache> leafs;
+    uint32_t                       entryCount;
+    uint64_t                       minId;
+    uint8_t                        idBytes;
+    uint8_t                        offsetBytes;
+    std::vector<Level>             levels;       //!< All levels, top level first
+    const unsigned char*           data;         //!< The memory mapped file or NULL
+    mutable PageCache              pageCache;    //!< Page cache, if the file is not memory mapped
 
   private:
-    size_t GetPageIndex(const PageRef& page, N id) const;
-    bool ReadPage(FileOffset offset, PageRef& page) const;
+    static inline uint64_t GetValue(const unsigned char* buffer,
+                                    uint8_t bytes)
+    {
+      uint64_t value=0;
+
+      for (uint8_t i=0; i<bytes; i++) {
+        value|=((uint64_t)buffer[i]) << (8*i);
+      }
+
+      return value;
+    }
+
+    bool GetPage(FileOffset offset,
+                 const unsigned char*& page) const;
+    bool GetBlock(size_t level,
+                  size_t block,
+                  const unsigned char*& page,
+                  size_t& count) const;
+    size_t FindEntry(const Level& level,
+                     const unsigned char* page,
+                     size_t count,
+                     uint64_t key) const;
+    bool GetLeafBlock(uint64_t key,
+                      size_t& block) const;
+    bool GetKeyOffsets(std::vector<std::pair<uint64_t,size_t> >& keys,
+                       std::vector<FileOffset>& result,
+                       std::vector<bool>& found) const;
+
+    template<typename IteratorIn>
+    bool GetOffsets(IteratorIn begin,
+                    IteratorIn end,
+                    size_t size,
+                    std::vector<FileOffset>& offsets) const;
 
   public:
     NumericIndex(const std::string& filename,
@@ -109,19 +153,78 @@ namespace osmscout {
     bool GetOffsets(const std::list<N>& ids, std::vector<FileOffset>& offsets) const;
     bool GetOffsets(const std::set<N>& ids, std::vector<FileOffset>& offsets) const;
 
+    void GetCacheSnapshot(CacheSnapshot& snapshot) const;
+    bool PrefetchCacheSnapshot(const CacheSnapshot& snapshot) const;
+
     void DumpStatistics() const;
   };
 
+  /**
+    \ingroup Database
+    Writes the static B+-tree read by NumericIndex. Ids have to be added in
+    ascending order. The leaf level is written while adding, the upper levels
+    and the file header are written on Close().
+    */
+  class OSMSCOUT_API NumericIndexWriter
+  {
+  private:
+    FileWriter              writer;
+    uint32_t                pageSize;
+    uint32_t                entryCount;   //!< Number of entries passed to Open()
+    uint32_t                addedCount;   //!< Number of entries added so far
+    uint64_t                minId;
+    uint64_t                lastKey;      //!< Last key added
+    FileOffset              leafStart;    //!< File offset of the leaf level
+    uint8_t                 idBytes;
+    uint8_t                 offsetBytes;
+    uint32_t                levelCount;   //!< Number of levels of the tree
+    std::vector<uint64_t>   keys;         //!< Keys of the current leaf page
+    std::vector<FileOffset> offsets;      //!< Offsets of the current leaf page
+    std::vector<uint64_t>   firstKeys;    //!< First key of each leaf page
+
+  private:
+    bool WriteLevel(uint8_t levelOffsetBytes,
+                    const std::vector<uint64_t>& levelKeys,
+                    const std::vector<FileOffset>& levelOffsets,
+                    std::vector<uint64_t>& levelFirstKeys);
+
+  public:
+    NumericIndexWriter();
+
+    bool Open(const std::string& filename,
+              uint32_t pageSize,
+              uint32_t entryCount,
+              uint64_t minId,
+              uint64_t maxId,
+              FileOffset dataFileSize);
+    bool Add(uint64_t id,
+             FileOffset offset);
+    bool Close();
+
+    inline std::string GetFilename() const
+    {
+      return writer.GetFilename();
+    }
+
+    inline uint32_t GetLevelCount() const
+    {
+      return levelCount;
+    }
+  };
+
   template <class N>
   NumericIndex<N>::NumericIndex(const std::string& filename,
                                 unsigned long cacheSize)
    : filepart(filename),
-     cacheSize(cacheSize),
      memoryMaped(false),
      mode(FileScanner::Normal),
      pageSize(0),
-     levels(0),
-     buffer(NULL)
+     entryCount(0),
+     minId(0),
+     idBytes(0),
+     offsetBytes(0),
+     data(NULL),
+     pageCache(cacheSize)
   {
     // no code
   }
@@ -130,101 +233,132 @@ namespace osmscout {
   NumericIndex<N>::~NumericIndex()
   {
     Close();
-
-    delete [] buffer;
   }
 
   /**
-    Binary search for index page for given id
+    Returns the page at the given file offset, either directly from the memory
+    mapped file or from the page cache
     */
   template <class N>
-  inline size_t NumericIndex<N>::GetPageIndex(const PageRef& page, N id) const
+  inline bool NumericIndex<N>::GetPage(FileOffset offset,
+                                       const unsigned char*& page) const
   {
-    size_t size=page->entries.size();
-
-    if (size>0) {
-      size_t left=0;
-      size_t right=size-1;
-      size_t mid;
-
-      while (left<=right) {
-        mid=(left+right)/2;
-        if (page->entries[mid].startId<=id &&
-            (mid+1>=size || page->entries[mid+1].startId>id)) {
-          return mid;
-        }
-        else if (page->entries[mid].startId<id) {
-          left=mid+1;
-        }
-        else {
-          if (mid==0) {
-            return size;
-          }
+    if (data!=NULL) {
+      page=data+offset;
 
-          right=mid-1;
-        }
+      return true;
+    }
+
+    typename PageCache::CacheRef cacheRef;
+
+    if (!pageCache.GetEntry(offset,cacheRef)) {
+      std::vector<unsigned char> buffer(pageSize);
+
+      // Only cache pages that could be read completely
+      if (!scanner.SetPos(offset) ||
+          !scanner.Read((char*)buffer.data(),
+                        pageSize)) {
+        std::cerr << "Cannot read index page from file '" << filename << "'!" << std::endl;
+        return false;
       }
+
+      typename PageCache::CacheEntry cacheEntry(offset);
+
+      cacheRef=pageCache.SetEntry(cacheEntry);
+      cacheRef->value.swap(buffer);
     }
 
-    return size;
+    page=cacheRef->value.data();
+
+    return true;
   }
 
+  /**
+    Returns the page of the given block of the given level and the number of
+    entries in this block
+    */
   template <class N>
-  inline bool NumericIndex<N>::ReadPage(FileOffset offset, PageRef& page) const
+  inline bool NumericIndex<N>::GetBlock(size_t level,
+                                        size_t block,
+                                        const unsigned char*& page,
+                                        size_t& count) const
   {
-    if (page.Invalid()) {
-      page=new Page();
-    }
-    else {
-      page->entries.clear();
-    }
+    const Level& l=levels[level];
+    size_t       first=block*l.blockSize;
 
-    page->entries.reserve(pageSize);
-
-    if (!scanner.IsOpen() &&
-        !scanner.Open(filename,mode,memoryMaped)) {
-      std::cerr << "Cannot open '" << filename << "'!" << std::endl;
+    if (first>=l.entryCount) {
       return false;
     }
 
-    scanner.SetPos(offset);
+    count=std::min((size_t)l.blockSize,
+                   l.entryCount-first);
 
-    if (!scanner.Read(buffer,pageSize)) {
-      std::cerr << "Cannot read index page from file '" << filename << "'!" << std::endl;
-      return false;
-    }
+    return GetPage(l.start+(FileOffset)block*pageSize,
+                   page);
+  }
 
-    size_t     currentPos=0;
-    N          sio=0;
-    FileOffset poo=0;
+  /**
+    Binary search for the last entry in the block with an id less than or
+    equal to the given key. Returns count, if there is no such entry.
+    */
+  template <class N>
+  inline size_t NumericIndex<N>::FindEntry(const Level& level,
+                                           const unsigned char* page,
+                                           size_t count,
+                                           uint64_t key) const
+  {
+    size_t left=0;
+    size_t right=count;
 
-    while (currentPos<pageSize &&
-           buffer[currentPos]!=0) {
-      unsigned int bytes;
-      N            si;
-      FileOffset   po;
-      Entry        entry;
+    // Find the first entry with an id greater than key
+    while (left<right) {
+      size_t mid=(left+right)/2;
 
-      bytes=DecodeNumber(&buffer[currentPos],
-                         si);
+      if (GetValue(page+mid*level.entryBytes,idBytes)<=key) {
+        left=mid+1;
+      }
+      else {
+        right=mid;
+      }
+    }
 
-      currentPos+=bytes;
+    return left==0 ? count : left-1;
+  }
 
-      bytes=DecodeNumber(&buffer[currentPos],
-                         po);
+  /**
+    Descends from the top level to the leaf level and returns the index of
+    the leaf block that could contain the given key.
+    */
+  template <class N>
+  inline bool NumericIndex<N>::GetLeafBlock(uint64_t key,
+                                            size_t& block) const
+  {
+    block=0;
 
-      currentPos+=bytes;
+    for (size_t level=0; level+1<levels.size(); level++) {
+      const unsigned char* page;
+      size_t               count;
 
-      sio+=si;
-      poo+=po;
+      if (!GetBlock(level,
+                    block,
+                    page,
+                    count)) {
+        return false;
+      }
+
+      size_t i=FindEntry(levels[level],
+                         page,
+                         count,
+                         key);
 
-      entry.startId=sio;
-      entry.fileOffset=poo;
+      if (i>=count) {
+        return false;
+      }
 
-      page->entries.push_back(entry);
+      block=block*levels[level].blockSize+i;
     }
 
-    return !scanner.HasError();
+    return true;
   }
 
   template <class N>
@@ -232,9 +366,7 @@ namespace osmscout {
                              FileScanner::Mode mode,
                              bool memoryMaped)
   {
-    uint32_t    entries;
-    FileOffset  lastLevelPageStart;
-    FileOffset  indexPageCountsOffset;
+    uint32_t levelCount;
 
     filename=AppendFileToDir(path,filepart);
     this->memoryMaped=memoryMaped;
@@ -245,64 +377,57 @@ namespace osmscout {
       return false;
     }
 
-    scanner.ReadNumber(pageSize);                  // Size of one index page
-    scanner.ReadNumber(entries);                   // Number of entries in data file
-
-    scanner.Read(levels);                          // Number of levels
-    scanner.ReadFileOffset(lastLevelPageStart);    // Start of top level index page
-    scanner.ReadFileOffset(indexPageCountsOffset); // Start of list of sizes of index levels
-
-    if (scanner.HasError()) {
+    scanner.Read(pageSize);                        // Size of one index page
+    scanner.Read(entryCount);                      // Number of entries in data file
+    scanner.Read(minId);                           // Smallest id
+    scanner.Read(idBytes);                         // Bytes per id
+    scanner.Read(offsetBytes);                     // Bytes per file offset
+    scanner.Read(levelCount);                      // Number of levels
+
+    if (scanner.HasError() ||
+        pageSize==0 ||
+        idBytes==0 ||
+        idBytes>8 ||
+        offsetBytes==0 ||
+        offsetBytes>8) {
       std::cerr << "Error while loading header data of index file '" << filename << "'" << std::endl;
       return false;
     }
 
-    pageCounts.resize(levels);
-
-    scanner.SetPos(indexPageCountsOffset);
-    for (size_t i=0; i<levels; i++) {
-      scanner.ReadNumber(pageCounts[pageCounts.size()-1-i]);
-    }
-
-    delete [] buffer;
-    buffer=new char[pageSize];
-
-    //std::cout << entries << " entries to index, " << levels << " levels, pageSize " << pageSize << ", cache size " << cacheSize << std::endl;
-
-    ReadPage(lastLevelPageStart,root);
+    levels.resize(levelCount);
 
-    unsigned long currentCacheSize=cacheSize;
-    unsigned long requiredCacheSize=0;
+    for (size_t i=0; i<levels.size(); i++) {
+      scanner.ReadFileOffset(levels[i].start);
+      scanner.Read(levels[i].entryCount);
 
-    for (size_t i=1; i<pageCounts.size(); i++) {
-      unsigned long resultingCacheSize;
-
-      requiredCacheSize+=pageCounts[i];
+      levels[i].entryBytes=(i+1==levels.size()) ? idBytes+offsetBytes : idBytes;
+      levels[i].blockSize=pageSize/levels[i].entryBytes;
+    }
 
-      if (pageCounts[i]>currentCacheSize) {
-        resultingCacheSize=currentCacheSize;
-        currentCacheSize=0;
-      }
-      else {
-        resultingCacheSize=pageCounts[i];
-        currentCacheSize-=pageCounts[i];
-      }
+    if (scanner.HasError()) {
+      std::cerr << "Error while loading header data of index file '" << filename << "'" << std::endl;
+      return false;
+    }
 
-      if (requiredCacheSize>cacheSize) {
-        std::cerr << "Warning: Index " << filepart << " has cache size " << cacheSize<< ", but requires cache size " << requiredCacheSize << " to load index completely into cache!" << std::endl;
+    // All pages must be part of the file, memory mapped pages are accessed unchecked
+    for (const auto& level : levels) {
+      if (level.blockSize==0 ||
+          level.start+(FileOffset)((level.entryCount+level.blockSize-1)/level.blockSize)*pageSize>scanner.GetSize()) {
+        std::cerr << "Index file '" << filename << "' is truncated" << std::endl;
+        return false;
       }
-
-      //std::cout << "Setting cache size for level " << i+1 << " with " << pageCounts[i] << " entries to " << resultingCacheSize << std::endl;
-
-      leafs.push_back(PageCache(resultingCacheSize));
     }
 
-    return !scanner.HasError();
+    data=(const unsigned char*)scanner.GetMappedData();
+
+    return true;
   }
 
   template <class N>
   bool NumericIndex<N>::Close()
   {
+    data=NULL;
+
     if (scanner.IsOpen()) {
       return scanner.Close();
     }
@@ -314,97 +439,240 @@ namespace osmscout {
   bool NumericIndex<N>::GetOffset(const N& id,
                                   FileOffset& offset) const
   {
-    size_t r=GetPageIndex(root,id);
+    if (levels.empty() ||
+        (uint64_t)id-minId>=((uint64_t)1 << 63)) {
+      return false;
+    }
 
-    if (!root->IndexIsValid(r)) {
-      //std::cerr << "Id " << id << " not found in root index, " << root->entries.front().startId << "-" << root->entries.back().startId << std::endl;
+    uint64_t             key=(uint64_t)id-minId;
+    size_t               block;
+    const unsigned char* page;
+    size_t               count;
+
+    if (!GetLeafBlock(key,
+                      block) ||
+        !GetBlock(levels.size()-1,
+                  block,
+                  page,
+                  count)) {
       return false;
     }
 
-    offset=root->entries[r].fileOffset;
+    const Level& leaf=levels.back();
+    size_t       i=FindEntry(leaf,
+                             page,
+                             count,
+                             key);
 
-    N startId=root->entries[r].startId;
-    for (size_t level=0; level+2<=levels; level++) {
-      typename PageCache::CacheRef cacheRef;
+    if (i>=count ||
+        GetValue(page+i*leaf.entryBytes,idBytes)!=key) {
+      return false;
+    }
 
-      if (!leafs[level].GetEntry(startId,cacheRef)) {
-        typename PageCache::CacheEntry cacheEntry(startId);
+    offset=(FileOffset)GetValue(page+i*leaf.entryBytes+idBytes,offsetBytes);
 
-        cacheRef=leafs[level].SetEntry(cacheEntry);
+    return true;
+  }
 
-        ReadPage(offset,cacheRef->value);
+  /**
+    Resolves the given keys (paired with their position in the result). The
+    keys are sorted and the leaf level is swept once, each leaf page is
+    visited at most once.
+    */
+  template <class N>
+  bool NumericIndex<N>::GetKeyOffsets(std::vector<std::pair<uint64_t,size_t> >& keys,
+                                      std::vector<FileOffset>& result,
+                                      std::vector<bool>& found) const
+  {
+    const Level&         leaf=levels.back();
+    const unsigned char* page=NULL;
+    size_t               count=0;
+    uint64_t             firstKey=0;
+    uint64_t             lastKey=0;
+
+    std::sort(keys.begin(),
+              keys.end());
+
+    for (const auto& key : keys) {
+      if (page==NULL ||
+          key.first<firstKey ||
+          key.first>lastKey) {
+        size_t block;
+
+        if (!GetLeafBlock(key.first,
+                          block) ||
+            !GetBlock(levels.size()-1,
+                      block,
+                      page,
+                      count)) {
+          page=NULL;
+          continue;
+        }
+
+        firstKey=GetValue(page,idBytes);
+        lastKey=GetValue(page+(count-1)*leaf.entryBytes,idBytes);
       }
 
-      size_t i=GetPageIndex(cacheRef->value,id);
+      size_t i=FindEntry(leaf,
+                         page,
+                         count,
+                         key.first);
 
-      if (!cacheRef->value->IndexIsValid(i)) {
-        //std::cerr << "Id " << id << " not found in index level " << level+2 << "!" << std::endl;
-        return false;
+      if (i<count &&
+          GetValue(page+i*leaf.entryBytes,idBytes)==key.first) {
+        result[key.second]=(FileOffset)GetValue(page+i*leaf.entryBytes+idBytes,offsetBytes);
+        found[key.second]=true;
       }
-
-      startId=cacheRef->value->entries[i].startId;
-      offset=cacheRef->value->entries[i].fileOffset;
     }
 
-    /*
-    if (startId!=id) {
-      std::cerr << "Id " << id << " not found in leaf index level!"  << " " << levels << std::endl;
-    }*/
-
-    return startId==id;
+    return !scanner.HasError();
   }
 
+  /**
+    Returns the offsets of all ids found in the index, in the order of the ids.
+    */
   template <class N>
-  bool NumericIndex<N>::GetOffsets(const std::vector<N>& ids,
+  template<typename IteratorIn>
+  bool NumericIndex<N>::GetOffsets(IteratorIn begin,
+                                   IteratorIn end,
+                                   size_t size,
                                    std::vector<FileOffset>& offsets) const
   {
+    std::vector<std::pair<uint64_t,size_t> > keys;
+    std::vector<FileOffset>                  result(size);
+    std::vector<bool>                        found(size,false);
+
     offsets.clear();
-    offsets.reserve(ids.size());
 
-    for (const auto& id : ids) {
-      FileOffset offset;
+    if (levels.empty()) {
+      return true;
+    }
+
+    keys.reserve(size);
 
-      if (GetOffset(id,
-                    offset)) {
-        offsets.push_back(offset);
+    size_t pos=0;
+
+    for (IteratorIn id=begin; id!=end; ++id, ++pos) {
+      if ((uint64_t)*id-minId<((uint64_t)1 << 63)) {
+        keys.push_back(std::make_pair((uint64_t)*id-minId,
+                                      pos));
+      }
+    }
+
+    if (!GetKeyOffsets(keys,
+                       result,
+                       found)) {
+      return false;
+    }
+
+    offsets.reserve(size);
+
+    for (size_t i=0; i<size; i++) {
+      if (found[i]) {
+        offsets.push_back(result[i]);
       }
     }
 
     return true;
   }
 
+  template <class N>
+  bool NumericIndex<N>::GetOffsets(const std::vector<N>& ids,
+                                   std::vector<FileOffset>& offsets) const
+  {
+    return GetOffsets(ids.begin(),
+                      ids.end(),
+                      ids.size(),
+                      offsets);
+  }
+
   template <class N>
   bool NumericIndex<N>::GetOffsets(const std::list<N>& ids,
                                    std::vector<FileOffset>& offsets) const
   {
-    offsets.clear();
-    offsets.reserve(ids.size());
+    return GetOffsets(ids.begin(),
+                      ids.end(),
+                      ids.size(),
+                      offsets);
+  }
 
-    for (const auto& id : ids) {
-      FileOffset offset;
+  template <class N>
+  bool NumericIndex<N>::GetOffsets(const std::set<N>& ids,
+                                   std::vector<FileOffset>& offsets) const
+  {
+    return GetOffsets(ids.begin(),
+                      ids.end(),
+                      ids.size(),
+                      offsets);
+  }
 
-      if (GetOffset(id,
-                    offset)) {
-        offsets.push_back(offset);
-      }
+  /**
+    Adds the file offsets of the index pages currently in the page cache to the
+    given snapshot. If the index is memory mapped, there is no page cache.
+    */
+  template <class N>
+  void NumericIndex<N>::GetCacheSnapshot(CacheSnapshot& snapshot) const
+  {
+    FileOffset            fileSize;
+    std::vector<uint64_t> keys;
+
+    if (data!=NULL ||
+        !pageCache.IsActive() ||
+        !GetFileSize(filename,
+                     fileSize)) {
+      return;
     }
 
-    return true;
+    std::vector<FileOffset> offsets;
+
+    pageCache.GetKeys(offsets);
+
+    keys.assign(offsets.begin(),
+                offsets.end());
+
+    snapshot.AddSection(filepart,
+                        fileSize,
+                        0,
+                        keys);
   }
 
+  /**
+    Loads the index pages referenced by the given snapshot into the page cache,
+    in the order of their file offsets.
+    */
   template <class N>
-  bool NumericIndex<N>::GetOffsets(const std::set<N>& ids,
-                                   std::vector<FileOffset>& offsets) const
+  bool NumericIndex<N>::PrefetchCacheSnapshot(const CacheSnapshot& snapshot) const
   {
-    offsets.clear();
-    offsets.reserve(ids.size());
+    if (data!=NULL ||
+        !pageCache.IsActive()) {
+      return true;
+    }
 
-    for (const auto& id : ids) {
-      FileOffset offset;
+    const CacheSnapshot::Section* section=snapshot.GetSection(filepart,
+                                                              0);
 
-      if (GetOffset(id,
-                    offset)) {
-        offsets.push_back(offset);
+    if (section==NULL ||
+        !CacheSnapshot::IsValid(*section,
+                                filename)) {
+      return true;
+    }
+
+    std::vector<uint64_t> keys;
+
+    CacheSnapshot::GetPrefetchKeys(*section,
+                                   pageCache.GetMaxSize(),
+                                   keys);
+
+    std::sort(keys.begin(),
+              keys.end());
+
+    for (const auto key : keys) {
+      const unsigned char* page;
+
+      if (key%pageSize!=0 ||
+          !GetPage((FileOffset)key,
+                   page)) {
+        return false;
       }
     }
 
@@ -414,19 +682,20 @@ namespace osmscout {
   template <class N>
   void NumericIndex<N>::DumpStatistics() const
   {
-    size_t memory=0;
     size_t pages=0;
 
-    pages+=1;
-    memory+=root->entries.size()*sizeof(Entry);
+    for (const auto& level : levels) {
+      pages+=(level.entryCount+level.blockSize-1)/level.blockSize;
+    }
 
+    std::cout << "Index " << filepart << ": " << levels.size() << " levels, " << pages << " pages, ";
 
-    for (size_t i=0; i<leafs.size(); i++) {
-      pages+=leafs[i].GetSize();
-      memory+=sizeof(leafs[i])+leafs[i].GetMemory(NumericIndexCacheValueSizer());
+    if (data!=NULL) {
+      std::cout << "memory mapped" << std::endl;
+    }
+    else {
+      std::cout << "memory " << pageCache.GetMemory(NumericIndexCacheValueSizer()) << std::endl;
     }
-
-    std::cout << "Index " << filepart << ": " << pages << " pages, memory " << memory << std::endl;
   }
 }
 
@@ -0,0 +1,143 @@
+#ifndef OSMSCOUT_POIINDEX_H
+#define OSMSCOUT_POIINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/GeoBox.h>
+
+namespace osmscout {
+
+  class POIIndexVisitor;
+
+  /**
+   * \ingroup Database
+   * Index of the representative points of all objects with a type that is
+   * marked as POI (see TypeInfo::GetIndexAsPOI()).
+   *
+   * For each type there is a packed R-tree. Its leaf entries are sorted by the
+   * Hilbert value of their position and grouped into nodes of NODE_SIZE entries,
+   * the bounding boxes of the nodes of one level are again grouped into the nodes
+   * of the next higher level up to the root.
+   *
+   * Searching is done best first: Nodes and entries are visited in the order of
+   * their (minimum) distance to the search position, so only the parts of the
+   * trees near to the search position are read.
+   */
+  class OSMSCOUT_API POIIndex
+  {
+  public:
+    static const char* const FILENAME_POI_IDX;
+
+    //! Maximum number of entries of a node of the tree
+    static const size_t NODE_SIZE=32;
+
+    //! Order of the Hilbert curve used for sorting the leaf entries
+    static const size_t HILBERT_ORDER=24;
+
+    /**
+     * A POI of the index
+     */
+    struct OSMSCOUT_API Entry
+    {
+      GeoCoord      coord;  //!< The representative point of the object
+      ObjectFileRef object; //!< The object
+    };
+
+  private:
+    /**
+     * The tree of one type
+     */
+    struct TypeData
+    {
+      TypeInfoRef type;       //!< The type
+      uint32_t    entryCount; //!< Number of entries in the tree
+      FileOffset  rootOffset; //!< Offset of the root node
+    };
+
+  private:
+    std::string           datafilename; //!< Full path and name of the data file
+    mutable FileScanner   scanner;      //!< Scanner instance for reading this file
+
+    std::vector<TypeData> typeData;
+
+  public:
+    POIIndex();
+    virtual ~POIIndex();
+
+    void Close();
+    bool Load(const TypeConfig& typeConfig,
+              const std::string& path);
+
+    bool VisitNearest(const GeoCoord& coord,
+                      const TypeInfoSet& types,
+                      double maxDistance,
+                      POIIndexVisitor& visitor) const;
+
+    bool GetNearest(const GeoCoord& coord,
+                    const TypeInfoSet& types,
+                    size_t limit,
+                    double maxDistance,
+                    std::vector<Entry>& entries,
+                    std::vector<double>& distances) const;
+
+    static double GetDistance(const GeoCoord& coord,
+                              const GeoCoord& other);
+
+    static double GetDistance(const GeoCoord& coord,
+                              const GeoBox& boundingBox);
+  };
+
+  /**
+   * \ingroup Database
+   * Visitor that gets called for the entries of the POIIndex in the order of their
+   * distance to the search position.
+   */
+  class OSMSCOUT_API POIIndexVisitor
+  {
+  public:
+    virtual ~POIIndexVisitor();
+
+    /**
+     * Called for each entry
+     *
+     * @param entry
+     *    The entry
+     * @param distance
+     *    The distance of the entry to the search position in meter
+     * @return
+     *    True, if the search should continue with the next entry, else false
+     */
+    virtual bool Visit(const POIIndex::Entry& entry,
+                       double distance) = 0;
+  };
+
+  typedef std::shared_ptr<POIIndex> POIIndexRef;
+}
+
+#endif
@@ -24,12 +24,32 @@
 #include <vector>
 
 #include <osmscout/Database.h>
+#include <osmscout/RoutingProfile.h>
+#include <osmscout/RoutingService.h>
 #include <osmscout/TypeSet.h>
 
 #include <osmscout/util/GeoBox.h>
 
 namespace osmscout {
 
+  /**
+   * \ingroup Service
+   *
+   * A POI found by a nearest neighbour search
+   */
+  struct OSMSCOUT_API POIResult
+  {
+    ObjectFileRef object;        //!< The object
+    GeoCoord      coord;         //!< The representative point of the object
+    double        distance;      //!< Air distance to the search position in meter
+    double        routeDistance; //!< Length of the route from the search position in meter, if ranked by route
+    NodeRef       node;          //!< The node, if the object is a node
+    WayRef        way;           //!< The way, if the object is a way
+    AreaRef       area;          //!< The area, if the object is an area
+
+    POIResult();
+  };
+
   /**
    * \ingroup Service
    *
@@ -37,6 +57,12 @@ namespace osmscout {
    *
    * Currently this includes the following functionality:
    * - Locating POIs of given types in a given area
+   * - Locating the POIs of given types nearest to a given position, either by
+   *   air distance or by routing distance
+   *
+   * If the import has written columnar copies of the data files (see
+   * ColumnDataFile), POIs in an area are located by scanning the type and
+   * coordinate columns instead of using the area indexes.
    */
   class OSMSCOUT_API POIService
   {
@@ -55,6 +81,8 @@ namespace osmscout {
                        const TypeSet& types,
                        std::vector<WayRef>& ways) const;
 
+    bool LoadPOIs(std::vector<POIResult>& pois) const;
+
   public:
     POIService(const DatabaseRef& database);
     virtual ~POIService();
@@ -66,6 +94,20 @@ namespace osmscout {
                        std::vector<WayRef>& ways,
                        const TypeSet& areaTypes,
                        std::vector<AreaRef>& areas) const;
+
+    bool GetNearestPOIs(const GeoCoord& coord,
+                        const TypeInfoSet& types,
+                        size_t limit,
+                        double maxDistance,
+                        std::vector<POIResult>& pois) const;
+
+    bool GetNearestPOIsByRoute(RoutingService& router,
+                               const RoutingProfile& profile,
+                               const GeoCoord& coord,
+                               const TypeInfoSet& types,
+                               size_t limit,
+                               double maxDistance,
+                               std::vector<POIResult>& pois) const;
   };
 
   //! \ingroup Service
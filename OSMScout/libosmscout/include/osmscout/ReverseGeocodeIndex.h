@@ -0,0 +1,162 @@
+#ifndef OSMSCOUT_REVERSEGEOCODEINDEX_H
+#define OSMSCOUT_REVERSEGEOCODEINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   * Spatial index over the geometry of all addresses and locations (streets,...)
+   * of the location index, used to find the nearest address and the nearest
+   * location for a coordinate.
+   *
+   * The world is divided into a grid of 2^CELL_LEVEL x 2^CELL_LEVEL cells. Addresses
+   * are stored as points in the cell containing them, locations as line segments in
+   * all cells the segments cross. Non empty cells are stored ordered by their
+   * position on the Hilbert curve.
+   *
+   * Lookups are done in batches. The coordinates of a batch are sorted in Hilbert
+   * order and processed in parallel, each thread caching the cells it has already
+   * loaded. Since neighbouring coordinates mostly need the same cells, most cells are
+   * only read once per batch.
+   */
+  class OSMSCOUT_API ReverseGeocodeIndex
+  {
+  public:
+    static const char* const FILENAME_REVERSEGEOCODE_IDX;
+
+    //! Order of the Hilbert curve, the grid has 2^CELL_LEVEL cells in each dimension
+    static const size_t CELL_LEVEL=16;
+
+    //! Number of coordinates of a batch processed in one chunk by one thread
+    static const size_t CHUNK_SIZE=1024;
+
+    //! Maximum number of cells cached by a thread
+    static const size_t MAX_CACHED_CELLS=256;
+
+    /**
+     * A line segment of a location
+     */
+    struct OSMSCOUT_API Segment
+    {
+      GeoCoord   from;           //!< Start of the segment
+      GeoCoord   to;             //!< End of the segment, equal to from for locations that are nodes
+      FileOffset regionOffset;   //!< Offset of the admin region of the location
+      FileOffset locationOffset; //!< Offset of the location in the location index
+    };
+
+    /**
+     * The position of an address
+     */
+    struct OSMSCOUT_API Point
+    {
+      GeoCoord      coord;          //!< Position of the address
+      FileOffset    regionOffset;   //!< Offset of the admin region of the address
+      FileOffset    locationOffset; //!< Offset of the location of the address in the location index
+      FileOffset    addressOffset;  //!< Offset of the address in the location index
+      std::string   name;           //!< The house number
+      ObjectFileRef object;         //!< The object with the address
+    };
+
+    /**
+     * The result of a lookup for one coordinate
+     */
+    struct OSMSCOUT_API Result
+    {
+      bool       hasLocation;      //!< A location was found within the maximum distance
+      Segment    location;         //!< The segment of the nearest location
+      double     locationDistance; //!< Distance to the nearest location in meter
+
+      bool       hasAddress;       //!< An address was found within the maximum distance
+      Point      address;          //!< The nearest address
+      double     addressDistance;  //!< Distance to the nearest address in meter
+
+      Result();
+    };
+
+  private:
+    struct Cell
+    {
+      std::vector<Segment> segments;
+      std::vector<Point>   points;
+    };
+
+    typedef std::unordered_map<uint64_t,Cell> CellCache;
+
+  private:
+    std::string             path;
+    std::vector<uint64_t>   cellIds;     //!< Sorted Hilbert values of all non empty cells
+    std::vector<FileOffset> cellOffsets; //!< Offsets of the cell data
+
+  private:
+    bool LoadCell(FileScanner& scanner,
+                  size_t cellIndex,
+                  Cell& cell) const;
+
+    bool GetCachedCell(FileScanner& scanner,
+                       CellCache& cache,
+                       uint32_t x,
+                       uint32_t y,
+                       const Cell*& cell) const;
+
+    bool LookupCoord(FileScanner& scanner,
+                     CellCache& cache,
+                     const GeoCoord& coord,
+                     double maxDistance,
+                     Result& result) const;
+
+  public:
+    ReverseGeocodeIndex();
+    virtual ~ReverseGeocodeIndex();
+
+    bool Load(const std::string& path);
+
+    bool Lookup(const std::vector<GeoCoord>& coords,
+                double maxDistance,
+                std::vector<Result>& results) const;
+
+    static void GetCell(const GeoCoord& coord,
+                        uint32_t& x,
+                        uint32_t& y);
+
+    static uint64_t GetCellId(uint32_t x,
+                              uint32_t y);
+
+    static double GetDistance(const GeoCoord& coord,
+                              const GeoCoord& from,
+                              const GeoCoord& to);
+  };
+
+  typedef std::shared_ptr<ReverseGeocodeIndex> ReverseGeocodeIndexRef;
+}
+
+#endif
@@ -31,7 +31,18 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
+#include <osmscout/GeoCoord.h>
 #include <osmscout/Types.h>
 
 #define SRTM1_GRID 3601
@@ -67,6 +78,103 @@ namespace osmscout {
         const std::string& srtmFilename(int patchLat, int patchLon);
         int heightAtLocation(double latitude, double longitude);
     };
+
+    /**
+     * One memory mapped hgt file of a SRTMService
+     */
+    class OSMSCOUT_API SRTMTile
+    {
+    private:
+        int                 tileLat;
+        int                 tileLon;
+        size_t              grid;    //!< Number of samples per row and column, 0 if there is no data
+        size_t              size;    //!< Size of the file in bytes
+        const unsigned char *data;   //!< The big endian samples, row by row from north to south
+        bool                mapped;  //!< data is memory mapped, else allocated
+
+    private:
+        int GetSample(size_t row, size_t column) const;
+
+    public:
+        SRTMTile(int tileLat, int tileLon);
+        virtual ~SRTMTile();
+
+        bool Open(const std::string &filename);
+
+        inline int GetTileLat() const
+        {
+            return tileLat;
+        }
+
+        inline int GetTileLon() const
+        {
+            return tileLon;
+        }
+
+        inline bool HasData() const
+        {
+            return data!=NULL;
+        }
+
+        double GetHeight(double latitude, double longitude) const;
+    };
+
+    typedef std::shared_ptr<SRTMTile> SRTMTileRef;
+
+    /**
+     * Thread-safe access to elevation data in hgt format.
+     *
+     * Tiles are memory mapped on first use and kept in a cache holding the
+     * most recently used tiles. Heights are bilinear interpolated between
+     * the four neighbouring samples. The batch methods group the requested
+     * coordinates by tile, so each tile is only looked up once per call.
+     */
+    class OSMSCOUT_API SRTMService
+    {
+    public:
+        //! Default number of cached tiles
+        static const size_t DEFAULT_CACHE_SIZE = 16;
+
+    private:
+        typedef std::list<SRTMTileRef>                          TileList;
+        typedef std::unordered_map<uint64_t,TileList::iterator> TileMap;
+
+    private:
+        std::string        srtmPath;
+        size_t             cacheSize;
+        mutable TileList   tiles;     //!< Cached tiles, most recently used first
+        mutable TileMap    tileMap;   //!< Cached tiles by tile key
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        mutable std::mutex cacheMutex;
+#endif
+
+    private:
+        static uint64_t GetTileKey(int tileLat, int tileLon);
+
+        SRTMTileRef GetTile(int tileLat, int tileLon) const;
+
+    public:
+        SRTMService(const std::string &path,
+                    size_t cacheSize = DEFAULT_CACHE_SIZE);
+        virtual ~SRTMService();
+
+        static std::string GetTileFilename(int tileLat, int tileLon);
+
+        double GetHeight(const GeoCoord &coord) const;
+
+        void GetHeights(const std::vector<GeoCoord> &coords,
+                        std::vector<double> &heights) const;
+
+        void GetProfile(const std::vector<GeoCoord> &polyline,
+                        double sampleDistance,
+                        std::vector<GeoCoord> &coords,
+                        std::vector<double> &distances,
+                        std::vector<double> &heights) const;
+
+        void FlushCache();
+    };
+
+    typedef std::shared_ptr<SRTMService> SRTMServiceRef;
 }
 
 #endif
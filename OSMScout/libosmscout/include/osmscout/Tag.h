@@ -24,6 +24,8 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <osmscout/private/CoreImportExport.h>
 
@@ -36,7 +38,85 @@ namespace osmscout {
 
   typedef uint16_t TagId;
 
-  typedef std::unordered_map<TagId,std::string> TagMap;
+  /**
+   * \ingroup type
+   *
+   * Map of tag ids to tag values of an object.
+   *
+   * Objects only have a few tags, so the map is implemented as a flat vector of
+   * entries sorted by tag id instead of a hash table. Clearing the map only
+   * resets the number of entries, the entries themselves are kept and reused,
+   * so that filling the map for the next object reuses the allocated nodes and
+   * string buffers instead of allocating new ones.
+   *
+   * The interface is a subset of the interface of std::unordered_map.
+   */
+  class OSMSCOUT_API TagMap
+  {
+  public:
+    typedef std::pair<TagId,std::string>            value_type;
+    typedef std::vector<value_type>::iterator       iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+  private:
+    std::vector<value_type> entries; //!< Entries, only the first 'count' entries are valid
+    size_t                  count;   //!< Number of valid entries
+
+  private:
+    size_t GetIndex(TagId tag) const;
+
+  public:
+    TagMap();
+    TagMap(const TagMap& other);
+
+    TagMap& operator=(const TagMap& other);
+
+    inline iterator begin()
+    {
+      return entries.begin();
+    }
+
+    inline iterator end()
+    {
+      return entries.begin()+count;
+    }
+
+    inline const_iterator begin() const
+    {
+      return entries.begin();
+    }
+
+    inline const_iterator end() const
+    {
+      return entries.begin()+count;
+    }
+
+    inline bool empty() const
+    {
+      return count==0;
+    }
+
+    inline size_t size() const
+    {
+      return count;
+    }
+
+    inline void clear()
+    {
+      count=0;
+    }
+
+    iterator find(TagId tag);
+    const_iterator find(TagId tag) const;
+
+    std::string& operator[](TagId tag);
+
+    void Set(TagId tag,
+             const char* value,
+             size_t length);
+
+    void erase(TagId tag);
+  };
 
   /**
    * \ingroup type
@@ -45,6 +125,30 @@ namespace osmscout {
    */
   static const TagId tagIgnore        = 0;
 
+  /**
+   * \ingroup type
+   *
+   * Describes the tags and tag values that trigger a tag condition: the condition
+   * can only be fulfilled, if the tag map contains at least one of the given tags
+   * (with an arbitrary value) or at least one of the given tag/value pairs.
+   *
+   * If 'unrestricted' is true, the condition might be fulfilled by any tag map
+   * (for example for negations). If 'exact' is true, the condition is fulfilled
+   * if and only if one of the triggers matches, so that the condition does not
+   * need to be evaluated at all.
+   */
+  struct OSMSCOUT_API TagConditionTriggers
+  {
+    bool                                        unrestricted;
+    bool                                        exact;
+    std::set<TagId>                             tags;
+    std::set<std::pair<TagId,std::string>>      values;
+
+    TagConditionTriggers();
+
+    void SetUnrestricted();
+  };
+
   /**
    * \ingroup type
    *
@@ -56,6 +160,8 @@ namespace osmscout {
     virtual ~TagCondition();
 
     virtual bool Evaluate(const TagMap& tagMap) const = 0;
+
+    virtual void GetTriggers(TagConditionTriggers& triggers) const;
   };
 
   /**
@@ -79,6 +185,7 @@ namespace osmscout {
     TagNotCondition(TagCondition* condition);
 
     bool Evaluate(const TagMap& tagMap) const;
+    void GetTriggers(TagConditionTriggers& triggers) const;
   };
 
   /**
@@ -105,6 +212,7 @@ namespace osmscout {
     void AddCondition(TagCondition* condition);
 
     bool Evaluate(const TagMap& tagMap) const;
+    void GetTriggers(TagConditionTriggers& triggers) const;
   };
 
   /**
@@ -121,6 +229,7 @@ namespace osmscout {
     TagExistsCondition(TagId tag);
 
     bool Evaluate(const TagMap& tagMap) const;
+    void GetTriggers(TagConditionTriggers& triggers) const;
   };
 
   /**
@@ -153,6 +262,7 @@ namespace osmscout {
                        const size_t& tagValue);
 
     bool Evaluate(const TagMap& tagMap) const;
+    void GetTriggers(TagConditionTriggers& triggers) const;
   };
 
   /**
@@ -173,6 +283,7 @@ namespace osmscout {
     void AddTagValue(const std::string& tagValue);
 
     bool Evaluate(const TagMap& tagMap) const;
+    void GetTriggers(TagConditionTriggers& triggers) const;
   };
 
   /**
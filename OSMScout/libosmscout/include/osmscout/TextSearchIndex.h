@@ -20,7 +20,10 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <set>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <osmscout/TypeSet.h>
 #include <osmscout/ObjectRef.h>
@@ -31,6 +34,28 @@
 
 namespace osmscout
 {
+  /**
+   \ingroup Database
+   Visitor receiving the results of a fuzzy search
+   in the TextSearchIndex
+   */
+  class OSMSCOUT_API TextSearchVisitor
+  {
+  public:
+    virtual ~TextSearchVisitor();
+
+    /**
+     * Called for each object of a result text. Texts are visited
+     * ordered by their edit distance to the query and their length.
+     *
+     * @return
+     *    false, if the search should be stopped
+     */
+    virtual bool Visit(const std::string& text,
+                       const ObjectFileRef& object,
+                       size_t distance) = 0;
+  };
+
   /**
    \ingroup Database
    A class that allows prefix-based searching
@@ -41,9 +66,9 @@ namespace osmscout
   private:
     struct TrieInfo
     {
-      marisa::Trie *trie;
-      std::string  file;
-      bool         isAvail;
+      marisa::Trie             *trie;
+      std::string              file;
+      bool                     isAvail;
 
       TrieInfo() :
         trie(NULL),
@@ -53,6 +78,24 @@ namespace osmscout
       }
     };
 
+    /**
+     * A node of the trie visited during fuzzy search or, if isText is set,
+     * the text ending at the node
+     */
+    struct FuzzySearchNode
+    {
+      size_t                     trieIndex;
+      std::string                prefix;   //! The text of the node
+      size_t                     length;   //! Length of the prefix in characters
+      std::vector<size_t>        row;      //! Edit distances of all prefixes of the query to the prefix
+      size_t                     distance; //! Smallest edit distance of the query to the prefix or one of its prefixes
+      size_t                     bound;    //! Lower bound of the distance of all texts starting with the prefix
+      bool                       isText;   //! Entry for the text ending at this node
+      std::vector<ObjectFileRef> refs;     //! Objects having the text, if isText is set
+
+      bool operator>(const FuzzySearchNode& other) const;
+    };
+
   public:
     typedef std::unordered_map<std::string,std::vector<ObjectFileRef> > ResultsMap;
 
@@ -69,11 +112,28 @@ namespace osmscout
                 bool searchOther,
                 ResultsMap& results) const;
 
+    bool Search(const std::string& query,
+                bool searchPOIs,
+                bool searchLocations,
+                bool searchRegions,
+                bool searchOther,
+                size_t maxDistance,
+                size_t limit,
+                TextSearchVisitor& visitor) const;
+
+    static void SplitIntoCharacters(const std::string& text,
+                                    std::vector<std::string>& characters);
+
   private:
     void splitSearchResult(const std::string& result,
                            std::string& text,
                            ObjectFileRef& ref) const;
 
+    void getChildren(const TrieInfo& trie,
+                     const std::string& prefix,
+                     std::set<std::string>& characters,
+                     std::vector<ObjectFileRef>& refs) const;
+
 
     uint8_t               offsetSizeBytes;  //! size in bytes of FileOffsets stored in the tries
     std::vector<TrieInfo> tries;
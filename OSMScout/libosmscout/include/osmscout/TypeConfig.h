@@ -911,6 +911,8 @@ namespace osmscout {
     FeatureValue* AllocateValue(size_t idx);
     void FreeValue(size_t idx);
 
+    size_t GetMemory() const;
+
     void Parse(Progress& progress,
                const TypeConfig& typeConfig,
                const ObjectOSMRef& object,
@@ -928,6 +930,71 @@ namespace osmscout {
     bool operator!=(const FeatureValueBuffer& other) const;
   };
 
+  /**
+   * \ingroup type
+   *
+   * Compiled form of the type conditions of a TypeConfig for one kind of object
+   * (node, way/area, relation). Returns the first type condition (in declaration
+   * order) that is fulfilled by a given tag map.
+   *
+   * During compilation the triggers of each condition are collected into a table
+   * indexed by tag id. For each tag there is a bitset of conditions triggered by
+   * the tag with any value and a bitset per (interned) tag value. Classification
+   * merges the bitsets of all tags of the object to a bitset of candidate conditions
+   * and only evaluates these (in declaration order). Conditions that are completely
+   * described by their triggers (EXISTS, == and IN) are not evaluated at all.
+   */
+  class OSMSCOUT_API TypeClassifier
+  {
+  public:
+    struct Rule
+    {
+      TypeInfoRef     type;      //!< The type to assign
+      TagConditionRef condition; //!< The condition to fulfill
+      unsigned char   types;     //!< Bitset of object types the condition applies to
+      bool            exact;     //!< If true, the condition is fulfilled if it is a candidate
+    };
+
+  private:
+    typedef std::vector<uint64_t> Bitset;
+
+    struct TagEntry
+    {
+      Bitset                                  anyValue; //!< Rules triggered by the tag with any value
+      std::unordered_map<std::string,size_t>  valueIds; //!< Interned values of the tag
+      std::vector<Bitset>                     values;   //!< Rules triggered by the tag with the given value id
+    };
+
+  private:
+    std::vector<Rule>     rules;
+    size_t                wordCount;
+    Bitset                unrestricted;
+    std::vector<TagEntry> tagEntries;
+    bool                  compiled;
+
+  private:
+    void SetRule(Bitset& bitset,
+                 size_t index) const;
+
+  public:
+    TypeClassifier();
+
+    void Clear();
+
+    void AddRule(const TypeInfoRef& type,
+                 const TagConditionRef& condition,
+                 unsigned char types);
+
+    void Compile();
+
+    inline bool IsCompiled() const
+    {
+      return compiled;
+    }
+
+    const Rule* Classify(const TagMap& tagMap) const;
+  };
+
   /**
    * \ingroup type
    *
@@ -984,6 +1051,13 @@ namespace osmscout {
     FeatureRef                                  featureTunnel;
     FeatureRef                                  featureRoundabout;
 
+    // Compiled type conditions
+
+    TypeClassifier                              nodeClassifier;
+    TypeClassifier                              wayAreaClassifier;
+    TypeClassifier                              multipolygonClassifier;
+    TypeClassifier                              relationClassifier;
+
   public:
     // Internal use (only available during preprocessing)
     TagId                                       tagArea;
@@ -1014,6 +1088,7 @@ namespace osmscout {
                              uint32_t priority);
 
     TagId GetTagId(const char* name) const;
+    TagId GetTagId(const std::string& name) const;
 
     bool IsNameTag(TagId tag,
                    uint32_t& priority) const;
@@ -1174,6 +1249,9 @@ namespace osmscout {
      * type.
      */
     TypeInfoRef GetRelationType(const TagMap& tagMap) const;
+
+    void CompileConditions();
+    void ClearCompiledConditions();
     //@}
 
     /**
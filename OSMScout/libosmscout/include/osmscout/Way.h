@@ -43,7 +43,7 @@ namespace osmscout {
 
   public:
     std::vector<Id>       ids;
-    std::vector<GeoCoord> nodes;
+    std::vector<CompactGeoCoord> nodes;
 
   public:
     inline Way()
@@ -124,6 +124,8 @@ namespace osmscout {
 
     void SetLayerToMax();
 
+    size_t GetMemory() const;
+
     bool Read(const TypeConfig& typeConfig,
               FileScanner& scanner);
     bool ReadOptimized(const TypeConfig& typeConfig,
@@ -26,6 +26,12 @@
 #include <osmscout/Way.h>
 
 namespace osmscout {
+
+  inline unsigned long GetDataMemory(const Way& way)
+  {
+    return (unsigned long)way.GetMemory();
+  }
+
   /**
     \ingroup Database
     Abstraction for getting cached access to the 'ways.dat' file.
@@ -43,6 +43,15 @@
 /* Support mmx instructions */
 /* #undef HAVE_MMX */
 
+/* Define to 1 if you have the `pread' function. */
+#define HAVE_PREAD 1
+
+/* Define to 1 if you have the `fopencookie' function. */
+#define HAVE_FOPENCOOKIE 1
+
+/* Define to 1 if you have the `funopen' function. */
+/* #undef HAVE_FUNOPEN */
+
 /* Define to 1 if you have the `posix_fadvise' function. */
 #define HAVE_POSIX_FADVISE 1
 
@@ -144,6 +153,9 @@
 /* libmarisa detected */
 /* #undef OSMSCOUT_HAVE_LIB_MARISA */
 
+/* zlib detected */
+/* #undef OSMSCOUT_HAVE_LIB_ZLIB */
+
 /* math function log2(double) is available */
 #define OSMSCOUT_HAVE_LOG2 1
 
@@ -0,0 +1,109 @@
+#ifndef OSMSCOUT_UTIL_BLOCKCOMPRESSION_H
+#define OSMSCOUT_UTIL_BLOCKCOMPRESSION_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdio>
+#include <string>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/CoreFeatures.h>
+
+#include <osmscout/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup File
+   * Support for block compressed files.
+   *
+   * A block compressed file holds the content of a normal file split into
+   * blocks of a fixed (uncompressed) size, each block compressed on its own
+   * using zlib. A block index at the end of the file maps the blocks to
+   * their position in the file, so the content can be read at any offset by
+   * only decompressing the block(s) containing the requested data.
+   *
+   * FileWriter::SetBlockCompression() converts a file into the block
+   * compressed format when it is closed. FileScanner detects block compressed
+   * files on Open() and transparently reads the uncompressed content, so
+   * offsets stay the same and existing readers work unchanged. Block
+   * compressed files are never memory mapped.
+   *
+   * Decompressed blocks are held in a LRU cache shared by all open block
+   * compressed files. All streams of the same file share its cached blocks,
+   * the blocks of a file are removed when its last stream is closed.
+   *
+   * Block compression is only available if the library has been configured
+   * with zlib (OSMSCOUT_HAVE_LIB_ZLIB) and the platform supports custom
+   * stdio streams (fopencookie() or funopen()), see IsSupported().
+   *
+   * File format (all numbers little endian):
+   * * 8 bytes magic
+   * * uint32 size of an uncompressed block
+   * * uint64 size of the uncompressed content
+   * * uint64 offset of the block index
+   * * The compressed blocks. A block is stored uncompressed if compression
+   *   does not reduce its size.
+   * * The block index: uint64 offset of each block followed by the offset of
+   *   the end of the last block.
+   */
+  class OSMSCOUT_API BlockCompression
+  {
+  public:
+    static const size_t DEFAULT_BLOCK_SIZE=128*1024;  //!< Default size of an uncompressed block
+    static const size_t DEFAULT_CACHE_SIZE=256;       //!< Default number of cached decompressed blocks
+
+    /**
+     * Counters for the access to block compressed files
+     */
+    struct Statistics
+    {
+      uint64_t blocksDecompressed;  //!< Number of blocks read from disk and decompressed
+      uint64_t compressedBytesRead; //!< Number of (compressed) bytes read from disk
+      uint64_t cacheHits;           //!< Number of block accesses served from the cache
+    };
+
+  public:
+    static bool IsSupported();
+
+    static bool IsCompressed(std::FILE* file);
+    static bool IsCompressed(const std::string& filename);
+
+    static bool GetDataSize(const std::string& filename,
+                            FileOffset& size);
+
+    static bool CompressFile(const std::string& filename,
+                             size_t blockSize);
+
+    static std::FILE* OpenStream(std::FILE* file,
+                                 const std::string& filename,
+                                 FileOffset& size);
+
+    static void SetCacheSize(size_t blocks);
+    static size_t GetCacheSize();
+    static void FlushCache();
+
+    static void GetStatistics(Statistics& statistics);
+    static void ResetStatistics();
+  };
+}
+
+#endif
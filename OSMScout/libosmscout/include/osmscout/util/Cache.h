@@ -26,15 +26,204 @@
 
 #include <limits>
 #include <list>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <atomic>
+#endif
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
+#include <osmscout/private/CoreImportExport.h>
+
 #include <osmscout/system/Assert.h>
+#include <osmscout/system/Types.h>
 
 #include <osmscout/Types.h>
 
 namespace osmscout {
 
+  class CacheManager;
+
+  /**
+   * \ingroup Util
+   * State of a cache whose memory limit can be controlled by a CacheManager.
+   *
+   * The cache publishes its usage and counts its lookups here, the manager
+   * only changes the memory limit. Both can be done from different threads,
+   * the cache applies a changed limit on its next access.
+   */
+  class OSMSCOUT_API ManagedCache
+  {
+  private:
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::atomic<CacheManager*> manager;   //!< The manager the cache is registered at, or NULL
+    std::atomic<unsigned long> maxMemory; //!< Memory limit, 0 if the number of entries is limited
+    std::atomic<unsigned long> entries;   //!< Number of entries, as published by the cache
+    std::atomic<unsigned long> memory;    //!< Memory used by the entries, as published by the cache
+    std::atomic<uint64_t>      hits;      //!< Number of lookups served from the cache
+    std::atomic<uint64_t>      misses;    //!< Number of lookups not served from the cache
+#else
+    CacheManager*              manager;
+    unsigned long              maxMemory;
+    unsigned long              entries;
+    unsigned long              memory;
+    uint64_t                   hits;
+    uint64_t                   misses;
+#endif
+
+  protected:
+    void PublishUsage(unsigned long entries,
+                      unsigned long memory);
+    void NotifyHit();
+    void NotifyMiss();
+
+  public:
+    ManagedCache();
+    ManagedCache(const ManagedCache& other);
+    virtual ~ManagedCache();
+
+    ManagedCache& operator=(const ManagedCache& other);
+
+    void SetManager(CacheManager* manager);
+
+    /**
+     * Returns the number of entries in the cache
+     */
+    inline unsigned long GetEntryCount() const
+    {
+      return entries;
+    }
+
+    /**
+     * Returns the memory (in bytes) used by the entries of the cache
+     */
+    inline unsigned long GetUsedMemory() const
+    {
+      return memory;
+    }
+
+    /**
+     * Returns the current memory limit of the cache (in bytes), 0 if the
+     * cache is limited by its number of entries
+     */
+    inline unsigned long GetMaxMemory() const
+    {
+      return maxMemory;
+    }
+
+    void SetMaxMemory(unsigned long maxMemory);
+
+    /**
+     * Returns the number of lookups that were served from the cache
+     */
+    inline uint64_t GetHits() const
+    {
+      return hits;
+    }
+
+    /**
+     * Returns the number of lookups that were not served from the cache
+     */
+    inline uint64_t GetMisses() const
+    {
+      return misses;
+    }
+  };
+
+  /**
+   * \ingroup Util
+   * Distributes a global memory budget between a number of caches.
+   *
+   * Each registered cache gets a memory limit, the sum of all limits does
+   * not exceed the budget. Every GetRebalanceInterval() cache misses (or on an
+   * explicit call of Rebalance()) the manager moves memory from the cache that
+   * profits least from its memory to the cache that profits most. The benefit
+   * of a cache is estimated by the number of hits per byte of cached data since the
+   * last rebalancing. Caches without misses cannot profit from more memory and
+   * caches that are not (nearly) full do not need more memory.
+   *
+   * Each cache keeps at least a minimum share of the budget and its most recently
+   * used entry, so the budget can be exceeded by the size of a single entry per cache.
+   *
+   * The manager only changes the memory limits, each cache removes entries
+   * exceeding its limit on its own next access. So caches used by different
+   * threads can share a manager as long as each cache is only used by one
+   * thread at a time.
+   */
+  class OSMSCOUT_API CacheManager
+  {
+  public:
+    static const size_t DEFAULT_REBALANCE_INTERVAL=1000; //!< Default number of cache misses between two rebalancings
+
+    /**
+     * Current state of a registered cache
+     */
+    struct OSMSCOUT_API CacheStatistics
+    {
+      std::string   name;      //!< Name of the cache
+      unsigned long entries;   //!< Number of entries
+      unsigned long memory;    //!< Memory used by the entries (in bytes)
+      unsigned long maxMemory; //!< Memory currently assigned to the cache (in bytes)
+      uint64_t      hits;      //!< Number of lookups served from the cache
+      uint64_t      misses;    //!< Number of lookups not served from the cache
+
+      double GetHitRate() const;
+    };
+
+  private:
+    struct ManagedEntry
+    {
+      std::string   name;   //!< Name of the cache
+      ManagedCache* cache;  //!< The cache
+      uint64_t      hits;   //!< Hits of the cache at the last rebalancing
+      uint64_t      misses; //!< Misses of the cache at the last rebalancing
+    };
+
+  private:
+    unsigned long             memoryBudget;      //!< Memory to distribute between the caches (in bytes)
+    size_t                    rebalanceInterval; //!< Number of cache misses between two rebalancings
+    size_t                    missCount;         //!< Number of cache misses since the last rebalancing
+    std::vector<ManagedEntry> caches;            //!< The registered caches
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    mutable std::mutex        mutex;             //!< Guards the manager state
+#endif
+
+  private:
+    unsigned long GetMinCacheMemory() const;
+    unsigned long GetAssignedMemory() const;
+    void RebalanceLocked();
+
+  public:
+    CacheManager(unsigned long memoryBudget);
+    virtual ~CacheManager();
+
+    void SetMemoryBudget(unsigned long memoryBudget);
+    unsigned long GetMemoryBudget() const;
+
+    void SetRebalanceInterval(size_t rebalanceInterval);
+    size_t GetRebalanceInterval() const;
+
+    void Register(const std::string& name,
+                  ManagedCache& cache);
+    void Unregister(ManagedCache& cache);
+
+    void CacheMiss();
+    void Rebalance();
+
+    unsigned long GetUsedMemory() const;
+    void GetStatistics(std::vector<CacheStatistics>& statistics) const;
+
+    void DumpStatistics() const;
+  };
+
+  typedef std::shared_ptr<CacheManager> CacheManagerRef;
+
   /**
    * \ingroup Util
    * Generic FIFO cache implementation with O(n log n) semantic.
@@ -53,9 +242,16 @@ namespace osmscout {
    * available, we use a vector as a hashtable via the key value with list
    * as entry type for hash code conflict handling.
    *
+   * The cache is either limited by the number of entries or - if a memory limit
+   * is set via SetMaxMemory() - by the memory used by its entries. A changed memory
+   * limit is applied on the next access of the cache. The memory of
+   * an entry is the bookkeeping overhead of the cache plus the size of the value
+   * as returned by the ValueSizer set via SetValueSizer() (or sizeof(V) if no sizer is set).
+   * If a value is filled after it has been added to the cache, UpdateMemory() must be
+   * called for the entry. The memory limit can be controlled by a CacheManager.
    */
   template <class K, class V, class IK = PageId>
-  class Cache
+  class Cache : public ManagedCache
   {
   public:
     /**
@@ -63,18 +259,21 @@ namespace osmscout {
       */
     struct CacheEntry
     {
-      K key;
-      V value;
+      K             key;
+      V             value;
+      unsigned long memory; //!< Memory accounted for the entry
 
       CacheEntry(const CacheEntry& entry)
       : key(entry.key),
-        value(entry.value)
+        value(entry.value),
+        memory(entry.memory)
       {
         // no code
       }
 
       CacheEntry(const K& key)
-      : key(key)
+      : key(key),
+        memory(0)
       {
         // no code
       }
@@ -82,7 +281,8 @@ namespace osmscout {
       CacheEntry(const K& key,
                  const V& value)
       : key(key),
-        value(value)
+        value(value),
+        memory(0)
       {
         // no code
       }
@@ -108,10 +308,12 @@ namespace osmscout {
     typedef std::unordered_map<K,typename OrderList::iterator> Map;
 
   private:
-    unsigned long size;
-    unsigned long maxSize;
-    OrderList     order;
-    Map           map;
+    unsigned long     size;
+    unsigned long     maxSize;
+    unsigned long     memory;    //!< Memory used by all entries
+    const ValueSizer* sizer;     //!< Optional sizer for the values, not owned
+    OrderList         order;
+    Map               map;
 
   private:
 
@@ -121,13 +323,45 @@ namespace osmscout {
     }
 
 
+    /**
+      Returns the memory accounted for an entry with the given value: the list node
+      (entry and two pointers), the hash map node (key, iterator and
+      a pointer) and the (dynamic) size of the value.
+      */
+    unsigned long GetEntryMemory(const V& value) const
+    {
+      unsigned long entryMemory=sizeof(CacheEntry)-sizeof(V)+2*sizeof(void*)+
+                                sizeof(typename Map::value_type)+sizeof(void*);
+
+      if (sizer!=NULL) {
+        entryMemory+=sizer->GetSize(value);
+      }
+      else {
+        entryMemory+=sizeof(V);
+      }
+
+      return entryMemory;
+    }
+
+    bool IsOverLimit() const
+    {
+      unsigned long maxMemory=GetMaxMemory();
+
+      if (maxMemory>0) {
+        // Always keep the most recently used entry
+        return size>1 && memory>maxMemory;
+      }
+
+      return size>maxSize;
+    }
+
     /**
       Clear the cache deleting the oldest cache entries
-      until it has the given max size.
+      until it has the given max size (or max memory).
       */
     void StripCache()
     {
-      while (size>maxSize) {
+      while (IsOverLimit()) {
         // Remove oldest entry from cache...
 
         // Get oldest entry
@@ -138,10 +372,14 @@ namespace osmscout {
         assert(iter!=map.end());
 
         map.erase(iter);
+        memory-=lastEntry->memory;
         // Remove it from order list
         order.pop_back();
         size--;
       }
+
+      PublishUsage(size,
+                   memory);
     }
 
   public:
@@ -150,17 +388,29 @@ namespace osmscout {
       */
     Cache(unsigned long maxSize)
      : size(0),
-       maxSize(maxSize)
+       maxSize(maxSize),
+       memory(0),
+       sizer(NULL)
     {
       map.reserve(maxSize);
     }
 
     /**
-     * Returns if the cache is active (maxSize > 0)
+     * Set the sizer used for calculating the memory of the cached values. The
+     * sizer must live as long as the cache. Should be called before the first
+     * entry is added.
+     */
+    void SetValueSizer(const ValueSizer* sizer)
+    {
+      this->sizer=sizer;
+    }
+
+    /**
+     * Returns if the cache is active (maxSize > 0 or maxMemory > 0)
      */
     bool IsActive() const
     {
-      return maxSize>0;
+      return maxSize>0 || GetMaxMemory()>0;
     }
 
     /**
@@ -191,9 +441,16 @@ namespace osmscout {
 
         reference=order.begin();
 
+        // Apply a reduced memory limit, the entry is the most recently used one
+        StripCache();
+
+        NotifyHit();
+
         return true;
       }
 
+      NotifyMiss();
+
       return false;
     }
 
@@ -207,7 +464,7 @@ namespace osmscout {
     typename Cache::CacheRef SetEntry(const CacheEntry& entry)
     {
       if (!IsActive()) {
-        order.clear();
+        Flush();
 
         order.push_front(entry);
 
@@ -223,11 +480,18 @@ namespace osmscout {
         // Update the map with the new iterator into the order list
         iter->second=order.begin();
 
+        memory-=order.front().memory;
         order.front().value=entry.value;
+        order.front().memory=GetEntryMemory(order.front().value);
+        memory+=order.front().memory;
+
+        StripCache();
       }
       else {
         // Place key/value to the start of the order list
         order.push_front(entry);
+        order.front().memory=GetEntryMemory(order.front().value);
+        memory+=order.front().memory;
         size++;
         // Update the map with the new iterator into the order list
         map[entry.key]=order.begin();
@@ -238,6 +502,44 @@ namespace osmscout {
       return order.begin();
     }
 
+    /**
+      Recalculate the memory of the given entry after its value has been
+      filled in place, possibly striping the oldest entries from the cache.
+      The entry must be the most recently used entry, which is never striped.
+      */
+    void UpdateMemory(const CacheRef& reference)
+    {
+      if (!IsActive()) {
+        return;
+      }
+
+      memory-=reference->memory;
+      reference->memory=GetEntryMemory(reference->value);
+      memory+=reference->memory;
+
+      StripCache();
+    }
+
+    /**
+      Remove the entry with the given key from the cache, if it is cached.
+      */
+    void RemoveEntry(const K& key)
+    {
+      typename Map::iterator iter=map.find(key);
+
+      if (iter==map.end()) {
+        return;
+      }
+
+      memory-=iter->second->memory;
+      order.erase(iter->second);
+      map.erase(iter);
+      size--;
+
+      PublishUsage(size,
+                   memory);
+    }
+
     /**
       Set a new cache max size, possible striping the oldest entries
       from cache if the new size is smaller than the old one.
@@ -259,6 +561,10 @@ namespace osmscout {
       order.clear();
       map.clear();
       size=0;
+      memory=0;
+
+      PublishUsage(size,
+                   memory);
     }
 
     /**
@@ -269,6 +575,56 @@ namespace osmscout {
       return size;
     }
 
+    /**
+      Returns the current max size of the cache.
+      */
+    unsigned long GetMaxSize() const
+    {
+      return maxSize;
+    }
+
+    /**
+      Returns the keys of all entries currently in the cache, the most
+      recently used entry first.
+      */
+    void GetKeys(std::vector<K>& keys) const
+    {
+      keys.clear();
+
+      if (!IsActive()) {
+        return;
+      }
+
+      keys.reserve(size);
+
+      for (typename std::list<CacheEntry>::const_iterator entry=order.begin();
+           entry!=order.end();
+           ++entry) {
+        keys.push_back(entry->key);
+      }
+    }
+
+    /**
+      Returns copies of all entries currently in the cache, the most
+      recently used entry first.
+      */
+    void GetEntries(std::vector<CacheEntry>& entries) const
+    {
+      entries.clear();
+
+      if (!IsActive()) {
+        return;
+      }
+
+      entries.reserve(size);
+
+      for (typename std::list<CacheEntry>::const_iterator entry=order.begin();
+           entry!=order.end();
+           ++entry) {
+        entries.push_back(*entry);
+      }
+    }
+
     unsigned long GetMemory(const ValueSizer& sizer) const
     {
       unsigned long memory=0;
@@ -293,7 +649,7 @@ namespace osmscout {
       */
     void DumpStatistics(const char* cacheName, const ValueSizer& sizer)
     {
-      std::cout << cacheName << " entries: " << size << ", memory " << GetMemory(sizer) << std::endl;
+      std::cout << cacheName << " entries: " << size << ", memory " << GetMemory(sizer) << ", hits " << GetHits() << ", misses " << GetMisses() << std::endl;
     }
   };
 }
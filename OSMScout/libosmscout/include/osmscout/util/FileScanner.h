@@ -33,6 +33,7 @@
 #include <osmscout/Types.h>
 
 #include <osmscout/util/GeoBox.h>
+#include <osmscout/util/Logger.h>
 
 #if defined(__WIN32__) || defined(WIN32)
   #include <windows.h>
@@ -52,6 +53,22 @@ namespace osmscout {
     mapping the complete file into the memory of the process (without
     allocating real memory) resulting in measurable speed increase because of
     exchanging buffered file access with in memory array access.
+
+    If the file is not memory mapped, data can also be read at a given
+    offset without changing the current file position (ReadAt()). A buffer
+    filled this way can be attached as window (SetWindow()), so that the
+    normal Read methods decode from the buffer instead of the file until
+    the window is removed again (ClearWindow()).
+
+    Block compressed files (see BlockCompression) are detected on Open() and
+    read transparently: offsets and the size of the file refer to the
+    uncompressed content. Such files are neither memory mapped nor can they
+    be read using ReadAt().
+
+    Sequences of variable length encoded numbers can be read in one go
+    (ReadNumbers(), ReadNumbersDelta()). If the data is read from memory
+    (memory mapped file or window) the numbers are decoded in bulk using
+    DecodeNumbers().
     */
   class OSMSCOUT_API FileScanner
   {
@@ -68,12 +85,18 @@ namespace osmscout {
     std::string  filename;
     std::FILE    *file;
     mutable bool hasError;
+    bool         compressed;     //!< true, if the file is block compressed
 
     // For mmap usage
     char         *buffer;
     FileOffset   size;
     FileOffset   offset;
 
+    // For window usage
+    bool         windowed;       //!< true, if buffer points to a window set by SetWindow()
+    FileOffset   windowStart;    //!< File offset of the first byte of the window
+    FileOffset   windowFileSize; //!< Size of the file, while size holds the size of the window
+
     // For Windows mmap usage
 #if defined(__WIN32__) || defined(WIN32)
     HANDLE       mmfHandle;
@@ -81,6 +104,11 @@ namespace osmscout {
 
   private:
     void FreeBuffer();
+    Logger::Line ReadError() const;
+    bool ReadCoordDeltas(const GeoCoord& minCoord,
+                         std::vector<GeoCoord>& nodes);
+    bool ReadCoordDeltas(const CompactGeoCoord& minCoord,
+                         std::vector<CompactGeoCoord>& nodes);
 
   public:
     FileScanner();
@@ -98,6 +126,25 @@ namespace osmscout {
 
     bool IsEOF() const;
 
+    inline bool IsCompressed() const
+    {
+      return compressed;
+    }
+
+    inline bool IsMemoryMapped() const
+    {
+      return buffer!=NULL && !windowed;
+    }
+
+    /**
+     * Returns the start of the memory mapped file content, or NULL if the
+     * file is not memory mapped. The data is valid until the file is closed.
+     */
+    inline const char* GetMappedData() const
+    {
+      return IsMemoryMapped() ? buffer : NULL;
+    }
+
     inline  bool HasError() const
     {
       return file==NULL || hasError;
@@ -109,6 +156,18 @@ namespace osmscout {
     bool SetPos(FileOffset pos);
     bool GetPos(FileOffset &pos) const;
 
+    FileOffset GetSize() const;
+
+    bool CanReadAt() const;
+    bool ReadAt(FileOffset pos,
+                char* buffer,
+                size_t bytes) const;
+
+    void SetWindow(FileOffset start,
+                   char* data,
+                   size_t size);
+    void ClearWindow();
+
     bool Read(char* buffer, size_t bytes);
 
     bool Read(std::string& value);
@@ -153,13 +212,31 @@ namespace osmscout {
     bool ReadNumber(uint64_t& number);
 #endif
 
+    bool ReadNumbers(uint32_t* numbers,
+                     size_t count);
+#if defined(OSMSCOUT_HAVE_UINT64_T)
+    bool ReadNumbers(uint64_t* numbers,
+                     size_t count);
+#endif
+
+    bool ReadNumbersDelta(uint32_t* numbers,
+                          size_t count);
+#if defined(OSMSCOUT_HAVE_UINT64_T)
+    bool ReadNumbersDelta(uint64_t* numbers,
+                          size_t count);
+#endif
+
     bool ReadCoord(GeoCoord& coord);
+    bool ReadCoord(CompactGeoCoord& coord);
     bool ReadConditionalCoord(GeoCoord& coord,
                               bool& isSet);
 
     bool Read(std::vector<GeoCoord>& nodes);
     bool Read(std::vector<GeoCoord>& nodes,
               size_t count);
+    bool Read(std::vector<CompactGeoCoord>& nodes);
+    bool Read(std::vector<CompactGeoCoord>& nodes,
+              size_t count);
 
     bool ReadBox(GeoBox& box);
 
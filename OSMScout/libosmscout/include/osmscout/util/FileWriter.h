@@ -47,6 +47,7 @@ namespace osmscout {
     std::string filename;
     std::FILE   *file;
     bool        hasError;
+    size_t      compressionBlockSize; //!< Block size for block compression on Close(), 0 for no compression
 
   public:
     FileWriter();
@@ -54,6 +55,9 @@ namespace osmscout {
 
     bool Open(const std::string& filename);
     bool Close();
+
+    void SetBlockCompression(size_t blockSize);
+
     inline bool IsOpen() const
     {
       return file!=NULL;
@@ -114,11 +118,15 @@ namespace osmscout {
 #endif
 
     bool WriteCoord(const GeoCoord& coord);
+    bool WriteCoord(const CompactGeoCoord& coord);
     bool WriteInvalidCoord();
 
     bool Write(const std::vector<GeoCoord>& nodes);
     bool Write(const std::vector<GeoCoord>& nodes,
                size_t count);
+    bool Write(const std::vector<CompactGeoCoord>& nodes);
+    bool Write(const std::vector<CompactGeoCoord>& nodes,
+               size_t count);
 
     bool WriteTypeId(TypeId id, uint8_t maxBytes);
 
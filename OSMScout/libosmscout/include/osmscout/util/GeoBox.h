@@ -79,6 +79,17 @@ namespace osmscout {
      */
     void Include(const GeoBox& other);
 
+    /**
+     * Returns true, if both bounding boxes intersect (touching boundaries count as intersection).
+     */
+    inline bool Intersects(const GeoBox& other) const
+    {
+      return !(other.GetMaxLon()<minCoord.GetLon() ||
+               other.GetMinLon()>maxCoord.GetLon() ||
+               other.GetMaxLat()<minCoord.GetLat() ||
+               other.GetMinLat()>maxCoord.GetLat());
+    }
+
     /**
      * Returns true, if the GeoBox instance is valid. This means there were
      * values assigned to the box. While being valid, the rectangle spanned by
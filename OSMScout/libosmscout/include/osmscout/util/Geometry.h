@@ -318,14 +318,16 @@ namespace osmscout {
    * If -1 returned, the point is outside the area, if 0, the point is on the area boundary, 1
    * the point is within the area.
    */
-  inline int GetRelationOfPointToArea(const GeoCoord& point,
-                                      const std::vector<GeoCoord>& nodes)
+  template<typename N, typename M>
+  inline int GetRelationOfPointToArea(const N& point,
+                                      const std::vector<M>& nodes)
   {
     size_t i,j;
     bool   c=false;
 
     for (i=0, j=nodes.size()-1; i<nodes.size(); j=i++) {
-      if (point==nodes[i]) {
+      if (point.GetLat()==nodes[i].GetLat() &&
+          point.GetLon()==nodes[i].GetLon()) {
         return 0;
       }
 
@@ -693,7 +695,7 @@ namespace osmscout {
    *
    * See http://en.wikipedia.org/wiki/Curve_orientation.
    */
-  extern OSMSCOUT_API bool AreaIsClockwise(const std::vector<GeoCoord>& edges);
+  extern OSMSCOUT_API bool AreaIsClockwise(const std::vector<CompactGeoCoord>& edges);
 
 
   extern OSMSCOUT_API double CalculateDistancePointToLineSegment(const GeoCoord& p,
@@ -762,6 +764,16 @@ namespace osmscout {
                                     int x2, int y2,
                                     std::vector<ScanCell>& cells);
 
+  /**
+   * \ingroup Geometry
+   * Returns the position of the cell (x,y) on the Hilbert curve covering a grid
+   * of 2^order x 2^order cells. Cells near to each other on the curve are also
+   * near to each other in the grid, so sorting by this value gives good locality.
+   */
+  extern OSMSCOUT_API uint64_t GetHilbertValue(uint32_t x,
+                                               uint32_t y,
+                                               size_t order);
+
   /**
    * \ingroup Geometry
    * Return de distance of the point (px,py) to the segment [(p1x,p1y),(p2x,p2y)],
@@ -775,8 +787,8 @@ namespace osmscout {
   private:
     struct Node
     {
-      GeoCoord coord;
-      Id       id;
+      CompactGeoCoord coord;
+      Id              id;
     };
 
     struct Edge
@@ -788,8 +800,8 @@ namespace osmscout {
   public:
     struct Polygon
     {
-      std::vector<GeoCoord> coords;
-      std::vector<Id>       ids;
+      std::vector<CompactGeoCoord> coords;
+      std::vector<Id>              ids;
     };
 
   private:
@@ -802,7 +814,7 @@ namespace osmscout {
     void RemoveEliminatingEdges();
 
   public:
-    void AddPolygon(const std::vector<GeoCoord>& polygonsCoords,
+    void AddPolygon(const std::vector<CompactGeoCoord>& polygonsCoords,
                     const std::vector<Id>& polygonsIds);
 
     bool Merge(std::list<Polygon>& result);
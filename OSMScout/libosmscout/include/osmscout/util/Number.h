@@ -22,6 +22,8 @@
 
 #include <osmscout/private/CoreImportExport.h>
 
+#include <osmscout/system/Types.h>
+
 #include <limits>
 
 #include <stddef.h>
@@ -266,6 +268,31 @@ namespace osmscout {
       ::f(buffer,number);
   }
 
+  /**
+   * \ingroup Util
+   * Decodes 'count' unsigned variable length encoded numbers (as written by
+   * EncodeNumber()) starting at the given buffer position into the given array
+   * and moves the position behind the last number.
+   *
+   * In contrast to calling DecodeNumber() for each number, the end of the
+   * buffer is checked only once for longer runs of numbers and the
+   * continuation bits of multiple bytes are evaluated at once. Returns false,
+   * if the buffer does not hold 'count' complete numbers.
+   */
+  extern OSMSCOUT_API bool DecodeNumbers(const char* buffer,
+                                         size_t size,
+                                         size_t& pos,
+                                         uint32_t* numbers,
+                                         size_t count);
+
+#if defined(OSMSCOUT_HAVE_UINT64_T)
+  extern OSMSCOUT_API bool DecodeNumbers(const char* buffer,
+                                         size_t size,
+                                         size_t& pos,
+                                         uint64_t* numbers,
+                                         size_t count);
+#endif
+
   template<typename N>
   inline N BitsToBytes(N bits)
   {
@@ -0,0 +1,74 @@
+#ifndef OSMSCOUT_UTIL_POSTINGLIST_H
+#define OSMSCOUT_UTIL_POSTINGLIST_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Number of deltas of a posting list packed with the same bit width
+   */
+  static const size_t POSTING_LIST_BLOCK_SIZE=128;
+
+  /**
+   * \ingroup Util
+   * Appends the encoded form of the given strictly increasing list of file
+   * offsets to the buffer.
+   *
+   * A posting list consists of the number of offsets and the first offset
+   * (both variable length encoded), followed by the differences between
+   * consecutive offsets minus one. The differences are stored in blocks of
+   * POSTING_LIST_BLOCK_SIZE values, each block starting with one byte holding
+   * the number of bits per value, followed by the values packed with this
+   * number of bits.
+   */
+  extern OSMSCOUT_API void EncodePostingList(const std::vector<FileOffset>& offsets,
+                                             std::vector<char>& buffer);
+
+  /**
+   * \ingroup Util
+   * Decodes the posting list starting at the given buffer position and appends
+   * its offsets to the given vector. The position is moved behind the posting
+   * list. Returns false, if the buffer does not hold a complete posting list.
+   */
+  extern OSMSCOUT_API bool DecodePostingList(const char* buffer,
+                                             size_t size,
+                                             size_t& pos,
+                                             std::vector<FileOffset>& offsets);
+
+  /**
+   * \ingroup Util
+   * Merges the sorted lists stored one after another in 'offsets' (list i
+   * starting at listStarts[i]) and appends the result without duplicates
+   * to 'result'.
+   */
+  extern OSMSCOUT_API void MergePostingLists(const std::vector<FileOffset>& offsets,
+                                             const std::vector<size_t>& listStarts,
+                                             std::vector<FileOffset>& result);
+}
+
+#endif
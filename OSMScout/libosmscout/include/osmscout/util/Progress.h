@@ -21,6 +21,7 @@
 */
 
 #include <ctime>
+#include <list>
 #include <string>
 
 #include <osmscout/private/CoreImportExport.h>
@@ -70,6 +71,43 @@ namespace osmscout {
     void Warning(const std::string& text);
     void Error(const std::string& text);
   };
+
+  /**
+   * Progress implementation that collects all messages instead of printing them.
+   * The collected messages can later be passed on to another Progress instance in the
+   * order they were reported.
+   *
+   * This allows worker threads to report messages for an object without directly
+   * accessing a shared (and non thread-safe) Progress instance.
+   */
+  class OSMSCOUT_API BufferedProgress : public Progress
+  {
+  private:
+    enum MessageType {
+      debugMessage,
+      infoMessage,
+      warningMessage,
+      errorMessage
+    };
+
+    struct Message
+    {
+      MessageType type;
+      std::string text;
+    };
+
+  private:
+    std::list<Message> messages;
+
+  public:
+    void Debug(const std::string& text);
+    void Info(const std::string& text);
+    void Warning(const std::string& text);
+    void Error(const std::string& text);
+
+    bool HasMessages() const;
+    void Forward(Progress& progress);
+  };
 }
 
 #endif
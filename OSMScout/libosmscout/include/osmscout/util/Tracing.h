@@ -0,0 +1,124 @@
+#ifndef OSMSCOUT_UTIL_TRACING_H
+#define OSMSCOUT_UTIL_TRACING_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <ostream>
+#include <string>
+
+#include <osmscout/CoreFeatures.h>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/system/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Records spans (named and timed sections of code) and counters on the hot
+   * paths of the library.
+   *
+   * Spans and counters are recorded into a buffer local to the current thread,
+   * so recording threads do not contend with each other. Recording only takes
+   * place if the library has been configured with tracing support
+   * (OSMSCOUT_HAVE_TRACING, see configure --enable-tracing) and the tracer
+   * has been enabled at runtime using SetEnabled(). Without tracing support
+   * the OSMSCOUT_TRACE_SPAN() and OSMSCOUT_TRACE_COUNTER() macros do not
+   * generate any code.
+   *
+   * The recorded spans can be exported in the Chrome trace event format
+   * (see chrome://tracing), the counters and the number and duration of the
+   * spans as a snapshot in the Prometheus text format.
+   */
+  class OSMSCOUT_API Tracer
+  {
+  public:
+    //! Maximum number of spans kept for a thread, further spans are only counted
+    static const size_t MAX_SPANS_PER_THREAD=1000000;
+
+  public:
+    static bool IsSupported();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    static uint64_t GetTimestamp();
+
+    static const char* InternName(const std::string& name);
+
+    static void AddSpan(const char* category,
+                        const char* name,
+                        uint64_t start,
+                        uint64_t end);
+    static void AddToCounter(const char* name,
+                             int64_t value);
+
+    static void GetCounters(std::map<std::string,int64_t>& counters);
+
+    static bool WriteChromeTrace(std::ostream& stream);
+    static bool WriteChromeTrace(const std::string& filename);
+    static bool WriteCounters(std::ostream& stream);
+
+    static void Clear();
+  };
+
+  /**
+   * \ingroup Util
+   * Records a span from its construction to its destruction, if the Tracer is
+   * enabled. Normally used via the OSMSCOUT_TRACE_SPAN() macro.
+   *
+   * Category and name must stay valid until the spans have been exported, so
+   * use string literals or Tracer::InternName().
+   */
+  class OSMSCOUT_API TraceSpan
+  {
+  private:
+    const char* category;
+    const char* name;
+    uint64_t    start;
+    bool        active;
+
+  private:
+    // We do not want you to make copies of a span
+    TraceSpan(const TraceSpan& other);
+
+  public:
+    TraceSpan(const char* category,
+              const char* name);
+    ~TraceSpan();
+  };
+}
+
+#if defined(OSMSCOUT_HAVE_TRACING)
+  #define OSMSCOUT_TRACE_CONCAT_(a,b) a##b
+  #define OSMSCOUT_TRACE_CONCAT(a,b) OSMSCOUT_TRACE_CONCAT_(a,b)
+
+  //! Record a span for the remaining part of the current block
+  #define OSMSCOUT_TRACE_SPAN(category,name) osmscout::TraceSpan OSMSCOUT_TRACE_CONCAT(osmscoutTraceSpan,__LINE__)(category,name)
+  //! Add the given value to the named counter
+  #define OSMSCOUT_TRACE_COUNTER(name,value) osmscout::Tracer::AddToCounter(name,value)
+#else
+  #define OSMSCOUT_TRACE_SPAN(category,name)
+  #define OSMSCOUT_TRACE_COUNTER(name,value)
+#endif
+
+#endif
@@ -69,8 +69,15 @@ namespace osmscout {
     TransPoint* points;
 
   private:
+    void AllocatePoints(size_t count);
     void TransformGeoToPixel(const Projection& projection,
                              const std::vector<GeoCoord>& nodes);
+    void TransformGeoToPixel(const Projection& projection,
+                             const std::vector<CompactGeoCoord>& nodes);
+    void OptimizeArea(OptimizeMethod optimize,
+                      double optimizeErrorTolerance);
+    void OptimizeWay(OptimizeMethod optimize,
+                     double optimizeErrorTolerance);
     void DropSimilarPoints(double optimizeErrorTolerance);
     void DropRedundantPointsFast(double optimizeErrorTolerance);
     void DropRedundantPointsDouglasPeucker(double optimizeErrorTolerance, bool isArea);
@@ -103,11 +110,19 @@ namespace osmscout {
                        OptimizeMethod optimize,
                        const std::vector<GeoCoord>& nodes,
                        double optimizeErrorTolerance);
+    void TransformArea(const Projection& projection,
+                       OptimizeMethod optimize,
+                       const std::vector<CompactGeoCoord>& nodes,
+                       double optimizeErrorTolerance);
 
     void TransformWay(const Projection& projection,
                       OptimizeMethod optimize,
                       const std::vector<GeoCoord>& nodes,
                       double optimizeErrorTolerance);
+    void TransformWay(const Projection& projection,
+                      OptimizeMethod optimize,
+                      const std::vector<CompactGeoCoord>& nodes,
+                      double optimizeErrorTolerance);
 
     bool GetBoundingBox(double& xmin, double& ymin,
                         double& xmax, double& ymax) const;
@@ -321,6 +336,10 @@ namespace osmscout {
     TransPolygon transPolygon;
     CoordBuffer *buffer;
 
+  private:
+    void CopyPoints(size_t& start,
+                    size_t& end);
+
   public:
     TransBuffer(CoordBuffer* buffer);
     virtual ~TransBuffer();
@@ -332,11 +351,21 @@ namespace osmscout {
                        const std::vector<GeoCoord>& nodes,
                        size_t& start, size_t &end,
                        double optimizeErrorTolerance);
+    void TransformArea(const Projection& projection,
+                       TransPolygon::OptimizeMethod optimize,
+                       const std::vector<CompactGeoCoord>& nodes,
+                       size_t& start, size_t &end,
+                       double optimizeErrorTolerance);
     bool TransformWay(const Projection& projection,
                       TransPolygon::OptimizeMethod optimize,
                       const std::vector<GeoCoord>& nodes,
                       size_t& start, size_t &end,
                       double optimizeErrorTolerance);
+    bool TransformWay(const Projection& projection,
+                      TransPolygon::OptimizeMethod optimize,
+                      const std::vector<CompactGeoCoord>& nodes,
+                      size_t& start, size_t &end,
+                      double optimizeErrorTolerance);
   };
 }
 
@@ -11,9 +11,13 @@ macx {
 
 SOURCES = \
           ../libosmscout/src/osmscout/AreaAreaIndex.cpp \
+          ../libosmscout/src/osmscout/AreaAreaRTreeIndex.cpp \
           ../libosmscout/src/osmscout/Area.cpp \
           ../libosmscout/src/osmscout/AreaNodeIndex.cpp \
           ../libosmscout/src/osmscout/AreaWayIndex.cpp \
+          ../libosmscout/src/osmscout/CacheSnapshot.cpp \
+          ../libosmscout/src/osmscout/CellDirectory.cpp \
+          ../libosmscout/src/osmscout/ColumnDataFile.cpp \
           ../libosmscout/src/osmscout/Coord.cpp \
           ../libosmscout/src/osmscout/CoordDataFile.cpp \
           ../libosmscout/src/osmscout/Database.cpp \
@@ -24,6 +28,7 @@ SOURCES = \
           ../libosmscout/src/osmscout/Location.cpp \
           ../libosmscout/src/osmscout/LocationIndex.cpp \
           ../libosmscout/src/osmscout/LocationService.cpp \
+          ../libosmscout/src/osmscout/LocationTokenIndex.cpp \
           ../libosmscout/src/osmscout/Node.cpp \
           ../libosmscout/src/osmscout/NodeDataFile.cpp \
           ../libosmscout/src/osmscout/NumericIndex.cpp \
@@ -33,7 +38,9 @@ SOURCES = \
           ../libosmscout/src/osmscout/Path.cpp \
           ../libosmscout/src/osmscout/Pixel.cpp \
           ../libosmscout/src/osmscout/Point.cpp \
+          ../libosmscout/src/osmscout/POIIndex.cpp \
           ../libosmscout/src/osmscout/POIService.cpp \
+          ../libosmscout/src/osmscout/ReverseGeocodeIndex.cpp \
           ../libosmscout/src/osmscout/Route.cpp \
           ../libosmscout/src/osmscout/RouteData.cpp \
           ../libosmscout/src/osmscout/RouteNode.cpp \
@@ -50,6 +57,7 @@ SOURCES = \
           ../libosmscout/src/osmscout/TypeSet.cpp \
           ../libosmscout/src/osmscout/WaterIndex.cpp \
           ../libosmscout/src/osmscout/Way.cpp \
+          ../libosmscout/src/osmscout/util/BlockCompression.cpp \
           ../libosmscout/src/osmscout/util/Breaker.cpp \
           ../libosmscout/src/osmscout/util/Cache.cpp \
           ../libosmscout/src/osmscout/util/Color.cpp \
@@ -64,12 +72,14 @@ SOURCES = \
           ../libosmscout/src/osmscout/util/Number.cpp \
           ../libosmscout/src/osmscout/util/NumberSet.cpp \
           ../libosmscout/src/osmscout/util/Parser.cpp \
+          ../libosmscout/src/osmscout/util/PostingList.cpp \
           ../libosmscout/src/osmscout/util/Progress.cpp \
           ../libosmscout/src/osmscout/util/Projection.cpp \
           ../libosmscout/src/osmscout/util/Reference.cpp \
           ../libosmscout/src/osmscout/util/StopClock.cpp \
           ../libosmscout/src/osmscout/util/String.cpp \
           ../libosmscout/src/osmscout/util/Tiling.cpp \
+          ../libosmscout/src/osmscout/util/Tracing.cpp \
           ../libosmscout/src/osmscout/util/Transformation.cpp \
           ../libosmscout/src/osmscout/ost/Parser.cpp \
           ../libosmscout/src/osmscout/ost/Scanner.cpp \
@@ -77,10 +87,14 @@ SOURCES = \
 
 HEADERS = \
         ../libosmscout/include/osmscout/AreaAreaIndex.h \
+        ../libosmscout/include/osmscout/AreaAreaRTreeIndex.h \
         ../libosmscout/include/osmscout/AreaDataFile.h \
         ../libosmscout/include/osmscout/Area.h \
         ../libosmscout/include/osmscout/AreaNodeIndex.h \
         ../libosmscout/include/osmscout/AreaWayIndex.h \
+        ../libosmscout/include/osmscout/CacheSnapshot.h \
+        ../libosmscout/include/osmscout/CellDirectory.h \
+        ../libosmscout/include/osmscout/ColumnDataFile.h \
         ../libosmscout/include/osmscout/CoordDataFile.h \
         ../libosmscout/include/osmscout/Coord.h \
         ../libosmscout/include/osmscout/CoreFeatures.h \
@@ -93,6 +107,7 @@ HEADERS = \
         ../libosmscout/include/osmscout/Location.h \
         ../libosmscout/include/osmscout/LocationIndex.h \
         ../libosmscout/include/osmscout/LocationService.h \
+        ../libosmscout/include/osmscout/LocationTokenIndex.h \
         ../libosmscout/include/osmscout/Navigation.h \
         ../libosmscout/include/osmscout/NodeDataFile.h \
         ../libosmscout/include/osmscout/Node.h \
@@ -103,7 +118,9 @@ HEADERS = \
         ../libosmscout/include/osmscout/Path.h \
         ../libosmscout/include/osmscout/Pixel.h \
         ../libosmscout/include/osmscout/Point.h \
+        ../libosmscout/include/osmscout/POIIndex.h \
         ../libosmscout/include/osmscout/POIService.h \
+        ../libosmscout/include/osmscout/ReverseGeocodeIndex.h \
         ../libosmscout/include/osmscout/RouteData.h \
         ../libosmscout/include/osmscout/Route.h \
         ../libosmscout/include/osmscout/RouteNode.h \
@@ -130,6 +147,7 @@ HEADERS = \
         ../libosmscout/include/osmscout/system/SSEMath.h \
         ../libosmscout/include/osmscout/system/SSEMathPublic.h \
         ../libosmscout/include/osmscout/system/Types.h \
+        ../libosmscout/include/osmscout/util/BlockCompression.h \
         ../libosmscout/include/osmscout/util/Breaker.h \
         ../libosmscout/include/osmscout/util/Cache.h \
         ../libosmscout/include/osmscout/util/Color.h \
@@ -144,10 +162,12 @@ HEADERS = \
         ../libosmscout/include/osmscout/util/Number.h \
         ../libosmscout/include/osmscout/util/NumberSet.h \
         ../libosmscout/include/osmscout/util/Parser.h \
+        ../libosmscout/include/osmscout/util/PostingList.h \
         ../libosmscout/include/osmscout/util/Progress.h \
         ../libosmscout/include/osmscout/util/Projection.h \
         ../libosmscout/include/osmscout/util/Reference.h \
         ../libosmscout/include/osmscout/util/StopClock.h \
         ../libosmscout/include/osmscout/util/String.h \
         ../libosmscout/include/osmscout/util/Tiling.h \
+        ../libosmscout/include/osmscout/util/Tracing.h \
         ../libosmscout/include/osmscout/util/Transformation.h
@@ -147,6 +147,23 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Returns the memory (in bytes) used by the area and its rings with their
+   * features, ids and coordinates
+   */
+  size_t Area::GetMemory() const
+  {
+    size_t memory=sizeof(Area)+rings.capacity()*sizeof(Ring);
+
+    for (const auto& ring : rings) {
+      memory+=ring.featureValueBuffer.GetMemory()+
+              ring.ids.capacity()*sizeof(Id)+
+              ring.nodes.capacity()*sizeof(CompactGeoCoord);
+    }
+
+    return memory;
+  }
+
   bool Area::ReadIds(FileScanner& scanner,
                      uint32_t nodesCount,
                      std::vector<Id>& ids)
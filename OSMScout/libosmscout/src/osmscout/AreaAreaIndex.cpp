@@ -19,25 +19,35 @@
 
 #include <osmscout/AreaAreaIndex.h>
 
+#include <algorithm>
 #include <iostream>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/system/Math.h>
 
 namespace osmscout {
 
-  AreaAreaIndex::AreaAreaIndex(size_t cacheSize)
+  AreaAreaIndex::AreaAreaIndex(size_t cacheSize,
+                               bool useRTree)
   : filepart("areaarea.idx"),
     maxLevel(0),
     topLevelOffset(0),
-    indexCache(cacheSize)
+    indexCache(cacheSize),
+    useRTree(useRTree)
   {
-    // no code
+    indexCache.SetValueSizer(&indexCacheValueSizer);
   }
 
   void AreaAreaIndex::Close()
   {
+    if (rtree) {
+      rtree->Close();
+      rtree=NULL;
+    }
+
     if (scanner.IsOpen()) {
       scanner.Close();
     }
@@ -62,14 +72,15 @@ namespace osmscout {
 
       scanner.SetPos(offset);
 
+      cacheRef->value.level=level;
+
       // Read offsets of children if not in the bottom level
 
       if (level<maxLevel) {
-        for (size_t c=0; c<4; c++) {
-          if (!scanner.ReadNumber(cacheRef->value.children[c])) {
-            log.Error() << "Cannot read index data at offset " << offset << " in file '" << scanner.GetFilename() << "'";
-            return false;
-          }
+        if (!scanner.ReadNumbers(cacheRef->value.children,
+                                 4)) {
+          log.Error() << "Cannot read index data at offset " << offset << " in file '" << scanner.GetFilename() << "'";
+          return false;
         }
       }
       else {
@@ -109,6 +120,8 @@ namespace osmscout {
 
         prevOffset=cacheRef->value.areas[c].offset;
       }
+
+      indexCache.UpdateMemory(cacheRef);
     }
 
     return true;
@@ -116,6 +129,22 @@ namespace osmscout {
 
   bool AreaAreaIndex::Load(const std::string& path)
   {
+    FileOffset rtreeSize;
+
+    if (useRTree &&
+        GetFileSize(AppendFileToDir(path,
+                                    AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE),
+                    rtreeSize)) {
+      rtree=std::make_shared<AreaAreaRTreeIndex>();
+
+      if (!rtree->Load(path)) {
+        rtree=NULL;
+        return false;
+      }
+
+      return true;
+    }
+
     datafilename=path+"/"+filepart;
 
     if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
@@ -158,6 +187,20 @@ namespace osmscout {
                                  size_t maxCount,
                                  std::vector<FileOffset>& offsets) const
   {
+    if (rtree) {
+      return rtree->GetOffsets(typeConfig,
+                               minlon,
+                               minlat,
+                               maxlon,
+                               maxlat,
+                               maxLevel,
+                               types,
+                               maxCount,
+                               offsets);
+    }
+
+    OSMSCOUT_TRACE_SPAN("index","AreaAreaIndex::GetOffsets");
+
     std::vector<CellRef>    cellRefs;     // cells to scan in this level
     std::vector<CellRef>    nextCellRefs; // cells to scan for the next level
     std::vector<FileOffset> newOffsets;   // offsets collected in the current level
@@ -290,9 +333,294 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Adds the offsets of the index cells currently in the cache to the given
+   * snapshot, one section per level of the quadtree.
+   */
+  void AreaAreaIndex::GetCacheSnapshot(CacheSnapshot& snapshot) const
+  {
+    std::vector<IndexCache::CacheEntry>  entries;
+    std::vector<std::vector<uint64_t> >  keysByLevel(maxLevel+1);
+    FileOffset                           fileSize;
+
+    if (datafilename.empty() ||
+        !indexCache.IsActive() ||
+        !GetFileSize(datafilename,
+                     fileSize)) {
+      return;
+    }
+
+    indexCache.GetEntries(entries);
+
+    for (const auto& entry : entries) {
+      if (entry.value.level<keysByLevel.size()) {
+        keysByLevel[entry.value.level].push_back(entry.key);
+      }
+    }
+
+    for (size_t level=0; level<keysByLevel.size(); level++) {
+      if (!keysByLevel[level].empty()) {
+        snapshot.AddSection(filepart,
+                            fileSize,
+                            (uint32_t)level,
+                            keysByLevel[level]);
+      }
+    }
+  }
+
+  /**
+   * Loads the index cells referenced by the given snapshot into the cache,
+   * in the order of their file offsets.
+   */
+  bool AreaAreaIndex::PrefetchCacheSnapshot(const TypeConfigRef& typeConfig,
+                                            const CacheSnapshot& snapshot) const
+  {
+    std::vector<std::pair<FileOffset,uint32_t> > cells;
+
+    if (datafilename.empty() ||
+        !indexCache.IsActive()) {
+      return true;
+    }
+
+    for (uint32_t level=0; level<=maxLevel; level++) {
+      const CacheSnapshot::Section* section=snapshot.GetSection(filepart,
+                                                                level);
+
+      if (section==NULL ||
+          !CacheSnapshot::IsValid(*section,
+                                  datafilename)) {
+        continue;
+      }
+
+      std::vector<uint64_t> keys;
+
+      CacheSnapshot::GetPrefetchKeys(*section,
+                                     indexCache.GetMaxSize(),
+                                     keys);
+
+      for (const auto key : keys) {
+        cells.push_back(std::make_pair((FileOffset)key,level));
+      }
+    }
+
+    std::sort(cells.begin(),
+              cells.end());
+
+    if (cells.size()>indexCache.GetMaxSize()) {
+      cells.resize(indexCache.GetMaxSize());
+    }
+
+    for (const auto& cell : cells) {
+      IndexCache::CacheRef cacheRef;
+
+      if (!GetIndexCell(*typeConfig,
+                        cell.second,
+                        cell.first,
+                        cacheRef)) {
+        log.Error() << "Cannot prefetch offset " << cell.first << " in level " << cell.second << " in file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Registers the index cache at the given manager, which from then on
+   * controls the memory limit of the cache.
+   */
+  void AreaAreaIndex::RegisterCache(CacheManager& manager) const
+  {
+    manager.Register(filepart,
+                     indexCache);
+  }
+
   void AreaAreaIndex::DumpStatistics()
   {
     indexCache.DumpStatistics(filepart.c_str(),IndexCacheValueSizer());
   }
+
+  /**
+   * Returns the level of the given bounding box in the quadtree: The deepest
+   * level (up to maxLevel) into whose cells the bounding box fits, or 0.
+   */
+  uint32_t AreaAreaIndex::GetAreaLevel(const GeoBox& boundingBox,
+                                       uint32_t maxLevel)
+  {
+    uint32_t level=maxLevel;
+
+    while (level>0 &&
+           (boundingBox.GetWidth()>360.0/pow(2.0,(int)level) ||
+            boundingBox.GetHeight()>180.0/pow(2.0,(int)level))) {
+      level--;
+    }
+
+    return level;
+  }
+
+  AreaAreaIndexWriter::AreaAreaIndexWriter()
+  : areaTypeIdBytes(0),
+    maxLevel(0),
+    level(0),
+    complete(false),
+    topLevelOffset(0),
+    topLevelOffsetOffset(0)
+  {
+    // no code
+  }
+
+  /**
+   * Creates the index file with the given number of levels. Areas of
+   * the level maxLevel are added first.
+   */
+  bool AreaAreaIndexWriter::Open(const std::string& filename,
+                                 uint32_t maxLevel,
+                                 uint8_t areaTypeIdBytes)
+  {
+    this->maxLevel=maxLevel;
+    this->areaTypeIdBytes=areaTypeIdBytes;
+
+    level=maxLevel;
+    complete=false;
+    topLevelOffset=0;
+    cells.clear();
+
+    if (!writer.Open(filename)) {
+      log.Error() << "Cannot create '" << filename << "'";
+      return false;
+    }
+
+    writer.WriteNumber(maxLevel); // MaxMag
+
+    if (!writer.GetPos(topLevelOffsetOffset)) {
+      log.Error() << "Cannot read current file position of '" << filename << "'";
+      return false;
+    }
+
+    if (!writer.WriteFileOffset(topLevelOffset)) {
+      log.Error() << "Cannot write top level entry offset to '" << filename << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Adds the area to the cell of the current level that holds the center of
+   * its bounding box. The area must belong to the current level.
+   */
+  void AreaAreaIndexWriter::AddArea(FileOffset offset,
+                                    TypeId type,
+                                    const GeoBox& boundingBox)
+  {
+    GeoCoord center=boundingBox.GetCenter();
+    uint32_t x=(uint32_t)((center.GetLon()+180.0)/(360.0/pow(2.0,(int)level)));
+    uint32_t y=(uint32_t)((center.GetLat()+90.0)/(180.0/pow(2.0,(int)level)));
+    Entry    entry;
+
+    entry.type=type;
+    entry.offset=offset;
+
+    // Since areas are added in file position order, their offsets are
+    // sorted within each cell
+    cells[Pixel(x,y)].areas.push_back(entry);
+  }
+
+  /**
+   * Writes the cells of the current level and creates the cells of the next
+   * upper level, that reference the written cells as their children.
+   */
+  bool AreaAreaIndexWriter::WriteLevel()
+  {
+    if (complete) {
+      log.Error() << "All levels have already been written to '" << writer.GetFilename() << "'";
+      return false;
+    }
+
+    // Remember the offset of the one cell in level 0
+    if (level==0 &&
+        !writer.GetPos(topLevelOffset)) {
+      log.Error() << "Cannot read top level entry offset of '" << writer.GetFilename() << "'";
+      return false;
+    }
+
+    for (auto& cell : cells) {
+      writer.GetPos(cell.second.offset);
+
+      if (level<maxLevel) {
+        for (size_t c=0; c<4; c++) {
+          writer.WriteNumber(cell.second.children[c]);
+        }
+      }
+
+      FileOffset lastOffset=0;
+
+      writer.WriteNumber((uint32_t)cell.second.areas.size());
+
+      for (const auto& entry : cell.second.areas) {
+        writer.WriteTypeId(entry.type,
+                           areaTypeIdBytes);
+        writer.WriteNumber(entry.offset-lastOffset);
+
+        lastOffset=entry.offset;
+      }
+    }
+
+    if (writer.HasError()) {
+      log.Error() << "Cannot write level " << level << " to '" << writer.GetFilename() << "'";
+      return false;
+    }
+
+    if (level==0) {
+      cells.clear();
+      complete=true;
+
+      return true;
+    }
+
+    std::map<Pixel,Cell> parents;
+
+    // child index is build as following (y-axis is from bottom to top!):
+    //   01
+    //   23
+    for (const auto& cell : cells) {
+      uint32_t xc=cell.first.x;
+      uint32_t yc=cell.first.y;
+      size_t   index;
+
+      if (yc%2!=0) {
+        index=xc%2==0 ? 0 : 1;
+      }
+      else {
+        index=xc%2==0 ? 2 : 3;
+      }
+
+      parents[Pixel(xc/2,yc/2)].children[index]=cell.second.offset;
+    }
+
+    cells.swap(parents);
+    level--;
+
+    return true;
+  }
+
+  /**
+   * Writes the offset of the top level cell and closes the file. All levels
+   * must have been written before.
+   */
+  bool AreaAreaIndexWriter::Close()
+  {
+    if (!complete) {
+      log.Error() << "Level " << level << " has not been written to '" << writer.GetFilename() << "'";
+      writer.Close();
+      return false;
+    }
+
+    writer.SetPos(topLevelOffsetOffset);
+    writer.WriteFileOffset(topLevelOffset);
+
+    return !writer.HasError() &&
+           writer.Close();
+  }
 }
 
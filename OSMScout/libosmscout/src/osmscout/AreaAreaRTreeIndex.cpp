@@ -0,0 +1,514 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/AreaAreaRTreeIndex.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <osmscout/AreaAreaIndex.h>
+
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
+
+#include <osmscout/system/Math.h>
+
+namespace osmscout {
+
+  const char* const AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE = "areaarea.rtree";
+
+  /**
+   * Order of the Hilbert curve used to sort bounding box centers
+   */
+  static const size_t HILBERT_ORDER=16;
+
+  static inline uint32_t GetUInt32(const unsigned char* data)
+  {
+    return ((uint32_t)data[0]) |
+           ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+  }
+
+  static inline uint64_t GetUInt64(const unsigned char* data)
+  {
+    return ((uint64_t)GetUInt32(data)) |
+           ((uint64_t)GetUInt32(data+4) << 32);
+  }
+
+  static inline uint16_t GetUInt16(const unsigned char* data)
+  {
+    return (uint16_t)(((uint16_t)data[0]) |
+                      ((uint16_t)data[1] << 8));
+  }
+
+  static inline void PutUInt32(char* data,
+                               uint32_t value)
+  {
+    data[0]=(char)((value >>  0) & 0xff);
+    data[1]=(char)((value >>  8) & 0xff);
+    data[2]=(char)((value >> 16) & 0xff);
+    data[3]=(char)((value >> 24) & 0xff);
+  }
+
+  static inline void PutUInt64(char* data,
+                               uint64_t value)
+  {
+    PutUInt32(data,(uint32_t)(value & 0xffffffff));
+    PutUInt32(data+4,(uint32_t)(value >> 32));
+  }
+
+  AreaAreaRTreeIndex::AreaAreaRTreeIndex()
+  : rootPage(0),
+    height(0),
+    maxLevel(0),
+    pageCount(0)
+  {
+    // no code
+  }
+
+  void AreaAreaRTreeIndex::Close()
+  {
+    if (scanner.IsOpen()) {
+      scanner.Close();
+    }
+  }
+
+  /**
+   * Converts the given longitude into the fixed point format used for
+   * bounding boxes in the index. Minimum values are rounded down and maximum
+   * values up, so the fixed point bounding box contains the original one.
+   */
+  uint32_t AreaAreaRTreeIndex::GetFixedLon(double lon,
+                                           bool roundUp)
+  {
+    double value=(lon+180.0)*FIXED_POINT_FACTOR;
+
+    value=roundUp ? ceil(value) : floor(value);
+
+    return (uint32_t)std::max(0.0,std::min(value,360.0*FIXED_POINT_FACTOR));
+  }
+
+  /**
+   * Converts the given latitude into the fixed point format used for
+   * bounding boxes in the index (see GetFixedLon()).
+   */
+  uint32_t AreaAreaRTreeIndex::GetFixedLat(double lat,
+                                           bool roundUp)
+  {
+    double value=(lat+90.0)*FIXED_POINT_FACTOR;
+
+    value=roundUp ? ceil(value) : floor(value);
+
+    return (uint32_t)std::max(0.0,std::min(value,180.0*FIXED_POINT_FACTOR));
+  }
+
+  /**
+   * Returns the node in the given page. If the file is memory mapped the node
+   * points directly into the mapped file, else the page is read into buffer.
+   */
+  bool AreaAreaRTreeIndex::GetNode(uint32_t page,
+                                   std::vector<char>& buffer,
+                                   const unsigned char*& node) const
+  {
+    if (page==0 ||
+        page>=pageCount) {
+      log.Error() << "Invalid node page " << page << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    const char* data=scanner.GetMappedData();
+
+    if (data!=NULL) {
+      node=(const unsigned char*)data+(FileOffset)page*PAGE_SIZE;
+
+      return true;
+    }
+
+    buffer.resize(PAGE_SIZE);
+
+    if (!scanner.SetPos((FileOffset)page*PAGE_SIZE) ||
+        !scanner.Read(buffer.data(),
+                      PAGE_SIZE)) {
+      log.Error() << "Cannot read node page " << page << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    node=(const unsigned char*)buffer.data();
+
+    return true;
+  }
+
+  bool AreaAreaRTreeIndex::Load(const std::string& path)
+  {
+    uint32_t pageSize;
+
+    datafilename=path+"/"+FILENAME_AREAAREA_RTREE;
+
+    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Read(pageSize) ||
+        !scanner.Read(rootPage) ||
+        !scanner.Read(height) ||
+        !scanner.Read(maxLevel)) {
+      log.Error() << "Cannot read data from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (pageSize!=PAGE_SIZE ||
+        scanner.GetSize()%PAGE_SIZE!=0) {
+      log.Error() << "Unsupported page size in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    pageCount=(uint32_t)(scanner.GetSize()/PAGE_SIZE);
+
+    return true;
+  }
+
+  /**
+   * Returns the offsets of all areas of the given types with a level of at
+   * most maxLevel, whose bounding box intersects the given bounding box,
+   * sorted by level and file offset.
+   *
+   * Like in AreaAreaIndex the result only contains complete levels and
+   * is smaller than maxCount: If all areas of the next level would not fit,
+   * the result is returned without them.
+   */
+  bool AreaAreaRTreeIndex::GetOffsets(const TypeConfigRef& typeConfig,
+                                      double minlon,
+                                      double minlat,
+                                      double maxlon,
+                                      double maxlat,
+                                      size_t maxLevel,
+                                      const TypeSet& types,
+                                      size_t maxCount,
+                                      std::vector<FileOffset>& offsets) const
+  {
+    OSMSCOUT_TRACE_SPAN("index","AreaAreaRTreeIndex::GetOffsets");
+
+    std::vector<std::pair<uint8_t,FileOffset> > hits;
+    std::vector<uint32_t>                       pages;
+    std::vector<char>                           buffer;
+    uint64_t                                    typeMask=0;
+    uint32_t                                    qMinLon=GetFixedLon(minlon,false);
+    uint32_t                                    qMinLat=GetFixedLat(minlat,false);
+    uint32_t                                    qMaxLon=GetFixedLon(maxlon,true);
+    uint32_t                                    qMaxLat=GetFixedLat(maxlat,true);
+
+    offsets.clear();
+
+    if (rootPage==0) {
+      return true;
+    }
+
+    for (const auto& type : typeConfig->GetAreaTypes()) {
+      if (types.IsTypeSet(type->GetAreaId())) {
+        typeMask|=((uint64_t)1) << (type->GetAreaId()%64);
+      }
+    }
+
+    if (typeMask==0) {
+      return true;
+    }
+
+    pages.reserve(height*NODE_CAPACITY);
+    pages.push_back(rootPage);
+
+    while (!pages.empty()) {
+      const unsigned char* node;
+      uint32_t             page=pages.back();
+
+      pages.pop_back();
+
+      if (!GetNode(page,
+                   buffer,
+                   node)) {
+        return false;
+      }
+
+      uint32_t entryCount=GetUInt32(node);
+      bool     isLeaf=node[4]!=0;
+
+      if (entryCount>NODE_CAPACITY) {
+        log.Error() << "Invalid entry count in node page " << page << " in file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      const unsigned char* entry=node+NODE_HEADER_SIZE;
+
+      for (uint32_t e=0; e<entryCount; e++, entry+=ENTRY_SIZE) {
+        if (GetUInt32(entry)>qMaxLon ||
+            GetUInt32(entry+4)>qMaxLat ||
+            GetUInt32(entry+8)<qMinLon ||
+            GetUInt32(entry+12)<qMinLat) {
+          continue;
+        }
+
+        if (isLeaf) {
+          TypeId  type=GetUInt16(entry+24);
+          uint8_t level=entry[26];
+
+          if (level<=maxLevel &&
+              types.IsTypeSet(type)) {
+            hits.push_back(std::make_pair(level,
+                                          (FileOffset)GetUInt64(entry+16)));
+          }
+        }
+        else if ((GetUInt64(entry+16) & typeMask)!=0 &&
+                 entry[28]<=maxLevel) {
+          pages.push_back(GetUInt32(entry+24));
+        }
+      }
+    }
+
+    std::sort(hits.begin(),
+              hits.end());
+
+    // Only return complete levels
+    size_t count=0;
+
+    while (count<hits.size()) {
+      size_t levelEnd=count+1;
+
+      while (levelEnd<hits.size() &&
+             hits[levelEnd].first==hits[count].first) {
+        levelEnd++;
+      }
+
+      if (levelEnd>=maxCount) {
+        break;
+      }
+
+      count=levelEnd;
+    }
+
+    offsets.reserve(count);
+
+    for (size_t i=0; i<count; i++) {
+      offsets.push_back(hits[i].second);
+    }
+
+    return true;
+  }
+
+  AreaAreaRTreeIndexWriter::AreaAreaRTreeIndexWriter(uint32_t maxLevel)
+  : maxLevel(maxLevel),
+    height(0)
+  {
+    // no code
+  }
+
+  void AreaAreaRTreeIndexWriter::Reserve(size_t areaCount)
+  {
+    entries.reserve(areaCount);
+  }
+
+  /**
+   * Adds the area with the given bounding box. Its level is calculated
+   * by AreaAreaIndex::GetAreaLevel().
+   */
+  void AreaAreaRTreeIndexWriter::AddArea(FileOffset offset,
+                                         TypeId type,
+                                         const GeoBox& boundingBox)
+  {
+    Entry entry;
+
+    entry.minLon=AreaAreaRTreeIndex::GetFixedLon(boundingBox.GetMinLon(),false);
+    entry.minLat=AreaAreaRTreeIndex::GetFixedLat(boundingBox.GetMinLat(),false);
+    entry.maxLon=AreaAreaRTreeIndex::GetFixedLon(boundingBox.GetMaxLon(),true);
+    entry.maxLat=AreaAreaRTreeIndex::GetFixedLat(boundingBox.GetMaxLat(),true);
+    entry.value=offset;
+    entry.page=0;
+    entry.type=type;
+    entry.level=(uint8_t)AreaAreaIndex::GetAreaLevel(boundingBox,
+                                                     maxLevel);
+    entry.hilbert=GetHilbertValue((uint32_t)((entry.minLon/2+entry.maxLon/2) >> (32-HILBERT_ORDER)),
+                                  (uint32_t)((entry.minLat/2+entry.maxLat/2) >> (32-HILBERT_ORDER)),
+                                  HILBERT_ORDER);
+
+    entries.push_back(entry);
+  }
+
+  /**
+   * Writes the given entries as nodes of one level of the tree, with up to
+   * NODE_CAPACITY entries each, and returns one parent entry per written node.
+   */
+  bool AreaAreaRTreeIndexWriter::WriteNodes(FileWriter& writer,
+                                            bool isLeaf,
+                                            const std::vector<Entry>& levelEntries,
+                                            uint32_t& nextPage,
+                                            std::vector<Entry>& parents)
+  {
+    std::vector<char> page(AreaAreaRTreeIndex::PAGE_SIZE);
+
+    parents.clear();
+    parents.reserve(levelEntries.size()/AreaAreaRTreeIndex::NODE_CAPACITY+1);
+
+    for (size_t start=0;
+         start<levelEntries.size();
+         start+=AreaAreaRTreeIndex::NODE_CAPACITY) {
+      size_t end=std::min(start+AreaAreaRTreeIndex::NODE_CAPACITY,
+                          levelEntries.size());
+      Entry  parent;
+
+      parent.minLon=std::numeric_limits<uint32_t>::max();
+      parent.minLat=std::numeric_limits<uint32_t>::max();
+      parent.maxLon=0;
+      parent.maxLat=0;
+      parent.value=0;
+      parent.page=nextPage;
+      parent.type=0;
+      parent.level=std::numeric_limits<uint8_t>::max();
+      parent.hilbert=0;
+
+      std::fill(page.begin(),
+                page.end(),
+                0);
+
+      PutUInt32(&page[0],(uint32_t)(end-start));
+      page[4]=isLeaf ? 1 : 0;
+
+      char* data=&page[AreaAreaRTreeIndex::NODE_HEADER_SIZE];
+
+      for (size_t i=start; i<end; i++) {
+        const Entry& entry=levelEntries[i];
+
+        PutUInt32(data,entry.minLon);
+        PutUInt32(data+4,entry.minLat);
+        PutUInt32(data+8,entry.maxLon);
+        PutUInt32(data+12,entry.maxLat);
+        PutUInt64(data+16,entry.value);
+
+        if (isLeaf) {
+          data[24]=(char)(entry.type & 0xff);
+          data[25]=(char)((entry.type >> 8) & 0xff);
+          data[26]=(char)entry.level;
+
+          parent.value|=((uint64_t)1) << (entry.type%64);
+        }
+        else {
+          PutUInt32(data+24,entry.page);
+          data[28]=(char)entry.level;
+
+          parent.value|=entry.value;
+        }
+
+        parent.minLon=std::min(parent.minLon,entry.minLon);
+        parent.minLat=std::min(parent.minLat,entry.minLat);
+        parent.maxLon=std::max(parent.maxLon,entry.maxLon);
+        parent.maxLat=std::max(parent.maxLat,entry.maxLat);
+        parent.level=std::min(parent.level,entry.level);
+
+        data+=AreaAreaRTreeIndex::ENTRY_SIZE;
+      }
+
+      if (!writer.Write(page.data(),
+                        page.size())) {
+        log.Error() << "Cannot write node page " << nextPage << " to '" << writer.GetFilename() << "'";
+        return false;
+      }
+
+      parents.push_back(parent);
+      nextPage++;
+    }
+
+    return true;
+  }
+
+  /**
+   * Sorts the areas by level and Hilbert value and writes the tree bottom
+   * up, one level of nodes after the other.
+   */
+  bool AreaAreaRTreeIndexWriter::Write(const std::string& filename)
+  {
+    FileWriter         writer;
+    std::vector<char>  header(AreaAreaRTreeIndex::PAGE_SIZE,0);
+    std::vector<Entry> parents;
+    uint32_t           nextPage=1;
+    uint32_t           rootPage=0;
+
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const Entry& a, const Entry& b) {
+      return a.level<b.level ||
+             (a.level==b.level && a.hilbert<b.hilbert);
+    });
+
+    height=0;
+
+    if (!writer.Open(filename)) {
+      log.Error() << "Cannot create '" << filename << "'";
+      return false;
+    }
+
+    // Placeholder for the header, written at the end
+    if (!writer.Write(header.data(),
+                      header.size())) {
+      log.Error() << "Cannot write file header to '" << filename << "'";
+      writer.Close();
+      return false;
+    }
+
+    bool isLeaf=true;
+
+    while (!entries.empty()) {
+      if (!WriteNodes(writer,
+                      isLeaf,
+                      entries,
+                      nextPage,
+                      parents)) {
+        writer.Close();
+        return false;
+      }
+
+      height++;
+
+      if (parents.size()==1) {
+        rootPage=parents.front().page;
+        break;
+      }
+
+      entries.swap(parents);
+      isLeaf=false;
+    }
+
+    entries.clear();
+
+    PutUInt32(&header[0],(uint32_t)AreaAreaRTreeIndex::PAGE_SIZE);
+    PutUInt32(&header[4],rootPage);
+    PutUInt32(&header[8],height);
+    PutUInt32(&header[12],maxLevel);
+
+    if (!writer.SetPos(0) ||
+        !writer.Write(header.data(),
+                      header.size())) {
+      log.Error() << "Cannot write file header to '" << filename << "'";
+      writer.Close();
+      return false;
+    }
+
+    return !writer.HasError() &&
+           writer.Close();
+  }
+}
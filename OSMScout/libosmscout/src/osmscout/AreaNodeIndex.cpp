@@ -20,6 +20,7 @@
 #include <osmscout/AreaNodeIndex.h>
 
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/system/Math.h>
 
@@ -28,7 +29,6 @@ namespace osmscout {
   AreaNodeIndex::TypeData::TypeData()
   : indexLevel(0),
     indexOffset(0),
-    dataOffsetBytes(0),
     cellXStart(0),
     cellXEnd(0),
     cellYStart(0),
@@ -40,7 +40,8 @@ namespace osmscout {
     minLon(0.0),
     maxLon(0.0),
     minLat(0.0),
-    maxLat(0.0)
+    maxLat(0.0),
+    directoryLoaded(false)
   {
   }
 
@@ -80,7 +81,6 @@ namespace osmscout {
       }
 
       scanner.ReadFileOffset(nodeTypeData[type].indexOffset);
-      scanner.Read(nodeTypeData[type].dataOffsetBytes);
 
       scanner.ReadNumber(nodeTypeData[type].indexLevel);
 
@@ -104,15 +104,12 @@ namespace osmscout {
     return !scanner.HasError() && scanner.Close();
   }
 
-  bool AreaNodeIndex::GetOffsets(const TypeData& typeData,
+  bool AreaNodeIndex::GetOffsets(TypeData& typeData,
                                  double minlon,
                                  double minlat,
                                  double maxlon,
                                  double maxlat,
-                                 size_t maxNodeCount,
-                                 std::vector<FileOffset>& offsets,
-                                 size_t currentSize,
-                                 bool& sizeExceeded) const
+                                 std::vector<FileOffset>& offsets) const
   {
     if (typeData.indexOffset==0) {
       // No data for this type available
@@ -127,7 +124,16 @@ namespace osmscout {
       return true;
     }
 
-    std::unordered_set<FileOffset> newOffsets;
+    if (!typeData.directoryLoaded) {
+      if (!typeData.directory.Read(scanner,
+                                   typeData.indexOffset,
+                                   typeData.cellXStart,
+                                   typeData.cellYStart)) {
+        return false;
+      }
+
+      typeData.directoryLoaded=true;
+    }
 
     uint32_t             minxc=(uint32_t)floor((minlon+180.0)/typeData.cellWidth);
     uint32_t             maxxc=(uint32_t)floor((maxlon+180.0)/typeData.cellWidth);
@@ -141,90 +147,12 @@ namespace osmscout {
     minyc=std::max(minyc,typeData.cellYStart);
     maxyc=std::min(maxyc,typeData.cellYEnd);
 
-    FileOffset dataOffset=typeData.indexOffset+
-                          typeData.cellXCount*typeData.cellYCount*(FileOffset)typeData.dataOffsetBytes;
-
-    // For each row
-    for (size_t y=minyc; y<=maxyc; y++) {
-      FileOffset initialCellDataOffset=0;
-      size_t     cellDataOffsetCount=0;
-      FileOffset cellIndexOffset=typeData.indexOffset+
-                                 ((y-typeData.cellYStart)*typeData.cellXCount+
-                                  minxc-typeData.cellXStart)*typeData.dataOffsetBytes;
-
-      if (!scanner.SetPos(cellIndexOffset)) {
-        log.Error() << "Cannot go to type cell index position " << cellIndexOffset << " in file '" << scanner.GetFilename() << "'";
-        return false;
-      }
-
-      // For each column in row
-      for (size_t x=minxc; x<=maxxc; x++) {
-        FileOffset cellDataOffset;
-
-        if (!scanner.ReadFileOffset(cellDataOffset,
-                                    typeData.dataOffsetBytes)) {
-          log.Error() << "Cannot read cell data position from file '" << scanner.GetFilename() << "'";
-          return false;
-        }
-
-        if (cellDataOffset==0) {
-          continue;
-        }
-
-        // We added +1 during import and now substract it again
-        cellDataOffset--;
-
-        if (initialCellDataOffset==0) {
-          initialCellDataOffset=dataOffset+cellDataOffset;
-        }
-
-        cellDataOffsetCount++;
-      }
-
-      if (cellDataOffsetCount==0) {
-        continue;
-      }
-
-      assert(initialCellDataOffset>=cellIndexOffset);
-
-      if (!scanner.SetPos(initialCellDataOffset)) {
-        log.Error() << "Cannot go to cell data position " << initialCellDataOffset << " in file '" << scanner.GetFilename() << "'";
-        return false;
-      }
-
-      // For each data cell in row found
-      for (size_t i=0; i<cellDataOffsetCount; i++) {
-        uint32_t   dataCount;
-        FileOffset lastOffset=0;
-
-
-        if (!scanner.ReadNumber(dataCount)) {
-          log.Error() << "Cannot read cell data count from file '" << scanner.GetFilename() << "'";
-          return false;
-        }
-
-        if (currentSize+newOffsets.size()+dataCount>maxNodeCount) {
-          sizeExceeded=true;
-          return true;
-        }
-
-        for (size_t d=0; d<dataCount; d++) {
-          FileOffset objectOffset;
-
-          scanner.ReadNumber(objectOffset);
-
-          objectOffset+=lastOffset;
-
-          newOffsets.insert(objectOffset);
-
-          lastOffset=objectOffset;
-        }
-      }
-    }
-
-    offsets.insert(offsets.end(),newOffsets.begin(),newOffsets.end());
-
-    return true;
+    return typeData.directory.GetOffsets(scanner,
+                                         minxc,
+                                         maxxc,
+                                         minyc,
+                                         maxyc,
+                                         offsets);
   }
 
   bool AreaNodeIndex::GetOffsets(double minlon,
@@ -235,6 +163,8 @@ namespace osmscout {
                                  size_t maxNodeCount,
                                  std::vector<FileOffset>& nodeOffsets) const
   {
+    OSMSCOUT_TRACE_SPAN("index","AreaNodeIndex::GetOffsets");
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
         log.Error() << "Error while opening file '" << scanner.GetFilename() << "' for reading!";
@@ -242,23 +172,22 @@ namespace osmscout {
       }
     }
 
-    bool sizeExceeded=false;
-
     for (size_t i=0; i<nodeTypeData.size(); i++) {
       if (nodeTypes.IsTypeSet(i)) {
+        size_t currentSize=nodeOffsets.size();
+
         if (!GetOffsets(nodeTypeData[i],
                         minlon,
                         minlat,
                         maxlon,
                         maxlat,
-                        maxNodeCount,
-                        nodeOffsets,
-                        nodeOffsets.size(),
-                        sizeExceeded)) {
+                        nodeOffsets)) {
           return false;
         }
 
-        if (sizeExceeded) {
+        if (nodeOffsets.size()>maxNodeCount) {
+          // Only return complete types
+          nodeOffsets.resize(currentSize);
           break;
         }
       }
@@ -20,6 +20,7 @@
 #include <osmscout/AreaWayIndex.h>
 
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/system/Math.h>
 
@@ -27,8 +28,7 @@ namespace osmscout {
 
   AreaWayIndex::TypeData::TypeData()
   : indexLevel(0),
-    dataOffsetBytes(0),
-    bitmapOffset(0),
+    directoryOffset(0),
     cellXStart(0),
     cellXEnd(0),
     cellYStart(0),
@@ -40,7 +40,8 @@ namespace osmscout {
     minLon(0.0),
     maxLon(0.0),
     minLat(0.0),
-    maxLat(0.0)
+    maxLat(0.0),
+    directoryLoaded(false)
   {
   }
 
@@ -81,11 +82,9 @@ namespace osmscout {
         wayTypeData.resize(type+1);
       }
 
-      scanner.ReadFileOffset(wayTypeData[type].bitmapOffset);
-
-      if (wayTypeData[type].bitmapOffset>0) {
-        scanner.Read(wayTypeData[type].dataOffsetBytes);
+      scanner.ReadFileOffset(wayTypeData[type].directoryOffset);
 
+      if (wayTypeData[type].directoryOffset>0) {
         scanner.ReadNumber(wayTypeData[type].indexLevel);
 
         scanner.ReadNumber(wayTypeData[type].cellXStart);
@@ -109,17 +108,14 @@ namespace osmscout {
     return !scanner.HasError() && scanner.Close();
   }
 
-  bool AreaWayIndex::GetOffsets(const TypeData& typeData,
+  bool AreaWayIndex::GetOffsets(TypeData& typeData,
                                 double minlon,
                                 double minlat,
                                 double maxlon,
                                 double maxlat,
-                                size_t maxWayCount,
-                                std::unordered_set<FileOffset>& offsets,
-                                size_t currentSize,
-                                bool& sizeExceeded) const
+                                std::vector<FileOffset>& offsets) const
   {
-    if (typeData.bitmapOffset==0) {
+    if (typeData.directoryOffset==0) {
       // No data for this type available
       return true;
     }
@@ -132,6 +128,17 @@ namespace osmscout {
       return true;
     }
 
+    if (!typeData.directoryLoaded) {
+      if (!typeData.directory.Read(scanner,
+                                   typeData.directoryOffset,
+                                   typeData.cellXStart,
+                                   typeData.cellYStart)) {
+        return false;
+      }
+
+      typeData.directoryLoaded=true;
+    }
+
     uint32_t minxc=(uint32_t)floor((minlon+180.0)/typeData.cellWidth);
     uint32_t maxxc=(uint32_t)floor((maxlon+180.0)/typeData.cellWidth);
 
@@ -144,92 +151,12 @@ namespace osmscout {
     minyc=std::max(minyc,typeData.cellYStart);
     maxyc=std::min(maxyc,typeData.cellYEnd);
 
-    FileOffset dataOffset=typeData.bitmapOffset+
-                          typeData.cellXCount*typeData.cellYCount*(FileOffset)typeData.dataOffsetBytes;
-
-    // For each row
-    for (size_t y=minyc; y<=maxyc; y++) {
-      FileOffset initialCellDataOffset=0;
-      size_t     cellDataOffsetCount=0;
-      FileOffset bitmapCellOffset=typeData.bitmapOffset+
-                                  ((y-typeData.cellYStart)*typeData.cellXCount+
-                                   minxc-typeData.cellXStart)*(FileOffset)typeData.dataOffsetBytes;
-
-      if (!scanner.SetPos(bitmapCellOffset)) {
-        log.Error() << "Cannot go to type cell index position " << bitmapCellOffset << " in file '" << scanner.GetFilename() << "'";
-        return false;
-      }
-
-      // For each column in row
-      for (size_t x=minxc; x<=maxxc; x++) {
-        FileOffset cellDataOffset;
-
-        if (!scanner.ReadFileOffset(cellDataOffset,
-                                    typeData.dataOffsetBytes)) {
-          log.Error() << "Cannot read cell data position in file '" << scanner.GetFilename() << "'";
-          return false;
-        }
-
-        if (cellDataOffset==0) {
-          continue;
-        }
-
-        // We added +1 during import and now substract it again
-        cellDataOffset--;
-
-        if (initialCellDataOffset==0) {
-          initialCellDataOffset=dataOffset+cellDataOffset;
-        }
-
-        cellDataOffsetCount++;
-      }
-
-      // We did not find any cells in the current row
-      if (cellDataOffsetCount==0) {
-        continue;
-      }
-
-      // The first data entry must be positioned behind the bitmap
-      assert(initialCellDataOffset>=bitmapCellOffset);
-
-      // first data entry in the row
-      if (!scanner.SetPos(initialCellDataOffset)) {
-        log.Error() << "Cannot go to cell data position " << initialCellDataOffset  << " in file '" << scanner.GetFilename() << "'";
-        return false;
-      }
-
-      // For each data cell (in range) in row found
-      for (size_t i=0; i<cellDataOffsetCount; i++) {
-        uint32_t   dataCount;
-        FileOffset lastOffset=0;
-
-
-        if (!scanner.ReadNumber(dataCount)) {
-          log.Error() << "Cannot read cell data count"  << " in file '" << scanner.GetFilename() << "'";
-          return false;
-        }
-
-        if (currentSize+offsets.size()+dataCount>maxWayCount) {
-          //std::cout << currentSize<< "+" << newOffsets.size() << "+" << dataCount << ">" << maxWayCount << std::endl;
-          sizeExceeded=true;
-          return true;
-        }
-
-        for (size_t d=0; d<dataCount; d++) {
-          FileOffset objectOffset;
-
-          scanner.ReadNumber(objectOffset);
-
-          objectOffset+=lastOffset;
-
-          offsets.insert(objectOffset);
-
-          lastOffset=objectOffset;
-        }
-      }
-    }
-
-    return true;
+    return typeData.directory.GetOffsets(scanner,
+                                         minxc,
+                                         maxxc,
+                                         minyc,
+                                         maxyc,
+                                         offsets);
   }
 
   bool AreaWayIndex::GetOffsets(double minlon,
@@ -240,6 +167,8 @@ namespace osmscout {
                                 size_t maxWayCount,
                                 std::vector<FileOffset>& offsets) const
   {
+    OSMSCOUT_TRACE_SPAN("index","AreaWayIndex::GetOffsets");
+
     if (!scanner.IsOpen()) {
       if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
         log.Error() << "Error while opening " << scanner.GetFilename() << " for reading!";
@@ -247,8 +176,7 @@ namespace osmscout {
       }
     }
 
-    bool                           sizeExceeded=false;
-    std::unordered_set<FileOffset> newOffsets;
+    std::vector<FileOffset> newOffsets;
 
     offsets.reserve(std::min(100000u,(uint32_t)maxWayCount));
     newOffsets.reserve(std::min(100000u,(uint32_t)maxWayCount));
@@ -260,25 +188,24 @@ namespace osmscout {
           type<wayTypeData.size();
           ++type) {
         if (wayTypes[i].IsTypeSet(type)) {
+          // The offsets of each type are sorted and unique, each way has
+          // exactly one type, so we can simply append them
           if (!GetOffsets(wayTypeData[type],
                           minlon,
                           minlat,
                           maxlon,
                           maxlat,
-                          maxWayCount,
-                          newOffsets,
-                          offsets.size(),
-                          sizeExceeded)) {
+                          newOffsets)) {
             return false;
           }
 
-          if (sizeExceeded) {
+          if (offsets.size()+newOffsets.size()>maxWayCount) {
             return true;
           }
         }
       }
 
-      // Copy data from temporary set to final vector
+      // Copy data from temporary vector to final vector
 
       offsets.insert(offsets.end(),newOffsets.begin(),newOffsets.end());
     }
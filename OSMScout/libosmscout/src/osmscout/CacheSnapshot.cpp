@@ -0,0 +1,228 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CacheSnapshot.h>
+
+#include <algorithm>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  /**
+   * Version of the file format of cache snapshot files
+   */
+  static const uint32_t CACHE_SNAPSHOT_FORMAT_VERSION=1;
+
+  void CacheSnapshot::Clear()
+  {
+    sections.clear();
+  }
+
+  void CacheSnapshot::AddSection(const std::string& file,
+                                 FileOffset fileSize,
+                                 uint32_t level,
+                                 const std::vector<uint64_t>& keys)
+  {
+    Section section;
+
+    section.file=file;
+    section.fileSize=fileSize;
+    section.level=level;
+    section.keys=keys;
+
+    sections.push_back(section);
+  }
+
+  /**
+   * Copies all sections for the given file from the other snapshot. Used to
+   * carry over sections for files that have not been accessed since the other
+   * snapshot has been loaded.
+   */
+  void CacheSnapshot::CopySections(const CacheSnapshot& other,
+                                   const std::string& file)
+  {
+    for (const auto& section : other.sections) {
+      if (section.file==file) {
+        sections.push_back(section);
+      }
+    }
+  }
+
+  const CacheSnapshot::Section* CacheSnapshot::GetSection(const std::string& file,
+                                                          uint32_t level) const
+  {
+    for (const auto& section : sections) {
+      if (section.file==file &&
+          section.level==level) {
+        return &section;
+      }
+    }
+
+    return NULL;
+  }
+
+  /**
+   * Returns true, if the given file still has the size it had at the time
+   * the snapshot section has been taken.
+   */
+  bool CacheSnapshot::IsValid(const Section& section,
+                              const std::string& filename)
+  {
+    FileOffset fileSize;
+
+    if (!GetFileSize(filename,
+                     fileSize)) {
+      return false;
+    }
+
+    return fileSize==section.fileSize;
+  }
+
+  bool CacheSnapshot::Read(const std::string& filename)
+  {
+    FileScanner scanner;
+    uint32_t    version;
+    uint32_t    sectionCount;
+
+    sections.clear();
+
+    if (!scanner.Open(filename,
+                      FileScanner::Sequential,
+                      false)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Read(version)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (version!=CACHE_SNAPSHOT_FORMAT_VERSION) {
+      log.Warn() << "Cache snapshot '" << scanner.GetFilename() << "' has format version " << version << ", expected " << CACHE_SNAPSHOT_FORMAT_VERSION << ", ignoring it";
+      scanner.Close();
+      return false;
+    }
+
+    scanner.ReadNumber(sectionCount);
+
+    for (size_t s=0; s<sectionCount; s++) {
+      Section  section;
+      uint32_t keyCount;
+
+      scanner.Read(section.file);
+      scanner.ReadFileOffset(section.fileSize);
+      scanner.ReadNumber(section.level);
+      scanner.ReadNumber(keyCount);
+
+      if (scanner.HasError()) {
+        break;
+      }
+
+      section.keys.resize(keyCount);
+
+      for (size_t k=0; k<keyCount; k++) {
+        scanner.ReadNumber(section.keys[k]);
+      }
+
+      sections.push_back(section);
+    }
+
+    if (scanner.HasError()) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      scanner.Close();
+      sections.clear();
+      return false;
+    }
+
+    return scanner.Close();
+  }
+
+  /**
+   * Writes the snapshot to the given file. The snapshot is written to a
+   * temporary file first, which is then renamed, so that an existing
+   * snapshot is never replaced by a partially written one.
+   */
+  bool CacheSnapshot::Write(const std::string& filename) const
+  {
+    FileWriter  writer;
+    std::string tmpFilename=filename+".tmp";
+
+    if (!writer.Open(tmpFilename)) {
+      log.Error() << "Cannot create file '" << tmpFilename << "'";
+      return false;
+    }
+
+    writer.Write(CACHE_SNAPSHOT_FORMAT_VERSION);
+    writer.WriteNumber((uint32_t)sections.size());
+
+    for (const auto& section : sections) {
+      writer.Write(section.file);
+      writer.WriteFileOffset(section.fileSize);
+      writer.WriteNumber(section.level);
+      writer.WriteNumber((uint32_t)section.keys.size());
+
+      for (const auto key : section.keys) {
+        writer.WriteNumber(key);
+      }
+    }
+
+    if (writer.HasError() ||
+        !writer.Close()) {
+      log.Error() << "Error while writing file '" << tmpFilename << "'";
+      RemoveFile(tmpFilename);
+      return false;
+    }
+
+#if defined(__WIN32__) || defined(WIN32)
+    // Windows does not replace existing files on rename
+    RemoveFile(filename);
+#endif
+
+    if (!RenameFile(tmpFilename,
+                    filename)) {
+      log.Error() << "Cannot rename file '" << tmpFilename << "' to '" << filename << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the (at most) maxCount most recently used keys of the given
+   * section, sorted ascending. For keys that are file offsets this is the
+   * order in which the entries should be loaded to minimize seeking.
+   */
+  void CacheSnapshot::GetPrefetchKeys(const Section& section,
+                                      size_t maxCount,
+                                      std::vector<uint64_t>& keys)
+  {
+    size_t count=std::min(maxCount,section.keys.size());
+
+    keys.assign(section.keys.begin(),
+                section.keys.begin()+count);
+
+    std::sort(keys.begin(),
+              keys.end());
+  }
+}
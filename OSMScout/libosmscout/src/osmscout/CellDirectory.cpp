@@ -0,0 +1,274 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CellDirectory.h>
+
+#include <algorithm>
+
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/PostingList.h>
+
+namespace osmscout {
+
+  /**
+   * Maximum number of bytes of neighbouring posting lists read with one call
+   */
+  static const size_t MAX_READ_SIZE=1024*1024;
+
+  bool CellDirectory::Read(FileScanner& scanner,
+                           FileOffset directoryOffset,
+                           uint32_t cellXStart,
+                           uint32_t cellYStart)
+  {
+    uint32_t   cellCount;
+    FileOffset dataOffset;
+
+    cells.clear();
+
+    if (!scanner.SetPos(directoryOffset)) {
+      log.Error() << "Cannot go to cell directory position " << directoryOffset << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    scanner.ReadNumber(cellCount);
+    scanner.ReadFileOffset(dataOffset);
+
+    if (scanner.HasError()) {
+      log.Error() << "Cannot read cell directory in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    cells.resize(cellCount);
+
+    for (auto& cell : cells) {
+      scanner.ReadNumber(cell.x);
+      scanner.ReadNumber(cell.y);
+      scanner.ReadNumber(cell.size);
+
+      cell.x+=cellXStart;
+      cell.y+=cellYStart;
+      cell.offset=dataOffset;
+
+      dataOffset+=cell.size;
+    }
+
+    if (scanner.HasError()) {
+      log.Error() << "Cannot read cell directory in file '" << scanner.GetFilename() << "'";
+      cells.clear();
+      return false;
+    }
+
+    // Cells are stored in Hilbert order, for lookup we need them by row
+    std::sort(cells.begin(),
+              cells.end());
+
+    return true;
+  }
+
+  /**
+   * Returns the non empty cells within the given cell range, sorted by the
+   * position of their data in the file.
+   */
+  void CellDirectory::GetCells(uint32_t minxc,
+                               uint32_t maxxc,
+                               uint32_t minyc,
+                               uint32_t maxyc,
+                               std::vector<const Cell*>& result) const
+  {
+    Cell start;
+
+    start.x=minxc;
+    start.y=minyc;
+
+    auto cell=std::lower_bound(cells.begin(),
+                               cells.end(),
+                               start);
+
+    while (cell!=cells.end() &&
+           cell->y<=maxyc) {
+      if (cell->x<minxc ||
+          cell->x>maxxc) {
+        // Skip the rest of the row (or the start of the row)
+        start.x=minxc;
+        start.y=cell->x<minxc ? cell->y : cell->y+1;
+
+        cell=std::lower_bound(cell,
+                              cells.end(),
+                              start);
+        continue;
+      }
+
+      result.push_back(&(*cell));
+      ++cell;
+    }
+
+    std::sort(result.begin(),
+              result.end(),
+              [](const Cell* a, const Cell* b) {
+      return a->offset<b->offset;
+    });
+  }
+
+  /**
+   * Appends the offsets of all objects in the given cell range to 'offsets'.
+   * The appended offsets are sorted and without duplicates. Neighbouring
+   * posting lists are read with one read call, the posting lists of all cells
+   * are then merged.
+   */
+  bool CellDirectory::GetOffsets(FileScanner& scanner,
+                                 uint32_t minxc,
+                                 uint32_t maxxc,
+                                 uint32_t minyc,
+                                 uint32_t maxyc,
+                                 std::vector<FileOffset>& offsets) const
+  {
+    std::vector<const Cell*> hits;
+
+    GetCells(minxc,
+             maxxc,
+             minyc,
+             maxyc,
+             hits);
+
+    if (hits.empty()) {
+      return true;
+    }
+
+    std::vector<char>       buffer;
+    std::vector<FileOffset> cellOffsets;
+    std::vector<size_t>     listStarts;
+
+    listStarts.reserve(hits.size());
+
+    size_t runStart=0;
+
+    while (runStart<hits.size()) {
+      size_t     runEnd=runStart+1;
+      FileOffset runSize=hits[runStart]->size;
+
+      while (runEnd<hits.size() &&
+             hits[runEnd]->offset==hits[runEnd-1]->offset+hits[runEnd-1]->size &&
+             runSize+hits[runEnd]->size<=MAX_READ_SIZE) {
+        runSize+=hits[runEnd]->size;
+        runEnd++;
+      }
+
+      buffer.resize((size_t)runSize);
+
+      if (!scanner.SetPos(hits[runStart]->offset) ||
+          !scanner.Read(buffer.data(),
+                        buffer.size())) {
+        log.Error() << "Cannot read cell data at position " << hits[runStart]->offset << " in file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      size_t pos=0;
+
+      for (size_t i=runStart; i<runEnd; i++) {
+        size_t cellEnd=pos+hits[i]->size;
+
+        listStarts.push_back(cellOffsets.size());
+
+        if (!DecodePostingList(buffer.data(),
+                               cellEnd,
+                               pos,
+                               cellOffsets) ||
+            pos!=cellEnd) {
+          log.Error() << "Cannot decode cell data at position " << hits[i]->offset << " in file '" << scanner.GetFilename() << "'";
+          return false;
+        }
+      }
+
+      runStart=runEnd;
+    }
+
+    MergePostingLists(cellOffsets,
+                      listStarts,
+                      offsets);
+
+    return true;
+  }
+
+  bool CellDirectory::Write(FileWriter& writer,
+                            uint32_t level,
+                            uint32_t cellXStart,
+                            uint32_t cellYStart,
+                            const CellOffsetsMap& cellOffsets,
+                            FileOffset& directoryOffset)
+  {
+    std::vector<std::pair<uint64_t,CellOffsetsMap::const_iterator> > order;
+    std::vector<uint32_t>                                            sizes;
+    std::vector<FileOffset>                                          offsets;
+    std::vector<char>                                                buffer;
+    FileOffset                                                       dataOffset;
+
+    order.reserve(cellOffsets.size());
+    sizes.reserve(cellOffsets.size());
+
+    for (auto cell=cellOffsets.begin();
+         cell!=cellOffsets.end();
+         ++cell) {
+      order.push_back(std::make_pair(GetHilbertValue(cell->first.x,
+                                                     cell->first.y,
+                                                     std::max(level,(uint32_t)1)),
+                                     cell));
+    }
+
+    std::sort(order.begin(),
+              order.end(),
+              [](const std::pair<uint64_t,CellOffsetsMap::const_iterator>& a,
+                 const std::pair<uint64_t,CellOffsetsMap::const_iterator>& b) {
+      return a.first<b.first;
+    });
+
+    if (!writer.GetPos(dataOffset)) {
+      return false;
+    }
+
+    for (const auto& entry : order) {
+      offsets.assign(entry.second->second.begin(),
+                     entry.second->second.end());
+      buffer.clear();
+
+      EncodePostingList(offsets,
+                        buffer);
+
+      writer.Write(buffer.data(),
+                   buffer.size());
+
+      sizes.push_back((uint32_t)buffer.size());
+    }
+
+    if (!writer.GetPos(directoryOffset)) {
+      return false;
+    }
+
+    writer.WriteNumber((uint32_t)order.size());
+    writer.WriteFileOffset(dataOffset);
+
+    for (size_t i=0; i<order.size(); i++) {
+      writer.WriteNumber(order[i].second->first.x-cellXStart);
+      writer.WriteNumber(order[i].second->first.y-cellYStart);
+      writer.WriteNumber(sizes[i]);
+    }
+
+    return !writer.HasError();
+  }
+}
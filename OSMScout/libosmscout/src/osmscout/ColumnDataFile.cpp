@@ -0,0 +1,841 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ColumnDataFile.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <osmscout/Area.h>
+#include <osmscout/Node.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const char* const ColumnDataFile::FILENAME_NODES_COL = "nodes.col";
+  const char* const ColumnDataFile::FILENAME_WAYS_COL  = "ways.col";
+  const char* const ColumnDataFile::FILENAME_AREAS_COL = "areas.col";
+
+  ColumnDataFile::ColumnDataFile()
+  : objectType(refNone),
+    objectCount(0)
+  {
+    // no code
+  }
+
+  ColumnDataFile::~ColumnDataFile()
+  {
+    Close();
+  }
+
+  /**
+   * Converts the given latitude into the fixed point resolution of GeoCoord
+   */
+  uint32_t ColumnDataFile::GetFixedLat(double lat)
+  {
+    return (uint32_t)round((lat+90.0)*latConversionFactor);
+  }
+
+  /**
+   * Converts the given longitude into the fixed point resolution of GeoCoord
+   */
+  uint32_t ColumnDataFile::GetFixedLon(double lon)
+  {
+    return (uint32_t)round((lon+180.0)*lonConversionFactor);
+  }
+
+  double ColumnDataFile::GetLat(uint32_t lat)
+  {
+    return lat/latConversionFactor-90.0;
+  }
+
+  double ColumnDataFile::GetLon(uint32_t lon)
+  {
+    return lon/lonConversionFactor-180.0;
+  }
+
+  TypeInfoRef ColumnDataFile::GetTypeInfo(TypeId id) const
+  {
+    switch (objectType) {
+    case refNode:
+      return typeConfig->GetNodeTypeInfo(id);
+    case refWay:
+      return typeConfig->GetWayTypeInfo(id);
+    default:
+      return typeConfig->GetAreaTypeInfo(id);
+    }
+  }
+
+  bool ColumnDataFile::Open(const TypeConfigRef& typeConfig,
+                            const std::string& path,
+                            const std::string& filename,
+                            bool memoryMaped)
+  {
+    uint32_t   blockCount;
+    uint8_t    type;
+    FileOffset directoryOffset;
+
+    this->typeConfig=typeConfig;
+
+    datafilename=AppendFileToDir(path,filename);
+
+    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,memoryMaped)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Read(objectCount) ||
+        !scanner.Read(blockCount) ||
+        !scanner.Read(type) ||
+        !scanner.ReadFileOffset(directoryOffset)) {
+      log.Error() << "Cannot read header of file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    objectType=(RefType)type;
+
+    if (objectType!=refNode &&
+        objectType!=refWay &&
+        objectType!=refArea) {
+      log.Error() << "Unsupported object type in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (blockCount==0) {
+      return true;
+    }
+
+    if (!scanner.SetPos(directoryOffset)) {
+      log.Error() << "Cannot read block directory of file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    blocks.resize(blockCount);
+
+    for (auto& block : blocks) {
+      uint32_t minLat;
+      uint32_t minLon;
+      uint32_t maxLat;
+      uint32_t maxLon;
+
+      scanner.Read(block.objectCount);
+      scanner.Read(block.partCount);
+
+      scanner.Read(minLat);
+      scanner.Read(minLon);
+      scanner.Read(maxLat);
+      scanner.Read(maxLon);
+
+      block.boundingBox.Set(GeoCoord(GetLat(minLat),GetLon(minLon)),
+                            GeoCoord(GetLat(maxLat),GetLon(maxLon)));
+
+      for (size_t c=0; c<=columnCount; c++) {
+        scanner.ReadFileOffset(block.columns[c]);
+      }
+    }
+
+    if (scanner.HasError()) {
+      log.Error() << "Cannot read block directory of file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  bool ColumnDataFile::Close()
+  {
+    blocks.clear();
+
+    if (scanner.IsOpen()) {
+      return scanner.Close();
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the indexes of all blocks whose bounding box intersects the given
+   * bounding box.
+   */
+  void ColumnDataFile::GetBlocks(const GeoBox& boundingBox,
+                                 std::vector<size_t>& blocks) const
+  {
+    blocks.clear();
+
+    for (size_t b=0; b<this->blocks.size(); b++) {
+      if (this->blocks[b].boundingBox.Intersects(boundingBox)) {
+        blocks.push_back(b);
+      }
+    }
+  }
+
+  /**
+   * Returns the file offsets (in the data file) of all objects of one of the
+   * given types whose bounding box intersects the given bounding box, sorted
+   * ascending. The type of an area is the type of its first ring.
+   *
+   * Only the offset, part, type and coordinate columns of the blocks
+   * intersecting the bounding box are read.
+   */
+  bool ColumnDataFile::GetOffsets(const GeoBox& boundingBox,
+                                  const TypeSet& types,
+                                  std::vector<FileOffset>& offsets) const
+  {
+    std::vector<size_t>                        matchingBlocks;
+    std::vector<FileOffset>                    blockOffsets;
+    std::vector<uint32_t>                      partCounts;
+    std::vector<uint8_t>                       rings;
+    std::vector<TypeId>                        typeIds;
+    std::vector<std::vector<CompactGeoCoord> > coords;
+    uint32_t                                   minLat=GetFixedLat(boundingBox.GetMinLat());
+    uint32_t                                   minLon=GetFixedLon(boundingBox.GetMinLon());
+    uint32_t                                   maxLat=GetFixedLat(boundingBox.GetMaxLat());
+    uint32_t                                   maxLon=GetFixedLon(boundingBox.GetMaxLon());
+
+    offsets.clear();
+
+    if (!types.HasTypes()) {
+      return true;
+    }
+
+    GetBlocks(boundingBox,
+              matchingBlocks);
+
+    for (const auto block : matchingBlocks) {
+      if (!ReadOffsets(block,
+                       blockOffsets) ||
+          !ReadParts(block,
+                     partCounts,
+                     rings) ||
+          !ReadTypeIds(block,
+                       typeIds) ||
+          !ReadCoords(block,
+                      coords)) {
+        log.Error() << "Cannot read block " << block << " of file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      size_t part=0;
+
+      for (size_t o=0; o<blockOffsets.size(); o++) {
+        size_t firstPart=part;
+
+        part+=partCounts[o];
+
+        if (part>typeIds.size()) {
+          log.Error() << "Invalid part count in block " << block << " of file '" << scanner.GetFilename() << "'";
+          return false;
+        }
+
+        if (partCounts[o]==0 ||
+            !types.IsTypeSet(typeIds[firstPart])) {
+          continue;
+        }
+
+        uint32_t objectMinLat=std::numeric_limits<uint32_t>::max();
+        uint32_t objectMinLon=std::numeric_limits<uint32_t>::max();
+        uint32_t objectMaxLat=0;
+        uint32_t objectMaxLon=0;
+
+        for (size_t p=firstPart; p<part; p++) {
+          for (const auto& coord : coords[p]) {
+            objectMinLat=std::min(objectMinLat,coord.GetFixedLat());
+            objectMinLon=std::min(objectMinLon,coord.GetFixedLon());
+            objectMaxLat=std::max(objectMaxLat,coord.GetFixedLat());
+            objectMaxLon=std::max(objectMaxLon,coord.GetFixedLon());
+          }
+        }
+
+        if (objectMinLat<=maxLat &&
+            objectMaxLat>=minLat &&
+            objectMinLon<=maxLon &&
+            objectMaxLon>=minLon) {
+          offsets.push_back(blockOffsets[o]);
+        }
+      }
+    }
+
+    return true;
+  }
+
+  bool ColumnDataFile::GotoColumn(size_t block,
+                                  Column column) const
+  {
+    if (block>=blocks.size()) {
+      log.Error() << "Invalid block " << block << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.SetPos(blocks[block].columns[column])) {
+      log.Error() << "Cannot read block " << block << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the file offsets of the objects of the block in the data file.
+   */
+  bool ColumnDataFile::ReadOffsets(size_t block,
+                                   std::vector<FileOffset>& offsets) const
+  {
+    if (!GotoColumn(block,
+                    columnOffset)) {
+      return false;
+    }
+
+    offsets.resize(blocks[block].objectCount);
+
+    return scanner.ReadNumbersDelta(offsets.data(),
+                                    offsets.size());
+  }
+
+  /**
+   * Returns the number of parts of each object and the ring level of each
+   * part. For nodes and ways each object has one part with ring level 0.
+   */
+  bool ColumnDataFile::ReadParts(size_t block,
+                                 std::vector<uint32_t>& partCounts,
+                                 std::vector<uint8_t>& rings) const
+  {
+    if (block>=blocks.size()) {
+      log.Error() << "Invalid block " << block << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (objectType!=refArea) {
+      partCounts.assign(blocks[block].objectCount,1);
+      rings.assign(blocks[block].partCount,0);
+
+      return true;
+    }
+
+    if (!GotoColumn(block,
+                    columnPart)) {
+      return false;
+    }
+
+    partCounts.resize(blocks[block].objectCount);
+    rings.resize(blocks[block].partCount);
+
+    scanner.ReadNumbers(partCounts.data(),
+                        partCounts.size());
+
+    for (auto& ring : rings) {
+      scanner.Read(ring);
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Returns the node, way or area type id of each part of the block
+   */
+  bool ColumnDataFile::ReadTypeIds(size_t block,
+                                   std::vector<TypeId>& typeIds) const
+  {
+    if (!GotoColumn(block,
+                    columnType)) {
+      return false;
+    }
+
+    typeIds.resize(blocks[block].partCount);
+
+    for (auto& typeId : typeIds) {
+      scanner.ReadNumber(typeId);
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Returns the type of each part of the block
+   */
+  bool ColumnDataFile::ReadTypes(size_t block,
+                                 std::vector<TypeInfoRef>& types) const
+  {
+    std::vector<TypeId> typeIds;
+
+    if (!ReadTypeIds(block,
+                     typeIds)) {
+      return false;
+    }
+
+    types.resize(typeIds.size());
+
+    for (size_t p=0; p<typeIds.size(); p++) {
+      types[p]=GetTypeInfo(typeIds[p]);
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the raw feature mask column of the block. The mask of a part
+   * has TypeInfo::GetFeatureMaskBytes() bytes of its type and directly
+   * follows the mask of the previous part.
+   */
+  bool ColumnDataFile::ReadFeatureMasks(size_t block,
+                                        std::vector<uint8_t>& masks) const
+  {
+    if (!GotoColumn(block,
+                    columnFeatureMask)) {
+      return false;
+    }
+
+    masks.resize((size_t)GetColumnSize(block,
+                                       columnFeatureMask));
+
+    if (!masks.empty() &&
+        !scanner.Read((char*)masks.data(),
+                      masks.size())) {
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the features of each part of the block, the types must be the
+   * result of ReadTypes() for the same block.
+   */
+  bool ColumnDataFile::ReadFeatures(size_t block,
+                                    const std::vector<TypeInfoRef>& types,
+                                    std::vector<FeatureValueBuffer>& features) const
+  {
+    std::vector<uint8_t> masks;
+
+    if (!ReadFeatureMasks(block,
+                          masks)) {
+      return false;
+    }
+
+    if (!GotoColumn(block,
+                    columnFeatureValue)) {
+      return false;
+    }
+
+    const uint8_t* mask=masks.data();
+    const uint8_t* masksEnd=masks.data()+masks.size();
+
+    features.resize(types.size());
+
+    for (size_t p=0; p<types.size(); p++) {
+      const TypeInfoRef& type=types[p];
+
+      features[p].SetType(type);
+
+      if (mask+type->GetFeatureMaskBytes()>masksEnd) {
+        log.Error() << "Invalid feature mask in block " << block << " in file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      for (const auto& feature : type->GetFeatures()) {
+        size_t idx=feature.GetIndex();
+
+        if ((mask[idx/8] & (1 << idx%8))==0) {
+          continue;
+        }
+
+        FeatureValue* value=features[p].AllocateValue(idx);
+
+        if (value!=NULL &&
+            !value->Read(scanner)) {
+          return false;
+        }
+      }
+
+      mask+=type->GetFeatureMaskBytes();
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Returns the coordinates of each part of the block
+   */
+  bool ColumnDataFile::ReadCoords(size_t block,
+                                  std::vector<std::vector<CompactGeoCoord> >& coords) const
+  {
+    if (!GotoColumn(block,
+                    columnCoord)) {
+      return false;
+    }
+
+    int64_t lat=0;
+    int64_t lon=0;
+
+    coords.resize(blocks[block].partCount);
+
+    for (auto& nodes : coords) {
+      uint32_t nodeCount;
+
+      scanner.ReadNumber(nodeCount);
+
+      nodes.resize(nodeCount);
+
+      for (auto& node : nodes) {
+        int64_t latDelta;
+        int64_t lonDelta;
+
+        scanner.ReadNumber(latDelta);
+        scanner.ReadNumber(lonDelta);
+
+        lat+=latDelta;
+        lon+=lonDelta;
+
+        node.SetFixed((uint32_t)lat,
+                      (uint32_t)lon);
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Returns the node ids of each part of the block. The ids of a part are
+   * empty, if the part has no ids, 0 if the coordinate has no id.
+   */
+  bool ColumnDataFile::ReadIds(size_t block,
+                               std::vector<std::vector<Id> >& ids) const
+  {
+    if (block>=blocks.size()) {
+      log.Error() << "Invalid block " << block << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (objectType==refNode) {
+      ids.assign(blocks[block].partCount,std::vector<Id>());
+
+      return true;
+    }
+
+    if (!GotoColumn(block,
+                    columnId)) {
+      return false;
+    }
+
+    int64_t lastId=0;
+
+    ids.resize(blocks[block].partCount);
+
+    for (auto& partIds : ids) {
+      uint32_t idCount;
+
+      scanner.ReadNumber(idCount);
+
+      partIds.resize(idCount);
+
+      for (auto& id : partIds) {
+        int64_t value;
+
+        scanner.ReadNumber(value);
+
+        if (value==0) {
+          id=0;
+        }
+        else {
+          lastId+=value>0 ? value-1 : value;
+          id=(Id)lastId;
+        }
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  ColumnDataWriter::ColumnDataWriter()
+  : objectType(refNone),
+    objectCount(0)
+  {
+    // no code
+  }
+
+  bool ColumnDataWriter::Open(const std::string& filename,
+                              RefType objectType)
+  {
+    this->objectType=objectType;
+
+    objectCount=0;
+    blocks.clear();
+    offsets.clear();
+    partCounts.clear();
+    parts.clear();
+
+    if (!writer.Open(filename)) {
+      return false;
+    }
+
+    // Header, rewritten on close
+    writer.Write(objectCount);
+    writer.Write((uint32_t)0);
+    writer.Write((uint8_t)objectType);
+    writer.WriteFileOffset(0);
+
+    return !writer.HasError();
+  }
+
+  ColumnDataWriter::Part& ColumnDataWriter::AddPart(const FeatureValueBuffer& features,
+                                                    TypeId typeId)
+  {
+    parts.push_back(Part());
+
+    Part& part=parts.back();
+
+    part.typeId=typeId;
+    part.features=features;
+    part.ring=0;
+
+    return part;
+  }
+
+  bool ColumnDataWriter::AddObject(FileOffset offset,
+                                   size_t partCount)
+  {
+    offsets.push_back(offset);
+    partCounts.push_back((uint32_t)partCount);
+
+    objectCount++;
+
+    if (offsets.size()>=BLOCK_OBJECT_COUNT) {
+      return WriteBlock();
+    }
+
+    return true;
+  }
+
+  bool ColumnDataWriter::Add(FileOffset offset,
+                             const Node& node)
+  {
+    Part& part=AddPart(node.GetFeatureValueBuffer(),
+                       node.GetType()->GetNodeId());
+
+    part.nodes.push_back(node.GetCoords());
+
+    return AddObject(offset,1);
+  }
+
+  bool ColumnDataWriter::Add(FileOffset offset,
+                             const Way& way)
+  {
+    Part& part=AddPart(way.GetFeatureValueBuffer(),
+                       way.GetType()->GetWayId());
+
+    part.nodes=way.nodes;
+    part.ids=way.ids;
+
+    return AddObject(offset,1);
+  }
+
+  bool ColumnDataWriter::Add(FileOffset offset,
+                             const Area& area)
+  {
+    for (const auto& ring : area.rings) {
+      Part& part=AddPart(ring.GetFeatureValueBuffer(),
+                         ring.GetType()->GetAreaId());
+
+      part.ring=ring.ring;
+      part.nodes=ring.nodes;
+      part.ids=ring.ids;
+    }
+
+    return AddObject(offset,area.rings.size());
+  }
+
+  /**
+   * Writes the collected objects as one block, column by column
+   */
+  bool ColumnDataWriter::WriteBlock()
+  {
+    BlockEntry block;
+
+    block.objectCount=(uint32_t)offsets.size();
+    block.partCount=(uint32_t)parts.size();
+    block.minLat=std::numeric_limits<uint32_t>::max();
+    block.minLon=std::numeric_limits<uint32_t>::max();
+    block.maxLat=0;
+    block.maxLon=0;
+
+    // Offsets
+    writer.GetPos(block.columns[ColumnDataFile::columnOffset]);
+
+    FileOffset lastOffset=0;
+
+    for (const auto offset : offsets) {
+      writer.WriteNumber(offset-lastOffset);
+
+      lastOffset=offset;
+    }
+
+    // Parts
+    writer.GetPos(block.columns[ColumnDataFile::columnPart]);
+
+    if (objectType==refArea) {
+      for (const auto partCount : partCounts) {
+        writer.WriteNumber(partCount);
+      }
+
+      for (const auto& part : parts) {
+        writer.Write(part.ring);
+      }
+    }
+
+    // Types
+    writer.GetPos(block.columns[ColumnDataFile::columnType]);
+
+    for (const auto& part : parts) {
+      writer.WriteNumber(part.typeId);
+    }
+
+    // Feature masks
+    writer.GetPos(block.columns[ColumnDataFile::columnFeatureMask]);
+
+    for (const auto& part : parts) {
+      TypeInfoRef          type=part.features.GetType();
+      std::vector<uint8_t> mask(type->GetFeatureMaskBytes(),0);
+
+      for (size_t idx=0; idx<type->GetFeatureCount(); idx++) {
+        if (part.features.HasValue(idx)) {
+          mask[idx/8]|=(uint8_t)(1 << idx%8);
+        }
+      }
+
+      if (!mask.empty()) {
+        writer.Write((const char*)mask.data(),
+                     mask.size());
+      }
+    }
+
+    // Feature values
+    writer.GetPos(block.columns[ColumnDataFile::columnFeatureValue]);
+
+    for (const auto& part : parts) {
+      for (const auto& feature : part.features.GetType()->GetFeatures()) {
+        size_t idx=feature.GetIndex();
+
+        if (part.features.HasValue(idx) &&
+            feature.GetFeature()->HasValue()) {
+          if (!part.features.GetValue(idx)->Write(writer)) {
+            return false;
+          }
+        }
+      }
+    }
+
+    // Coordinates
+    writer.GetPos(block.columns[ColumnDataFile::columnCoord]);
+
+    int64_t lastLat=0;
+    int64_t lastLon=0;
+
+    for (const auto& part : parts) {
+      writer.WriteNumber((uint32_t)part.nodes.size());
+
+      for (const auto& node : part.nodes) {
+        uint32_t lat=node.GetFixedLat();
+        uint32_t lon=node.GetFixedLon();
+
+        writer.WriteNumber((int64_t)lat-lastLat);
+        writer.WriteNumber((int64_t)lon-lastLon);
+
+        lastLat=lat;
+        lastLon=lon;
+
+        block.minLat=std::min(block.minLat,lat);
+        block.minLon=std::min(block.minLon,lon);
+        block.maxLat=std::max(block.maxLat,lat);
+        block.maxLon=std::max(block.maxLon,lon);
+      }
+    }
+
+    // Ids
+    writer.GetPos(block.columns[ColumnDataFile::columnId]);
+
+    if (objectType!=refNode) {
+      int64_t lastId=0;
+
+      for (const auto& part : parts) {
+        writer.WriteNumber((uint32_t)part.ids.size());
+
+        for (const auto id : part.ids) {
+          if (id==0) {
+            writer.WriteNumber((int64_t)0);
+          }
+          else {
+            int64_t delta=(int64_t)id-lastId;
+
+            writer.WriteNumber(delta>=0 ? delta+1 : delta);
+
+            lastId=(int64_t)id;
+          }
+        }
+      }
+    }
+
+    writer.GetPos(block.columns[ColumnDataFile::columnCount]);
+
+    blocks.push_back(block);
+
+    offsets.clear();
+    partCounts.clear();
+    parts.clear();
+
+    return !writer.HasError();
+  }
+
+  bool ColumnDataWriter::Close()
+  {
+    if (!offsets.empty() &&
+        !WriteBlock()) {
+      return false;
+    }
+
+    FileOffset directoryOffset;
+
+    writer.GetPos(directoryOffset);
+
+    for (const auto& block : blocks) {
+      writer.Write(block.objectCount);
+      writer.Write(block.partCount);
+      writer.Write(block.minLat);
+      writer.Write(block.minLon);
+      writer.Write(block.maxLat);
+      writer.Write(block.maxLon);
+
+      for (size_t c=0; c<=ColumnDataFile::columnCount; c++) {
+        writer.WriteFileOffset(block.columns[c]);
+      }
+    }
+
+    writer.SetPos(0);
+    writer.Write(objectCount);
+    writer.Write((uint32_t)blocks.size());
+    writer.Write((uint8_t)objectType);
+    writer.WriteFileOffset(directoryOffset);
+
+    return !writer.HasError() &&
+           writer.Close();
+  }
+}
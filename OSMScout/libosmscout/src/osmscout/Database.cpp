@@ -28,6 +28,7 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 
@@ -35,10 +36,15 @@ namespace osmscout {
 
   DatabaseParameter::DatabaseParameter()
   : areaAreaIndexCacheSize(1000),
+    areaAreaIndexRTree(true),
     areaNodeIndexCacheSize(1000),
     nodeCacheSize(1000),
     wayCacheSize(4000),
-    areaCacheSize(4000)
+    areaCacheSize(4000),
+    cacheMemoryBudget(0),
+    nodesDataMMap(true),
+    waysDataMMap(true),
+    areasDataMMap(true)
   {
     // no code
   }
@@ -48,6 +54,16 @@ namespace osmscout {
     this->areaAreaIndexCacheSize=areaAreaIndexCacheSize;
   }
 
+  /**
+   * If set to false, the quadtree in 'areaarea.idx' is used as area area
+   * index even if the database also contains the R-tree in 'areaarea.rtree'.
+   * Default is true.
+   */
+  void DatabaseParameter::SetAreaAreaIndexRTree(bool rtree)
+  {
+    areaAreaIndexRTree=rtree;
+  }
+
   void DatabaseParameter::SetAreaNodeIndexCacheSize(unsigned long areaNodeIndexCacheSize)
   {
     this->areaNodeIndexCacheSize=areaNodeIndexCacheSize;
@@ -68,11 +84,65 @@ namespace osmscout {
     this->areaCacheSize=areaCacheSize;
   }
 
+  /**
+   * If set to a value > 0, the caches of nodes, ways, areas and the area
+   * area index share the given memory budget (in bytes) and the memory is
+   * rebalanced between them depending on their hit rates. The configured
+   * cache sizes are then ignored, only a cache size of 0 still disables a cache.
+   * Default is 0, the caches are limited by their number of entries.
+   */
+  void DatabaseParameter::SetCacheMemoryBudget(unsigned long cacheMemoryBudget)
+  {
+    this->cacheMemoryBudget=cacheMemoryBudget;
+  }
+
+  /**
+   * If set to false, 'nodes.dat' is not memory mapped but read using
+   * (batched) file reads. Default is true.
+   */
+  void DatabaseParameter::SetNodesDataMMap(bool mmap)
+  {
+    nodesDataMMap=mmap;
+  }
+
+  /**
+   * If set to false, 'ways.dat' is not memory mapped but read using
+   * (batched) file reads. Default is true.
+   */
+  void DatabaseParameter::SetWaysDataMMap(bool mmap)
+  {
+    waysDataMMap=mmap;
+  }
+
+  /**
+   * If set to false, 'areas.dat' is not memory mapped but read using
+   * (batched) file reads. Default is true.
+   */
+  void DatabaseParameter::SetAreasDataMMap(bool mmap)
+  {
+    areasDataMMap=mmap;
+  }
+
+  /**
+   * Sets the name of the file the cache snapshot is read from in
+   * Database::Open() and written to in Database::Close(). An empty
+   * filename (the default) disables cache snapshots.
+   */
+  void DatabaseParameter::SetCacheSnapshotFile(const std::string& cacheSnapshotFile)
+  {
+    this->cacheSnapshotFile=cacheSnapshotFile;
+  }
+
   unsigned long DatabaseParameter::GetAreaAreaIndexCacheSize() const
   {
     return areaAreaIndexCacheSize;
   }
 
+  bool DatabaseParameter::GetAreaAreaIndexRTree() const
+  {
+    return areaAreaIndexRTree;
+  }
+
   unsigned long DatabaseParameter::GetAreaNodeIndexCacheSize() const
   {
     return areaNodeIndexCacheSize;
@@ -93,9 +163,37 @@ namespace osmscout {
     return areaCacheSize;
   }
 
+  unsigned long DatabaseParameter::GetCacheMemoryBudget() const
+  {
+    return cacheMemoryBudget;
+  }
+
+  bool DatabaseParameter::GetNodesDataMMap() const
+  {
+    return nodesDataMMap;
+  }
+
+  bool DatabaseParameter::GetWaysDataMMap() const
+  {
+    return waysDataMMap;
+  }
+
+  bool DatabaseParameter::GetAreasDataMMap() const
+  {
+    return areasDataMMap;
+  }
+
+  std::string DatabaseParameter::GetCacheSnapshotFile() const
+  {
+    return cacheSnapshotFile;
+  }
+
   Database::Database(const DatabaseParameter& parameter)
    : parameter(parameter),
      isOpen(false)
+#if defined(OSMSCOUT_HAVE_THREAD)
+     ,prefetchAborted(false)
+#endif
   {
     // no code
   }
@@ -139,11 +237,131 @@ namespace osmscout {
       return false;
     }
 
+    if (parameter.GetCacheMemoryBudget()>0) {
+      cacheManager=std::make_shared<CacheManager>(parameter.GetCacheMemoryBudget());
+    }
+
+    FileOffset snapshotSize;
+
+    // A missing snapshot is not an error, there is none on the first start
+    if (!parameter.GetCacheSnapshotFile().empty() &&
+        GetFileSize(parameter.GetCacheSnapshotFile(),
+                    snapshotSize)) {
+      if (cacheSnapshot.Read(parameter.GetCacheSnapshotFile())) {
+        log.Debug() << "Loaded cache snapshot '" << parameter.GetCacheSnapshotFile() << "'";
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+        prefetchAborted=false;
+        prefetchThread=std::thread(&Database::PrefetchFiles,this);
+#endif
+      }
+    }
+
     isOpen=true;
 
     return true;
   }
 
+  /**
+   * Reads the file regions referenced by the cache snapshot in file offset
+   * order, so that they are already in the page cache of the operating
+   * system when the caches of the data files and indexes get filled.
+   *
+   * Runs in its own thread and only uses its own file handles.
+   */
+  void Database::PrefetchFiles()
+  {
+#if defined(OSMSCOUT_HAVE_THREAD)
+    // Number of bytes read at each offset, should cover most objects
+    const size_t          blockSize=4096;
+    std::set<std::string> files;
+    std::vector<char>     buffer(blockSize);
+    StopClock             timer;
+    size_t                blockCount=0;
+
+    for (const auto& section : cacheSnapshot.GetSections()) {
+      files.insert(section.file);
+    }
+
+    for (const auto& file : files) {
+      std::string             filename=AppendFileToDir(path,file);
+      std::vector<FileOffset> offsets;
+      FileOffset              fileSize;
+      FileScanner             scanner;
+
+      for (const auto& section : cacheSnapshot.GetSections()) {
+        if (section.file==file &&
+            CacheSnapshot::IsValid(section,
+                                   filename)) {
+          offsets.insert(offsets.end(),
+                         section.keys.begin(),
+                         section.keys.end());
+        }
+      }
+
+      if (offsets.empty() ||
+          !GetFileSize(filename,
+                       fileSize)) {
+        continue;
+      }
+
+      std::sort(offsets.begin(),
+                offsets.end());
+
+      if (!scanner.Open(filename,
+                        FileScanner::Sequential,
+                        false)) {
+        continue;
+      }
+
+      FileOffset prefetchedEnd=0;
+
+      for (const auto offset : offsets) {
+        if (prefetchAborted) {
+          break;
+        }
+
+        if (offset<prefetchedEnd ||
+            offset>=fileSize) {
+          continue;
+        }
+
+        size_t bytes=(size_t)std::min((FileOffset)blockSize,
+                                      fileSize-offset);
+
+        if (!scanner.SetPos(offset) ||
+            !scanner.Read(buffer.data(),
+                          bytes)) {
+          break;
+        }
+
+        prefetchedEnd=offset+bytes;
+        blockCount++;
+      }
+
+      scanner.Close();
+
+      if (prefetchAborted) {
+        break;
+      }
+    }
+
+    timer.Stop();
+
+    log.Debug() << "Prefetching " << blockCount << " blocks of cache snapshot: " << timer.ResultString();
+#endif
+  }
+
+  void Database::StopPrefetch()
+  {
+#if defined(OSMSCOUT_HAVE_THREAD)
+    if (prefetchThread.joinable()) {
+      prefetchAborted=true;
+      prefetchThread.join();
+    }
+#endif
+  }
+
   bool Database::IsOpen() const
   {
     return isOpen;
@@ -151,6 +369,15 @@ namespace osmscout {
 
   void Database::Close()
   {
+    StopPrefetch();
+
+    if (isOpen &&
+        !parameter.GetCacheSnapshotFile().empty()) {
+      SaveCacheSnapshot(parameter.GetCacheSnapshotFile());
+    }
+
+    cacheSnapshot.Clear();
+
     if (nodeDataFile &&
         nodeDataFile->IsOpen()) {
       nodeDataFile->Close();
@@ -169,6 +396,10 @@ namespace osmscout {
       wayDataFile=NULL;
     }
 
+    nodeColumnFile=NULL;
+    wayColumnFile=NULL;
+    areaColumnFile=NULL;
+
     if (areaNodeIndex) {
       areaNodeIndex->Close();
       areaNodeIndex=NULL;
@@ -199,6 +430,15 @@ namespace osmscout {
         waterIndex=NULL;
     }
 
+    reverseGeocodeIndex=NULL;
+
+    if (poiIndex) {
+      poiIndex->Close();
+      poiIndex=NULL;
+    }
+
+    cacheManager=NULL;
+
     isOpen=false;
   }
 
@@ -217,6 +457,56 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Writes a snapshot of the keys of the entries in the caches of the data
+   * files and indexes to the given file. Sections of a snapshot loaded
+   * during Open() are carried over for files that have not been accessed
+   * since.
+   */
+  bool Database::SaveCacheSnapshot(const std::string& filename) const
+  {
+    CacheSnapshot snapshot;
+
+    if (nodeDataFile) {
+      nodeDataFile->GetCacheSnapshot(snapshot);
+    }
+    else {
+      snapshot.CopySections(cacheSnapshot,
+                            "nodes.dat");
+    }
+
+    if (areaDataFile) {
+      areaDataFile->GetCacheSnapshot(snapshot);
+    }
+    else {
+      snapshot.CopySections(cacheSnapshot,
+                            "areas.dat");
+    }
+
+    if (wayDataFile) {
+      wayDataFile->GetCacheSnapshot(snapshot);
+    }
+    else {
+      snapshot.CopySections(cacheSnapshot,
+                            "ways.dat");
+    }
+
+    if (areaAreaIndex) {
+      areaAreaIndex->GetCacheSnapshot(snapshot);
+    }
+    else {
+      snapshot.CopySections(cacheSnapshot,
+                            "areaarea.idx");
+    }
+
+    if (!snapshot.Write(filename)) {
+      log.Error() << "Cannot write cache snapshot '" << filename << "'";
+      return false;
+    }
+
+    return true;
+  }
+
   std::string Database::GetPath() const
   {
     return path;
@@ -227,6 +517,16 @@ namespace osmscout {
     return typeConfig;
   }
 
+  /**
+   * Returns the manager distributing the cache memory budget between the
+   * caches, which also provides the current memory split and the hit rates
+   * of the caches. Returns NULL if no cache memory budget is configured.
+   */
+  CacheManagerRef Database::GetCacheManager() const
+  {
+    return cacheManager;
+  }
+
   NodeDataFileRef Database::GetNodeDataFile() const
   {
     if (!IsOpen()) {
@@ -235,6 +535,11 @@ namespace osmscout {
 
     if (!nodeDataFile) {
       nodeDataFile=std::make_shared<NodeDataFile>(parameter.GetNodeCacheSize());
+
+      if (cacheManager &&
+          parameter.GetNodeCacheSize()>0) {
+        nodeDataFile->RegisterCache(*cacheManager);
+      }
     }
 
     if (!nodeDataFile->IsOpen()) {
@@ -243,11 +548,16 @@ namespace osmscout {
       if (!nodeDataFile->Open(typeConfig,
                               path,
                               FileScanner::LowMemRandom,
-                              true)) {
+                              parameter.GetNodesDataMMap())) {
         log.Error() << "Cannot open 'nodes.dat'!";
         return NULL;
       }
 
+      if (!cacheSnapshot.IsEmpty() &&
+          !nodeDataFile->PrefetchCacheSnapshot(cacheSnapshot)) {
+        log.Warn() << "Cannot prefetch cache snapshot for 'nodes.dat'";
+      }
+
       timer.Stop();
 
       log.Debug() << "Opening NodeDataFile: " << timer.ResultString();
@@ -265,6 +575,11 @@ namespace osmscout {
     if (!areaDataFile) {
       areaDataFile=std::make_shared<AreaDataFile>("areas.dat",
                                                   parameter.GetAreaCacheSize());
+
+      if (cacheManager &&
+          parameter.GetAreaCacheSize()>0) {
+        areaDataFile->RegisterCache(*cacheManager);
+      }
     }
 
     if (!areaDataFile->IsOpen()) {
@@ -273,11 +588,16 @@ namespace osmscout {
       if (!areaDataFile->Open(typeConfig,
                               path,
                               FileScanner::LowMemRandom,
-                              true)) {
+                              parameter.GetAreasDataMMap())) {
         log.Error() << "Cannot open 'areas.dat'!";
         return NULL;
       }
 
+      if (!cacheSnapshot.IsEmpty() &&
+          !areaDataFile->PrefetchCacheSnapshot(cacheSnapshot)) {
+        log.Warn() << "Cannot prefetch cache snapshot for 'areas.dat'";
+      }
+
       timer.Stop();
 
       log.Debug() << "Opening AreaDataFile: " << timer.ResultString();
@@ -295,6 +615,11 @@ namespace osmscout {
     if (!wayDataFile) {
       wayDataFile=std::make_shared<WayDataFile>("ways.dat",
                                                 parameter.GetWayCacheSize());
+
+      if (cacheManager &&
+          parameter.GetWayCacheSize()>0) {
+        wayDataFile->RegisterCache(*cacheManager);
+      }
     }
 
     if (!wayDataFile->IsOpen()) {
@@ -303,11 +628,16 @@ namespace osmscout {
       if (!wayDataFile->Open(typeConfig,
                              path,
                              FileScanner::LowMemRandom,
-                             true)) {
+                             parameter.GetWaysDataMMap())) {
         log.Error() << "Cannot open 'ways.dat'!";
         return NULL;
       }
 
+      if (!cacheSnapshot.IsEmpty() &&
+          !wayDataFile->PrefetchCacheSnapshot(cacheSnapshot)) {
+        log.Warn() << "Cannot prefetch cache snapshot for 'ways.dat'";
+      }
+
       timer.Stop();
 
       log.Debug() << "Opening WayDataFile: " << timer.ResultString();
@@ -316,6 +646,79 @@ namespace osmscout {
     return wayDataFile;
   }
 
+  /**
+   * Returns the given optional columnar copy of a data file, opening it on first
+   * access. Returns NULL, if the file does not exist or cannot be opened.
+   */
+  ColumnDataFileRef Database::GetColumnFile(const char* filename,
+                                            bool memoryMapped,
+                                            ColumnDataFileRef& columnFile) const
+  {
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!columnFile) {
+      FileOffset size;
+
+      if (!GetFileSize(AppendFileToDir(path,
+                                       filename),
+                       size)) {
+        return NULL;
+      }
+
+      StopClock timer;
+
+      columnFile=std::make_shared<ColumnDataFile>();
+
+      if (!columnFile->Open(typeConfig,
+                            path,
+                            filename,
+                            memoryMapped)) {
+        log.Error() << "Cannot open '" << filename << "'!";
+        columnFile=NULL;
+
+        return NULL;
+      }
+
+      timer.Stop();
+
+      log.Debug() << "Opening ColumnDataFile '" << filename << "': " << timer.ResultString();
+    }
+
+    return columnFile;
+  }
+
+  /**
+   * Returns the columnar copy of 'nodes.dat', if it has been written by the import
+   */
+  ColumnDataFileRef Database::GetNodeColumnFile() const
+  {
+    return GetColumnFile(ColumnDataFile::FILENAME_NODES_COL,
+                         parameter.GetNodesDataMMap(),
+                         nodeColumnFile);
+  }
+
+  /**
+   * Returns the columnar copy of 'ways.dat', if it has been written by the import
+   */
+  ColumnDataFileRef Database::GetWayColumnFile() const
+  {
+    return GetColumnFile(ColumnDataFile::FILENAME_WAYS_COL,
+                         parameter.GetWaysDataMMap(),
+                         wayColumnFile);
+  }
+
+  /**
+   * Returns the columnar copy of 'areas.dat', if it has been written by the import
+   */
+  ColumnDataFileRef Database::GetAreaColumnFile() const
+  {
+    return GetColumnFile(ColumnDataFile::FILENAME_AREAS_COL,
+                         parameter.GetAreasDataMMap(),
+                         areaColumnFile);
+  }
+
   AreaNodeIndexRef Database::GetAreaNodeIndex() const
   {
     if (!IsOpen()) {
@@ -349,7 +752,8 @@ namespace osmscout {
     }
 
     if (!areaAreaIndex) {
-      areaAreaIndex=std::make_shared<AreaAreaIndex>(parameter.GetAreaAreaIndexCacheSize());
+      areaAreaIndex=std::make_shared<AreaAreaIndex>(parameter.GetAreaAreaIndexCacheSize(),
+                                                    parameter.GetAreaAreaIndexRTree());
 
       StopClock timer;
 
@@ -360,6 +764,19 @@ namespace osmscout {
         return NULL;
       }
 
+      // The R-tree does not use the cache of the quadtree
+      if (cacheManager &&
+          parameter.GetAreaAreaIndexCacheSize()>0 &&
+          !areaAreaIndex->IsRTree()) {
+        areaAreaIndex->RegisterCache(*cacheManager);
+      }
+
+      if (!cacheSnapshot.IsEmpty() &&
+          !areaAreaIndex->PrefetchCacheSnapshot(typeConfig,
+                                                cacheSnapshot)) {
+        log.Warn() << "Cannot prefetch cache snapshot for 'areaarea.idx'";
+      }
+
       timer.Stop();
 
       log.Debug() << "Opening AreaAreaIndex: " << timer.ResultString();
@@ -421,6 +838,59 @@ namespace osmscout {
     return locationIndex;
   }
 
+  ReverseGeocodeIndexRef Database::GetReverseGeocodeIndex() const
+  {
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!reverseGeocodeIndex) {
+      reverseGeocodeIndex=std::make_shared<ReverseGeocodeIndex>();
+
+      StopClock timer;
+
+      if (!reverseGeocodeIndex->Load(path)) {
+        log.Error() << "Cannot load reverse geocode index!";
+        reverseGeocodeIndex=NULL;
+
+        return NULL;
+      }
+
+      timer.Stop();
+
+      log.Debug() << "Opening ReverseGeocodeIndex: " << timer.ResultString();
+    }
+
+    return reverseGeocodeIndex;
+  }
+
+  POIIndexRef Database::GetPOIIndex() const
+  {
+    if (!IsOpen()) {
+      return NULL;
+    }
+
+    if (!poiIndex) {
+      poiIndex=std::make_shared<POIIndex>();
+
+      StopClock timer;
+
+      if (!poiIndex->Load(*typeConfig,
+                          path)) {
+        log.Error() << "Cannot load POI index!";
+        poiIndex=NULL;
+
+        return NULL;
+      }
+
+      timer.Stop();
+
+      log.Debug() << "Opening POIIndex: " << timer.ResultString();
+    }
+
+    return poiIndex;
+  }
+
   WaterIndexRef Database::GetWaterIndex() const
   {
     if (!IsOpen()) {
@@ -703,6 +1173,10 @@ namespace osmscout {
 
   void Database::DumpStatistics()
   {
+    if (cacheManager) {
+      cacheManager->DumpStatistics();
+    }
+
     if (nodeDataFile) {
       nodeDataFile->DumpStatistics();
     }
@@ -94,6 +94,10 @@ namespace osmscout {
       return false;
     }
 
+    if (!tokenIndex.Load(path)) {
+      return false;
+    }
+
     return !scanner.HasError() && scanner.Close();
   }
 
@@ -277,13 +281,76 @@ namespace osmscout {
     }
   }
 
-  bool LocationIndex::LoadRegionDataEntry(FileScanner& scanner,
-                                          const AdminRegion& adminRegion,
-                                          LocationVisitor& visitor,
-                                          bool& stopped) const
+  /**
+   * Return the offset of the parent region of the region at the given offset.
+   * Already loaded parent offsets are cached in the given map.
+   */
+  bool LocationIndex::LoadParentRegionOffset(FileScanner& scanner,
+                                             std::unordered_map<FileOffset,FileOffset>& parentOffsets,
+                                             FileOffset regionOffset,
+                                             FileOffset& parentOffset) const
+  {
+    std::unordered_map<FileOffset,FileOffset>::const_iterator entry=parentOffsets.find(regionOffset);
+
+    if (entry!=parentOffsets.end()) {
+      parentOffset=entry->second;
+
+      return true;
+    }
+
+    AdminRegion region;
+
+    if (!scanner.SetPos(regionOffset)) {
+      return false;
+    }
+
+    if (!LoadAdminRegion(scanner,
+                         region)) {
+      return false;
+    }
+
+    parentOffsets[regionOffset]=region.parentRegionOffset;
+    parentOffset=region.parentRegionOffset;
+
+    return true;
+  }
+
+  /**
+   * Check if the region at the given offset is one of the given root regions
+   * or a sub region of one of them.
+   */
+  bool LocationIndex::IsRegionInSubtree(FileScanner& scanner,
+                                        std::unordered_map<FileOffset,FileOffset>& parentOffsets,
+                                        const std::unordered_set<FileOffset>& rootOffsets,
+                                        FileOffset regionOffset,
+                                        bool& inSubtree) const
+  {
+    inSubtree=false;
+
+    while (regionOffset!=0) {
+      if (rootOffsets.find(regionOffset)!=rootOffsets.end()) {
+        inSubtree=true;
+
+        return true;
+      }
+
+      if (!LoadParentRegionOffset(scanner,
+                                  parentOffsets,
+                                  regionOffset,
+                                  regionOffset)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool LocationIndex::LoadRegionPOIEntries(FileScanner& scanner,
+                                           const AdminRegion& adminRegion,
+                                           LocationVisitor& visitor,
+                                           bool& stopped) const
   {
     uint32_t poiCount;
-    uint32_t locationCount;
 
     if (!scanner.ReadNumber(poiCount)) {
       return false;
@@ -312,55 +379,90 @@ namespace osmscout {
       }
     }
 
-    if (!scanner.ReadNumber(locationCount)) {
+    return !scanner.HasError();
+  }
+
+  bool LocationIndex::LoadLocationEntry(FileScanner& scanner,
+                                        FileOffset regionOffset,
+                                        Location& location) const
+  {
+    uint32_t objectCount;
+
+    if (!scanner.GetPos(location.locationOffset)) {
       return false;
     }
 
-    for (size_t i=0; i<locationCount; i++) {
-      Location location;
-      uint32_t  objectCount;
+    if (!scanner.Read(location.name)) {
+      return false;
+    }
 
-      if (!scanner.GetPos(location.locationOffset)) {
-        return false;
-      }
+    location.regionOffset=regionOffset;
 
-      if (!scanner.Read(location.name)) {
-        return false;
-      }
+    if (!scanner.ReadNumber(objectCount)) {
+      return false;
+    }
+
+    location.objects.reserve(objectCount);
 
-      location.regionOffset=adminRegion.regionOffset;
+    bool hasAddresses;
+
+    if (!scanner.Read(hasAddresses)) {
+      return false;
+    }
 
-      if (!scanner.ReadNumber(objectCount)) {
+    if (hasAddresses) {
+      if (!scanner.ReadFileOffset(location.addressesOffset)) {
         return false;
       }
+    }
+    else {
+      location.addressesOffset=0;
+    }
 
-      location.objects.reserve(objectCount);
+    ObjectFileRefStreamReader objectFileRefReader(scanner);
 
-      bool hasAddresses;
+    for (size_t j=0; j<objectCount; j++) {
+      ObjectFileRef ref;
 
-      if (!scanner.Read(hasAddresses)) {
+      if (!objectFileRefReader.Read(ref)) {
         return false;
       }
 
-      if (hasAddresses) {
-        if (!scanner.ReadFileOffset(location.addressesOffset)) {
-          return false;
-        }
-      }
-      else {
-        location.addressesOffset=0;
-      }
+      location.objects.push_back(ref);
+    }
+
+    return !scanner.HasError();
+  }
+
+  bool LocationIndex::LoadRegionDataEntry(FileScanner& scanner,
+                                          const AdminRegion& adminRegion,
+                                          LocationVisitor& visitor,
+                                          bool& stopped) const
+  {
+    uint32_t locationCount;
 
-      objectFileRefReader.Reset();
+    if (!LoadRegionPOIEntries(scanner,
+                              adminRegion,
+                              visitor,
+                              stopped)) {
+      return false;
+    }
 
-      for (size_t j=0; j<objectCount; j++) {
-        ObjectFileRef ref;
+    if (stopped) {
+      return true;
+    }
 
-        if (!objectFileRefReader.Read(ref)) {
-          return false;
-        }
+    if (!scanner.ReadNumber(locationCount)) {
+      return false;
+    }
 
-        location.objects.push_back(ref);
+    for (size_t i=0; i<locationCount; i++) {
+      Location location;
+
+      if (!LoadLocationEntry(scanner,
+                             adminRegion.regionOffset,
+                             location)) {
+        return false;
       }
 
       if (!visitor.Visit(adminRegion,
@@ -536,6 +638,89 @@ namespace osmscout {
     return !scanner.HasError() && scanner.Close();
   }
 
+  /**
+   * Visit all admin regions, whose name or alias might match the given pattern.
+   * The visitor is called in the same order as for a complete traversal, but is
+   * not called for regions that cannot match the pattern. If the location token index
+   * is not available or cannot be used for the pattern, all regions are visited.
+   */
+  bool LocationIndex::VisitAdminRegions(const std::string& pattern,
+                                        AdminRegionVisitor& visitor) const
+  {
+    std::vector<LocationTokenIndex::Entry> entries;
+    bool                                   indexed;
+
+    if (!tokenIndex.GetEntries(pattern,
+                               entries,
+                               indexed)) {
+      return false;
+    }
+
+    if (!indexed) {
+      return VisitAdminRegions(visitor);
+    }
+
+    FileScanner scanner;
+
+    if (!scanner.Open(AppendFileToDir(path,
+                                      FILENAME_LOCATION_IDX),
+                      FileScanner::LowMemRandom,
+                      true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    std::unordered_map<FileOffset,FileOffset> parentOffsets;
+    std::unordered_set<FileOffset>            skippedOffsets;
+
+    for (const auto& entry : entries) {
+      if (entry.type!=LocationTokenIndex::entryRegion) {
+        continue;
+      }
+
+      if (!skippedOffsets.empty()) {
+        bool skipped;
+
+        if (!IsRegionInSubtree(scanner,
+                               parentOffsets,
+                               skippedOffsets,
+                               entry.offset,
+                               skipped)) {
+          return false;
+        }
+
+        if (skipped) {
+          continue;
+        }
+      }
+
+      AdminRegion region;
+
+      if (!scanner.SetPos(entry.offset)) {
+        return false;
+      }
+
+      if (!LoadAdminRegion(scanner,
+                           region)) {
+        return false;
+      }
+
+      AdminRegionVisitor::Action action=visitor.Visit(region);
+
+      if (action==AdminRegionVisitor::error) {
+        return false;
+      }
+      else if (action==AdminRegionVisitor::stop) {
+        break;
+      }
+      else if (action==AdminRegionVisitor::skipChildren) {
+        skippedOffsets.insert(region.regionOffset);
+      }
+    }
+
+    return !scanner.HasError() && scanner.Close();
+  }
+
   bool LocationIndex::VisitAdminRegionLocations(const AdminRegion& region,
                                                 LocationVisitor& visitor,
                                                 bool recursive) const
@@ -569,6 +754,114 @@ namespace osmscout {
     return !scanner.HasError() && scanner.Close();
   }
 
+  /**
+   * Visit all POIs and locations within the given admin region and its sub regions,
+   * whose name might match the given pattern. The visitor is called in the same order
+   * as for a complete recursive traversal, but is not called for locations that cannot
+   * match the pattern. POIs are visited for all regions having at least one POI
+   * that might match. If the location token index is not available or cannot be used
+   * for the pattern, all POIs and locations are visited.
+   */
+  bool LocationIndex::VisitAdminRegionLocations(const AdminRegion& region,
+                                                const std::string& pattern,
+                                                LocationVisitor& visitor) const
+  {
+    std::vector<LocationTokenIndex::Entry> entries;
+    bool                                   indexed;
+
+    if (!tokenIndex.GetEntries(pattern,
+                               entries,
+                               indexed)) {
+      return false;
+    }
+
+    if (!indexed) {
+      return VisitAdminRegionLocations(region,
+                                       visitor,
+                                       true);
+    }
+
+    FileScanner scanner;
+
+    if (!scanner.Open(AppendFileToDir(path,
+                                      FILENAME_LOCATION_IDX),
+                      FileScanner::LowMemRandom,
+                      true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    std::unordered_map<FileOffset,FileOffset> parentOffsets;
+    std::unordered_set<FileOffset>            rootOffsets;
+    AdminRegion                               entryRegion;
+    bool                                      stopped=false;
+
+    rootOffsets.insert(region.regionOffset);
+    entryRegion.regionOffset=0;
+
+    for (const auto& entry : entries) {
+      if (entry.type==LocationTokenIndex::entryRegion) {
+        continue;
+      }
+
+      bool inSubtree;
+
+      if (!IsRegionInSubtree(scanner,
+                             parentOffsets,
+                             rootOffsets,
+                             entry.regionOffset,
+                             inSubtree)) {
+        return false;
+      }
+
+      if (!inSubtree) {
+        continue;
+      }
+
+      if (entryRegion.regionOffset!=entry.regionOffset) {
+        if (!scanner.SetPos(entry.regionOffset)) {
+          return false;
+        }
+
+        if (!LoadAdminRegion(scanner,
+                             entryRegion)) {
+          return false;
+        }
+      }
+
+      if (!scanner.SetPos(entry.offset)) {
+        return false;
+      }
+
+      if (entry.type==LocationTokenIndex::entryPOI) {
+        if (!LoadRegionPOIEntries(scanner,
+                                  entryRegion,
+                                  visitor,
+                                  stopped)) {
+          return false;
+        }
+      }
+      else {
+        Location location;
+
+        if (!LoadLocationEntry(scanner,
+                               entryRegion.regionOffset,
+                               location)) {
+          return false;
+        }
+
+        stopped=!visitor.Visit(entryRegion,
+                               location);
+      }
+
+      if (stopped) {
+        break;
+      }
+    }
+
+    return !scanner.HasError() && scanner.Close();
+  }
+
   bool LocationIndex::VisitLocationAddresses(const AdminRegion& region,
                                              const Location& location,
                                              AddressVisitor& visitor) const
@@ -601,6 +894,25 @@ namespace osmscout {
 
   bool LocationIndex::ResolveAdminRegionHierachie(const AdminRegionRef& adminRegion,
                                                   std::map<FileOffset,AdminRegionRef >& refs) const
+  {
+    std::set<FileOffset> offsets;
+
+    refs[adminRegion->regionOffset]=adminRegion;
+
+    if (adminRegion->parentRegionOffset!=0) {
+      offsets.insert(adminRegion->parentRegionOffset);
+    }
+
+    return ResolveAdminRegionHierachie(offsets,
+                                       refs);
+  }
+
+  /**
+   * Load the admin regions at the given offsets together with all their
+   * parent regions. Regions already part of refs are not loaded again.
+   */
+  bool LocationIndex::ResolveAdminRegionHierachie(const std::set<FileOffset>& regionOffsets,
+                                                  std::map<FileOffset,AdminRegionRef >& refs) const
   {
     FileScanner scanner;
 
@@ -616,13 +928,8 @@ namespace osmscout {
       return false;
     }
 
-    std::list<FileOffset> offsets;
-
-    refs[adminRegion->regionOffset]=adminRegion;
-
-    if (adminRegion->parentRegionOffset!=0) {
-      offsets.push_back(adminRegion->parentRegionOffset);
-    }
+    std::list<FileOffset> offsets(regionOffsets.begin(),
+                                  regionOffsets.end());
 
     while (!offsets.empty()) {
       std::list<FileOffset> newOffsets;
@@ -659,6 +966,47 @@ namespace osmscout {
     return !scanner.HasError() && scanner.Close();
   }
 
+  /**
+   * Load the locations at the given offsets
+   *
+   * @param locationRegionOffsets
+   *    Map of the offsets of the locations to the offsets of the admin regions
+   *    they belong to
+   * @param locations
+   *    Map of the offsets of the locations to the loaded locations
+   */
+  bool LocationIndex::ResolveLocations(const std::map<FileOffset,FileOffset>& locationRegionOffsets,
+                                       std::map<FileOffset,LocationRef>& locations) const
+  {
+    FileScanner scanner;
+
+    if (!scanner.Open(AppendFileToDir(path,
+                                      FILENAME_LOCATION_IDX),
+                      FileScanner::LowMemRandom,
+                      true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    for (const auto& entry : locationRegionOffsets) {
+      Location location;
+
+      if (!scanner.SetPos(entry.first)) {
+        return false;
+      }
+
+      if (!LoadLocationEntry(scanner,
+                             entry.second,
+                             location)) {
+        return false;
+      }
+
+      locations[entry.first]=std::make_shared<Location>(location);
+    }
+
+    return !scanner.HasError() && scanner.Close();
+  }
+
   void LocationIndex::DumpStatistics()
   {
     size_t memory=0;
@@ -48,27 +48,7 @@ namespace osmscout {
 
   void LocationService::VisitorMatcher::TolowerUmlaut(std::string& s) const
   {
-    for (std::string::iterator it=s.begin();
-         it!=s.end();
-         ++it)
-    {
-      /* this filter matches all character from the table
-       * http://en.wikipedia.org/wiki/Latin-1_Supplement_%28Unicode_block%29#Compact_table
-       * beginning at U+0x00C0 to U+0x00DE
-       */
-      if((uint8_t)*it == 0xC3)
-      {
-        ++it;
-
-        if((uint8_t)*it>=0x80 && (uint8_t)*it<=0x9E) {
-          // 0x9F is german "sz" which is already small caps.
-          *it+=0x20;
-        }
-      }
-      else {
-        *it=tolower(*it);
-      }
-    }
+    LocationTokenIndex::NormalizeName(s);
   }
 
   LocationService::AdminRegionMatchVisitor::AdminRegionMatchVisitor(const std::string& pattern,
@@ -483,13 +463,20 @@ namespace osmscout {
 
     //std::cout << "  Search for location '" << searchEntry.locationPattern << "'" << " in " << adminRegionResult.adminRegion->name << "/" << adminRegionResult.adminRegion->aliasName << std::endl;
 
+    LocationIndexRef locationIndex=database->GetLocationIndex();
+
+    if (!locationIndex) {
+      return false;
+    }
+
     LocationMatchVisitor visitor(adminRegionResult.adminRegion,
                                  searchEntry.locationPattern,
                                  search.limit>=result.results.size() ? search.limit-result.results.size() : 0);
 
 
-    if (!VisitAdminRegionLocations(*adminRegionResult.adminRegion,
-                                   visitor)) {
+    if (!locationIndex->VisitAdminRegionLocations(*adminRegionResult.adminRegion,
+                                                  searchEntry.locationPattern,
+                                                  visitor)) {
       log.Error() << "Error during traversal of region location list";
       return false;
     }
@@ -840,6 +827,12 @@ namespace osmscout {
   bool LocationService::SearchForLocations(const LocationSearch& search,
                                            LocationSearchResult& result) const
   {
+    LocationIndexRef locationIndex=database->GetLocationIndex();
+
+    if (!locationIndex) {
+      return false;
+    }
+
     result.limitReached=false;
     result.results.clear();
 
@@ -853,7 +846,8 @@ namespace osmscout {
       AdminRegionMatchVisitor adminRegionVisitor(searchEntry.adminRegionPattern,
                                                  search.limit);
 
-      if (!VisitAdminRegions(adminRegionVisitor)) {
+      if (!locationIndex->VisitAdminRegions(searchEntry.adminRegionPattern,
+                                            adminRegionVisitor)) {
         log.Error() << "Error during traversal of region tree";
         return false;
       }
@@ -885,8 +879,8 @@ namespace osmscout {
   public:
     struct SearchEntry
     {
-      ObjectFileRef         object;
-      std::vector<GeoCoord> coords;
+      ObjectFileRef                object;
+      std::vector<CompactGeoCoord> coords;
     };
 
   private:
@@ -1251,4 +1245,113 @@ namespace osmscout {
     return ReverseLookupObjects(objects,
                                 result);
   }
+
+  /**
+   * Find the nearest address and the nearest location (street,...) together
+   * with the admin region hierarchy for a batch of coordinates. The coordinates
+   * are processed in parallel using the reverse geocode index, so passing many
+   * coordinates at once is much faster than passing them one by one.
+   *
+   * @param coords
+   *    The coordinates to look up
+   * @param maxDistance
+   *    Maximum distance in meter of an address or a location to the coordinate
+   * @param results
+   *    List of results, one entry for each coordinate in the same order as the coordinates
+   * @return
+   *    True, if there was no error
+   */
+  bool LocationService::ReverseGeocode(const std::vector<GeoCoord>& coords,
+                                       double maxDistance,
+                                       std::vector<ReverseGeocodeResult>& results) const
+  {
+    results.clear();
+
+    LocationIndexRef       locationIndex=database->GetLocationIndex();
+    ReverseGeocodeIndexRef reverseGeocodeIndex=database->GetReverseGeocodeIndex();
+
+    if (!locationIndex ||
+        !reverseGeocodeIndex) {
+      return false;
+    }
+
+    std::vector<ReverseGeocodeIndex::Result> matches;
+
+    if (!reverseGeocodeIndex->Lookup(coords,
+                                     maxDistance,
+                                     matches)) {
+      return false;
+    }
+
+    std::set<FileOffset>                regionOffsets;
+    std::map<FileOffset,FileOffset>     locationRegionOffsets;
+    std::map<FileOffset,AdminRegionRef> regions;
+    std::map<FileOffset,LocationRef>    locations;
+
+    for (const auto& match : matches) {
+      if (match.hasLocation) {
+        regionOffsets.insert(match.location.regionOffset);
+        locationRegionOffsets[match.location.locationOffset]=match.location.regionOffset;
+      }
+
+      if (match.hasAddress) {
+        regionOffsets.insert(match.address.regionOffset);
+        locationRegionOffsets[match.address.locationOffset]=match.address.regionOffset;
+      }
+    }
+
+    if (!locationIndex->ResolveAdminRegionHierachie(regionOffsets,
+                                                    regions) ||
+        !locationIndex->ResolveLocations(locationRegionOffsets,
+                                         locations)) {
+      return false;
+    }
+
+    results.resize(coords.size());
+
+    for (size_t i=0; i<coords.size(); i++) {
+      const ReverseGeocodeIndex::Result& match=matches[i];
+      ReverseGeocodeResult&              result=results[i];
+
+      result.coord=coords[i];
+      result.locationDistance=0.0;
+      result.addressDistance=0.0;
+
+      if (match.hasLocation) {
+        result.location=locations[match.location.locationOffset];
+        result.locationDistance=match.locationDistance;
+        result.adminRegion=regions[match.location.regionOffset];
+      }
+
+      if (match.hasAddress) {
+        result.address=std::make_shared<Address>();
+        result.address->addressOffset=match.address.addressOffset;
+        result.address->locationOffset=match.address.locationOffset;
+        result.address->regionOffset=match.address.regionOffset;
+        result.address->name=match.address.name;
+        result.address->object=match.address.object;
+
+        result.addressLocation=locations[match.address.locationOffset];
+        result.addressDistance=match.addressDistance;
+
+        // The region of an address is more specific than the region of a location
+        // that might just pass by
+        result.adminRegion=regions[match.address.regionOffset];
+      }
+
+      AdminRegionRef region=result.adminRegion;
+
+      while (region) {
+        result.adminRegions.push_back(region);
+
+        if (region->parentRegionOffset==0) {
+          break;
+        }
+
+        region=regions[region->parentRegionOffset];
+      }
+    }
+
+    return true;
+  }
 }
@@ -0,0 +1,416 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/LocationTokenIndex.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
+
+namespace osmscout {
+
+  const char* const LocationTokenIndex::FILENAME_LOCATIONTOKEN_IDX = "locationtoken.idx";
+
+  LocationTokenIndex::LocationTokenIndex()
+  : isAvailable(false),
+    entryCount(0),
+    entryTableOffset(0),
+    termCount(0)
+  {
+    // no code
+  }
+
+  LocationTokenIndex::~LocationTokenIndex()
+  {
+    // no code
+  }
+
+  /**
+   * Load the index. The index is optional, if it does not exist, the
+   * method returns true, but the index is marked as not available.
+   *
+   * The file consists of:
+   * - The offset of the term index
+   * - The number of entries followed by the entry table, each entry
+   *   of size ENTRY_SIZE
+   * - For each term its posting list: the number of entry ids followed
+   *   by the delta encoded, sorted entry ids
+   * - The sorted list of terms, each followed by the offset of its posting list
+   * - The term index: the number of terms, the number of term index
+   *   entries and every TERM_INDEX_INTERVAL'th term together with its offset
+   *   in the term list
+   */
+  bool LocationTokenIndex::Load(const std::string& path)
+  {
+    std::string filename=AppendFileToDir(path,
+                                         FILENAME_LOCATIONTOKEN_IDX);
+    FileOffset  fileSize;
+
+    this->path=path;
+
+    isAvailable=false;
+    termIndex.clear();
+
+    if (!GetFileSize(filename,
+                     fileSize)) {
+      log.Debug() << "No location token index found, location search will scan the location index";
+      return true;
+    }
+
+    FileScanner scanner;
+
+    if (!scanner.Open(filename,
+                      FileScanner::LowMemRandom,
+                      false)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    FileOffset termIndexOffset;
+    uint32_t   termIndexCount;
+
+    if (!scanner.ReadFileOffset(termIndexOffset) ||
+        !scanner.ReadNumber(entryCount) ||
+        !scanner.GetPos(entryTableOffset)) {
+      log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    if (!scanner.SetPos(termIndexOffset) ||
+        !scanner.ReadNumber(termCount) ||
+        !scanner.ReadNumber(termIndexCount)) {
+      log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    termIndex.resize(termIndexCount);
+
+    for (auto& entry : termIndex) {
+      if (!scanner.Read(entry.term) ||
+          !scanner.ReadFileOffset(entry.offset)) {
+        log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+    }
+
+    if (scanner.HasError() || !scanner.Close()) {
+      return false;
+    }
+
+    isAvailable=true;
+
+    return true;
+  }
+
+  /**
+   * Return the sorted ids of all entries having a term starting with the given token
+   */
+  bool LocationTokenIndex::GetTokenEntryIds(FileScanner& scanner,
+                                            const std::string& token,
+                                            std::vector<uint32_t>& ids) const
+  {
+    TermIndexEntry                              searchEntry;
+    std::vector<TermIndexEntry>::const_iterator indexEntry;
+    std::vector<FileOffset>                     postingOffsets;
+
+    ids.clear();
+
+    if (termIndex.empty()) {
+      return true;
+    }
+
+    searchEntry.term=token;
+
+    // The first term starting with the token is part of the block of the last
+    // index term smaller than the token
+    indexEntry=std::lower_bound(termIndex.begin(),
+                                termIndex.end(),
+                                searchEntry);
+
+    if (indexEntry!=termIndex.begin()) {
+      --indexEntry;
+    }
+
+    size_t termPos=(indexEntry-termIndex.begin())*TERM_INDEX_INTERVAL;
+
+    if (!scanner.SetPos(indexEntry->offset)) {
+      return false;
+    }
+
+    while (termPos<termCount) {
+      std::string term;
+      FileOffset  postingOffset;
+
+      if (!scanner.Read(term) ||
+          !scanner.ReadFileOffset(postingOffset)) {
+        return false;
+      }
+
+      termPos++;
+
+      if (term<token) {
+        continue;
+      }
+
+      if (term.compare(0,token.length(),token)!=0) {
+        break;
+      }
+
+      postingOffsets.push_back(postingOffset);
+    }
+
+    for (const auto& postingOffset : postingOffsets) {
+      uint32_t idCount;
+      uint32_t id=0;
+
+      if (!scanner.SetPos(postingOffset) ||
+          !scanner.ReadNumber(idCount)) {
+        return false;
+      }
+
+      for (size_t i=0; i<idCount; i++) {
+        uint32_t delta;
+
+        if (!scanner.ReadNumber(delta)) {
+          return false;
+        }
+
+        id+=delta;
+
+        ids.push_back(id);
+      }
+    }
+
+    if (postingOffsets.size()>1) {
+      std::sort(ids.begin(),
+                ids.end());
+
+      ids.erase(std::unique(ids.begin(),
+                            ids.end()),
+                ids.end());
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Return all entries that might match the given pattern, sorted by their
+   * offset in the location index. Only tokens of the pattern with at least
+   * MIN_TOKEN_LENGTH bytes are used for the lookup.
+   *
+   * @param pattern
+   *    The search pattern
+   * @param entries
+   *    The entries possibly matching the pattern
+   * @param indexed
+   *    Set to false, if the index is not available or the pattern does not
+   *    contain a token that can be looked up. In this case the entries are
+   *    empty and all entries have to be considered.
+   * @return
+   *    True, if there was no error
+   */
+  bool LocationTokenIndex::GetEntries(const std::string& pattern,
+                                      std::vector<Entry>& entries,
+                                      bool& indexed) const
+  {
+    OSMSCOUT_TRACE_SPAN("index","LocationTokenIndex::GetEntries");
+
+    std::list<std::string> tokens;
+
+    entries.clear();
+    indexed=false;
+
+    if (!isAvailable) {
+      return true;
+    }
+
+    GetTokens(pattern,
+              tokens);
+
+    // Tokens starting in the middle of an UTF-8 sequence are not indexed
+    tokens.remove_if([](const std::string& token) {
+      return token.length()<MIN_TOKEN_LENGTH ||
+             ((uint8_t)token[0] & 0xc0)==0x80;
+    });
+
+    if (tokens.empty()) {
+      return true;
+    }
+
+    FileScanner scanner;
+
+    if (!scanner.Open(AppendFileToDir(path,
+                                      FILENAME_LOCATIONTOKEN_IDX),
+                      FileScanner::LowMemRandom,
+                      true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    std::vector<uint32_t> ids;
+    bool                  firstToken=true;
+
+    for (const auto& token : tokens) {
+      std::vector<uint32_t> tokenIds;
+
+      if (!GetTokenEntryIds(scanner,
+                            token,
+                            tokenIds)) {
+        log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+
+      if (firstToken) {
+        ids.swap(tokenIds);
+        firstToken=false;
+      }
+      else {
+        std::vector<uint32_t> intersection;
+
+        std::set_intersection(ids.begin(),
+                              ids.end(),
+                              tokenIds.begin(),
+                              tokenIds.end(),
+                              std::back_inserter(intersection));
+
+        ids.swap(intersection);
+      }
+
+      if (ids.empty()) {
+        break;
+      }
+    }
+
+    entries.reserve(ids.size());
+
+    for (const auto& id : ids) {
+      Entry   entry;
+      uint8_t type;
+
+      if (id>=entryCount ||
+          !scanner.SetPos(entryTableOffset+id*ENTRY_SIZE) ||
+          !scanner.Read(type) ||
+          !scanner.ReadFileOffset(entry.regionOffset) ||
+          !scanner.ReadFileOffset(entry.offset)) {
+        log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+
+      entry.type=(EntryType)type;
+
+      entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(),
+              entries.end());
+
+    entries.erase(std::unique(entries.begin(),
+                              entries.end()),
+                  entries.end());
+
+    indexed=true;
+
+    return !scanner.HasError() && scanner.Close();
+  }
+
+  /**
+   * Convert the given name to lower case, including the upper case characters
+   * of the Latin-1 supplement.
+   */
+  void LocationTokenIndex::NormalizeName(std::string& name)
+  {
+    for (std::string::iterator it=name.begin();
+         it!=name.end();
+         ++it)
+    {
+      /* this filter matches all character from the table
+       * http://en.wikipedia.org/wiki/Latin-1_Supplement_%28Unicode_block%29#Compact_table
+       * beginning at U+0x00C0 to U+0x00DE
+       */
+      if((uint8_t)*it == 0xC3)
+      {
+        ++it;
+
+        if (it==name.end()) {
+          break;
+        }
+
+        if((uint8_t)*it>=0x80 && (uint8_t)*it<=0x9E) {
+          // 0x9F is german "sz" which is already small caps.
+          *it+=0x20;
+        }
+      }
+      else {
+        *it=tolower(*it);
+      }
+    }
+  }
+
+  /**
+   * Normalize the given name and split it into tokens. Tokens are separated
+   * by all ASCII characters that are neither letters nor digits.
+   */
+  void LocationTokenIndex::GetTokens(const std::string& name,
+                                     std::list<std::string>& tokens)
+  {
+    std::string normalizedName(name);
+    size_t      start=0;
+
+    NormalizeName(normalizedName);
+
+    tokens.clear();
+
+    for (size_t i=0; i<=normalizedName.length(); i++) {
+      if (i==normalizedName.length() ||
+          ((uint8_t)normalizedName[i]<0x80 &&
+           !isalnum((uint8_t)normalizedName[i]))) {
+        if (i>start) {
+          tokens.push_back(normalizedName.substr(start,i-start));
+        }
+
+        start=i+1;
+      }
+    }
+  }
+
+  /**
+   * Return all terms to be indexed for the given name: all suffixes
+   * of its tokens starting at a character boundary with at least
+   * MIN_TOKEN_LENGTH bytes.
+   */
+  void LocationTokenIndex::GetIndexTerms(const std::string& name,
+                                         std::set<std::string>& terms)
+  {
+    std::list<std::string> tokens;
+
+    GetTokens(name,
+              tokens);
+
+    for (const auto& token : tokens) {
+      for (size_t pos=0; pos+MIN_TOKEN_LENGTH<=token.length(); pos++) {
+        if (((uint8_t)token[pos] & 0xc0)!=0x80) {
+          terms.insert(token.substr(pos));
+        }
+      }
+    }
+  }
+}
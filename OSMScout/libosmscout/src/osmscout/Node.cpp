@@ -36,6 +36,14 @@ namespace osmscout {
     featureValueBuffer.Set(buffer);
   }
 
+  /**
+   * Returns the memory (in bytes) used by the node and its features
+   */
+  size_t Node::GetMemory() const
+  {
+    return sizeof(Node)+featureValueBuffer.GetMemory();
+  }
+
   bool Node::Read(const TypeConfig& typeConfig,
                   FileScanner& scanner)
   {
@@ -19,7 +19,273 @@
 
 #include <osmscout/NumericIndex.h>
 
+#include <osmscout/util/Logger.h>
+
 namespace osmscout {
 
-}
+  static inline void PutValue(char* buffer,
+                              uint64_t value,
+                              uint8_t bytes)
+  {
+    for (uint8_t i=0; i<bytes; i++) {
+      buffer[i]=(char)((value >> (8*i)) & 0xff);
+    }
+  }
+
+  NumericIndexWriter::NumericIndexWriter()
+  : pageSize(0),
+    entryCount(0),
+    addedCount(0),
+    minId(0),
+    lastKey(0),
+    leafStart(0),
+    idBytes(0),
+    offsetBytes(0),
+    levelCount(0)
+  {
+    // no code
+  }
+
+  /**
+    Writes the given values as fixed width entries into pages of pageSize
+    bytes. Each page holds blockSize entries, the rest of the page is filled
+    with zeros. The first key of each page is returned in levelFirstKeys.
+    */
+  bool NumericIndexWriter::WriteLevel(uint8_t levelOffsetBytes,
+                                      const std::vector<uint64_t>& levelKeys,
+                                      const std::vector<FileOffset>& levelOffsets,
+                                      std::vector<uint64_t>& levelFirstKeys)
+  {
+    size_t            entryBytes=idBytes+levelOffsetBytes;
+    size_t            blockSize=pageSize/entryBytes;
+    std::vector<char> page(pageSize);
+
+    levelFirstKeys.clear();
+    levelFirstKeys.reserve(levelKeys.size()/blockSize+1);
+
+    for (size_t start=0; start<levelKeys.size(); start+=blockSize) {
+      size_t end=std::min(start+blockSize,levelKeys.size());
+      char*  entry=page.data();
+
+      std::fill(page.begin(),
+                page.end(),
+                0);
+
+      for (size_t i=start; i<end; i++) {
+        PutValue(entry,levelKeys[i],idBytes);
+
+        if (levelOffsetBytes>0) {
+          PutValue(entry+idBytes,levelOffsets[i],levelOffsetBytes);
+        }
+
+        entry+=entryBytes;
+      }
+
+      levelFirstKeys.push_back(levelKeys[start]);
+
+      if (!writer.Write(page.data(),
+                        page.size())) {
+        log.Error() << "Cannot write index page to '" << writer.GetFilename() << "'";
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+    Creates the index file for the given number of entries with ids in the range
+    [minId,maxId] and file offsets less than dataFileSize. The range defines the
+    number of bytes per id, the size of the data file the number of bytes per
+    file offset.
+    */
+  bool NumericIndexWriter::Open(const std::string& filename,
+                                uint32_t pageSize,
+                                uint32_t entryCount,
+                                uint64_t minId,
+                                uint64_t maxId,
+                                FileOffset dataFileSize)
+  {
+    this->pageSize=pageSize;
+    this->entryCount=entryCount;
+    this->minId=minId;
+
+    addedCount=0;
+    lastKey=0;
+    keys.clear();
+    offsets.clear();
+    firstKeys.clear();
+
+    idBytes=1;
+
+    for (uint64_t range=(maxId-minId) >> 8;
+         range>0;
+         range=range >> 8) {
+      idBytes++;
+    }
+
+    offsetBytes=BytesNeededToAddressFileData(dataFileSize);
+
+    if (pageSize<2*(idBytes+offsetBytes) ||
+        pageSize<64) {
+      log.Error() << "Index page size " << pageSize << " is too small for '" << filename << "'";
+      return false;
+    }
+
+    size_t leafBlockSize=pageSize/(idBytes+offsetBytes);
+    size_t innerBlockSize=pageSize/idBytes;
+
+    levelCount=1;
+
+    for (size_t count=(entryCount+leafBlockSize-1)/leafBlockSize;
+         count>1;
+         count=(count+innerBlockSize-1)/innerBlockSize) {
+      levelCount++;
+    }
+
+    if (!writer.Open(filename)) {
+      log.Error() << "Cannot create '" << filename << "'";
+      return false;
+    }
+
+    // Fixed fields plus file offset and entry count of each level, padded to
+    // full pages
+    size_t            headerSize=4+4+8+1+1+4+levelCount*(8+4);
+    std::vector<char> header((headerSize+pageSize-1)/pageSize*pageSize,0);
+
+    // Placeholder for the header, written on Close()
+    if (!writer.Write(header.data(),
+                      header.size())) {
+      log.Error() << "Cannot write file header to '" << filename << "'";
+      return false;
+    }
+
+    writer.GetPos(leafStart);
 
+    keys.reserve(leafBlockSize);
+    offsets.reserve(leafBlockSize);
+
+    return true;
+  }
+
+  /**
+    Adds the file offset of the object with the given id. Ids have to be
+    added in ascending order. Ids are stored relative to the smallest id
+    (modulo 2^64), so negative ids cast to uint64_t are supported, too.
+    */
+  bool NumericIndexWriter::Add(uint64_t id,
+                               FileOffset offset)
+  {
+    uint64_t key=id-minId;
+
+    if (addedCount>=entryCount) {
+      log.Error() << "More than " << entryCount << " entries added to '" << writer.GetFilename() << "'";
+      return false;
+    }
+
+    if (addedCount>0 &&
+        key<=lastKey) {
+      log.Error() << "Ids added to '" << writer.GetFilename() << "' are not sorted ascending";
+      return false;
+    }
+
+    keys.push_back(key);
+    offsets.push_back(offset);
+
+    lastKey=key;
+    addedCount++;
+
+    if (keys.size()==pageSize/(idBytes+offsetBytes)) {
+      std::vector<uint64_t> pageKeys;
+
+      if (!WriteLevel(offsetBytes,
+                      keys,
+                      offsets,
+                      pageKeys)) {
+        return false;
+      }
+
+      firstKeys.push_back(pageKeys.front());
+      keys.clear();
+      offsets.clear();
+    }
+
+    return true;
+  }
+
+  /**
+    Writes the last leaf page, the upper levels and the file header.
+    */
+  bool NumericIndexWriter::Close()
+  {
+    std::vector<FileOffset> levelStarts;
+    std::vector<uint32_t>   levelCounts;
+    std::vector<uint64_t>   levelKeys;
+    FileOffset              levelStart;
+
+    if (addedCount!=entryCount) {
+      log.Error() << "Expected " << entryCount << " entries, but " << addedCount << " were added to '" << writer.GetFilename() << "'";
+      writer.Close();
+      return false;
+    }
+
+    if (!keys.empty()) {
+      std::vector<uint64_t> pageKeys;
+
+      if (!WriteLevel(offsetBytes,
+                      keys,
+                      offsets,
+                      pageKeys)) {
+        writer.Close();
+        return false;
+      }
+
+      firstKeys.push_back(pageKeys.front());
+      keys.clear();
+      offsets.clear();
+    }
+
+    levelStarts.push_back(leafStart);
+    levelCounts.push_back(entryCount);
+
+    while (firstKeys.size()>1) {
+      levelKeys.swap(firstKeys);
+
+      writer.GetPos(levelStart);
+      levelStarts.push_back(levelStart);
+      levelCounts.push_back((uint32_t)levelKeys.size());
+
+      if (!WriteLevel(0,
+                      levelKeys,
+                      offsets,
+                      firstKeys)) {
+        writer.Close();
+        return false;
+      }
+    }
+
+    if (levelStarts.size()!=levelCount) {
+      log.Error() << "Expected " << levelCount << " levels, but wrote " << levelStarts.size() << " to '" << writer.GetFilename() << "'";
+      writer.Close();
+      return false;
+    }
+
+    writer.SetPos(0);
+
+    writer.Write(pageSize);                  // Size of one index page in bytes
+    writer.Write(entryCount);                // Number of entries in data file
+    writer.Write(minId);                     // Smallest id
+    writer.Write(idBytes);                   // Bytes per id
+    writer.Write(offsetBytes);               // Bytes per file offset
+    writer.Write(levelCount);                // Number of levels
+
+    // Levels, starting with the top level
+    for (size_t i=levelStarts.size(); i>0; i--) {
+      writer.WriteFileOffset(levelStarts[i-1]);
+      writer.Write(levelCounts[i-1]);
+    }
+
+    return !writer.HasError() &&
+           writer.Close();
+  }
+}
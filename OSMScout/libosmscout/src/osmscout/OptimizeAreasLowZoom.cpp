@@ -29,6 +29,7 @@
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 #include <osmscout/util/Transformation.h>
 
 #include <iostream>
@@ -270,6 +271,8 @@ namespace osmscout
                                       TypeSet& areaTypes,
                                       std::vector<AreaRef>& areas) const
   {
+    OSMSCOUT_TRACE_SPAN("index","OptimizeAreasLowZoom::GetAreas");
+
     std::vector<FileOffset> offsets;
 
     if (!scanner.IsOpen()) {
@@ -29,6 +29,7 @@
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 #include <osmscout/util/Transformation.h>
 
 namespace osmscout
@@ -268,6 +269,8 @@ namespace osmscout
                                     std::vector<TypeSet>& wayTypes,
                                     std::vector<WayRef>& ways) const
   {
+    OSMSCOUT_TRACE_SPAN("index","OptimizeWaysLowZoom::GetWays");
+
     std::vector<FileOffset> offsets;
 
     if (!scanner.IsOpen()) {
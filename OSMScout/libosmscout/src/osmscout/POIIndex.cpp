@@ -0,0 +1,370 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/POIIndex.h>
+
+#include <algorithm>
+#include <queue>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
+
+namespace osmscout {
+
+  const char* const POIIndex::FILENAME_POI_IDX = "poi.idx";
+
+  //! Length of one degree of latitude in meter (on a sphere with the mean earth radius)
+  static const double metersPerDegree=6371010.0*M_PI/180.0;
+
+  /**
+   * A node of a tree or an entry waiting to be visited
+   */
+  struct POIQueueEntry
+  {
+    double          distance;   //!< (Minimum) distance to the search position
+    bool            isEntry;    //!< Entry is valid, else nodeOffset
+    FileOffset      nodeOffset; //!< Offset of the node
+    POIIndex::Entry entry;      //!< The entry
+  };
+
+  /**
+   * Order the queue so that the nearest element is on top. For equal
+   * distances entries are visited before nodes, so an entry is returned as
+   * early as possible.
+   */
+  struct POIQueueEntryCompare
+  {
+    inline bool operator()(const POIQueueEntry& a,
+                           const POIQueueEntry& b) const
+    {
+      if (a.distance!=b.distance) {
+        return a.distance>b.distance;
+      }
+
+      return !a.isEntry && b.isEntry;
+    }
+  };
+
+  /**
+   * Visitor collecting the first limit entries
+   */
+  class POINearestCollector : public POIIndexVisitor
+  {
+  private:
+    size_t                        limit;
+    std::vector<POIIndex::Entry>& entries;
+    std::vector<double>&          distances;
+
+  public:
+    POINearestCollector(size_t limit,
+                        std::vector<POIIndex::Entry>& entries,
+                        std::vector<double>& distances)
+    : limit(limit),
+      entries(entries),
+      distances(distances)
+    {
+      // no code
+    }
+
+    bool Visit(const POIIndex::Entry& entry,
+               double distance)
+    {
+      entries.push_back(entry);
+      distances.push_back(distance);
+
+      return entries.size()<limit;
+    }
+  };
+
+  POIIndexVisitor::~POIIndexVisitor()
+  {
+    // no code
+  }
+
+  POIIndex::POIIndex()
+  {
+    // no code
+  }
+
+  POIIndex::~POIIndex()
+  {
+    Close();
+  }
+
+  void POIIndex::Close()
+  {
+    if (scanner.IsOpen()) {
+      scanner.Close();
+    }
+  }
+
+  /**
+   * Load the index.
+   *
+   * The file consists of:
+   * - The offset of the type index
+   * - The nodes of all trees, the nodes of a tree are written level by level
+   *   starting with the leafs. A node consists of the number of its children,
+   *   a flag signaling a leaf node and the children. Children of a leaf are
+   *   the coordinate and the object of an entry, children of the other nodes
+   *   are the bounding box and the offset of a node of the next lower level.
+   * - The type index: the number of types and for each type the type index,
+   *   the number of entries and the offset of the root node
+   */
+  bool POIIndex::Load(const TypeConfig& typeConfig,
+                      const std::string& path)
+  {
+    FileOffset typeIndexOffset;
+    uint32_t   typeCount;
+
+    datafilename=AppendFileToDir(path,
+                                 FILENAME_POI_IDX);
+
+    typeData.clear();
+
+    if (!scanner.Open(datafilename,
+                      FileScanner::LowMemRandom,
+                      true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    if (!scanner.ReadFileOffset(typeIndexOffset) ||
+        !scanner.SetPos(typeIndexOffset) ||
+        !scanner.ReadNumber(typeCount)) {
+      log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    for (size_t i=0; i<typeCount; i++) {
+      uint32_t typeIndex;
+      TypeData data;
+
+      if (!scanner.ReadNumber(typeIndex) ||
+          !scanner.ReadNumber(data.entryCount) ||
+          !scanner.ReadFileOffset(data.rootOffset)) {
+        log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+
+      if (typeIndex>=typeConfig.GetTypeCount()) {
+        log.Error() << "Unknown type index " << typeIndex << " in file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+
+      data.type=typeConfig.GetTypeInfo(typeIndex);
+
+      typeData.push_back(data);
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Visit the entries of the given types in the order of their distance to the
+   * given coordinate.
+   *
+   * @param coord
+   *    The search position
+   * @param types
+   *    Only entries of these types are visited
+   * @param maxDistance
+   *    Maximum distance in meter of a visited entry to the search position
+   * @param visitor
+   *    Visitor called for each entry until it returns false
+   * @return
+   *    True, if there was no error
+   */
+  bool POIIndex::VisitNearest(const GeoCoord& coord,
+                              const TypeInfoSet& types,
+                              double maxDistance,
+                              POIIndexVisitor& visitor) const
+  {
+    OSMSCOUT_TRACE_SPAN("index","POIIndex::VisitNearest");
+
+    std::priority_queue<POIQueueEntry,
+                        std::vector<POIQueueEntry>,
+                        POIQueueEntryCompare> queue;
+
+    if (!scanner.IsOpen()) {
+      if (!scanner.Open(datafilename,
+                        FileScanner::LowMemRandom,
+                        true)) {
+        log.Error() << "Error while opening file '" << scanner.GetFilename() << "' for reading!";
+        return false;
+      }
+    }
+
+    for (const auto& data : typeData) {
+      if (data.entryCount>0 &&
+          types.IsSet(data.type)) {
+        POIQueueEntry root;
+
+        root.distance=0.0;
+        root.isEntry=false;
+        root.nodeOffset=data.rootOffset;
+
+        queue.push(root);
+      }
+    }
+
+    while (!queue.empty()) {
+      POIQueueEntry current=queue.top();
+
+      queue.pop();
+
+      if (current.isEntry) {
+        if (!visitor.Visit(current.entry,
+                           current.distance)) {
+          return true;
+        }
+
+        continue;
+      }
+
+      uint32_t childCount;
+      bool     isLeaf;
+
+      if (!scanner.SetPos(current.nodeOffset) ||
+          !scanner.ReadNumber(childCount) ||
+          !scanner.Read(isLeaf)) {
+        log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+
+      for (size_t c=0; c<childCount; c++) {
+        POIQueueEntry child;
+
+        if (isLeaf) {
+          child.isEntry=true;
+          child.nodeOffset=0;
+
+          if (!scanner.ReadCoord(child.entry.coord) ||
+              !scanner.Read(child.entry.object)) {
+            log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+            return false;
+          }
+
+          child.distance=GetDistance(coord,
+                                     child.entry.coord);
+        }
+        else {
+          GeoBox boundingBox;
+
+          child.isEntry=false;
+
+          if (!scanner.ReadBox(boundingBox) ||
+              !scanner.ReadFileOffset(child.nodeOffset)) {
+            log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+            return false;
+          }
+
+          child.distance=GetDistance(coord,
+                                     boundingBox);
+        }
+
+        if (child.distance<=maxDistance) {
+          queue.push(child);
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the nearest entries of the given types, ordered by their distance to
+   * the given coordinate.
+   *
+   * @param coord
+   *    The search position
+   * @param types
+   *    Only entries of these types are returned
+   * @param limit
+   *    Maximum number of entries returned
+   * @param maxDistance
+   *    Maximum distance in meter of an entry to the search position
+   * @param entries
+   *    The resulting entries
+   * @param distances
+   *    The distance in meter of each entry
+   * @return
+   *    True, if there was no error
+   */
+  bool POIIndex::GetNearest(const GeoCoord& coord,
+                            const TypeInfoSet& types,
+                            size_t limit,
+                            double maxDistance,
+                            std::vector<Entry>& entries,
+                            std::vector<double>& distances) const
+  {
+    entries.clear();
+    distances.clear();
+
+    if (limit==0) {
+      return true;
+    }
+
+    POINearestCollector collector(limit,
+                                  entries,
+                                  distances);
+
+    return VisitNearest(coord,
+                        types,
+                        maxDistance,
+                        collector);
+  }
+
+  /**
+   * Return the distance in meter between the two coordinates.
+   *
+   * The distance is calculated in a local equirectangular projection around
+   * coord, which is precise enough for the distances of nearby POIs and allows
+   * an exact minimum distance to a bounding box.
+   */
+  double POIIndex::GetDistance(const GeoCoord& coord,
+                               const GeoCoord& other)
+  {
+    double dx=(other.GetLon()-coord.GetLon())*metersPerDegree*cos(coord.GetLat()*M_PI/180.0);
+    double dy=(other.GetLat()-coord.GetLat())*metersPerDegree;
+
+    return sqrt(dx*dx+dy*dy);
+  }
+
+  /**
+   * Return the minimum distance in meter between the coordinate and any point
+   * within the bounding box, measured like GetDistance() between coordinates.
+   */
+  double POIIndex::GetDistance(const GeoCoord& coord,
+                               const GeoBox& boundingBox)
+  {
+    GeoCoord nearest(std::max(boundingBox.GetMinLat(),
+                              std::min(boundingBox.GetMaxLat(),
+                                       coord.GetLat())),
+                     std::max(boundingBox.GetMinLon(),
+                              std::min(boundingBox.GetMaxLon(),
+                                       coord.GetLon())));
+
+    return GetDistance(coord,
+                       nearest);
+  }
+}
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 
+#include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 
 #if _OPENMP
@@ -29,6 +30,165 @@
 
 namespace osmscout {
 
+  //! Radius in meter for searching the routable node next to the search position and to a POI
+  static const double routableNodeRadius=1000.0;
+
+  POIResult::POIResult()
+  : distance(0.0),
+    routeDistance(0.0)
+  {
+    // no code
+  }
+
+  /**
+   * Visitor collecting the POIs with the shortest routes. Since the air distance
+   * is a lower bound for the length of the route, the search can stop as soon
+   * as the air distance of the next POI is longer than the longest of the
+   * limit shortest routes found so far.
+   */
+  class POIRouteCollector : public POIIndexVisitor
+  {
+  private:
+    RoutingService&         router;
+    const RoutingProfile&   profile;
+    ObjectFileRef           startObject;
+    size_t                  startNodeIndex;
+    size_t                  limit;
+    std::vector<POIResult>& pois;
+
+  public:
+    bool                    error;
+
+  private:
+    bool GetRouteDistance(const GeoCoord& coord,
+                          bool& found,
+                          double& routeDistance)
+    {
+      ObjectFileRef targetObject;
+      size_t        targetNodeIndex;
+
+      found=false;
+
+      if (!router.GetClosestRoutableNode(coord.GetLat(),
+                                         coord.GetLon(),
+                                         router.GetVehicle(),
+                                         routableNodeRadius,
+                                         targetObject,
+                                         targetNodeIndex)) {
+        return false;
+      }
+
+      if (!targetObject.Valid()) {
+        return true;
+      }
+
+      RouteData route;
+
+      // No route found, the POI is not reachable
+      if (!router.CalculateRoute(profile,
+                                 startObject,
+                                 startNodeIndex,
+                                 targetObject,
+                                 targetNodeIndex,
+                                 route) ||
+          route.IsEmpty()) {
+        return true;
+      }
+
+      std::list<Point> points;
+
+      if (!router.TransformRouteDataToPoints(route,
+                                             points)) {
+        return false;
+      }
+
+      routeDistance=0.0;
+
+      std::list<Point>::const_iterator last=points.end();
+
+      for (std::list<Point>::const_iterator point=points.begin();
+           point!=points.end();
+           ++point) {
+        if (last!=points.end()) {
+          routeDistance+=GetEllipsoidalDistance(last->GetLon(),
+                                                last->GetLat(),
+                                                point->GetLon(),
+                                                point->GetLat())*1000.0;
+        }
+
+        last=point;
+      }
+
+      found=true;
+
+      return true;
+    }
+
+  public:
+    POIRouteCollector(RoutingService& router,
+                      const RoutingProfile& profile,
+                      const ObjectFileRef& startObject,
+                      size_t startNodeIndex,
+                      size_t limit,
+                      std::vector<POIResult>& pois)
+    : router(router),
+      profile(profile),
+      startObject(startObject),
+      startNodeIndex(startNodeIndex),
+      limit(limit),
+      pois(pois),
+      error(false)
+    {
+      // no code
+    }
+
+    bool Visit(const POIIndex::Entry& entry,
+               double distance)
+    {
+      if (pois.size()>=limit &&
+          pois.back().routeDistance<=distance) {
+        return false;
+      }
+
+      bool   found;
+      double routeDistance;
+
+      if (!GetRouteDistance(entry.coord,
+                            found,
+                            routeDistance)) {
+        error=true;
+        return false;
+      }
+
+      if (!found) {
+        return true;
+      }
+
+      POIResult poi;
+
+      poi.object=entry.object;
+      poi.coord=entry.coord;
+      poi.distance=distance;
+      poi.routeDistance=routeDistance;
+
+      std::vector<POIResult>::iterator position=std::upper_bound(pois.begin(),
+                                                                 pois.end(),
+                                                                 poi,
+                                                                 [](const POIResult& a, const POIResult& b) {
+        return a.routeDistance<b.routeDistance;
+      });
+
+      pois.insert(position,
+                  poi);
+
+      if (pois.size()>limit) {
+        pois.pop_back();
+      }
+
+      return true;
+    }
+  };
+
   POIService::POIService(const DatabaseRef& database)
    : database(database)
   {
@@ -56,31 +216,46 @@ namespace osmscout {
                                   const TypeSet& types,
                                   std::vector<NodeRef>& nodes) const
   {
-    AreaNodeIndexRef areaNodeIndex=database->GetAreaNodeIndex();
-    NodeDataFileRef  nodeDataFile=database->GetNodeDataFile();
+    ColumnDataFileRef nodeColumnFile=database->GetNodeColumnFile();
+    NodeDataFileRef   nodeDataFile=database->GetNodeDataFile();
 
     nodes.clear();
 
-    if (!areaNodeIndex ||
-        !nodeDataFile) {
+    if (!nodeDataFile) {
       return false;
     }
 
     std::vector<FileOffset> nodeOffsets;
 
-    if (!areaNodeIndex->GetOffsets(boundingBox.GetMinLon(),
-                                   boundingBox.GetMinLat(),
-                                   boundingBox.GetMaxLon(),
-                                   boundingBox.GetMaxLat(),
-                                   types,
-                                   std::numeric_limits<size_t>::max(),
-                                   nodeOffsets)) {
-      log.Error() << "Error getting nodes from area node index!";
-      return false;
+    if (nodeColumnFile) {
+      if (!nodeColumnFile->GetOffsets(boundingBox,
+                                      types,
+                                      nodeOffsets)) {
+        log.Error() << "Error getting nodes from columnar data file!";
+        return false;
+      }
+    }
+    else {
+      AreaNodeIndexRef areaNodeIndex=database->GetAreaNodeIndex();
+
+      if (!areaNodeIndex) {
+        return false;
+      }
+
+      if (!areaNodeIndex->GetOffsets(boundingBox.GetMinLon(),
+                                     boundingBox.GetMinLat(),
+                                     boundingBox.GetMaxLon(),
+                                     boundingBox.GetMaxLat(),
+                                     types,
+                                     std::numeric_limits<size_t>::max(),
+                                     nodeOffsets)) {
+        log.Error() << "Error getting nodes from area node index!";
+        return false;
+      }
+
+      std::sort(nodeOffsets.begin(),
+                nodeOffsets.end());
     }
-
-    std::sort(nodeOffsets.begin(),
-              nodeOffsets.end());
 
     if (!nodeDataFile->GetByOffset(nodeOffsets,
                                    nodes)) {
@@ -108,33 +283,49 @@ namespace osmscout {
                                   const TypeSet& types,
                                   std::vector<AreaRef>& areas) const
   {
-    AreaAreaIndexRef areaAreaIndex=database->GetAreaAreaIndex();
-    AreaDataFileRef  areaDataFile=database->GetAreaDataFile();
+    ColumnDataFileRef areaColumnFile=database->GetAreaColumnFile();
+    AreaDataFileRef   areaDataFile=database->GetAreaDataFile();
 
     areas.clear();
 
-    if (!areaAreaIndex ||
-        !areaDataFile) {
+    if (!areaDataFile) {
       return false;
     }
 
     std::vector<FileOffset> wayAreaOffsets;
 
-    if (!areaAreaIndex->GetOffsets(database->GetTypeConfig(),
-                                   boundingBox.GetMinLon(),
-                                   boundingBox.GetMinLat(),
-                                   boundingBox.GetMaxLon(),
-                                   boundingBox.GetMaxLat(),
-                                   std::numeric_limits<size_t>::max(),
-                                   types,
-                                   std::numeric_limits<size_t>::max(),
-                                   wayAreaOffsets)) {
-      log.Error() << "Error getting ways and relations from area index!";
+    if (areaColumnFile) {
+      if (!areaColumnFile->GetOffsets(boundingBox,
+                                      types,
+                                      wayAreaOffsets)) {
+        log.Error() << "Error getting areas from columnar data file!";
 
-      return false;
+        return false;
+      }
+    }
+    else {
+      AreaAreaIndexRef areaAreaIndex=database->GetAreaAreaIndex();
+
+      if (!areaAreaIndex) {
+        return false;
+      }
+
+      if (!areaAreaIndex->GetOffsets(database->GetTypeConfig(),
+                                     boundingBox.GetMinLon(),
+                                     boundingBox.GetMinLat(),
+                                     boundingBox.GetMaxLon(),
+                                     boundingBox.GetMaxLat(),
+                                     std::numeric_limits<size_t>::max(),
+                                     types,
+                                     std::numeric_limits<size_t>::max(),
+                                     wayAreaOffsets)) {
+        log.Error() << "Error getting ways and relations from area index!";
+
+        return false;
+      }
+
+      std::sort(wayAreaOffsets.begin(),wayAreaOffsets.end());
     }
-
-    std::sort(wayAreaOffsets.begin(),wayAreaOffsets.end());
 
     if (!areaDataFile->GetByOffset(wayAreaOffsets,
                                    areas)) {
@@ -162,36 +353,50 @@ namespace osmscout {
                                  const TypeSet& types,
                                  std::vector<WayRef>& ways) const
   {
-    AreaWayIndexRef  areaWayIndex=database->GetAreaWayIndex();
-    WayDataFileRef   wayDataFile=database->GetWayDataFile();
+    ColumnDataFileRef wayColumnFile=database->GetWayColumnFile();
+    WayDataFileRef    wayDataFile=database->GetWayDataFile();
 
     ways.clear();
 
-    if (!areaWayIndex ||
-        !wayDataFile) {
+    if (!wayDataFile) {
       return false;
     }
 
-    std::vector<TypeSet>    wayTypes;
     std::vector<FileOffset> wayWayOffsets;
 
+    if (wayColumnFile) {
+      if (!wayColumnFile->GetOffsets(boundingBox,
+                                     types,
+                                     wayWayOffsets)) {
+        log.Error() << "Error getting ways from columnar data file!";
 
-    wayTypes.push_back(types);
+        return false;
+      }
+    }
+    else {
+      AreaWayIndexRef      areaWayIndex=database->GetAreaWayIndex();
+      std::vector<TypeSet> wayTypes;
 
+      if (!areaWayIndex) {
+        return false;
+      }
 
-    if (!areaWayIndex->GetOffsets(boundingBox.GetMinLon(),
-                                  boundingBox.GetMinLat(),
-                                  boundingBox.GetMaxLon(),
-                                  boundingBox.GetMaxLat(),
-                                  wayTypes,
-                                  std::numeric_limits<size_t>::max(),
-                                  wayWayOffsets)) {
-      log.Error() << "Error getting ways and relations from area way index!";
+      wayTypes.push_back(types);
 
-      return false;
-    }
+      if (!areaWayIndex->GetOffsets(boundingBox.GetMinLon(),
+                                    boundingBox.GetMinLat(),
+                                    boundingBox.GetMaxLon(),
+                                    boundingBox.GetMaxLat(),
+                                    wayTypes,
+                                    std::numeric_limits<size_t>::max(),
+                                    wayWayOffsets)) {
+        log.Error() << "Error getting ways and relations from area way index!";
 
-    std::sort(wayWayOffsets.begin(),wayWayOffsets.end());
+        return false;
+      }
+
+      std::sort(wayWayOffsets.begin(),wayWayOffsets.end());
+    }
 
     if (!wayDataFile->GetByOffset(wayWayOffsets,
                                   ways)) {
@@ -266,4 +471,219 @@ namespace osmscout {
 
     return true;
   }
+
+  /**
+   * Load the objects of the given POIs.
+   */
+  bool POIService::LoadPOIs(std::vector<POIResult>& pois) const
+  {
+    NodeDataFileRef nodeDataFile=database->GetNodeDataFile();
+    WayDataFileRef  wayDataFile=database->GetWayDataFile();
+    AreaDataFileRef areaDataFile=database->GetAreaDataFile();
+
+    if (!nodeDataFile ||
+        !wayDataFile ||
+        !areaDataFile) {
+      return false;
+    }
+
+    std::set<FileOffset> nodeOffsets;
+    std::set<FileOffset> wayOffsets;
+    std::set<FileOffset> areaOffsets;
+
+    for (const auto& poi : pois) {
+      switch (poi.object.GetType()) {
+      case refNode:
+        nodeOffsets.insert(poi.object.GetFileOffset());
+        break;
+      case refWay:
+        wayOffsets.insert(poi.object.GetFileOffset());
+        break;
+      case refArea:
+        areaOffsets.insert(poi.object.GetFileOffset());
+        break;
+      default:
+        break;
+      }
+    }
+
+    std::unordered_map<FileOffset,NodeRef> nodeMap;
+    std::unordered_map<FileOffset,WayRef>  wayMap;
+    std::unordered_map<FileOffset,AreaRef> areaMap;
+
+    if (!nodeDataFile->GetByOffset(nodeOffsets,
+                                   nodeMap) ||
+        !wayDataFile->GetByOffset(wayOffsets,
+                                  wayMap) ||
+        !areaDataFile->GetByOffset(areaOffsets,
+                                   areaMap)) {
+      log.Error() << "Error reading POIs!";
+      return false;
+    }
+
+    for (auto& poi : pois) {
+      switch (poi.object.GetType()) {
+      case refNode:
+        poi.node=nodeMap[poi.object.GetFileOffset()];
+        break;
+      case refWay:
+        poi.way=wayMap[poi.object.GetFileOffset()];
+        break;
+      case refArea:
+        poi.area=areaMap[poi.object.GetFileOffset()];
+        break;
+      default:
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the POIs of the given types nearest to the given position, ordered
+   * by their air distance. Only the resulting objects are loaded.
+   *
+   * @param coord
+   *    The search position
+   * @param types
+   *    The resulting objects must be of one of these types
+   * @param limit
+   *    The maximum number of POIs returned
+   * @param maxDistance
+   *    The maximum air distance in meter of a POI to the search position
+   * @param pois
+   *    Result of the query, in case the query succeeded. In case of errors
+   *    the result is empty.
+   * @return
+   *    True, if success, else false
+   */
+  bool POIService::GetNearestPOIs(const GeoCoord& coord,
+                                  const TypeInfoSet& types,
+                                  size_t limit,
+                                  double maxDistance,
+                                  std::vector<POIResult>& pois) const
+  {
+    POIIndexRef                  poiIndex=database->GetPOIIndex();
+    std::vector<POIIndex::Entry> entries;
+    std::vector<double>          distances;
+
+    pois.clear();
+
+    if (!poiIndex) {
+      return false;
+    }
+
+    if (!poiIndex->GetNearest(coord,
+                              types,
+                              limit,
+                              maxDistance,
+                              entries,
+                              distances)) {
+      log.Error() << "Error getting POIs from POI index!";
+      return false;
+    }
+
+    pois.resize(entries.size());
+
+    for (size_t i=0; i<entries.size(); i++) {
+      pois[i].object=entries[i].object;
+      pois[i].coord=entries[i].coord;
+      pois[i].distance=distances[i];
+    }
+
+    if (!LoadPOIs(pois)) {
+      pois.clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the POIs of the given types nearest to the given position, ordered
+   * by the length of the route to them. POIs that cannot be reached are skipped.
+   * Only the resulting objects are loaded.
+   *
+   * Candidates are routed to in the order of their air distance, until the air
+   * distance of the next candidate is longer than the routes already found.
+   *
+   * @param router
+   *    The (opened) routing service used for calculating the routes
+   * @param profile
+   *    The routing profile
+   * @param coord
+   *    The search position
+   * @param types
+   *    The resulting objects must be of one of these types
+   * @param limit
+   *    The maximum number of POIs returned
+   * @param maxDistance
+   *    The maximum air distance in meter of a POI to the search position
+   * @param pois
+   *    Result of the query, in case the query succeeded. In case of errors
+   *    the result is empty.
+   * @return
+   *    True, if success, else false
+   */
+  bool POIService::GetNearestPOIsByRoute(RoutingService& router,
+                                         const RoutingProfile& profile,
+                                         const GeoCoord& coord,
+                                         const TypeInfoSet& types,
+                                         size_t limit,
+                                         double maxDistance,
+                                         std::vector<POIResult>& pois) const
+  {
+    POIIndexRef   poiIndex=database->GetPOIIndex();
+    ObjectFileRef startObject;
+    size_t        startNodeIndex;
+
+    pois.clear();
+
+    if (!poiIndex) {
+      return false;
+    }
+
+    if (limit==0) {
+      return true;
+    }
+
+    if (!router.GetClosestRoutableNode(coord.GetLat(),
+                                       coord.GetLon(),
+                                       router.GetVehicle(),
+                                       routableNodeRadius,
+                                       startObject,
+                                       startNodeIndex)) {
+      log.Error() << "Error while searching for routing node near start location!";
+      return false;
+    }
+
+    if (!startObject.Valid()) {
+      return true;
+    }
+
+    POIRouteCollector collector(router,
+                                profile,
+                                startObject,
+                                startNodeIndex,
+                                limit,
+                                pois);
+
+    if (!poiIndex->VisitNearest(coord,
+                                types,
+                                maxDistance,
+                                collector) ||
+        collector.error) {
+      log.Error() << "Error getting POIs from POI index!";
+      pois.clear();
+      return false;
+    }
+
+    if (!LoadPOIs(pois)) {
+      pois.clear();
+      return false;
+    }
+
+    return true;
+  }
 }
@@ -0,0 +1,466 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ReverseGeocodeIndex.h>
+
+#include <algorithm>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace osmscout {
+
+  const char* const ReverseGeocodeIndex::FILENAME_REVERSEGEOCODE_IDX = "reversegeocode.idx";
+
+  //! Length of one degree of latitude in meter (on a sphere with the mean earth radius)
+  static const double metersPerDegree=6371010.0*M_PI/180.0;
+
+  ReverseGeocodeIndex::Result::Result()
+  : hasLocation(false),
+    locationDistance(0.0),
+    hasAddress(false),
+    addressDistance(0.0)
+  {
+    // no code
+  }
+
+  ReverseGeocodeIndex::ReverseGeocodeIndex()
+  {
+    // no code
+  }
+
+  ReverseGeocodeIndex::~ReverseGeocodeIndex()
+  {
+    // no code
+  }
+
+  /**
+   * Load the index of all cells.
+   *
+   * The file consists of:
+   * - The offset of the cell index
+   * - For each non empty cell in Hilbert order the number of segments followed
+   *   by the segments and the number of address points followed by the points
+   * - The cell index: the number of cells and for each cell the delta encoded
+   *   cell id and the offset of its data
+   */
+  bool ReverseGeocodeIndex::Load(const std::string& path)
+  {
+    FileScanner scanner;
+    FileOffset  cellIndexOffset;
+    uint32_t    cellCount;
+
+    this->path=path;
+
+    cellIds.clear();
+    cellOffsets.clear();
+
+    if (!scanner.Open(AppendFileToDir(path,
+                                      FILENAME_REVERSEGEOCODE_IDX),
+                      FileScanner::LowMemRandom,
+                      false)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    if (!scanner.ReadFileOffset(cellIndexOffset) ||
+        !scanner.SetPos(cellIndexOffset) ||
+        !scanner.ReadNumber(cellCount)) {
+      log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    cellIds.resize(cellCount);
+    cellOffsets.resize(cellCount);
+
+    uint64_t cellId=0;
+
+    for (size_t i=0; i<cellCount; i++) {
+      uint64_t delta;
+
+      if (!scanner.ReadNumber(delta) ||
+          !scanner.ReadFileOffset(cellOffsets[i])) {
+        log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+        return false;
+      }
+
+      cellId+=delta;
+      cellIds[i]=cellId;
+    }
+
+    return !scanner.HasError() && scanner.Close();
+  }
+
+  bool ReverseGeocodeIndex::LoadCell(FileScanner& scanner,
+                                     size_t cellIndex,
+                                     Cell& cell) const
+  {
+    uint32_t segmentCount;
+    uint32_t pointCount;
+
+    if (!scanner.SetPos(cellOffsets[cellIndex]) ||
+        !scanner.ReadNumber(segmentCount)) {
+      return false;
+    }
+
+    cell.segments.resize(segmentCount);
+
+    for (auto& segment : cell.segments) {
+      if (!scanner.ReadCoord(segment.from) ||
+          !scanner.ReadCoord(segment.to) ||
+          !scanner.ReadNumber(segment.regionOffset) ||
+          !scanner.ReadNumber(segment.locationOffset)) {
+        return false;
+      }
+    }
+
+    if (!scanner.ReadNumber(pointCount)) {
+      return false;
+    }
+
+    cell.points.resize(pointCount);
+
+    for (auto& point : cell.points) {
+      if (!scanner.ReadCoord(point.coord) ||
+          !scanner.ReadNumber(point.regionOffset) ||
+          !scanner.ReadNumber(point.locationOffset) ||
+          !scanner.ReadNumber(point.addressOffset) ||
+          !scanner.Read(point.name) ||
+          !scanner.Read(point.object)) {
+        return false;
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Return the cell (x,y) from the cache, loading it if necessary. cell is set to
+   * NULL, if the cell does not exist or is empty.
+   */
+  bool ReverseGeocodeIndex::GetCachedCell(FileScanner& scanner,
+                                          CellCache& cache,
+                                          uint32_t x,
+                                          uint32_t y,
+                                          const Cell*& cell) const
+  {
+    uint64_t cellId=GetCellId(x,y);
+
+    cell=NULL;
+
+    CellCache::const_iterator cacheEntry=cache.find(cellId);
+
+    if (cacheEntry!=cache.end()) {
+      cell=&cacheEntry->second;
+
+      return true;
+    }
+
+    std::vector<uint64_t>::const_iterator idEntry=std::lower_bound(cellIds.begin(),
+                                                                   cellIds.end(),
+                                                                   cellId);
+
+    if (idEntry==cellIds.end() ||
+        *idEntry!=cellId) {
+      return true;
+    }
+
+    if (cache.size()>=MAX_CACHED_CELLS) {
+      cache.clear();
+    }
+
+    Cell& newCell=cache[cellId];
+
+    if (!LoadCell(scanner,
+                  idEntry-cellIds.begin(),
+                  newCell)) {
+      log.Error() << "Error while reading file '" << scanner.GetFilename() << "'!";
+      cache.erase(cellId);
+
+      return false;
+    }
+
+    cell=&newCell;
+
+    return true;
+  }
+
+  /**
+   * Search the cells around the coordinate in rings of growing size until neither
+   * a nearer address nor a nearer location can be found in the next ring.
+   */
+  bool ReverseGeocodeIndex::LookupCoord(FileScanner& scanner,
+                                        CellCache& cache,
+                                        const GeoCoord& coord,
+                                        double maxDistance,
+                                        Result& result) const
+  {
+    uint32_t cellX;
+    uint32_t cellY;
+    int64_t  cellCount=((int64_t)1) << CELL_LEVEL;
+    double   cellWidth=360.0/cellCount;
+    double   cellHeight=180.0/cellCount;
+
+    GetCell(coord,
+            cellX,
+            cellY);
+
+    for (int64_t ring=0; ring<=cellCount; ring++) {
+      if (ring>0) {
+        // All cells of the ring are at least ring-1 complete cells away from the
+        // cell of the coordinate
+        double maxLat=std::min(std::fabs(coord.GetLat())+ring*cellHeight,
+                               89.9);
+        double minCellSize=std::min(cellHeight*metersPerDegree,
+                                    cellWidth*metersPerDegree*cos(maxLat*M_PI/180.0));
+        double minDistance=(ring-1)*minCellSize;
+
+        if (minDistance>maxDistance) {
+          break;
+        }
+
+        if (result.hasLocation &&
+            result.hasAddress &&
+            minDistance>result.locationDistance &&
+            minDistance>result.addressDistance) {
+          break;
+        }
+      }
+
+      for (int64_t y=(int64_t)cellY-ring; y<=(int64_t)cellY+ring; y++) {
+        if (y<0 || y>=cellCount) {
+          continue;
+        }
+
+        // Inner rows only have a cell at the start and the end of the ring
+        int64_t step=(y==(int64_t)cellY-ring || y==(int64_t)cellY+ring || ring==0) ? 1 : 2*ring;
+
+        for (int64_t x=(int64_t)cellX-ring; x<=(int64_t)cellX+ring; x+=step) {
+          if (x<0 || x>=cellCount) {
+            continue;
+          }
+
+          const Cell* cell;
+
+          if (!GetCachedCell(scanner,
+                             cache,
+                             (uint32_t)x,
+                             (uint32_t)y,
+                             cell)) {
+            return false;
+          }
+
+          if (cell==NULL) {
+            continue;
+          }
+
+          for (const auto& segment : cell->segments) {
+            double distance=GetDistance(coord,
+                                        segment.from,
+                                        segment.to);
+
+            if (distance<=maxDistance &&
+                (!result.hasLocation || distance<result.locationDistance)) {
+              result.hasLocation=true;
+              result.location=segment;
+              result.locationDistance=distance;
+            }
+          }
+
+          for (const auto& point : cell->points) {
+            double distance=GetDistance(coord,
+                                        point.coord,
+                                        point.coord);
+
+            if (distance<=maxDistance &&
+                (!result.hasAddress || distance<result.addressDistance)) {
+              result.hasAddress=true;
+              result.address=point;
+              result.addressDistance=distance;
+            }
+          }
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Find the nearest location and the nearest address for each of the given
+   * coordinates.
+   *
+   * @param coords
+   *    The coordinates to look up
+   * @param maxDistance
+   *    Maximum distance in meter of a location or an address to the coordinate
+   * @param results
+   *    The results, one entry for each coordinate in the same order as the coordinates
+   * @return
+   *    True, if there was no error
+   */
+  bool ReverseGeocodeIndex::Lookup(const std::vector<GeoCoord>& coords,
+                                   double maxDistance,
+                                   std::vector<Result>& results) const
+  {
+    OSMSCOUT_TRACE_SPAN("index","ReverseGeocodeIndex::Lookup");
+
+    std::vector<std::pair<uint64_t,size_t> > order;
+
+    results.clear();
+    results.resize(coords.size());
+
+    order.reserve(coords.size());
+
+    for (size_t i=0; i<coords.size(); i++) {
+      uint32_t x;
+      uint32_t y;
+
+      GetCell(coords[i],
+              x,
+              y);
+
+      order.push_back(std::make_pair(GetCellId(x,y),
+                                     i));
+    }
+
+    std::sort(order.begin(),
+              order.end());
+
+    size_t               chunkCount=(order.size()+CHUNK_SIZE-1)/CHUNK_SIZE;
+    std::vector<uint8_t> chunkSuccess(chunkCount,1);
+    bool                 closeSuccess=true;
+
+    // Each thread uses its own scanner and cell cache for all of its chunks
+#pragma omp parallel
+    {
+      FileScanner scanner;
+      CellCache   cache;
+      bool        opened=scanner.Open(AppendFileToDir(path,
+                                                      FILENAME_REVERSEGEOCODE_IDX),
+                                      FileScanner::LowMemRandom,
+                                      true);
+
+#pragma omp for schedule(dynamic)
+      for (size_t chunk=0; chunk<chunkCount; chunk++) {
+        if (!opened) {
+          chunkSuccess[chunk]=0;
+          continue;
+        }
+
+        size_t end=std::min((chunk+1)*CHUNK_SIZE,
+                            order.size());
+
+        for (size_t i=chunk*CHUNK_SIZE; i<end; i++) {
+          size_t index=order[i].second;
+
+          if (!LookupCoord(scanner,
+                           cache,
+                           coords[index],
+                           maxDistance,
+                           results[index])) {
+            chunkSuccess[chunk]=0;
+            break;
+          }
+        }
+      }
+
+      if (opened &&
+          !scanner.Close()) {
+#pragma omp critical
+        closeSuccess=false;
+      }
+    }
+
+    if (!closeSuccess ||
+        std::find(chunkSuccess.begin(),
+                  chunkSuccess.end(),
+                  0)!=chunkSuccess.end()) {
+      log.Error() << "Error while reverse geocoding using '" << AppendFileToDir(path,FILENAME_REVERSEGEOCODE_IDX) << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the grid cell containing the given coordinate
+   */
+  void ReverseGeocodeIndex::GetCell(const GeoCoord& coord,
+                                    uint32_t& x,
+                                    uint32_t& y)
+  {
+    uint64_t cellCount=((uint64_t)1) << CELL_LEVEL;
+    double   lon=std::max(-180.0,std::min(180.0,coord.GetLon()));
+    double   lat=std::max(-90.0,std::min(90.0,coord.GetLat()));
+
+    x=(uint32_t)std::min((uint64_t)((lon+180.0)/360.0*cellCount),
+                         cellCount-1);
+    y=(uint32_t)std::min((uint64_t)((lat+90.0)/180.0*cellCount),
+                         cellCount-1);
+  }
+
+  /**
+   * Return the id of the given cell, its position on the Hilbert curve
+   */
+  uint64_t ReverseGeocodeIndex::GetCellId(uint32_t x,
+                                          uint32_t y)
+  {
+    return GetHilbertValue(x,
+                           y,
+                           CELL_LEVEL);
+  }
+
+  /**
+   * Return the distance in meter between the coordinate and the segment. The
+   * segment is projected to a plane tangential to the earth at the coordinate, which
+   * is exact enough for the distances used for reverse geocoding.
+   */
+  double ReverseGeocodeIndex::GetDistance(const GeoCoord& coord,
+                                          const GeoCoord& from,
+                                          const GeoCoord& to)
+  {
+    double xFactor=metersPerDegree*cos(coord.GetLat()*M_PI/180.0);
+    double ax=(from.GetLon()-coord.GetLon())*xFactor;
+    double ay=(from.GetLat()-coord.GetLat())*metersPerDegree;
+    double bx=(to.GetLon()-coord.GetLon())*xFactor;
+    double by=(to.GetLat()-coord.GetLat())*metersPerDegree;
+    double dx=bx-ax;
+    double dy=by-ay;
+    double length=dx*dx+dy*dy;
+    double u=0.0;
+
+    if (length>0.0) {
+      u=std::max(0.0,std::min(1.0,-(ax*dx+ay*dy)/length));
+    }
+
+    double cx=ax+u*dx;
+    double cy=ay+u*dy;
+
+    return sqrt(cx*cx+cy*cy);
+  }
+}
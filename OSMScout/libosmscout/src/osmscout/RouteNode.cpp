@@ -56,9 +56,7 @@ namespace osmscout {
 
   bool RouteNode::Read(FileScanner& scanner)
   {
-    uint32_t objectCount;
-    uint32_t pathCount;
-    uint32_t excludesCount;
+    uint32_t counts[3];
 
     if (!scanner.GetPos(fileOffset)) {
       return false;
@@ -70,14 +68,16 @@ namespace osmscout {
       return false;
     }
 
-    scanner.ReadNumber(objectCount);
-    scanner.ReadNumber(pathCount);
-    scanner.ReadNumber(excludesCount);
-
-    if (scanner.HasError()) {
+    // Number of objects, paths and excludes
+    if (!scanner.ReadNumbers(counts,
+                             3)) {
       return false;
     }
 
+    uint32_t objectCount=counts[0];
+    uint32_t pathCount=counts[1];
+    uint32_t excludesCount=counts[2];
+
     objects.resize(objectCount);
 
     Id previousFileOffset=0;
@@ -28,6 +28,7 @@
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/Tracing.h>
 
 //#define DEBUG_ROUTING
 
@@ -994,6 +995,8 @@ namespace osmscout {
                                       std::vector<osmscout::GeoCoord> via,
                                       RouteData& route)
   {
+      OSMSCOUT_TRACE_SPAN("routing","RoutingService::CalculateRoute");
+
       std::vector<size_t>                  nodeIndexes;
       std::vector<osmscout::ObjectFileRef> objects;
 
@@ -1071,6 +1074,8 @@ namespace osmscout {
                                       size_t targetNodeIndex,
                                       RouteData& route)
   {
+    OSMSCOUT_TRACE_SPAN("routing","RoutingService::CalculateRoute");
+
     RouteNodeRef             startForwardRouteNode;
     RouteNodeRef             startBackwardRouteNode;
     RNodeRef                 startForwardNode;
@@ -1346,6 +1351,9 @@ namespace osmscout {
 
     clock.Stop();
 
+    OSMSCOUT_TRACE_COUNTER("RoutingService.nodesLoaded",nodesLoadedCount);
+    OSMSCOUT_TRACE_COUNTER("RoutingService.nodesIgnored",nodesIgnoredCount);
+
     if (debugPerformance) {
       std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
       std::cout << "[";
@@ -25,12 +25,33 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <osmscout/private/Config.h>
+
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <ostream>
 #include <sstream>
 
+#include <errno.h>
+
+#if defined(HAVE_MMAP)
+  #include <sys/mman.h>
+#endif
+
+#if defined(__WIN32__) || defined(WIN32)
+  #include <io.h>
+  #include <windows.h>
+
+  #if !defined(_fileno)
+    #define _fileno(__F) ((__F)->_file)
+  #endif
+#endif
+
 #include <osmscout/SRTM.h>
 
+#include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 
 #include <osmscout/system/Math.h>
@@ -151,4 +172,342 @@ namespace osmscout {
 	}
     }
 
+    SRTMTile::SRTMTile(int tileLat, int tileLon)
+    : tileLat(tileLat),
+      tileLon(tileLon),
+      grid(0),
+      size(0),
+      data(NULL),
+      mapped(false)
+    {
+        // no code
+    }
+
+    SRTMTile::~SRTMTile(){
+        if(data==NULL){
+            return;
+        }
+
+        if(mapped){
+#if defined(HAVE_MMAP)
+            if(munmap(const_cast<unsigned char*>(data),size)!=0){
+                log.Error() << "Error while calling munmap: " << strerror(errno);
+            }
+#elif defined(__WIN32__) || defined(WIN32)
+            UnmapViewOfFile(data);
+#endif
+        } else {
+            delete [] data;
+        }
+    }
+
+    /**
+     * Map the given hgt file into memory. Returns false, if the file exists but
+     * cannot be read. If there is no such file, the tile has no data.
+     */
+    bool SRTMTile::Open(const std::string &filename){
+        FILE *file=fopen(filename.c_str(),"rb");
+
+        if(file==NULL){
+            return true;
+        }
+
+        if(fseek(file,0L,SEEK_END)!=0){
+            log.Error() << "Cannot seek in SRTM hgt file '" << filename << "'";
+            fclose(file);
+            return false;
+        }
+
+        long length=ftell(file);
+
+        if(length==SRTM1_FILESIZE){
+            grid=SRTM1_GRID;
+        } else if(length==SRTM3_FILESIZE){
+            grid=SRTM3_GRID;
+        } else {
+            log.Error() << "Unknown size of SRTM hgt file '" << filename << "': " << length;
+            fclose(file);
+            return false;
+        }
+
+        size=(size_t)length;
+
+#if defined(HAVE_MMAP)
+        void *buffer=mmap(NULL,size,PROT_READ,MAP_PRIVATE,fileno(file),0);
+
+        if(buffer!=MAP_FAILED){
+            data=(const unsigned char*)buffer;
+            mapped=true;
+        } else {
+            log.Error() << "Cannot mmap SRTM hgt file '" << filename << "': " << strerror(errno);
+        }
+#elif defined(__WIN32__) || defined(WIN32)
+        HANDLE mmfHandle=CreateFileMapping((HANDLE)_get_osfhandle(_fileno(file)),
+                                           (LPSECURITY_ATTRIBUTES)NULL,
+                                           PAGE_READONLY,
+                                           0,0,
+                                           (LPCTSTR)NULL);
+
+        if(mmfHandle!=NULL){
+            // The view keeps the mapping alive
+            data=(const unsigned char*)MapViewOfFile(mmfHandle,FILE_MAP_READ,0,0,0);
+            mapped=data!=NULL;
+            CloseHandle(mmfHandle);
+        }
+#endif
+
+        if(data==NULL){
+            unsigned char *buffer=new unsigned char[size];
+
+            if(fseek(file,0L,SEEK_SET)!=0 ||
+               fread(buffer,1,size,file)!=size){
+                log.Error() << "Cannot read SRTM hgt file '" << filename << "'";
+                delete [] buffer;
+                fclose(file);
+                return false;
+            }
+
+            data=buffer;
+        }
+
+        fclose(file);
+
+        return true;
+    }
+
+    int SRTMTile::GetSample(size_t row, size_t column) const {
+        const unsigned char *sample=data+2*(row*grid+column);
+
+        return (int16_t)((sample[0]<<8)|sample[1]);
+    }
+
+    /**
+     * Return the height at the given position within the tile, bilinear
+     * interpolated between the four neighbouring samples. Samples without data
+     * are ignored, if all four samples have no data SRTM::nodata is returned.
+     */
+    double SRTMTile::GetHeight(double latitude, double longitude) const {
+        if(data==NULL){
+            return SRTM::nodata;
+        }
+
+        double y=(tileLat+1-latitude)*(grid-1);
+        double x=(longitude-tileLon)*(grid-1);
+
+        y=std::max(0.0,std::min(y,(double)(grid-1)));
+        x=std::max(0.0,std::min(x,(double)(grid-1)));
+
+        size_t row=std::min((size_t)y,grid-2);
+        size_t column=std::min((size_t)x,grid-2);
+        double fy=y-row;
+        double fx=x-column;
+
+        int    samples[4]={GetSample(row,column),
+                           GetSample(row,column+1),
+                           GetSample(row+1,column),
+                           GetSample(row+1,column+1)};
+        double weights[4]={(1-fy)*(1-fx),
+                           (1-fy)*fx,
+                           fy*(1-fx),
+                           fy*fx};
+        double height=0.0;
+        double weight=0.0;
+
+        for(size_t i=0; i<4; i++){
+            if(samples[i]!=SRTM::nodata){
+                height+=samples[i]*weights[i];
+                weight+=weights[i];
+            }
+        }
+
+        if(weight<=0.0){
+            return SRTM::nodata;
+        }
+
+        return height/weight;
+    }
+
+    SRTMService::SRTMService(const std::string &path,
+                             size_t cacheSize)
+    : srtmPath(path),
+      cacheSize(std::max(cacheSize,(size_t)1))
+    {
+        // no code
+    }
+
+    SRTMService::~SRTMService(){
+        // no code
+    }
+
+    /**
+     * generate the name of the hgt file like N43E006.hgt for the tile with the given
+     * south west corner
+     */
+    std::string SRTMService::GetTileFilename(int tileLat, int tileLon){
+        char fileName[32];
+
+        snprintf(fileName,sizeof(fileName),"%c%02d%c%03d.hgt",
+                 tileLat>=0 ? 'N' : 'S',std::abs(tileLat),
+                 tileLon>=0 ? 'E' : 'W',std::abs(tileLon));
+
+        return fileName;
+    }
+
+    uint64_t SRTMService::GetTileKey(int tileLat, int tileLon){
+        return ((uint64_t)(uint32_t)tileLat << 32) | (uint32_t)tileLon;
+    }
+
+    /**
+     * Return the tile with the given south west corner from the cache, loading
+     * it if necessary. Tiles without data are cached, too.
+     */
+    SRTMTileRef SRTMService::GetTile(int tileLat, int tileLon) const {
+        uint64_t key=GetTileKey(tileLat,tileLon);
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> lock(cacheMutex);
+#endif
+
+        TileMap::iterator entry=tileMap.find(key);
+
+        if(entry!=tileMap.end()){
+            tiles.splice(tiles.begin(),tiles,entry->second);
+
+            return *entry->second;
+        }
+
+        SRTMTileRef tile=std::make_shared<SRTMTile>(tileLat,tileLon);
+
+        if(!tile->Open(srtmPath+"/"+GetTileFilename(tileLat,tileLon))){
+            // Errors are logged, the tile is cached without data
+            tile=std::make_shared<SRTMTile>(tileLat,tileLon);
+        }
+
+        tiles.push_front(tile);
+        tileMap[key]=tiles.begin();
+
+        // Tiles still in use by other threads stay alive until they are released
+        while(tiles.size()>cacheSize){
+            tileMap.erase(GetTileKey(tiles.back()->GetTileLat(),
+                                     tiles.back()->GetTileLon()));
+            tiles.pop_back();
+        }
+
+        return tile;
+    }
+
+    /**
+     * return the height at the given coordinate or SRTM::nodata if there is no data
+     */
+    double SRTMService::GetHeight(const GeoCoord &coord) const {
+        SRTMTileRef tile=GetTile((int)floor(coord.GetLat()),
+                                 (int)floor(coord.GetLon()));
+
+        return tile->GetHeight(coord.GetLat(),
+                               coord.GetLon());
+    }
+
+    /**
+     * Return the heights of all given coordinates, SRTM::nodata if there is no
+     * data for a coordinate. The coordinates are processed grouped by tile, so each
+     * tile is looked up only once per call, even if the coordinates alternate
+     * between more tiles than the cache holds.
+     */
+    void SRTMService::GetHeights(const std::vector<GeoCoord> &coords,
+                                 std::vector<double> &heights) const {
+        std::vector<std::pair<uint64_t,size_t> > order;
+
+        heights.resize(coords.size());
+        order.reserve(coords.size());
+
+        for(size_t i=0; i<coords.size(); i++){
+            order.push_back(std::make_pair(GetTileKey((int)floor(coords[i].GetLat()),
+                                                      (int)floor(coords[i].GetLon())),
+                                           i));
+        }
+
+        // Indices within a tile stay in input order
+        std::sort(order.begin(),order.end());
+
+        SRTMTileRef tile;
+        uint64_t    tileKey=0;
+
+        for(size_t i=0; i<order.size(); i++){
+            const GeoCoord &coord=coords[order[i].second];
+
+            if(!tile || order[i].first!=tileKey){
+                tile=GetTile((int)floor(coord.GetLat()),
+                             (int)floor(coord.GetLon()));
+                tileKey=order[i].first;
+            }
+
+            heights[order[i].second]=tile->GetHeight(coord.GetLat(),
+                                                     coord.GetLon());
+        }
+    }
+
+    /**
+     * Calculate the elevation profile of the given polyline (for example the nodes of
+     * a way or the points of a route).
+     *
+     * @param polyline
+     *    The coordinates of the polyline
+     * @param sampleDistance
+     *    Distance in meter between samples along the polyline. The nodes of the polyline
+     *    are always sampled, a value <=0 only samples the nodes.
+     * @param coords
+     *    The coordinates of the samples
+     * @param distances
+     *    The distance in meter of each sample from the start of the polyline
+     * @param heights
+     *    The height of each sample or SRTM::nodata
+     */
+    void SRTMService::GetProfile(const std::vector<GeoCoord> &polyline,
+                                 double sampleDistance,
+                                 std::vector<GeoCoord> &coords,
+                                 std::vector<double> &distances,
+                                 std::vector<double> &heights) const {
+        double distance=0.0;
+
+        coords.clear();
+        distances.clear();
+
+        for(size_t i=0; i<polyline.size(); i++){
+            if(i>0){
+                const GeoCoord &from=polyline[i-1];
+                const GeoCoord &to=polyline[i];
+                double         length=GetEllipsoidalDistance(from.GetLon(),from.GetLat(),
+                                                             to.GetLon(),to.GetLat())*1000.0;
+
+                if(sampleDistance>0.0){
+                    for(double offset=sampleDistance; offset<length; offset+=sampleDistance){
+                        double f=offset/length;
+
+                        coords.push_back(GeoCoord(from.GetLat()+f*(to.GetLat()-from.GetLat()),
+                                                  from.GetLon()+f*(to.GetLon()-from.GetLon())));
+                        distances.push_back(distance+offset);
+                    }
+                }
+
+                distance+=length;
+            }
+
+            coords.push_back(polyline[i]);
+            distances.push_back(distance);
+        }
+
+        GetHeights(coords,heights);
+    }
+
+    /**
+     * Remove all tiles from the cache
+     */
+    void SRTMService::FlushCache(){
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> lock(cacheMutex);
+#endif
+
+        tileMap.clear();
+        tiles.clear();
+    }
 }
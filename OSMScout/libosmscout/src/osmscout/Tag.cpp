@@ -19,17 +19,170 @@
 
 #include <osmscout/Tag.h>
 
+#include <algorithm>
+
 #include <osmscout/util/String.h>
 
 #include <osmscout/system/Assert.h>
 
 namespace osmscout {
 
+  TagMap::TagMap()
+  : count(0)
+  {
+    // no code
+  }
+
+  TagMap::TagMap(const TagMap& other)
+  : entries(other.begin(),
+            other.end()),
+    count(other.count)
+  {
+    // no code
+  }
+
+  TagMap& TagMap::operator=(const TagMap& other)
+  {
+    if (this!=&other) {
+      if (entries.size()<other.count) {
+        entries.resize(other.count);
+      }
+
+      std::copy(other.begin(),
+                other.end(),
+                entries.begin());
+
+      count=other.count;
+    }
+
+    return *this;
+  }
+
+  /**
+   * Returns the index of the first entry with a tag id not less than
+   * the given tag id
+   */
+  size_t TagMap::GetIndex(TagId tag) const
+  {
+    size_t index=0;
+
+    // Objects have only a few tags, linear search is faster than binary search
+    while (index<count &&
+           entries[index].first<tag) {
+      index++;
+    }
+
+    return index;
+  }
+
+  TagMap::iterator TagMap::find(TagId tag)
+  {
+    size_t index=GetIndex(tag);
+
+    if (index<count &&
+        entries[index].first==tag) {
+      return entries.begin()+index;
+    }
+
+    return end();
+  }
+
+  TagMap::const_iterator TagMap::find(TagId tag) const
+  {
+    size_t index=GetIndex(tag);
+
+    if (index<count &&
+        entries[index].first==tag) {
+      return entries.begin()+index;
+    }
+
+    return end();
+  }
+
+  /**
+   * Returns a reference to the value of the given tag, inserting
+   * an entry with an empty value for the tag, if it does not exist yet.
+   */
+  std::string& TagMap::operator[](TagId tag)
+  {
+    size_t index=GetIndex(tag);
+
+    if (index<count &&
+        entries[index].first==tag) {
+      return entries[index].second;
+    }
+
+    if (count==entries.size()) {
+      entries.push_back(value_type());
+    }
+
+    // Move the first unused entry to the insert position
+    std::rotate(entries.begin()+index,
+                entries.begin()+count,
+                entries.begin()+count+1);
+
+    entries[index].first=tag;
+    entries[index].second.clear();
+    count++;
+
+    return entries[index].second;
+  }
+
+  /**
+   * Sets the value of the given tag to the given character sequence
+   * without creating a temporary string.
+   */
+  void TagMap::Set(TagId tag,
+                   const char* value,
+                   size_t length)
+  {
+    (*this)[tag].assign(value,
+                        length);
+  }
+
+  void TagMap::erase(TagId tag)
+  {
+    size_t index=GetIndex(tag);
+
+    if (index<count &&
+        entries[index].first==tag) {
+      // Move the erased entry behind the valid entries, so it can be reused
+      std::rotate(entries.begin()+index,
+                  entries.begin()+index+1,
+                  entries.begin()+count);
+      count--;
+    }
+  }
+
+  TagConditionTriggers::TagConditionTriggers()
+  : unrestricted(false),
+    exact(true)
+  {
+    // no code
+  }
+
+  void TagConditionTriggers::SetUnrestricted()
+  {
+    unrestricted=true;
+    exact=false;
+    tags.clear();
+    values.clear();
+  }
+
   TagCondition::~TagCondition()
   {
     // no code
   }
 
+  /**
+   * Default implementation, marking the condition as unrestricted, so that it
+   * always gets evaluated.
+   */
+  void TagCondition::GetTriggers(TagConditionTriggers& triggers) const
+  {
+    triggers.SetUnrestricted();
+  }
+
   TagNotCondition::TagNotCondition(TagCondition* condition)
   : condition(condition)
   {
@@ -41,6 +194,11 @@ namespace osmscout {
     return !condition->Evaluate(tagMap);
   }
 
+  void TagNotCondition::GetTriggers(TagConditionTriggers& triggers) const
+  {
+    triggers.SetUnrestricted();
+  }
+
   TagBoolCondition::TagBoolCondition(Type type)
   : type(type)
   {
@@ -78,6 +236,68 @@ namespace osmscout {
     }
   }
 
+  /**
+   * For 'or' the triggers of all child conditions are merged. For 'and' the
+   * triggers of the most selective child condition are used, since it must be
+   * fulfilled, too.
+   */
+  void TagBoolCondition::GetTriggers(TagConditionTriggers& triggers) const
+  {
+    switch (type) {
+    case boolAnd: {
+      bool found=false;
+
+      triggers.SetUnrestricted();
+
+      for (const auto &condition : conditions) {
+        TagConditionTriggers childTriggers;
+
+        condition->GetTriggers(childTriggers);
+
+        if (childTriggers.unrestricted) {
+          continue;
+        }
+
+        // Tag/value pairs are more selective than tags with any value
+        if (!found ||
+            childTriggers.tags.size()<triggers.tags.size() ||
+            (childTriggers.tags.size()==triggers.tags.size() &&
+             childTriggers.values.size()<triggers.values.size())) {
+          triggers=childTriggers;
+          found=true;
+        }
+      }
+
+      if (found) {
+        triggers.exact=triggers.exact &&
+                       conditions.size()==1;
+      }
+    }
+      break;
+    case boolOr:
+      for (const auto &condition : conditions) {
+        TagConditionTriggers childTriggers;
+
+        condition->GetTriggers(childTriggers);
+
+        if (childTriggers.unrestricted) {
+          triggers.SetUnrestricted();
+          return;
+        }
+
+        triggers.exact=triggers.exact && childTriggers.exact;
+        triggers.tags.insert(childTriggers.tags.begin(),
+                             childTriggers.tags.end());
+        triggers.values.insert(childTriggers.values.begin(),
+                               childTriggers.values.end());
+      }
+      break;
+    default:
+      assert(false);
+      triggers.SetUnrestricted();
+    }
+  }
+
   TagExistsCondition::TagExistsCondition(TagId tag)
   : tag(tag)
   {
@@ -89,6 +309,11 @@ namespace osmscout {
     return tagMap.find(tag)!=tagMap.end();
   }
 
+  void TagExistsCondition::GetTriggers(TagConditionTriggers& triggers) const
+  {
+    triggers.tags.insert(tag);
+  }
+
   TagBinaryCondition::TagBinaryCondition(TagId tag,
                                          BinaryOperator binaryOperator,
                                          const std::string& tagValue)
@@ -174,6 +399,23 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Only string equality can be resolved by a tag/value lookup, all other
+   * comparisons require the tag to exist and must be evaluated.
+   */
+  void TagBinaryCondition::GetTriggers(TagConditionTriggers& triggers) const
+  {
+    if (valueType==string &&
+        binaryOperator==operatorEqual) {
+      triggers.values.insert(std::make_pair(tag,
+                                            tagStringValue));
+    }
+    else {
+      triggers.tags.insert(tag);
+      triggers.exact=false;
+    }
+  }
+
   TagIsInCondition::TagIsInCondition(TagId tag)
   : tag(tag)
   {
@@ -196,6 +438,14 @@ namespace osmscout {
     return tagValues.find(t->second)!=tagValues.end();
   }
 
+  void TagIsInCondition::GetTriggers(TagConditionTriggers& triggers) const
+  {
+    for (const auto &tagValue : tagValues) {
+      triggers.values.insert(std::make_pair(tag,
+                                            tagValue));
+    }
+  }
+
   TagInfo::TagInfo()
    : id(0)
   {
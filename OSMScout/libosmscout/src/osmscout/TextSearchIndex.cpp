@@ -1,11 +1,43 @@
 #include <osmscout/TextSearchIndex.h>
 
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <set>
+
 #include <osmscout/util/String.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout
 {
 
+  TextSearchVisitor::~TextSearchVisitor()
+  {
+    // no code
+  }
+
+  bool TextSearchIndex::FuzzySearchNode::operator>(const FuzzySearchNode& other) const
+  {
+    if(bound!=other.bound) {
+      return bound>other.bound;
+    }
+
+    if(length!=other.length) {
+      return length>other.length;
+    }
+
+    if(prefix!=other.prefix) {
+      return prefix>other.prefix;
+    }
+
+    if(isText!=other.isText) {
+      return other.isText;
+    }
+
+    return trieIndex>other.trieIndex;
+  }
+
   TextSearchIndex::TextSearchIndex()
   {
     // no code
@@ -100,7 +132,6 @@ namespace osmscout
     return true;
   }
 
-
   bool TextSearchIndex::Search(const std::string& query,
                                bool searchPOIs,
                                bool searchLocations,
@@ -108,6 +139,8 @@ namespace osmscout
                                bool searchOther,
                                ResultsMap& results) const
   {
+    OSMSCOUT_TRACE_SPAN("index","TextSearchIndex::Search");
+
     results.clear();
 
     if(query.empty()) {
@@ -161,6 +194,281 @@ namespace osmscout
     return true;
   }
 
+  /**
+   * Collect the characters following the given prefix in the keys of the trie
+   * and the objects whose text is the prefix, using a single predictive search
+   * over the keys starting with the prefix. Keys of objects continue with an ASCII
+   * control character (the type of the object) after the text.
+   */
+  void TextSearchIndex::getChildren(const TrieInfo& trie,
+                                    const std::string& prefix,
+                                    std::set<std::string>& characters,
+                                    std::vector<ObjectFileRef>& refs) const
+  {
+    marisa::Agent agent;
+
+    characters.clear();
+    refs.clear();
+
+    agent.set_query(prefix.c_str(),
+                    prefix.length());
+
+    while(trie.trie->predictive_search(agent)) {
+      std::string result(agent.key().ptr(),
+                         agent.key().length());
+
+      if(result.length()<=prefix.length()) {
+        continue;
+      }
+
+      if((unsigned char)result[prefix.length()]<0x20) {
+        std::string   text;
+        ObjectFileRef ref;
+
+        // Special keys (like the size of the offsets) start with a control character
+        if(prefix.empty()) {
+          continue;
+        }
+
+        splitSearchResult(result,text,ref);
+
+        if(text==prefix) {
+          refs.push_back(ref);
+        }
+
+        continue;
+      }
+
+      std::vector<std::string> nextCharacters;
+
+      SplitIntoCharacters(result.substr(prefix.length(),4),
+                          nextCharacters);
+
+      characters.insert(nextCharacters.front());
+    }
+  }
+
+  /**
+   * Search for texts starting with a prefix having an edit distance of at most
+   * maxDistance to the query. The edit distance is calculated on UTF-8 characters
+   * and texts are case sensitive.
+   *
+   * The tries are traversed best first by an edit distance automaton: for each
+   * visited node the row of edit distances between all prefixes of the query and the
+   * prefix of the node is calculated. The minimum of the row is a lower bound for
+   * the distance of all texts below the node, so nodes can be visited in order of
+   * this bound and their length and subtrees exceeding maxDistance are pruned.
+   * The children of a node and the objects having its text are collected by a
+   * single predictive search for the prefix of the node.
+   * Texts are passed to the visitor in the order of their distance and length, the
+   * search stops after limit texts.
+   *
+   * @param query
+   *    The text to search for
+   * @param maxDistance
+   *    The maximum edit distance between the query and a prefix of a result text
+   * @param limit
+   *    The maximum number of texts passed to the visitor
+   * @param visitor
+   *    The visitor receiving the results
+   * @return
+   *    true, if there was no error
+   */
+  bool TextSearchIndex::Search(const std::string& query,
+                               bool searchPOIs,
+                               bool searchLocations,
+                               bool searchRegions,
+                               bool searchOther,
+                               size_t maxDistance,
+                               size_t limit,
+                               TextSearchVisitor& visitor) const
+  {
+    OSMSCOUT_TRACE_SPAN("index","TextSearchIndex::Search");
+
+    if(query.empty() ||
+       limit==0) {
+      return true;
+    }
+
+    std::vector<bool> searchGroups;
+
+    searchGroups.push_back(searchPOIs);
+    searchGroups.push_back(searchLocations);
+    searchGroups.push_back(searchRegions);
+    searchGroups.push_back(searchOther);
+
+    std::vector<std::string> queryCharacters;
+
+    SplitIntoCharacters(query,
+                        queryCharacters);
+
+    size_t queryLength=queryCharacters.size();
+
+    std::priority_queue<FuzzySearchNode,
+                        std::vector<FuzzySearchNode>,
+                        std::greater<FuzzySearchNode> > queue;
+
+    for(size_t i=0; i < tries.size(); i++) {
+      if(searchGroups[i] && tries[i].isAvail) {
+        FuzzySearchNode root;
+
+        root.trieIndex=i;
+        root.length=0;
+        root.row.resize(queryLength+1);
+
+        for(size_t j=0; j <= queryLength; j++) {
+          root.row[j]=j;
+        }
+
+        root.distance=queryLength;
+        root.bound=0;
+        root.isText=false;
+
+        queue.push(root);
+      }
+    }
+
+    size_t resultCount=0;
+
+    try {
+      while(!queue.empty()) {
+        FuzzySearchNode node=queue.top();
+        const TrieInfo& trie=tries[node.trieIndex];
+
+        queue.pop();
+
+        if(node.isText) {
+          for(const auto& ref : node.refs) {
+            if(!visitor.Visit(node.prefix,
+                              ref,
+                              node.distance)) {
+              return true;
+            }
+          }
+
+          resultCount++;
+
+          if(resultCount>=limit) {
+            return true;
+          }
+
+          continue;
+        }
+
+        std::set<std::string>      characters;
+        std::vector<ObjectFileRef> refs;
+
+        getChildren(trie,
+                    node.prefix,
+                    characters,
+                    refs);
+
+        // The text ending at this node (if there is one) has its final distance,
+        // but must not be visited before other nodes with a smaller distance
+        if(!refs.empty() &&
+           node.distance<=maxDistance) {
+          FuzzySearchNode text;
+
+          text.trieIndex=node.trieIndex;
+          text.prefix=node.prefix;
+          text.length=node.length;
+          text.distance=node.distance;
+          text.bound=node.distance;
+          text.isText=true;
+          text.refs.swap(refs);
+
+          queue.push(text);
+        }
+
+        for(const auto& character : characters) {
+          FuzzySearchNode child;
+
+          child.trieIndex=node.trieIndex;
+          child.prefix=node.prefix+character;
+
+          child.row.resize(queryLength+1);
+          child.row[0]=node.row[0]+1;
+
+          size_t minDistance=child.row[0];
+
+          for(size_t j=1; j <= queryLength; j++) {
+            size_t substitution=node.row[j-1]+(queryCharacters[j-1]==character ? 0 : 1);
+
+            child.row[j]=std::min(std::min(node.row[j]+1,
+                                           child.row[j-1]+1),
+                                  substitution);
+
+            minDistance=std::min(minDistance,
+                                 child.row[j]);
+          }
+
+          child.distance=std::min(node.distance,
+                                  child.row[queryLength]);
+          child.bound=std::min(child.distance,
+                               minDistance);
+
+          if(child.bound>maxDistance) {
+            continue;
+          }
+
+          child.length=node.length+1;
+          child.isText=false;
+
+          queue.push(child);
+        }
+      }
+    }
+    catch(const marisa::Exception &ex) {
+      log.Error() << "Error searching for text: " << ex.what();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Split the given UTF-8 text into its characters. Bytes not being part of
+   * a valid UTF-8 sequence are returned as single characters.
+   */
+  void TextSearchIndex::SplitIntoCharacters(const std::string& text,
+                                            std::vector<std::string>& characters)
+  {
+    characters.clear();
+    characters.reserve(text.length());
+
+    size_t pos=0;
+
+    while(pos < text.length()) {
+      unsigned char lead=(unsigned char)text[pos];
+      size_t        length=1;
+
+      if(lead>=0xf0 && lead<=0xf7) {
+        length=4;
+      }
+      else if(lead>=0xe0) {
+        length=3;
+      }
+      else if(lead>=0xc0) {
+        length=2;
+      }
+
+      if(lead>=0xf8 ||
+         pos+length>text.length()) {
+        length=1;
+      }
+
+      for(size_t i=1; i < length; i++) {
+        if(((unsigned char)text[pos+i] & 0xc0)!=0x80) {
+          length=1;
+          break;
+        }
+      }
+
+      characters.push_back(text.substr(pos,length));
+      pos+=length;
+    }
+  }
+
   void TextSearchIndex::splitSearchResult(const std::string& result,
                                           std::string& text,
                                           ObjectFileRef& ref) const
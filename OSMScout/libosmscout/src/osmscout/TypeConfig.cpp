@@ -201,6 +201,20 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Returns the memory (in bytes) allocated by the buffer for the feature bits
+   * and the feature values. Memory allocated by the feature values
+   * themselves (like the content of strings) is not counted.
+   */
+  size_t FeatureValueBuffer::GetMemory() const
+  {
+    if (featureBits==NULL) {
+      return 0;
+    }
+
+    return type->GetFeatureMaskBytes()+type->GetFeatureValueBufferSize();
+  }
+
   FeatureValue* FeatureValueBuffer::AllocateValue(size_t idx)
   {
     size_t byteIdx=idx/8;
@@ -685,6 +699,167 @@ namespace osmscout {
     }
   }
 
+  TypeClassifier::TypeClassifier()
+  : wordCount(0),
+    compiled(false)
+  {
+    // no code
+  }
+
+  void TypeClassifier::SetRule(Bitset& bitset,
+                               size_t index) const
+  {
+    if (bitset.empty()) {
+      bitset.resize(wordCount,0);
+    }
+
+    bitset[index/64]|=((uint64_t)1) << (index%64);
+  }
+
+  void TypeClassifier::Clear()
+  {
+    rules.clear();
+    wordCount=0;
+    unrestricted.clear();
+    tagEntries.clear();
+    compiled=false;
+  }
+
+  /**
+   * Adds the given condition for the given type. Conditions must be added
+   * in the order they should be evaluated.
+   */
+  void TypeClassifier::AddRule(const TypeInfoRef& type,
+                               const TagConditionRef& condition,
+                               unsigned char types)
+  {
+    Rule rule;
+
+    rule.type=type;
+    rule.condition=condition;
+    rule.types=types;
+    rule.exact=false;
+
+    rules.push_back(rule);
+
+    compiled=false;
+  }
+
+  /**
+   * Builds the lookup tables for all rules added.
+   */
+  void TypeClassifier::Compile()
+  {
+    wordCount=(rules.size()+63)/64;
+    unrestricted.assign(wordCount,0);
+    tagEntries.clear();
+
+    for (size_t r=0; r<rules.size(); r++) {
+      TagConditionTriggers triggers;
+
+      rules[r].condition->GetTriggers(triggers);
+
+      rules[r].exact=triggers.exact &&
+                     !triggers.unrestricted;
+
+      if (triggers.unrestricted) {
+        SetRule(unrestricted,r);
+        continue;
+      }
+
+      for (const auto tag : triggers.tags) {
+        if (tag>=tagEntries.size()) {
+          tagEntries.resize(tag+1);
+        }
+
+        SetRule(tagEntries[tag].anyValue,r);
+      }
+
+      for (const auto &value : triggers.values) {
+        if (value.first>=tagEntries.size()) {
+          tagEntries.resize(value.first+1);
+        }
+
+        TagEntry& entry=tagEntries[value.first];
+        auto      valueId=entry.valueIds.find(value.second);
+
+        if (valueId==entry.valueIds.end()) {
+          valueId=entry.valueIds.insert(std::make_pair(value.second,
+                                                       entry.values.size())).first;
+          entry.values.push_back(Bitset());
+        }
+
+        SetRule(entry.values[valueId->second],r);
+      }
+    }
+
+    compiled=true;
+  }
+
+  /**
+   * Returns the first rule fulfilled by the given tag map or NULL,
+   * if there is no such rule.
+   */
+  const TypeClassifier::Rule* TypeClassifier::Classify(const TagMap& tagMap) const
+  {
+    assert(compiled);
+
+    Bitset candidates(unrestricted);
+
+    for (const auto &tag : tagMap) {
+      if (tag.first>=tagEntries.size()) {
+        continue;
+      }
+
+      const TagEntry& entry=tagEntries[tag.first];
+
+      if (!entry.anyValue.empty()) {
+        for (size_t w=0; w<wordCount; w++) {
+          candidates[w]|=entry.anyValue[w];
+        }
+      }
+
+      if (!entry.valueIds.empty()) {
+        auto valueId=entry.valueIds.find(tag.second);
+
+        if (valueId!=entry.valueIds.end()) {
+          const Bitset& values=entry.values[valueId->second];
+
+          for (size_t w=0; w<wordCount; w++) {
+            candidates[w]|=values[w];
+          }
+        }
+      }
+    }
+
+    for (size_t w=0; w<wordCount; w++) {
+      uint64_t word=candidates[w];
+
+      while (word!=0) {
+#if defined(__GNUC__)
+        size_t bit=(size_t)__builtin_ctzll(word);
+#else
+        size_t bit=0;
+
+        while ((word & (((uint64_t)1) << bit))==0) {
+          bit++;
+        }
+#endif
+
+        word&=word-1;
+
+        const Rule& rule=rules[w*64+bit];
+
+        if (rule.exact ||
+            rule.condition->Evaluate(tagMap)) {
+          return &rule;
+        }
+      }
+    }
+
+    return NULL;
+  }
+
   TypeConfig::TypeConfig()
    : nextTagId(0),
      nodeTypIdBytes(1),
@@ -972,6 +1147,9 @@ namespace osmscout {
 
     types.push_back(typeInfo);
 
+    // Compiled conditions are outdated now
+    ClearCompiledConditions();
+
     if (!typeInfo->GetIgnore() &&
         (typeInfo->CanBeNode() ||
          typeInfo->CanBeWay() ||
@@ -1040,6 +1218,18 @@ namespace osmscout {
     }
   }
 
+  TagId TypeConfig::GetTagId(const std::string& name) const
+  {
+    auto iter=stringToTagMap.find(name);
+
+    if (iter!=stringToTagMap.end()) {
+      return iter->second;
+    }
+    else {
+      return tagIgnore;
+    }
+  }
+
   const TypeInfoRef TypeConfig::GetTypeInfo(const std::string& name) const
   {
     auto typeEntry=nameToTypeMap.find(name);
@@ -1091,6 +1281,12 @@ namespace osmscout {
       return typeInfoIgnore;
     }
 
+    if (nodeClassifier.IsCompiled()) {
+      const TypeClassifier::Rule* rule=nodeClassifier.Classify(tagMap);
+
+      return rule!=NULL ? rule->type : typeInfoIgnore;
+    }
+
     for (const auto &type : types) {
       if (!type->HasConditions() ||
           !type->CanBeNode()) {
@@ -1122,6 +1318,24 @@ namespace osmscout {
       return false;
     }
 
+    if (wayAreaClassifier.IsCompiled()) {
+      const TypeClassifier::Rule* rule=wayAreaClassifier.Classify(tagMap);
+
+      if (rule==NULL) {
+        return false;
+      }
+
+      if (rule->types & TypeInfo::typeWay) {
+        wayType=rule->type;
+      }
+
+      if (rule->types & TypeInfo::typeArea) {
+        areaType=rule->type;
+      }
+
+      return true;
+    }
+
     for (const auto &type : types) {
       if (!((type->CanBeWay() ||
              type->CanBeArea()) &&
@@ -1167,6 +1381,12 @@ namespace osmscout {
 
     if (relationType!=tagMap.end() &&
         relationType->second=="multipolygon") {
+      if (multipolygonClassifier.IsCompiled()) {
+        const TypeClassifier::Rule* rule=multipolygonClassifier.Classify(tagMap);
+
+        return rule!=NULL ? rule->type : typeInfoIgnore;
+      }
+
       for (size_t i=0; i<types.size(); i++) {
         if (!types[i]->HasConditions() ||
             !types[i]->CanBeArea()) {
@@ -1185,6 +1405,12 @@ namespace osmscout {
       }
     }
     else {
+      if (relationClassifier.IsCompiled()) {
+        const TypeClassifier::Rule* rule=relationClassifier.Classify(tagMap);
+
+        return rule!=NULL ? rule->type : typeInfoIgnore;
+      }
+
       for (size_t i=0; i<types.size(); i++) {
         if (!types[i]->HasConditions() ||
             !types[i]->CanBeRelation()) {
@@ -1206,6 +1432,73 @@ namespace osmscout {
     return typeInfoIgnore;
   }
 
+  /**
+   * Compiles the conditions of all types registered into lookup tables, so that
+   * GetNodeType(), GetWayAreaType() and GetRelationType() do not need to evaluate
+   * the conditions of all types anymore. Registering a new type invalidates the
+   * compiled conditions, the methods then fall back to evaluating all conditions
+   * until the conditions get compiled again.
+   */
+  void TypeConfig::CompileConditions()
+  {
+    ClearCompiledConditions();
+
+    for (const auto &type : types) {
+      if (!type->HasConditions()) {
+        continue;
+      }
+
+      for (const auto &cond : type->GetConditions()) {
+        if (type->CanBeNode() &&
+            (cond.types & TypeInfo::typeNode)) {
+          nodeClassifier.AddRule(type,
+                                 cond.condition,
+                                 cond.types);
+        }
+
+        if ((type->CanBeWay() ||
+             type->CanBeArea()) &&
+            ((cond.types & TypeInfo::typeWay) ||
+             (cond.types & TypeInfo::typeArea))) {
+          wayAreaClassifier.AddRule(type,
+                                    cond.condition,
+                                    cond.types);
+        }
+
+        if (type->CanBeArea() &&
+            (cond.types & TypeInfo::typeArea)) {
+          multipolygonClassifier.AddRule(type,
+                                         cond.condition,
+                                         cond.types);
+        }
+
+        if (type->CanBeRelation() &&
+            (cond.types & TypeInfo::typeRelation)) {
+          relationClassifier.AddRule(type,
+                                     cond.condition,
+                                     cond.types);
+        }
+      }
+    }
+
+    nodeClassifier.Compile();
+    wayAreaClassifier.Compile();
+    multipolygonClassifier.Compile();
+    relationClassifier.Compile();
+  }
+
+  /**
+   * Removes the compiled conditions, so that the conditions of all types get
+   * evaluated one after the other again.
+   */
+  void TypeConfig::ClearCompiledConditions()
+  {
+    nodeClassifier.Clear();
+    wayAreaClassifier.Clear();
+    multipolygonClassifier.Clear();
+    relationClassifier.Clear();
+  }
+
   void TypeConfig::RegisterSurfaceToGradeMapping(const std::string& surface,
                                                  size_t grade)
   {
@@ -1306,6 +1599,10 @@ namespace osmscout {
     delete parser;
     delete scanner;
 
+    if (success) {
+      CompileConditions();
+    }
+
     return success;
   }
 
@@ -23,6 +23,7 @@
 
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout {
 
@@ -102,6 +103,8 @@ namespace osmscout {
                               const Magnification& magnification,
                               std::list<GroundTile>& tiles) const
   {
+    OSMSCOUT_TRACE_SPAN("index","WaterIndex::GetRegions");
+
     uint32_t cx1,cx2,cy1,cy2;
     uint32_t idx=magnification.GetLevel();
 
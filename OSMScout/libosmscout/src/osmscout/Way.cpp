@@ -58,6 +58,18 @@ namespace osmscout {
     // attributes.SetLayer(std::numeric_limits<int8_t>::max());
   }
 
+  /**
+   * Returns the memory (in bytes) used by the way, its features, ids and
+   * coordinates
+   */
+  size_t Way::GetMemory() const
+  {
+    return sizeof(Way)+
+           featureValueBuffer.GetMemory()+
+           ids.capacity()*sizeof(Id)+
+           nodes.capacity()*sizeof(CompactGeoCoord);
+  }
+
   void Way::GetCoordinates(size_t nodeIndex,
                            double& lat,
                            double& lon) const
@@ -0,0 +1,862 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+// Make sure that 64 file access activation works, by first importing
+// The Config.h, than our class and then std io.
+#include <osmscout/private/Config.h>
+
+#include <osmscout/util/BlockCompression.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Logger.h>
+
+#if defined(OSMSCOUT_HAVE_LIB_ZLIB) && defined(OSMSCOUT_HAVE_MUTEX) && (defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN))
+  #define OSMSCOUT_HAVE_BLOCK_COMPRESSION
+#endif
+
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+  #include <sys/stat.h>
+
+  #include <map>
+  #include <memory>
+  #include <mutex>
+  #include <tuple>
+  #include <vector>
+
+  #include <zlib.h>
+
+  #include <osmscout/util/Cache.h>
+#endif
+
+namespace osmscout {
+
+  static const char   BLOCK_COMPRESSION_MAGIC[8]={'\x89','o','s','m','z','\r','\n','\x1a'};
+  static const size_t BLOCK_COMPRESSION_HEADER_SIZE=8+4+8+8;
+
+  /**
+   * Header of a block compressed file
+   */
+  struct BlockCompressionHeader
+  {
+    uint32_t blockSize;
+    uint64_t dataSize;
+    uint64_t indexOffset;
+  };
+
+  static uint32_t DecodeUInt32(const unsigned char* buffer)
+  {
+    return ((uint32_t)buffer[0] <<  0) |
+           ((uint32_t)buffer[1] <<  8) |
+           ((uint32_t)buffer[2] << 16) |
+           ((uint32_t)buffer[3] << 24);
+  }
+
+  static uint64_t DecodeUInt64(const unsigned char* buffer)
+  {
+    return ((uint64_t)DecodeUInt32(buffer)) |
+           ((uint64_t)DecodeUInt32(buffer+4) << 32);
+  }
+
+  static bool SeekFile(std::FILE* file,
+                       FileOffset pos)
+  {
+#if defined(HAVE_FSEEKO)
+    return fseeko(file,(off_t)pos,SEEK_SET)==0;
+#else
+    return fseek(file,(long)pos,SEEK_SET)==0;
+#endif
+  }
+
+  /**
+   * Reads the header of the block compressed file from the start of the
+   * file. Returns false, if the file is not block compressed.
+   */
+  static bool ReadBlockCompressionHeader(std::FILE* file,
+                                         BlockCompressionHeader& header)
+  {
+    unsigned char buffer[BLOCK_COMPRESSION_HEADER_SIZE];
+
+    if (!SeekFile(file,0)) {
+      return false;
+    }
+
+    bool compressed=fread(buffer,1,BLOCK_COMPRESSION_HEADER_SIZE,file)==BLOCK_COMPRESSION_HEADER_SIZE &&
+                    memcmp(buffer,BLOCK_COMPRESSION_MAGIC,sizeof(BLOCK_COMPRESSION_MAGIC))==0;
+
+    clearerr(file);
+    SeekFile(file,0);
+
+    if (!compressed) {
+      return false;
+    }
+
+    header.blockSize=DecodeUInt32(buffer+8);
+    header.dataSize=DecodeUInt64(buffer+12);
+    header.indexOffset=DecodeUInt64(buffer+20);
+
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+  typedef std::shared_ptr<const std::vector<char> > BlockRef;
+
+  /**
+   * Identity of an opened file: device, inode, size and modification time
+   */
+  typedef std::tuple<uint64_t,uint64_t,uint64_t,int64_t> BlockFileIdentity;
+
+  static const uint64_t BLOCK_FILE_ID_BITS=24;
+  static const uint64_t BLOCK_INDEX_BITS=64-BLOCK_FILE_ID_BITS;
+
+  /**
+   * A file opened by at least one stream
+   */
+  struct BlockFile
+  {
+    uint64_t fileId;  //!< Id of the file in the keys of the cache
+    size_t   streams; //!< Number of open streams of the file
+  };
+
+  /**
+   * Global state of the block compression: the cache of decompressed blocks
+   * shared by all streams and the statistics.
+   *
+   * All streams of the same file share the blocks in the cache. The key of a
+   * cached block is the id of the file in the upper 24 bits and the index of
+   * the block in the lower 40 bits. The blocks of a file are removed from the
+   * cache when its last stream is closed, so the id can be reused afterwards.
+   */
+  struct BlockCompressionState
+  {
+    std::mutex                             mutex;
+    Cache<uint64_t,BlockRef>               cache;
+    std::map<BlockFileIdentity,BlockFile>  files;         //!< Files with open streams
+    std::vector<uint64_t>                  freeFileIds;   //!< Ids of closed files
+    uint64_t                               nextFileId;    //!< Next never used file id
+    BlockCompression::Statistics           statistics;
+
+    BlockCompressionState()
+    : cache(BlockCompression::DEFAULT_CACHE_SIZE),
+      nextFileId(0)
+    {
+      memset(&statistics,0,sizeof(statistics));
+    }
+  };
+
+  static BlockCompressionState& GetBlockCompressionState()
+  {
+    static BlockCompressionState state;
+
+    return state;
+  }
+
+  /**
+   * State of one stream opened by BlockCompression::OpenStream(), used as
+   * cookie of the custom stdio stream
+   */
+  struct BlockCompressionStream
+  {
+    std::FILE*              file;
+    std::string             filename;
+    BlockFileIdentity       identity;       //!< Identity of the file
+    uint64_t                fileId;         //!< Id of the file in the keys of the cache
+    BlockCompressionHeader  header;
+    std::vector<FileOffset> blockOffsets;   //!< Offset of each block followed by the end of the last block
+    std::vector<char>       compressed;     //!< Buffer for reading compressed blocks
+    size_t                  currentIndex;   //!< Index of the current block
+    BlockRef                currentBlock;   //!< The current block, if set
+    FileOffset              pos;            //!< Current position in the uncompressed data
+  };
+
+  /**
+   * Makes the block with the given index the current block of the stream,
+   * either taking it from the cache or reading and decompressing it.
+   */
+  static bool LoadBlock(BlockCompressionStream& stream,
+                        size_t index)
+  {
+    if (stream.currentBlock &&
+        stream.currentIndex==index) {
+      return true;
+    }
+
+    BlockCompressionState&             state=GetBlockCompressionState();
+    uint64_t                           key=(stream.fileId << BLOCK_INDEX_BITS) | (uint64_t)index;
+    Cache<uint64_t,BlockRef>::CacheRef entry;
+
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+
+      if (state.cache.GetEntry(key,entry)) {
+        stream.currentIndex=index;
+        stream.currentBlock=entry->value;
+        state.statistics.cacheHits++;
+
+        return true;
+      }
+    }
+
+    FileOffset blockStart=index*(FileOffset)stream.header.blockSize;
+    size_t     blockSize=(size_t)std::min((FileOffset)stream.header.blockSize,
+                                          stream.header.dataSize-blockStart);
+    size_t     storedSize=(size_t)(stream.blockOffsets[index+1]-stream.blockOffsets[index]);
+
+    stream.compressed.resize(storedSize);
+
+    if (!SeekFile(stream.file,stream.blockOffsets[index]) ||
+        fread(stream.compressed.data(),1,storedSize,stream.file)!=storedSize) {
+      log.Error() << "Cannot read block " << index << " of file '" << stream.filename << "'";
+      return false;
+    }
+
+    std::shared_ptr<std::vector<char> > block=std::make_shared<std::vector<char> >(blockSize);
+
+    if (storedSize==blockSize) {
+      block->swap(stream.compressed);
+    }
+    else {
+      uLongf destSize=(uLongf)blockSize;
+
+      if (uncompress((Bytef*)block->data(),
+                     &destSize,
+                     (const Bytef*)stream.compressed.data(),
+                     (uLong)storedSize)!=Z_OK ||
+          destSize!=blockSize) {
+        log.Error() << "Cannot decompress block " << index << " of file '" << stream.filename << "'";
+        return false;
+      }
+    }
+
+    stream.currentIndex=index;
+    stream.currentBlock=block;
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.statistics.blocksDecompressed++;
+    state.statistics.compressedBytesRead+=storedSize;
+
+    if (state.cache.IsActive()) {
+      state.cache.SetEntry(Cache<uint64_t,BlockRef>::CacheEntry(key,stream.currentBlock));
+    }
+
+    return true;
+  }
+
+  static long ReadStream(BlockCompressionStream& stream,
+                         char* buffer,
+                         size_t size)
+  {
+    size_t bytesRead=0;
+
+    while (bytesRead<size &&
+           stream.pos<stream.header.dataSize) {
+      size_t index=(size_t)(stream.pos/stream.header.blockSize);
+
+      if (!LoadBlock(stream,index)) {
+        errno=EIO;
+        return -1;
+      }
+
+      size_t offset=(size_t)(stream.pos-index*(FileOffset)stream.header.blockSize);
+      size_t bytes=std::min(size-bytesRead,
+                            stream.currentBlock->size()-offset);
+
+      memcpy(buffer+bytesRead,stream.currentBlock->data()+offset,bytes);
+
+      bytesRead+=bytes;
+      stream.pos+=bytes;
+    }
+
+    return (long)bytesRead;
+  }
+
+  static bool SeekStream(BlockCompressionStream& stream,
+                         int64_t& offset,
+                         int whence)
+  {
+    int64_t pos;
+
+    switch (whence) {
+    case SEEK_SET:
+      pos=offset;
+      break;
+    case SEEK_CUR:
+      pos=(int64_t)stream.pos+offset;
+      break;
+    case SEEK_END:
+      pos=(int64_t)stream.header.dataSize+offset;
+      break;
+    default:
+      errno=EINVAL;
+      return false;
+    }
+
+    if (pos<0) {
+      errno=EINVAL;
+      return false;
+    }
+
+    stream.pos=(FileOffset)pos;
+    offset=pos;
+
+    return true;
+  }
+
+  /**
+   * Returns the identity of the given file. Streams of files with the same
+   * identity share their blocks in the cache.
+   */
+  static bool GetFileIdentity(std::FILE* file,
+                              BlockFileIdentity& identity)
+  {
+    struct stat fileStat;
+
+    if (fstat(fileno(file),&fileStat)!=0) {
+      return false;
+    }
+
+    identity=BlockFileIdentity((uint64_t)fileStat.st_dev,
+                               (uint64_t)fileStat.st_ino,
+                               (uint64_t)fileStat.st_size,
+                               (int64_t)fileStat.st_mtime);
+
+    return true;
+  }
+
+  /**
+   * Registers a new stream for the file of the stream and assigns the id of the
+   * file to the stream. Must be called with the mutex of the state held.
+   */
+  static bool RegisterStream(BlockCompressionState& state,
+                             BlockCompressionStream& stream)
+  {
+    std::map<BlockFileIdentity,BlockFile>::iterator file=state.files.find(stream.identity);
+
+    if (file!=state.files.end()) {
+      file->second.streams++;
+      stream.fileId=file->second.fileId;
+
+      return true;
+    }
+
+    BlockFile blockFile;
+
+    if (!state.freeFileIds.empty()) {
+      blockFile.fileId=state.freeFileIds.back();
+      state.freeFileIds.pop_back();
+    }
+    else if (state.nextFileId<((uint64_t)1 << BLOCK_FILE_ID_BITS)) {
+      blockFile.fileId=state.nextFileId++;
+    }
+    else {
+      return false;
+    }
+
+    blockFile.streams=1;
+
+    state.files[stream.identity]=blockFile;
+    stream.fileId=blockFile.fileId;
+
+    return true;
+  }
+
+  /**
+   * Unregisters the stream from its file. If it was the last stream of the file,
+   * the blocks of the file are removed from the cache and its id is freed.
+   * Must be called with the mutex of the state held.
+   */
+  static void UnregisterStream(BlockCompressionState& state,
+                               const BlockCompressionStream& stream)
+  {
+    std::map<BlockFileIdentity,BlockFile>::iterator file=state.files.find(stream.identity);
+
+    if (file==state.files.end() ||
+        --file->second.streams>0) {
+      return;
+    }
+
+    std::vector<uint64_t> keys;
+
+    state.cache.GetKeys(keys);
+
+    for (const auto& key : keys) {
+      if ((key >> BLOCK_INDEX_BITS)==stream.fileId) {
+        state.cache.RemoveEntry(key);
+      }
+    }
+
+    state.freeFileIds.push_back(stream.fileId);
+    state.files.erase(file);
+  }
+
+  static int CloseStream(BlockCompressionStream* stream)
+  {
+    {
+      BlockCompressionState&      state=GetBlockCompressionState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+
+      UnregisterStream(state,
+                       *stream);
+    }
+
+    int result=fclose(stream->file);
+
+    delete stream;
+
+    return result;
+  }
+
+#if defined(HAVE_FOPENCOOKIE)
+  static ssize_t CookieRead(void* cookie,
+                            char* buffer,
+                            size_t size)
+  {
+    return (ssize_t)ReadStream(*static_cast<BlockCompressionStream*>(cookie),
+                               buffer,
+                               size);
+  }
+
+  static int CookieSeek(void* cookie,
+                        off64_t* offset,
+                        int whence)
+  {
+    int64_t pos=(int64_t)*offset;
+
+    if (!SeekStream(*static_cast<BlockCompressionStream*>(cookie),
+                    pos,
+                    whence)) {
+      return -1;
+    }
+
+    *offset=(off64_t)pos;
+
+    return 0;
+  }
+
+  static int CookieClose(void* cookie)
+  {
+    return CloseStream(static_cast<BlockCompressionStream*>(cookie));
+  }
+#else
+  static int CookieRead(void* cookie,
+                        char* buffer,
+                        int size)
+  {
+    return (int)ReadStream(*static_cast<BlockCompressionStream*>(cookie),
+                           buffer,
+                           (size_t)size);
+  }
+
+  static fpos_t CookieSeek(void* cookie,
+                           fpos_t offset,
+                           int whence)
+  {
+    int64_t pos=(int64_t)offset;
+
+    if (!SeekStream(*static_cast<BlockCompressionStream*>(cookie),
+                    pos,
+                    whence)) {
+      return (fpos_t)-1;
+    }
+
+    return (fpos_t)pos;
+  }
+
+  static int CookieClose(void* cookie)
+  {
+    return CloseStream(static_cast<BlockCompressionStream*>(cookie));
+  }
+#endif
+#endif
+
+  /**
+   * Returns true, if block compressed files can be written and read.
+   */
+  bool BlockCompression::IsSupported()
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Returns true, if the given file is block compressed. The file position
+   * is reset to the start of the file.
+   */
+  bool BlockCompression::IsCompressed(std::FILE* file)
+  {
+    BlockCompressionHeader header;
+
+    return ReadBlockCompressionHeader(file,
+                                      header);
+  }
+
+  /**
+   * Returns true, if the file with the given name exists and is block
+   * compressed.
+   */
+  bool BlockCompression::IsCompressed(const std::string& filename)
+  {
+    std::FILE* file=fopen(filename.c_str(),"rb");
+
+    if (file==NULL) {
+      return false;
+    }
+
+    bool compressed=IsCompressed(file);
+
+    fclose(file);
+
+    return compressed;
+  }
+
+  /**
+   * Returns the size of the content of the given file. For block compressed
+   * files this is the size of the uncompressed content, else the size of the
+   * file. Use this instead of GetFileSize() to calculate the number of bytes
+   * needed to address data within the file.
+   */
+  bool BlockCompression::GetDataSize(const std::string& filename,
+                                     FileOffset& size)
+  {
+    std::FILE*             file=fopen(filename.c_str(),"rb");
+    BlockCompressionHeader header;
+
+    if (file==NULL) {
+      return false;
+    }
+
+    bool compressed=ReadBlockCompressionHeader(file,
+                                               header);
+
+    fclose(file);
+
+    if (compressed) {
+      size=(FileOffset)header.dataSize;
+
+      return true;
+    }
+
+    return GetFileSize(filename,
+                       size);
+  }
+
+  /**
+   * Converts the given file into a block compressed file with blocks of the
+   * given (uncompressed) size. The file is replaced with its compressed
+   * version.
+   */
+  bool BlockCompression::CompressFile(const std::string& filename,
+                                      size_t blockSize)
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    std::string             tmpFilename=filename+".tmp";
+    std::FILE*              source;
+    FileWriter              writer;
+    FileOffset              dataSize;
+    std::vector<FileOffset> blockOffsets;
+    std::vector<char>       block(blockSize);
+    std::vector<char>       compressed(compressBound((uLong)blockSize));
+
+    if (blockSize==0 ||
+        blockSize>std::numeric_limits<uint32_t>::max()) {
+      log.Error() << "Invalid block size " << blockSize << " for compressing file '" << filename << "'";
+      return false;
+    }
+
+    if (!GetFileSize(filename,
+                     dataSize)) {
+      log.Error() << "Cannot get size of file '" << filename << "'";
+      return false;
+    }
+
+    source=fopen(filename.c_str(),"rb");
+
+    if (source==NULL) {
+      log.Error() << "Cannot open file '" << filename << "': " << strerror(errno);
+      return false;
+    }
+
+    if (!writer.Open(tmpFilename)) {
+      log.Error() << "Cannot create file '" << tmpFilename << "'";
+      fclose(source);
+      return false;
+    }
+
+    // Header, the index offset is rewritten at the end
+    writer.Write(BLOCK_COMPRESSION_MAGIC,sizeof(BLOCK_COMPRESSION_MAGIC));
+    writer.Write((uint32_t)blockSize);
+    writer.Write((uint64_t)dataSize);
+    writer.Write((uint64_t)0);
+
+    FileOffset remaining=dataSize;
+
+    while (remaining>0 &&
+           !writer.HasError()) {
+      size_t     bytes=(size_t)std::min((FileOffset)blockSize,remaining);
+      FileOffset offset;
+
+      if (fread(block.data(),1,bytes,source)!=bytes) {
+        log.Error() << "Cannot read file '" << filename << "'";
+        fclose(source);
+        writer.Close();
+        RemoveFile(tmpFilename);
+        return false;
+      }
+
+      writer.GetPos(offset);
+      blockOffsets.push_back(offset);
+
+      uLongf compressedSize=(uLongf)compressed.size();
+
+      if (compress((Bytef*)compressed.data(),
+                   &compressedSize,
+                   (const Bytef*)block.data(),
+                   (uLong)bytes)==Z_OK &&
+          compressedSize<bytes) {
+        writer.Write(compressed.data(),(size_t)compressedSize);
+      }
+      else {
+        writer.Write(block.data(),bytes);
+      }
+
+      remaining-=bytes;
+    }
+
+    fclose(source);
+
+    FileOffset indexOffset;
+
+    writer.GetPos(indexOffset);
+    blockOffsets.push_back(indexOffset);
+
+    for (const auto offset : blockOffsets) {
+      writer.Write((uint64_t)offset);
+    }
+
+    writer.SetPos(8+4+8);
+    writer.Write((uint64_t)indexOffset);
+
+    if (writer.HasError() ||
+        !writer.Close()) {
+      log.Error() << "Cannot write file '" << tmpFilename << "'";
+      RemoveFile(tmpFilename);
+      return false;
+    }
+
+    if (!RemoveFile(filename) ||
+        !RenameFile(tmpFilename,
+                    filename)) {
+      log.Error() << "Cannot replace file '" << filename << "' with '" << tmpFilename << "'";
+      return false;
+    }
+
+    return true;
+#else
+    (void)blockSize;
+
+    log.Error() << "Cannot compress file '" << filename << "', block compression is not supported";
+
+    return false;
+#endif
+  }
+
+  /**
+   * Returns a stdio stream for reading the uncompressed content of the given
+   * block compressed file and sets size to the size of the uncompressed
+   * content. On success the stream takes ownership of the given file handle,
+   * closing the stream also closes the file. On error NULL is returned and
+   * the file handle is still owned by the caller.
+   */
+  std::FILE* BlockCompression::OpenStream(std::FILE* file,
+                                          const std::string& filename,
+                                          FileOffset& size)
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    BlockCompressionHeader header;
+
+    if (!ReadBlockCompressionHeader(file,
+                                    header) ||
+        header.blockSize==0) {
+      log.Error() << "File '" << filename << "' is not block compressed";
+      return NULL;
+    }
+
+    size_t                     blockCount=(size_t)((header.dataSize+header.blockSize-1)/header.blockSize);
+    std::vector<unsigned char> index((blockCount+1)*8);
+    BlockFileIdentity          identity;
+
+    if (blockCount>=((uint64_t)1 << BLOCK_INDEX_BITS)) {
+      log.Error() << "File '" << filename << "' has too many blocks";
+      return NULL;
+    }
+
+    if (!GetFileIdentity(file,
+                         identity)) {
+      log.Error() << "Cannot get status of file '" << filename << "': " << strerror(errno);
+      return NULL;
+    }
+
+    if (!SeekFile(file,header.indexOffset) ||
+        fread(index.data(),1,index.size(),file)!=index.size()) {
+      log.Error() << "Cannot read block index of file '" << filename << "'";
+      return NULL;
+    }
+
+    BlockCompressionStream* stream=new BlockCompressionStream();
+
+    stream->file=file;
+    stream->filename=filename;
+    stream->identity=identity;
+    stream->header=header;
+    stream->currentIndex=0;
+    stream->pos=0;
+
+    stream->blockOffsets.resize(blockCount+1);
+
+    for (size_t i=0; i<=blockCount; i++) {
+      stream->blockOffsets[i]=(FileOffset)DecodeUInt64(&index[i*8]);
+    }
+
+    {
+      BlockCompressionState&      state=GetBlockCompressionState();
+      std::lock_guard<std::mutex> lock(state.mutex);
+
+      if (!RegisterStream(state,
+                          *stream)) {
+        log.Error() << "Cannot open stream for file '" << filename << "': Too many open files";
+        delete stream;
+        return NULL;
+      }
+    }
+
+#if defined(HAVE_FOPENCOOKIE)
+    cookie_io_functions_t functions;
+
+    functions.read=CookieRead;
+    functions.write=NULL;
+    functions.seek=CookieSeek;
+    functions.close=CookieClose;
+
+    std::FILE* result=fopencookie(stream,"rb",functions);
+#else
+    std::FILE* result=funopen(stream,CookieRead,NULL,CookieSeek,CookieClose);
+#endif
+
+    if (result==NULL) {
+      log.Error() << "Cannot open stream for file '" << filename << "': " << strerror(errno);
+
+      {
+        BlockCompressionState&      state=GetBlockCompressionState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        UnregisterStream(state,
+                         *stream);
+      }
+
+      delete stream;
+      return NULL;
+    }
+
+    size=(FileOffset)header.dataSize;
+
+    return result;
+#else
+    (void)file;
+    (void)size;
+
+    log.Error() << "Cannot read file '" << filename << "', block compression is not supported";
+
+    return NULL;
+#endif
+  }
+
+  /**
+   * Sets the maximum number of decompressed blocks held in the cache shared by
+   * all block compressed files. 0 disables the cache.
+   */
+  void BlockCompression::SetCacheSize(size_t blocks)
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    BlockCompressionState&      state=GetBlockCompressionState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.cache.SetMaxSize(blocks);
+#else
+    (void)blocks;
+#endif
+  }
+
+  size_t BlockCompression::GetCacheSize()
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    BlockCompressionState&      state=GetBlockCompressionState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    return state.cache.GetMaxSize();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * Removes all blocks from the cache
+   */
+  void BlockCompression::FlushCache()
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    BlockCompressionState&      state=GetBlockCompressionState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.cache.Flush();
+#endif
+  }
+
+  void BlockCompression::GetStatistics(Statistics& statistics)
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    BlockCompressionState&      state=GetBlockCompressionState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    statistics=state.statistics;
+#else
+    memset(&statistics,0,sizeof(statistics));
+#endif
+  }
+
+  void BlockCompression::ResetStatistics()
+  {
+#if defined(OSMSCOUT_HAVE_BLOCK_COMPRESSION)
+    BlockCompressionState&      state=GetBlockCompressionState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    memset(&state.statistics,0,sizeof(state.statistics));
+#endif
+  }
+}
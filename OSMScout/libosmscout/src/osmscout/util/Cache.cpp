@@ -19,7 +19,472 @@
 
 #include <osmscout/util/Cache.h>
 
+#include <algorithm>
+
 namespace osmscout {
 
+  ManagedCache::ManagedCache()
+  : manager(NULL),
+    maxMemory(0),
+    entries(0),
+    memory(0),
+    hits(0),
+    misses(0)
+  {
+    // no code
+  }
+
+  /**
+   * A copy of a cache is not registered at the manager of the original
+   */
+  ManagedCache::ManagedCache(const ManagedCache& /*other*/)
+  : manager(NULL),
+    maxMemory(0),
+    entries(0),
+    memory(0),
+    hits(0),
+    misses(0)
+  {
+    // no code
+  }
+
+  ManagedCache::~ManagedCache()
+  {
+    CacheManager* manager=this->manager;
+
+    if (manager!=NULL) {
+      manager->Unregister(*this);
+    }
+  }
+
+  ManagedCache& ManagedCache::operator=(const ManagedCache& /*other*/)
+  {
+    return *this;
+  }
+
+  /**
+   * Called by the CacheManager on (un)registration of the cache
+   */
+  void ManagedCache::SetManager(CacheManager* manager)
+  {
+    this->manager=manager;
+  }
+
+  /**
+   * Set the memory limit of the cache (in bytes). If the limit is > 0 it replaces
+   * the limit of the number of entries. Entries exceeding the limit are removed
+   * by the cache on its next access.
+   */
+  void ManagedCache::SetMaxMemory(unsigned long maxMemory)
+  {
+    this->maxMemory=maxMemory;
+  }
+
+  /**
+   * To be called by the implementation after the number of entries or their
+   * memory has changed
+   */
+  void ManagedCache::PublishUsage(unsigned long entries,
+                                  unsigned long memory)
+  {
+    this->entries=entries;
+    this->memory=memory;
+  }
+
+  /**
+   * To be called by the implementation on a cache hit
+   */
+  void ManagedCache::NotifyHit()
+  {
+    hits++;
+  }
+
+  /**
+   * To be called by the implementation on a cache miss
+   */
+  void ManagedCache::NotifyMiss()
+  {
+    CacheManager* manager=this->manager;
+
+    misses++;
+
+    if (manager!=NULL) {
+      manager->CacheMiss();
+    }
+  }
+
+  double CacheManager::CacheStatistics::GetHitRate() const
+  {
+    if (hits+misses==0) {
+      return 0.0;
+    }
+
+    return (double)hits/(double)(hits+misses);
+  }
+
+  /**
+   * Create a new cache manager distributing the given memory (in bytes)
+   * between the registered caches.
+   */
+  CacheManager::CacheManager(unsigned long memoryBudget)
+  : memoryBudget(memoryBudget),
+    rebalanceInterval(DEFAULT_REBALANCE_INTERVAL),
+    missCount(0)
+  {
+    // no code
+  }
+
+  /**
+   * Registered caches are limited by their number of entries again
+   */
+  CacheManager::~CacheManager()
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    for (auto& entry : caches) {
+      entry.cache->SetMaxMemory(0);
+      entry.cache->SetManager(NULL);
+    }
+  }
+
+  /**
+   * Minimum memory a cache keeps on rebalancing
+   */
+  unsigned long CacheManager::GetMinCacheMemory() const
+  {
+    if (caches.empty()) {
+      return 1;
+    }
+
+    return std::max((unsigned long)(memoryBudget/(16*caches.size())),
+                    1ul);
+  }
+
+  /**
+   * Sum of the memory limits of all caches
+   */
+  unsigned long CacheManager::GetAssignedMemory() const
+  {
+    unsigned long assigned=0;
+
+    for (const auto& entry : caches) {
+      assigned+=entry.cache->GetMaxMemory();
+    }
+
+    return assigned;
+  }
+
+  /**
+   * Set a new memory budget. The memory limits of all caches are scaled
+   * accordingly, each cache applies its new limit on its next access.
+   */
+  void CacheManager::SetMemoryBudget(unsigned long memoryBudget)
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    unsigned long assigned=GetAssignedMemory();
+
+    this->memoryBudget=memoryBudget;
+
+    if (assigned==0) {
+      return;
+    }
+
+    for (auto& entry : caches) {
+      uint64_t maxMemory=(uint64_t)entry.cache->GetMaxMemory()*memoryBudget/assigned;
+
+      entry.cache->SetMaxMemory(std::max((unsigned long)maxMemory,
+                                         1ul));
+    }
+  }
+
+  unsigned long CacheManager::GetMemoryBudget() const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    return memoryBudget;
+  }
+
+  /**
+   * Set the number of cache misses (summed over all caches) after which the
+   * memory is automatically rebalanced between the caches. 0 disables automatic
+   * rebalancing.
+   */
+  void CacheManager::SetRebalanceInterval(size_t rebalanceInterval)
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    this->rebalanceInterval=rebalanceInterval;
+  }
+
+  size_t CacheManager::GetRebalanceInterval() const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    return rebalanceInterval;
+  }
+
+  /**
+   * Register the given cache under the given name. The cache gets its share
+   * of the budget (the limits of the other caches are reduced proportionally)
+   * and is from now on limited by memory instead of by its number of entries.
+   * A cache can only be registered at one manager.
+   */
+  void CacheManager::Register(const std::string& name,
+                              ManagedCache& cache)
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    ManagedEntry entry;
+
+    entry.name=name;
+    entry.cache=&cache;
+    entry.hits=cache.GetHits();
+    entry.misses=cache.GetMisses();
+
+    caches.push_back(entry);
+
+    unsigned long assigned=0;
+
+    for (size_t i=0; i<caches.size()-1; i++) {
+      uint64_t maxMemory=(uint64_t)caches[i].cache->GetMaxMemory()*(caches.size()-1)/caches.size();
+
+      caches[i].cache->SetMaxMemory(std::max((unsigned long)maxMemory,
+                                             1ul));
+
+      assigned+=caches[i].cache->GetMaxMemory();
+    }
+
+    if (assigned<memoryBudget) {
+      cache.SetMaxMemory(memoryBudget-assigned);
+    }
+    else {
+      cache.SetMaxMemory(GetMinCacheMemory());
+    }
+
+    cache.SetManager(this);
+  }
+
+  /**
+   * Unregister the given cache. The cache keeps its current memory limit, the
+   * memory is reassigned to the other caches on the next rebalancing.
+   */
+  void CacheManager::Unregister(ManagedCache& cache)
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    for (std::vector<ManagedEntry>::iterator entry=caches.begin();
+         entry!=caches.end();
+         ++entry) {
+      if (entry->cache==&cache) {
+        caches.erase(entry);
+
+        cache.SetManager(NULL);
+
+        return;
+      }
+    }
+  }
+
+  /**
+   * Called by a registered cache on a cache miss.
+   */
+  void CacheManager::CacheMiss()
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    missCount++;
+
+    if (rebalanceInterval>0 &&
+        missCount>=rebalanceInterval) {
+      RebalanceLocked();
+    }
+  }
+
+  /**
+   * Move memory from the cache with the least benefit to the cache with
+   * the highest benefit, based on the lookups since the last rebalancing.
+   *
+   * The benefit of a cache is its number of hits per byte. Assuming that
+   * the hits are evenly distributed over the cached entries, this is
+   * the number of hits the cache gains by additional memory. Caches without
+   * misses in the period have no benefit, since they would not profit from
+   * more memory. Only caches that are nearly full can receive memory.
+   *
+   * Only the memory limits are changed, each cache removes entries exceeding
+   * its new limit on its own next access.
+   */
+  void CacheManager::Rebalance()
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    RebalanceLocked();
+  }
+
+  /**
+   * Rebalance with the mutex of the manager already held
+   */
+  void CacheManager::RebalanceLocked()
+  {
+    missCount=0;
+
+    if (caches.empty()) {
+      return;
+    }
+
+    std::vector<double> benefits(caches.size());
+    size_t              receiver=caches.size();
+    size_t              donor=caches.size();
+    unsigned long       minMemory=GetMinCacheMemory();
+
+    for (size_t i=0; i<caches.size(); i++) {
+      ManagedCache* cache=caches[i].cache;
+      uint64_t      hits=cache->GetHits()-caches[i].hits;
+      uint64_t      misses=cache->GetMisses()-caches[i].misses;
+
+      caches[i].hits=cache->GetHits();
+      caches[i].misses=cache->GetMisses();
+
+      if (misses>0) {
+        benefits[i]=(hits+1.0)/(cache->GetUsedMemory()+1.0);
+      }
+      else {
+        benefits[i]=0.0;
+      }
+
+      bool nearlyFull=cache->GetUsedMemory()>=cache->GetMaxMemory()-cache->GetMaxMemory()/8;
+
+      if (misses>0 &&
+          nearlyFull &&
+          (receiver==caches.size() ||
+           benefits[i]>benefits[receiver])) {
+        receiver=i;
+      }
+    }
+
+    if (receiver==caches.size()) {
+      return;
+    }
+
+    ManagedCache* receiverCache=caches[receiver].cache;
+    unsigned long assigned=GetAssignedMemory();
+
+    // Memory not assigned yet (because of a larger budget or unregistered caches)
+    if (assigned<memoryBudget) {
+      receiverCache->SetMaxMemory(receiverCache->GetMaxMemory()+memoryBudget-assigned);
+
+      return;
+    }
+
+    for (size_t i=0; i<caches.size(); i++) {
+      if (i!=receiver &&
+          caches[i].cache->GetMaxMemory()>minMemory &&
+          (donor==caches.size() ||
+           benefits[i]<benefits[donor])) {
+        donor=i;
+      }
+    }
+
+    if (donor==caches.size() ||
+        benefits[donor]>=benefits[receiver]) {
+      return;
+    }
+
+    ManagedCache* donorCache=caches[donor].cache;
+    unsigned long step=std::max(memoryBudget/32,
+                                1ul);
+    unsigned long unused=0;
+
+    if (donorCache->GetMaxMemory()>donorCache->GetUsedMemory()) {
+      unused=donorCache->GetMaxMemory()-donorCache->GetUsedMemory();
+    }
+
+    // Memory unused by the donor can be moved without any loss
+    unsigned long transfer=std::min(std::max(step,
+                                             unused),
+                                    donorCache->GetMaxMemory()-minMemory);
+
+    donorCache->SetMaxMemory(donorCache->GetMaxMemory()-transfer);
+    receiverCache->SetMaxMemory(receiverCache->GetMaxMemory()+transfer);
+  }
+
+  /**
+   * Returns the memory used by all registered caches
+   */
+  unsigned long CacheManager::GetUsedMemory() const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    unsigned long memory=0;
+
+    for (const auto& entry : caches) {
+      memory+=entry.cache->GetUsedMemory();
+    }
+
+    return memory;
+  }
+
+  /**
+   * Returns the current state of all registered caches, in the order of
+   * their registration
+   */
+  void CacheManager::GetStatistics(std::vector<CacheStatistics>& statistics) const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+
+    statistics.clear();
+    statistics.reserve(caches.size());
+
+    for (const auto& entry : caches) {
+      CacheStatistics cacheStatistics;
+
+      cacheStatistics.name=entry.name;
+      cacheStatistics.entries=entry.cache->GetEntryCount();
+      cacheStatistics.memory=entry.cache->GetUsedMemory();
+      cacheStatistics.maxMemory=entry.cache->GetMaxMemory();
+      cacheStatistics.hits=entry.cache->GetHits();
+      cacheStatistics.misses=entry.cache->GetMisses();
+
+      statistics.push_back(cacheStatistics);
+    }
+  }
+
+  /**
+    Dump the state of all registered caches to std::cout.
+    */
+  void CacheManager::DumpStatistics() const
+  {
+    std::vector<CacheStatistics> statistics;
+
+    GetStatistics(statistics);
+
+    std::cout << "Cache budget: " << GetMemoryBudget() << ", used " << GetUsedMemory() << std::endl;
+
+    for (const auto& cache : statistics) {
+      std::cout << cache.name << " entries: " << cache.entries << ", memory " << cache.memory << "/" << cache.maxMemory << ", hit rate " << cache.GetHitRate() << std::endl;
+    }
+  }
 }
 
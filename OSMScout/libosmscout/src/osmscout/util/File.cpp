@@ -21,6 +21,8 @@
 
 #include <osmscout/util/File.h>
 
+#include <osmscout/util/BlockCompression.h>
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -137,8 +139,8 @@ namespace osmscout {
   {
     FileOffset fileSize;
 
-    if (!GetFileSize(filename,
-                     fileSize)) {
+    if (!BlockCompression::GetDataSize(filename,
+                                       fileSize)) {
       return false;
     }
 
@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <limits>
 
 #if defined(HAVE_MMAP)
@@ -32,6 +33,10 @@
   #include <sys/mman.h>
 #endif
 
+#if defined(HAVE_PREAD) && !defined(HAVE_MMAP)
+  #include <unistd.h>
+#endif
+
 #if defined(HAVE_FCNTL_H)
   #include <fcntl.h>
 #endif
@@ -46,17 +51,24 @@
 
 #include <osmscout/system/Assert.h>
 
+#include <osmscout/util/BlockCompression.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/Number.h>
 
 namespace osmscout {
 
+  static NoOpLogger windowLogger;
+
   FileScanner::FileScanner()
    : file(NULL),
      hasError(true),
+     compressed(false),
      buffer(NULL),
      size(0),
-     offset(0)
+     offset(0),
+     windowed(false),
+     windowStart(0),
+     windowFileSize(0)
 #if defined(__WIN32__) || defined(WIN32)
      ,mmfHandle((HANDLE)0)
 #endif
@@ -64,6 +76,19 @@ namespace osmscout {
     // no code
   }
 
+  /**
+   * Returns the log line for errors while reading data. Reads beyond the
+   * end of a window are expected (see SetWindow()) and thus not logged.
+   */
+  Logger::Line FileScanner::ReadError() const
+  {
+    if (windowed) {
+      return windowLogger.Error();
+    }
+
+    return log.Error();
+  }
+
   FileScanner::~FileScanner()
   {
     if (IsOpen()) {
@@ -73,6 +98,11 @@ namespace osmscout {
 
   void FileScanner::FreeBuffer()
   {
+    if (windowed) {
+      ClearWindow();
+      return;
+    }
+
 #if defined(HAVE_MMAP)
     if (buffer!=NULL) {
       if (munmap(buffer,size)!=0) {
@@ -162,6 +192,27 @@ namespace osmscout {
     }
 #endif
 
+    compressed=false;
+
+    if (BlockCompression::IsCompressed(file)) {
+      std::FILE* stream=BlockCompression::OpenStream(file,
+                                                     filename,
+                                                     this->size);
+
+      if (stream==NULL) {
+        fclose(file);
+        file=NULL;
+        hasError=true;
+        return false;
+      }
+
+      file=stream;
+      compressed=true;
+      hasError=false;
+
+      return true;
+    }
+
 #if defined(HAVE_POSIX_FADVISE)
     if (mode==FastRandom) {
       if (posix_fadvise(fileno(file),0,size,POSIX_FADV_WILLNEED)<0) {
@@ -260,6 +311,8 @@ namespace osmscout {
 
     FreeBuffer();
 
+    compressed=false;
+
     result=fclose(file)==0;
 
     if (result) {
@@ -306,11 +359,12 @@ namespace osmscout {
 
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
-      if (pos>=size) {
+      if (pos<windowStart ||
+          pos-windowStart>=size) {
         return false;
       }
 
-      offset=pos;
+      offset=pos-windowStart;
 
       return true;
     }
@@ -339,7 +393,7 @@ namespace osmscout {
 
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
-      pos=offset;
+      pos=windowStart+offset;
       return true;
     }
 #endif
@@ -371,12 +425,138 @@ namespace osmscout {
     return !hasError;
   }
 
+  /**
+   * Returns the size of the file (also while a window is set).
+   */
+  FileOffset FileScanner::GetSize() const
+  {
+    if (windowed) {
+      return windowFileSize;
+    }
+
+    return size;
+  }
+
+  /**
+   * Returns true, if ReadAt() can be used for this file. This is the case
+   * if the file is open, is neither block compressed nor memory mapped and
+   * the platform supports positional reads.
+   */
+  bool FileScanner::CanReadAt() const
+  {
+#if defined(HAVE_PREAD) && defined(HAVE_MMAP)
+    return file!=NULL &&
+           !hasError &&
+           !compressed &&
+           !IsMemoryMapped() &&
+           !windowed;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Reads the given number of bytes starting at the given file offset into
+   * the given buffer. The current file position is not changed.
+   *
+   * Does not touch the internal state of the scanner and thus can be called
+   * for multiple non overlapping buffers in parallel.
+   */
+  bool FileScanner::ReadAt(FileOffset pos,
+                           char* buffer,
+                           size_t bytes) const
+  {
+#if defined(HAVE_PREAD)
+    if (file==NULL) {
+      return false;
+    }
+
+    int    fd=fileno(file);
+    size_t bytesRead=0;
+
+    while (bytesRead<bytes) {
+      ssize_t result=pread(fd,
+                           buffer+bytesRead,
+                           bytes-bytesRead,
+                           (off_t)(pos+bytesRead));
+
+      if (result<0) {
+        if (errno==EINTR) {
+          continue;
+        }
+
+        log.Error() << "Cannot read " << bytes << " bytes at offset " << pos << " of file '" << filename << "': " << strerror(errno);
+        return false;
+      }
+
+      if (result==0) {
+        log.Error() << "Cannot read " << bytes << " bytes at offset " << pos << " beyond end of file '" << filename << "'";
+        return false;
+      }
+
+      bytesRead+=(size_t)result;
+    }
+
+    return true;
+#else
+    (void)pos;
+    (void)buffer;
+    (void)bytes;
+
+    log.Error() << "Positional reads are not supported for file '" << filename << "'";
+    return false;
+#endif
+  }
+
+  /**
+   * Attaches the given buffer holding the data of the file starting at the
+   * given offset. Until ClearWindow() is called, all read methods decode from
+   * the buffer and SetPos() only accepts offsets within the window. Reading
+   * beyond the end of the window fails without logging an error. The
+   * buffer is not owned by the scanner.
+   */
+  void FileScanner::SetWindow(FileOffset start,
+                              char* data,
+                              size_t size)
+  {
+    assert(!IsMemoryMapped());
+
+    if (!windowed) {
+      windowFileSize=this->size;
+    }
+
+    buffer=data;
+    this->size=(FileOffset)size;
+    offset=0;
+    windowed=true;
+    windowStart=start;
+  }
+
+  /**
+   * Removes the window set by SetWindow(), following reads access the file
+   * again. An error caused by reading beyond the end of the window is reset.
+   */
+  void FileScanner::ClearWindow()
+  {
+    if (!windowed) {
+      return;
+    }
+
+    hasError=false;
+    buffer=NULL;
+    size=windowFileSize;
+    offset=0;
+    windowed=false;
+    windowStart=0;
+    windowFileSize=0;
+  }
+
   bool FileScanner::Read(char* buffer, size_t bytes)
   {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (this->buffer!=NULL) {
       if (offset+(FileOffset)bytes-1>=size) {
-        log.Error() << "Cannot read byte array beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read byte array beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -392,7 +572,7 @@ namespace osmscout {
     hasError=fread(buffer,1,bytes,file)!=bytes;
 
     if (hasError) {
-      log.Error() << "Cannot read byte array beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read byte array beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -410,7 +590,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read std::string beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read std::string beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -425,7 +605,7 @@ namespace osmscout {
       value.assign(&buffer[start],offset-start);
 
       if (offset>=size) {
-        log.Error() << "String has no terminating '\\0' before end of file '" << filename << "'";
+        ReadError() << "String has no terminating '\\0' before end of file '" << filename << "'";
         hasError=true;
         return false;
       }
@@ -441,7 +621,7 @@ namespace osmscout {
     hasError=fread(&character,1,1,file)!=1;
 
     if (hasError) {
-      log.Error() << "Cannot read std::string beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read std::string beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -451,7 +631,7 @@ namespace osmscout {
       hasError=fread(&character,1,1,file)!=1;
 
       if (hasError) {
-        log.Error() << "String has no terminating '\\0' before end of file '" << filename << "'";
+        ReadError() << "String has no terminating '\\0' before end of file '" << filename << "'";
         return false;
       }
     }
@@ -468,7 +648,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read bool beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read bool beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -486,7 +666,7 @@ namespace osmscout {
     hasError=fread(&value,1,1,file)!=1;
 
     if (hasError) {
-      log.Error() << "Cannot read bool beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read bool beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -506,7 +686,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read int8_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read int8_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -522,7 +702,7 @@ namespace osmscout {
     hasError=fread(&number,1,1,file)!=1;
 
     if (hasError) {
-      log.Error() << "Cannot read int8_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read int8_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -540,7 +720,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+2-1>=size) {
-        log.Error() << "Cannot read int16_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read int16_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -569,7 +749,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,2,file)!=2;
 
     if (hasError) {
-      log.Error() << "Cannot read int16_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read int16_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -600,7 +780,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+4-1>=size) {
-        log.Error() << "Cannot read int32_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read int32_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -639,7 +819,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,4,file)!=4;
 
     if (hasError) {
-      log.Error() << "Cannot read int32_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read int32_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -681,7 +861,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+8-1>=size) {
-        log.Error() << "Cannot read int64_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read int64_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -740,7 +920,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,8,file)!=8;
 
     if (hasError) {
-      log.Error() << "Cannot read int64_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read int64_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -802,7 +982,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read uint8_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint8_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -818,7 +998,7 @@ namespace osmscout {
     hasError=fread(&number,1,1,file)!=1;
 
     if (hasError) {
-      log.Error() << "Cannot read uint8_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint8_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -836,7 +1016,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+2-1>=size) {
-        log.Error() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -865,7 +1045,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,2,file)!=2;
 
     if (hasError) {
-      log.Error() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -896,7 +1076,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+4-1>=size) {
-        log.Error() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -935,7 +1115,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,4,file)!=4;
 
     if (hasError) {
-      log.Error() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -977,7 +1157,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+8-1>=size) {
-        log.Error() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1036,7 +1216,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,8,file)!=8;
 
     if (hasError) {
-      log.Error() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -1099,7 +1279,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+bytes-1>=size) {
-        log.Error() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1130,7 +1310,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,bytes,file)!=bytes;
 
     if (hasError) {
-      log.Error() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint16_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -1164,7 +1344,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+bytes-1>=size) {
-        log.Error() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1209,7 +1389,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,bytes,file)!=bytes;
 
     if (hasError) {
-      log.Error() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint32_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -1258,7 +1438,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+bytes-1>=size) {
-        log.Error() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1331,7 +1511,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,bytes,file)!=bytes;
 
     if (hasError) {
-      log.Error() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read uint64_t beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -1422,7 +1602,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+8-1>=size) {
-        log.Error() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1481,7 +1661,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,8,file)!=8;
 
     if (hasError) {
-      log.Error() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -1545,7 +1725,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+bytes-1>=size) {
-        log.Error() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1618,7 +1798,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,bytes,file)!=bytes;
 
     if (hasError) {
-      log.Error() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read osmscout::FileOffset beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -1693,7 +1873,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1709,7 +1889,7 @@ namespace osmscout {
     char buffer;
 
     if (fread(&buffer,1,1,file)!=1) {
-      log.Error() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
       hasError=true;
       return false;
     }
@@ -1729,7 +1909,7 @@ namespace osmscout {
       while ((buffer & 0x80)!=0) {
 
         if (fread(&buffer,1,1,file)!=1) {
-          log.Error() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1751,7 +1931,7 @@ namespace osmscout {
       while ((buffer & 0x80)!=0) {
 
         if (fread(&buffer,1,1,file)!=1) {
-          log.Error() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed int16_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1779,7 +1959,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1795,7 +1975,7 @@ namespace osmscout {
     char buffer;
 
     if (fread(&buffer,1,1,file)!=1) {
-      log.Error() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
       hasError=true;
       return false;
     }
@@ -1816,7 +1996,7 @@ namespace osmscout {
       while ((buffer & 0x80)!=0) {
 
         if (fread(&buffer,1,1,file)!=1) {
-          log.Error() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1838,7 +2018,7 @@ namespace osmscout {
       while ((buffer & 0x80)!=0) {
 
         if (fread(&buffer,1,1,file)!=1) {
-          log.Error() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed int32_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1867,7 +2047,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1883,7 +2063,7 @@ namespace osmscout {
     char buffer;
 
     if (fread(&buffer,1,1,file)!=1) {
-      log.Error() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
       hasError=true;
       return false;
     }
@@ -1903,7 +2083,7 @@ namespace osmscout {
       while ((buffer & 0x80)!=0) {
 
         if (fread(&buffer,1,1,file)!=1) {
-          log.Error() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1925,7 +2105,7 @@ namespace osmscout {
       while ((buffer & 0x80)!=0) {
 
         if (fread(&buffer,1,1,file)!=1) {
-          log.Error() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed int64_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1954,7 +2134,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -1973,7 +2153,7 @@ namespace osmscout {
         }
 
         if (offset>=size) {
-          log.Error() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -1988,7 +2168,7 @@ namespace osmscout {
     char buffer;
 
     if (fread(&buffer,1,1,file)!=1) {
-      log.Error() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
       hasError=true;
       return false;
     }
@@ -2003,7 +2183,7 @@ namespace osmscout {
       }
 
       if (fread(&buffer,1,1,file)!=1) {
-        log.Error() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed uint16_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2025,7 +2205,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2044,7 +2224,7 @@ namespace osmscout {
         }
 
         if (offset>=size) {
-          log.Error() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -2059,7 +2239,7 @@ namespace osmscout {
     char buffer;
 
     if (fread(&buffer,1,1,file)!=1) {
-      log.Error() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
       hasError=true;
       return false;
     }
@@ -2074,7 +2254,7 @@ namespace osmscout {
       }
 
       if (fread(&buffer,1,1,file)!=1) {
-        log.Error() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2097,7 +2277,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset>=size) {
-        log.Error() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2116,7 +2296,7 @@ namespace osmscout {
         }
 
         if (offset>=size) {
-          log.Error() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
+          ReadError() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
           hasError=true;
           return false;
         }
@@ -2131,7 +2311,7 @@ namespace osmscout {
     char buffer;
 
     if (fread(&buffer,1,1,file)!=1) {
-      log.Error() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
       hasError=true;
       return false;
     }
@@ -2146,7 +2326,7 @@ namespace osmscout {
       }
 
       if (fread(&buffer,1,1,file)!=1) {
-        log.Error() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2158,7 +2338,125 @@ namespace osmscout {
   }
 #endif
 
-  bool FileScanner::ReadCoord(GeoCoord& coord)
+  /**
+   * Reads 'count' variable length encoded unsigned numbers into the given
+   * array. The result is the same as calling ReadNumber() 'count' times, but
+   * if the data is read from memory, the numbers are decoded in one go.
+   */
+  bool FileScanner::ReadNumbers(uint32_t* numbers,
+                                size_t count)
+  {
+    if (HasError()) {
+      return false;
+    }
+
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      size_t pos=(size_t)offset;
+
+      if (offset>size ||
+          !DecodeNumbers(buffer,
+                         (size_t)size,
+                         pos,
+                         numbers,
+                         count)) {
+        ReadError() << "Cannot read compressed uint32_t beyond end of file'"  << filename << "'";
+        hasError=true;
+        return false;
+      }
+
+      offset=(FileOffset)pos;
+
+      return true;
+    }
+#endif
+
+    for (size_t i=0; i<count; i++) {
+      if (!ReadNumber(numbers[i])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_UINT64_T)
+  bool FileScanner::ReadNumbers(uint64_t* numbers,
+                                size_t count)
+  {
+    if (HasError()) {
+      return false;
+    }
+
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      size_t pos=(size_t)offset;
+
+      if (offset>size ||
+          !DecodeNumbers(buffer,
+                         (size_t)size,
+                         pos,
+                         numbers,
+                         count)) {
+        ReadError() << "Cannot read compressed uint64_t beyond end of file'"  << filename << "'";
+        hasError=true;
+        return false;
+      }
+
+      offset=(FileOffset)pos;
+
+      return true;
+    }
+#endif
+
+    for (size_t i=0; i<count; i++) {
+      if (!ReadNumber(numbers[i])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+#endif
+
+  /**
+   * Like ReadNumbers(), but each number read is the difference to the
+   * previous number of the sequence (the first one is read as it is). The
+   * array holds the absolute values afterwards.
+   */
+  bool FileScanner::ReadNumbersDelta(uint32_t* numbers,
+                                     size_t count)
+  {
+    if (!ReadNumbers(numbers,
+                     count)) {
+      return false;
+    }
+
+    for (size_t i=1; i<count; i++) {
+      numbers[i]+=numbers[i-1];
+    }
+
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_UINT64_T)
+  bool FileScanner::ReadNumbersDelta(uint64_t* numbers,
+                                     size_t count)
+  {
+    if (!ReadNumbers(numbers,
+                     count)) {
+      return false;
+    }
+
+    for (size_t i=1; i<count; i++) {
+      numbers[i]+=numbers[i-1];
+    }
+
+    return true;
+  }
+#endif
+
+  bool FileScanner::ReadCoord(CompactGeoCoord& coord)
   {
     if (HasError()) {
       return false;
@@ -2170,7 +2468,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+coordByteSize-1>=size) {
-        log.Error() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2189,8 +2487,8 @@ namespace osmscout {
 
       offset+=coordByteSize;
 
-      coord.Set(latDat/latConversionFactor-90.0,
-                lonDat/lonConversionFactor-180.0);
+      coord.SetFixed(latDat,
+                     lonDat);
 
       return true;
     }
@@ -2201,7 +2499,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,coordByteSize,file)!=coordByteSize;
 
     if (hasError) {
-      log.Error() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -2215,8 +2513,22 @@ namespace osmscout {
            | (buffer[5] << 16)
            | ((buffer[6] & 0xf0) << 20);
 
-    coord.Set(latDat/latConversionFactor-90.0,
-              lonDat/lonConversionFactor-180.0);
+    coord.SetFixed(latDat,
+                   lonDat);
+
+    return true;
+  }
+
+  bool FileScanner::ReadCoord(GeoCoord& coord)
+  {
+    CompactGeoCoord compactCoord;
+
+    if (!ReadCoord(compactCoord)) {
+      return false;
+    }
+
+    coord.Set(compactCoord.GetLat(),
+              compactCoord.GetLon());
 
     return true;
   }
@@ -2234,7 +2546,7 @@ namespace osmscout {
 #if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
     if (buffer!=NULL) {
       if (offset+coordByteSize-1>=size) {
-        log.Error() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
+        ReadError() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
         hasError=true;
         return false;
       }
@@ -2272,7 +2584,7 @@ namespace osmscout {
     hasError=fread(&buffer,1,coordByteSize,file)!=coordByteSize;
 
     if (hasError) {
-      log.Error() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
+      ReadError() << "Cannot read osmscout::GeoCoord beyond end of file'"  << filename << "'";
       return false;
     }
 
@@ -2299,6 +2611,57 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Reads the differences of the given nodes to the minimum coordinate
+   * (pairs of latitude and longitude values). The values are decoded in
+   * chunks using ReadNumbers().
+   */
+  bool FileScanner::ReadCoordDeltas(const GeoCoord& minCoord,
+                                    std::vector<GeoCoord>& nodes)
+  {
+    const size_t chunkSize=64;
+    uint32_t     values[2*chunkSize];
+
+    for (size_t start=0; start<nodes.size(); start+=chunkSize) {
+      size_t count=std::min(chunkSize,nodes.size()-start);
+
+      if (!ReadNumbers(values,
+                       2*count)) {
+        return false;
+      }
+
+      for (size_t i=0; i<count; i++) {
+        nodes[start+i].Set(minCoord.GetLat()+values[2*i]/latConversionFactor,
+                           minCoord.GetLon()+values[2*i+1]/lonConversionFactor);
+      }
+    }
+
+    return !HasError();
+  }
+
+  bool FileScanner::ReadCoordDeltas(const CompactGeoCoord& minCoord,
+                                    std::vector<CompactGeoCoord>& nodes)
+  {
+    const size_t chunkSize=64;
+    uint32_t     values[2*chunkSize];
+
+    for (size_t start=0; start<nodes.size(); start+=chunkSize) {
+      size_t count=std::min(chunkSize,nodes.size()-start);
+
+      if (!ReadNumbers(values,
+                       2*count)) {
+        return false;
+      }
+
+      for (size_t i=0; i<count; i++) {
+        nodes[start+i].SetFixed(minCoord.GetFixedLat()+values[2*i],
+                                minCoord.GetFixedLon()+values[2*i+1]);
+      }
+    }
+
+    return !HasError();
+  }
+
   bool FileScanner::Read(std::vector<GeoCoord>& nodes)
   {
     uint32_t nodeCount;
@@ -2314,20 +2677,9 @@ namespace osmscout {
     }
 
     nodes.resize(nodeCount);
-    for (size_t i=0; i<nodeCount; i++) {
-      uint32_t latValue;
-      uint32_t lonValue;
 
-      if (!ReadNumber(latValue) ||
-          !ReadNumber(lonValue)) {
-        return false;
-      }
-
-      nodes[i].Set(minCoord.GetLat()+latValue/latConversionFactor,
-                   minCoord.GetLon()+lonValue/lonConversionFactor);
-    }
-
-    return !HasError();
+    return ReadCoordDeltas(minCoord,
+                           nodes);
   }
 
   bool FileScanner::Read(std::vector<GeoCoord>& nodes,
@@ -2340,20 +2692,48 @@ namespace osmscout {
     }
 
     nodes.resize(count);
-    for (size_t i=0; i<count; i++) {
-      uint32_t latValue;
-      uint32_t lonValue;
 
-      if (!ReadNumber(latValue) ||
-          !ReadNumber(lonValue)) {
-        return false;
-      }
+    return ReadCoordDeltas(minCoord,
+                           nodes);
+  }
 
-      nodes[i].Set(minCoord.GetLat()+latValue/latConversionFactor,
-                   minCoord.GetLon()+lonValue/lonConversionFactor);
+  /**
+   * Reads the coordinates like Read(std::vector<GeoCoord>&), but without
+   * converting them from the fixed point format of the file.
+   */
+  bool FileScanner::Read(std::vector<CompactGeoCoord>& nodes)
+  {
+    uint32_t nodeCount;
+
+    if (!ReadNumber(nodeCount)) {
+      return false;
     }
 
-    return !HasError();
+    CompactGeoCoord minCoord;
+
+    if (!ReadCoord(minCoord)) {
+      return false;
+    }
+
+    nodes.resize(nodeCount);
+
+    return ReadCoordDeltas(minCoord,
+                           nodes);
+  }
+
+  bool FileScanner::Read(std::vector<CompactGeoCoord>& nodes,
+                         size_t count)
+  {
+    CompactGeoCoord minCoord;
+
+    if (!ReadCoord(minCoord)) {
+      return false;
+    }
+
+    nodes.resize(count);
+
+    return ReadCoordDeltas(minCoord,
+                           nodes);
   }
 
   bool FileScanner::ReadBox(GeoBox& box)
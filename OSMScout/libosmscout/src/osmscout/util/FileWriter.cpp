@@ -30,13 +30,15 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
+#include <osmscout/util/BlockCompression.h>
 #include <osmscout/util/Number.h>
 
 namespace osmscout {
 
   FileWriter::FileWriter()
    : file(NULL),
-     hasError(true)
+     hasError(true),
+     compressionBlockSize(0)
   {
     // no code
   }
@@ -55,6 +57,7 @@ namespace osmscout {
     }
 
     this->filename=filename;
+    this->compressionBlockSize=0;
 
     file=fopen(filename.c_str(),"w+b");
 
@@ -73,11 +76,27 @@ namespace osmscout {
 
     if (!hasError) {
       file=NULL;
+
+      if (compressionBlockSize>0) {
+        hasError=!BlockCompression::CompressFile(filename,
+                                                 compressionBlockSize);
+      }
     }
 
     return !hasError;
   }
 
+  /**
+   * Converts the file into a block compressed file with blocks of the given
+   * size when it is closed, see BlockCompression. Writing (including
+   * changing already written data) works as for uncompressed files.
+   * A block size of 0 disables compression.
+   */
+  void FileWriter::SetBlockCompression(size_t blockSize)
+  {
+    compressionBlockSize=blockSize;
+  }
+
   std::string FileWriter::GetFilename() const
   {
     return filename;
@@ -536,13 +555,18 @@ namespace osmscout {
 #endif
 
   bool FileWriter::WriteCoord(const GeoCoord& coord)
+  {
+    return WriteCoord(CompactGeoCoord(coord));
+  }
+
+  bool FileWriter::WriteCoord(const CompactGeoCoord& coord)
   {
     if (HasError()) {
       return false;
     }
 
-    uint32_t latValue=(uint32_t)round((coord.GetLat()+90.0)*latConversionFactor);
-    uint32_t lonValue=(uint32_t)round((coord.GetLon()+180.0)*lonConversionFactor);
+    uint32_t latValue=coord.GetFixedLat();
+    uint32_t lonValue=coord.GetFixedLon();
 
     char buffer[coordByteSize];
 
@@ -644,6 +668,47 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Writes the coordinates in the same format as Write(const std::vector<GeoCoord>&),
+   * the differences to the minimum coordinate are calculated on the fixed point values.
+   */
+  bool FileWriter::Write(const std::vector<CompactGeoCoord>& nodes)
+  {
+    if (!WriteNumber((uint32_t)nodes.size())) {
+      return false;
+    }
+
+    return Write(nodes,
+                 nodes.size());
+  }
+
+  bool FileWriter::Write(const std::vector<CompactGeoCoord>& nodes,
+                         size_t count)
+  {
+    CompactGeoCoord minCoord=nodes[0];
+
+    for (size_t i=1; i<count; i++) {
+      minCoord.SetFixed(std::min(minCoord.GetFixedLat(),nodes[i].GetFixedLat()),
+                        std::min(minCoord.GetFixedLon(),nodes[i].GetFixedLon()));
+    }
+
+    if (!WriteCoord(minCoord)) {
+      return false;
+    }
+
+    for (size_t i=0; i<count; i++) {
+      if (!WriteNumber(nodes[i].GetFixedLat()-minCoord.GetFixedLat())) {
+        return false;
+      }
+
+      if (!WriteNumber(nodes[i].GetFixedLon()-minCoord.GetFixedLon())) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   bool FileWriter::WriteTypeId(TypeId id, uint8_t maxBytes)
   {
     if (maxBytes==1) {
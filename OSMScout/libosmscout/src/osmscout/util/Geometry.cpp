@@ -48,7 +48,7 @@ namespace osmscout {
     return res;
   }
 
-  bool AreaIsClockwise(const std::vector<GeoCoord>& edges)
+  bool AreaIsClockwise(const std::vector<CompactGeoCoord>& edges)
   {
     assert(edges.size()>=3);
     // based on http://en.wikipedia.org/wiki/Curve_orientation
@@ -446,6 +446,31 @@ namespace osmscout {
     }
   }
 
+  uint64_t GetHilbertValue(uint32_t x,
+                           uint32_t y,
+                           size_t order)
+  {
+    uint64_t value=0;
+
+    for (uint64_t s=((uint64_t)1) << (order-1); s>0; s/=2) {
+      uint64_t rx=(x & s)>0 ? 1 : 0;
+      uint64_t ry=(y & s)>0 ? 1 : 0;
+
+      value+=s*s*((3*rx) ^ ry);
+
+      // Rotate the quadrant
+      if (ry==0) {
+        if (rx==1) {
+          x=(uint32_t)(s-1-x%s);
+          y=(uint32_t)(s-1-y%s);
+        }
+
+        std::swap(x,y);
+      }
+    }
+
+    return value;
+  }
 
   /**
    * return the minimum distance from the point p to the line segment [p1,p2]
@@ -492,13 +517,13 @@ namespace osmscout {
     }
   }
 
-  void PolygonMerger::AddPolygon(const std::vector<GeoCoord>& polygonCoords,
+  void PolygonMerger::AddPolygon(const std::vector<CompactGeoCoord>& polygonCoords,
                                  const std::vector<Id>& polygonIds)
   {
     assert(polygonCoords.size()>=3);
     assert(polygonCoords.size()==polygonIds.size());
 
-    std::vector<GeoCoord> coords(polygonCoords);
+    std::vector<CompactGeoCoord> coords(polygonCoords);
     std::vector<Id>       ids(polygonIds);
 
     if (!AreaIsClockwise(polygonCoords)) {
@@ -19,6 +19,285 @@
 
 #include <osmscout/util/Number.h>
 
+#include <cstring>
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
 namespace osmscout {
 
+  /**
+   * Decodes one number like DecodeNumber(), but checking the end of the
+   * buffer. Bits not fitting into the number are dropped.
+   */
+  template<typename N>
+  static inline bool DecodeNumberChecked(const char* buffer,
+                                         size_t size,
+                                         size_t& pos,
+                                         N& number)
+  {
+    unsigned int shift=0;
+
+    number=0;
+
+    while (pos<size) {
+      unsigned char byte=(unsigned char)buffer[pos++];
+
+      if (shift<(unsigned int)std::numeric_limits<N>::digits) {
+        number|=static_cast<N>(byte & 0x7f) << shift;
+      }
+
+      if ((byte & 0x80)==0) {
+        return true;
+      }
+
+      shift+=7;
+    }
+
+    return false;
+  }
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+  static inline unsigned int CountTrailingZeros(uint64_t value)
+  {
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctzll(value);
+#else
+    unsigned int count=0;
+
+    while ((value & 1)==0) {
+      value>>=1;
+      count++;
+    }
+
+    return count;
+#endif
+  }
+
+  /**
+   * Drops the continuation bits of the first 'length' (<=8) bytes of the
+   * word and joins the remaining groups of 7 bits into one number. Only the
+   * groups fitting into N are joined.
+   */
+  template<typename N>
+  static inline N JoinNumberGroups(uint64_t word,
+                                   unsigned int length)
+  {
+    static const uint64_t lengthMasks[9]={
+      0x0ULL,
+      0xffULL,
+      0xffffULL,
+      0xffffffULL,
+      0xffffffffULL,
+      0xffffffffffULL,
+      0xffffffffffffULL,
+      0xffffffffffffffULL,
+      0xffffffffffffffffULL
+    };
+
+    word&=lengthMasks[length];
+
+    uint64_t number=(word & 0x7fULL) |
+                    ((word >> 1) & 0x3f80ULL) |
+                    ((word >> 2) & 0x1fc000ULL) |
+                    ((word >> 3) & 0xfe00000ULL) |
+                    ((word >> 4) & 0x7f0000000ULL);
+
+    if (sizeof(N)>4) {
+      number|=((word >> 5) & 0x3f800000000ULL) |
+              ((word >> 6) & 0x1fc0000000000ULL) |
+              ((word >> 7) & 0xfe000000000000ULL);
+    }
+
+    return static_cast<N>(number);
+  }
+
+  /**
+   * Stores 16 numbers each encoded in one byte
+   */
+  static inline void StoreSingleByteNumbers(__m128i data,
+                                            uint32_t* numbers)
+  {
+    __m128i zero=_mm_setzero_si128();
+    __m128i low=_mm_unpacklo_epi8(data,zero);
+    __m128i high=_mm_unpackhi_epi8(data,zero);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers),_mm_unpacklo_epi16(low,zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers+4),_mm_unpackhi_epi16(low,zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers+8),_mm_unpacklo_epi16(high,zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers+12),_mm_unpackhi_epi16(high,zero));
+  }
+
+  static inline void StoreSingleByteNumbers(__m128i data,
+                                            uint64_t* numbers)
+  {
+    __m128i zero=_mm_setzero_si128();
+    __m128i words[2]={_mm_unpacklo_epi8(data,zero),
+                      _mm_unpackhi_epi8(data,zero)};
+
+    for (size_t w=0; w<2; w++) {
+      __m128i low=_mm_unpacklo_epi16(words[w],zero);
+      __m128i high=_mm_unpackhi_epi16(words[w],zero);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers),_mm_unpacklo_epi32(low,zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers+2),_mm_unpackhi_epi32(low,zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers+4),_mm_unpacklo_epi32(high,zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(numbers+6),_mm_unpackhi_epi32(high,zero));
+
+      numbers+=8;
+    }
+  }
+#endif
+
+  /**
+   * Decodes one number without checking the end of the buffer, at least
+   * 10 bytes must be available. Returns false for numbers longer than 10
+   * bytes.
+   */
+  template<typename N>
+  static inline bool DecodeNumberUnchecked(const char* buffer,
+                                           size_t& pos,
+                                           N& number)
+  {
+    unsigned char byte=(unsigned char)buffer[pos++];
+    unsigned int  shift=7;
+
+    number=static_cast<N>(byte & 0x7f);
+
+    while ((byte & 0x80)!=0) {
+      if (shift>=70) {
+        return false;
+      }
+
+      byte=(unsigned char)buffer[pos++];
+
+      if (shift<(unsigned int)std::numeric_limits<N>::digits) {
+        number|=static_cast<N>(byte & 0x7f) << shift;
+      }
+
+      shift+=7;
+    }
+
+    return true;
+  }
+
+  template<typename N>
+  static inline bool DecodeNumbersTemplated(const char* buffer,
+                                            size_t size,
+                                            size_t& pos,
+                                            N* numbers,
+                                            size_t count)
+  {
+    size_t i=0;
+
+    if (pos>size) {
+      return false;
+    }
+
+#if defined(OSMSCOUT_HAVE_SSE2)
+    // Longest number JoinNumberGroups() can decode for the given type
+    const unsigned int maxLength=sizeof(N)<8 ? 5 : 8;
+
+    // Masked VByte style: Get the continuation bits of the next 16 bytes
+    // at once and decode all numbers ending within these bytes without
+    // further checks. We need 8 more bytes for loading the last word.
+    while (i<count &&
+           size-pos>=24) {
+      __m128i      data=_mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer+pos));
+      unsigned int ends=~(unsigned int)_mm_movemask_epi8(data) & 0xffff;
+
+      if (ends==0xffff &&
+          count-i>=16) {
+        StoreSingleByteNumbers(data,
+                               numbers+i);
+
+        i+=16;
+        pos+=16;
+        continue;
+      }
+
+      unsigned int start=0;
+
+      while (ends!=0 &&
+             i<count) {
+        unsigned int end=CountTrailingZeros(ends);
+
+        if (end+1-start>maxLength) {
+          break;
+        }
+
+        uint64_t word;
+
+        std::memcpy(&word,buffer+pos+start,sizeof(word));
+
+        numbers[i]=JoinNumberGroups<N>(word,end+1-start);
+
+        i++;
+        start=end+1;
+        ends&=ends-1;
+      }
+
+      pos+=start;
+
+      // Number too long for the fast path
+      if (start==0 &&
+          !DecodeNumberChecked(buffer,size,pos,numbers[i++])) {
+        return false;
+      }
+    }
+#endif
+
+    // Only check once per number, that the longest possible number fits
+    while (i<count &&
+           size-pos>=10) {
+      size_t start=pos;
+
+      if (!DecodeNumberUnchecked(buffer,pos,numbers[i])) {
+        pos=start;
+
+        if (!DecodeNumberChecked(buffer,size,pos,numbers[i])) {
+          return false;
+        }
+      }
+
+      i++;
+    }
+
+    while (i<count) {
+      if (!DecodeNumberChecked(buffer,size,pos,numbers[i++])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool DecodeNumbers(const char* buffer,
+                     size_t size,
+                     size_t& pos,
+                     uint32_t* numbers,
+                     size_t count)
+  {
+    return DecodeNumbersTemplated(buffer,
+                                  size,
+                                  pos,
+                                  numbers,
+                                  count);
+  }
+
+#if defined(OSMSCOUT_HAVE_UINT64_T)
+  bool DecodeNumbers(const char* buffer,
+                     size_t size,
+                     size_t& pos,
+                     uint64_t* numbers,
+                     size_t count)
+  {
+    return DecodeNumbersTemplated(buffer,
+                                  size,
+                                  pos,
+                                  numbers,
+                                  count);
+  }
+#endif
 }
@@ -0,0 +1,313 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/PostingList.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include <osmscout/system/Assert.h>
+
+#include <osmscout/util/Number.h>
+
+namespace osmscout {
+
+  static void EncodeUnsigned(uint64_t value,
+                             std::vector<char>& buffer)
+  {
+    char         data[10];
+    unsigned int bytes=EncodeNumber(value,
+                                    data);
+
+    buffer.insert(buffer.end(),
+                  data,
+                  data+bytes);
+  }
+
+  /**
+   * Variable length decoding like DecodeNumber(), but checking the
+   * end of the buffer
+   */
+  static bool DecodeUnsigned(const char* buffer,
+                             size_t size,
+                             size_t& pos,
+                             uint64_t& value)
+  {
+    unsigned int shift=0;
+
+    value=0;
+
+    while (pos<size && shift<64) {
+      unsigned char byte=(unsigned char)buffer[pos++];
+
+      value|=((uint64_t)(byte & 0x7f)) << shift;
+
+      if ((byte & 0x80)==0) {
+        return true;
+      }
+
+      shift+=7;
+    }
+
+    return false;
+  }
+
+  static uint8_t BitsNeeded(uint64_t value)
+  {
+    uint8_t bits=0;
+
+    while (value!=0) {
+      bits++;
+      value>>=1;
+    }
+
+    return bits;
+  }
+
+  void EncodePostingList(const std::vector<FileOffset>& offsets,
+                         std::vector<char>& buffer)
+  {
+    EncodeUnsigned(offsets.size(),
+                   buffer);
+
+    if (offsets.empty()) {
+      return;
+    }
+
+    EncodeUnsigned(offsets.front(),
+                   buffer);
+
+    for (size_t blockStart=1;
+         blockStart<offsets.size();
+         blockStart+=POSTING_LIST_BLOCK_SIZE) {
+      size_t  blockEnd=std::min(blockStart+POSTING_LIST_BLOCK_SIZE,
+                                offsets.size());
+      uint8_t bits=0;
+
+      for (size_t i=blockStart; i<blockEnd; i++) {
+        assert(offsets[i]>offsets[i-1]);
+
+        bits=std::max(bits,
+                      BitsNeeded(offsets[i]-offsets[i-1]-1));
+      }
+
+      size_t dataStart=buffer.size()+1;
+
+      buffer.push_back((char)bits);
+      buffer.resize(dataStart+((blockEnd-blockStart)*bits+7)/8,
+                    0);
+
+      unsigned char* data=(unsigned char*)&buffer[dataStart];
+      size_t         bitPos=0;
+
+      for (size_t i=blockStart; i<blockEnd; i++) {
+        uint64_t value=offsets[i]-offsets[i-1]-1;
+
+        for (size_t bit=0; bit<bits; bit++) {
+          if ((value & (((uint64_t)1) << bit))!=0) {
+            data[(bitPos+bit)/8]|=(unsigned char)(1 << ((bitPos+bit)%8));
+          }
+        }
+
+        bitPos+=bits;
+      }
+    }
+  }
+
+  /**
+   * Unpacks 'count' values of 'bits' bits each from data, adding them as
+   * deltas (plus one) to 'offset'. The loop body only has to load and shift
+   * a 64 bit word for values of up to 56 bits, the slow path for wider
+   * values is practically never taken.
+   */
+  static void UnpackDeltas(const unsigned char* data,
+                           size_t count,
+                           uint8_t bits,
+                           FileOffset offset,
+                           FileOffset* target)
+  {
+    if (bits==0) {
+      for (size_t i=0; i<count; i++) {
+        offset++;
+        target[i]=offset;
+      }
+
+      return;
+    }
+
+    uint64_t mask=bits==64 ? ~((uint64_t)0) : (((uint64_t)1) << bits)-1;
+    size_t   dataSize=(count*bits+7)/8;
+    size_t   bitPos=0;
+
+    for (size_t i=0; i<count; i++) {
+      size_t   bytePos=bitPos/8;
+      size_t   shift=bitPos%8;
+      size_t   bytes=std::min((size_t)8,dataSize-bytePos);
+      uint64_t word=0;
+
+      for (size_t b=0; b<bytes; b++) {
+        word|=((uint64_t)data[bytePos+b]) << (8*b);
+      }
+
+      word>>=shift;
+
+      if (shift+bits>64) {
+        word|=((uint64_t)data[bytePos+8]) << (64-shift);
+      }
+
+      offset+=(word & mask)+1;
+      target[i]=offset;
+
+      bitPos+=bits;
+    }
+  }
+
+  bool DecodePostingList(const char* buffer,
+                         size_t size,
+                         size_t& pos,
+                         std::vector<FileOffset>& offsets)
+  {
+    uint64_t count;
+    uint64_t first;
+
+    if (!DecodeUnsigned(buffer,
+                        size,
+                        pos,
+                        count)) {
+      return false;
+    }
+
+    if (count==0) {
+      return true;
+    }
+
+    if (!DecodeUnsigned(buffer,
+                        size,
+                        pos,
+                        first)) {
+      return false;
+    }
+
+    size_t start=offsets.size();
+
+    offsets.resize(start+count);
+    offsets[start]=first;
+
+    for (size_t blockStart=1;
+         blockStart<count;
+         blockStart+=POSTING_LIST_BLOCK_SIZE) {
+      size_t blockCount=std::min((size_t)POSTING_LIST_BLOCK_SIZE,
+                                 (size_t)count-blockStart);
+
+      if (pos>=size) {
+        offsets.resize(start);
+        return false;
+      }
+
+      uint8_t bits=(uint8_t)buffer[pos++];
+      size_t  dataSize=(blockCount*bits+7)/8;
+
+      if (bits>64 ||
+          pos+dataSize>size) {
+        offsets.resize(start);
+        return false;
+      }
+
+      UnpackDeltas((const unsigned char*)&buffer[pos],
+                   blockCount,
+                   bits,
+                   offsets[start+blockStart-1],
+                   &offsets[start+blockStart]);
+
+      pos+=dataSize;
+    }
+
+    return true;
+  }
+
+  /**
+   * The lists are merged pairwise in rounds, each round halving the number of
+   * lists. Compared to merging all lists at once using a heap each round is a
+   * simple sequential pass over the data, which is considerably faster for the
+   * many short lists of a cell index query.
+   */
+  void MergePostingLists(const std::vector<FileOffset>& offsets,
+                         const std::vector<size_t>& listStarts,
+                         std::vector<FileOffset>& result)
+  {
+    if (listStarts.empty()) {
+      return;
+    }
+
+    if (listStarts.size()==1) {
+      result.insert(result.end(),
+                    offsets.begin()+listStarts.front(),
+                    offsets.end());
+      return;
+    }
+
+    std::vector<FileOffset> current(offsets.begin()+listStarts.front(),
+                                    offsets.end());
+    std::vector<size_t>     currentStarts;
+    std::vector<FileOffset> next;
+    std::vector<size_t>     nextStarts;
+
+    currentStarts.reserve(listStarts.size()+1);
+
+    for (const auto start : listStarts) {
+      currentStarts.push_back(start-listStarts.front());
+    }
+
+    currentStarts.push_back(current.size());
+
+    next.reserve(current.size());
+    nextStarts.reserve(currentStarts.size()/2+2);
+
+    while (currentStarts.size()>2) {
+      next.clear();
+      nextStarts.clear();
+
+      for (size_t l=0; l+1<currentStarts.size(); l+=2) {
+        nextStarts.push_back(next.size());
+
+        if (l+2<currentStarts.size()) {
+          std::set_union(current.begin()+currentStarts[l],
+                         current.begin()+currentStarts[l+1],
+                         current.begin()+currentStarts[l+1],
+                         current.begin()+currentStarts[l+2],
+                         std::back_inserter(next));
+        }
+        else {
+          next.insert(next.end(),
+                      current.begin()+currentStarts[l],
+                      current.begin()+currentStarts[l+1]);
+        }
+      }
+
+      nextStarts.push_back(next.size());
+
+      current.swap(next);
+      currentStarts.swap(nextStarts);
+    }
+
+    result.insert(result.end(),
+                  current.begin(),
+                  current.end());
+  }
+}
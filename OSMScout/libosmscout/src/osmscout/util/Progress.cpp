@@ -133,5 +133,77 @@ namespace osmscout {
   {
     std::cout << "   !! " << text << std::endl;
   }
-}
 
+  void BufferedProgress::Debug(const std::string& text)
+  {
+    if (OutputDebug()) {
+      Message message;
+
+      message.type=debugMessage;
+      message.text=text;
+
+      messages.push_back(message);
+    }
+  }
+
+  void BufferedProgress::Info(const std::string& text)
+  {
+    Message message;
+
+    message.type=infoMessage;
+    message.text=text;
+
+    messages.push_back(message);
+  }
+
+  void BufferedProgress::Warning(const std::string& text)
+  {
+    Message message;
+
+    message.type=warningMessage;
+    message.text=text;
+
+    messages.push_back(message);
+  }
+
+  void BufferedProgress::Error(const std::string& text)
+  {
+    Message message;
+
+    message.type=errorMessage;
+    message.text=text;
+
+    messages.push_back(message);
+  }
+
+  bool BufferedProgress::HasMessages() const
+  {
+    return !messages.empty();
+  }
+
+  /**
+   * Pass all collected messages in order to the given progress instance and
+   * clear the buffer afterwards.
+   */
+  void BufferedProgress::Forward(Progress& progress)
+  {
+    for (const auto& message : messages) {
+      switch (message.type) {
+      case debugMessage:
+        progress.Debug(message.text);
+        break;
+      case infoMessage:
+        progress.Info(message.text);
+        break;
+      case warningMessage:
+        progress.Warning(message.text);
+        break;
+      case errorMessage:
+        progress.Error(message.text);
+        break;
+      }
+    }
+
+    messages.clear();
+  }
+}
@@ -0,0 +1,486 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/Tracing.h>
+
+#include <fstream>
+
+#if defined(OSMSCOUT_HAVE_TRACING)
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#endif
+
+namespace osmscout {
+
+#if defined(OSMSCOUT_HAVE_TRACING)
+  /**
+   * Escape the given text for usage within a JSON string or a Prometheus label
+   */
+  static std::string EscapeTraceText(const char* text)
+  {
+    std::string result;
+
+    for (const char* c=text; *c!='\0'; c++) {
+      if (*c=='"' || *c=='\\') {
+        result+='\\';
+        result+=*c;
+      }
+      else if (*c=='\n') {
+        result+="\\n";
+      }
+      else if ((unsigned char)*c>=0x20) {
+        result+=*c;
+      }
+    }
+
+    return result;
+  }
+
+  /**
+   * Return a valid Prometheus metric name for the given counter name
+   */
+  static std::string GetMetricName(const std::string& name)
+  {
+    std::string result="osmscout_";
+
+    for (const auto& c : name) {
+      if ((c>='a' && c<='z') ||
+          (c>='A' && c<='Z') ||
+          (c>='0' && c<='9') ||
+          c=='_') {
+        result+=c;
+      }
+      else {
+        result+='_';
+      }
+    }
+
+    return result;
+  }
+
+  /**
+   * A recorded span
+   */
+  struct TraceSpanRecord
+  {
+    const char* category;
+    const char* name;
+    uint64_t    start;    //!< Start in microseconds since the start of the tracer
+    uint64_t    duration; //!< Duration in microseconds
+  };
+
+  /**
+   * Number and summed up duration of the spans of one category and name
+   */
+  struct TraceSpanStatistics
+  {
+    uint64_t count;
+    uint64_t duration;
+  };
+
+  /**
+   * Spans and counters recorded by one thread.
+   *
+   * The mutex is only contended while exporting, recording threads only
+   * access their own buffer.
+   */
+  struct TraceThreadBuffer
+  {
+    std::mutex                                                       mutex;
+    size_t                                                           threadId;
+    std::vector<TraceSpanRecord>                                     spans;
+    size_t                                                           droppedSpans;
+    std::map<std::pair<const char*,const char*>,TraceSpanStatistics> spanStatistics;
+    std::unordered_map<const char*,int64_t>                          counters;
+  };
+
+  typedef std::shared_ptr<TraceThreadBuffer> TraceThreadBufferRef;
+
+  /**
+   * Global state of the tracer
+   */
+  struct TraceState
+  {
+    std::atomic<bool>                     enabled;
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex                            mutex;
+    size_t                                nextThreadId;
+    std::list<TraceThreadBufferRef>       buffers;
+    std::set<std::string>                 names;
+
+    TraceState()
+    : enabled(false),
+      epoch(std::chrono::steady_clock::now()),
+      nextThreadId(1)
+    {
+      // no code
+    }
+  };
+
+  static TraceState& GetTraceState()
+  {
+    static TraceState state;
+
+    return state;
+  }
+
+  /**
+   * Return the buffer of the current thread, registering it on first usage. The
+   * buffer is kept by the tracer after the thread has ended, so its data can
+   * still be exported.
+   */
+  static TraceThreadBuffer& GetTraceThreadBuffer()
+  {
+    static thread_local TraceThreadBufferRef buffer;
+
+    if (!buffer) {
+      TraceState& state=GetTraceState();
+
+      buffer=std::make_shared<TraceThreadBuffer>();
+      buffer->droppedSpans=0;
+
+      std::lock_guard<std::mutex> lock(state.mutex);
+
+      buffer->threadId=state.nextThreadId++;
+      state.buffers.push_back(buffer);
+    }
+
+    return *buffer;
+  }
+
+  /**
+   * Return copies of the buffers of all threads, so they can be exported
+   * without blocking the recording threads for too long
+   */
+  static std::list<TraceThreadBufferRef> GetTraceThreadBuffers()
+  {
+    TraceState&                     state=GetTraceState();
+    std::list<TraceThreadBufferRef> result;
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    for (const auto& buffer : state.buffers) {
+      TraceThreadBufferRef copy=std::make_shared<TraceThreadBuffer>();
+
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+      copy->threadId=buffer->threadId;
+      copy->spans=buffer->spans;
+      copy->droppedSpans=buffer->droppedSpans;
+      copy->spanStatistics=buffer->spanStatistics;
+      copy->counters=buffer->counters;
+
+      result.push_back(copy);
+    }
+
+    return result;
+  }
+#endif
+
+  /**
+   * Return true, if the library has been configured with tracing support
+   */
+  bool Tracer::IsSupported()
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Enable or disable recording of spans and counters. Without tracing support
+   * the tracer cannot be enabled.
+   */
+  void Tracer::SetEnabled(bool enabled)
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    GetTraceState().enabled=enabled;
+#else
+    (void)enabled;
+#endif
+  }
+
+  bool Tracer::IsEnabled()
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    return GetTraceState().enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+  }
+
+  /**
+   * Return the current time in microseconds since the start of the tracer
+   */
+  uint64_t Tracer::GetTimestamp()
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-GetTraceState().epoch).count();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * Return a pointer to a copy of the given name, that stays valid for the
+   * lifetime of the program. Use it for span names that are not literals.
+   */
+  const char* Tracer::InternName(const std::string& name)
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    TraceState&                 state=GetTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    return state.names.insert(name).first->c_str();
+#else
+    (void)name;
+    return "";
+#endif
+  }
+
+  /**
+   * Record a span of the current thread, start and end are timestamps as
+   * returned by GetTimestamp().
+   */
+  void Tracer::AddSpan(const char* category,
+                       const char* name,
+                       uint64_t start,
+                       uint64_t end)
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    if (!IsEnabled()) {
+      return;
+    }
+
+    TraceThreadBuffer&          buffer=GetTraceThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceSpanStatistics&        statistics=buffer.spanStatistics[std::make_pair(category,name)];
+
+    statistics.count++;
+    statistics.duration+=end-start;
+
+    if (buffer.spans.size()>=MAX_SPANS_PER_THREAD) {
+      buffer.droppedSpans++;
+      return;
+    }
+
+    TraceSpanRecord span;
+
+    span.category=category;
+    span.name=name;
+    span.start=start;
+    span.duration=end-start;
+
+    buffer.spans.push_back(span);
+#else
+    (void)category;
+    (void)name;
+    (void)start;
+    (void)end;
+#endif
+  }
+
+  /**
+   * Add the given value to the named counter of the current thread. The name
+   * must stay valid until the counters have been exported.
+   */
+  void Tracer::AddToCounter(const char* name,
+                            int64_t value)
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    if (!IsEnabled()) {
+      return;
+    }
+
+    TraceThreadBuffer&          buffer=GetTraceThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+
+    buffer.counters[name]+=value;
+#else
+    (void)name;
+    (void)value;
+#endif
+  }
+
+  /**
+   * Return the counters summed up over all threads
+   */
+  void Tracer::GetCounters(std::map<std::string,int64_t>& counters)
+  {
+    counters.clear();
+
+#if defined(OSMSCOUT_HAVE_TRACING)
+    for (const auto& buffer : GetTraceThreadBuffers()) {
+      for (const auto& counter : buffer->counters) {
+        counters[counter.first]+=counter.second;
+      }
+    }
+#endif
+  }
+
+  /**
+   * Write all recorded spans in the Chrome trace event format.
+   */
+  bool Tracer::WriteChromeTrace(std::ostream& stream)
+  {
+    stream << "{\"traceEvents\":[";
+
+#if defined(OSMSCOUT_HAVE_TRACING)
+    bool first=true;
+
+    for (const auto& buffer : GetTraceThreadBuffers()) {
+      stream << (first ? "" : ",") << std::endl;
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId;
+      stream << ",\"args\":{\"name\":\"Thread " << buffer->threadId << "\"}}";
+
+      first=false;
+
+      for (const auto& span : buffer->spans) {
+        stream << "," << std::endl;
+        stream << "{\"name\":\"" << EscapeTraceText(span.name) << "\"";
+        stream << ",\"cat\":\"" << EscapeTraceText(span.category) << "\"";
+        stream << ",\"ph\":\"X\",\"ts\":" << span.start << ",\"dur\":" << span.duration;
+        stream << ",\"pid\":1,\"tid\":" << buffer->threadId << "}";
+      }
+    }
+#endif
+
+    stream << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+    return !stream.fail();
+  }
+
+  bool Tracer::WriteChromeTrace(const std::string& filename)
+  {
+    std::ofstream stream(filename.c_str());
+
+    if (!stream) {
+      return false;
+    }
+
+    return WriteChromeTrace(stream);
+  }
+
+  /**
+   * Write a snapshot of all counters and of the number and duration of all
+   * spans in the Prometheus text format, so it can be served to a scraper.
+   */
+  bool Tracer::WriteCounters(std::ostream& stream)
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    std::map<std::string,int64_t>                                    counters;
+    std::map<std::pair<std::string,std::string>,TraceSpanStatistics> spans;
+    size_t                                                           droppedSpans=0;
+
+    for (const auto& buffer : GetTraceThreadBuffers()) {
+      for (const auto& counter : buffer->counters) {
+        counters[counter.first]+=counter.second;
+      }
+
+      for (const auto& entry : buffer->spanStatistics) {
+        TraceSpanStatistics& statistics=spans[std::make_pair(std::string(entry.first.first),
+                                                             std::string(entry.first.second))];
+
+        statistics.count+=entry.second.count;
+        statistics.duration+=entry.second.duration;
+      }
+
+      droppedSpans+=buffer->droppedSpans;
+    }
+
+    for (const auto& counter : counters) {
+      std::string name=GetMetricName(counter.first);
+
+      stream << "# TYPE " << name << " counter" << std::endl;
+      stream << name << " " << counter.second << std::endl;
+    }
+
+    stream << "# TYPE osmscout_span_count counter" << std::endl;
+
+    for (const auto& span : spans) {
+      stream << "osmscout_span_count{category=\"" << EscapeTraceText(span.first.first.c_str());
+      stream << "\",name=\"" << EscapeTraceText(span.first.second.c_str()) << "\"} ";
+      stream << span.second.count << std::endl;
+    }
+
+    stream << "# TYPE osmscout_span_microseconds counter" << std::endl;
+
+    for (const auto& span : spans) {
+      stream << "osmscout_span_microseconds{category=\"" << EscapeTraceText(span.first.first.c_str());
+      stream << "\",name=\"" << EscapeTraceText(span.first.second.c_str()) << "\"} ";
+      stream << span.second.duration << std::endl;
+    }
+
+    stream << "# TYPE osmscout_span_dropped counter" << std::endl;
+    stream << "osmscout_span_dropped " << droppedSpans << std::endl;
+#endif
+
+    return !stream.fail();
+  }
+
+  /**
+   * Drop all recorded spans and counters
+   */
+  void Tracer::Clear()
+  {
+#if defined(OSMSCOUT_HAVE_TRACING)
+    TraceState&                 state=GetTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    for (const auto& buffer : state.buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+      buffer->spans.clear();
+      buffer->droppedSpans=0;
+      buffer->spanStatistics.clear();
+      buffer->counters.clear();
+    }
+#endif
+  }
+
+  TraceSpan::TraceSpan(const char* category,
+                       const char* name)
+  : category(category),
+    name(name),
+    start(0),
+    active(Tracer::IsEnabled())
+  {
+    if (active) {
+      start=Tracer::GetTimestamp();
+    }
+  }
+
+  TraceSpan::~TraceSpan()
+  {
+    if (active) {
+      Tracer::AddSpan(category,
+                      name,
+                      start,
+                      Tracer::GetTimestamp());
+    }
+  }
+}
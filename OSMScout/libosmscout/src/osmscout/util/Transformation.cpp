@@ -182,11 +182,57 @@ namespace osmscout {
     delete [] points;
   }
 
+  /**
+   * Allocates enough points for the given number of nodes
+   */
+  void TransPolygon::AllocatePoints(size_t count)
+  {
+    if (pointsSize<count) {
+      delete [] points;
+
+      points=new TransPoint[count];
+      pointsSize=count;
+    }
+  }
+
   void TransPolygon::TransformGeoToPixel(const Projection& projection,
                                          const std::vector<GeoCoord>& nodes)
   {
     Projection::BatchTransformer batchTransformer(projection);
 
+    AllocatePoints(nodes.size());
+
+    if (!nodes.empty()) {
+      start=0;
+      length=nodes.size();
+      end=length-1;
+
+      for (size_t i=start; i<=end; i++) {
+         batchTransformer.GeoToPixel(nodes[i].GetLon(),
+                                     nodes[i].GetLat(),
+                                     points[i].x,
+                                     points[i].y);
+        points[i].draw=true;
+      }
+    }
+    else {
+      start=0;
+      end=0;
+      length=0;
+    }
+  }
+
+  /**
+   * Like TransformGeoToPixel(const Projection&,const std::vector<GeoCoord>&),
+   * the fixed point coordinates are converted directly before the projection.
+   */
+  void TransPolygon::TransformGeoToPixel(const Projection& projection,
+                                         const std::vector<CompactGeoCoord>& nodes)
+  {
+    Projection::BatchTransformer batchTransformer(projection);
+
+    AllocatePoints(nodes.size());
+
     if (!nodes.empty()) {
       start=0;
       length=nodes.size();
@@ -349,58 +395,118 @@ namespace osmscout {
     }
   }
 
-  void TransPolygon::TransformArea(const Projection& projection,
-                                   OptimizeMethod optimize,
-                                   const std::vector<GeoCoord>& nodes,
-                                   double optimizeErrorTolerance)
+  /**
+   * Drops points of the transformed area depending on the optimization method
+   * and calculates start, end and length
+   */
+  void TransPolygon::OptimizeArea(OptimizeMethod optimize,
+                                  double optimizeErrorTolerance)
   {
-    if (nodes.size()<2) {
-      length=0;
-
+    if (optimize==none) {
       return;
     }
 
-    if (pointsSize<nodes.size()) {
-      delete [] points;
+    size_t count=length;
 
-      points=new TransPoint[nodes.size()];
-      pointsSize=nodes.size();
+    if (optimize==fast) {
+      DropSimilarPoints(optimizeErrorTolerance);
+      DropRedundantPointsFast(optimizeErrorTolerance);
+    }
+    else {
+      DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,true);
     }
 
-    if (optimize!=none) {
-      TransformGeoToPixel(projection,
-                          nodes);
+    length=0;
+    start=count;
+    end=0;
 
+    // Calculate start, end and length
+    for (size_t i=0; i<count; i++) {
+      if (points[i].draw) {
+        length++;
 
-      if (optimize==fast) {
-        DropSimilarPoints(optimizeErrorTolerance);
-        DropRedundantPointsFast(optimizeErrorTolerance);
-      }
-      else {
-        DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,true);
+        if (i<start) {
+          start=i;
+        }
+
+        end=i;
       }
+    }
+  }
 
-      length=0;
-      start=nodes.size();
-      end=0;
+  /**
+   * Drops points of the transformed way depending on the optimization method
+   * and calculates start, end and length
+   */
+  void TransPolygon::OptimizeWay(OptimizeMethod optimize,
+                                 double optimizeErrorTolerance)
+  {
+    if (optimize==none) {
+      return;
+    }
 
-      // Calculate start, end and length
-      for (size_t i=0; i<nodes.size(); i++) {
-        if (points[i].draw) {
-          length++;
+    size_t count=length;
 
-          if (i<start) {
-            start=i;
-          }
+    DropSimilarPoints(optimizeErrorTolerance);
+
+    if (optimize==fast) {
+      DropRedundantPointsFast(optimizeErrorTolerance);
+    }
+    else {
+      DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,false);
+    }
+
+    length=0;
+    start=count;
+    end=0;
 
-          end=i;
+    // Calculate start & end
+    for (size_t i=0; i<count; i++) {
+      if (points[i].draw) {
+        length++;
+
+        if (i<start) {
+          start=i;
         }
+        end=i;
       }
     }
-    else {
-      TransformGeoToPixel(projection,
-                          nodes);
+  }
+
+  void TransPolygon::TransformArea(const Projection& projection,
+                                   OptimizeMethod optimize,
+                                   const std::vector<GeoCoord>& nodes,
+                                   double optimizeErrorTolerance)
+  {
+    if (nodes.size()<2) {
+      length=0;
+
+      return;
     }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+
+    OptimizeArea(optimize,
+                 optimizeErrorTolerance);
+  }
+
+  void TransPolygon::TransformArea(const Projection& projection,
+                                   OptimizeMethod optimize,
+                                   const std::vector<CompactGeoCoord>& nodes,
+                                   double optimizeErrorTolerance)
+  {
+    if (nodes.size()<2) {
+      length=0;
+
+      return;
+    }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+
+    OptimizeArea(optimize,
+                 optimizeErrorTolerance);
   }
 
   void TransPolygon::TransformWay(const Projection& projection,
@@ -414,46 +520,29 @@ namespace osmscout {
       return;
     }
 
-    if (pointsSize<nodes.size()) {
-      delete [] points;
-
-      points=new TransPoint[nodes.size()];
-      pointsSize=nodes.size();
-    }
-
-    if (optimize!=none) {
-      TransformGeoToPixel(projection,
-                          nodes);
+    TransformGeoToPixel(projection,
+                        nodes);
 
-      DropSimilarPoints(optimizeErrorTolerance);
-
-      if (optimize==fast) {
-        DropRedundantPointsFast(optimizeErrorTolerance);
-      }
-      else {
-        DropRedundantPointsDouglasPeucker(optimizeErrorTolerance,false);
-      }
+    OptimizeWay(optimize,
+                optimizeErrorTolerance);
+  }
 
+  void TransPolygon::TransformWay(const Projection& projection,
+                                  OptimizeMethod optimize,
+                                  const std::vector<CompactGeoCoord>& nodes,
+                                  double optimizeErrorTolerance)
+  {
+    if (nodes.empty()) {
       length=0;
-      start=nodes.size();
-      end=0;
 
-      // Calculate start & end
-      for (size_t i=0; i<nodes.size(); i++) {
-        if (points[i].draw) {
-          length++;
-
-          if (i<start) {
-            start=i;
-          }
-          end=i;
-        }
-      }
-    }
-    else {
-      TransformGeoToPixel(projection,
-                          nodes);
+      return;
     }
+
+    TransformGeoToPixel(projection,
+                        nodes);
+
+    OptimizeWay(optimize,
+                optimizeErrorTolerance);
   }
 
   bool TransPolygon::GetBoundingBox(double& xmin, double& ymin,
@@ -527,6 +616,27 @@ namespace osmscout {
     buffer->Reset();
   }
 
+  /**
+   * Copies the points of the transformed polygon that should be drawn to the
+   * coordinate buffer
+   */
+  void TransBuffer::CopyPoints(size_t& start,
+                               size_t& end)
+  {
+    bool isStart=true;
+    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
+      if (transPolygon.points[i].draw) {
+        end=buffer->PushCoord(transPolygon.points[i].x,
+                              transPolygon.points[i].y);
+
+        if (isStart) {
+          start=end;
+          isStart=false;
+        }
+      }
+    }
+  }
+
   void TransBuffer::TransformArea(const Projection& projection,
                                   TransPolygon::OptimizeMethod optimize,
                                   const std::vector<GeoCoord>& nodes,
@@ -540,18 +650,25 @@ namespace osmscout {
 
     assert(!transPolygon.IsEmpty());
 
-    bool isStart=true;
-    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
-      if (transPolygon.points[i].draw) {
-        end=buffer->PushCoord(transPolygon.points[i].x,
-                              transPolygon.points[i].y);
+    CopyPoints(start,
+               end);
+  }
 
-        if (isStart) {
-          start=end;
-          isStart=false;
-        }
-      }
-    }
+  void TransBuffer::TransformArea(const Projection& projection,
+                                  TransPolygon::OptimizeMethod optimize,
+                                  const std::vector<CompactGeoCoord>& nodes,
+                                  size_t& start, size_t &end,
+                                  double optimizeErrorTolerance)
+  {
+    transPolygon.TransformArea(projection,
+                               optimize,
+                               nodes,
+                               optimizeErrorTolerance);
+
+    assert(!transPolygon.IsEmpty());
+
+    CopyPoints(start,
+               end);
   }
 
   bool TransBuffer::TransformWay(const Projection& projection,
@@ -566,19 +683,27 @@ namespace osmscout {
       return false;
     }
 
-    bool isStart=true;
-    for (size_t i=transPolygon.GetStart(); i<=transPolygon.GetEnd(); i++) {
-      if (transPolygon.points[i].draw) {
-        end=buffer->PushCoord(transPolygon.points[i].x,
-                              transPolygon.points[i].y);
+    CopyPoints(start,
+               end);
 
-        if (isStart) {
-          start=end;
-          isStart=false;
-        }
-      }
+    return true;
+  }
+
+  bool TransBuffer::TransformWay(const Projection& projection,
+                                 TransPolygon::OptimizeMethod optimize,
+                                 const std::vector<CompactGeoCoord>& nodes,
+                                 size_t& start, size_t &end,
+                                 double optimizeErrorTolerance)
+  {
+    transPolygon.TransformWay(projection, optimize, nodes, optimizeErrorTolerance);
+
+    if (transPolygon.IsEmpty()) {
+      return false;
     }
 
+    CopyPoints(start,
+               end);
+
     return true;
   }
 }
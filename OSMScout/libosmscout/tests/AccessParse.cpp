@@ -104,7 +104,7 @@ bool CheckParseSuccess(bool canFoot,
   osmscout::TypeInfoRef                           testType=new osmscout::TypeInfo();
   osmscout::FeatureRef                            accessFeature;
   size_t                                          featureInstanceIndex;
-  std::unordered_map<osmscout::TagId,std::string> tags;
+  osmscout::TagMap                                tags;
 
   for (const auto &entry : stringTags) {
     osmscout::TagId tagId=typeConfig.RegisterTag(entry.first);
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/AreaAreaIndex.h>
+#include <osmscout/AreaAreaRTreeIndex.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/TypeSet.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/GeoBox.h>
+
+/*
+ * Builds the quadtree of AreaAreaIndex and the R-tree of AreaAreaRTreeIndex
+ * over the same generated areas. For random viewports the result of the R-tree
+ * must be the result of the quadtree restricted to the areas whose bounding
+ * box intersects the viewport. The quadtree also returns areas in cells near
+ * the viewport, the R-tree only areas actually in it.
+ */
+
+int errors=0;
+
+static const size_t   areaCount=20000;
+static const size_t   areaTypeCount=70;  // More than 64, so types share bits of the type mask
+static const uint32_t maxLevel=15;
+static const size_t   unlimited=std::numeric_limits<size_t>::max();
+
+struct TestArea
+{
+  osmscout::FileOffset offset;
+  osmscout::TypeId     type;
+  osmscout::GeoBox     boundingBox;
+  uint32_t             level;
+};
+
+static std::mt19937 generator(4711);
+
+static double GetRandom(double min,
+                        double max)
+{
+  return std::uniform_real_distribution<double>(min,max)(generator);
+}
+
+static size_t GetIndex(osmscout::FileOffset offset)
+{
+  return (size_t)((offset-1000)/64);
+}
+
+static void GenerateAreas(const osmscout::TypeConfig& typeConfig,
+                          std::vector<TestArea>& areas)
+{
+  const std::vector<osmscout::TypeInfoRef>& types=typeConfig.GetAreaTypes();
+
+  for (size_t i=0; i<areaCount; i++) {
+    TestArea area;
+    double   lon=GetRandom(5.0,15.0);
+    double   lat=GetRandom(45.0,55.0);
+    // From buildings to countries, evenly distributed over the levels
+    double   width=pow(10.0,GetRandom(-4.0,1.3));
+    double   height=width*GetRandom(0.2,2.0);
+
+    area.offset=1000+i*64;
+    area.type=types[(i*7919)%types.size()]->GetAreaId();
+    area.boundingBox.Set(osmscout::GeoCoord(lat-height/2,lon-width/2),
+                         osmscout::GeoCoord(lat+height/2,lon+width/2));
+    area.level=osmscout::AreaAreaIndex::GetAreaLevel(area.boundingBox,
+                                                     maxLevel);
+
+    areas.push_back(area);
+  }
+}
+
+static bool WriteQuadtree(const osmscout::TypeConfig& typeConfig,
+                          const std::vector<TestArea>& areas)
+{
+  osmscout::AreaAreaIndexWriter writer;
+
+  if (!writer.Open("areaarea.idx",
+                   maxLevel,
+                   typeConfig.GetAreaTypeIdBytes())) {
+    return false;
+  }
+
+  while (true) {
+    uint32_t level=writer.GetLevel();
+
+    for (const auto& area : areas) {
+      if (area.level==level) {
+        writer.AddArea(area.offset,
+                       area.type,
+                       area.boundingBox);
+      }
+    }
+
+    if (!writer.WriteLevel()) {
+      return false;
+    }
+
+    if (level==0) {
+      break;
+    }
+  }
+
+  return writer.Close();
+}
+
+static bool WriteRTree(const std::vector<TestArea>& areas)
+{
+  osmscout::AreaAreaRTreeIndexWriter writer(maxLevel);
+
+  for (const auto& area : areas) {
+    writer.AddArea(area.offset,
+                   area.type,
+                   area.boundingBox);
+  }
+
+  if (!writer.Write(osmscout::AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE)) {
+    return false;
+  }
+
+  if (writer.GetHeight()<2) {
+    std::cerr << "Expected an R-tree with inner nodes, got " << writer.GetHeight() << " levels" << std::endl;
+    errors++;
+  }
+
+  return true;
+}
+
+/**
+ * Returns true, if the bounding box of the area intersects the viewport,
+ * in the fixed point coordinates of the R-tree
+ */
+static bool Intersects(const TestArea& area,
+                       const osmscout::GeoBox& viewport)
+{
+  return osmscout::AreaAreaRTreeIndex::GetFixedLon(area.boundingBox.GetMinLon(),false)<=osmscout::AreaAreaRTreeIndex::GetFixedLon(viewport.GetMaxLon(),true) &&
+         osmscout::AreaAreaRTreeIndex::GetFixedLat(area.boundingBox.GetMinLat(),false)<=osmscout::AreaAreaRTreeIndex::GetFixedLat(viewport.GetMaxLat(),true) &&
+         osmscout::AreaAreaRTreeIndex::GetFixedLon(area.boundingBox.GetMaxLon(),true)>=osmscout::AreaAreaRTreeIndex::GetFixedLon(viewport.GetMinLon(),false) &&
+         osmscout::AreaAreaRTreeIndex::GetFixedLat(area.boundingBox.GetMaxLat(),true)>=osmscout::AreaAreaRTreeIndex::GetFixedLat(viewport.GetMinLat(),false);
+}
+
+/**
+ * Returns the areas of the quadtree result in the viewport, sorted by level
+ * and file offset like the result of the R-tree
+ */
+static void Restrict(const std::vector<TestArea>& areas,
+                     const osmscout::GeoBox& viewport,
+                     const std::vector<osmscout::FileOffset>& offsets,
+                     std::vector<osmscout::FileOffset>& restricted)
+{
+  restricted.clear();
+
+  for (const auto offset : offsets) {
+    if (Intersects(areas[GetIndex(offset)],viewport)) {
+      restricted.push_back(offset);
+    }
+  }
+
+  std::sort(restricted.begin(),
+            restricted.end(),
+            [&areas](osmscout::FileOffset a, osmscout::FileOffset b) {
+    return areas[GetIndex(a)].level<areas[GetIndex(b)].level ||
+           (areas[GetIndex(a)].level==areas[GetIndex(b)].level && a<b);
+  });
+}
+
+static void CheckViewport(const std::string& test,
+                          const osmscout::TypeConfigRef& typeConfig,
+                          const osmscout::AreaAreaIndex& quadtree,
+                          const osmscout::AreaAreaRTreeIndex& rtree,
+                          const std::vector<TestArea>& areas,
+                          const osmscout::GeoBox& viewport,
+                          size_t level,
+                          const osmscout::TypeSet& types,
+                          size_t maxCount)
+{
+  std::vector<osmscout::FileOffset> quadtreeOffsets;
+  std::vector<osmscout::FileOffset> restricted;
+  std::vector<osmscout::FileOffset> rtreeOffsets;
+
+  if (!quadtree.GetOffsets(typeConfig,
+                           viewport.GetMinLon(),
+                           viewport.GetMinLat(),
+                           viewport.GetMaxLon(),
+                           viewport.GetMaxLat(),
+                           level,
+                           types,
+                           unlimited,
+                           quadtreeOffsets) ||
+      !rtree.GetOffsets(typeConfig,
+                        viewport.GetMinLon(),
+                        viewport.GetMinLat(),
+                        viewport.GetMaxLon(),
+                        viewport.GetMaxLat(),
+                        level,
+                        types,
+                        maxCount,
+                        rtreeOffsets)) {
+    std::cerr << test << ": Query failed" << std::endl;
+    errors++;
+    return;
+  }
+
+  Restrict(areas,
+           viewport,
+           quadtreeOffsets,
+           restricted);
+
+  if (maxCount!=unlimited) {
+    std::vector<osmscout::FileOffset> limitedOffsets;
+    std::vector<osmscout::FileOffset> limitedRestricted;
+
+    // Only complete levels with less than maxCount areas in total
+    size_t count=0;
+
+    while (count<restricted.size()) {
+      size_t levelEnd=count+1;
+
+      while (levelEnd<restricted.size() &&
+             areas[GetIndex(restricted[levelEnd])].level==areas[GetIndex(restricted[count])].level) {
+        levelEnd++;
+      }
+
+      if (levelEnd>=maxCount) {
+        break;
+      }
+
+      count=levelEnd;
+    }
+
+    restricted.resize(count);
+
+    // The quadtree counts areas in cells near the viewport and areas of other
+    // types, too. So the R-tree returns at least the levels of the quadtree.
+    if (!quadtree.GetOffsets(typeConfig,
+                             viewport.GetMinLon(),
+                             viewport.GetMinLat(),
+                             viewport.GetMaxLon(),
+                             viewport.GetMaxLat(),
+                             level,
+                             types,
+                             maxCount,
+                             limitedOffsets)) {
+      std::cerr << test << ": Query failed" << std::endl;
+      errors++;
+      return;
+    }
+
+    Restrict(areas,
+             viewport,
+             limitedOffsets,
+             limitedRestricted);
+
+    if (limitedRestricted.size()>restricted.size() ||
+        !std::equal(limitedRestricted.begin(),
+                    limitedRestricted.end(),
+                    restricted.begin())) {
+      std::cerr << test << ": R-tree returns less levels than the quadtree" << std::endl;
+      errors++;
+    }
+  }
+
+  if (rtreeOffsets!=restricted) {
+    std::cerr << test << ": R-tree returned " << rtreeOffsets.size() << " areas, quadtree " << restricted.size() << " areas in viewport " << viewport.GetDisplayText() << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  osmscout::TypeConfigRef typeConfig=std::make_shared<osmscout::TypeConfig>();
+  std::vector<TestArea>   areas;
+
+  for (size_t i=0; i<areaTypeCount; i++) {
+    osmscout::TypeInfoRef type=std::make_shared<osmscout::TypeInfo>();
+
+    type->SetType("area_"+std::to_string(i));
+    type->CanBeArea(true);
+
+    typeConfig->RegisterType(type);
+  }
+
+  GenerateAreas(*typeConfig,areas);
+
+  if (!WriteQuadtree(*typeConfig,areas) ||
+      !WriteRTree(areas)) {
+    std::cerr << "Cannot write indexes" << std::endl;
+    return 1;
+  }
+
+  osmscout::AreaAreaIndex      quadtree(1000,false);
+  osmscout::AreaAreaIndex      delegating(1000,true);
+  osmscout::AreaAreaRTreeIndex rtree;
+
+  if (!quadtree.Load(".") ||
+      !delegating.Load(".") ||
+      !rtree.Load(".")) {
+    std::cerr << "Cannot load indexes" << std::endl;
+    return 1;
+  }
+
+  if (quadtree.IsRTree() ||
+      !delegating.IsRTree()) {
+    std::cerr << "AreaAreaIndex does not respect the R-tree setting" << std::endl;
+    errors++;
+  }
+
+  // Type sets: All types, no type, a few types and two types sharing
+  // a bit of the type mask of inner nodes
+  std::vector<osmscout::TypeSet> typeSets(4,osmscout::TypeSet(*typeConfig));
+
+  for (const auto& type : typeConfig->GetAreaTypes()) {
+    typeSets[0].SetType(type->GetAreaId());
+
+    if (type->GetAreaId()%9==2) {
+      typeSets[2].SetType(type->GetAreaId());
+    }
+  }
+
+  typeSets[3].SetType(1);
+
+  std::vector<osmscout::GeoBox> viewports;
+
+  viewports.push_back(osmscout::GeoBox(osmscout::GeoCoord(-90.0,-180.0),
+                                       osmscout::GeoCoord(90.0,180.0)));
+  viewports.push_back(osmscout::GeoBox(osmscout::GeoCoord(10.0,-20.0),
+                                       osmscout::GeoCoord(20.0,-10.0)));
+  viewports.push_back(osmscout::GeoBox(osmscout::GeoCoord(50.0,10.0),
+                                       osmscout::GeoCoord(50.0,10.0)));
+
+  for (size_t i=0; i<200; i++) {
+    double lon=GetRandom(4.0,16.0);
+    double lat=GetRandom(44.0,56.0);
+    double width=pow(10.0,GetRandom(-3.0,1.0));
+    double height=width*GetRandom(0.5,1.5);
+
+    viewports.push_back(osmscout::GeoBox(osmscout::GeoCoord(lat,lon),
+                                         osmscout::GeoCoord(lat+height,lon+width)));
+  }
+
+  size_t levels[]={0,4,9,maxLevel,maxLevel+5};
+  size_t maxCounts[]={unlimited,1,50,500,5000};
+
+  for (size_t v=0; v<viewports.size(); v++) {
+    for (size_t t=0; t<typeSets.size(); t++) {
+      for (const auto level : levels) {
+        for (const auto maxCount : maxCounts) {
+          std::string test="Viewport "+std::to_string(v)+
+                           ", types "+std::to_string(t)+
+                           ", level "+std::to_string(level)+
+                           ", maxCount "+(maxCount==unlimited ? std::string("unlimited") : std::to_string(maxCount));
+
+          CheckViewport(test,
+                        typeConfig,
+                        quadtree,
+                        rtree,
+                        areas,
+                        viewports[v],
+                        level,
+                        typeSets[t],
+                        maxCount);
+        }
+      }
+    }
+
+    // Queries are delegated to the R-tree
+    std::vector<osmscout::FileOffset> rtreeOffsets;
+    std::vector<osmscout::FileOffset> delegatedOffsets;
+
+    rtree.GetOffsets(typeConfig,
+                     viewports[v].GetMinLon(),
+                     viewports[v].GetMinLat(),
+                     viewports[v].GetMaxLon(),
+                     viewports[v].GetMaxLat(),
+                     maxLevel,
+                     typeSets[0],
+                     500,
+                     rtreeOffsets);
+    delegating.GetOffsets(typeConfig,
+                          viewports[v].GetMinLon(),
+                          viewports[v].GetMinLat(),
+                          viewports[v].GetMaxLon(),
+                          viewports[v].GetMaxLat(),
+                          maxLevel,
+                          typeSets[0],
+                          500,
+                          delegatedOffsets);
+
+    if (delegatedOffsets!=rtreeOffsets) {
+      std::cerr << "Viewport " << v << ": AreaAreaIndex does not delegate to the R-tree" << std::endl;
+      errors++;
+    }
+  }
+
+  quadtree.Close();
+  delegating.Close();
+  rtree.Close();
+
+  osmscout::RemoveFile("areaarea.idx");
+  osmscout::RemoveFile(osmscout::AreaAreaRTreeIndex::FILENAME_AREAAREA_RTREE);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
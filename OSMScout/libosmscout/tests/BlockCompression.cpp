@@ -0,0 +1,237 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/util/BlockCompression.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+int errors=0;
+
+static const size_t      valueCount=20000;
+static const std::string text="A string crossing the border between two blocks";
+
+static bool WriteFile(const std::string& filename,
+                      std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::FileWriter writer;
+
+  if (!writer.Open(filename)) {
+    std::cerr << "Cannot create '" << filename << "'" << std::endl;
+    return false;
+  }
+
+  // Small blocks, so that values and strings cross block borders
+  writer.SetBlockCompression(1000);
+
+  writer.Write((uint32_t)0);
+
+  offsets.resize(valueCount);
+
+  for (size_t i=0; i<valueCount; i++) {
+    writer.GetPos(offsets[i]);
+
+    writer.WriteNumber((uint32_t)(i*7));
+
+    if (i%1000==0) {
+      writer.Write(text);
+    }
+  }
+
+  // Rewrite the header like the import does
+  writer.SetPos(0);
+  writer.Write((uint32_t)valueCount);
+
+  return writer.Close();
+}
+
+static void CheckValue(osmscout::FileScanner& scanner,
+                       size_t i)
+{
+  uint32_t value;
+
+  if (!scanner.ReadNumber(value) ||
+      value!=i*7) {
+    std::cerr << "Value " << i << ": Expected " << i*7 << ", got " << value << std::endl;
+    errors++;
+  }
+
+  if (i%1000==0) {
+    std::string value;
+
+    if (!scanner.Read(value) ||
+        value!=text) {
+      std::cerr << "String " << i << ": Expected '" << text << "', got '" << value << "'" << std::endl;
+      errors++;
+    }
+  }
+}
+
+static void CheckFile(const std::string& filename,
+                      const std::vector<osmscout::FileOffset>& offsets,
+                      bool memoryMapped)
+{
+  osmscout::FileScanner scanner;
+  osmscout::FileOffset  size;
+  uint32_t              count;
+
+  if (!scanner.Open(filename,osmscout::FileScanner::LowMemRandom,memoryMapped)) {
+    std::cerr << "Cannot open '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (!scanner.IsCompressed() ||
+      scanner.IsMemoryMapped() ||
+      scanner.CanReadAt()) {
+    std::cerr << "File '" << filename << "' is not opened as compressed file" << std::endl;
+    errors++;
+  }
+
+  if (!osmscout::BlockCompression::GetDataSize(filename,size) ||
+      size!=scanner.GetSize()) {
+    std::cerr << "Data size does not match size of the scanner" << std::endl;
+    errors++;
+  }
+
+  // Sequential
+
+  if (!scanner.Read(count) ||
+      count!=valueCount) {
+    std::cerr << "Header: Expected " << valueCount << ", got " << count << std::endl;
+    errors++;
+  }
+
+  for (size_t i=0; i<valueCount; i++) {
+    osmscout::FileOffset pos;
+
+    if (!scanner.GetPos(pos) ||
+        pos!=offsets[i]) {
+      std::cerr << "Position " << i << ": Expected " << offsets[i] << ", got " << pos << std::endl;
+      errors++;
+    }
+
+    CheckValue(scanner,i);
+  }
+
+  // Random
+
+  for (size_t j=0; j<valueCount; j++) {
+    size_t i=(j*7919)%valueCount;
+
+    if (!scanner.SetPos(offsets[i])) {
+      std::cerr << "Cannot set position " << offsets[i] << std::endl;
+      errors++;
+      continue;
+    }
+
+    CheckValue(scanner,i);
+  }
+
+  if (scanner.HasError()) {
+    std::cerr << "Scanner has error" << std::endl;
+    errors++;
+  }
+
+  scanner.Close();
+}
+
+static void ReadFile(const std::string& filename,
+                     osmscout::FileScanner& scanner)
+{
+  uint32_t count;
+
+  if (!scanner.Open(filename,osmscout::FileScanner::LowMemRandom,false)) {
+    std::cerr << "Cannot open '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  scanner.Read(count);
+
+  for (size_t i=0; i<valueCount; i++) {
+    CheckValue(scanner,i);
+  }
+}
+
+static void CheckSharedCache(const std::string& filename)
+{
+  osmscout::BlockCompression::Statistics statistics;
+  osmscout::FileScanner                  first;
+  osmscout::FileScanner                  second;
+  osmscout::FileScanner                  reopened;
+  uint64_t                               blocks;
+
+  osmscout::BlockCompression::SetCacheSize(osmscout::BlockCompression::DEFAULT_CACHE_SIZE);
+  osmscout::BlockCompression::ResetStatistics();
+
+  ReadFile(filename,first);
+
+  osmscout::BlockCompression::GetStatistics(statistics);
+  blocks=statistics.blocksDecompressed;
+
+  // A second stream of the same file is served from the cache
+  ReadFile(filename,second);
+
+  osmscout::BlockCompression::GetStatistics(statistics);
+
+  if (statistics.blocksDecompressed!=blocks) {
+    std::cerr << "Second stream decompressed " << statistics.blocksDecompressed-blocks << " blocks again" << std::endl;
+    errors++;
+  }
+
+  first.Close();
+  second.Close();
+
+  // The blocks of the file are dropped with its last stream
+  ReadFile(filename,reopened);
+
+  osmscout::BlockCompression::GetStatistics(statistics);
+
+  if (statistics.blocksDecompressed!=2*blocks) {
+    std::cerr << "Reopened file decompressed " << statistics.blocksDecompressed-blocks << " instead of " << blocks << " blocks" << std::endl;
+    errors++;
+  }
+
+  reopened.Close();
+}
+
+int main()
+{
+  std::string                       filename="test.cdat";
+  std::vector<osmscout::FileOffset> offsets;
+
+  if (!osmscout::BlockCompression::IsSupported()) {
+    std::cout << "Block compression is not supported, skipping test" << std::endl;
+    return 0;
+  }
+
+  if (!WriteFile(filename,offsets)) {
+    std::cerr << "Cannot write '" << filename << "'" << std::endl;
+    return 1;
+  }
+
+  if (!osmscout::BlockCompression::IsCompressed(filename)) {
+    std::cerr << "File '" << filename << "' is not compressed" << std::endl;
+    errors++;
+  }
+
+  CheckFile(filename,offsets,true);
+
+  CheckSharedCache(filename);
+
+  // Without cache, every block change decompresses the block again
+  osmscout::BlockCompression::SetCacheSize(0);
+
+  CheckFile(filename,offsets,false);
+
+  osmscout::RemoveFile(filename);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/util/Cache.h>
+
+typedef osmscout::Cache<size_t,std::string> TestCache;
+
+struct TestValueSizer : public TestCache::ValueSizer
+{
+  unsigned long GetSize(const std::string& value) const
+  {
+    return sizeof(value)+value.capacity();
+  }
+};
+
+int errors=0;
+
+static void Lookup(TestCache& cache,
+                   size_t key)
+{
+  TestCache::CacheRef cacheRef;
+
+  if (!cache.GetEntry(key,cacheRef)) {
+    TestCache::CacheEntry cacheEntry(key);
+
+    cacheRef=cache.SetEntry(cacheEntry);
+
+    // Filled in place, like the data files do
+    cacheRef->value.assign(1000,'x');
+
+    cache.UpdateMemory(cacheRef);
+  }
+}
+
+static void CheckMemoryLimit()
+{
+  TestValueSizer sizer;
+  TestCache      cache(10);
+
+  cache.SetValueSizer(&sizer);
+
+  for (size_t i=0; i<100; i++) {
+    Lookup(cache,i);
+  }
+
+  if (cache.GetEntryCount()!=10) {
+    std::cerr << "Entry limit: Expected 10 entries, got " << cache.GetEntryCount() << std::endl;
+    errors++;
+  }
+
+  unsigned long entryMemory=cache.GetUsedMemory()/cache.GetEntryCount();
+
+  if (entryMemory<1000) {
+    std::cerr << "Entry memory " << entryMemory << " does not include the value" << std::endl;
+    errors++;
+  }
+
+  // The memory limit replaces the entry limit
+  cache.SetMaxMemory(entryMemory*50);
+
+  for (size_t i=0; i<100; i++) {
+    Lookup(cache,i);
+  }
+
+  if (cache.GetEntryCount()!=50 ||
+      cache.GetUsedMemory()>cache.GetMaxMemory()) {
+    std::cerr << "Memory limit: Expected 50 entries within " << cache.GetMaxMemory() << " bytes, got " << cache.GetEntryCount() << " entries with " << cache.GetUsedMemory() << " bytes" << std::endl;
+    errors++;
+  }
+
+  cache.Flush();
+
+  if (cache.GetUsedMemory()!=0) {
+    std::cerr << "Flushed cache still uses " << cache.GetUsedMemory() << " bytes" << std::endl;
+    errors++;
+  }
+}
+
+static void CheckRebalance()
+{
+  const unsigned long     budget=1000000;
+  TestValueSizer          sizer;
+  TestCache               hotCache(1);
+  TestCache               scanCache(1);
+  osmscout::CacheManager  manager(budget);
+  size_t                  random=1;
+
+  hotCache.SetValueSizer(&sizer);
+  scanCache.SetValueSizer(&sizer);
+
+  manager.SetRebalanceInterval(100);
+  manager.Register("hot",hotCache);
+  manager.Register("scan",scanCache);
+
+  if (hotCache.GetMaxMemory()+scanCache.GetMaxMemory()!=budget ||
+      hotCache.GetMaxMemory()!=scanCache.GetMaxMemory()) {
+    std::cerr << "Initial split: " << hotCache.GetMaxMemory() << "/" << scanCache.GetMaxMemory() << std::endl;
+    errors++;
+  }
+
+  // The hot cache has a working set of ~800 entries (~1MB) with many hits, the scan
+  // cache never sees a key twice
+  for (size_t i=0; i<100000; i++) {
+    random=(random*1103515245+12345)%2147483648u;
+
+    Lookup(hotCache,random%800);
+    Lookup(scanCache,i);
+  }
+
+  std::vector<osmscout::CacheManager::CacheStatistics> statistics;
+
+  manager.GetStatistics(statistics);
+
+  if (statistics.size()!=2 ||
+      statistics[0].name!="hot" ||
+      statistics[1].name!="scan") {
+    std::cerr << "Statistics do not match the registered caches" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (statistics[0].maxMemory<=statistics[1].maxMemory) {
+    std::cerr << "Hot cache did not get more memory: " << statistics[0].maxMemory << "/" << statistics[1].maxMemory << std::endl;
+    errors++;
+  }
+
+  if (statistics[0].maxMemory+statistics[1].maxMemory>budget) {
+    std::cerr << "Budget exceeded: " << statistics[0].maxMemory+statistics[1].maxMemory << std::endl;
+    errors++;
+  }
+
+  if (statistics[0].GetHitRate()<=statistics[1].GetHitRate() ||
+      statistics[1].hits!=0) {
+    std::cerr << "Unexpected hit rates: " << statistics[0].GetHitRate() << "/" << statistics[1].GetHitRate() << std::endl;
+    errors++;
+  }
+
+  manager.SetMemoryBudget(budget/2);
+
+  if (hotCache.GetMaxMemory()+scanCache.GetMaxMemory()>budget/2) {
+    std::cerr << "Limits not reduced to new budget: " << hotCache.GetMaxMemory()+scanCache.GetMaxMemory() << std::endl;
+    errors++;
+  }
+
+  // The new limits are applied on the next access of each cache
+  Lookup(hotCache,0);
+  Lookup(scanCache,0);
+
+  if (hotCache.GetUsedMemory()+scanCache.GetUsedMemory()>budget/2) {
+    std::cerr << "Caches not reduced to new budget: " << hotCache.GetUsedMemory()+scanCache.GetUsedMemory() << std::endl;
+    errors++;
+  }
+
+  {
+    TestCache tempCache(1);
+
+    manager.Register("temp",tempCache);
+  }
+
+  manager.GetStatistics(statistics);
+
+  if (statistics.size()!=2) {
+    std::cerr << "Destroyed cache is still registered" << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  CheckMemoryLimit();
+  CheckRebalance();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,408 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/Area.h>
+#include <osmscout/ColumnDataFile.h>
+#include <osmscout/Node.h>
+#include <osmscout/TypeFeatures.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/util/File.h>
+
+int errors=0;
+
+static const size_t objectCount=2500; // More than two blocks
+
+struct TestTypes
+{
+  osmscout::TypeInfoRef poi;
+  osmscout::TypeInfoRef shop;
+  osmscout::TypeInfoRef road;
+  osmscout::TypeInfoRef building;
+};
+
+static osmscout::TypeInfoRef RegisterType(osmscout::TypeConfig& typeConfig,
+                                          const std::string& name)
+{
+  osmscout::TypeInfoRef type=std::make_shared<osmscout::TypeInfo>();
+
+  type->SetType(name);
+  type->CanBeNode(true);
+  type->CanBeWay(true);
+  type->CanBeArea(true);
+  type->AddFeature(typeConfig.GetFeature(osmscout::NameFeature::NAME));
+
+  return typeConfig.RegisterType(type);
+}
+
+static void SetName(osmscout::FeatureValueBuffer& buffer,
+                    size_t i)
+{
+  size_t idx;
+
+  // Only every third object has a name, so the masks differ
+  if (i%3==0 &&
+      buffer.GetType()->GetFeature(osmscout::NameFeature::NAME,idx)) {
+    osmscout::NameFeatureValue* value=static_cast<osmscout::NameFeatureValue*>(buffer.AllocateValue(idx));
+
+    value->SetName("Object "+std::to_string(i));
+  }
+}
+
+static osmscout::CompactGeoCoord GetCoord(size_t i,
+                                          size_t n)
+{
+  return osmscout::CompactGeoCoord(51.0+(i%100)*0.001+n*0.0001,
+                                   7.0+(i/100)*0.001-n*0.0001);
+}
+
+static osmscout::TypeInfoRef GetType(const TestTypes& types,
+                                     size_t i)
+{
+  return i%2==0 ? types.poi : types.shop;
+}
+
+static std::string GetName(const osmscout::FeatureValueBuffer& buffer)
+{
+  size_t idx;
+
+  if (!buffer.GetType()->GetFeature(osmscout::NameFeature::NAME,idx) ||
+      !buffer.HasValue(idx)) {
+    return "";
+  }
+
+  return static_cast<osmscout::NameFeatureValue*>(buffer.GetValue(idx))->GetName();
+}
+
+static void CreateObjects(const TestTypes& types,
+                          std::vector<osmscout::Node>& nodes,
+                          std::vector<osmscout::Way>& ways,
+                          std::vector<osmscout::Area>& areas)
+{
+  nodes.resize(objectCount);
+  ways.resize(objectCount);
+  areas.resize(objectCount);
+
+  for (size_t i=0; i<objectCount; i++) {
+    osmscout::FeatureValueBuffer buffer;
+
+    buffer.SetType(GetType(types,i));
+    SetName(buffer,i);
+
+    nodes[i].SetType(buffer.GetType());
+    nodes[i].SetFeatures(buffer);
+    nodes[i].SetCoords(osmscout::GeoCoord(GetCoord(i,0).GetLat(),
+                                        GetCoord(i,0).GetLon()));
+
+    ways[i].SetType(types.road);
+
+    osmscout::FeatureValueBuffer wayBuffer;
+
+    wayBuffer.SetType(types.road);
+    SetName(wayBuffer,i);
+
+    ways[i].SetFeatures(wayBuffer);
+
+    for (size_t n=0; n<2+i%5; n++) {
+      ways[i].nodes.push_back(GetCoord(i,n));
+      // Mix of ids and coordinates without id, ids going up and down
+      ways[i].ids.push_back(n%2==0 ? 1000000-i*10+n : 0);
+    }
+
+    // Every fourth area is a multipolygon with a master ring without nodes
+    size_t ringCount=i%4==0 ? 3 : 1;
+
+    areas[i].rings.resize(ringCount);
+
+    for (size_t r=0; r<ringCount; r++) {
+      osmscout::Area::Ring& ring=areas[i].rings[r];
+
+      ring.SetType(types.building);
+
+      if (r==0) {
+        SetName(ring.featureValueBuffer,i);
+      }
+
+      ring.ring=ringCount==1 ? (uint8_t)osmscout::Area::masterRingId : (uint8_t)r;
+
+      if (ringCount==1 || r>0) {
+        for (size_t n=0; n<4; n++) {
+          ring.nodes.push_back(GetCoord(i,n+r));
+          ring.ids.push_back(i*100+n+r);
+        }
+      }
+    }
+  }
+}
+
+static bool CheckParts(osmscout::ColumnDataFile& file,
+                       size_t block,
+                       size_t first,
+                       const std::vector<std::vector<osmscout::TypeInfoRef> >& expectedTypes,
+                       const std::vector<std::vector<const osmscout::FeatureValueBuffer*> >& expectedFeatures,
+                       const std::vector<std::vector<const std::vector<osmscout::CompactGeoCoord>*> >& expectedCoords,
+                       const std::vector<std::vector<const std::vector<osmscout::Id>*> >& expectedIds,
+                       const std::vector<std::vector<uint8_t> >& expectedRings)
+{
+  std::vector<osmscout::FileOffset>                    offsets;
+  std::vector<uint32_t>                                partCounts;
+  std::vector<uint8_t>                                 rings;
+  std::vector<osmscout::TypeInfoRef>                   types;
+  std::vector<osmscout::FeatureValueBuffer>            features;
+  std::vector<std::vector<osmscout::CompactGeoCoord> > coords;
+  std::vector<std::vector<osmscout::Id> >              ids;
+
+  if (!file.ReadOffsets(block,offsets) ||
+      !file.ReadParts(block,partCounts,rings) ||
+      !file.ReadTypes(block,types) ||
+      !file.ReadFeatures(block,types,features) ||
+      !file.ReadCoords(block,coords) ||
+      !file.ReadIds(block,ids)) {
+    std::cerr << file.GetFilename() << ": Cannot read block " << block << std::endl;
+    return false;
+  }
+
+  size_t part=0;
+
+  for (size_t o=0; o<offsets.size(); o++) {
+    size_t i=first+o;
+
+    if (offsets[o]!=i*37) {
+      std::cerr << file.GetFilename() << ": Object " << i << ": Expected offset " << i*37 << ", got " << offsets[o] << std::endl;
+      return false;
+    }
+
+    if (partCounts[o]!=expectedTypes[i].size()) {
+      std::cerr << file.GetFilename() << ": Object " << i << ": Expected " << expectedTypes[i].size() << " parts, got " << partCounts[o] << std::endl;
+      return false;
+    }
+
+    for (size_t p=0; p<partCounts[o]; p++, part++) {
+      if (types[part]!=expectedTypes[i][p] ||
+          rings[part]!=expectedRings[i][p]) {
+        std::cerr << file.GetFilename() << ": Object " << i << ", part " << p << ": Type or ring differs" << std::endl;
+        return false;
+      }
+
+      if (GetName(features[part])!=GetName(*expectedFeatures[i][p])) {
+        std::cerr << file.GetFilename() << ": Object " << i << ", part " << p << ": Expected name '" << GetName(*expectedFeatures[i][p]) << "', got '" << GetName(features[part]) << "'" << std::endl;
+        return false;
+      }
+
+      const std::vector<osmscout::CompactGeoCoord>& expectedCoord=*expectedCoords[i][p];
+
+      if (coords[part].size()!=expectedCoord.size()) {
+        std::cerr << file.GetFilename() << ": Object " << i << ", part " << p << ": Expected " << expectedCoord.size() << " coordinates, got " << coords[part].size() << std::endl;
+        return false;
+      }
+
+      for (size_t n=0; n<expectedCoord.size(); n++) {
+        if (!coords[part][n].IsEqual(expectedCoord[n])) {
+          std::cerr << file.GetFilename() << ": Object " << i << ", part " << p << ": Coordinate " << n << " differs" << std::endl;
+          return false;
+        }
+      }
+
+      if (ids[part]!=*expectedIds[i][p]) {
+        std::cerr << file.GetFilename() << ": Object " << i << ", part " << p << ": Ids differ" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template<class T>
+static void CheckFile(const osmscout::TypeConfigRef& typeConfig,
+                      const std::string& filename,
+                      osmscout::RefType objectType,
+                      const std::vector<T>& objects,
+                      const std::vector<std::vector<osmscout::TypeInfoRef> >& expectedTypes,
+                      const std::vector<std::vector<const osmscout::FeatureValueBuffer*> >& expectedFeatures,
+                      const std::vector<std::vector<const std::vector<osmscout::CompactGeoCoord>*> >& expectedCoords,
+                      const std::vector<std::vector<const std::vector<osmscout::Id>*> >& expectedIds,
+                      const std::vector<std::vector<uint8_t> >& expectedRings)
+{
+  osmscout::ColumnDataWriter writer;
+  osmscout::ColumnDataFile   file;
+
+  if (!writer.Open(filename,objectType)) {
+    std::cerr << "Cannot create '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<objects.size(); i++) {
+    writer.Add(i*37,objects[i]);
+  }
+
+  if (!writer.Close()) {
+    std::cerr << "Cannot write '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (!file.Open(typeConfig,".",filename,false)) {
+    std::cerr << "Cannot open '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (file.GetObjectType()!=objectType ||
+      file.GetObjectCount()!=objects.size()) {
+    std::cerr << filename << ": Header does not match" << std::endl;
+    errors++;
+  }
+
+  size_t first=0;
+
+  for (size_t b=0; b<file.GetBlockCount(); b++) {
+    if (!CheckParts(file,b,first,expectedTypes,expectedFeatures,expectedCoords,expectedIds,expectedRings)) {
+      errors++;
+    }
+
+    first+=file.GetBlock(b).objectCount;
+  }
+
+  if (first!=objects.size()) {
+    std::cerr << filename << ": Expected " << objects.size() << " objects in blocks, got " << first << std::endl;
+    errors++;
+  }
+
+  std::vector<std::vector<osmscout::Id> > ids;
+
+  if (file.ReadIds(file.GetBlockCount(),ids)) {
+    std::cerr << filename << ": Invalid block accepted" << std::endl;
+    errors++;
+  }
+
+  file.Close();
+}
+
+static void CheckOffsets(const osmscout::TypeConfigRef& typeConfig,
+                         const std::string& filename,
+                         const TestTypes& types,
+                         const std::vector<osmscout::Node>& nodes)
+{
+  osmscout::ColumnDataFile  file;
+  osmscout::TypeSet         typeSet(*typeConfig);
+  osmscout::GeoBox          boundingBox(osmscout::GeoCoord(51.01,7.005),
+                                        osmscout::GeoCoord(51.03,7.012));
+  std::vector<osmscout::FileOffset> offsets;
+  std::vector<osmscout::FileOffset> expected;
+
+  typeSet.SetType(types.shop->GetNodeId());
+
+  for (size_t i=0; i<nodes.size(); i++) {
+    osmscout::CompactGeoCoord coord(nodes[i].GetCoords());
+
+    if (nodes[i].GetType()==types.shop &&
+        coord.GetFixedLat()>=osmscout::ColumnDataFile::GetFixedLat(boundingBox.GetMinLat()) &&
+        coord.GetFixedLat()<=osmscout::ColumnDataFile::GetFixedLat(boundingBox.GetMaxLat()) &&
+        coord.GetFixedLon()>=osmscout::ColumnDataFile::GetFixedLon(boundingBox.GetMinLon()) &&
+        coord.GetFixedLon()<=osmscout::ColumnDataFile::GetFixedLon(boundingBox.GetMaxLon())) {
+      expected.push_back(i*37);
+    }
+  }
+
+  if (!file.Open(typeConfig,".",filename,false) ||
+      !file.GetOffsets(boundingBox,typeSet,offsets)) {
+    std::cerr << "Cannot scan '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (expected.empty() ||
+      offsets!=expected) {
+    std::cerr << filename << ": Expected " << expected.size() << " objects of type in bounding box, got " << offsets.size() << std::endl;
+    errors++;
+  }
+
+  file.Close();
+}
+
+int main()
+{
+  osmscout::TypeConfigRef       typeConfig=std::make_shared<osmscout::TypeConfig>();
+  TestTypes                     types;
+  std::vector<osmscout::Node>   nodes;
+  std::vector<osmscout::Way>    ways;
+  std::vector<osmscout::Area>   areas;
+
+  types.poi=RegisterType(*typeConfig,"poi");
+  types.shop=RegisterType(*typeConfig,"shop");
+  types.road=RegisterType(*typeConfig,"road");
+  types.building=RegisterType(*typeConfig,"building");
+
+  CreateObjects(types,nodes,ways,areas);
+
+  std::vector<std::vector<osmscout::TypeInfoRef> >                           expectedTypes(objectCount);
+  std::vector<std::vector<const osmscout::FeatureValueBuffer*> >             expectedFeatures(objectCount);
+  std::vector<std::vector<const std::vector<osmscout::CompactGeoCoord>*> >   expectedCoords(objectCount);
+  std::vector<std::vector<const std::vector<osmscout::Id>*> >                expectedIds(objectCount);
+  std::vector<std::vector<uint8_t> >                                         expectedRings(objectCount);
+  std::vector<std::vector<osmscout::CompactGeoCoord> >                       nodeCoords(objectCount);
+  std::vector<osmscout::Id>                                                  noIds;
+
+  // Nodes
+
+  for (size_t i=0; i<objectCount; i++) {
+    nodeCoords[i].push_back(osmscout::CompactGeoCoord(nodes[i].GetCoords()));
+
+    expectedTypes[i].assign(1,nodes[i].GetType());
+    expectedFeatures[i].assign(1,&nodes[i].GetFeatureValueBuffer());
+    expectedCoords[i].assign(1,&nodeCoords[i]);
+    expectedIds[i].assign(1,&noIds);
+    expectedRings[i].assign(1,0);
+  }
+
+  CheckFile(typeConfig,"test_nodes.col",osmscout::refNode,nodes,
+            expectedTypes,expectedFeatures,expectedCoords,expectedIds,expectedRings);
+  CheckOffsets(typeConfig,"test_nodes.col",types,nodes);
+
+  // Ways
+
+  for (size_t i=0; i<objectCount; i++) {
+    expectedTypes[i].assign(1,ways[i].GetType());
+    expectedFeatures[i].assign(1,&ways[i].GetFeatureValueBuffer());
+    expectedCoords[i].assign(1,&ways[i].nodes);
+    expectedIds[i].assign(1,&ways[i].ids);
+  }
+
+  CheckFile(typeConfig,"test_ways.col",osmscout::refWay,ways,
+            expectedTypes,expectedFeatures,expectedCoords,expectedIds,expectedRings);
+
+  // Areas
+
+  for (size_t i=0; i<objectCount; i++) {
+    expectedTypes[i].clear();
+    expectedFeatures[i].clear();
+    expectedCoords[i].clear();
+    expectedIds[i].clear();
+    expectedRings[i].clear();
+
+    for (const auto& ring : areas[i].rings) {
+      expectedTypes[i].push_back(ring.GetType());
+      expectedFeatures[i].push_back(&ring.GetFeatureValueBuffer());
+      expectedCoords[i].push_back(&ring.nodes);
+      expectedIds[i].push_back(&ring.ids);
+      expectedRings[i].push_back(ring.ring);
+    }
+  }
+
+  CheckFile(typeConfig,"test_areas.col",osmscout::refArea,areas,
+            expectedTypes,expectedFeatures,expectedCoords,expectedIds,expectedRings);
+
+  osmscout::RemoveFile("test_nodes.col");
+  osmscout::RemoveFile("test_ways.col");
+  osmscout::RemoveFile("test_areas.col");
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
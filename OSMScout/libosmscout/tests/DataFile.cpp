@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/DataFile.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+int errors=0;
+
+static const size_t objectCount=20000; // File larger than the maximum range size
+
+/**
+ * Object of variable size, every 50th object is larger than the tail read
+ * after the last object of a range
+ */
+class TestData : public osmscout::Referencable
+{
+public:
+  uint32_t    index;
+  std::string payload;
+
+public:
+  static std::string GetPayload(size_t i)
+  {
+    if (i%50==0) {
+      return std::string(6000,(char)('a'+i%26));
+    }
+
+    return std::string(10+(i*7)%90,(char)('A'+i%26));
+  }
+
+  bool Read(const osmscout::TypeConfig& /*typeConfig*/,
+            osmscout::FileScanner& scanner)
+  {
+    scanner.ReadNumber(index);
+    scanner.Read(payload);
+
+    return !scanner.HasError();
+  }
+
+  bool Write(osmscout::FileWriter& writer) const
+  {
+    writer.WriteNumber(index);
+    writer.Write(payload);
+
+    return !writer.HasError();
+  }
+};
+
+typedef osmscout::DataFile<TestData> TestDataFile;
+
+static bool WriteFile(const std::string& filename,
+                      std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::FileWriter writer;
+
+  if (!writer.Open(filename)) {
+    std::cerr << "Cannot create '" << filename << "'" << std::endl;
+    return false;
+  }
+
+  offsets.resize(objectCount);
+
+  for (size_t i=0; i<objectCount; i++) {
+    TestData data;
+
+    data.index=(uint32_t)i;
+    data.payload=TestData::GetPayload(i);
+
+    writer.GetPos(offsets[i]);
+    data.Write(writer);
+  }
+
+  return writer.Close();
+}
+
+static void CheckData(const std::string& test,
+                      const std::vector<osmscout::FileOffset>& offsets,
+                      const std::vector<size_t>& indexes,
+                      const std::vector<TestDataFile::ValueType>& data,
+                      const std::vector<TestDataFile::ValueType>& reference)
+{
+  if (data.size()!=indexes.size()) {
+    std::cerr << test << ": Expected " << indexes.size() << " objects, got " << data.size() << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<indexes.size(); i++) {
+    const TestDataFile::ValueType& expected=reference[indexes[i]];
+
+    if (!data[i] ||
+        data[i]->index!=expected->index ||
+        data[i]->payload!=expected->payload) {
+      std::cerr << test << ": Object " << i << " at offset " << offsets[indexes[i]] << " does not match object " << expected->index << std::endl;
+      errors++;
+      return;
+    }
+  }
+}
+
+static void CheckBatch(const std::string& test,
+                       const TestDataFile& dataFile,
+                       const std::vector<osmscout::FileOffset>& offsets,
+                       const std::vector<size_t>& indexes,
+                       const std::vector<TestDataFile::ValueType>& reference)
+{
+  std::vector<osmscout::FileOffset>    batch;
+  std::vector<TestDataFile::ValueType> data;
+
+  for (size_t index : indexes) {
+    batch.push_back(offsets[index]);
+  }
+
+  if (!dataFile.GetByOffset(batch,data)) {
+    std::cerr << test << ": Cannot read objects" << std::endl;
+    errors++;
+    return;
+  }
+
+  CheckData(test,offsets,indexes,data,reference);
+}
+
+int main()
+{
+  std::string                          filename="test.dat";
+  osmscout::TypeConfigRef              typeConfig=std::make_shared<osmscout::TypeConfig>();
+  std::vector<osmscout::FileOffset>    offsets;
+  std::vector<TestDataFile::ValueType> reference;
+  TestDataFile                         singleFile(filename,0);
+  osmscout::FileScanner                scanner;
+
+  if (!WriteFile(filename,offsets)) {
+    return 1;
+  }
+
+  if (scanner.Open(filename,osmscout::FileScanner::LowMemRandom,false)) {
+    if (!scanner.CanReadAt()) {
+      std::cout << "Positional reads are not supported, batched reads are not tested" << std::endl;
+    }
+
+    scanner.Close();
+  }
+
+  // Reference: One object at a time, never batched
+
+  if (!singleFile.Open(typeConfig,".",osmscout::FileScanner::LowMemRandom,false)) {
+    std::cerr << "Cannot open '" << filename << "'" << std::endl;
+    return 1;
+  }
+
+  reference.resize(objectCount);
+
+  for (size_t i=0; i<objectCount; i++) {
+    if (!singleFile.GetByOffset(offsets[i],reference[i]) ||
+        reference[i]->index!=i ||
+        reference[i]->payload!=TestData::GetPayload(i)) {
+      std::cerr << "Single read of object " << i << " failed" << std::endl;
+      errors++;
+    }
+  }
+
+  singleFile.Close();
+
+  for (size_t cacheSize=0; cacheSize<=1000; cacheSize+=1000) {
+    TestDataFile        dataFile(filename,cacheSize);
+    std::vector<size_t> indexes;
+    std::string         suffix=cacheSize>0 ? " (cached)" : "";
+
+    if (!dataFile.Open(typeConfig,".",osmscout::FileScanner::LowMemRandom,false)) {
+      std::cerr << "Cannot open '" << filename << "'" << std::endl;
+      errors++;
+      continue;
+    }
+
+    // Objects with ranges split at the size limit, reversed with duplicates
+
+    indexes.clear();
+    for (size_t i=0; i<objectCount; i++) {
+      indexes.push_back(objectCount-1-i);
+
+      if (i%10==0) {
+        indexes.push_back(i);
+      }
+    }
+
+    CheckBatch("All"+suffix,dataFile,offsets,indexes,reference);
+
+    // Gaps around the maximum gap, large objects at the end of ranges
+
+    for (size_t stride=20; stride<=200; stride+=30) {
+      indexes.clear();
+      for (size_t i=0; i<objectCount; i+=stride) {
+        indexes.push_back((i*7919)%objectCount);
+      }
+
+      CheckBatch("Stride "+std::to_string(stride)+suffix,dataFile,offsets,indexes,reference);
+    }
+
+    // Range ending at end of file
+
+    indexes.clear();
+    indexes.push_back(objectCount-1);
+    indexes.push_back(objectCount-3);
+    indexes.push_back(objectCount-2);
+    indexes.push_back(objectCount-3);
+
+    CheckBatch("End of file"+suffix,dataFile,offsets,indexes,reference);
+
+    // Objects partly in the cache of the previous reads
+
+    indexes.clear();
+    for (size_t i=0; i<objectCount; i+=3) {
+      indexes.push_back(i);
+    }
+
+    CheckBatch("Mixed"+suffix,dataFile,offsets,indexes,reference);
+
+    dataFile.Close();
+  }
+
+  osmscout::RemoveFile(filename);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
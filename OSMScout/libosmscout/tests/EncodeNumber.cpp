@@ -1,4 +1,5 @@
 #include <iostream>
+#include <vector>
 
 #include <osmscout/util/Number.h>
 
@@ -49,6 +50,85 @@ bool CheckDecode(const char* buffer, unsigned long expected, size_t bytesExpecte
   return true;
 }
 
+/**
+ * Encodes the values one after another and checks that DecodeNumbers()
+ * returns the same values as DecodeNumber() called for each number
+ */
+template<typename N>
+bool CheckDecodeNumbers(const std::vector<N>& values)
+{
+  std::vector<char> buffer;
+
+  for (const auto value : values) {
+    char         data[10];
+    unsigned int bytes=osmscout::EncodeNumber(value,data);
+
+    buffer.insert(buffer.end(),data,data+bytes);
+  }
+
+  std::vector<N> decoded(values.size());
+  size_t         pos=0;
+
+  if (!osmscout::DecodeNumbers(buffer.data(),buffer.size(),pos,decoded.data(),decoded.size())) {
+    std::cerr << "Bulk decoding of " << values.size() << " numbers failed" << std::endl;
+    return false;
+  }
+
+  if (pos!=buffer.size()) {
+    std::cerr << "Bulk decoding: expected " << buffer.size() << " bytes read, actual " << pos << std::endl;
+    return false;
+  }
+
+  pos=0;
+
+  for (size_t i=0; i<values.size(); i++) {
+    N value;
+
+    pos+=osmscout::DecodeNumber(buffer.data()+pos,value);
+
+    if (decoded[i]!=value || value!=values[i]) {
+      std::cerr << "Error in bulk decoding of number " << i << ": expected " << values[i] << " actual " << decoded[i] << std::endl;
+      return false;
+    }
+  }
+
+  // A buffer missing the last byte must fail
+  if (!buffer.empty()) {
+    pos=0;
+
+    if (osmscout::DecodeNumbers(buffer.data(),buffer.size()-1,pos,decoded.data(),decoded.size())) {
+      std::cerr << "Bulk decoding of truncated buffer did not fail" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename N>
+bool CheckDecodeNumbers(int bits)
+{
+  std::vector<N> values;
+  uint64_t       random=1;
+
+  // Runs of small numbers followed by numbers of mixed length
+  for (size_t i=0; i<100; i++) {
+    values.push_back((N)(i%128));
+  }
+
+  for (size_t i=0; i<1000; i++) {
+    random=random*6364136223846793005ULL+1442695040888963407ULL;
+
+    int length=(int)((random >> 33)%bits)+1;
+
+    values.push_back((N)((random >> 7) & ((((uint64_t)1) << (length-1))*2-1)));
+  }
+
+  values.push_back(std::numeric_limits<N>::max());
+
+  return CheckDecodeNumbers(values);
+}
+
 int main()
 {
   if (!CheckEncode(0,"\0",1)) {
@@ -115,6 +195,18 @@ int main()
     errors++;
   }
 
+  if (!CheckDecodeNumbers<uint32_t>(32)) {
+    errors++;
+  }
+
+  if (!CheckDecodeNumbers<uint64_t>(64)) {
+    errors++;
+  }
+
+  if (!CheckDecodeNumbers(std::vector<uint32_t>())) {
+    errors++;
+  }
+
   if (errors!=0) {
     return 1;
   }
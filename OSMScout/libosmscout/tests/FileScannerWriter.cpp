@@ -1,5 +1,6 @@
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/FileWriter.h>
@@ -43,6 +44,15 @@ int main()
 
   osmscout::FileOffset  info;
 
+  std::vector<osmscout::CompactGeoCoord> outCoords;
+  std::vector<osmscout::CompactGeoCoord> inCoords;
+  std::vector<osmscout::GeoCoord>        inGeoCoords;
+
+  outCoords.push_back(osmscout::CompactGeoCoord(51.5761,7.46474));
+  outCoords.push_back(osmscout::CompactGeoCoord(-33.8568,151.2153));
+  outCoords.push_back(osmscout::CompactGeoCoord(-90.0,-180.0));
+  outCoords.push_back(osmscout::CompactGeoCoord(90.0,180.0));
+
   if (writer.Open("test.dat")) {
     writer.Write(outBool1);
     writer.Write(outBool2);
@@ -77,6 +87,9 @@ int main()
     writer.WriteFileOffset(outfo2);
     writer.WriteFileOffset(outfo3);
 
+    writer.Write(outCoords);
+    writer.Write(outCoords);
+
     writer.Close();
 
     if (scanner.Open("test.dat",osmscout::FileScanner::Normal,false)) {
@@ -228,6 +241,30 @@ int main()
         std::cerr << "Read/WriteFileOffset(FileOffset): Expected " << outfo3 << ", got " << info << std::endl;
         errors++;
       }
+
+      // Read/Write(std::vector<CompactGeoCoord>)
+
+      scanner.Read(inCoords);
+      if (inCoords!=outCoords) {
+        std::cerr << "Read/Write(std::vector<CompactGeoCoord>): Coordinates do not match" << std::endl;
+        errors++;
+      }
+
+      // The same data read as GeoCoord must result in the same coordinates
+
+      scanner.Read(inGeoCoords);
+      if (inGeoCoords.size()!=outCoords.size()) {
+        std::cerr << "Read/Write(std::vector<GeoCoord>): Expected " << outCoords.size() << " coordinates, got " << inGeoCoords.size() << std::endl;
+        errors++;
+      }
+      else {
+        for (size_t i=0; i<inGeoCoords.size(); i++) {
+          if (osmscout::CompactGeoCoord(inGeoCoords[i])!=outCoords[i]) {
+            std::cerr << "Read/Write(std::vector<GeoCoord>): Expected " << outCoords[i].GetDisplayText() << ", got " << inGeoCoords[i].GetDisplayText() << std::endl;
+            errors++;
+          }
+        }
+      }
     }
     else {
       std::cerr << "Cannot open file for reading" << std::endl;
@@ -0,0 +1,122 @@
+#include <iostream>
+
+#include <osmscout/LocationTokenIndex.h>
+
+#include <osmscout/util/String.h>
+
+bool CheckTokens(const std::string& name,
+                 const std::list<std::string>& expected)
+{
+  std::list<std::string> tokens;
+
+  osmscout::LocationTokenIndex::GetTokens(name,
+                                          tokens);
+
+  std::cout << "Expect '" << name << "' to split into '" << osmscout::StringListToString(expected,"|") << "'" << std::endl;
+
+  if (tokens==expected) {
+    std::cout << "OK" << std::endl;
+    return true;
+  }
+  else {
+    std::cerr << "FAIL: Was split into '" << osmscout::StringListToString(tokens,"|") << "'" << std::endl;
+    return false;
+  }
+}
+
+bool CheckIndexTerms(const std::string& name,
+                     const std::string& pattern,
+                     bool expected)
+{
+  std::set<std::string> terms;
+  bool                  found=false;
+
+  osmscout::LocationTokenIndex::GetIndexTerms(name,
+                                              terms);
+
+  std::string normalizedPattern(pattern);
+
+  osmscout::LocationTokenIndex::NormalizeName(normalizedPattern);
+
+  for (const auto& term : terms) {
+    if (term.compare(0,normalizedPattern.length(),normalizedPattern)==0) {
+      found=true;
+      break;
+    }
+  }
+
+  std::cout << "Expect '" << pattern << "' to be " << (expected ? "" : "not ") << "found in '" << name << "'" << std::endl;
+
+  if (found==expected) {
+    std::cout << "OK" << std::endl;
+    return true;
+  }
+  else {
+    std::cerr << "FAIL" << std::endl;
+    return false;
+  }
+}
+
+int main()
+{
+  int errors=0;
+
+  // Empty name
+  if (!CheckTokens("",
+                   {})) {
+    errors++;
+  }
+
+  // Only separators
+  if (!CheckTokens(" - ",
+                   {})) {
+    errors++;
+  }
+
+  // Lower case conversion and ASCII separators
+  if (!CheckTokens("Rue de l'Église-Saint-Pierre",
+                   {"rue","de","l","église","saint","pierre"})) {
+    errors++;
+  }
+
+  // Latin-1 supplement upper case characters, "ß" stays unchanged
+  if (!CheckTokens("GROßE ÄUßERE STRAßE 12a",
+                   {"große","äußere","straße","12a"})) {
+    errors++;
+  }
+
+  // Substring of a token
+  if (!CheckIndexTerms("Hauptstraße 12",
+                       "STRAß",
+                       true)) {
+    errors++;
+  }
+
+  // Substring at the end of a token
+  if (!CheckIndexTerms("Hauptstraße 12",
+                       "aße",
+                       true)) {
+    errors++;
+  }
+
+  // Substring spanning two tokens
+  if (!CheckIndexTerms("Hauptstraße 12",
+                       "ße 1",
+                       false)) {
+    errors++;
+  }
+
+  // Tokens shorter than the minimum length are not indexed
+  if (!CheckIndexTerms("Am Markt",
+                       "am",
+                       false)) {
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
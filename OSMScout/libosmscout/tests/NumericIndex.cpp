@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/NumericIndex.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+int errors=0;
+
+static const std::string          filename="test.idx";
+static const uint32_t             pageSize=64;         // Small pages for a deep tree
+static const osmscout::FileOffset dataFileSize=1 << 20;
+
+template <class N>
+static bool WriteIndex(const std::vector<N>& ids,
+                       std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::NumericIndexWriter writer;
+
+  offsets.resize(ids.size());
+
+  if (!writer.Open(filename,
+                   pageSize,
+                   (uint32_t)ids.size(),
+                   (uint64_t)ids.front(),
+                   (uint64_t)ids.back(),
+                   dataFileSize)) {
+    std::cerr << "Cannot create '" << filename << "'" << std::endl;
+    return false;
+  }
+
+  for (size_t i=0; i<ids.size(); i++) {
+    offsets[i]=(osmscout::FileOffset)((i*37+5)%dataFileSize);
+
+    if (!writer.Add((uint64_t)ids[i],
+                    offsets[i])) {
+      std::cerr << "Cannot add id " << ids[i] << std::endl;
+      return false;
+    }
+  }
+
+  // Adding an id out of order fails
+  if (writer.Add((uint64_t)ids.back(),0)) {
+    std::cerr << "Id added twice" << std::endl;
+    errors++;
+  }
+
+  return writer.Close();
+}
+
+/**
+ * Checks that the file header is larger than one page and the tree has
+ * several levels
+ */
+static void CheckHeader(const std::string& test,
+                        size_t minLevels)
+{
+  osmscout::FileScanner scanner;
+  uint32_t              filePageSize;
+  uint32_t              entryCount;
+  uint64_t              minId;
+  uint8_t               idBytes;
+  uint8_t               offsetBytes;
+  uint32_t              levelCount;
+  osmscout::FileOffset  levelStart=0;
+  uint32_t              levelEntries;
+
+  if (!scanner.Open(filename,osmscout::FileScanner::Sequential,false)) {
+    std::cerr << test << ": Cannot open '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  scanner.Read(filePageSize);
+  scanner.Read(entryCount);
+  scanner.Read(minId);
+  scanner.Read(idBytes);
+  scanner.Read(offsetBytes);
+  scanner.Read(levelCount);
+
+  for (size_t i=0; i<levelCount; i++) {
+    scanner.ReadFileOffset(levelStart);
+    scanner.Read(levelEntries);
+  }
+
+  // The last level is the leaf level, directly after the header
+  if (scanner.HasError() ||
+      levelCount<minLevels ||
+      levelStart<2*pageSize ||
+      levelStart%pageSize!=0) {
+    std::cerr << test << ": Expected at least " << minLevels << " levels and a header of several pages, got " << levelCount << " levels, leaf level at " << levelStart << std::endl;
+    errors++;
+  }
+
+  scanner.Close();
+}
+
+template <class N>
+static void CheckIndex(const std::string& test,
+                       const std::vector<N>& ids,
+                       const std::vector<osmscout::FileOffset>& offsets,
+                       const std::vector<N>& missingIds,
+                       bool memoryMapped,
+                       unsigned long cacheSize)
+{
+  osmscout::NumericIndex<N> index(filename,cacheSize);
+
+  if (!index.Open(".",
+                  osmscout::FileScanner::LowMemRandom,
+                  memoryMapped)) {
+    std::cerr << test << ": Cannot open index" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<ids.size(); i++) {
+    osmscout::FileOffset offset;
+
+    if (!index.GetOffset(ids[i],offset) ||
+        offset!=offsets[i]) {
+      std::cerr << test << ": Id " << ids[i] << " not found or wrong offset" << std::endl;
+      errors++;
+      return;
+    }
+  }
+
+  for (const auto& id : missingIds) {
+    osmscout::FileOffset offset;
+
+    if (index.GetOffset(id,offset)) {
+      std::cerr << test << ": Missing id " << id << " found" << std::endl;
+      errors++;
+    }
+  }
+
+  // Batch lookup, existing ids in reverse order mixed with missing ids
+  std::vector<N>                    batchIds;
+  std::vector<osmscout::FileOffset> batchOffsets;
+
+  for (size_t i=ids.size(); i>0; i--) {
+    batchIds.push_back(ids[i-1]);
+
+    if (i%100==0) {
+      batchIds.push_back(missingIds[i%missingIds.size()]);
+    }
+  }
+
+  if (!index.GetOffsets(batchIds,batchOffsets) ||
+      batchOffsets.size()!=ids.size()) {
+    std::cerr << test << ": Batch lookup returned " << batchOffsets.size() << " instead of " << ids.size() << " offsets" << std::endl;
+    errors++;
+  }
+  else {
+    for (size_t i=0; i<ids.size(); i++) {
+      if (batchOffsets[i]!=offsets[ids.size()-1-i]) {
+        std::cerr << test << ": Batch lookup returned wrong offset for id " << ids[ids.size()-1-i] << std::endl;
+        errors++;
+        break;
+      }
+    }
+  }
+
+  index.Close();
+}
+
+static bool ReadIndexFile(std::vector<char>& content)
+{
+  osmscout::FileScanner scanner;
+
+  if (!scanner.Open(filename,osmscout::FileScanner::Sequential,false)) {
+    return false;
+  }
+
+  content.resize((size_t)scanner.GetSize());
+
+  return scanner.Read(content.data(),content.size()) &&
+         scanner.Close();
+}
+
+static bool WriteIndexFile(const std::vector<char>& content,
+                           size_t size)
+{
+  osmscout::FileWriter writer;
+
+  // Truncates the existing file, so opened indexes see the new size
+  return writer.Open(filename) &&
+         writer.Write(content.data(),size) &&
+         writer.Close();
+}
+
+/**
+ * A truncated file is rejected on open. If the file gets truncated while the
+ * index is open, lookups fail and no page beyond the new end of the file gets
+ * cached (pages cached before stay valid).
+ */
+template <class N>
+static void CheckTruncated(const std::string& test,
+                           const std::vector<N>& ids)
+{
+  std::vector<char> content;
+  size_t            truncatedSize;
+
+  if (!ReadIndexFile(content)) {
+    std::cerr << test << ": Cannot read '" << filename << "'" << std::endl;
+    errors++;
+    return;
+  }
+
+  truncatedSize=content.size()/2/pageSize*pageSize;
+
+  for (size_t mmap=0; mmap<2; mmap++) {
+    osmscout::NumericIndex<N> index(filename,1000);
+
+    WriteIndexFile(content,truncatedSize);
+
+    if (index.Open(".",osmscout::FileScanner::LowMemRandom,mmap!=0)) {
+      std::cerr << test << ": Truncated index file opened" << std::endl;
+      errors++;
+    }
+  }
+
+  WriteIndexFile(content,content.size());
+
+  osmscout::NumericIndex<N> index(filename,1000);
+  osmscout::FileOffset      offset;
+  osmscout::CacheSnapshot   before;
+  osmscout::CacheSnapshot   after;
+
+  if (!index.Open(".",osmscout::FileScanner::LowMemRandom,false)) {
+    std::cerr << test << ": Cannot open index" << std::endl;
+    errors++;
+    return;
+  }
+
+  // Caches the path to the first id
+  if (!index.GetOffset(ids.front(),offset)) {
+    std::cerr << test << ": Id " << ids.front() << " not found" << std::endl;
+    errors++;
+  }
+
+  index.GetCacheSnapshot(before);
+
+  WriteIndexFile(content,truncatedSize);
+
+  for (size_t i=0; i<2; i++) {
+    if (index.GetOffset(ids.back(),offset)) {
+      std::cerr << test << ": Id " << ids.back() << " found in truncated file" << std::endl;
+      errors++;
+    }
+  }
+
+  index.GetCacheSnapshot(after);
+
+  const osmscout::CacheSnapshot::Section* beforeSection=before.GetSection(filename,0);
+  const osmscout::CacheSnapshot::Section* afterSection=after.GetSection(filename,0);
+
+  if (beforeSection==NULL ||
+      afterSection==NULL) {
+    std::cerr << test << ": No pages cached" << std::endl;
+    errors++;
+  }
+  else {
+    for (const auto key : afterSection->keys) {
+      if (key+pageSize>truncatedSize &&
+          std::find(beforeSection->keys.begin(),
+                    beforeSection->keys.end(),
+                    key)==beforeSection->keys.end()) {
+        std::cerr << test << ": Page at offset " << key << " beyond end of file is cached" << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  index.Close();
+}
+
+template <class N>
+static void CheckIds(const std::string& test,
+                     const std::vector<N>& ids,
+                     const std::vector<N>& missingIds,
+                     size_t minLevels)
+{
+  std::vector<osmscout::FileOffset> offsets;
+
+  if (!WriteIndex(ids,offsets)) {
+    errors++;
+    return;
+  }
+
+  CheckHeader(test,minLevels);
+
+  CheckIndex(test+" (mmap)",ids,offsets,missingIds,true,0);
+  CheckIndex(test+" (cached)",ids,offsets,missingIds,false,1000);
+  CheckIndex(test+" (uncached)",ids,offsets,missingIds,false,0);
+
+  CheckTruncated(test,ids);
+
+  osmscout::RemoveFile(filename);
+}
+
+int main()
+{
+  // Consecutive ids
+  {
+    std::vector<osmscout::Id> ids;
+    std::vector<osmscout::Id> missingIds;
+
+    for (osmscout::Id id=1000; id<51000; id++) {
+      ids.push_back(id);
+    }
+
+    missingIds.push_back(0);
+    missingIds.push_back(999);
+    missingIds.push_back(51000);
+    missingIds.push_back(100000);
+
+    CheckIds("Consecutive",ids,missingIds,4);
+  }
+
+  // Sparse ids with gaps, more bytes per id
+  {
+    std::vector<osmscout::Id> ids;
+    std::vector<osmscout::Id> missingIds;
+
+    for (osmscout::Id id=1; id<20000; id++) {
+      ids.push_back(id*7919);
+
+      if (id%50==0) {
+        missingIds.push_back(id*7919+1);
+        missingIds.push_back(id*7919-1);
+      }
+    }
+
+    missingIds.push_back(0);
+    missingIds.push_back(7918);
+    missingIds.push_back(20000*7919);
+
+    CheckIds("Sparse",ids,missingIds,4);
+  }
+
+  // Negative and positive OSM ids
+  {
+    std::vector<osmscout::OSMId> ids;
+    std::vector<osmscout::OSMId> missingIds;
+
+    for (osmscout::OSMId id=-10000; id<10000; id++) {
+      if (id%3!=0) {
+        ids.push_back(id*3);
+      }
+      else {
+        missingIds.push_back(id*3);
+      }
+    }
+
+    missingIds.push_back(-30001);
+    missingIds.push_back(30000);
+
+    CheckIds("Negative",ids,missingIds,4);
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+
+#include <osmscout/util/PostingList.h>
+
+int errors=0;
+
+void CheckRoundtrip(const std::vector<osmscout::FileOffset>& offsets)
+{
+  std::vector<char>                 buffer;
+  std::vector<osmscout::FileOffset> decoded;
+  size_t                            pos=0;
+
+  osmscout::EncodePostingList(offsets,
+                              buffer);
+
+  if (!osmscout::DecodePostingList(buffer.data(),
+                                   buffer.size(),
+                                   pos,
+                                   decoded)) {
+    std::cerr << "Cannot decode posting list of " << offsets.size() << " offsets!" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (pos!=buffer.size()) {
+    std::cerr << "Decoded " << pos << " bytes, expected " << buffer.size() << "!" << std::endl;
+    errors++;
+  }
+
+  if (decoded!=offsets) {
+    std::cerr << "Decoded posting list of " << offsets.size() << " offsets differs!" << std::endl;
+    errors++;
+  }
+
+  // A truncated posting list must be detected
+  if (!buffer.empty()) {
+    pos=0;
+    decoded.clear();
+
+    if (osmscout::DecodePostingList(buffer.data(),
+                                    buffer.size()-1,
+                                    pos,
+                                    decoded)) {
+      std::cerr << "Truncated posting list of " << offsets.size() << " offsets decoded!" << std::endl;
+      errors++;
+    }
+  }
+}
+
+int main()
+{
+  std::vector<osmscout::FileOffset> offsets;
+
+  CheckRoundtrip(offsets);
+
+  offsets.push_back(0);
+  CheckRoundtrip(offsets);
+
+  offsets.clear();
+  offsets.push_back(123456789);
+  CheckRoundtrip(offsets);
+
+  // Consecutive offsets, deltas are packed with zero bits
+  offsets.clear();
+  for (osmscout::FileOffset i=1000; i<1300; i++) {
+    offsets.push_back(i);
+  }
+  CheckRoundtrip(offsets);
+
+  // Increasing deltas, different bit widths per block
+  offsets.clear();
+  osmscout::FileOffset offset=17;
+  for (size_t i=0; i<1000; i++) {
+    offsets.push_back(offset);
+    offset+=1+i*i*37;
+  }
+  CheckRoundtrip(offsets);
+
+  // Deltas needing the full 64 bits
+  offsets.clear();
+  offsets.push_back(0);
+  offsets.push_back(1);
+  offsets.push_back(0xffffffffffffffffULL);
+  CheckRoundtrip(offsets);
+
+  // Merging of lists with common offsets
+  std::vector<osmscout::FileOffset> lists;
+  std::vector<size_t>               listStarts;
+  std::vector<osmscout::FileOffset> merged;
+
+  listStarts.push_back(lists.size());
+  lists.push_back(10);
+  lists.push_back(20);
+  lists.push_back(30);
+
+  listStarts.push_back(lists.size());
+
+  listStarts.push_back(lists.size());
+  lists.push_back(5);
+  lists.push_back(20);
+  lists.push_back(40);
+
+  listStarts.push_back(lists.size());
+  lists.push_back(30);
+
+  osmscout::MergePostingLists(lists,
+                              listStarts,
+                              merged);
+
+  std::vector<osmscout::FileOffset> expected={5,10,20,30,40};
+
+  if (merged!=expected) {
+    std::cerr << "Merged posting lists differ!" << std::endl;
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
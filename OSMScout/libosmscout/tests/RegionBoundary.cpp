@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+
+#include <osmscout/util/Geometry.h>
+
+/*
+ * Pins how the location index assigns objects on the boundary of a region
+ * (see LocationIndexGenerator::FindRegionForCoord() and FindRegionsForWay()).
+ *
+ * The data is taken from Tests/data/benchmark.osm: The region "Synthtown" is
+ * the square 50.000,7.000 - 50.039,7.039. The node "Fuel 1600" is its north east
+ * corner and the way "Avenue 39" runs along its east edge.
+ *
+ * Node coordinates are read from nodes.dat, the coordinates of areas and ways
+ * are stored as CompactGeoCoord. Both decode to exactly the same values, so a
+ * node on a vertex of the region is on the boundary and thus part of the region.
+ */
+
+int errors=0;
+
+static osmscout::GeoCoord ReadNodeCoord(double lat,
+                                        double lon)
+{
+  unsigned char      buffer[osmscout::coordByteSize];
+  osmscout::GeoCoord coord;
+
+  osmscout::GeoCoord(lat,lon).EncodeToBuffer(buffer);
+  coord.DecodeFromBuffer(buffer);
+
+  return coord;
+}
+
+static void Check(const std::string& test,
+                  bool result,
+                  bool expected)
+{
+  if (result!=expected) {
+    std::cerr << test << ": Expected " << (expected ? "true" : "false") << ", got " << (result ? "true" : "false") << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  std::vector<osmscout::CompactGeoCoord> region;
+  std::vector<osmscout::CompactGeoCoord> avenue;
+
+  region.push_back(osmscout::CompactGeoCoord(50.0,7.0));
+  region.push_back(osmscout::CompactGeoCoord(50.0,7.039));
+  region.push_back(osmscout::CompactGeoCoord(50.039,7.039));
+  region.push_back(osmscout::CompactGeoCoord(50.039,7.0));
+
+  for (size_t i=0; i<40; i++) {
+    avenue.push_back(osmscout::CompactGeoCoord(50.0+i*0.001,7.039));
+  }
+
+  for (const auto& vertex : region) {
+    osmscout::GeoCoord node=ReadNodeCoord(vertex.GetLat(),vertex.GetLon());
+
+    if (node.GetLat()!=vertex.GetLat() ||
+        node.GetLon()!=vertex.GetLon()) {
+      std::cerr << "Node " << node.GetDisplayText() << " differs from vertex " << vertex.GetDisplayText() << std::endl;
+      errors++;
+    }
+  }
+
+  // Node "Fuel 1600" on the north east corner is part of the region
+  Check("Corner node",
+        osmscout::IsCoordInArea(ReadNodeCoord(50.039,7.039),region),
+        true);
+  Check("Corner node relation",
+        osmscout::GetRelationOfPointToArea(ReadNodeCoord(50.039,7.039),region)==0,
+        true);
+
+  // ...but not a node right next to it
+  Check("Node east of corner",
+        osmscout::IsCoordInArea(ReadNodeCoord(50.039,7.03901),region),
+        false);
+  Check("Node north of corner",
+        osmscout::IsCoordInArea(ReadNodeCoord(50.03901,7.039),region),
+        false);
+
+  // Node within the region
+  Check("Inner node",
+        osmscout::IsCoordInArea(ReadNodeCoord(50.02,7.02),region),
+        true);
+
+  // Way "Avenue 39" on the east edge is partly in the region (its end points are
+  // vertices of the region), so it is added to the region and to its parent region
+  Check("Way on edge partly in region",
+        osmscout::IsAreaAtLeastPartlyInArea(avenue,region),
+        true);
+  Check("Way on edge completely in region",
+        osmscout::IsAreaCompletelyInArea(avenue,region),
+        false);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
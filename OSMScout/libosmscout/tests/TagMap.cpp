@@ -0,0 +1,137 @@
+#include <iostream>
+
+#include <osmscout/Tag.h>
+
+int errors=0;
+
+void CheckValue(const osmscout::TagMap& tags,
+                osmscout::TagId tag,
+                const std::string& expectedValue)
+{
+  auto entry=tags.find(tag);
+
+  if (entry==tags.end()) {
+    std::cerr << "Tag " << tag << " not found!" << std::endl;
+    errors++;
+  }
+  else if (entry->second!=expectedValue) {
+    std::cerr << "Tag " << tag << " has value '" << entry->second << "', expected '" << expectedValue << "'!" << std::endl;
+    errors++;
+  }
+}
+
+void CheckSorted(const osmscout::TagMap& tags)
+{
+  osmscout::TagId lastTag=0;
+  size_t          count=0;
+
+  for (const auto& entry : tags) {
+    if (count>0 &&
+        entry.first<=lastTag) {
+      std::cerr << "Tag " << entry.first << " is not sorted!" << std::endl;
+      errors++;
+    }
+
+    lastTag=entry.first;
+    count++;
+  }
+
+  if (count!=tags.size()) {
+    std::cerr << "Iterated " << count << " tags, expected " << tags.size() << "!" << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  osmscout::TagMap tags;
+
+  if (!tags.empty()) {
+    std::cerr << "New map is not empty!" << std::endl;
+    errors++;
+  }
+
+  tags[5]="residential";
+  tags[2]="Main Street";
+  tags[9]="yes";
+
+  if (tags.size()!=3) {
+    std::cerr << "Map has " << tags.size() << " tags, expected 3!" << std::endl;
+    errors++;
+  }
+
+  CheckSorted(tags);
+  CheckValue(tags,2,"Main Street");
+  CheckValue(tags,5,"residential");
+  CheckValue(tags,9,"yes");
+
+  if (tags.find(3)!=tags.end()) {
+    std::cerr << "Tag 3 found in map!" << std::endl;
+    errors++;
+  }
+
+  tags[5]="primary";
+
+  if (tags.size()!=3) {
+    std::cerr << "Overwriting a tag changed the size!" << std::endl;
+    errors++;
+  }
+
+  CheckValue(tags,5,"primary");
+
+  // Entries are reused after clear, but new entries must still be empty
+  tags.clear();
+
+  if (!tags.empty()) {
+    std::cerr << "Cleared map is not empty!" << std::endl;
+    errors++;
+  }
+
+  if (tags.find(2)!=tags.end()) {
+    std::cerr << "Tag 2 found in cleared map!" << std::endl;
+    errors++;
+  }
+
+  if (!tags[7].empty()) {
+    std::cerr << "Reused entry is not empty!" << std::endl;
+    errors++;
+  }
+
+  tags.Set(1,"no",2);
+  tags[4]="4";
+
+  CheckSorted(tags);
+  CheckValue(tags,1,"no");
+  CheckValue(tags,4,"4");
+  CheckValue(tags,7,"");
+
+  tags.erase(4);
+
+  if (tags.size()!=2 ||
+      tags.find(4)!=tags.end()) {
+    std::cerr << "Tag 4 not erased!" << std::endl;
+    errors++;
+  }
+
+  CheckSorted(tags);
+
+  osmscout::TagMap copy(tags);
+
+  CheckSorted(copy);
+  CheckValue(copy,1,"no");
+  CheckValue(copy,7,"");
+
+  copy=osmscout::TagMap();
+
+  if (!copy.empty()) {
+    std::cerr << "Assigned map is not empty!" << std::endl;
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}